@@ -0,0 +1,434 @@
+#include "bench_grid.h"
+#include "space/grid/SpaceGrid.h"
+#include "space/grid/CacheSpaceGrid.h"
+#include "core/ext/Ranges.h"
+#include "items/text/Text.h"
+#include "items/checkbox/Check.h"
+#include "core/ext/ViewComposite.h"
+#include "core/ext/ViewStaticSchema.h"
+#include "core/ext/ModelStore.h"
+#include "items/numeric/Numeric.h"
+#include "items/sorting/Sorting.h"
+#include "misc/GridTicker.h"
+#include "widgets/GridWidget.h"
+#include <QtTest/QtTest>
+#include <QScrollBar>
+
+using namespace Qi;
+
+static SharedPtr<ModelTextCallback> makeModelText()
+{
+    auto modelText = makeShared<ModelTextCallback>();
+    modelText->getValueFunction = [](ID id)->QString {
+        return QString("Item [%1, %2]").arg(row(id)).arg(column(id));
+    };
+    return modelText;
+}
+
+// exposes layout validation of GridWidget
+class GridWidgetFrozen: public GridWidget
+{
+public:
+    GridWidgetFrozen(int rows, int columns, int frozenRows, int frozenColumns)
+    {
+        resize(800, 600);
+
+        // frozen rows and columns are placed at top and left sub-grids
+        this->rows(0)->setCount(frozenRows);
+        this->rows(1)->setCount(rows);
+        this->columns(0)->setCount(frozenColumns);
+        this->columns(1)->setCount(columns);
+
+        auto schema = makeShared<ViewText>(makeModelText());
+        for (GridID subID : {topLeftID, topID, leftID, clientID})
+            subGrid(subID)->addSchema(makeRangeAll(), schema);
+    }
+
+    void relayout()
+    {
+        invalidateCacheItemsLayout();
+        validateCacheItemsLayout();
+    }
+};
+
+static void addFrozenData()
+{
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<int>("columns");
+    QTest::addColumn<int>("frozenRows");
+    QTest::addColumn<int>("frozenColumns");
+
+    for (int frozen : {0, 2, 10})
+    {
+        QTest::newRow(qPrintable(QString("1000x20 frozen %1").arg(frozen))) << 1000 << 20 << frozen << frozen;
+        QTest::newRow(qPrintable(QString("100000x100 frozen %1").arg(frozen))) << 100000 << 100 << frozen << frozen;
+    }
+}
+
+void BenchGrid::cacheScroll_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<int>("step");
+
+    for (int rows : {10000, 1000000})
+    {
+        QTest::newRow(qPrintable(QString("%1 by line").arg(rows))) << rows << 20;
+        QTest::newRow(qPrintable(QString("%1 by page").arg(rows))) << rows << 600;
+    }
+}
+
+void BenchGrid::cacheScroll()
+{
+    QFETCH(int, rows);
+    QFETCH(int, step);
+
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(rows);
+    grid->columns()->setCount(20);
+    grid->addSchema(makeRangeAll(), makeShared<ViewText>(makeModelText()));
+
+    CacheSpaceGrid cache(grid);
+    cache.setWindow(QRect(0, 0, 800, 600));
+
+    const int maxOffset = grid->rows()->visibleSize() - 600;
+    int offset = 0;
+    GridID idStart, idEnd;
+
+    QBENCHMARK
+    {
+        offset = (offset + step) % maxOffset;
+        cache.setScrollOffset(QPoint(0, offset));
+        // validates items cache
+        cache.visibleItemsRange(idStart, idEnd);
+    }
+
+    QVERIFY(idStart.isValid());
+}
+
+void BenchGrid::widgetPaint_data()
+{
+    QTest::addColumn<int>("rows");
+    QTest::addColumn<int>("columns");
+
+    QTest::newRow("100x10") << 100 << 10;
+    QTest::newRow("100000x20") << 100000 << 20;
+    QTest::newRow("100000x100") << 100000 << 100;
+}
+
+void BenchGrid::widgetPaint()
+{
+    QFETCH(int, rows);
+    QFETCH(int, columns);
+
+    GridWidget widget;
+    widget.resize(800, 600);
+
+    auto grid = widget.subGrid();
+    grid->rows()->setCount(rows);
+    grid->columns()->setCount(columns);
+    grid->addSchema(makeRangeAll(), makeShared<ViewText>(makeModelText()));
+
+    QPixmap pixmap(widget.size());
+    int offset = 0;
+
+    QBENCHMARK
+    {
+        // scroll and render to offscreen pixmap
+        offset = (offset + 20) % (grid->rows()->visibleSize() - 600 + 1);
+        widget.cacheSubGrid()->setScrollOffset(QPoint(0, offset));
+        widget.render(&pixmap);
+    }
+}
+
+void BenchGrid::frozenLayout_data()
+{
+    addFrozenData();
+}
+
+void BenchGrid::frozenLayout()
+{
+    QFETCH(int, rows);
+    QFETCH(int, columns);
+    QFETCH(int, frozenRows);
+    QFETCH(int, frozenColumns);
+
+    GridWidgetFrozen widget(rows, columns, frozenRows, frozenColumns);
+
+    QBENCHMARK
+    {
+        // geometry of all nine sub-grids
+        widget.relayout();
+    }
+}
+
+void BenchGrid::frozenScroll_data()
+{
+    addFrozenData();
+}
+
+void BenchGrid::frozenScroll()
+{
+    QFETCH(int, rows);
+    QFETCH(int, columns);
+    QFETCH(int, frozenRows);
+    QFETCH(int, frozenColumns);
+
+    GridWidgetFrozen widget(rows, columns, frozenRows, frozenColumns);
+    widget.relayout();
+
+    QScrollBar* vScroll = widget.verticalScrollBar();
+    QScrollBar* hScroll = widget.horizontalScrollBar();
+    QVERIFY(vScroll->maximum() > 0);
+    int offset = 0;
+
+    QBENCHMARK
+    {
+        // updates scroll offsets of sub-grids and validates their caches
+        offset = (offset + 20) % (vScroll->maximum() + 1);
+        vScroll->setValue(offset);
+        hScroll->setValue(offset % (hScroll->maximum() + 1));
+        widget.cacheSubGrid()->validate(widget.guiContext());
+    }
+}
+
+void BenchGrid::frozenPaint_data()
+{
+    addFrozenData();
+}
+
+void BenchGrid::frozenPaint()
+{
+    QFETCH(int, rows);
+    QFETCH(int, columns);
+    QFETCH(int, frozenRows);
+    QFETCH(int, frozenColumns);
+
+    GridWidgetFrozen widget(rows, columns, frozenRows, frozenColumns);
+    QImage image(widget.size(), QImage::Format_ARGB32_Premultiplied);
+
+    QBENCHMARK
+    {
+        // full paint of all regions
+        widget.update();
+        widget.render(&image);
+    }
+}
+
+void BenchGrid::tickerFrame_data()
+{
+    QTest::addColumn<bool>("flash");
+    QTest::addColumn<bool>("sorted");
+
+    QTest::newRow("plain") << false << false;
+    QTest::newRow("flash") << true << false;
+    QTest::newRow("flash sorted") << true << true;
+}
+
+void BenchGrid::tickerFrame()
+{
+    QFETCH(bool, flash);
+    QFETCH(bool, sorted);
+
+    // 50 columns by 2000 rows, all columns are visible
+    const int rows = 2000;
+    const int columns = 50;
+    const int updatesPerFrame = 100000 / 60;
+
+    GridWidget widget;
+    widget.resize(columns * 40 + 20, 1000);
+
+    auto grid = widget.subGrid();
+    grid->setDimensions(rows, columns);
+    grid->rows()->setLineSizeAll(20);
+    grid->columns()->setLineSizeAll(40);
+
+    auto values = makeShared<ModelStorageColumns<double>>(grid, 0, columns - 1);
+    grid->addSchema(makeRangeAll(), makeShared<ViewText>(makeShared<ModelNumericText<double>>(values)));
+
+    GridTicker ticker(&widget);
+    auto feed = ticker.addFeed<double>(values);
+    if (flash)
+        ticker.addFlash(values, makeRangeAll(), 65536);
+
+    auto sorting = makeShared<ModelGridSorting>(grid);
+    if (sorted)
+    {
+        sorting->addSortingModel(0, values);
+        ticker.setSorting(sorting);
+        sorting->sortByItem(GridID(0, 0), true);
+    }
+
+    // changed items are repainted only
+    QRegion dirty;
+    QObject::connect(widget.cacheSubGrid().data(), &CacheSpace::cacheItemsChanged, [&dirty](const CacheSpace*, const QRegion& region) {
+        dirty |= region;
+    });
+
+    QImage image(widget.viewport()->size(), QImage::Format_ARGB32_Premultiplied);
+    widget.viewport()->render(&image);
+
+    quint32 seed = 1;
+    QBENCHMARK
+    {
+        // should fit into 16 ms
+        for (int i = 0; i < updatesPerFrame; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            feed->push(ID(GridID(int((seed >> 8) % rows), int(seed % columns))), double(seed % 10000));
+        }
+        ticker.drain();
+
+        widget.viewport()->render(&image, QPoint(), dirty);
+        dirty = QRegion();
+    }
+}
+
+enum StorageAccess
+{
+    StorageAccessColumn,
+    StorageAccessRow,
+    StorageAccessBlock
+};
+
+template <typename Layout>
+static void benchStorageAccess(int access)
+{
+    // 100000 rows by 100 columns
+    const int rows = 100000;
+    const int columns = 100;
+    // visible block of 800x600 widget
+    const int blockRows = 30;
+    const int blockColumns = 10;
+
+    auto grid = makeShared<SpaceGrid>();
+    grid->setDimensions(rows, columns);
+
+    auto model = makeShared<ModelStorageGrid<int, int, Layout>>(grid);
+    for (int row = 0; row < rows; ++row)
+    {
+        for (int column = 0; column < columns; ++column)
+            model->setValueId(GridID(row, column), row ^ column);
+    }
+
+    qint64 sum = 0;
+    int offset = 0;
+    QBENCHMARK
+    {
+        switch (access)
+        {
+        case StorageAccessColumn:
+            // column scan of sorting and filtering
+            for (int row = 0; row < rows; ++row)
+                sum += model->valueAt(GridID(row, offset % columns));
+            break;
+
+        case StorageAccessRow:
+            // row by row export and copying
+            for (int row = offset % 1000; row < rows; row += 1000)
+            {
+                for (int column = 0; column < columns; ++column)
+                    sum += model->valueAt(GridID(row, column));
+            }
+            break;
+
+        case StorageAccessBlock:
+            // painting of scrolled visible block
+            for (int block = 0; block < 100; ++block)
+            {
+                int firstRow = (offset * 997 + block * 251) % (rows - blockRows);
+                int firstColumn = (offset + block) % (columns - blockColumns);
+                for (int row = firstRow; row < firstRow + blockRows; ++row)
+                {
+                    for (int column = firstColumn; column < firstColumn + blockColumns; ++column)
+                        sum += model->valueAt(GridID(row, column));
+                }
+            }
+            break;
+        }
+        ++offset;
+    }
+
+    QVERIFY(sum != 0);
+}
+
+void BenchGrid::storageAccess_data()
+{
+    QTest::addColumn<int>("layout");
+    QTest::addColumn<int>("access");
+
+    const char* layouts[] = { "columns", "rows", "tiles" };
+    const char* accesses[] = { "column scan", "row scan", "block" };
+    for (int layout = 0; layout < 3; ++layout)
+    {
+        for (int access = StorageAccessColumn; access <= StorageAccessBlock; ++access)
+            QTest::newRow(qPrintable(QString("%1 layout, %2").arg(layouts[layout]).arg(accesses[access]))) << layout << access;
+    }
+}
+
+void BenchGrid::storageAccess()
+{
+    QFETCH(int, layout);
+    QFETCH(int, access);
+
+    switch (layout)
+    {
+    case 0:
+        benchStorageAccess<StorageGridColumns>(access);
+        break;
+    case 1:
+        benchStorageAccess<StorageGridRows>(access);
+        break;
+    default:
+        benchStorageAccess<StorageGridTiles>(access);
+        break;
+    }
+}
+
+void BenchGrid::schemaPaint_data()
+{
+    QTest::addColumn<bool>("isStatic");
+
+    QTest::newRow("composite") << false;
+    QTest::newRow("static") << true;
+}
+
+void BenchGrid::schemaPaint()
+{
+    QFETCH(bool, isStatic);
+
+    GridWidget widget;
+    widget.resize(800, 600);
+
+    auto grid = widget.subGrid();
+    grid->setDimensions(100000, 20);
+    grid->columns()->setLineSizeAll(100);
+
+    auto modelCheck = makeShared<ModelCheckCallback>();
+    modelCheck->getValueFunction = [](ID id)->Qt::CheckState {
+        return (row(id) % 2) ? Qt::Checked : Qt::Unchecked;
+    };
+
+    if (isStatic)
+    {
+        grid->addSchema(makeRangeAll(), makeViewStaticSchema(staticLeft(makeViewStatic<ViewCheck>(modelCheck, false)),
+                                                             staticClient(makeViewStatic<ViewText>(makeModelText()))));
+    }
+    else
+    {
+        QVector<ViewSchema> subViews;
+        subViews.append(ViewSchema(makeLayoutLeft(), makeShared<ViewCheck>(modelCheck, false)));
+        subViews.append(ViewSchema(makeLayoutClient(), makeShared<ViewText>(makeModelText())));
+        grid->addSchema(makeRangeAll(), makeShared<ViewComposite>(subViews));
+    }
+
+    QPixmap pixmap(widget.size());
+    int offset = 0;
+
+    QBENCHMARK
+    {
+        // scroll by rows, so new cache items are laid out and drawn
+        offset = (offset + 20) % (grid->rows()->visibleSize() - 600 + 1);
+        widget.cacheSubGrid()->setScrollOffset(QPoint(0, offset));
+        widget.render(&pixmap);
+    }
+}
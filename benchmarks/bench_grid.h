@@ -0,0 +1,41 @@
+#ifndef BENCH_GRID_H
+#define BENCH_GRID_H
+
+#include <QObject>
+
+class BenchGrid: public QObject
+{
+    Q_OBJECT
+
+public:
+    Q_INVOKABLE BenchGrid() {}
+
+private slots:
+
+    void cacheScroll_data();
+    void cacheScroll();
+    void widgetPaint_data();
+    void widgetPaint();
+
+    // phases of GridWidget with frozen rows and columns
+    void frozenLayout_data();
+    void frozenLayout();
+    void frozenScroll_data();
+    void frozenScroll();
+    void frozenPaint_data();
+    void frozenPaint();
+
+    // frame of GridWidget in ticker mode, 100k updates per second at 60 fps
+    void tickerFrame_data();
+    void tickerFrame();
+
+    // ModelStorageGrid layouts by access patterns
+    void storageAccess_data();
+    void storageAccess();
+
+    // check and text cells by ViewComposite and ViewStaticSchema
+    void schemaPaint_data();
+    void schemaPaint();
+};
+
+#endif // BENCH_GRID_H
@@ -0,0 +1,135 @@
+#include "bench_lines.h"
+#include "space/grid/Lines.h"
+#include <QtTest/QtTest>
+#include <numeric>
+
+using namespace Qi;
+
+static void addSizes()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("uniform");
+
+    for (int count : {1000, 100000, 1000000})
+    {
+        QTest::newRow(qPrintable(QString("%1 uniform").arg(count))) << count << true;
+        QTest::newRow(qPrintable(QString("%1 mixed").arg(count))) << count << false;
+    }
+}
+
+static void addTreeSizes()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("sizesIndex");
+
+    for (int count : {100000, 1000000, 10000000})
+    {
+        QTest::newRow(qPrintable(QString("%1 tree").arg(count))) << count << false;
+        QTest::newRow(qPrintable(QString("%1 index").arg(count))) << count << true;
+    }
+}
+
+static void initLines(Lines& lines, int count, bool uniform)
+{
+    lines.setCount(count);
+
+    if (uniform)
+        return;
+
+    // every 10th line is bigger and every 7th line is hidden
+    for (int i = 0; i < count; i += 10)
+        lines.setLineSize(i, 40);
+    for (int i = 0; i < count; i += 7)
+        lines.setLineVisible(i, false);
+}
+
+void BenchLines::findVisibleIDByPos_data()
+{
+    addSizes();
+}
+
+void BenchLines::findVisibleIDByPos()
+{
+    QFETCH(int, count);
+    QFETCH(bool, uniform);
+
+    Lines lines;
+    initLines(lines, count, uniform);
+
+    const int size = lines.visibleSize();
+    int result = 0;
+
+    QBENCHMARK
+    {
+        for (int pos = 0; pos < size; pos += size / 1000 + 1)
+            result += lines.findVisibleIDByPos(pos);
+    }
+
+    QVERIFY(result >= 0);
+}
+
+void BenchLines::findVisibleIDByPosRandom_data()
+{
+    addTreeSizes();
+}
+
+void BenchLines::findVisibleIDByPosRandom()
+{
+    QFETCH(int, count);
+    QFETCH(bool, sizesIndex);
+
+    Lines lines;
+    initLines(lines, count, false);
+    lines.setSizesIndexEnabled(sizesIndex);
+
+    // spread lookups over whole lines to miss cpu caches
+    const int size = lines.visibleSize();
+    QVector<int> positions(10000);
+    quint32 seed = 1;
+    for (auto& pos : positions)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        pos = int(seed % quint32(size));
+    }
+
+    // builds index if enabled
+    int result = 0;
+    for (int i = 0; i < count / 64; ++i)
+        result += lines.findVisibleIDByPos(positions[i % positions.size()]);
+
+    QBENCHMARK
+    {
+        for (int pos : positions)
+            result += lines.findVisibleIDByPos(pos);
+    }
+
+    QVERIFY(result >= 0);
+}
+
+void BenchLines::sort_data()
+{
+    addSizes();
+}
+
+void BenchLines::sort()
+{
+    QFETCH(int, count);
+    QFETCH(bool, uniform);
+
+    Lines lines;
+    initLines(lines, count, uniform);
+
+    QVector<int> keys(count);
+    for (int i = 0; i < count; ++i)
+        keys[i] = (i * 7919) % 1000;
+
+    QVector<int> identity(count);
+    std::iota(identity.begin(), identity.end(), 0);
+
+    QBENCHMARK
+    {
+        // start from unsorted lines each time
+        lines.setPermutation(identity);
+        lines.sort(true, [&keys](int left, int right) { return keys[left] < keys[right]; });
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef BENCH_LINES_H
+#define BENCH_LINES_H
+
+#include <QObject>
+
+class BenchLines: public QObject
+{
+    Q_OBJECT
+
+public:
+    Q_INVOKABLE BenchLines() {}
+
+private slots:
+
+    void findVisibleIDByPos_data();
+    void findVisibleIDByPos();
+    void findVisibleIDByPosRandom_data();
+    void findVisibleIDByPosRandom();
+    void sort_data();
+    void sort();
+};
+
+#endif // BENCH_LINES_H
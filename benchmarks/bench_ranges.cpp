@@ -0,0 +1,75 @@
+#include "bench_ranges.h"
+#include "core/ext/Ranges.h"
+#include "core/ext/ModelStore.h"
+#include "space/grid/RangeGrid.h"
+#include "items/filter/FilterText.h"
+#include <QtTest/QtTest>
+
+using namespace Qi;
+
+void BenchRanges::selectionHasItem_data()
+{
+    QTest::addColumn<int>("ranges");
+
+    for (int ranges : {10, 100, 1000, 10000})
+        QTest::newRow(qPrintable(QString::number(ranges))) << ranges;
+}
+
+void BenchRanges::selectionHasItem()
+{
+    QFETCH(int, ranges);
+
+    // selection of ranges rectangles with some excluded cells
+    RangeSelection selection;
+    for (int i = 0; i < ranges; ++i)
+    {
+        selection.addRange(makeRangeGridRect(i * 10, i * 10 + 5, i % 20, i % 20 + 3), false);
+        if (i % 3 == 0)
+            selection.addRange(makeRangeGridRect(i * 10 + 1, i * 10 + 2, i % 20, i % 20 + 1), true);
+    }
+
+    const int rows = ranges * 10;
+    int result = 0;
+
+    QBENCHMARK
+    {
+        for (int row = 0; row < rows; row += rows / 1000 + 1)
+            for (int column = 0; column < 24; ++column)
+                result += selection.hasItem(ID(GridID(row, column))) ? 1 : 0;
+    }
+
+    QVERIFY(result > 0);
+}
+
+void BenchRanges::rowsFilterByText_data()
+{
+    QTest::addColumn<int>("count");
+
+    for (int count : {10000, 100000, 1000000})
+        QTest::newRow(qPrintable(QString::number(count))) << count;
+}
+
+void BenchRanges::rowsFilterByText()
+{
+    QFETCH(int, count);
+
+    auto rows = makeShared<Lines>(count);
+    auto modelText = makeShared<ModelStorageColumn<QString>>(rows);
+    for (int i = 0; i < count; ++i)
+        modelText->setValueId(GridID(i, 0), QString("Item %1").arg(i));
+
+    auto filterByText = makeShared<RowsFilterByText>();
+    auto filter = makeShared<ItemsFilterTextByText>(modelText);
+    filterByText->addFilterByColumn(0, filter);
+    rows->addLinesVisibility(filterByText);
+
+    int index = 0;
+    QStringList texts = { "1", "12", "123", "7", "" };
+
+    QBENCHMARK
+    {
+        filter->setFilterText(texts[index++ % texts.size()]);
+        // request visible lines to apply filter
+        rows->visibleCount();
+    }
+}
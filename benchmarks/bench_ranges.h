@@ -0,0 +1,21 @@
+#ifndef BENCH_RANGES_H
+#define BENCH_RANGES_H
+
+#include <QObject>
+
+class BenchRanges: public QObject
+{
+    Q_OBJECT
+
+public:
+    Q_INVOKABLE BenchRanges() {}
+
+private slots:
+
+    void selectionHasItem_data();
+    void selectionHasItem();
+    void rowsFilterByText_data();
+    void rowsFilterByText();
+};
+
+#endif // BENCH_RANGES_H
@@ -0,0 +1,23 @@
+include(../common.pri)
+
+QT       += core gui widgets
+QT       += testlib
+
+TARGET = qi-benchmarks
+
+CONFIG   += console
+CONFIG   -= app_bundle
+
+INCLUDEPATH += $$ROOT_DIR/src/
+LIBS += -L$$DESTDIR -lqt-items
+
+TEMPLATE = app
+
+HEADERS +=  bench_lines.h \
+    bench_ranges.h \
+    bench_grid.h
+
+SOURCES +=  main.cpp \
+    bench_lines.cpp \
+    bench_ranges.cpp \
+    bench_grid.cpp
@@ -0,0 +1,38 @@
+#include "bench_lines.h"
+#include "bench_ranges.h"
+#include "bench_grid.h"
+
+#include <QtTest/QtTest>
+#include <QApplication>
+
+int main(int argc, char* argv[])
+{
+    // widgets are painted offscreen
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    int result = 0;
+
+    QList<const QMetaObject*> benchmarks;
+
+    // register benchmarks
+    benchmarks.append(&BenchLines::staticMetaObject);
+    benchmarks.append(&BenchRanges::staticMetaObject);
+    benchmarks.append(&BenchGrid::staticMetaObject);
+
+    // run benchmarks
+    foreach (const QMetaObject* benchmarkMetaObject, benchmarks)
+    {
+        QScopedPointer<QObject> benchmark(benchmarkMetaObject->newInstance());
+        Q_ASSERT(benchmark);
+
+        if (benchmark)
+        {
+            result |= QTest::qExec(benchmark.data(), argc, argv);
+        }
+    }
+
+    return result;
+}
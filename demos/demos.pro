@@ -2,5 +2,6 @@ TEMPLATE   = subdirs
 SUBDIRS   += item-widgets\
              list-widgets\
              grid-widgets\
-             scene-widgets
+             scene-widgets\
+             ticker-grid
 
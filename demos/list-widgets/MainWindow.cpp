@@ -347,7 +347,7 @@ QAbstractAnimation* MainWindow::createCircleViewAnimation(const Qi::CacheSpaceAn
             subAnimation->setStartValue(0);
             subAnimation->setEndValue(radius);
 
-            info.cacheView->drawProxy = [subAnimation](const CacheView2* cacheView, QPainter* painter, const GuiContext &ctx, ID id, const QRect& itemRect, const QRect* visibleRect) {
+            info.cacheView->setDrawProxy([subAnimation](const CacheView2* cacheView, QPainter* painter, const GuiContext &ctx, ID id, const QRect& itemRect, const QRect* visibleRect) {
 
                 painter->save();
 
@@ -360,7 +360,7 @@ QAbstractAnimation* MainWindow::createCircleViewAnimation(const Qi::CacheSpaceAn
                 cacheView->drawRaw(painter, ctx, id, itemRect, visibleRect);
 
                 painter->restore();
-            };
+            });
 
             animation->addAnimation(subAnimation);
         }
@@ -375,7 +375,7 @@ QAbstractAnimation* MainWindow::createCircleViewAnimation(const Qi::CacheSpaceAn
             subAnimation->setStartValue(0.f);
             subAnimation->setEndValue(1.f);
 
-            info.cacheView->drawProxy = [subAnimation](const CacheView2* cacheView, QPainter* painter, const GuiContext &ctx, ID id, const QRect& itemRect, const QRect* visibleRect) {
+            info.cacheView->setDrawProxy([subAnimation](const CacheView2* cacheView, QPainter* painter, const GuiContext &ctx, ID id, const QRect& itemRect, const QRect* visibleRect) {
 
                 float progress = subAnimation->currentValue().toFloat();
 
@@ -385,7 +385,7 @@ QAbstractAnimation* MainWindow::createCircleViewAnimation(const Qi::CacheSpaceAn
                 cacheView->drawRaw(painter, ctx, id, itemRect, visibleRect);
 
                 painter->setOpacity(oldOpacity);
-            };
+            });
 
             animation->addAnimation(subAnimation);
         }
@@ -422,9 +422,9 @@ QAbstractAnimation* MainWindow::createShiftRightItemAnimation(const Qi::CacheSpa
 
             cacheItem->draw(&itemPainter, ctx, &cacheSpace->window());
 
-            cacheItem->drawProxy = [itemPixmap](CacheItem* cacheItem, QPainter* painter, const GuiContext& /*ctx*/, const QRect* /*visibleRect*/) {
+            cacheItem->setDrawProxy([itemPixmap](CacheItem* cacheItem, QPainter* painter, const GuiContext& /*ctx*/, const QRect* /*visibleRect*/) {
                 painter->drawPixmap(cacheItem->rect.topLeft(), itemPixmap);
-            };
+            });
         }
 
         auto subAnimation = new QSequentialAnimationGroup(animation);
@@ -489,12 +489,12 @@ QAbstractAnimation* MainWindow::createShiftDownItemAnimation(const Qi::CacheSpac
 
             cacheItem->draw(&itemPainter, ctx, &cacheSpace->window());
 
-            cacheItem->drawProxy = [itemPixmap, topAnimation](CacheItem* cacheItem, QPainter* painter, const GuiContext& /*ctx*/, const QRect* /*visibleRect*/) {
+            cacheItem->setDrawProxy([itemPixmap, topAnimation](CacheItem* cacheItem, QPainter* painter, const GuiContext& /*ctx*/, const QRect* /*visibleRect*/) {
                 painter->save();
                 painter->setClipRect(cacheItem->rect, Qt::IntersectClip);
                 painter->drawPixmap(cacheItem->rect.left(), topAnimation->currentValue().toInt(), itemPixmap);
                 painter->restore();
-            };
+            });
         }
 
         animation->addAnimation(topAnimation);
@@ -0,0 +1,124 @@
+#include "widgets/GridWidget.h"
+#include "space/grid/CacheSpaceGrid.h"
+#include "core/ext/Ranges.h"
+#include "core/ext/ModelStore.h"
+#include "items/text/Text.h"
+#include "items/numeric/Numeric.h"
+#include "items/color/Heatmap.h"
+#include "items/misc/ViewItemBorder.h"
+#include "items/misc/ViewChangeFlash.h"
+#include "items/sorting/Sorting.h"
+#include "misc/GridTicker.h"
+#include <QApplication>
+#include <QThread>
+#include <atomic>
+
+using namespace Qi;
+
+static const int rowsCount = 5000;
+static const int columnsCount = 50;
+// updates per second pushed by the worker thread
+static const int updatesRate = 100000;
+
+// pushes random prices of random rows from worker thread
+class TickerThread: public QThread
+{
+public:
+    TickerThread(SharedPtr<ModelFeed<double>> feed)
+        : m_feed(std::move(feed)),
+          m_stop(false)
+    {}
+
+    void stop() { m_stop.store(true); wait(); }
+
+protected:
+    void run() override
+    {
+        quint32 seed = 1;
+        auto random = [&seed]() {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+        };
+
+        // updates are sent in 1 ms portions
+        const int portion = updatesRate / 1000;
+        while (!m_stop.load())
+        {
+            for (int i = 0; i < portion; ++i)
+            {
+                int row = int(random() % rowsCount);
+                int column = 1 + int(random() % (columnsCount - 1));
+                m_feed->push(ID(GridID(row, column)), 100. + double(random() % 10000) / 100.);
+            }
+            msleep(1);
+        }
+    }
+
+private:
+    SharedPtr<ModelFeed<double>> m_feed;
+    std::atomic<bool> m_stop;
+};
+
+int main(int argc, char *argv[])
+{
+    QApplication a(argc, argv);
+
+    GridWidget widget;
+    widget.setWindowTitle("Ticker grid");
+    widget.resize(1600, 900);
+
+    auto clientGrid = widget.subGrid();
+    clientGrid->setDimensions(rowsCount, columnsCount);
+    clientGrid->rows()->setLineSizeAll(18);
+    clientGrid->columns()->setLineSizeAll(60);
+
+    auto topGrid = widget.subGrid(topID);
+    topGrid->setRowsCount(1);
+    topGrid->rows()->setLineSizeAll(22);
+
+    // columnar store of prices
+    auto prices = makeShared<ModelStorageColumns<double>>(clientGrid, 1, columnsCount - 1);
+
+    auto names = makeShared<ModelTextCallback>();
+    names->getValueFunction = [](ID id)->QString {
+        return QString("SYM%1").arg(row(id));
+    };
+
+    auto captions = makeShared<ModelTextCallback>();
+    captions->getValueFunction = [](ID id)->QString {
+        return column(id) == 0 ? QString("Symbol") : QString("Price %1").arg(column(id));
+    };
+
+    auto pricesRange = makeRangeGridColumns(1, columnsCount);
+
+    clientGrid->addSchema(makeRangeAll(), makeShared<ViewRowBorder>(), makeLayoutBottom(LayoutBehaviorTransparent));
+    clientGrid->addSchema(makeRangeAll(), makeShared<ViewColumnBorder>(), makeLayoutRight(LayoutBehaviorTransparent));
+    // last column is shown as heatmap
+    clientGrid->addSchema(makeRangeGridColumn(columnsCount - 1), makeShared<ViewHeatmap>(prices), makeLayoutBackground());
+    clientGrid->addSchema(makeRangeGridColumn(0), makeShared<ViewText>(names));
+    clientGrid->addSchema(pricesRange, makeShared<ViewText>(makeShared<ModelNumericText<double>>(prices), ViewDefaultControllerNone, Qt::AlignRight | Qt::AlignVCenter));
+    topGrid->addSchema(makeRangeAll(), makeShared<ViewText>(captions));
+
+    // updates are applied at 60 fps, changed prices are flashed
+    // and rows are kept sorted by the first price
+    auto ticker = new GridTicker(&widget, 60);
+    auto feed = ticker->addFeed<double>(prices);
+    auto flash = ticker->addFlash(prices, pricesRange, 65536);
+    flash->setDuration(500);
+
+    auto sorting = makeShared<ModelGridSorting>(clientGrid);
+    sorting->addSortingModel(1, prices);
+    ticker->setSorting(sorting);
+    sorting->sortByItem(GridID(0, 1), false);
+
+    TickerThread thread(feed);
+    thread.start();
+
+    widget.show();
+    int result = a.exec();
+
+    thread.stop();
+    return result;
+}
@@ -0,0 +1,17 @@
+include(../../common.pri)
+
+QT += core gui widgets
+
+TARGET = qi-demos-ticker-grid
+TEMPLATE = app
+DESTDIR = $$OUT_PWD/../../bin/
+
+SOURCES +=  main.cpp
+
+INCLUDEPATH += $$ROOT_DIR/src/
+LIBS += -L$$DESTDIR -lqt-items
+
+win32 {
+} else:unix {
+    QMAKE_LFLAGS += -Wl,-rpath,\'\$$ORIGIN\'
+}
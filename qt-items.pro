@@ -1,9 +1,13 @@
 TEMPLATE   = subdirs
 SUBDIRS   += src\
              tests\
+             benchmarks\
+             replay\
              demos
 
 src.file = src/qt-items-lib.pro
 
 tests.depends = src
+benchmarks.depends = src
+replay.depends = src
 demos.depends = src
@@ -0,0 +1,81 @@
+#include "InteractionRecorder.h"
+#include <QWindow>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QKeyEvent>
+
+InteractionRecorder::InteractionRecorder(QWindow* window, const QString& scenario)
+    : m_window(window)
+{
+    Q_ASSERT(window);
+
+    m_trace.scenario = scenario;
+    m_trace.windowSize = window->size();
+    m_timer.start();
+
+    window->installEventFilter(this);
+}
+
+InteractionRecorder::~InteractionRecorder()
+{
+    if (m_window)
+        m_window->removeEventFilter(this);
+}
+
+bool InteractionRecorder::eventFilter(QObject* watched, QEvent* event)
+{
+    if (watched != m_window)
+        return false;
+
+    InteractionEvent record;
+    record.time = m_timer.elapsed();
+    record.type = event->type();
+
+    switch (event->type())
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    {
+        auto mouseEvent = static_cast<QMouseEvent*>(event);
+        record.pos = mouseEvent->pos();
+        record.button = mouseEvent->button();
+        record.buttons = mouseEvent->buttons();
+        record.modifiers = mouseEvent->modifiers();
+        break;
+    }
+
+    case QEvent::Wheel:
+    {
+        auto wheelEvent = static_cast<QWheelEvent*>(event);
+        record.pos = wheelEvent->pos();
+        record.buttons = wheelEvent->buttons();
+        record.modifiers = wheelEvent->modifiers();
+        record.angleDelta = wheelEvent->angleDelta();
+        break;
+    }
+
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    {
+        auto keyEvent = static_cast<QKeyEvent*>(event);
+        record.modifiers = keyEvent->modifiers();
+        record.key = keyEvent->key();
+        record.text = keyEvent->text();
+        record.autoRepeat = keyEvent->isAutoRepeat();
+        break;
+    }
+
+    case QEvent::Resize:
+        // replay uses the last window size
+        m_trace.windowSize = m_window->size();
+        return false;
+
+    default:
+        return false;
+    }
+
+    m_trace.events.append(record);
+    return false;
+}
@@ -0,0 +1,33 @@
+#ifndef INTERACTION_RECORDER_H
+#define INTERACTION_RECORDER_H
+
+#include "InteractionTrace.h"
+#include <QObject>
+#include <QElapsedTimer>
+#include <QPointer>
+
+class QWindow;
+
+// records input events of window
+// events are taken before widgets see them, so propagated events are not duplicated
+class InteractionRecorder: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(InteractionRecorder)
+
+public:
+    InteractionRecorder(QWindow* window, const QString& scenario);
+    ~InteractionRecorder();
+
+    const InteractionTrace& trace() const { return m_trace; }
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
+private:
+    QPointer<QWindow> m_window;
+    InteractionTrace m_trace;
+    QElapsedTimer m_timer;
+};
+
+#endif // INTERACTION_RECORDER_H
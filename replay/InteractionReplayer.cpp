@@ -0,0 +1,284 @@
+#include "InteractionReplayer.h"
+#include <QApplication>
+#include <QWindow>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QKeyEvent>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+
+using namespace Qi;
+
+static const char* const categoryNames[TraceCategoriesCount] = {
+    "controller", "cache", "lines", "sort", "paint", "view"
+};
+
+qint64 ReplayReport::percentile(double percent) const
+{
+    if (frameTimes.isEmpty())
+        return 0;
+
+    QVector<qint64> times = frameTimes;
+    std::sort(times.begin(), times.end());
+
+    int rank = int(std::ceil(percent / 100.0 * times.size()));
+    return times[qBound(0, rank - 1, times.size() - 1)];
+}
+
+static QString formatTime(qint64 nsecs)
+{
+    return QString("%1 us").arg(nsecs / 1000.0, 0, 'f', 1);
+}
+
+QString ReplayReport::toString() const
+{
+    QString result;
+    QTextStream stream(&result);
+
+    stream << "scenario: " << scenario << "\n";
+    stream << "frames: " << frameTimes.size() << " (" << repeats << " repeats)\n";
+    stream << "total: " << formatTime(totalTime) << "\n";
+    stream << "p50: " << formatTime(percentile(50)) << "\n";
+    stream << "p90: " << formatTime(percentile(90)) << "\n";
+    stream << "p99: " << formatTime(percentile(99)) << "\n";
+    stream << "max: " << formatTime(percentile(100)) << "\n";
+
+    if (phases.isEmpty())
+    {
+        stream << "phases: not traced, build library with CONFIG+=qi_trace\n";
+        return result;
+    }
+
+    stream << "phases:\n";
+    for (const auto& phase : phases)
+    {
+        stream << "  " << phase.category << "/" << phase.name
+               << " count " << phase.count
+               << " total " << formatTime(phase.totalTime)
+               << " max " << formatTime(phase.maxTime) << "\n";
+    }
+
+    stream << "views:\n";
+    for (const auto& draw : draws)
+    {
+        stream << "  " << draw.viewType
+               << " draws " << draw.draws
+               << " total " << formatTime(draw.totalTime)
+               << " max " << formatTime(draw.maxTime) << "\n";
+    }
+
+    if (!callbacks.isEmpty())
+    {
+        stream << "callbacks:\n";
+        for (const auto& callback : callbacks)
+        {
+            stream << "  " << callback.name
+                   << " calls " << callback.calls
+                   << " total " << formatTime(callback.totalTime) << "\n";
+        }
+    }
+
+    stream.flush();
+    return result;
+}
+
+QByteArray ReplayReport::toJson() const
+{
+    QJsonObject root;
+    root["scenario"] = scenario;
+    root["repeats"] = repeats;
+    root["frames"] = frameTimes.size();
+    root["totalNs"] = double(totalTime);
+
+    QJsonObject percentiles;
+    percentiles["p50"] = double(percentile(50));
+    percentiles["p90"] = double(percentile(90));
+    percentiles["p99"] = double(percentile(99));
+    percentiles["max"] = double(percentile(100));
+    root["frameNs"] = percentiles;
+
+    QJsonArray phasesArray;
+    for (const auto& phase : phases)
+    {
+        QJsonObject object;
+        object["category"] = phase.category;
+        object["name"] = phase.name;
+        object["count"] = double(phase.count);
+        object["totalNs"] = double(phase.totalTime);
+        object["maxNs"] = double(phase.maxTime);
+        phasesArray.append(object);
+    }
+    root["phases"] = phasesArray;
+
+    QJsonArray drawsArray;
+    for (const auto& draw : draws)
+    {
+        QJsonObject object;
+        object["view"] = QString::fromLatin1(draw.viewType);
+        object["draws"] = double(draw.draws);
+        object["totalNs"] = double(draw.totalTime);
+        object["maxNs"] = double(draw.maxTime);
+        drawsArray.append(object);
+    }
+    root["views"] = drawsArray;
+
+    QJsonArray callbacksArray;
+    for (const auto& callback : callbacks)
+    {
+        QJsonObject object;
+        object["callback"] = QString::fromLatin1(callback.name);
+        object["calls"] = double(callback.calls);
+        object["totalNs"] = double(callback.totalTime);
+        callbacksArray.append(object);
+    }
+    root["callbacks"] = callbacksArray;
+
+    return QJsonDocument(root).toJson();
+}
+
+InteractionReplayer::InteractionReplayer(QWidget* window)
+    : m_window(window)
+{
+    Q_ASSERT(m_window);
+    Q_ASSERT(m_window->isWindow());
+}
+
+ReplayReport InteractionReplayer::replay(const InteractionTrace& trace, int repeats, int warmups)
+{
+    Q_ASSERT(repeats > 0);
+    Q_ASSERT(warmups >= 0);
+
+    prepare(trace);
+
+    // fill caches and pools before measurements
+    for (int i = 0; i < warmups; ++i)
+    {
+        for (const auto& event : trace.events)
+        {
+            send(event);
+            flush();
+        }
+    }
+
+    ReplayReport report;
+    report.scenario = trace.scenario;
+    report.repeats = repeats;
+    report.frameTimes.reserve(trace.events.size() * repeats);
+
+    Tracer::clear();
+    Tracer::start();
+
+    QElapsedTimer timer;
+    for (int i = 0; i < repeats; ++i)
+    {
+        for (const auto& event : trace.events)
+        {
+            timer.start();
+            send(event);
+            flush();
+            qint64 frameTime = timer.nsecsElapsed();
+
+            report.frameTimes.append(frameTime);
+            report.totalTime += frameTime;
+        }
+    }
+
+    Tracer::stop();
+
+    // aggregate markers by phase
+    QHash<QString, int> phaseIndexes;
+    for (const auto& event : Tracer::events())
+    {
+        QString category = QString::fromLatin1(categoryNames[event.category]);
+        QString name = QString::fromLatin1(event.name);
+        QString key = category + QLatin1Char('/') + name;
+
+        auto it = phaseIndexes.find(key);
+        if (it == phaseIndexes.end())
+        {
+            it = phaseIndexes.insert(key, report.phases.size());
+            ReplayPhase phase;
+            phase.category = category;
+            phase.name = name;
+            report.phases.append(phase);
+        }
+
+        ReplayPhase& phase = report.phases[it.value()];
+        ++phase.count;
+        phase.totalTime += event.duration;
+        phase.maxTime = qMax(phase.maxTime, event.duration);
+    }
+
+    std::sort(report.phases.begin(), report.phases.end(), [](const ReplayPhase& left, const ReplayPhase& right) {
+        return left.totalTime > right.totalTime;
+    });
+
+    report.draws = Tracer::drawStatistics();
+    report.callbacks = Tracer::callbackStatistics();
+    return report;
+}
+
+void InteractionReplayer::prepare(const InteractionTrace& trace)
+{
+    m_window->resize(trace.windowSize);
+    m_window->show();
+    m_window->activateWindow();
+    m_window->setFocus();
+
+    // layout and first paint are not measured
+    QApplication::processEvents();
+    flush();
+}
+
+void InteractionReplayer::send(const InteractionEvent& event)
+{
+    QWindow* window = m_window->windowHandle();
+    Q_ASSERT(window);
+
+    QPointF pos = event.pos;
+    QPointF globalPos = window->mapToGlobal(event.pos);
+
+    switch (event.type)
+    {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    {
+        QMouseEvent mouseEvent(event.type, pos, pos, globalPos, event.button, event.buttons, event.modifiers);
+        QApplication::sendEvent(window, &mouseEvent);
+        break;
+    }
+
+    case QEvent::Wheel:
+    {
+        QWheelEvent wheelEvent(pos, globalPos, QPoint(), event.angleDelta, event.angleDelta.y(), Qt::Vertical, event.buttons, event.modifiers);
+        QApplication::sendEvent(window, &wheelEvent);
+        break;
+    }
+
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    {
+        QKeyEvent keyEvent(event.type, event.key, event.modifiers, event.text, event.autoRepeat);
+        QApplication::sendEvent(window, &keyEvent);
+        break;
+    }
+
+    default:
+        Q_ASSERT(false);
+    }
+}
+
+void InteractionReplayer::flush()
+{
+    // deferred calls may post update requests
+    QApplication::sendPostedEvents();
+    QApplication::sendPostedEvents();
+}
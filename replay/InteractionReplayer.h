@@ -0,0 +1,59 @@
+#ifndef INTERACTION_REPLAYER_H
+#define INTERACTION_REPLAYER_H
+
+#include "InteractionTrace.h"
+#include "utils/Trace.h"
+#include <QWidget>
+
+// costs of trace markers with the same category and name
+struct ReplayPhase
+{
+    QString category;
+    QString name;
+    quint64 count = 0;
+    // nanoseconds
+    qint64 totalTime = 0;
+    qint64 maxTime = 0;
+};
+
+struct ReplayReport
+{
+    QString scenario;
+    int repeats = 0;
+    // nanoseconds to handle event and paint widgets it has updated
+    QVector<qint64> frameTimes;
+    qint64 totalTime = 0;
+    // empty if library is built without qi_trace
+    QVector<ReplayPhase> phases;
+    QVector<Qi::Tracer::DrawStatistics> draws;
+    QVector<Qi::Tracer::CallbackStatistics> callbacks;
+
+    // nearest rank percentile of frame times, percent is in [0, 100]
+    qint64 percentile(double percent) const;
+
+    QString toString() const;
+    QByteArray toJson() const;
+};
+
+// replays trace against top level widget as fast as possible
+// each event is handled and painted before the next one, timers are not fired
+// between events, so results don't depend on how fast machine replays them
+class InteractionReplayer
+{
+    Q_DISABLE_COPY(InteractionReplayer)
+
+public:
+    explicit InteractionReplayer(QWidget* window);
+
+    ReplayReport replay(const InteractionTrace& trace, int repeats = 1, int warmups = 1);
+
+private:
+    void prepare(const InteractionTrace& trace);
+    void send(const InteractionEvent& event);
+    // delivers posted events and paints updated widgets
+    void flush();
+
+    QWidget* m_window;
+};
+
+#endif // INTERACTION_REPLAYER_H
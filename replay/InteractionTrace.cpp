@@ -0,0 +1,285 @@
+#include "InteractionTrace.h"
+#include <QFile>
+#include <QTextStream>
+#include <QUrl>
+
+static const char* const traceSignature = "qi-replay-trace 1";
+
+static const struct
+{
+    QEvent::Type type;
+    const char* name;
+} eventTypeNames[] = {
+    { QEvent::MouseButtonPress, "press" },
+    { QEvent::MouseButtonRelease, "release" },
+    { QEvent::MouseButtonDblClick, "dblclick" },
+    { QEvent::MouseMove, "move" },
+    { QEvent::Wheel, "wheel" },
+    { QEvent::KeyPress, "keypress" },
+    { QEvent::KeyRelease, "keyrelease" }
+};
+
+static QString eventTypeName(QEvent::Type type)
+{
+    for (const auto& typeName : eventTypeNames)
+    {
+        if (typeName.type == type)
+            return typeName.name;
+    }
+    return QString();
+}
+
+static QEvent::Type eventType(const QString& name)
+{
+    for (const auto& typeName : eventTypeNames)
+    {
+        if (name == QLatin1String(typeName.name))
+            return typeName.type;
+    }
+    return QEvent::None;
+}
+
+bool InteractionTrace::save(QIODevice* device) const
+{
+    Q_ASSERT(device);
+
+    QTextStream stream(device);
+    stream << traceSignature << "\n";
+    stream << "scenario " << scenario << "\n";
+    stream << "window " << windowSize.width() << " " << windowSize.height() << "\n";
+
+    for (const auto& event : events)
+    {
+        QString text = event.text.isEmpty() ? QString("-") : QString::fromLatin1(QUrl::toPercentEncoding(event.text));
+        stream << event.time << " " << eventTypeName(event.type)
+               << " " << event.pos.x() << " " << event.pos.y()
+               << " " << int(event.button) << " " << int(event.buttons) << " " << int(event.modifiers)
+               << " " << event.angleDelta.x() << " " << event.angleDelta.y()
+               << " " << event.key << " " << int(event.autoRepeat) << " " << text << "\n";
+    }
+
+    stream.flush();
+    return stream.status() == QTextStream::Ok;
+}
+
+bool InteractionTrace::load(QIODevice* device)
+{
+    Q_ASSERT(device);
+
+    QTextStream stream(device);
+    if (stream.readLine() != QLatin1String(traceSignature))
+        return false;
+
+    InteractionTrace trace;
+    while (!stream.atEnd())
+    {
+        QString line = stream.readLine();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        QStringList fields = line.split(' ', QString::SkipEmptyParts);
+        if (fields[0] == QLatin1String("scenario") && fields.size() == 2)
+        {
+            trace.scenario = fields[1];
+            continue;
+        }
+
+        if (fields[0] == QLatin1String("window") && fields.size() == 3)
+        {
+            trace.windowSize = QSize(fields[1].toInt(), fields[2].toInt());
+            continue;
+        }
+
+        if (fields.size() != 12)
+            return false;
+
+        InteractionEvent event;
+        event.time = fields[0].toLongLong();
+        event.type = eventType(fields[1]);
+        if (event.type == QEvent::None)
+            return false;
+        event.pos = QPoint(fields[2].toInt(), fields[3].toInt());
+        event.button = Qt::MouseButton(fields[4].toInt());
+        event.buttons = Qt::MouseButtons(fields[5].toInt());
+        event.modifiers = Qt::KeyboardModifiers(fields[6].toInt());
+        event.angleDelta = QPoint(fields[7].toInt(), fields[8].toInt());
+        event.key = fields[9].toInt();
+        event.autoRepeat = fields[10].toInt() != 0;
+        if (fields[11] != QLatin1String("-"))
+            event.text = QUrl::fromPercentEncoding(fields[11].toLatin1());
+
+        trace.events.append(event);
+    }
+
+    if (!trace.windowSize.isValid())
+        return false;
+
+    *this = trace;
+    return true;
+}
+
+bool InteractionTrace::save(const QString& fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+    return save(&file);
+}
+
+bool InteractionTrace::load(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+    return load(&file);
+}
+
+void InteractionTrace::append(InteractionEvent event)
+{
+    // scripted events are one frame apart
+    event.time = events.isEmpty() ? 0 : events.last().time + 16;
+    events.append(event);
+}
+
+void InteractionTrace::mouseMove(const QPoint& pos, Qt::MouseButtons buttons)
+{
+    InteractionEvent event;
+    event.type = QEvent::MouseMove;
+    event.pos = pos;
+    event.buttons = buttons;
+    append(event);
+}
+
+void InteractionTrace::mouseClick(const QPoint& pos, Qt::KeyboardModifiers modifiers)
+{
+    InteractionEvent event;
+    event.type = QEvent::MouseButtonPress;
+    event.pos = pos;
+    event.button = Qt::LeftButton;
+    event.buttons = Qt::LeftButton;
+    event.modifiers = modifiers;
+    append(event);
+
+    event.type = QEvent::MouseButtonRelease;
+    event.buttons = Qt::NoButton;
+    append(event);
+}
+
+void InteractionTrace::mouseDrag(const QPoint& from, const QPoint& to, int steps)
+{
+    Q_ASSERT(steps > 0);
+
+    InteractionEvent event;
+    event.type = QEvent::MouseButtonPress;
+    event.pos = from;
+    event.button = Qt::LeftButton;
+    event.buttons = Qt::LeftButton;
+    append(event);
+
+    for (int i = 1; i <= steps; ++i)
+        mouseMove(from + (to - from) * i / steps, Qt::LeftButton);
+
+    event.type = QEvent::MouseButtonRelease;
+    event.pos = to;
+    event.buttons = Qt::NoButton;
+    append(event);
+}
+
+void InteractionTrace::wheel(const QPoint& pos, int delta, int count)
+{
+    InteractionEvent event;
+    event.type = QEvent::Wheel;
+    event.pos = pos;
+    event.angleDelta = QPoint(0, delta);
+    for (int i = 0; i < count; ++i)
+        append(event);
+}
+
+void InteractionTrace::keyClick(int key, int count, Qt::KeyboardModifiers modifiers)
+{
+    Q_ASSERT(count > 0);
+
+    InteractionEvent event;
+    event.type = QEvent::KeyPress;
+    event.key = key;
+    event.modifiers = modifiers;
+    // held key sends auto-repeated presses
+    for (int i = 0; i < count; ++i)
+    {
+        event.autoRepeat = i > 0;
+        append(event);
+    }
+
+    event.type = QEvent::KeyRelease;
+    event.autoRepeat = false;
+    append(event);
+}
+
+InteractionTrace InteractionTrace::scripted(const QString& scenario, const QSize& windowSize)
+{
+    InteractionTrace trace;
+    trace.scenario = scenario;
+    trace.windowSize = windowSize;
+
+    const QPoint center(windowSize.width() / 2, windowSize.height() / 2);
+
+    if (scenario == QLatin1String("grid"))
+    {
+        // hover items
+        for (int i = 0; i <= 50; ++i)
+            trace.mouseMove(QPoint(60 + i * 12, 60 + i * 8));
+
+        // keyboard navigation from clicked item
+        trace.mouseClick(QPoint(200, 100));
+        trace.keyClick(Qt::Key_Down, 100);
+        trace.keyClick(Qt::Key_PageDown, 10);
+        trace.keyClick(Qt::Key_Right, 5);
+        trace.keyClick(Qt::Key_Down, 20, Qt::ShiftModifier);
+
+        // scrolling
+        trace.wheel(center, -120, 100);
+        trace.wheel(center, 120, 50);
+
+        // range selection
+        trace.mouseDrag(QPoint(100, 80), QPoint(windowSize.width() - 40, windowSize.height() - 40), 40);
+
+        // column resize by header border
+        trace.mouseDrag(QPoint(40 + 150 - 1, 12), QPoint(40 + 250, 12), 30);
+
+        trace.keyClick(Qt::Key_End, 1, Qt::ControlModifier);
+        trace.keyClick(Qt::Key_Home, 1, Qt::ControlModifier);
+    }
+    else if (scenario == QLatin1String("list"))
+    {
+        for (int i = 0; i <= 40; ++i)
+            trace.mouseMove(QPoint(center.x(), 10 + i * (windowSize.height() - 20) / 40));
+
+        trace.wheel(center, -120, 200);
+        trace.wheel(center, 120, 100);
+
+        for (int i = 0; i < 10; ++i)
+            trace.mouseClick(QPoint(center.x(), 30 + i * 50));
+
+        trace.keyClick(Qt::Key_PageDown, 20);
+        trace.keyClick(Qt::Key_PageUp, 10);
+    }
+    else if (scenario == QLatin1String("scene"))
+    {
+        for (int i = 0; i <= 60; ++i)
+            trace.mouseMove(QPoint(i * windowSize.width() / 60, i * windowSize.height() / 60));
+
+        trace.mouseDrag(QPoint(50, 50), QPoint(windowSize.width() - 50, windowSize.height() - 50), 40);
+
+        trace.wheel(center, -120, 100);
+        trace.wheel(center, 120, 100);
+        trace.wheel(center, -120, 50);
+
+        trace.mouseDrag(QPoint(windowSize.width() - 50, 50), QPoint(50, windowSize.height() - 50), 40);
+    }
+    else
+    {
+        trace.events.clear();
+    }
+
+    return trace;
+}
@@ -0,0 +1,60 @@
+#ifndef INTERACTION_TRACE_H
+#define INTERACTION_TRACE_H
+
+#include <QEvent>
+#include <QPoint>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+// input event recorded in window coordinates
+struct InteractionEvent
+{
+    // milliseconds since recording start, replay ignores it
+    qint64 time = 0;
+    QEvent::Type type = QEvent::None;
+    QPoint pos;
+    Qt::MouseButton button = Qt::NoButton;
+    Qt::MouseButtons buttons = Qt::NoButton;
+    Qt::KeyboardModifiers modifiers = Qt::NoModifier;
+    // wheel events
+    QPoint angleDelta;
+    // key events
+    int key = 0;
+    QString text;
+    bool autoRepeat = false;
+};
+
+// stream of input events against window of scenario
+// one event per text line, so traces can be kept in the repository and diffed
+class InteractionTrace
+{
+public:
+    QString scenario;
+    QSize windowSize;
+    QVector<InteractionEvent> events;
+
+    bool save(QIODevice* device) const;
+    bool load(QIODevice* device);
+
+    bool save(const QString& fileName) const;
+    bool load(const QString& fileName);
+
+    // scripted trace of typical interactions with scenario widget
+    // empty trace if scenario is unknown
+    static InteractionTrace scripted(const QString& scenario, const QSize& windowSize);
+
+    // helpers to script traces
+    void mouseMove(const QPoint& pos, Qt::MouseButtons buttons = Qt::NoButton);
+    void mouseClick(const QPoint& pos, Qt::KeyboardModifiers modifiers = Qt::NoModifier);
+    void mouseDrag(const QPoint& from, const QPoint& to, int steps);
+    void wheel(const QPoint& pos, int delta, int count);
+    void keyClick(int key, int count = 1, Qt::KeyboardModifiers modifiers = Qt::NoModifier);
+
+private:
+    void append(InteractionEvent event);
+};
+
+#endif // INTERACTION_TRACE_H
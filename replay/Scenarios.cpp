@@ -0,0 +1,194 @@
+#include "Scenarios.h"
+#include "core/Layout.h"
+#include "core/ext/Ranges.h"
+#include "core/ext/ModelStore.h"
+#include "core/ext/ViewComposite.h"
+#include "items/misc/ViewItemBorder.h"
+#include "items/misc/ViewAlternateBackground.h"
+#include "items/misc/ControllerMouseLinesResizer.h"
+#include "items/checkbox/Check.h"
+#include "items/text/Text.h"
+#include "items/numeric/Numeric.h"
+#include "items/selection/Selection.h"
+#include "widgets/GridWidget.h"
+#include "widgets/ListWidget.h"
+#include "widgets/SceneWidget.h"
+#include <QPainter>
+
+using namespace Qi;
+
+namespace
+{
+
+class ViewLine: public View
+{
+protected:
+    void drawImpl(QPainter* painter, const GuiContext& /*ctx*/, const CacheContext& cache, bool* /*showTooltip*/) const override
+    {
+        painter->drawLine(cache.cacheView.rect().topLeft(), cache.cacheView.rect().bottomRight());
+    }
+};
+
+class ViewRect: public View
+{
+protected:
+    void drawImpl(QPainter* painter, const GuiContext& /*ctx*/, const CacheContext& cache, bool* /*showTooltip*/) const override
+    {
+        painter->drawRect(cache.cacheView.rect());
+    }
+};
+
+} // end anonymous namespace
+
+static QWidget* createGridScenario()
+{
+    auto widget = new GridWidget();
+
+    auto fixedGrid = widget->subGrid(topLeftID);
+
+    auto clientGrid = widget->subGrid();
+    clientGrid->setDimensions(100000, 20);
+    clientGrid->rows()->setLineSizeAll(25);
+    clientGrid->columns()->setLineSizeAll(150);
+
+    auto topGrid = widget->subGrid(topID);
+    topGrid->setRowsCount(2);
+    topGrid->rows()->setLineSizeAll(25);
+
+    auto leftGrid = widget->subGrid(leftID);
+    leftGrid->setColumnsCount(1);
+    leftGrid->columns()->setLineSizeAll(40);
+
+    clientGrid->addSchema(makeRangeAll(), makeShared<ViewRowBorder>(), makeLayoutBottom(LayoutBehaviorTransparent));
+    clientGrid->addSchema(makeRangeAll(), makeShared<ViewColumnBorder>(), makeLayoutRight(LayoutBehaviorTransparent));
+    clientGrid->addSchema(makeRangeAll(), makeShared<ViewAlternateBackground>(), makeLayoutBackground());
+
+    auto selection = makeShared<ModelSelection>(clientGrid);
+    clientGrid->addSchema(makeRangeAll(), makeShared<ViewSelectionClient>(selection), makeLayoutBackground());
+    topGrid->addSchema(makeRangeAll(), makeShared<ViewSelectionHeader>(selection, SelectionRowsHeader), makeLayoutBackground());
+    leftGrid->addSchema(makeRangeAll(), makeShared<ViewSelectionHeader>(selection, SelectionColumnsHeader), makeLayoutBackground());
+    fixedGrid->addSchema(makeRangeAll(), makeShared<ViewSelectionHeader>(selection, SelectionCornerHeader), makeLayoutBackground());
+    widget->setControllerKeyboard(makeShared<ControllerKeyboardSelection>(selection, widget->cacheSubGrid(clientID).data(), widget));
+
+    {
+        auto view = makeShared<View>();
+        view->addController(makeShared<ControllerMouseColumnsResizer>(topGrid->columns()));
+        topGrid->addSchema(makeRangeAll(), view, makeLayoutFixedRight(3));
+    }
+
+    {
+        auto modelText = makeShared<ModelTextCallback>();
+        modelText->getValueFunction = [](ID id)->QString {
+            return QString("Caption[%1, %2]").arg(row(id)).arg(column(id));
+        };
+        topGrid->addSchema(makeRangeGridRow(0), makeShared<ViewText>(modelText));
+    }
+
+    {
+        auto modelRowText = makeShared<ModelNumericText<int>>(makeShared<ModelRowNumber>());
+        leftGrid->addSchema(makeRangeGridColumn(0), makeShared<ViewText>(modelRowText, ViewDefaultControllerNone, Qt::AlignRight | Qt::AlignVCenter));
+    }
+
+    {
+        auto modelChecks = makeShared<ModelStorageColumn<Qt::CheckState>>(clientGrid->rows());
+        clientGrid->addSchema(makeRangeGridColumn(0), makeShared<ViewCheck>(modelChecks), makeLayoutLeft());
+    }
+
+    auto modelText = makeShared<ModelTextCallback>();
+    modelText->getValueFunction = [](ID id)->QString {
+        return QString("Item [%1, %2]").arg(row(id)).arg(column(id));
+    };
+    clientGrid->addSchema(makeRangeAll(), makeShared<ViewText>(modelText));
+
+    return widget;
+}
+
+static QWidget* createListScenario()
+{
+    auto widget = new ListWidget();
+
+    auto& grid = *widget->grid();
+    grid.columns()->setCount(1);
+    grid.rows()->setCount(10000);
+    grid.rows()->setLineSizeAll(60);
+
+    auto names = makeShared<ModelTextCallback>();
+    names->getValueFunction = [](ID id)->QString {
+        return QString("Item %1").arg(row(id));
+    };
+
+    auto descriptions = makeShared<ModelTextCallback>();
+    descriptions->getValueFunction = [](ID id)->QString {
+        return QString("Description of item %1 wrapped to several lines of the item to measure text layout").arg(row(id));
+    };
+
+    QFont boldFont = widget->font();
+    boldFont.setBold(true);
+
+    grid.addSchema(makeRangeGridColumn(0), makeShared<ViewRowBorder>(), makeLayoutBottom());
+
+    {
+        QVector<ViewSchema> subViews;
+        subViews.append(ViewSchema(makeLayoutBackground(), makeShared<ViewTextFont>(boldFont)));
+        subViews.append(ViewSchema(makeLayoutClient(), makeShared<ViewText>(names, ViewDefaultControllerNone, Qt::AlignHCenter | Qt::AlignTop, Qt::ElideRight)));
+        grid.addSchema(makeRangeGridColumn(0), makeShared<ViewComposite>(subViews, QMargins(0, 2, 0, 2)), makeLayoutTop());
+    }
+
+    grid.addSchema(makeRangeGridColumn(0), makeShared<ViewText>(descriptions, ViewDefaultControllerNone, Qt::Alignment(Qt::AlignLeft | Qt::AlignTop | Qt::TextWordWrap)), makeLayoutClient());
+
+    return widget;
+}
+
+static QWidget* createSceneScenario()
+{
+    auto widget = new SceneWidget();
+
+    auto scene = makeShared<SpaceSceneElements>();
+    widget->initScene(scene);
+
+    // binary trees of nodes in rows
+    const int nodeSize = 60;
+    QVector<SharedPtr<SceneElementNode>> parents;
+    for (int level = 0; level < 7; ++level)
+    {
+        QVector<SharedPtr<SceneElementNode>> nodes;
+        int nodesCount = 1 << level;
+        for (int i = 0; i < nodesCount; ++i)
+        {
+            auto node = makeShared<SceneElementNode>(QRect(i * nodeSize * 2 + (1 << (6 - level)) * nodeSize, level * nodeSize * 3, nodeSize, nodeSize));
+            nodes.append(node);
+
+            if (!parents.isEmpty())
+            {
+                auto from = makeShared<SceneElementAnchor>(parents[i / 2], HCenter | Bottom);
+                auto to = makeShared<SceneElementAnchor>(node, HCenter | Top);
+                scene->addElement(makeShared<SceneElementConnection>(from, to));
+            }
+        }
+
+        for (const auto& node : nodes)
+            scene->addElement(node);
+        parents = nodes;
+    }
+
+    scene->addSchema(makeRangeByType(scene.data(), SceneElementTypeNode), makeShared<ViewRect>(), makeLayoutBackground());
+    scene->addSchema(makeRangeByType(scene.data(), SceneElementTypeConnection), makeShared<ViewLine>(), makeLayoutBackground());
+
+    return widget;
+}
+
+QStringList scenarioNames()
+{
+    return QStringList() << "grid" << "list" << "scene";
+}
+
+QWidget* createScenario(const QString& name)
+{
+    if (name == QLatin1String("grid"))
+        return createGridScenario();
+    if (name == QLatin1String("list"))
+        return createListScenario();
+    if (name == QLatin1String("scene"))
+        return createSceneScenario();
+    return nullptr;
+}
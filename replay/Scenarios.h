@@ -0,0 +1,14 @@
+#ifndef SCENARIOS_H
+#define SCENARIOS_H
+
+#include <QWidget>
+#include <QStringList>
+
+// widgets set up like demos/* to record and replay interactions against
+// "grid" - GridWidget of grid-widgets demo, "list" - ListWidget of list-widgets demo,
+// "scene" - SceneWidget of scene-widgets demo
+QStringList scenarioNames();
+// returns nullptr if scenario is unknown
+QWidget* createScenario(const QString& name);
+
+#endif // SCENARIOS_H
@@ -0,0 +1,132 @@
+#include "InteractionTrace.h"
+#include "InteractionRecorder.h"
+#include "InteractionReplayer.h"
+#include "Scenarios.h"
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QTextStream>
+
+// qi-replay --scenario grid --record grid.trace
+//     shows scenario widget and records interactions until it is closed
+// qi-replay --scenario grid --script grid.trace
+//     writes scripted trace of scenario
+// qi-replay grid.trace [--repeat 5] [--json report.json] [--chrome-trace trace.json]
+//     replays trace offscreen and reports frame times and phase costs
+int main(int argc, char* argv[])
+{
+    bool isRecording = false;
+    for (int i = 1; i < argc; ++i)
+        isRecording |= qstrcmp(argv[i], "--record") == 0;
+
+    // replayed widgets are painted offscreen
+    if (!isRecording && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+    QApplication::setApplicationName("qi-replay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Records and replays interactions with qt-items widgets");
+    parser.addHelpOption();
+    parser.addPositionalArgument("trace", "Trace file to replay, scripted trace of scenario if omitted");
+
+    QCommandLineOption scenarioOption("scenario", QString("Scenario: %1.").arg(scenarioNames().join(", ")), "name");
+    QCommandLineOption recordOption("record", "Record interactions to file.", "file");
+    QCommandLineOption scriptOption("script", "Write scripted trace of scenario to file.", "file");
+    QCommandLineOption repeatOption("repeat", "Replay trace given times.", "count", "3");
+    QCommandLineOption warmupOption("warmup", "Replay trace given times before measurement.", "count", "1");
+    QCommandLineOption jsonOption("json", "Write report in JSON to file.", "file");
+    QCommandLineOption chromeTraceOption("chrome-trace", "Write trace markers in Chrome trace format to file.", "file");
+    parser.addOptions({ scenarioOption, recordOption, scriptOption, repeatOption, warmupOption, jsonOption, chromeTraceOption });
+
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    InteractionTrace trace;
+    if (!parser.positionalArguments().isEmpty())
+    {
+        QString fileName = parser.positionalArguments().first();
+        if (!trace.load(fileName))
+        {
+            err << "Cannot load trace " << fileName << "\n";
+            return 1;
+        }
+    }
+    else
+    {
+        trace = InteractionTrace::scripted(parser.value(scenarioOption), QSize(800, 600));
+    }
+
+    QString scenario = parser.isSet(scenarioOption) ? parser.value(scenarioOption) : trace.scenario;
+    QScopedPointer<QWidget> window(createScenario(scenario));
+    if (!window)
+    {
+        err << "Unknown scenario '" << scenario << "', use one of: " << scenarioNames().join(", ") << "\n";
+        return 1;
+    }
+
+    if (parser.isSet(scriptOption))
+    {
+        if (!trace.save(parser.value(scriptOption)))
+        {
+            err << "Cannot write trace " << parser.value(scriptOption) << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (parser.isSet(recordOption))
+    {
+        window->resize(trace.windowSize.isValid() ? trace.windowSize : QSize(800, 600));
+        window->show();
+
+        InteractionRecorder recorder(window->windowHandle(), scenario);
+        app.exec();
+
+        if (!recorder.trace().save(parser.value(recordOption)))
+        {
+            err << "Cannot write trace " << parser.value(recordOption) << "\n";
+            return 1;
+        }
+
+        out << "Recorded " << recorder.trace().events.size() << " events\n";
+        return 0;
+    }
+
+    if (trace.events.isEmpty())
+    {
+        err << "Trace has no events\n";
+        return 1;
+    }
+
+    InteractionReplayer replayer(window.data());
+    ReplayReport report = replayer.replay(trace, qMax(1, parser.value(repeatOption).toInt()), qMax(0, parser.value(warmupOption).toInt()));
+
+    out << report.toString();
+
+    if (parser.isSet(jsonOption))
+    {
+        QFile file(parser.value(jsonOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(report.toJson()) < 0)
+        {
+            err << "Cannot write report " << parser.value(jsonOption) << "\n";
+            return 1;
+        }
+    }
+
+    if (parser.isSet(chromeTraceOption))
+    {
+        QFile file(parser.value(chromeTraceOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || !Qi::Tracer::writeChromeTrace(&file))
+        {
+            err << "Cannot write trace " << parser.value(chromeTraceOption) << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
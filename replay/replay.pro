@@ -0,0 +1,27 @@
+include(../common.pri)
+
+QT       += core gui widgets
+
+TARGET = qi-replay
+
+CONFIG   += console
+CONFIG   -= app_bundle
+
+INCLUDEPATH += $$ROOT_DIR/src/
+LIBS += -L$$DESTDIR -lqt-items
+
+# phase costs are reported if library is built with CONFIG += qi_trace
+qi_trace: DEFINES += QI_TRACE
+
+TEMPLATE = app
+
+HEADERS +=  InteractionTrace.h \
+    InteractionRecorder.h \
+    InteractionReplayer.h \
+    Scenarios.h
+
+SOURCES +=  main.cpp \
+    InteractionTrace.cpp \
+    InteractionRecorder.cpp \
+    InteractionReplayer.cpp \
+    Scenarios.cpp
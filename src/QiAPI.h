@@ -79,6 +79,11 @@ enum ChangeReasonFlag
     ChangeReasonCacheItems = 0x04000,
     ChangeReasonCacheContent = 0x08000,
     ChangeReasonCacheFrame = 0x10000,
+
+    // comes with ChangeReasonSpaceStructure if items were reordered only
+    ChangeReasonSpaceItemsOrder = 0x20000,
+    // comes with ChangeReasonSpaceStructure if items were resized only
+    ChangeReasonSpaceItemsSize = 0x40000,
 };
 
 Q_DECLARE_FLAGS(ChangeReason, ChangeReasonFlag)
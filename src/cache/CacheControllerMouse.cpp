@@ -19,7 +19,9 @@
 #include "cache/CacheItemFactory.h"
 #include "widgets/core/SpaceWidgetCore.h"
 #include "utils/auto_value.h"
+#include "utils/Trace.h"
 #include <QDebug>
+#include <limits>
 
 namespace Qi
 {
@@ -29,12 +31,17 @@ CacheControllerMouse::CacheControllerMouse(QWidget* owner, SpaceWidgetCore* widg
       m_cacheSpaces(1, std::move(cacheSpace)),
       m_capturingController(nullptr),
       m_isStopped(false),
-      m_isBusy(false)
+      m_isBusy(false),
+      m_cacheChanges(0)
 {
+    connectCacheSpace(m_cacheSpaces.first().data());
 }
 
 CacheControllerMouse::~CacheControllerMouse()
 {
+    for (const auto& connection : m_cacheSpacesConnections)
+        QObject::disconnect(connection);
+
     clear();
 
     Q_ASSERT(!m_capturingController);
@@ -44,9 +51,19 @@ CacheControllerMouse::~CacheControllerMouse()
 void CacheControllerMouse::addCacheSpace(SharedPtr<CacheSpace> cacheSpace)
 {
     clear();
+    connectCacheSpace(cacheSpace.data());
     m_cacheSpaces.append(std::move(cacheSpace));
 }
 
+void CacheControllerMouse::connectCacheSpace(const CacheSpace* cacheSpace)
+{
+    // items geometry may be changed
+    m_cacheSpacesConnections.append(QObject::connect(cacheSpace, &CacheSpace::cacheChanged, [this]() {
+        m_activationRect = QRect();
+        ++m_cacheChanges;
+    }));
+}
+
 void CacheControllerMouse::stop()
 {
     m_isStopped = true;
@@ -63,6 +80,8 @@ void CacheControllerMouse::resume()
 
 void CacheControllerMouse::clear()
 {
+    m_activationRect = QRect();
+
     QVector<ControllerMouse*> activeControllers;
     activeControllers.swap(m_activeControllers);
 
@@ -157,19 +176,44 @@ void CacheControllerMouse::updatePosition(QPoint point)
     if (isStopped())
         return;
 
-    this->point = point;
+    // controllers get points in space units of scaled cache space
+    this->point = m_cacheSpaces.first()->fromView(point);
 
     if (!m_capturingController)
         updateActiveControllers();
 }
 
+void CacheControllerMouse::updateHoverPosition(QPoint point)
+{
+    if (isStopped())
+        return;
+
+    this->point = m_cacheSpaces.first()->fromView(point);
+
+    if (m_capturingController)
+        return;
+
+    // point hasn't crossed any view with controller
+    if (m_activationRect.contains(this->point))
+        return;
+
+    updateActiveControllers();
+}
+
 void CacheControllerMouse::updateActiveControllers()
 {
+    QI_TRACE_SCOPE(TraceCategoryController, "CacheControllerMouse::updateActiveControllers");
     Q_ASSERT(!m_capturingController);
     Q_ASSERT(!m_isBusy);
 
     auto_value<bool> isBusy(m_isBusy, true);
 
+    int cacheChanges = m_cacheChanges;
+
+    // cache spaces and controllers narrow activationRect
+    const int maxCoordinate = std::numeric_limits<int>::max() / 2;
+    activationRect = QRect(QPoint(-maxCoordinate, -maxCoordinate), QPoint(maxCoordinate, maxCoordinate));
+
     // try to activate controllers under the point
     // and get actually activated controllers
     QVector<ControllerMouse*> activatedControllers;
@@ -188,6 +232,9 @@ void CacheControllerMouse::updateActiveControllers()
         m_activeControllers[i]->deactivate();
 
     m_activeControllers.swap(activatedControllers);
+
+    // activation could change cache items
+    m_activationRect = (cacheChanges == m_cacheChanges) ? activationRect : QRect();
 }
 
 void CacheControllerMouse::stopCapturing()
@@ -221,6 +268,7 @@ void CacheControllerMouse::notifyStopCapturing(ControllerMouse& controller)
         return;
 
     m_capturingController = nullptr;
+    m_activationRect = QRect();
 }
 
 bool CacheControllerMouse::processEvent(QEvent* event)
@@ -342,7 +390,7 @@ bool CacheControllerMouse::processLButtonDblClick(QMouseEvent* event)
 
 bool CacheControllerMouse::processMouseMove(QMouseEvent* event)
 {
-    updatePosition(event->pos());
+    updateHoverPosition(event->pos());
     return processFunc(&ControllerMouse::processMouseMove, event);
 }
 
@@ -37,6 +37,7 @@ public:
 
     bool isBusy() const { return m_isBusy; }
 
+    // point is in owner widget units
     void updatePosition(QPoint point);
     void stopCapturing();
     bool isCapturing() const { return m_capturingController; }
@@ -67,6 +68,9 @@ private:
 
     bool isEmpty() const { return m_activeControllers.empty(); }
     void updateActiveControllers();
+    // activates controllers only if point has left m_activationRect
+    void updateHoverPosition(QPoint point);
+    void connectCacheSpace(const CacheSpace* cacheSpace);
 
     template <typename Func> bool processFunc(Func func)
     {
@@ -113,10 +117,15 @@ private:
     }
 
     QVector<SharedPtr<CacheSpace>> m_cacheSpaces;
+    QVector<QMetaObject::Connection> m_cacheSpacesConnections;
     QVector<ControllerMouse*> m_activeControllers;
+    // controllers are not activated again while point is inside this rect
+    QRect m_activationRect;
     ControllerMouse* m_capturingController;
     bool m_isStopped;
     bool m_isBusy;
+    // count of cache changes to detect them during activation
+    int m_cacheChanges;
 };
 
 } // end namespace Qi
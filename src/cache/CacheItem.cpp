@@ -16,7 +16,10 @@
 
 #include "CacheItem.h"
 #include "core/View.h"
+#include "core/Layout.h"
 #include "core/ControllerMouse.h"
+#include "utils/Trace.h"
+#include <QThread>
 
 //#define DEBUG_RECTS
 
@@ -41,29 +44,43 @@ CacheItemInfo& CacheItemInfo::operator=(const CacheItemInfo& other)
 
 CacheItem::CacheItem(ID id)
     : CacheItemInfo(id),
-      m_isCacheViewValid(false)
+      m_isCacheViewValid(false),
+      m_isCacheViewDraft(false)
 {
 }
 
 CacheItem::CacheItem(const CacheItemInfo& info)
     : CacheItemInfo(info),
-      m_isCacheViewValid(false)
+      m_isCacheViewValid(false),
+      m_isCacheViewDraft(false)
 {
 }
 
 CacheItem::CacheItem(const CacheItem& other)
     : CacheItemInfo(other),
-      m_cacheView(other.m_cacheView),
-      m_isCacheViewValid(other.m_isCacheViewValid)
+      m_isCacheViewValid(other.m_isCacheViewValid),
+      m_isCacheViewDraft(other.m_isCacheViewDraft)
 {
+    // each item owns its cache view to recycle it
+    if (other.m_cacheView)
+        m_cacheView.reset(new CacheView2(*other.m_cacheView));
 }
 
 CacheItem& CacheItem::operator=(const CacheItem& other)
 {
+    if (this == &other)
+        return *this;
+
     CacheItemInfo::operator =(other);
 
-    m_cacheView = other.m_cacheView;
+    if (!other.m_cacheView)
+        m_cacheView.reset();
+    else if (m_cacheView)
+        *m_cacheView = *other.m_cacheView;
+    else
+        m_cacheView.reset(new CacheView2(*other.m_cacheView));
     m_isCacheViewValid = other.m_isCacheViewValid;
+    m_isCacheViewDraft = other.m_isCacheViewDraft;
 
     return *this;
 }
@@ -88,6 +105,18 @@ const CacheView2* CacheItem::findCacheViewByController(const ControllerMouse* co
     return result;
 }
 
+void CacheItem::recycle(const CacheItemInfo& info)
+{
+    CacheItemInfo::operator =(info);
+    m_drawProxy.reset();
+    m_isCacheViewValid = false;
+}
+
+bool CacheItem::isCacheViewValid(const GuiContext& ctx) const
+{
+    return m_isCacheViewValid && (!m_isCacheViewDraft || ctx.isDraft());
+}
+
 void CacheItem::invalidateCacheView()
 {
     m_cacheView.reset();
@@ -96,6 +125,9 @@ void CacheItem::invalidateCacheView()
 
 void CacheItem::correctRectangles(const QPoint &offset)
 {
+    if (offset.isNull())
+        return;
+
     // offset cell rect
     rect.translate(offset);
 
@@ -112,12 +144,7 @@ void CacheItem::correctRectangles(const QPoint &offset)
 
     // just offset all rects
     if (m_cacheView)
-    {
-        m_cacheView->forEachCacheView([&offset](CacheView2* cacheView)->bool {
-            cacheView->rRect().translate(offset);
-            return true;
-        });
-    }
+        m_cacheView->translate(offset);
 }
 QString CacheItem::text() const
 {
@@ -129,10 +156,18 @@ QString CacheItem::text() const
     return text;
 }
 
-void CacheItem::draw(QPainter *painter, const GuiContext& ctx, const QRect* visibleRect)
+void CacheItem::setDrawProxy(DrawProxy drawProxy)
 {
     if (drawProxy)
-        drawProxy(this, painter, ctx, visibleRect);
+        m_drawProxy.reset(new DrawProxy(std::move(drawProxy)));
+    else
+        m_drawProxy.reset();
+}
+
+void CacheItem::draw(QPainter *painter, const GuiContext& ctx, const QRect* visibleRect)
+{
+    if (m_drawProxy)
+        (*m_drawProxy)(this, painter, ctx, visibleRect);
     else
         drawRaw(painter, ctx, visibleRect);
 }
@@ -156,17 +191,29 @@ void CacheItem::tryActivateControllers(const ControllerContext& context, const C
 {
     // don't handle if CacheCellEx is not ready yet
     if (!m_isCacheViewValid || !m_cacheView)
+    {
+        context.activationRect = QRect();
         return;
+    }
+
+    // controllers stay the same while point is inside the item
+    // and doesn't cross rects of views with controllers
+    context.narrowActivationRect(rect, true);
+    if (visibleRect)
+        context.narrowActivationRect(*visibleRect, true);
 
     typedef QPair<ControllerMouse*, const CacheView2*> ControllerInfo_t;
     QVector<ControllerInfo_t> itemControllersInfo;
 
     // collect affected controllers
     m_cacheView->forEachCacheView([&itemControllersInfo, &context](const CacheView2* cacheView)->bool {
-        if (!cacheView->view()->controller())
+        // lazy controllers are created for views under point only
+        if (!cacheView->view()->hasController())
             return true;
 
-        if (!cacheView->rect().contains(context.point))
+        bool isUnderPoint = cacheView->rect().contains(context.point);
+        context.narrowActivationRect(cacheView->rect(), isUnderPoint);
+        if (!isUnderPoint)
             return true;
 
         itemControllersInfo.push_back(ControllerInfo_t(cacheView->view()->controller().data(), cacheView));
@@ -238,10 +285,12 @@ bool CacheItem::tooltipByPoint(const QPoint& point, TooltipInfo &tooltipInfo) co
 
 void CacheItem::validateCacheView(const GuiContext& ctx, const QRect* visibleRect)
 {
-    if (m_isCacheViewValid)
+    if (isCacheViewValid(ctx))
         return;
 
-    Q_ASSERT(!m_cacheView);
+    m_isCacheViewDraft = ctx.isDraft();
+
+    QI_TRACE_SCOPE(TraceCategoryCache, "CacheItem::validateCacheView");
 
     QRect* visibleItemRectPtr = nullptr;
 
@@ -256,16 +305,62 @@ void CacheItem::validateCacheView(const GuiContext& ctx, const QRect* visibleRec
         }
     }
 
-    if (schema.isValid())
+    // items of the same schema and size have the same layout
+    // unless it depends on item id or on visible part of the item
+    // memo is not synchronized, so worker threads lay out items without it
+    bool isLayoutMemoAllowed = schema.isValid() && !visibleItemRectPtr && schema.view->isCacheViewUniform()
+                               && schema.view->thread() == QThread::currentThread();
+    const CacheView2* layoutMemo = isLayoutMemoAllowed ? schema.view->layoutMemo(*schema.layout, ctx, rect.size()) : nullptr;
+
+    if (layoutMemo)
+    {
+        // reuse recycled cache view
+        if (m_cacheView)
+            *m_cacheView = *layoutMemo;
+        else
+            m_cacheView.reset(new CacheView2(*layoutMemo));
+        m_cacheView->translate(rect.topLeft());
+    }
+    else if (schema.isValid())
     {
+        quint64 sizeRequests = Layout::idDependentSizeRequests();
+
         QRect itemRect = rect;
         QVector<CacheView2> cacheViews;
         CacheView2* cacheView = schema.view->addCacheView(*schema.layout, ctx, id, cacheViews, itemRect, visibleItemRectPtr);
         if (cacheView)
         {
-            m_cacheView.reset(new CacheView2(*cacheView));
+            if (isLayoutMemoAllowed && sizeRequests == Layout::idDependentSizeRequests())
+            {
+                CacheView2 memo(*cacheView);
+                memo.translate(-rect.topLeft());
+                schema.view->setLayoutMemo(*schema.layout, ctx, rect.size(), memo);
+            }
+
+            // reuse recycled cache view, temporary tree is moved
+            if (m_cacheView)
+                *m_cacheView = std::move(*cacheView);
+            else
+                m_cacheView.reset(new CacheView2(std::move(*cacheView)));
+        }
+        else
+        {
+            m_cacheView.reset();
         }
     }
+    else
+    {
+        m_cacheView.reset();
+    }
+
+    // let views prepare draw data for assigned rects
+    if (m_cacheView)
+    {
+        m_cacheView->forEachCacheView([&ctx, this](const CacheView2* cacheView)->bool {
+            cacheView->view()->prepareCacheView(ctx, id, *cacheView);
+            return true;
+        });
+    }
 
     // mark cache views as valid
     m_isCacheViewValid = true;
@@ -48,10 +48,15 @@ public:
     CacheItem(const CacheItem& other);
     CacheItem& operator=(const CacheItem& other);
 
-    const CacheView2* cacheView() const { return m_cacheView.data(); }
-    CacheView2* cacheView() { return m_cacheView.data(); }
+    const CacheView2* cacheView() const { return m_isCacheViewValid ? m_cacheView.data() : nullptr; }
+    CacheView2* cacheView() { return m_isCacheViewValid ? m_cacheView.data() : nullptr; }
+
+    // reinitializes retired item, keeps cache view allocation to reuse it
+    void recycle(const CacheItemInfo& info);
 
     bool isCacheViewValid() const { return m_isCacheViewValid; }
+    // draft cache view is not valid for full drawing (see GuiContext::isDraft)
+    bool isCacheViewValid(const GuiContext& ctx) const;
     const CacheView2* findCacheViewByController(const ControllerMouse* controller) const;
 
     void invalidateCacheView();
@@ -63,7 +68,10 @@ public:
     void tryActivateControllers(const ControllerContext& context, const CacheSpace& cacheSpace, const QRect* visibleRect, QVector<ControllerMouse*>& controllers) const;
     bool tooltipByPoint(const QPoint& point, TooltipInfo& tooltipInfo) const;
 
-    std::function<void(CacheItem*, QPainter*, const GuiContext&, const QRect*)> drawProxy;
+    typedef std::function<void(CacheItem*, QPainter*, const GuiContext&, const QRect*)> DrawProxy;
+    // replaces item drawing, it's rarely used (by animations) and stored out of line
+    bool hasDrawProxy() const { return !m_drawProxy.isNull(); }
+    void setDrawProxy(DrawProxy drawProxy);
 
     void draw(QPainter* painter, const GuiContext& ctx, const QRect* visibleRect = nullptr);
     void drawRaw(QPainter* painter, const GuiContext& ctx, const QRect* visibleRect = nullptr);
@@ -72,6 +80,9 @@ public:
 private:
     SharedPtr<CacheView2> m_cacheView;
     bool m_isCacheViewValid;
+    // cache view was laid out in draft (see GuiContext::isDraft)
+    bool m_isCacheViewDraft;
+    QScopedPointer<DrawProxy> m_drawProxy;
 };
 
 } // end namespace Qi
@@ -18,12 +18,16 @@
 #include "core/ext/Layouts.h"
 #include "core/ext/ViewComposite.h"
 #include "space/grid/GridID.h"
+#include "utils/BitVector.h"
+#include <QtAlgorithms>
+#include <algorithm>
 
 namespace Qi
 {
 
 CacheItemFactory::CacheItemFactory(const Space& space)
-    : m_space(space)
+    : m_space(space),
+      m_schemasVersion(space.schemasVersion())
 {
 }
 
@@ -33,6 +37,8 @@ CacheItemFactory::~CacheItemFactory()
 
 CacheItemInfo CacheItemFactory::create(ID visibleId) const
 {
+    validate();
+
     CacheItemInfo info(m_space.toAbsolute(visibleId));
     updateSchema(info);
     info.rect = m_space.itemRect(visibleId);
@@ -40,17 +46,150 @@ CacheItemInfo CacheItemFactory::create(ID visibleId) const
     return info;
 }
 
+QVector<CacheItemInfo> CacheItemFactory::create(const QVector<ID>& visibleIds) const
+{
+    validate();
+
+    // rects of the block are computed together
+    QVector<QRect> rects = m_space.itemRects(visibleIds);
+
+    QVector<CacheItemInfo> infos;
+    infos.reserve(visibleIds.size());
+    for (int i = 0; i < visibleIds.size(); ++i)
+    {
+        infos.append(CacheItemInfo(m_space.toAbsolute(visibleIds[i])));
+        infos.back().rect = rects[i];
+    }
+
+    initSchemasImpl(infos);
+    return infos;
+}
+
 void CacheItemFactory::updateSchema(CacheItemInfo& info) const
 {
+    validate();
     initSchemaImpl(info);
 }
 
+void CacheItemFactory::invalidate()
+{
+    m_schemasVersion = m_space.schemasVersion();
+    m_schemaByMask.clear();
+    m_singleSchemas.clear();
+    m_lastSchema = ViewSchema();
+    invalidateImpl();
+}
+
+void CacheItemFactory::validate() const
+{
+    if (m_schemasVersion != m_space.schemasVersion())
+        const_cast<CacheItemFactory*>(this)->invalidate();
+}
+
 void CacheItemFactory::initSchemaImpl(CacheItemInfo& info) const
 {
     info.schema = createViewSchema(info.id);
 }
 
-ViewSchema CacheItemFactory::createViewSchema(ID absId) const
+void CacheItemFactory::initSchemasImpl(QVector<CacheItemInfo>& infos) const
+{
+    for (auto& info : infos)
+        initSchemaImpl(info);
+}
+
+const ViewSchema& CacheItemFactory::createViewSchema(ID absId) const
+{
+    const auto& schemas = m_space.schemasOrdered();
+
+    // memoize composite schemas by mask of matched schemas
+    if (schemas.size() > SchemasMaskSize)
+    {
+        m_lastSchema = createViewSchemaImpl(absId);
+        return m_lastSchema;
+    }
+
+    quint64 mask = 0;
+    for (int i = 0; i < schemas.size(); ++i)
+    {
+        if (schemas[i].range->hasItem(absId))
+            mask |= quint64(1) << i;
+    }
+
+    return viewSchemaByMask(mask);
+}
+
+void CacheItemFactory::createViewSchemas(QVector<CacheItemInfo>& infos) const
+{
+    const auto& schemas = m_space.schemasOrdered();
+
+    if (schemas.size() > SchemasMaskSize)
+    {
+        for (auto& info : infos)
+            info.schema = createViewSchemaImpl(info.id);
+        return;
+    }
+
+    QVector<ID> ids;
+    ids.reserve(infos.size());
+    for (const auto& info : infos)
+        ids.append(info.id);
+
+    // one batch query per schema
+    QVector<quint64> masks(ids.size(), 0);
+    QVector<bool> results(ids.size());
+    for (int i = 0; i < schemas.size(); ++i)
+    {
+        schemas[i].range->hasItems(ids.constData(), results.data(), ids.size());
+        for (int j = 0; j < ids.size(); ++j)
+        {
+            if (results[j])
+                masks[j] |= quint64(1) << i;
+        }
+    }
+
+    for (int j = 0; j < infos.size(); ++j)
+        infos[j].schema = viewSchemaByMask(masks[j]);
+}
+
+const ViewSchema& CacheItemFactory::viewSchemaByMask(quint64 mask) const
+{
+    static const ViewSchema emptySchema;
+    const auto& schemas = m_space.schemasOrdered();
+
+    if (mask == 0)
+        return emptySchema;
+
+    if ((mask & (mask - 1)) == 0)
+    {
+        // single schema
+        if (m_singleSchemas.isEmpty())
+        {
+            m_singleSchemas.reserve(schemas.size());
+            for (const auto& schema : schemas)
+                m_singleSchemas.append(ViewSchema(schema.layout, schema.view));
+        }
+
+        return m_singleSchemas.at(qCountTrailingZeroBits(mask));
+    }
+
+    auto it = m_schemaByMask.find(mask);
+    if (it != m_schemaByMask.end())
+        return it.value();
+
+    QVector<ViewSchema> viewSchemas;
+    for (int i = 0; i < schemas.size(); ++i)
+    {
+        if (mask & (quint64(1) << i))
+            viewSchemas.append(ViewSchema(schemas[i].layout, schemas[i].view));
+    }
+
+    ViewSchema& schema = m_schemaByMask[mask];
+    schema.layout = makeLayoutBackground();
+    schema.view = makeShared<ViewComposite>(viewSchemas);
+    return schema;
+}
+
+ViewSchema CacheItemFactory::createViewSchemaImpl(ID absId) const
 {
     QVector<ViewSchema> viewSchemas;
 
@@ -75,9 +214,23 @@ ViewSchema CacheItemFactory::createViewSchema(ID absId) const
     }
 }
 
+class CacheItemFactoryBatch: public CacheItemFactory
+{
+public:
+    CacheItemFactoryBatch(const Space& space)
+        : CacheItemFactory(space)
+    {}
+
+protected:
+    void initSchemasImpl(QVector<CacheItemInfo>& infos) const override
+    {
+        createViewSchemas(infos);
+    }
+};
+
 SharedPtr<CacheItemFactory> createCacheItemFactoryDefault(const Space& space)
 {
-    return makeShared<CacheItemFactory>(space);
+    return makeShared<CacheItemFactoryBatch>(space);
 }
 
 class CacheItemFactoryItem: public CacheItemFactory
@@ -111,6 +264,44 @@ SharedPtr<CacheItemFactory> createCacheItemFactoryItem(const Space& space)
     return makeShared<CacheItemFactoryItem>(space);
 }
 
+// schemas of absolute lines in dense table
+class ViewSchemasTable
+{
+public:
+    const ViewSchema* find(int line) const
+    {
+        if (line < 0 || line >= m_isKnown.size() || !m_isKnown.value(line))
+            return nullptr;
+
+        return &m_schemas.at(line);
+    }
+
+    void insert(int line, const ViewSchema& schema)
+    {
+        if (line < 0)
+            return;
+
+        if (line >= m_schemas.size())
+        {
+            m_schemas.resize(line + 1);
+            m_isKnown.resize(line + 1);
+        }
+
+        m_schemas[line] = schema;
+        m_isKnown.setValue(line, true);
+    }
+
+    void clear()
+    {
+        m_schemas.clear();
+        m_isKnown.clear();
+    }
+
+private:
+    QVector<ViewSchema> m_schemas;
+    BitVector m_isKnown;
+};
+
 class CacheItemFactorySameSchemaByColumn: public CacheItemFactory
 {
 public:
@@ -119,23 +310,24 @@ public:
     {}
 
 protected:
-    void initSchemaImpl(CacheItemInfo& info) const
+    void initSchemaImpl(CacheItemInfo& info) const override
     {
-        auto it = m_schemaByColumn.find(column(info.id));
-        if (it != m_schemaByColumn.end())
+        int theColumn = column(info.id);
+        if (auto schema = m_schemaByColumn.find(theColumn))
         {
-            info.schema = it.value();
+            info.schema = *schema;
         }
         else
         {
-            ViewSchema& schema = m_schemaByColumn[column(info.id)];
-            schema = createViewSchema(info.id);
-            info.schema = schema;
+            info.schema = createViewSchema(info.id);
+            m_schemaByColumn.insert(theColumn, info.schema);
         }
     }
 
+    void invalidateImpl() override { m_schemaByColumn.clear(); }
+
 private:
-    mutable QMap<int, ViewSchema> m_schemaByColumn;
+    mutable ViewSchemasTable m_schemaByColumn;
 };
 
 SharedPtr<CacheItemFactory> createCacheItemFactorySameSchemaByColumn(const Space& space)
@@ -151,23 +343,24 @@ public:
     {}
 
 protected:
-    void initSchemaImpl(CacheItemInfo& info) const
+    void initSchemaImpl(CacheItemInfo& info) const override
     {
-        auto it = m_schemaByRow.find(row(info.id));
-        if (it != m_schemaByRow.end())
+        int theRow = row(info.id);
+        if (auto schema = m_schemaByRow.find(theRow))
         {
-            info.schema = it.value();
+            info.schema = *schema;
         }
         else
         {
-            ViewSchema& schema = m_schemaByRow[row(info.id)];
-            schema = createViewSchema(info.id);
-            info.schema = schema;
+            info.schema = createViewSchema(info.id);
+            m_schemaByRow.insert(theRow, info.schema);
         }
     }
 
+    void invalidateImpl() override { m_schemaByRow.clear(); }
+
 private:
-    mutable QMap<int, ViewSchema> m_schemaByRow;
+    mutable ViewSchemasTable m_schemaByRow;
 };
 
 SharedPtr<CacheItemFactory> createCacheItemFactorySameSchemaByRow(const Space& space)
@@ -175,5 +368,251 @@ SharedPtr<CacheItemFactory> createCacheItemFactorySameSchemaByRow(const Space& s
     return makeShared<CacheItemFactorySameSchemaByRow>(space);
 }
 
+class CacheItemFactorySameSchemaByColumnRanges: public CacheItemFactory
+{
+public:
+    CacheItemFactorySameSchemaByColumnRanges(const Space& space)
+        : CacheItemFactory(space)
+    {}
+
+protected:
+    void initSchemaImpl(CacheItemInfo& info) const override
+    {
+        int theColumn = column(info.id);
+
+        // first run ending after the column
+        auto it = std::upper_bound(m_runs.begin(), m_runs.end(), theColumn, [](int column, const ColumnsRun& run) {
+            return column < run.end;
+        });
+        if (it != m_runs.end() && it->begin <= theColumn)
+        {
+            info.schema = it->schema;
+            return;
+        }
+
+        info.schema = createViewSchema(info.id);
+
+        // equal schemas share views, so they are compared by pointers
+        int index = it - m_runs.begin();
+        bool isPrevSame = index > 0 && m_runs[index - 1].end == theColumn && isSame(m_runs[index - 1].schema, info.schema);
+        bool isNextSame = index < m_runs.size() && m_runs[index].begin == theColumn + 1 && isSame(m_runs[index].schema, info.schema);
+        if (isPrevSame && isNextSame)
+        {
+            m_runs[index - 1].end = m_runs[index].end;
+            m_runs.remove(index);
+        }
+        else if (isPrevSame)
+        {
+            m_runs[index - 1].end = theColumn + 1;
+        }
+        else if (isNextSame)
+        {
+            m_runs[index].begin = theColumn;
+        }
+        else
+        {
+            ColumnsRun run;
+            run.begin = theColumn;
+            run.end = theColumn + 1;
+            run.schema = info.schema;
+            m_runs.insert(index, run);
+        }
+    }
+
+    void invalidateImpl() override { m_runs.clear(); }
+
+private:
+    struct ColumnsRun
+    {
+        int begin;
+        int end;
+        ViewSchema schema;
+    };
+
+    static bool isSame(const ViewSchema& left, const ViewSchema& right)
+    {
+        return left.layout == right.layout && left.view == right.view;
+    }
+
+    // sorted runs [begin, end) of columns with the same schema
+    mutable QVector<ColumnsRun> m_runs;
+};
+
+SharedPtr<CacheItemFactory> createCacheItemFactorySameSchemaByColumnRanges(const Space& space)
+{
+    return makeShared<CacheItemFactorySameSchemaByColumnRanges>(space);
+}
+
+// bits of schemas matched by lines in dense table
+class SchemasMasksTable
+{
+public:
+    bool find(int line, quint64& mask) const
+    {
+        if (line < 0 || line >= m_isKnown.size() || !m_isKnown.value(line))
+            return false;
+
+        mask = m_masks.at(line);
+        return true;
+    }
+
+    void insert(int line, quint64 mask)
+    {
+        if (line < 0)
+            return;
+
+        if (line >= m_masks.size())
+        {
+            m_masks.resize(line + 1);
+            m_isKnown.resize(line + 1);
+        }
+
+        m_masks[line] = mask;
+        m_isKnown.setValue(line, true);
+    }
+
+    void clear()
+    {
+        m_masks.clear();
+        m_isKnown.clear();
+    }
+
+private:
+    QVector<quint64> m_masks;
+    BitVector m_isKnown;
+};
+
+class CacheItemFactoryUniform: public CacheItemFactory
+{
+public:
+    CacheItemFactoryUniform(const Space& space)
+        : CacheItemFactory(space)
+    {}
+
+protected:
+    void initSchemaImpl(CacheItemInfo& info) const override
+    {
+        if (!m_isClassified)
+            classify();
+
+        if (m_isTooManySchemas)
+        {
+            info.schema = createViewSchema(info.id);
+            return;
+        }
+
+        // all schemas follow columns or rows, cache views directly
+        if (m_byRowSchemas == 0 && m_itemSchemas == 0)
+        {
+            initSchemaByLine(info, column(info.id), m_schemaByColumn);
+            return;
+        }
+        if (m_byColumnSchemas == 0 && m_itemSchemas == 0)
+        {
+            initSchemaByLine(info, row(info.id), m_schemaByRow);
+            return;
+        }
+
+        quint64 mask = lineMask(info.id, column(info.id), m_byColumnSchemas, m_maskByColumn)
+                     | lineMask(info.id, row(info.id), m_byRowSchemas, m_maskByRow)
+                     | schemasMask(info.id, m_itemSchemas);
+        info.schema = viewSchemaByMask(mask);
+    }
+
+    void invalidateImpl() override
+    {
+        m_isClassified = false;
+        m_schemaByColumn.clear();
+        m_schemaByRow.clear();
+        m_maskByColumn.clear();
+        m_maskByRow.clear();
+    }
+
+private:
+    void classify() const
+    {
+        const auto& schemas = space().schemasOrdered();
+
+        m_isClassified = true;
+        m_isTooManySchemas = schemas.size() > SchemasMaskSize;
+        m_byColumnSchemas = 0;
+        m_byRowSchemas = 0;
+        m_itemSchemas = 0;
+        if (m_isTooManySchemas)
+            return;
+
+        for (int i = 0; i < schemas.size(); ++i)
+        {
+            quint64 bit = quint64(1) << i;
+            int uniformity = schemas[i].range->uniformity();
+            if (uniformity & RangeUniformByColumn)
+                m_byColumnSchemas |= bit;
+            else if (uniformity & RangeUniformByRow)
+                m_byRowSchemas |= bit;
+            else
+                m_itemSchemas |= bit;
+        }
+    }
+
+    void initSchemaByLine(CacheItemInfo& info, int line, ViewSchemasTable& table) const
+    {
+        if (auto schema = table.find(line))
+        {
+            info.schema = *schema;
+        }
+        else
+        {
+            info.schema = viewSchemaByMask(schemasMask(info.id, m_byColumnSchemas | m_byRowSchemas));
+            table.insert(line, info.schema);
+        }
+    }
+
+    quint64 lineMask(ID absId, int line, quint64 schemasBits, SchemasMasksTable& table) const
+    {
+        if (schemasBits == 0)
+            return 0;
+
+        quint64 mask = 0;
+        if (!table.find(line, mask))
+        {
+            mask = schemasMask(absId, schemasBits);
+            table.insert(line, mask);
+        }
+
+        return mask;
+    }
+
+    quint64 schemasMask(ID absId, quint64 schemasBits) const
+    {
+        const auto& schemas = space().schemasOrdered();
+
+        quint64 mask = 0;
+        for (; schemasBits; schemasBits &= schemasBits - 1)
+        {
+            int i = qCountTrailingZeroBits(schemasBits);
+            if (schemas[i].range->hasItem(absId))
+                mask |= quint64(1) << i;
+        }
+
+        return mask;
+    }
+
+    mutable bool m_isClassified = false;
+    mutable bool m_isTooManySchemas = false;
+    // bits of schemas by uniformity of their ranges
+    mutable quint64 m_byColumnSchemas = 0;
+    mutable quint64 m_byRowSchemas = 0;
+    mutable quint64 m_itemSchemas = 0;
+
+    mutable ViewSchemasTable m_schemaByColumn;
+    mutable ViewSchemasTable m_schemaByRow;
+    mutable SchemasMasksTable m_maskByColumn;
+    mutable SchemasMasksTable m_maskByRow;
+};
+
+SharedPtr<CacheItemFactory> createCacheItemFactoryUniform(const Space& space)
+{
+    return makeShared<CacheItemFactoryUniform>(space);
+}
 
 } // end namespace Qi
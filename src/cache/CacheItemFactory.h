@@ -19,6 +19,7 @@
 
 #include "space/Space.h"
 #include "CacheItem.h"
+#include <QHash>
 
 namespace Qi
 {
@@ -32,23 +33,54 @@ public:
     virtual ~CacheItemFactory();
 
     CacheItemInfo create(ID visibleId) const;
+    // batch version of create
+    QVector<CacheItemInfo> create(const QVector<ID>& visibleIds) const;
     void updateSchema(CacheItemInfo& info) const;
 
     const Space& space() const { return m_space; }
 
+    // forgets memoized schemas, called automatically when schemasVersion of the space changes
+    void invalidate();
+
 protected:
     virtual void initSchemaImpl(CacheItemInfo& info) const;
+    // calls initSchemaImpl for each item by default
+    virtual void initSchemasImpl(QVector<CacheItemInfo>& infos) const;
+    virtual void invalidateImpl() {}
+
+    // identical schema combinations share one composite view
+    // returned schema is memoized by the factory and valid until the next call,
+    // assign it to item schema to not copy pointers of unchanged schemas
+    const ViewSchema& createViewSchema(ID absId) const;
+    // batch version of createViewSchema with one range query per schema
+    void createViewSchemas(QVector<CacheItemInfo>& infos) const;
 
-    ViewSchema createViewSchema(ID absId) const;
+    // mask has bits of matched schemas in ordered schemas
+    enum { SchemasMaskSize = 64 };
+    const ViewSchema& viewSchemaByMask(quint64 mask) const;
 
 private:
+    ViewSchema createViewSchemaImpl(ID absId) const;
+    // invalidates memoized schemas if schemas of the space were changed since the last call
+    void validate() const;
+
     const Space& m_space;
+    mutable QHash<quint64, ViewSchema> m_schemaByMask;
+    // view schemas of single ordered schemas
+    mutable QVector<ViewSchema> m_singleSchemas;
+    // result of createViewSchemaImpl for too many schemas
+    mutable ViewSchema m_lastSchema;
+    mutable quint64 m_schemasVersion;
 };
 
 QI_EXPORT SharedPtr<CacheItemFactory> createCacheItemFactoryDefault(const Space& space);
 QI_EXPORT SharedPtr<CacheItemFactory> createCacheItemFactoryItem(const Space& space);
 QI_EXPORT SharedPtr<CacheItemFactory> createCacheItemFactorySameSchemaByColumn(const Space& space);
 QI_EXPORT SharedPtr<CacheItemFactory> createCacheItemFactorySameSchemaByRow(const Space& space);
+// adjacent columns with the same schema share one entry
+QI_EXPORT SharedPtr<CacheItemFactory> createCacheItemFactorySameSchemaByColumnRanges(const Space& space);
+// memoizes schemas by column or row as uniformity of schemas ranges allows
+QI_EXPORT SharedPtr<CacheItemFactory> createCacheItemFactoryUniform(const Space& space);
 
 } // end namespace Qi
 
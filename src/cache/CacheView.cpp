@@ -17,15 +17,29 @@
 #include "CacheView.h"
 #include "core/Layout.h"
 #include "core/View.h"
+#include <QElapsedTimer>
 
 //#define DEBUG_RECTS
 
 namespace Qi
 {
 
+static const CacheViewDrawRecorder* cacheViewDrawRecorder = nullptr;
+
+void setCacheViewDrawRecorder(const CacheViewDrawRecorder* recorder)
+{
+    cacheViewDrawRecorder = recorder;
+}
+
+bool isCacheViewDrawRecording()
+{
+    return cacheViewDrawRecorder != nullptr;
+}
+
 CacheView2::CacheView2()
     : m_view(nullptr),
-      m_showTooltip(false)
+      m_showTooltip(false),
+      m_isDrawnByBatch(false)
 {
     // this constructor is required for QVector
     Q_ASSERT(false);
@@ -34,7 +48,8 @@ CacheView2::CacheView2()
 CacheView2::CacheView2(const View *view, const QRect &rect)
     : m_view(view),
       m_rect(rect),
-      m_showTooltip(false)
+      m_showTooltip(false),
+      m_isDrawnByBatch(false)
 {
     Q_ASSERT(m_view);
 }
@@ -43,10 +58,24 @@ CacheView2::CacheView2(const CacheView2& other)
     : m_view(other.m_view),
       m_rect(other.m_rect),
       m_showTooltip(other.m_showTooltip),
+      m_isDrawnByBatch(false),
+      m_drawData(other.m_drawData),
       m_subViews(other.m_subViews)
 {
 }
 
+CacheView2::CacheView2(CacheView2&& other) Q_DECL_NOEXCEPT
+    : m_view(other.m_view),
+      m_rect(other.m_rect),
+      m_showTooltip(other.m_showTooltip),
+      m_isDrawnByBatch(false),
+      m_drawData(std::move(other.m_drawData)),
+      m_drawProxy(other.m_drawProxy.take()),
+      m_tooltipCache(other.m_tooltipCache.take()),
+      m_subViews(std::move(other.m_subViews))
+{
+}
+
 CacheView2::~CacheView2()
 {
 }
@@ -56,16 +85,61 @@ CacheView2& CacheView2::operator=(const CacheView2& other)
     m_view =other.m_view;
     m_rect = other.m_rect;
     m_showTooltip = other.m_showTooltip;
+    m_drawData = other.m_drawData;
+    m_tooltipCache.reset();
     m_subViews= other.m_subViews;
     return *this;
 }
 
-void CacheView2::draw(QPainter* painter, const GuiContext &ctx, ID id, const QRect& itemRect, const QRect *visibleRect) const
+CacheView2& CacheView2::operator=(CacheView2&& other) Q_DECL_NOEXCEPT
+{
+    m_view = other.m_view;
+    m_rect = other.m_rect;
+    m_showTooltip = other.m_showTooltip;
+    m_drawData = std::move(other.m_drawData);
+    m_drawProxy.reset(other.m_drawProxy.take());
+    m_tooltipCache.reset(other.m_tooltipCache.take());
+    m_subViews = std::move(other.m_subViews);
+    return *this;
+}
+
+void CacheView2::setDrawProxy(DrawProxy drawProxy)
 {
     if (drawProxy)
-        drawProxy(this, painter, ctx, id, itemRect, visibleRect);
+        m_drawProxy.reset(new DrawProxy(std::move(drawProxy)));
+    else
+        m_drawProxy.reset();
+}
+
+void CacheView2::translate(const QPoint& offset)
+{
+    m_rect.translate(offset);
+
+    // leaf views don't detach sub-views
+    if (m_subViews.isEmpty())
+        return;
+
+    for (auto& cacheSubView: m_subViews)
+        cacheSubView.translate(offset);
+}
+
+void CacheView2::draw(QPainter* painter, const GuiContext &ctx, ID id, const QRect& itemRect, const QRect *visibleRect) const
+{
+    if (m_isDrawnByBatch)
+        return;
+
+    QElapsedTimer timer;
+    bool isRecorded = cacheViewDrawRecorder && m_subViews.isEmpty();
+    if (isRecorded)
+        timer.start();
+
+    if (m_drawProxy)
+        (*m_drawProxy)(this, painter, ctx, id, itemRect, visibleRect);
     else
         drawRaw(painter, ctx, id, itemRect, visibleRect);
+
+    if (isRecorded)
+        (*cacheViewDrawRecorder)(painter->transform().mapRect(m_rect), timer.nsecsElapsed());
 }
 
 void CacheView2::drawRaw(QPainter* painter, const GuiContext &ctx, ID id, const QRect& itemRect, const QRect *visibleRect) const
@@ -98,7 +172,21 @@ bool CacheView2::tooltipText(ID id, QString& tooltipText) const
     if (!m_showTooltip)
         return false;
 
-    return m_view->tooltipText(id, tooltipText);
+    quint64 contentVersion = m_view->contentVersion();
+    if (!m_tooltipCache || m_tooltipCache->id != id || m_tooltipCache->contentVersion != contentVersion)
+    {
+        if (!m_tooltipCache)
+            m_tooltipCache.reset(new TooltipCache());
+
+        m_tooltipCache->id = id;
+        m_tooltipCache->contentVersion = contentVersion;
+        m_tooltipCache->text.clear();
+        m_tooltipCache->hasText = m_view->tooltipText(id, m_tooltipCache->text);
+    }
+
+    if (m_tooltipCache->hasText)
+        tooltipText = m_tooltipCache->text;
+    return m_tooltipCache->hasText;
 }
 
 CacheView::CacheView(const CacheView* parent, QRect rect)
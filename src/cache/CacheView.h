@@ -20,6 +20,7 @@
 #include "core/ID.h"
 #include <QVector>
 #include <QPainter>
+#include <QScopedPointer>
 #include <functional>
 
 namespace Qi
@@ -28,15 +29,26 @@ namespace Qi
 class View;
 class GuiContext;
 
+// data prepared by view to draw faster next time
+class QI_EXPORT CacheViewDrawData
+{
+public:
+    virtual ~CacheViewDrawData() {}
+};
+
 class QI_EXPORT CacheView2
 {
 public:
     CacheView2();
     CacheView2(const View* view, const QRect& rect);
     CacheView2(const CacheView2& other);
+    // sub views are moved without copying, so QVector relocation and
+    // building of cache views trees don't touch sub views storage
+    CacheView2(CacheView2&& other) Q_DECL_NOEXCEPT;
     ~CacheView2();
 
     CacheView2& operator=(const CacheView2& other);
+    CacheView2& operator=(CacheView2&& other) Q_DECL_NOEXCEPT;
 
     const View* view() const { return m_view; }
     const QRect& rect() const { return m_rect; }
@@ -45,7 +57,19 @@ public:
     QVector<CacheView2>& rSubViews() { return m_subViews; }
     QRect& rRect() { return m_rect; }
 
-    std::function<void(const CacheView2*, QPainter*, const GuiContext&, ID, const QRect&, const QRect*)> drawProxy;
+    // offsets rects of this view and all sub-views
+    void translate(const QPoint& offset);
+
+    // view can keep data between draws, data should be validated by view
+    template <typename T>
+    T* drawData() const { return dynamic_cast<T*>(m_drawData.data()); }
+    void setDrawData(SharedPtr<CacheViewDrawData> drawData) const { m_drawData = std::move(drawData); }
+
+    typedef std::function<void(const CacheView2*, QPainter*, const GuiContext&, ID, const QRect&, const QRect*)> DrawProxy;
+    // replaces view drawing, it's rarely used (by animations) and stored out of line
+    // proxy is kept by moves only
+    bool hasDrawProxy() const { return !m_drawProxy.isNull(); }
+    void setDrawProxy(DrawProxy drawProxy);
 
     // draws view within m_rect
     void draw(QPainter* painter, const GuiContext &ctx, ID id, const QRect& itemRect, const QRect* visibleRect = nullptr) const;
@@ -53,7 +77,17 @@ public:
 
     void cleanupDraw(QPainter* painter, const GuiContext &ctx, ID id, const QRect& itemRect, const QRect* visibleRect = nullptr) const;
 
+    // draws by non-virtual view.drawDirect instead of View::draw (see ViewStatic)
+    // falls back to draw if view has draw proxy or draws are recorded
+    template <typename ViewT>
+    void drawDirect(const ViewT& view, QPainter* painter, const GuiContext &ctx, ID id, const QRect& itemRect, const QRect* visibleRect = nullptr) const;
+
+    // view is already drawn by batch pass (see View::drawBatch) and draw skips it
+    bool isDrawnByBatch() const { return m_isDrawnByBatch; }
+    void setDrawnByBatch(bool drawnByBatch) const { m_isDrawnByBatch = drawnByBatch; }
+
     // retruns tooltip text
+    // text is computed once per id and view content version
     bool tooltipText(ID id, QString& tooltipText) const;
 
     template <typename Pred>
@@ -90,10 +124,30 @@ protected:
     const View* m_view;
     QRect m_rect;
     mutable bool m_showTooltip;
+    mutable bool m_isDrawnByBatch;
+    mutable SharedPtr<CacheViewDrawData> m_drawData;
+    QScopedPointer<DrawProxy> m_drawProxy;
+
+    struct TooltipCache
+    {
+        ID id;
+        quint64 contentVersion;
+        bool hasText;
+        QString text;
+    };
+    // tooltips are rare, so cache is allocated on first request and kept by moves only
+    mutable QScopedPointer<TooltipCache> m_tooltipCache;
 
     QVector<CacheView2> m_subViews;
 };
 
+// receives draw durations (in nanoseconds) of cache views without sub views
+// and their rects in device coordinates, used by debug overlays
+// recorder is set around drawing in GUI thread, nullptr stops recording
+typedef std::function<void(const QRect& deviceRect, qint64 duration)> CacheViewDrawRecorder;
+QI_EXPORT void setCacheViewDrawRecorder(const CacheViewDrawRecorder* recorder);
+QI_EXPORT bool isCacheViewDrawRecording();
+
 class QI_EXPORT CacheContext
 {
 public:
@@ -111,6 +165,45 @@ public:
     }
 };
 
+template <typename ViewT>
+void CacheView2::drawDirect(const ViewT& view, QPainter* painter, const GuiContext &ctx, ID id, const QRect& itemRect, const QRect* visibleRect) const
+{
+    Q_ASSERT(m_view == &view);
+
+    if (m_isDrawnByBatch)
+        return;
+
+    if (m_drawProxy || (isCacheViewDrawRecording() && m_subViews.isEmpty()))
+    {
+        draw(painter, ctx, id, itemRect, visibleRect);
+        return;
+    }
+
+    m_showTooltip = false;
+    view.drawDirect(painter, ctx, CacheContext(id, itemRect, *this, visibleRect), &m_showTooltip);
+}
+
+// cache view of the item drawn by View::drawBatch
+class QI_EXPORT CacheViewBatchItem
+{
+public:
+    ID id;
+    QRect itemRect;
+    const CacheView2* cacheView;
+
+    CacheViewBatchItem()
+        : cacheView(nullptr)
+    {
+    }
+
+    CacheViewBatchItem(ID id, const QRect& itemRect, const CacheView2* cacheView)
+        : id(id),
+          itemRect(itemRect),
+          cacheView(cacheView)
+    {
+    }
+};
+
 class QI_EXPORT CacheView: public QObject
 {
     Q_OBJECT
@@ -18,10 +18,14 @@
 #define QI_ITEM_ID_H
 
 #include "QiAPI.h"
+#include <QHash>
 #include <array>
 #include <memory>
+#include <cstring>
+#include <type_traits>
 
-#if !defined(QT_NO_DEBUG)
+// type checks are debug only and can be disabled by QI_NO_CHECK_ID_TYPES
+#if !defined(QT_NO_DEBUG) && !defined(QI_NO_CHECK_ID_TYPES)
     #define QI_CHECK_ID_TYPES
 #endif
 
@@ -38,8 +42,8 @@ class QI_EXPORT ID
 {
 public:
     ID()
+        : m_data()
     {
-        Adopt(NoID());
     }
 
     template <typename T>
@@ -133,16 +137,21 @@ public:
         return m_data != other.m_data;
     }
 
+    uint hash(uint seed = 0) const
+    {
+        return QT_PREPEND_NAMESPACE(qHash)(m_data[0], seed) ^ QT_PREPEND_NAMESPACE(qHash)(m_data[1], seed + 1);
+    }
+
 protected:
     template <typename T>
     void CheckType() const
     {
-        static_assert(sizeof(T) <= sizeof(ID), "Should fit in size");
+        static_assert(sizeof(T) <= sizeof(Data), "Should fit in size");
         static_assert(std::is_standard_layout<T>::value, "Should be standard layout");
         static_assert(std::is_trivially_copyable<T>::value, "Should be trivial copyable");
         static_assert(std::is_trivially_destructible<T>::value, "Should be trivial destructable");
 #if defined(QI_CHECK_ID_TYPES)
-        Q_ASSERT(!m_typeHashCode || m_typeHashCode == typeid(T).hash_code());
+        Q_ASSERT(!m_typeHashCode || m_typeHashCode == TypeHashCode<T>());
 #endif
     }
 
@@ -158,25 +167,31 @@ protected:
     void Adopt(const T& other)
     {
         CheckType<T>();
-        m_data.fill(0);
         std::memcpy(&m_data.front(), &other, sizeof(T));
+        // clear only bytes after payload
+        if (sizeof(T) < sizeof(Data))
+            std::memset(reinterpret_cast<char*>(&m_data.front()) + sizeof(T), 0, sizeof(Data) - sizeof(T));
 
 #if defined(QI_CHECK_ID_TYPES)
-        if (typeid(T).hash_code() != typeid(NoID).hash_code())
-        {
-            m_typeHashCode = typeid(T).hash_code();
-            m_typeName = typeid(T).name();
-        }
-        else
-        {
-            m_typeHashCode = 0;
-            m_typeName = nullptr;
-        }
+        m_typeHashCode = TypeHashCode<T>();
+        m_typeName = m_typeHashCode ? typeid(T).name() : nullptr;
 #endif
     }
 
+#if defined(QI_CHECK_ID_TYPES)
+    template <typename T>
+    static size_t TypeHashCode()
+    {
+        // NoID has zero hash code
+        static const size_t hashCode = std::is_same<T, NoID>::value ? 0 : typeid(T).hash_code();
+        return hashCode;
+    }
+#endif
+
 private:
-    std::array<qintptr, 3> m_data;
+    // 16 bytes fit int, GridID or a couple of pointers
+    typedef std::array<quint64, 2> Data;
+    Data m_data;
 
 #if defined(QI_CHECK_ID_TYPES)
     size_t m_typeHashCode = 0;
@@ -184,6 +199,12 @@ private:
 #endif
 };
 
+// allows ID as a key of QHash and QSet
+inline uint qHash(const ID& id, uint seed = 0)
+{
+    return id.hash(seed);
+}
+
 inline int index(ID id)
 {
     return id.as<int>();
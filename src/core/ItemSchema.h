@@ -33,6 +33,20 @@ struct QI_EXPORT ViewSchema
         : layout(std::move(layout)),
           view(std::move(view))
     {}
+    ViewSchema(const ViewSchema&) = default;
+    ViewSchema(ViewSchema&&) = default;
+    ViewSchema& operator=(ViewSchema&&) = default;
+
+    // recycled cache items mostly get the same schema,
+    // so skip atomic reference counting for the same pointers
+    ViewSchema& operator=(const ViewSchema& other)
+    {
+        if (layout != other.layout)
+            layout = other.layout;
+        if (view != other.view)
+            view = other.view;
+        return *this;
+    }
 
     bool isValid() const { return layout && view; }
 };
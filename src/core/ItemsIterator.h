@@ -43,6 +43,18 @@ public:
 
     bool isValid() const { return isValidImpl(); }
 
+    // fills ids with up to count items from the current one and moves past them
+    // returns count of filled ids, 0 if iterator is not valid
+    // the common bulk usage is
+    // ID ids[IdIterator::BatchSize];
+    // for (cit.atFirst(); int n = cit.fetchIds(ids, IdIterator::BatchSize);)
+    // {
+    //    process(ids, n);
+    // }
+    int fetchIds(ID* ids, int count) { return fetchIdsImpl(ids, count); }
+
+    enum { BatchSize = 256 };
+
 protected:
     IdIterator() = default;
 
@@ -50,6 +62,14 @@ protected:
     virtual bool atFirstImpl() = 0;
     virtual bool toNextImpl() = 0;
     virtual bool isValidImpl() const = 0;
+    // calls idImpl and toNextImpl for each item by default
+    virtual int fetchIdsImpl(ID* ids, int count)
+    {
+        int fetched = 0;
+        for (; fetched < count && isValidImpl(); toNextImpl())
+            ids[fetched++] = idImpl();
+        return fetched;
+    }
 };
 
 /*
@@ -20,11 +20,53 @@
 namespace Qi
 {
 
+// views may be measured by worker threads (see calculateColumnsFitWidthParallel)
+// each thread counts its own requests
+static thread_local quint64 s_idDependentSizeRequests = 0;
+
 QSize Layout::ViewInfo::size() const
 {
+    return viewSize(view, ctx, id, sizeMode);
+}
+
+quint64 Layout::idDependentSizeRequests()
+{
+    return s_idDependentSizeRequests;
+}
+
+QSize Layout::viewSize(const View& view, const GuiContext& ctx, ID id, ViewSizeMode sizeMode)
+{
+    if (!view.isSizeUniform())
+        ++s_idDependentSizeRequests;
+
     return view.size(ctx, id, sizeMode);
 }
 
+void Layout::addListener(LayoutListener* listener)
+{
+    Q_ASSERT(listener);
+    Q_ASSERT(!m_listeners.contains(listener));
+    m_listeners.append(listener);
+}
+
+void Layout::removeListener(LayoutListener* listener)
+{
+    m_listeners.removeOne(listener);
+}
+
+void Layout::emitLayoutChanged(ChangeReason reason)
+{
+    // listeners may be removed during notification
+    const auto listeners = m_listeners;
+    for (auto listener : listeners)
+    {
+        if (m_listeners.contains(listener))
+            listener->onLayoutChanged(this, reason);
+    }
+
+    emit layoutChanged(this, reason);
+}
+
 bool Layout::doLayout(const View& view, const GuiContext& ctx, ID id, ViewSizeMode sizeMode, QRect& viewRect, QRect& itemRect, QRect* visibleItemRect) const
 {
     ViewInfo vi(view, ctx, id, sizeMode);
@@ -19,6 +19,7 @@
 
 #include "ID.h"
 #include <QRect>
+#include <QVector>
 
 namespace Qi
 {
@@ -34,6 +35,16 @@ enum LayoutBehavior
 };
 typedef quint16 LayoutBehaviorMask;
 
+class Layout;
+
+// lightweight alternative to layoutChanged signal connection
+class QI_EXPORT LayoutListener
+{
+public:
+    virtual ~LayoutListener() = default;
+    virtual void onLayoutChanged(const Layout* layout, ChangeReason reason) = 0;
+};
+
 // view layout interface
 class QI_EXPORT Layout: public QObject
 {
@@ -54,6 +65,17 @@ public:
     bool isTransparent() const { return m_behavior&LayoutBehaviorTransparent; }
     bool isFloat() const { return m_behavior&LayoutBehaviorFloat; }
 
+    // counter of size requests to views which size depends on item id made by the calling thread
+    // layout result is valid for other items if the counter is unchanged
+    static quint64 idDependentSizeRequests();
+    // size of the view requested by layout, counts requests to views which size depends on item id
+    // layouts performed without Layout objects request sizes by it (see ViewStaticSchema)
+    static QSize viewSize(const View& view, const GuiContext& ctx, ID id, ViewSizeMode sizeMode);
+
+    // listener should be removed before it's destroyed
+    void addListener(LayoutListener* listener);
+    void removeListener(LayoutListener* listener);
+
 signals:
     void layoutChanged(const Layout*, ChangeReason);
 
@@ -62,6 +84,9 @@ protected:
         : m_behavior(behavior)
     {}
 
+    // notifies listeners and emits layoutChanged
+    void emitLayoutChanged(ChangeReason reason);
+
     class QI_EXPORT ViewInfo
     {
     public:
@@ -97,6 +122,7 @@ protected:
 
 private:
     LayoutBehaviorMask m_behavior;
+    QVector<LayoutListener*> m_listeners;
 };
 
 QI_EXPORT SharedPtr<Layout> makeLayoutBackground();
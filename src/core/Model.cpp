@@ -19,7 +19,14 @@
 namespace Qi
 {
 
+// collected items above the limit are reported as whole model change
+static const int MaxPendingIds = 4096;
+
 Model::Model()
+    : m_version(0),
+      m_updateDepth(0),
+      m_pendingChanged(false),
+      m_pendingAllChanged(false)
 {
 }
 
@@ -27,6 +34,110 @@ Model::~Model()
 {
 }
 
+void Model::beginUpdate()
+{
+    ++m_updateDepth;
+}
+
+void Model::endUpdate()
+{
+    Q_ASSERT(m_updateDepth > 0);
+    if (m_updateDepth <= 0 || --m_updateDepth > 0)
+        return;
+
+    if (!m_pendingChanged)
+        return;
+
+    QVector<ID> ids;
+    ids.swap(m_pendingIds);
+    bool allChanged = m_pendingAllChanged;
+    m_pendingChanged = false;
+    m_pendingAllChanged = false;
+
+    if (!allChanged)
+    {
+        if (ids.size() == 1)
+            emit modelItemChanged(this, ids.first());
+        emit modelItemsChanged(this, ids);
+    }
+    emit modelChanged(this);
+}
+
+void Model::notifyItemChanged(ID id)
+{
+    ++m_version;
+    if (m_updateDepth == 0)
+    {
+        emit modelItemChanged(this, id);
+        emit modelChanged(this);
+        return;
+    }
+
+    m_pendingChanged = true;
+    if (m_pendingAllChanged)
+        return;
+
+    // repeated edits of the same item are common
+    if (!m_pendingIds.isEmpty() && m_pendingIds.last() == id)
+        return;
+
+    if (m_pendingIds.size() < MaxPendingIds)
+        m_pendingIds.append(id);
+    else
+        notifyChanged();
+}
+
+void Model::notifyChanged()
+{
+    ++m_version;
+    if (m_updateDepth == 0)
+    {
+        emit modelChanged(this);
+        return;
+    }
+
+    m_pendingChanged = true;
+    m_pendingAllChanged = true;
+    m_pendingIds.clear();
+}
+
+ModelSortKeysRanks::ModelSortKeysRanks(std::vector<std::pair<int, int>> keys, int ranksCount)
+    : m_keys(std::move(keys)),
+      m_ranksCount(ranksCount)
+{
+    Q_ASSERT(m_ranksCount > 0);
+}
+
+bool ModelSortKeysRanks::sortImpl(bool ascending, QVector<int>& lines, const std::function<bool(int)>& progress)
+{
+    // starts of ranks in sorted order
+    std::vector<int> starts(size_t(m_ranksCount) + 1, 0);
+    for (const auto& key : m_keys)
+    {
+        Q_ASSERT(key.first >= 0 && key.first < m_ranksCount);
+        int rank = ascending ? key.first : m_ranksCount - 1 - key.first;
+        ++starts[size_t(rank) + 1];
+    }
+
+    if (progress && !progress(50))
+        return false;
+
+    for (size_t i = 1; i < starts.size(); ++i)
+        starts[i] += starts[i - 1];
+
+    // equal keys keep their order
+    lines.resize(int(m_keys.size()));
+    for (const auto& key : m_keys)
+    {
+        int rank = ascending ? key.first : m_ranksCount - 1 - key.first;
+        lines[starts[size_t(rank)]++] = key.second;
+    }
+
+    if (progress)
+        progress(100);
+    return true;
+}
+
 ModelComparable::ModelComparable()
 {
 
@@ -37,4 +148,18 @@ ModelComparable::~ModelComparable()
 
 }
 
+SharedPtr<ModelSortKeys> ModelComparable::sortKeys(const QVector<int>& lines, const std::function<ID(int)>& lineToId) const
+{
+    int keysCount = ordinalKeysCount();
+    if (keysCount <= 0)
+        return sortKeysImpl(lines, lineToId);
+
+    std::vector<std::pair<int, int>> keys;
+    keys.reserve(lines.size());
+    for (int line : lines)
+        keys.emplace_back(qBound(0, ordinalKey(lineToId(line)), keysCount - 1), line);
+
+    return makeShared<ModelSortKeysRanks>(std::move(keys), keysCount);
+}
+
 } // end namespace Qi
@@ -18,6 +18,9 @@
 #define QI_MODEL_H
 
 #include "ID.h"
+#include <QVector>
+#include <functional>
+#include <vector>
 
 namespace Qi
 {
@@ -32,9 +35,84 @@ protected:
 
 public:
     virtual ~Model();
+
+    // postpones change signals until the outermost endUpdate
+    // and emits them once for all changes made in between
+    void beginUpdate();
+    void endUpdate();
+    bool isUpdating() const { return m_updateDepth > 0; }
+
+    // incremented by each change even during update, caches of values are valid while it's the same
+    quint64 version() const { return m_version; }
     
 signals:
     void modelChanged(const Model*);
+    // emitted before modelChanged if only one item was changed
+    void modelItemChanged(const Model*, ID id);
+    // emitted before modelChanged by endUpdate if only known items were changed
+    // ids may contain duplicates
+    void modelItemsChanged(const Model*, const QVector<ID>& ids);
+
+protected:
+    // emit change signals or collect them during update
+    void notifyItemChanged(ID id);
+    void notifyChanged();
+
+private:
+    quint64 m_version;
+    int m_updateDepth;
+    bool m_pendingChanged;
+    bool m_pendingAllChanged;
+    QVector<ID> m_pendingIds;
+};
+
+// calls beginUpdate/endUpdate in scope
+class ModelUpdateGuard
+{
+    Q_DISABLE_COPY(ModelUpdateGuard)
+
+public:
+    explicit ModelUpdateGuard(Model& model)
+        : m_model(model)
+    {
+        m_model.beginUpdate();
+    }
+
+    ~ModelUpdateGuard()
+    {
+        m_model.endUpdate();
+    }
+
+private:
+    Model& m_model;
+};
+
+// snapshot of model values to sort lines by them
+class QI_EXPORT ModelSortKeys
+{
+public:
+    virtual ~ModelSortKeys() {}
+
+    // stable sorts lines by keys, may be called once from any thread
+    // progress receives percents done and returns false to cancel sorting
+    bool sort(bool ascending, QVector<int>& lines, const std::function<bool(int)>& progress = nullptr) { return sortImpl(ascending, lines, progress); }
+
+protected:
+    virtual bool sortImpl(bool ascending, QVector<int>& lines, const std::function<bool(int)>& progress) = 0;
+};
+
+// keys are ranks in [0, ranksCount), sorted by stable counting sort in O(N + K)
+class QI_EXPORT ModelSortKeysRanks: public ModelSortKeys
+{
+public:
+    ModelSortKeysRanks(std::vector<std::pair<int, int>> keys, int ranksCount);
+
+protected:
+    bool sortImpl(bool ascending, QVector<int>& lines, const std::function<bool(int)>& progress) override;
+
+private:
+    std::vector<std::pair<int, int>> m_keys;
+    int m_ranksCount;
 };
 
 class QI_EXPORT ModelComparable: public Model
@@ -55,9 +133,32 @@ public:
 
     bool isAscendingDefault(ID item) const { return isAscendingDefaultImpl(item); }
 
+    // model can be compared from several threads simultaneously
+    bool isThreadSafe() const { return isThreadSafeImpl(); }
+
+    // model values are small integers in [0, ordinalKeysCount) ordered as compare does
+    // returns 0 if model doesn't have such keys
+    int ordinalKeysCount() const { return ordinalKeysCountImpl(); }
+    int ordinalKey(ID id) const { return ordinalKeyImpl(id); }
+
+    // makes snapshot of model values for lines (lineToId converts line to model id)
+    // ordinal keys are sorted by counting sort in O(N + K)
+    // returns nullptr if model doesn't support it and lines should be sorted by compare
+    SharedPtr<ModelSortKeys> sortKeys(const QVector<int>& lines, const std::function<ID(int)>& lineToId) const;
+    // stable sorts lines using sortKeys, returns false if model doesn't support it
+    bool sortLines(QVector<int>& lines, const std::function<ID(int)>& lineToId, bool ascending) const
+    {
+        auto keys = sortKeys(lines, lineToId);
+        return keys && keys->sort(ascending, lines);
+    }
+
 protected:
     virtual int compareImpl(ID left, ID right) const = 0;
     virtual bool isAscendingDefaultImpl(ID /*item*/) const { return true; }
+    virtual bool isThreadSafeImpl() const { return false; }
+    virtual SharedPtr<ModelSortKeys> sortKeysImpl(const QVector<int>& /*lines*/, const std::function<ID(int)>& /*lineToId*/) const { return SharedPtr<ModelSortKeys>(); }
+    virtual int ordinalKeysCountImpl() const { return 0; }
+    virtual int ordinalKeyImpl(ID /*id*/) const { return 0; }
 };
 
 } // end namespace Qi
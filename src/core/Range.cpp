@@ -19,4 +19,37 @@
 namespace Qi
 {
 
+void Range::addListener(RangeListener* listener)
+{
+    Q_ASSERT(listener);
+    Q_ASSERT(!m_listeners.contains(listener));
+    m_listeners.append(listener);
+}
+
+void Range::removeListener(RangeListener* listener)
+{
+    m_listeners.removeOne(listener);
+}
+
+void Range::emitRangeChanged(ChangeReason reason)
+{
+    ++m_version;
+
+    // listeners may be removed during notification
+    const auto listeners = m_listeners;
+    for (auto listener : listeners)
+    {
+        if (m_listeners.contains(listener))
+            listener->onRangeChanged(this, reason);
+    }
+
+    emitRangeChanged(reason);
+}
+
+void Range::hasItemsImpl(const ID* ids, bool* results, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        results[i] = hasItemImpl(ids[i]);
+}
+
 } // end namespace Qi
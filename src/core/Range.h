@@ -18,11 +18,32 @@
 #define QI_RANGE_H
 
 #include <QObject>
+#include <QVector>
 #include "ID.h"
 
 namespace Qi
 {
 
+enum RangeUniformityFlag
+{
+    RangeUniformNone = 0x0,
+    // grid items of a column are all in or out of the range
+    RangeUniformByColumn = 0x1,
+    // grid items of a row are all in or out of the range
+    RangeUniformByRow = 0x2,
+    RangeUniform = RangeUniformByColumn | RangeUniformByRow
+};
+
+class Range;
+
+// lightweight alternative to rangeChanged signal connection
+class QI_EXPORT RangeListener
+{
+public:
+    virtual ~RangeListener() = default;
+    virtual void onRangeChanged(const Range* range, ChangeReason reason) = 0;
+};
+
 class QI_EXPORT Range: public QObject
 {
     Q_OBJECT
@@ -32,6 +53,17 @@ public:
     virtual ~Range() = default;
 
     bool hasItem(ID id) const { return hasItemImpl(id); }
+    // batch version of hasItem, results should have count elements
+    void hasItems(const ID* ids, bool* results, int count) const { hasItemsImpl(ids, results, count); }
+    // RangeUniformityFlag combination, lets caches memoize items by column or row
+    int uniformity() const { return uniformityImpl(); }
+
+    // incremented before each rangeChanged, memos of items are valid while it's the same
+    quint64 version() const { return m_version; }
+
+    // listener should be removed before it's destroyed
+    void addListener(RangeListener* listener);
+    void removeListener(RangeListener* listener);
 
 signals:
     void rangeChanged(const Range*, ChangeReason);
@@ -39,8 +71,19 @@ signals:
 protected:
     Range() = default;
 
+    // notifies listeners and emits rangeChanged
+    void emitRangeChanged(ChangeReason reason);
+
     // should return true if item is included in the range and false otherwise
     virtual bool hasItemImpl(ID id) const = 0;
+    // calls hasItemImpl for each item by default
+    virtual void hasItemsImpl(const ID* ids, bool* results, int count) const;
+    // items are not uniform by default
+    virtual int uniformityImpl() const { return RangeUniformNone; }
+
+private:
+    quint64 m_version = 0;
+    QVector<RangeListener*> m_listeners;
 };
 
 } // end namespace Qi
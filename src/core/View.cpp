@@ -18,20 +18,51 @@
 #include "Layout.h"
 #include "core/ext/ControllerMouseMultiple.h"
 #include "core/ext/ControllerMousePushable.h"
+#include "utils/Trace.h"
+#include <QThread>
 
 namespace Qi
 {
 
+// maximal count of laid out memos per view
+static const int LayoutMemoLimit = 16;
+
+uint qHash(const View::LayoutMemoKey& key, uint seed)
+{
+    return qHash(qMakePair(quintptr(key.layout), quintptr(key.widget)), seed) ^ qHash(quintptr(key.style), seed)
+           ^ qHash(qMakePair(key.itemSize.width(), key.itemSize.height()), seed) ^ uint(key.isDraft);
+}
+
 View::View()
+    : m_contentVersion(0)
 {
+    // any view change can change layout
+    connect(this, &View::viewChanged, [this]() {
+        m_layoutMemo.clear();
+        m_uniformSizes.clear();
+    });
 }
 
 View::~View()
 {
 }
 
+SharedPtr<ControllerMouse> View::controller() const
+{
+    if (m_createController)
+    {
+        auto createController = std::move(m_createController);
+        m_createController = nullptr;
+        m_controller = createController();
+        emit const_cast<View*>(this)->controllerCreated(this);
+    }
+
+    return m_controller;
+}
+
 void View::setController(SharedPtr<ControllerMouse> controller)
 {
+    m_createController = nullptr;
     if (m_controller == controller)
         return;
 
@@ -39,9 +70,19 @@ void View::setController(SharedPtr<ControllerMouse> controller)
     emitViewChanged(ChangeReasonViewController);
 }
 
+void View::setControllerLazy(std::function<SharedPtr<ControllerMouse>()> createController)
+{
+    Q_ASSERT(createController);
+
+    m_controller.reset();
+    m_createController = std::move(createController);
+    emitViewChanged(ChangeReasonViewController);
+}
+
 void View::addController(SharedPtr<ControllerMouse> controller)
 {
-    if (!m_controller)
+    // lazy controller is needed to combine it
+    if (!this->controller())
     {
         setController(controller);
     }
@@ -63,12 +104,24 @@ void View::draw(QPainter* painter, const GuiContext& ctx, const CacheContext& ca
 {
     Q_ASSERT(cache.cacheView.view() == this);
 
+    // class name is static string
+    QI_TRACE_SCOPE(TraceCategoryView, metaObject()->className());
     drawImpl(painter, ctx, cache, showTooltip);
 
     if (showTooltip && tooltipTextCallback)
         *showTooltip = true;
 }
 
+void View::drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* visibleRect) const
+{
+    for (const auto& item : items)
+    {
+        CacheContext cache(item.id, item.itemRect, *item.cacheView, visibleRect);
+        draw(painter, ctx, cache, nullptr);
+        cleanupDraw(painter, ctx, cache);
+    }
+}
+
 bool View::tooltipText(ID id, QString& text) const
 {
     if (tooltipTextCallback)
@@ -79,9 +132,16 @@ bool View::tooltipText(ID id, QString& text) const
 
 void View::emitViewChanged(ChangeReason reason)
 {
+    ++m_contentVersion;
     emit viewChanged(this, reason);
 }
 
+void View::emitViewItemsChanged(const QVector<ID>& items)
+{
+    ++m_contentVersion;
+    emit viewItemsChanged(this, items);
+}
+
 void View::addViewImpl(ID /*id*/, QVector<const View*>& views) const
 {
     views.append(this);
@@ -93,8 +153,7 @@ CacheView2* View::addCacheViewImpl(const Layout& layout, const GuiContext& ctx,
     if (!layout.doLayout(*this, ctx, id, ViewSizeModeExact, viewRect, itemRect, visibleItemRect))
         return nullptr;
 
-    CacheView2 cacheView(this, viewRect);
-    cacheViews.append(cacheView);
+    cacheViews.append(CacheView2(this, viewRect));
     return &cacheViews.back();
 }
 
@@ -109,11 +168,72 @@ QSize View::sizeImpl(const GuiContext& /*ctx*/, ID /*id*/, ViewSizeMode /*sizeMo
     return QSize(0, 0);
 }
 
+// maximal count of styles and fonts to keep uniform sizes for
+static const int UniformSizesLimit = 8;
+
+QSize View::size(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const
+{
+    // uniform sizes are not synchronized, so worker threads measure views without them
+    if (!isSizeUniform() || thread() != QThread::currentThread())
+        return sizeImpl(ctx, id, sizeMode);
+
+    const QStyle* style = ctx.style();
+    const QFont& font = ctx.font();
+    for (const auto& uniformSize : m_uniformSizes)
+    {
+        if (uniformSize.style == style && uniformSize.sizeMode == sizeMode && uniformSize.font == font)
+            return uniformSize.size;
+    }
+
+    QSize size = sizeImpl(ctx, id, sizeMode);
+    if (m_uniformSizes.size() >= UniformSizesLimit)
+        m_uniformSizes.clear();
+    m_uniformSizes.append(UniformSize{style, font, sizeMode, size});
+    return size;
+}
+
+const CacheView2* View::layoutMemo(const Layout& layout, const GuiContext& ctx, QSize itemSize) const
+{
+    auto it = m_layoutMemo.constFind(layoutMemoKey(layout, ctx, itemSize));
+    return (it != m_layoutMemo.constEnd()) ? &it.value() : nullptr;
+}
+
+void View::setLayoutMemo(const Layout& layout, const GuiContext& ctx, QSize itemSize, const CacheView2& cacheView) const
+{
+    // many different sizes means item sizes vary and memo doesn't help
+    if (m_layoutMemo.size() >= LayoutMemoLimit)
+        m_layoutMemo.clear();
+
+    // new layout may get address of destroyed one
+    connect(&layout, &QObject::destroyed, this, &View::dropLayoutMemo, Qt::UniqueConnection);
+    connect(&layout, &Layout::layoutChanged, this, &View::dropLayoutMemo, Qt::UniqueConnection);
+
+    m_layoutMemo.insert(layoutMemoKey(layout, ctx, itemSize), cacheView);
+}
+
+View::LayoutMemoKey View::layoutMemoKey(const Layout& layout, const GuiContext& ctx, QSize itemSize)
+{
+    // laid out sizes depend on style and font as well
+    return LayoutMemoKey{&layout, ctx.widget, ctx.style(), ctx.font(), itemSize, ctx.isDraft()};
+}
+
+void View::dropLayoutMemo(const QObject* layout) const
+{
+    for (auto it = m_layoutMemo.begin(); it != m_layoutMemo.end(); )
+    {
+        if (it.key().layout == layout)
+            it = m_layoutMemo.erase(it);
+        else
+            ++it;
+    }
+}
+
 void View::setTooltipText(const QString& text)
 {
     tooltipTextCallback = [text] (ID /*id*/, QString& itemText) {
         itemText = text;
         return true;
     };
+    ++m_contentVersion;
 }
 } // end namespace Qi
@@ -20,6 +20,7 @@
 #include "core/misc/ViewAuxiliary.h"
 #include "cache/CacheView.h"
 #include <QPainter>
+#include <QHash>
 #include <functional>
 
 namespace Qi
@@ -38,27 +39,53 @@ public:
     View();
     virtual ~View();
 
-    SharedPtr<ControllerMouse> controller() const { return m_controller; }
+    // creates lazy controller on first request
+    SharedPtr<ControllerMouse> controller() const;
     void setController(SharedPtr<ControllerMouse> controller);
     void addController(SharedPtr<ControllerMouse> controller);
+    // controller is created by createController on first request (usually first activation)
+    void setControllerLazy(std::function<SharedPtr<ControllerMouse>()> createController);
+    // true if controller is set or will be created on request
+    bool hasController() const { return m_controller || m_createController; }
+    bool isControllerLazy() const { return bool(m_createController); }
 
     std::function<bool(ID id, QString& text)> tooltipTextCallback;
     void setTooltipText(const QString& text);
 
+    // incremented by view changes, texts cached by cache views are valid while it's the same
+    // call emitViewChanged after assigning tooltipTextCallback directly
+    quint64 contentVersion() const { return m_contentVersion; }
+
     // adds self to views
     void addView(ID id, QVector<const View*>& views) const
     { addViewImpl(id, views); }
 
     // adds self CacheView2 to cacheViews
     CacheView2* addCacheView(const Layout& layout, const GuiContext& ctx, ID id, QVector<CacheView2>& cacheViews, QRect& itemRect, QRect* visibleItemRect) const
-    { return addCacheViewImpl(layout, ctx, id, cacheViews, itemRect, visibleItemRect); }
+    { return (ctx.isDraft() && !isDrawnInDraft()) ? nullptr : addCacheViewImpl(layout, ctx, id, cacheViews, itemRect, visibleItemRect); }
+
+    // false for expensive views (images, style controls) which are skipped in draft rendering
+    bool isDrawnInDraft() const { return isDrawnInDraftImpl(); }
 
     SharedPtr<CacheView> createCacheView(const CacheView* parent, QRect rect, ID id, const GuiContext& ctx) const
     { return createCacheViewImpl(parent, rect, id, ctx); }
 
+    // called once rect of cacheView is assigned, view can prepare draw data (see CacheView2::setDrawData)
+    void prepareCacheView(const GuiContext& ctx, ID id, const CacheView2& cacheView) const
+    { prepareCacheViewImpl(ctx, id, cacheView); }
+
     // returns size of the view
-    QSize size(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const
-    { return sizeImpl(ctx, id, sizeMode); }
+    // uniform size is calculated once per widget style and font
+    QSize size(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const;
+    // true if size of the view doesn't depend on item id
+    bool isSizeUniform() const { return isSizeUniformImpl(); }
+    // true if cache views depend on item id through view sizes only
+    bool isCacheViewUniform() const { return isCacheViewUniformImpl(); }
+
+    // cache views laid out by layout within item of itemSize at (0, 0)
+    // memo is kept until viewChanged (see CacheItem::validateCacheView)
+    const CacheView2* layoutMemo(const Layout& layout, const GuiContext& ctx, QSize itemSize) const;
+    void setLayoutMemo(const Layout& layout, const GuiContext& ctx, QSize itemSize, const CacheView2& cacheView) const;
 
     // draws view content
     void draw(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const;
@@ -66,6 +93,18 @@ public:
     void cleanupDraw(QPainter* painter, const GuiContext& ctx, const CacheContext& cache) const
     { cleanupDrawImpl(painter, ctx, cache); }
 
+    // true if view can be drawn by drawBatch for many items at once
+    // such view neither depends on nor leaves painter state for other views,
+    // and draws all its sub views in order if it has them
+    bool isDrawBatchable() const { return isDrawBatchableImpl(); }
+    // draws view content of several items
+    void drawBatch(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* visibleRect) const
+    { drawBatchImpl(painter, ctx, items, visibleRect); }
+    // true if view can be drawn into QImage from a worker thread (see CacheSpaceGridTiles)
+    // such view reads thread safe models only, has no mutable draw state
+    // and draws neither QStyle controls nor pixmaps
+    bool isDrawThreadSafe() const { return isDrawThreadSafeImpl(); }
+
     // returns text representation of the view
     bool text(ID id, QString& txt) const { return textImpl(id, txt); }
     // returns tooltip text of the view
@@ -79,9 +118,15 @@ public:
 
     // emits viewChanged signal
     void emitViewChanged(ChangeReason reason);
+    // emits viewItemsChanged signal
+    void emitViewItemsChanged(const QVector<ID>& items);
 
 signals:
     void viewChanged(const View*, ChangeReason);
+    // emitted instead of viewChanged if only content of items was changed
+    void viewItemsChanged(const View*, const QVector<ID>& items);
+    // emitted when lazy controller is created, view is not changed by it
+    void controllerCreated(const View*);
 
 protected:
     // adds View to views
@@ -90,12 +135,22 @@ protected:
     virtual CacheView2* addCacheViewImpl(const Layout& layout, const GuiContext& ctx, ID id, QVector<CacheView2>& cacheViews, QRect& itemRect, QRect* visibleItemRect) const;
     // creates new cache view
     virtual SharedPtr<CacheView> createCacheViewImpl(const CacheView* parent, QRect rect, ID id, const GuiContext& ctx) const;
+    // prepares draw data after layout
+    virtual void prepareCacheViewImpl(const GuiContext& /*ctx*/, ID /*id*/, const CacheView2& /*cacheView*/) const { }
     // returns size of the view
     virtual QSize sizeImpl(const GuiContext& /*ctx*/, ID /*id*/, ViewSizeMode /*sizeMode*/) const;
+    virtual bool isSizeUniformImpl() const { return false; }
+    // views which add cache views depending on item id should return false
+    virtual bool isCacheViewUniformImpl() const { return true; }
     // draws view content
     virtual void drawImpl(QPainter* /*painter*/, const GuiContext& /*ctx*/, const CacheContext& /*cache*/, bool* /*showTooltip*/) const { }
     // cleanups drawing attributes
     virtual void cleanupDrawImpl(QPainter* /*painter*/, const GuiContext& /*ctx*/, const CacheContext& /*cache*/) const { }
+    virtual bool isDrawBatchableImpl() const { return false; }
+    virtual bool isDrawnInDraftImpl() const { return true; }
+    virtual bool isDrawThreadSafeImpl() const { return false; }
+    // draws items one by one by default
+    virtual void drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* visibleRect) const;
 
     // returns text representation of the view
     virtual bool textImpl(ID /*id*/, QString& /*txt*/) const { return false; }
@@ -130,7 +185,42 @@ protected:
     };
 
 private:
-    SharedPtr<ControllerMouse> m_controller;
+    mutable SharedPtr<ControllerMouse> m_controller;
+    mutable std::function<SharedPtr<ControllerMouse>()> m_createController;
+    quint64 m_contentVersion;
+
+    struct LayoutMemoKey
+    {
+        const Layout* layout;
+        const QWidget* widget;
+        const QStyle* style;
+        QFont font;
+        QSize itemSize;
+        bool isDraft;
+
+        bool operator==(const LayoutMemoKey& other) const
+        {
+            return layout == other.layout && widget == other.widget && style == other.style && itemSize == other.itemSize
+                   && isDraft == other.isDraft && font == other.font;
+        }
+    };
+    friend uint qHash(const LayoutMemoKey& key, uint seed);
+
+    static LayoutMemoKey layoutMemoKey(const Layout& layout, const GuiContext& ctx, QSize itemSize);
+    // drops memos of destroyed or changed layout
+    void dropLayoutMemo(const QObject* layout) const;
+
+    mutable QHash<LayoutMemoKey, CacheView2> m_layoutMemo;
+
+    struct UniformSize
+    {
+        const QStyle* style;
+        QFont font;
+        ViewSizeMode sizeMode;
+        QSize size;
+    };
+    // sizes of the view with isSizeUniform, used in the view thread only
+    mutable QVector<UniformSize> m_uniformSizes;
 };
 
 } // end namespace Qi
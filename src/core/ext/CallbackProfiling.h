@@ -0,0 +1,75 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_CALLBACK_PROFILING_H
+#define QI_CALLBACK_PROFILING_H
+
+#include "ModelCallback.h"
+#include "Ranges.h"
+#include "utils/Trace.h"
+
+namespace Qi
+{
+
+// wrap user callbacks to count their calls and time while Tracer is active,
+// counters are listed by Tracer::callbackStatistics under the name
+// and live as long as the wrapped callback, name should be static string
+// callbacks set after wrapping are not profiled
+
+template <typename T, bool ascendingDefault>
+SharedPtr<CallbackProfile> profileCallbacks(ModelCallback<T, ascendingDefault>& model, const char* name)
+{
+    Q_ASSERT(model.getValueFunction);
+
+    auto profile = makeShared<CallbackProfile>(name);
+    auto getValue = std::move(model.getValueFunction);
+    model.getValueFunction = [profile, getValue](ID id)->T {
+        CallbackProfileScope scope(*profile);
+        return getValue(id);
+    };
+    return profile;
+}
+
+inline SharedPtr<CallbackProfile> profileCallbacks(ModelCallbackComparable& model, const char* name)
+{
+    Q_ASSERT(model.compareFunction);
+
+    auto profile = makeShared<CallbackProfile>(name);
+    auto compare = std::move(model.compareFunction);
+    model.compareFunction = [profile, compare](const ID& left, const ID& right)->int {
+        CallbackProfileScope scope(*profile);
+        return compare(left, right);
+    };
+    return profile;
+}
+
+inline SharedPtr<CallbackProfile> profileCallbacks(RangeCallback& range, const char* name)
+{
+    Q_ASSERT(range.hasItemCallback);
+
+    auto profile = makeShared<CallbackProfile>(name);
+    auto hasItem = std::move(range.hasItemCallback);
+    range.hasItemCallback = [profile, hasItem](ID id)->bool {
+        CallbackProfileScope scope(*profile);
+        return hasItem(id);
+    };
+    return profile;
+}
+
+} // end namespace Qi
+
+#endif // QI_CALLBACK_PROFILING_H
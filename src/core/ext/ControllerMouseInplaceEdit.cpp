@@ -91,12 +91,12 @@ void ControllerMouseInplaceEdit::stopInplaceEditor()
     {
         // inconsistency
         Q_ASSERT(false);
+        return;
     }
 
     Q_ASSERT(inplaceEdit().current() == m_inplaceEditor);
 
-    disconnect(m_inplaceEditor, &QObject::destroyed, this, &ControllerMouseInplaceEdit::onInplaceEditorDestroyed);
-    onInplaceEditorDestroyed(m_inplaceEditor);
+    releaseInplaceEditor();
 
     inplaceEdit().stop();
 }
@@ -121,6 +121,7 @@ bool ControllerMouseInplaceEdit::startInplaceEditor(const QKeyEvent* keyEvent)
     }
 
     connect(m_inplaceEditor, &QObject::destroyed, this, &ControllerMouseInplaceEdit::onInplaceEditorDestroyed);
+    connect(&inplaceEdit(), &InplaceEdit::stopped, this, &ControllerMouseInplaceEdit::onInplaceEditorStopped);
 
     emit inplaceEditStarted(aState.id, m_inplaceEditor);
 
@@ -150,11 +151,27 @@ QRect ControllerMouseInplaceEdit::editorRect() const
     }
 }
 
+void ControllerMouseInplaceEdit::releaseInplaceEditor()
+{
+    Q_ASSERT(m_inplaceEditor);
+
+    // all editor signals to this controller including destroyed
+    m_inplaceEditor->disconnect(this);
+    onInplaceEditorDestroyed(m_inplaceEditor);
+}
+
+void ControllerMouseInplaceEdit::onInplaceEditorStopped(QWidget* editor)
+{
+    if (editor == m_inplaceEditor)
+        releaseInplaceEditor();
+}
+
 void ControllerMouseInplaceEdit::onInplaceEditorDestroyed(QObject* obj)
 {
     Q_UNUSED(obj);
     Q_ASSERT(m_inplaceEditor == obj);
     m_inplaceEditor = nullptr;
+    disconnect(&inplaceEdit(), &InplaceEdit::stopped, this, &ControllerMouseInplaceEdit::onInplaceEditorStopped);
 
     if (isCapturing())
         stopCapturing();
@@ -62,6 +62,9 @@ protected:
 private:
     bool startInplaceEditor(const QKeyEvent* keyEvent);
     QRect editorRect() const;
+    // disconnects from editor which may be reused by other controllers
+    void releaseInplaceEditor();
+    void onInplaceEditorStopped(QWidget* editor);
     void onInplaceEditorDestroyed(QObject* obj);
 
     bool m_editBySingleClick;
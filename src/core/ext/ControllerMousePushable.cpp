@@ -16,12 +16,14 @@
 
 #include "ControllerMousePushable.h"
 #include "core/View.h"
+#include "space/CacheSpace.h"
 
 namespace Qi
 {
 
 ControllerMousePushable::ControllerMousePushable(ControllerMousePriority priority, bool processDblClick)
-    : ControllerMouseCaptured(priority, processDblClick)
+    : ControllerMouseCaptured(priority, processDblClick),
+      m_pushState(MousePushStateNone)
 {
 }
 
@@ -39,6 +41,10 @@ void ControllerMousePushable::setPushState(MousePushState pushState)
     {
         m_pushState = pushState;
         emit pushStateChanged(this);
+
+        // repaint view only instead of whole item
+        if (m_cacheSpace)
+            m_cacheSpace->updateWindowRect(m_viewRect);
     }
 }
 
@@ -64,6 +70,8 @@ void ControllerMousePushable::stopCapturingImpl()
 void ControllerMousePushable::activateImpl(const ActivationInfo& activationInfo)
 {
     ControllerMouseCaptured::activateImpl(activationInfo);
+    m_cacheSpace = &activationInfo.cacheSpace;
+    m_viewRect = activationInfo.cache.cacheView.rect();
     updatePushState();
 }
 
@@ -97,20 +105,21 @@ PushableTracker::PushableTracker(View* owner)
     m_viewConnection = QObject::connect(m_owner.data(), &View::viewChanged, [this](const View* view, ChangeReason changeReason){
         onViewChanged(view, changeReason);
     });
+    m_controllerCreatedConnection = QObject::connect(m_owner.data(), &View::controllerCreated, [this](const View* view){
+        attachController(view);
+    });
 }
 
 PushableTracker::~PushableTracker()
 {
     QObject::disconnect(m_controllerConnection);
     QObject::disconnect(m_viewConnection);
+    QObject::disconnect(m_controllerCreatedConnection);
 }
 
 MousePushState PushableTracker::pushStateByItem(ID id) const
 {
-    if (!m_controller)
-        return MousePushStateNone;
-
-    return m_controller->pushStateByItem(id);
+    return m_pushStates.value(id, MousePushStateNone);
 }
 
 QStyle::State PushableTracker::styleStateByItem(ID id) const
@@ -130,18 +139,26 @@ void PushableTracker::onViewChanged(const View* view, ChangeReason changeReason)
 {
     Q_ASSERT(view == m_owner.data());
     if (changeReason & ChangeReasonViewController)
+        attachController(view);
+}
+
+void PushableTracker::attachController(const View* view)
+{
+    QObject::disconnect(m_controllerConnection);
+    m_controller = nullptr;
+    m_pushStates.clear();
+
+    // lazy controller is attached when it's created
+    if (view->isControllerLazy())
+        return;
+
+    auto controllerPushable = view->controller().objectCast<ControllerMousePushable>();
+    if (controllerPushable)
     {
-        QObject::disconnect(m_controllerConnection);
-        m_controller = nullptr;
-
-        auto controllerPushable = view->controller().objectCast<ControllerMousePushable>();
-        if (controllerPushable)
-        {
-            m_controller = controllerPushable.data();
-            m_controllerConnection = QObject::connect(controllerPushable.data(), &ControllerMousePushable::pushStateChanged, [this](const ControllerMousePushable* controllerPushable) {
-                onPushStateChanged(controllerPushable);
-            });
-        }
+        m_controller = controllerPushable.data();
+        m_controllerConnection = QObject::connect(controllerPushable.data(), &ControllerMousePushable::pushStateChanged, [this](const ControllerMousePushable* controllerPushable) {
+            onPushStateChanged(controllerPushable);
+        });
     }
 }
 
@@ -149,7 +166,13 @@ void PushableTracker::onPushStateChanged(const ControllerMousePushable* controll
 {
     Q_UNUSED(controllerPushable);
     Q_ASSERT(controllerPushable == m_controller.data());
-    m_owner->emitViewChanged(ChangeReasonViewContent);
+
+    // controller repaints its view, only states are tracked here
+    m_pushStates.clear();
+
+    auto activeId = m_controller->activeId();
+    if (activeId && m_controller->pushState() != MousePushStateNone)
+        m_pushStates.insert(*activeId, m_controller->pushState());
 }
 
 
@@ -19,11 +19,13 @@
 
 #include "ControllerMouseCaptured.h"
 #include <QStyle>
+#include <QHash>
 
 namespace Qi
 {
 
 class View;
+class CacheSpace;
 
 enum MousePushState
 {
@@ -59,6 +61,9 @@ private:
     void updatePushState();
 
     MousePushState m_pushState;
+    // view of active item is repainted on push state changes
+    QPointer<const CacheSpace> m_cacheSpace;
+    QRect m_viewRect;
 };
 
 class QI_EXPORT PushableTracker
@@ -75,12 +80,16 @@ public:
 private:
     void onViewChanged(const View* view, ChangeReason changeReason);
     void onPushStateChanged(const ControllerMousePushable*controllerPushable);
+    void attachController(const View* view);
 
     QPointer<View> m_owner;
     QMetaObject::Connection m_viewConnection;
+    QMetaObject::Connection m_controllerCreatedConnection;
 
     QPointer<ControllerMousePushable> m_controller;
     QMetaObject::Connection m_controllerConnection;
+    // items with not MousePushStateNone state
+    QHash<ID, MousePushState> m_pushStates;
 };
 
 } // end namespace Qi
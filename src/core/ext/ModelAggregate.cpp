@@ -0,0 +1,311 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "ModelAggregate.h"
+
+namespace Qi
+{
+
+ColumnAggregates::ColumnAggregates(SharedPtr<Model> model, int column, SharedPtr<Lines> rows, std::function<double(int)> value)
+    : m_model(std::move(model)),
+      m_column(column),
+      m_rows(std::move(rows)),
+      m_value(std::move(value)),
+      m_insertedRow(InvalidIndex),
+      m_insertedCount(0),
+      m_sum(0.),
+      m_count(0),
+      m_min(0.),
+      m_max(0.),
+      m_isMinMaxValid(true),
+      m_itemsUpdated(false)
+{
+    Q_ASSERT(m_model);
+    Q_ASSERT(m_rows);
+    Q_ASSERT(m_value);
+
+    connect(m_model.data(), &Model::modelItemChanged, this, [this](const Model*, ID id) {
+        onModelItemsChanged(QVector<ID>(1, id));
+    });
+    connect(m_model.data(), &Model::modelItemsChanged, this, [this](const Model*, const QVector<ID>& ids) {
+        onModelItemsChanged(ids);
+    });
+    connect(m_model.data(), &Model::modelChanged, this, &ColumnAggregates::onModelChanged);
+
+    connect(m_rows.data(), &Lines::linesChanged, this, &ColumnAggregates::onRowsChanged);
+    connect(m_rows.data(), &Lines::linesInserted, this, &ColumnAggregates::onRowsInserted);
+    connect(m_rows.data(), &Lines::linesRemoved, this, &ColumnAggregates::onRowsRemoved);
+
+    reload();
+}
+
+ColumnAggregates::~ColumnAggregates()
+{
+}
+
+double ColumnAggregates::min() const
+{
+    validateMinMax();
+    return m_min;
+}
+
+double ColumnAggregates::max() const
+{
+    validateMinMax();
+    return m_max;
+}
+
+double ColumnAggregates::value(AggregateType type) const
+{
+    switch (type)
+    {
+    case AggregateSum:
+        return sum();
+    case AggregateCount:
+        return count();
+    case AggregateMin:
+        return min();
+    case AggregateMax:
+        return max();
+    case AggregateMean:
+        return mean();
+    }
+
+    Q_ASSERT(false);
+    return 0.;
+}
+
+void ColumnAggregates::reload()
+{
+    int rowsCount = m_rows->count();
+    m_values.resize(rowsCount);
+    m_included.fill(false, rowsCount);
+    m_insertedRow = InvalidIndex;
+    m_insertedCount = 0;
+
+    m_sum = 0.;
+    m_count = 0;
+    m_isMinMaxValid = false;
+
+    for (int row = 0; row < rowsCount; ++row)
+    {
+        m_values[row] = m_value(row);
+        if (m_rows->isLineVisible(row))
+        {
+            m_included.setValue(row, true);
+            m_sum += m_values[row];
+            ++m_count;
+        }
+    }
+
+    emit aggregatesChanged(this);
+}
+
+void ColumnAggregates::onModelItemsChanged(const QVector<ID>& ids)
+{
+    m_itemsUpdated = true;
+
+    // modelItemChanged and modelItemsChanged report the same single item
+    bool isChanged = false;
+    for (const auto& item : ids)
+    {
+        const auto& id = item.as<GridID>();
+        if (id.column != m_column || id.row < 0 || id.row >= m_values.size())
+            continue;
+
+        double oldValue = m_values[id.row];
+        double newValue = m_value(id.row);
+        if (oldValue == newValue)
+            continue;
+
+        m_values[id.row] = newValue;
+        if (!m_included.value(id.row))
+            continue;
+
+        exclude(oldValue);
+        include(newValue);
+        isChanged = true;
+    }
+
+    if (isChanged)
+        emit aggregatesChanged(this);
+}
+
+void ColumnAggregates::onModelChanged()
+{
+    // aggregates were updated by item signals
+    if (m_itemsUpdated)
+    {
+        m_itemsUpdated = false;
+        return;
+    }
+
+    reload();
+}
+
+void ColumnAggregates::onRowsChanged(const Lines* /*rows*/, ChangeReason reason)
+{
+    if (!(reason & (ChangeReasonLinesCount | ChangeReasonLinesVisibility)))
+        return;
+
+    if (m_values.size() != m_rows->count())
+    {
+        // resized without inserted or removed notifications
+        reload();
+        return;
+    }
+
+    for (int i = 0; i < m_insertedCount; ++i)
+        updateValue(m_insertedRow + i);
+    m_insertedRow = InvalidIndex;
+    m_insertedCount = 0;
+
+    if (updateIncluded())
+        emit aggregatesChanged(this);
+}
+
+void ColumnAggregates::onRowsInserted(const Lines* /*rows*/, int row, int rowsCount)
+{
+    m_values.insert(row, rowsCount, 0.);
+    m_included.insert(row, rowsCount, false);
+    m_insertedRow = row;
+    m_insertedCount = rowsCount;
+}
+
+void ColumnAggregates::onRowsRemoved(const Lines* /*rows*/, int row, int rowsCount)
+{
+    for (int i = row; i < row + rowsCount; ++i)
+    {
+        if (m_included.value(i))
+            exclude(m_values[i]);
+    }
+
+    m_values.remove(row, rowsCount);
+    m_included.remove(row, rowsCount);
+}
+
+void ColumnAggregates::updateValue(int row)
+{
+    Q_ASSERT(!m_included.value(row));
+    m_values[row] = m_value(row);
+}
+
+bool ColumnAggregates::updateIncluded()
+{
+    bool isChanged = false;
+    for (int row = 0, rowsCount = m_values.size(); row < rowsCount; ++row)
+    {
+        bool isVisible = m_rows->isLineVisible(row);
+        if (isVisible == m_included.value(row))
+            continue;
+
+        m_included.setValue(row, isVisible);
+        if (isVisible)
+            include(m_values[row]);
+        else
+            exclude(m_values[row]);
+        isChanged = true;
+    }
+
+    return isChanged;
+}
+
+void ColumnAggregates::include(double value)
+{
+    m_sum += value;
+    ++m_count;
+
+    if (!m_isMinMaxValid)
+        return;
+
+    if (m_count == 1)
+    {
+        m_min = value;
+        m_max = value;
+    }
+    else
+    {
+        m_min = qMin(m_min, value);
+        m_max = qMax(m_max, value);
+    }
+}
+
+void ColumnAggregates::exclude(double value)
+{
+    Q_ASSERT(m_count > 0);
+    m_sum -= value;
+    --m_count;
+
+    // keep sum exact when all rows are excluded
+    if (m_count == 0)
+        m_sum = 0.;
+
+    if (m_isMinMaxValid && (value == m_min || value == m_max))
+        m_isMinMaxValid = false;
+}
+
+void ColumnAggregates::validateMinMax() const
+{
+    if (m_isMinMaxValid)
+        return;
+
+    m_min = 0.;
+    m_max = 0.;
+    bool isFirst = true;
+    for (int row = 0, rowsCount = m_values.size(); row < rowsCount; ++row)
+    {
+        if (!m_included.value(row))
+            continue;
+
+        double value = m_values[row];
+        if (isFirst)
+        {
+            m_min = value;
+            m_max = value;
+            isFirst = false;
+        }
+        else
+        {
+            m_min = qMin(m_min, value);
+            m_max = qMax(m_max, value);
+        }
+    }
+
+    m_isMinMaxValid = true;
+}
+
+ModelAggregate::ModelAggregate(SharedPtr<ColumnAggregates> aggregates, AggregateType type)
+    : m_aggregates(std::move(aggregates)),
+      m_type(type)
+{
+    Q_ASSERT(m_aggregates);
+    connect(m_aggregates.data(), &ColumnAggregates::aggregatesChanged, this, [this](const ColumnAggregates*) {
+        notifyChanged();
+    });
+}
+
+double ModelAggregate::valueImpl(ID /*id*/) const
+{
+    return m_aggregates->value(m_type);
+}
+
+bool ModelAggregate::setValueImpl(ID /*id*/, double /*value*/)
+{
+    return false;
+}
+
+} // end namespace Qi
@@ -0,0 +1,143 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_MODEL_AGGREGATE_H
+#define QI_MODEL_AGGREGATE_H
+
+#include "ModelTyped.h"
+#include "space/grid/Lines.h"
+#include "utils/BitVector.h"
+#include <functional>
+#include <limits>
+
+namespace Qi
+{
+
+enum AggregateType
+{
+    AggregateSum,
+    AggregateCount,
+    AggregateMin,
+    AggregateMax,
+    AggregateMean
+};
+
+// aggregates values of the model column over visible rows
+// source item notifications update aggregates by value differences,
+// rows visibility changes rescan cached values without source calls
+class QI_EXPORT ColumnAggregates: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ColumnAggregates)
+
+public:
+    template <typename T>
+    ColumnAggregates(const SharedPtr<ModelTyped<T>>& model, int column, SharedPtr<Lines> rows)
+        : ColumnAggregates(model, column, std::move(rows), [model, column](int row) {
+              return double(model->value(ID(GridID(row, column))));
+          })
+    {
+        static_assert(std::numeric_limits<T>::is_specialized, "T should be numeric.");
+    }
+    ~ColumnAggregates();
+
+    const SharedPtr<Lines>& rows() const { return m_rows; }
+    int column() const { return m_column; }
+
+    // values are 0 if there are no visible rows
+    double sum() const { return m_sum; }
+    int count() const { return m_count; }
+    double min() const;
+    double max() const;
+    double mean() const { return m_count ? m_sum / m_count : 0.; }
+    double value(AggregateType type) const;
+
+    // reloads all values from the source model
+    void reload();
+
+signals:
+    void aggregatesChanged(const ColumnAggregates* aggregates);
+
+private:
+    ColumnAggregates(SharedPtr<Model> model, int column, SharedPtr<Lines> rows, std::function<double(int)> value);
+
+    void onModelItemsChanged(const QVector<ID>& ids);
+    void onModelChanged();
+    void onRowsChanged(const Lines* rows, ChangeReason reason);
+    void onRowsInserted(const Lines* rows, int row, int rowsCount);
+    void onRowsRemoved(const Lines* rows, int row, int rowsCount);
+    void updateValue(int row);
+
+    // includes visible and excludes hidden rows
+    bool updateIncluded();
+    void include(double value);
+    void exclude(double value);
+    void validateMinMax() const;
+
+    SharedPtr<Model> m_model;
+    int m_column;
+    SharedPtr<Lines> m_rows;
+    std::function<double(int)> m_value;
+
+    // values of all rows and rows included in aggregates
+    QVector<double> m_values;
+    BitVector m_included;
+    // rows inserted before linesChanged, their values are read after source is resized
+    int m_insertedRow;
+    int m_insertedCount;
+
+    double m_sum;
+    int m_count;
+    // min and max are recalculated lazily once extreme value is excluded
+    mutable double m_min;
+    mutable double m_max;
+    mutable bool m_isMinMaxValid;
+
+    // items were reported before modelChanged
+    bool m_itemsUpdated;
+};
+
+// represents aggregate value for any item, intended for footer grids
+class QI_EXPORT ModelAggregate: public ModelTyped<double>
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ModelAggregate)
+
+public:
+    ModelAggregate(SharedPtr<ColumnAggregates> aggregates, AggregateType type);
+
+    const SharedPtr<ColumnAggregates>& aggregates() const { return m_aggregates; }
+    AggregateType type() const { return m_type; }
+
+protected:
+    double valueImpl(ID id) const override;
+    bool setValueImpl(ID id, double value) override;
+
+private:
+    SharedPtr<ColumnAggregates> m_aggregates;
+    AggregateType m_type;
+};
+
+template <typename T>
+SharedPtr<ColumnAggregates> makeColumnAggregates(const SharedPtr<ModelTyped<T>>& model, int column, SharedPtr<Lines> rows)
+{
+    return makeShared<ColumnAggregates>(model, column, std::move(rows));
+}
+
+} // end namespace Qi
+
+#endif // QI_MODEL_AGGREGATE_H
@@ -18,6 +18,7 @@
 #define QI_MODEL_CONVERSION_H
 
 #include "ModelTyped.h"
+#include "ModelValuesCache.h"
 #include <functional>
 
 namespace Qi
@@ -27,18 +28,26 @@ template <typename Source_t, typename Target_t>
 class ModelConversion: public ModelTyped<Target_t>
 {
 public:
-    ModelConversion(const makeShared<ModelTyped<Source_t>>& sourceModel, bool compareBySource = true)
+    typedef typename ModelTyped<Target_t>::ValueType_t ValueType_t;
+
+    ModelConversion(const SharedPtr<ModelTyped<Source_t>>& sourceModel, bool compareBySource = true)
         : m_sourceModel(sourceModel),
           m_compareBySource(compareBySource)
     {
         Q_ASSERT(m_sourceModel);
+        m_cache.connectSource(m_sourceModel.data(), this, [this](ID id) { this->notifyItemChanged(id); }, [this]() { this->notifyChanged(); });
     }
 
     std::function<Target_t(Source_t)> s2tFunction;
     std::function<Source_t(Target_t)> t2sFunction;
 
+    // keeps converted values until source model changes them
+    // s2tFunction should be changed before caching is enabled
+    bool isCaching() const { return m_cache.isEnabled(); }
+    void setCaching(bool isCaching) { m_cache.setEnabled(isCaching); }
+
 protected:
-    int compareImpl(const ID& left, const ID& right) const override
+    int compareImpl(ID left, ID right) const override
     {
         if (m_compareBySource)
             return m_sourceModel->compare(left, right);
@@ -49,20 +58,47 @@ protected:
     bool isAscendingDefaultImpl(ID id) const override
     {
         if (m_compareBySource)
-            return m_sourceModel->isAscendingDefault(item);
+            return m_sourceModel->isAscendingDefault(id);
+        else
+            return ModelTyped<Target_t>::isAscendingDefaultImpl(id);
+    }
+
+    SharedPtr<ModelSortKeys> sortKeysImpl(const QVector<int>& lines, const std::function<ID(int)>& lineToId) const override
+    {
+        // sort by raw source values without conversion
+        if (m_compareBySource)
+            return m_sourceModel->sortKeys(lines, lineToId);
+        else
+            return ModelTyped<Target_t>::sortKeysImpl(lines, lineToId);
+    }
+
+    int ordinalKeysCountImpl() const override
+    {
+        if (m_compareBySource)
+            return m_sourceModel->ordinalKeysCount();
+        else
+            return ModelTyped<Target_t>::ordinalKeysCountImpl();
+    }
+
+    int ordinalKeyImpl(ID id) const override
+    {
+        if (m_compareBySource)
+            return m_sourceModel->ordinalKey(id);
         else
-            return ModelTyped<Target_t>::isAscendingDefaultImpl(item);
+            return ModelTyped<Target_t>::ordinalKeyImpl(id);
     }
 
     Target_t valueImpl(ID id) const override
     {
-        return s2tFunction(m_sourceModel->value(item));
+        return m_cache.value(id, [this](ID itemId) {
+            return s2tFunction(m_sourceModel->value(itemId));
+        });
     }
 
     bool setValueImpl(ID id, Target_t value) override
     {
         if (t2sFunction)
-            return m_sourceModel->setValue(item, t2sFunction(value));
+            return m_sourceModel->setValue(id, t2sFunction(value));
         else
             return false;
     }
@@ -76,8 +112,9 @@ protected:
     }
 
 private:
-    makeShared<ModelTyped<Source_t>> m_sourceModel;
+    SharedPtr<ModelTyped<Source_t>> m_sourceModel;
     bool m_compareBySource;
+    ModelValuesCache<typename std::decay<Target_t>::type> m_cache;
 };
 
 } // end namespace Qi
@@ -0,0 +1,75 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "ModelFeed.h"
+#include <QTimer>
+
+namespace Qi
+{
+
+// about one frame of 60 fps
+static const int DefaultDrainInterval = 16;
+
+ModelFeedBase::ModelFeedBase()
+    : m_drainScheduled(false),
+      m_drainInterval(DefaultDrainInterval),
+      m_drainTimer(new QTimer(this))
+{
+    m_drainTimer->setSingleShot(true);
+    connect(m_drainTimer, &QTimer::timeout, this, &ModelFeedBase::drain);
+}
+
+ModelFeedBase::~ModelFeedBase()
+{
+}
+
+void ModelFeedBase::setDrainInterval(int msec)
+{
+    m_drainInterval = qMax(0, msec);
+}
+
+void ModelFeedBase::drain()
+{
+    m_drainTimer->stop();
+
+    // updates pushed from now on will request another drain
+    m_drainScheduled.store(false);
+
+    drainImpl();
+    m_lastDrain.restart();
+}
+
+void ModelFeedBase::scheduleDrain()
+{
+    if (m_drainScheduled.exchange(true))
+        return;
+
+    QMetaObject::invokeMethod(this, "onDrainRequested", Qt::QueuedConnection);
+}
+
+void ModelFeedBase::onDrainRequested()
+{
+    if (m_drainTimer->isActive())
+        return;
+
+    qint64 elapsed = m_lastDrain.isValid() ? m_lastDrain.elapsed() : m_drainInterval;
+    if (elapsed < m_drainInterval)
+        m_drainTimer->start(int(m_drainInterval - elapsed));
+    else
+        drain();
+}
+
+} // end namespace Qi
@@ -0,0 +1,135 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_MODEL_FEED_H
+#define QI_MODEL_FEED_H
+
+#include "ModelTyped.h"
+#include "utils/LockFreeQueue.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <atomic>
+
+class QTimer;
+
+namespace Qi
+{
+
+// applies updates posted from any thread to a model in GUI thread
+class QI_EXPORT ModelFeedBase: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ModelFeedBase)
+
+public:
+    virtual ~ModelFeedBase();
+
+    // minimal interval between drains in milliseconds
+    // default interval is one frame
+    int drainInterval() const { return m_drainInterval; }
+    void setDrainInterval(int msec);
+
+    // applies queued updates right now, GUI thread only
+    void drain();
+
+protected:
+    ModelFeedBase();
+
+    // requests drain in GUI thread, can be called from any thread
+    void scheduleDrain();
+
+    virtual void drainImpl() = 0;
+
+private slots:
+    void onDrainRequested();
+
+private:
+    std::atomic<bool> m_drainScheduled;
+    int m_drainInterval;
+    QTimer* m_drainTimer;
+    QElapsedTimer m_lastDrain;
+};
+
+// collects (ID, value) updates from worker threads without locks
+// and sets them to the model in batches, latest value of an item wins
+template <typename T>
+class ModelFeed: public ModelFeedBase
+{
+public:
+    typedef typename std::decay<T>::type Value_t;
+
+    ModelFeed(SharedPtr<ModelTyped<T>> model, int capacity = 65536)
+        : m_model(std::move(model)),
+          m_queue(capacity)
+    {
+        Q_ASSERT(m_model);
+    }
+
+    const SharedPtr<ModelTyped<T>>& model() const { return m_model; }
+
+    // can be called from any thread
+    // returns false if queue is full and update is dropped
+    bool push(ID id, Value_t value)
+    {
+        if (!m_queue.push(Update(id, std::move(value))))
+            return false;
+
+        scheduleDrain();
+        return true;
+    }
+
+protected:
+    void drainImpl() override
+    {
+        const int capacity = m_queue.capacity();
+
+        // take no more than one queue of updates to not block GUI forever
+        QVector<Update> updates;
+        Update update;
+        while (updates.size() < capacity && m_queue.pop(update))
+            updates.append(std::move(update));
+
+        if (updates.isEmpty())
+            return;
+
+        if (updates.size() == capacity)
+            scheduleDrain();
+
+        // index of the latest update of each item
+        QHash<ID, int> latest;
+        latest.reserve(updates.size());
+        for (int i = 0; i < updates.size(); ++i)
+            latest[updates[i].first] = i;
+
+        // single notification for all updates
+        ModelUpdateGuard guard(*m_model);
+        for (int i = 0; i < updates.size(); ++i)
+        {
+            if (latest.value(updates[i].first) == i)
+                m_model->setValue(updates[i].first, updates[i].second);
+        }
+    }
+
+private:
+    typedef std::pair<ID, Value_t> Update;
+
+    SharedPtr<ModelTyped<T>> m_model;
+    LockFreeQueue<Update> m_queue;
+};
+
+} // end namespace Qi
+
+#endif // QI_MODEL_FEED_H
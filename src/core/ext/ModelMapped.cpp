@@ -0,0 +1,197 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "ModelMapped.h"
+#include <QtEndian>
+#include <limits>
+
+namespace Qi
+{
+
+static const char MappedColumnsMagic[4] = { 'Q', 'I', 'M', 'C' };
+static const quint32 MappedColumnsVersion = 1;
+static const qint64 MappedHeaderSize = 24;
+static const qint64 MappedColumnEntrySize = 32;
+
+MappedColumns::MappedColumns(const QString& fileName)
+    : m_file(fileName),
+      m_data(nullptr),
+      m_rowsCount(0)
+{
+    open();
+}
+
+MappedColumns::~MappedColumns()
+{
+    if (m_data)
+        m_file.unmap(const_cast<uchar*>(m_data));
+}
+
+MappedColumns::ColumnType MappedColumns::columnType(int column) const
+{
+    if (column < 0 || column >= m_columns.size())
+        return ColumnInvalid;
+    return m_columns[column].type;
+}
+
+qint64 MappedColumns::integerValue(int row, int column) const
+{
+    Q_ASSERT(isInside(row, column));
+    const Column& c = m_columns[column];
+
+    switch (c.type)
+    {
+    case ColumnInt32:
+        return qFromLittleEndian(read<qint32>(c.data + qint64(row) * 4));
+    case ColumnInt64:
+        return qFromLittleEndian(read<qint64>(c.data + qint64(row) * 8));
+    case ColumnDouble:
+        return qint64(doubleValue(row, column));
+    default:
+        return 0;
+    }
+}
+
+double MappedColumns::doubleValue(int row, int column) const
+{
+    Q_ASSERT(isInside(row, column));
+    const Column& c = m_columns[column];
+
+    if (c.type != ColumnDouble)
+        return double(integerValue(row, column));
+
+    quint64 bits = qFromLittleEndian(read<quint64>(c.data + qint64(row) * 8));
+    return read<double>(reinterpret_cast<const uchar*>(&bits));
+}
+
+QString MappedColumns::stringValue(int row, int column) const
+{
+    Q_ASSERT(isInside(row, column));
+    const Column& c = m_columns[column];
+
+    switch (c.type)
+    {
+    case ColumnString:
+        return QString::fromUtf8(utf8Value(row, column));
+    case ColumnDouble:
+        return QString::number(doubleValue(row, column));
+    default:
+        return QString::number(integerValue(row, column));
+    }
+}
+
+QByteArray MappedColumns::utf8Value(int row, int column) const
+{
+    Q_ASSERT(isInside(row, column));
+    const Column& c = m_columns[column];
+
+    if (c.type != ColumnString)
+        return stringValue(row, column).toUtf8();
+
+    quint64 start = qFromLittleEndian(read<quint64>(c.data + qint64(row) * 8));
+    quint64 end = qFromLittleEndian(read<quint64>(c.data + qint64(row + 1) * 8));
+    if (start > end || end > c.blobSize)
+        return QByteArray();
+
+    return QByteArray::fromRawData(reinterpret_cast<const char*>(c.blob + start), int(end - start));
+}
+
+bool MappedColumns::open()
+{
+    if (!m_file.open(QIODevice::ReadOnly))
+        return fail(m_file.errorString());
+
+    qint64 fileSize = m_file.size();
+    if (fileSize < MappedHeaderSize)
+        return fail(QStringLiteral("File is too small"));
+
+    uchar* data = m_file.map(0, fileSize);
+    if (!data)
+        return fail(m_file.errorString());
+
+    if (std::memcmp(data, MappedColumnsMagic, sizeof(MappedColumnsMagic)) != 0 ||
+        qFromLittleEndian(read<quint32>(data + 4)) != MappedColumnsVersion)
+    {
+        m_file.unmap(data);
+        return fail(QStringLiteral("Unknown file format"));
+    }
+
+    quint32 columnsCount = qFromLittleEndian(read<quint32>(data + 8));
+    quint64 rowsCount = qFromLittleEndian(read<quint64>(data + 16));
+    if (rowsCount > quint64(std::numeric_limits<int>::max()) ||
+        MappedHeaderSize + qint64(columnsCount) * MappedColumnEntrySize > fileSize)
+    {
+        m_file.unmap(data);
+        return fail(QStringLiteral("Corrupted header"));
+    }
+
+    // check all ranges once, so values are read without checks
+    QVector<Column> columns;
+    columns.reserve(int(columnsCount));
+    for (quint32 i = 0; i < columnsCount; ++i)
+    {
+        const uchar* entry = data + MappedHeaderSize + i * MappedColumnEntrySize;
+        Column column;
+        column.type = ColumnType(qFromLittleEndian(read<quint32>(entry)));
+        quint64 dataOffset = qFromLittleEndian(read<quint64>(entry + 8));
+        quint64 blobOffset = qFromLittleEndian(read<quint64>(entry + 16));
+        column.blobSize = qFromLittleEndian(read<quint64>(entry + 24));
+
+        quint64 dataSize = 0;
+        switch (column.type)
+        {
+        case ColumnInt32:
+            dataSize = rowsCount * 4;
+            break;
+        case ColumnInt64:
+        case ColumnDouble:
+            dataSize = rowsCount * 8;
+            break;
+        case ColumnString:
+            dataSize = (rowsCount + 1) * 8;
+            break;
+        default:
+            m_file.unmap(data);
+            return fail(QStringLiteral("Unknown column type"));
+        }
+
+        if (dataOffset > quint64(fileSize) || dataSize > quint64(fileSize) - dataOffset ||
+            (column.type == ColumnString && (blobOffset > quint64(fileSize) || column.blobSize > quint64(fileSize) - blobOffset)))
+        {
+            m_file.unmap(data);
+            return fail(QStringLiteral("Column is out of file"));
+        }
+
+        column.data = data + dataOffset;
+        column.blob = data + blobOffset;
+        columns.append(column);
+    }
+
+    m_data = data;
+    m_rowsCount = int(rowsCount);
+    m_columns = std::move(columns);
+    return true;
+}
+
+bool MappedColumns::fail(const QString& errorString)
+{
+    m_errorString = errorString;
+    m_file.close();
+    return false;
+}
+
+} // end namespace Qi
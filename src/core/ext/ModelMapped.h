@@ -0,0 +1,156 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_MODEL_MAPPED_H
+#define QI_MODEL_MAPPED_H
+
+#include "ModelTyped.h"
+#include "space/grid/GridID.h"
+#include <QFile>
+#include <cstring>
+#include <stdexcept>
+
+namespace Qi
+{
+
+// read-only columnar file mapped into memory
+// little-endian layout:
+//   header: "QIMC", quint32 version (1), quint32 columns count, quint32 reserved, quint64 rows count
+//   columns table: quint32 type, quint32 reserved, quint64 data offset, quint64 blob offset, quint64 blob size
+//   numeric column data: rows count fixed-width values
+//   string column data: rows count + 1 quint64 offsets into utf-8 blob
+// values are read straight from the mapping, so only pages of touched rows are loaded
+class QI_EXPORT MappedColumns
+{
+    Q_DISABLE_COPY(MappedColumns)
+
+public:
+    enum ColumnType
+    {
+        ColumnInvalid = 0,
+        ColumnInt32 = 1,
+        ColumnInt64 = 2,
+        ColumnDouble = 3,
+        ColumnString = 4
+    };
+
+    explicit MappedColumns(const QString& fileName);
+    ~MappedColumns();
+
+    bool isValid() const { return m_data != nullptr; }
+    QString errorString() const { return m_errorString; }
+
+    int rowsCount() const { return m_rowsCount; }
+    int columnsCount() const { return m_columns.size(); }
+    ColumnType columnType(int column) const;
+
+    bool isInside(int row, int column) const { return row >= 0 && row < m_rowsCount && column >= 0 && column < m_columns.size(); }
+
+    // row and column should be inside
+    qint64 integerValue(int row, int column) const;
+    double doubleValue(int row, int column) const;
+    QString stringValue(int row, int column) const;
+    // utf-8 bytes referencing mapped data without copy
+    QByteArray utf8Value(int row, int column) const;
+
+private:
+    struct Column
+    {
+        ColumnType type;
+        const uchar* data;
+        const uchar* blob;
+        quint64 blobSize;
+    };
+
+    bool open();
+    bool fail(const QString& errorString);
+
+    template <typename T>
+    static T read(const uchar* data)
+    {
+        // mapped data might be unaligned
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+    QFile m_file;
+    const uchar* m_data;
+    QString m_errorString;
+    int m_rowsCount;
+    QVector<Column> m_columns;
+};
+
+namespace Private
+{
+    template <typename T>
+    T mappedValue(const MappedColumns& columns, int row, int column, std::true_type /*isArithmetic*/)
+    {
+        if (columns.columnType(column) == MappedColumns::ColumnDouble)
+            return T(columns.doubleValue(row, column));
+        return T(columns.integerValue(row, column));
+    }
+
+    template <typename T>
+    T mappedValue(const MappedColumns& columns, int row, int column, std::false_type /*isArithmetic*/)
+    {
+        return T(columns.stringValue(row, column));
+    }
+}
+
+// read-only grid model over mapped columns
+// grid rows and columns are file rows and columns shifted by firstColumn
+template <typename T>
+class ModelMappedColumns: public ModelIdTyped<T, GridID>
+{
+public:
+    explicit ModelMappedColumns(SharedPtr<MappedColumns> columns, int firstColumn = 0)
+        : m_columns(std::move(columns)),
+          m_firstColumn(firstColumn)
+    {
+        Q_ASSERT(m_columns);
+    }
+
+    const SharedPtr<MappedColumns>& columns() const { return m_columns; }
+
+    bool isInside(GridID id) const { return m_columns->isInside(id.row, id.column + m_firstColumn); }
+
+protected:
+    // mapping is never written
+    bool isThreadSafeImpl() const override { return true; }
+
+    T valueIdImpl(GridID id) const final
+    {
+        if (!isInside(id))
+            throw std::logic_error("Cannot return value");
+
+        return Private::mappedValue<T>(*m_columns, id.row, id.column + m_firstColumn, typename std::is_arithmetic<T>::type());
+    }
+
+    bool setValueIdImpl(GridID /*id*/, T /*value*/) final
+    {
+        return false;
+    }
+
+private:
+    SharedPtr<MappedColumns> m_columns;
+    int m_firstColumn;
+};
+
+} // end namespace Qi
+
+#endif // QI_MODEL_MAPPED_H
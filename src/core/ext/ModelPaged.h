@@ -0,0 +1,300 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_MODEL_PAGED_H
+#define QI_MODEL_PAGED_H
+
+#include "ModelTyped.h"
+#include "space/grid/CacheSpaceGrid.h"
+#include "utils/CallLater.h"
+#include <QHash>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <functional>
+
+namespace Qi
+{
+
+// keeps only pages of rows around visible items of cache spaces
+// missing pages are fetched asynchronously, pending items show placeholder value
+// least recently visible pages are evicted when pages count exceeds budget
+template <typename T>
+class ModelPaged: public ModelIdTyped<T, GridID>
+{
+public:
+    typedef typename std::decay<T>::type StorageT;
+    // returns pageRows * columnsCount values row by row
+    typedef std::function<QFuture<QVector<StorageT>>(int firstRow, int pageRows)> FetchCallback;
+
+    explicit ModelPaged(FetchCallback fetch, int columnsCount = 1, StorageT placeholder = StorageT())
+        : m_fetch(std::move(fetch)),
+          m_columnsCount(columnsCount),
+          m_placeholder(std::move(placeholder)),
+          m_rowsCount(0),
+          m_pageRows(256),
+          m_pagesBudget(64),
+          m_tick(0),
+          m_generation(0),
+          m_isFetchScheduled(false)
+    {
+        Q_ASSERT(m_fetch);
+        Q_ASSERT(m_columnsCount > 0);
+    }
+
+    ~ModelPaged()
+    {
+        for (auto connection : m_connections)
+            QObject::disconnect(connection);
+    }
+
+    // rows count of remote data, rows outside are never fetched
+    int rowsCount() const { return m_rowsCount; }
+    void setRowsCount(int rowsCount)
+    {
+        Q_ASSERT(rowsCount >= 0);
+        if (m_rowsCount == rowsCount)
+            return;
+
+        m_rowsCount = rowsCount;
+        clear();
+    }
+
+    int pageRows() const { return m_pageRows; }
+    void setPageRows(int pageRows)
+    {
+        Q_ASSERT(pageRows > 0);
+        if (m_pageRows == pageRows)
+            return;
+
+        m_pageRows = pageRows;
+        clear();
+    }
+
+    // maximal count of loaded pages
+    int pagesBudget() const { return m_pagesBudget; }
+    void setPagesBudget(int pagesBudget)
+    {
+        Q_ASSERT(pagesBudget > 0);
+        m_pagesBudget = pagesBudget;
+        evictPages();
+    }
+
+    const StorageT& placeholder() const { return m_placeholder; }
+
+    bool isLoaded(GridID id) const { return m_pages.contains(pageOf(id.row)); }
+    bool isPending(GridID id) const { return m_pendingPages.contains(pageOf(id.row)); }
+
+    // fetches pages around visible items of the cache space when it changes
+    void addCacheSpace(const SharedPtr<CacheSpaceGrid>& cacheSpace)
+    {
+        Q_ASSERT(cacheSpace);
+        m_cacheSpaces.append(cacheSpace.toWeakRef());
+        m_connections.append(QObject::connect(cacheSpace.data(), &CacheSpace::cacheChanged, this, [this]() {
+            scheduleFetch();
+        }));
+        scheduleFetch();
+    }
+
+    // drops all pages and refetches visible ones
+    void clear()
+    {
+        m_pages.clear();
+        // late results are ignored by generation
+        m_pendingPages.clear();
+        ++m_generation;
+
+        this->notifyChanged();
+        scheduleFetch();
+    }
+
+protected:
+    T valueIdImpl(GridID id) const final
+    {
+        auto it = m_pages.constFind(pageOf(id.row));
+        if (it == m_pages.constEnd() || id.column < 0 || id.column >= m_columnsCount)
+            return m_placeholder;
+
+        int index = (id.row - it.key() * m_pageRows) * m_columnsCount + id.column;
+        if (index < 0 || index >= it->values.size())
+            return m_placeholder;
+
+        return it->values[index];
+    }
+
+    bool setValueIdImpl(GridID id, T value) final
+    {
+        auto it = m_pages.find(pageOf(id.row));
+        if (it == m_pages.end() || id.column < 0 || id.column >= m_columnsCount)
+            return false;
+
+        int index = (id.row - it.key() * m_pageRows) * m_columnsCount + id.column;
+        if (index < 0 || index >= it->values.size())
+            return false;
+
+        it->values[index] = value;
+        return true;
+    }
+
+private:
+    struct Page
+    {
+        QVector<StorageT> values;
+        // tick of the last fetch request which saw the page visible
+        quint64 lastVisible;
+    };
+
+    int pageOf(int row) const { return row >= 0 ? row / m_pageRows : -1; }
+
+    void scheduleFetch()
+    {
+        if (m_isFetchScheduled)
+            return;
+
+        // cache items are valid only after pending changes are processed
+        m_isFetchScheduled = true;
+        callLater(this, [this]() {
+            m_isFetchScheduled = false;
+            fetchVisible();
+        });
+    }
+
+    void fetchVisible()
+    {
+        ++m_tick;
+
+        for (const auto& weakCacheSpace : m_cacheSpaces)
+        {
+            auto cacheSpace = weakCacheSpace.toStrongRef();
+            if (!cacheSpace)
+                continue;
+
+            GridID idStart, idEnd;
+            cacheSpace->visibleItemsRange(idStart, idEnd);
+            if (!idStart.isValid() || !idEnd.isValid())
+                continue;
+
+            const auto& rows = *cacheSpace->spaceGrid()->rows();
+            int lastPage = -1;
+            for (int visibleRow = idStart.row; visibleRow <= idEnd.row; ++visibleRow)
+            {
+                int page = pageOf(rows.toAbsoluteSafe(visibleRow));
+                if (page < 0 || page == lastPage)
+                    continue;
+
+                lastPage = page;
+                touchPage(page);
+            }
+        }
+
+        evictPages();
+    }
+
+    void touchPage(int page)
+    {
+        auto it = m_pages.find(page);
+        if (it != m_pages.end())
+        {
+            it->lastVisible = m_tick;
+            return;
+        }
+
+        if (m_pendingPages.contains(page))
+            return;
+
+        int firstRow = page * m_pageRows;
+        int pageRows = qMin(m_pageRows, m_rowsCount - firstRow);
+        if (pageRows <= 0)
+            return;
+
+        auto watcher = new QFutureWatcher<QVector<StorageT>>(this);
+        quint64 generation = m_generation;
+        QObject::connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, page, generation]() {
+            watcher->deleteLater();
+            if (generation == m_generation && !watcher->isCanceled())
+                onPageFetched(page, watcher->result());
+        });
+
+        m_pendingPages.insert(page, m_tick);
+        watcher->setFuture(m_fetch(firstRow, pageRows));
+    }
+
+    void onPageFetched(int page, QVector<StorageT> values)
+    {
+        auto it = m_pendingPages.find(page);
+        if (it == m_pendingPages.end())
+            return;
+
+        Page& newPage = m_pages[page];
+        newPage.values = std::move(values);
+        newPage.lastVisible = it.value();
+        m_pendingPages.erase(it);
+
+        // notify items of the page only
+        {
+            ModelUpdateGuard guard(*this);
+            int firstRow = page * m_pageRows;
+            int pageRows = newPage.values.size() / m_columnsCount;
+            for (int row = firstRow; row < firstRow + pageRows; ++row)
+            {
+                for (int column = 0; column < m_columnsCount; ++column)
+                    this->notifyItemChanged(ID(GridID(row, column)));
+            }
+        }
+
+        evictPages();
+    }
+
+    void evictPages()
+    {
+        while (m_pages.size() > m_pagesBudget)
+        {
+            auto oldest = m_pages.begin();
+            for (auto it = m_pages.begin(); it != m_pages.end(); ++it)
+            {
+                if (it->lastVisible < oldest->lastVisible)
+                    oldest = it;
+            }
+
+            // pages visible right now are kept
+            if (oldest->lastVisible == m_tick)
+                break;
+
+            m_pages.erase(oldest);
+        }
+    }
+
+    FetchCallback m_fetch;
+    int m_columnsCount;
+    StorageT m_placeholder;
+    int m_rowsCount;
+    int m_pageRows;
+    int m_pagesBudget;
+
+    QHash<int, Page> m_pages;
+    // page -> tick of request
+    QHash<int, quint64> m_pendingPages;
+    quint64 m_tick;
+    quint64 m_generation;
+    bool m_isFetchScheduled;
+
+    QVector<WeakPtr<CacheSpaceGrid>> m_cacheSpaces;
+    QVector<QMetaObject::Connection> m_connections;
+};
+
+} // end namespace Qi
+
+#endif // QI_MODEL_PAGED_H
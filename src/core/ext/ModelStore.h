@@ -18,82 +18,866 @@
 #define QI_MODEL_STORE_H
 
 #include "ModelTyped.h"
+#include "utils/MemoryUsage.h"
 #include "space/grid/SpaceGrid.h"
+#include <QMap>
 #include <QSet>
+#include <algorithm>
 #include <functional>
+#include <memory>
+#include <vector>
 
 namespace Qi
 {
 
-template <typename T, typename StorageT = typename std::decay<T>::type>
+namespace Private
+{
+    // values of storage models are not implicitly shared, so writes don't check for detach,
+    // and take memory from the allocator, bools stay in QVector as std::vector<bool> packs them
+    template <typename T, typename Allocator>
+    struct StorageValues
+    {
+        typedef std::vector<T, Allocator> type;
+        static type create(const Allocator& allocator) { return type(allocator); }
+    };
+
+    template <typename Allocator>
+    struct StorageValues<bool, Allocator>
+    {
+        typedef QVector<bool> type;
+        static type create(const Allocator& /*allocator*/) { return type(); }
+    };
+}
+
+// layouts of ModelStorageGrid values in memory,
+// values are stored in blocks of rows x columns which are row-major inside,
+// so adding rows doesn't move existing values
+template <int RowsShift, int ColumnsShift>
+struct StorageGridLayout
+{
+    enum
+    {
+        BlockRowsShift = RowsShift,
+        BlockRows = 1 << RowsShift,
+        BlockColumnsShift = ColumnsShift,
+        BlockColumns = 1 << ColumnsShift
+    };
+};
+
+// values of a column are contiguous, fits column scans, sorting and filtering
+typedef StorageGridLayout<12, 0> StorageGridColumns;
+// values of a row are contiguous by 256 columns, fits row export and copying
+typedef StorageGridLayout<6, 8> StorageGridRows;
+// tiles of 16 rows x 64 columns, fits painting of visible blocks
+typedef StorageGridLayout<4, 6> StorageGridTiles;
+
+// stores values in blocks of the layout,
+// last blocks are trimmed to grid rows and columns
+template <typename T, typename StorageT = typename std::decay<T>::type, typename LayoutT = StorageGridColumns, typename Allocator = std::allocator<StorageT>>
 class ModelStorageGrid: public ModelIdTyped<T, GridID>
 {
 public:
-    ModelStorageGrid(SharedPtr<SpaceGrid> grid)
+    typedef LayoutT Layout_t;
+    typedef Allocator Allocator_t;
+
+    explicit ModelStorageGrid(SharedPtr<SpaceGrid> grid, const Allocator& allocator = Allocator())
         : m_grid(std::move(grid)),
-          m_rowsCount(0)
+          m_allocator(allocator),
+          m_rowsCount(0),
+          m_columnsCount(0),
+          m_reservedRows(0)
     {
         Q_ASSERT(m_grid);
         m_connection = QObject::connect(m_grid.data(), &Space::spaceChanged, this, &ModelStorageGrid::onSpaceChanged);
-        /*[this] (const Space* space, ChangeReason reason) {
-            onSpaceChanged(space, reason);
-        });*/
+        m_insertedConnection = QObject::connect(m_grid.data(), &SpaceGrid::linesInserted, this, &ModelStorageGrid::onLinesInserted);
+        m_removedConnection = QObject::connect(m_grid.data(), &SpaceGrid::linesRemoved, this, &ModelStorageGrid::onLinesRemoved);
         resize();
     }
 
     ~ModelStorageGrid()
     {
         QObject::disconnect(m_connection);
+        QObject::disconnect(m_insertedConnection);
+        QObject::disconnect(m_removedConnection);
+    }
+
+    int rowsCount() const { return m_rowsCount; }
+    int columnsCount() const { return m_columnsCount; }
+    const Allocator& allocator() const { return m_allocator; }
+
+    MemoryUsage memoryUsage() const
+    {
+        qint64 bytes = MemoryUsage::bytes(m_blocks);
+        for (const auto& blocks : m_blocks)
+        {
+            bytes += MemoryUsage::bytes(blocks);
+            for (const auto& block : blocks)
+                bytes += MemoryUsage::bytes(block);
+        }
+
+        MemoryUsage usage;
+        usage.add("values", bytes);
+        return usage;
+    }
+
+    // typed access without virtual calls, id should be inside the grid
+    const StorageT& valueAt(GridID id) const
+    {
+        Q_ASSERT(isInside(id));
+        return valueRef(m_blocks, m_columnsCount, id.row, id.column);
+    }
+
+    // preallocates blocks for rows
+    void reserve(int rows)
+    {
+        m_reservedRows = qMax(m_reservedRows, rows);
+        for (auto& blocks : m_blocks)
+            blocks.reserve(rowBlocksCount(m_reservedRows));
+    }
+
+    // sets n values of the column starting from firstRow
+    // and emits single change notification
+    bool setColumnValues(int column, const StorageT* values, int n, int firstRow = 0)
+    {
+        if (column < 0 || column >= m_columnsCount || firstRow < 0 || n < 0 || firstRow + n > m_rowsCount)
+            return false;
+
+        for (int i = 0; i < n; ++i)
+            valueRef(m_blocks, m_columnsCount, firstRow + i, column) = values[i];
+
+        if (n > 0)
+            this->notifyChanged();
+        return true;
+    }
+
+    // sets n values of the row starting from firstColumn
+    // and emits single change notification
+    bool setRowValues(int row, const StorageT* values, int n, int firstColumn = 0)
+    {
+        if (row < 0 || row >= m_rowsCount || firstColumn < 0 || n < 0 || firstColumn + n > m_columnsCount)
+            return false;
+
+        for (int i = 0; i < n; ++i)
+            valueRef(m_blocks, m_columnsCount, row, firstColumn + i) = values[i];
+
+        if (n > 0)
+            this->notifyChanged();
+        return true;
     }
 
 protected:
+    bool isThreadSafeImpl() const override { return true; }
+
     T valueIdImpl(GridID id) const final
     {
-        int index = id.column * m_rowsCount + id.row;
-        if (index >= m_values.size())
+        if (!isInside(id))
             throw std::logic_error("Cannot return value");
 
-        return m_values[index];
+        return valueAt(id);
     }
 
     bool setValueIdImpl(GridID id, T value) final
     {
-        int index = id.column * m_rowsCount + id.row;
-        if (index < m_values.size())
+        if (!isInside(id))
+            return false;
+
+        valueRef(m_blocks, m_columnsCount, id.row, id.column) = value;
+        return true;
+    }
+
+    // runs of rows reported by grid iterators are filled by blocks
+    bool setValueMultipleImpl(IdIterator& it, T value) override
+    {
+        auto gridIt = dynamic_cast<IdIteratorGrid*>(&it);
+        if (!gridIt)
+            return ModelIdTyped<T, GridID>::setValueMultipleImpl(it, value);
+
+        bool result = false;
+        GridColumnSpan span;
+        for (it.atFirst(); gridIt->fetchColumnSpan(span);)
         {
-            m_values[index] = value;
-            return true;
+            if (span.column < 0 || span.column >= m_columnsCount)
+                continue;
+
+            int row = qMax(span.firstRow, 0);
+            int rowEnd = qMin(span.firstRow + span.rowsCount, m_rowsCount);
+            auto& blocks = m_blocks[span.column >> LayoutT::BlockColumnsShift];
+            int width = blockWidth(m_columnsCount, span.column >> LayoutT::BlockColumnsShift);
+            int localColumn = span.column & (LayoutT::BlockColumns - 1);
+            while (row < rowEnd)
+            {
+                auto& block = blocks[row >> LayoutT::BlockRowsShift];
+                int offset = row & (LayoutT::BlockRows - 1);
+                int blockRowEnd = qMin(rowEnd, row - offset + int(LayoutT::BlockRows));
+                // values of column are strided by block width
+                StorageT* values = block.data() + localColumn;
+                for (int i = offset, end = offset + blockRowEnd - row; i < end; ++i)
+                    values[i * width] = value;
+                row = blockRowEnd;
+                result = true;
+            }
+        }
+
+        return result;
+    }
+
+private slots:
+    void onSpaceChanged(const Space* space, ChangeReason reason)
+    {
+        Q_UNUSED(space);
+        // lines count changes come as space structure changes
+        if (reason & ChangeReasonSpaceStructure)
+        {
+            Q_ASSERT(space == m_grid.data());
+            resize();
         }
+    }
+
+    // values are shifted in place, so they stay attached to their lines
+    void onLinesInserted(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount)
+    {
+        if (lines == grid->rows().data())
+            insertRows(absoluteLine, linesCount);
         else
+            insertColumns(absoluteLine, linesCount);
+    }
+
+    void onLinesRemoved(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount)
+    {
+        if (lines == grid->rows().data())
+            removeRows(absoluteLine, linesCount);
+        else
+            removeColumns(absoluteLine, linesCount);
+    }
+
+private:
+    typedef typename Private::StorageValues<StorageT, Allocator>::type Block;
+    // blocks of one block column by block rows
+    typedef std::vector<Block> BlockColumn;
+
+    static int rowBlocksCount(int rows) { return (rows + LayoutT::BlockRows - 1) >> LayoutT::BlockRowsShift; }
+    static int columnBlocksCount(int columns) { return (columns + LayoutT::BlockColumns - 1) >> LayoutT::BlockColumnsShift; }
+    // last block column is trimmed to columns count
+    static int blockWidth(int columnsCount, int columnBlock)
+    {
+        return LayoutT::BlockColumns == 1 ? 1 : qMin(int(LayoutT::BlockColumns), columnsCount - (columnBlock << LayoutT::BlockColumnsShift));
+    }
+
+    template <typename Blocks>
+    static auto valueRef(Blocks& blocks, int columnsCount, int row, int column) -> decltype(blocks[0][0][0])
+    {
+        int columnBlock = column >> LayoutT::BlockColumnsShift;
+        int offset = (row & (LayoutT::BlockRows - 1)) * blockWidth(columnsCount, columnBlock) + (column & (LayoutT::BlockColumns - 1));
+        return blocks[columnBlock][row >> LayoutT::BlockRowsShift][offset];
+    }
+
+    bool isInside(GridID id) const
+    {
+        return id.row >= 0 && id.row < m_rowsCount && id.column >= 0 && id.column < m_columnsCount;
+    }
+
+    void insertRows(int row, int rowsCount)
+    {
+        int oldRowsCount = m_rowsCount;
+        m_rowsCount += rowsCount;
+        resizeBlocks();
+
+        for (int column = 0; column < m_columnsCount; ++column)
         {
+            for (int i = oldRowsCount - 1; i >= row; --i)
+                valueRef(m_blocks, m_columnsCount, i + rowsCount, column) = std::move(valueRef(m_blocks, m_columnsCount, i, column));
+            for (int i = row; i < row + rowsCount; ++i)
+                valueRef(m_blocks, m_columnsCount, i, column) = StorageT();
+        }
+    }
+
+    void removeRows(int row, int rowsCount)
+    {
+        for (int column = 0; column < m_columnsCount; ++column)
+        {
+            for (int i = row + rowsCount; i < m_rowsCount; ++i)
+                valueRef(m_blocks, m_columnsCount, i - rowsCount, column) = std::move(valueRef(m_blocks, m_columnsCount, i, column));
+        }
+
+        m_rowsCount -= rowsCount;
+        resizeBlocks();
+    }
+
+    void insertColumns(int column, int columnsCount)
+    {
+        // single column blocks are inserted without moving values
+        if (LayoutT::BlockColumns == 1)
+        {
+            m_blocks.insert(m_blocks.begin() + column, columnsCount, BlockColumn());
+            m_columnsCount += columnsCount;
+            resizeBlocks();
+            return;
+        }
+
+        relayout(m_rowsCount, m_columnsCount + columnsCount, [column, columnsCount](int oldColumn) {
+            return oldColumn < column ? oldColumn : oldColumn + columnsCount;
+        });
+    }
+
+    void removeColumns(int column, int columnsCount)
+    {
+        if (LayoutT::BlockColumns == 1)
+        {
+            m_blocks.erase(m_blocks.begin() + column, m_blocks.begin() + column + columnsCount);
+            m_columnsCount -= columnsCount;
+            return;
+        }
+
+        relayout(m_rowsCount, m_columnsCount - columnsCount, [column, columnsCount](int oldColumn) {
+            if (oldColumn < column)
+                return oldColumn;
+            return oldColumn < column + columnsCount ? int(InvalidIndex) : oldColumn - columnsCount;
+        });
+    }
+
+    void resize()
+    {
+        auto grid = m_grid.toStrongRef();
+        int rowsCount = grid->rowsCount();
+        int columnsCount = grid->columnsCount();
+
+        if (rowsCount == m_rowsCount && columnsCount == m_columnsCount)
+            return;
+
+        // blocks of other width change offsets of values
+        if (LayoutT::BlockColumns == 1 || columnsCount == m_columnsCount)
+        {
+            m_rowsCount = rowsCount;
+            m_columnsCount = columnsCount;
+            resizeBlocks();
+            return;
+        }
+
+        int keptColumns = qMin(columnsCount, m_columnsCount);
+        relayout(rowsCount, columnsCount, [keptColumns](int oldColumn) {
+            return oldColumn < keptColumns ? oldColumn : int(InvalidIndex);
+        });
+    }
+
+    // moves values to blocks of new dimensions, newColumn maps old column to the new one or InvalidIndex
+    template <typename ColumnMap>
+    void relayout(int rowsCount, int columnsCount, const ColumnMap& newColumn)
+    {
+        std::vector<BlockColumn> oldBlocks;
+        oldBlocks.swap(m_blocks);
+        int oldColumnsCount = m_columnsCount;
+        int keptRows = qMin(rowsCount, m_rowsCount);
+
+        m_rowsCount = rowsCount;
+        m_columnsCount = columnsCount;
+        resizeBlocks();
+
+        for (int column = 0; column < oldColumnsCount; ++column)
+        {
+            int targetColumn = newColumn(column);
+            if (targetColumn == InvalidIndex)
+                continue;
+
+            for (int row = 0; row < keptRows; ++row)
+                valueRef(m_blocks, m_columnsCount, row, targetColumn) = std::move(valueRef(oldBlocks, oldColumnsCount, row, column));
+        }
+    }
+
+    // blocks of existing rows stay in place, width of block columns should not change
+    void resizeBlocks()
+    {
+        int rowBlocks = rowBlocksCount(m_rowsCount);
+        int reservedRowBlocks = rowBlocksCount(m_reservedRows);
+
+        m_blocks.resize(columnBlocksCount(m_columnsCount));
+        for (int columnBlock = 0, columnBlocks = int(m_blocks.size()); columnBlock < columnBlocks; ++columnBlock)
+        {
+            auto& blocks = m_blocks[columnBlock];
+            int width = blockWidth(m_columnsCount, columnBlock);
+            blocks.reserve(qMax(rowBlocks, reservedRowBlocks));
+            blocks.resize(rowBlocks, Private::StorageValues<StorageT, Allocator>::create(m_allocator));
+            for (int i = 0; i < rowBlocks; ++i)
+            {
+                auto& block = blocks[i];
+                int blockRows = qMin(int(LayoutT::BlockRows), m_rowsCount - i * int(LayoutT::BlockRows));
+                if (int(block.size()) == blockRows * width)
+                    continue;
+
+                if (m_reservedRows > m_rowsCount)
+                    block.reserve(int(LayoutT::BlockRows) * width);
+                block.resize(blockRows * width);
+            }
+        }
+    }
+
+    WeakPtr<SpaceGrid> m_grid;
+    Allocator m_allocator;
+    // blocks by block columns and block rows
+    std::vector<BlockColumn> m_blocks;
+    int m_rowsCount;
+    int m_columnsCount;
+    int m_reservedRows;
+    QMetaObject::Connection m_connection;
+    QMetaObject::Connection m_insertedConnection;
+    QMetaObject::Connection m_removedConnection;
+};
+
+// stores only cells which differ from the default value in ordered maps by columns,
+// for mostly empty grids, missing cells return the default value
+template <typename T, typename StorageT = typename std::decay<T>::type>
+class ModelStorageGridSparse: public ModelIdTyped<T, GridID>
+{
+    typedef QMap<int, StorageT> Column;
+
+public:
+    explicit ModelStorageGridSparse(SharedPtr<SpaceGrid> grid, StorageT defaultValue = StorageT())
+        : m_grid(std::move(grid)),
+          m_defaultValue(std::move(defaultValue)),
+          m_rowsCount(0),
+          m_populatedCount(0)
+    {
+        Q_ASSERT(m_grid);
+        m_connection = QObject::connect(m_grid.data(), &Space::spaceChanged, this, &ModelStorageGridSparse::onSpaceChanged);
+        m_insertedConnection = QObject::connect(m_grid.data(), &SpaceGrid::linesInserted, this, &ModelStorageGridSparse::onLinesInserted);
+        m_removedConnection = QObject::connect(m_grid.data(), &SpaceGrid::linesRemoved, this, &ModelStorageGridSparse::onLinesRemoved);
+        resize();
+    }
+
+    ~ModelStorageGridSparse()
+    {
+        QObject::disconnect(m_connection);
+        QObject::disconnect(m_insertedConnection);
+        QObject::disconnect(m_removedConnection);
+    }
+
+    int rowsCount() const { return m_rowsCount; }
+    int columnsCount() const { return m_columns.size(); }
+
+    const StorageT& defaultValue() const { return m_defaultValue; }
+    // count of cells with stored values
+    int populatedCount() const { return m_populatedCount; }
+
+    MemoryUsage memoryUsage() const
+    {
+        qint64 bytes = MemoryUsage::bytes(m_columns);
+        for (const auto& column : m_columns)
+            bytes += MemoryUsage::bytes(column);
+
+        MemoryUsage usage;
+        usage.add("values", bytes);
+        return usage;
+    }
+
+    // typed access without virtual calls
+    const StorageT& valueAt(GridID id) const
+    {
+        if (id.column < 0 || id.column >= m_columns.size())
+            return m_defaultValue;
+
+        const Column& column = m_columns[id.column];
+        auto it = column.constFind(id.row);
+        return (it == column.constEnd()) ? m_defaultValue : it.value();
+    }
+
+    // calls fn(GridID, const StorageT&) for populated cells
+    // column by column with ascending rows
+    template <typename Fn>
+    void forEachPopulated(const Fn& fn) const
+    {
+        for (int column = 0; column < m_columns.size(); ++column)
+        {
+            const Column& values = m_columns[column];
+            for (auto it = values.constBegin(); it != values.constEnd(); ++it)
+                fn(GridID(it.key(), column), it.value());
+        }
+    }
+
+    // iterates populated cells in forEachPopulated order
+    class PopulatedIterator: public IdIteratorGrid
+    {
+    public:
+        explicit PopulatedIterator(const ModelStorageGridSparse& model)
+            : m_model(model),
+              m_column(InvalidIndex)
+        {
+            atFirst();
+        }
+
+    protected:
+        GridID gridIdImpl() const override { return m_id; }
+
+        bool atFirstImpl() override
+        {
+            m_column = InvalidIndex;
+            return toNextColumn();
+        }
+
+        bool toNextImpl() override
+        {
+            if (!m_id.isValid())
+                return false;
+
+            if (++m_it != m_model.m_columns[m_column].constEnd())
+            {
+                m_id.row = m_it.key();
+                return true;
+            }
+
+            return toNextColumn();
+        }
+
+    private:
+        bool toNextColumn()
+        {
+            for (++m_column; m_column < m_model.m_columns.size(); ++m_column)
+            {
+                const Column& values = m_model.m_columns[m_column];
+                if (!values.isEmpty())
+                {
+                    m_it = values.constBegin();
+                    m_id = GridID(m_it.key(), m_column);
+                    return true;
+                }
+            }
+
+            m_id = GridID();
             return false;
         }
+
+        const ModelStorageGridSparse& m_model;
+        int m_column;
+        typename Column::const_iterator m_it;
+        GridID m_id;
+    };
+
+protected:
+    bool isThreadSafeImpl() const override { return true; }
+
+    T valueIdImpl(GridID id) const final
+    {
+        if (!isInside(id))
+            throw std::logic_error("Cannot return value");
+
+        return valueAt(id);
+    }
+
+    bool setValueIdImpl(GridID id, T value) final
+    {
+        if (!isInside(id))
+            return false;
+
+        // default values are not stored
+        Column& column = m_columns[id.column];
+        if (value == m_defaultValue)
+        {
+            m_populatedCount -= column.remove(id.row);
+        }
+        else
+        {
+            auto it = column.find(id.row);
+            if (it == column.end())
+            {
+                column.insert(id.row, value);
+                ++m_populatedCount;
+            }
+            else
+            {
+                it.value() = value;
+            }
+        }
+
+        return true;
     }
 
 private slots:
     void onSpaceChanged(const Space* space, ChangeReason reason)
     {
         Q_UNUSED(space);
-        if ((reason & ChangeReasonSpaceStructure) &&
-            (reason & ChangeReasonLinesCount))
+        if (reason & ChangeReasonSpaceStructure)
         {
             Q_ASSERT(space == m_grid.data());
             resize();
         }
     }
 
+    // only populated cells after the line are shifted
+    void onLinesInserted(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount)
+    {
+        if (lines == grid->rows().data())
+        {
+            m_rowsCount += linesCount;
+            for (auto& column : m_columns)
+                shiftRows(column, absoluteLine, linesCount);
+        }
+        else
+        {
+            m_columns.insert(absoluteLine, linesCount, Column());
+        }
+    }
+
+    void onLinesRemoved(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount)
+    {
+        if (lines == grid->rows().data())
+        {
+            m_rowsCount -= linesCount;
+            for (auto& column : m_columns)
+            {
+                auto it = column.lowerBound(absoluteLine);
+                while (it != column.end() && it.key() < absoluteLine + linesCount)
+                {
+                    it = column.erase(it);
+                    --m_populatedCount;
+                }
+                shiftRows(column, absoluteLine + linesCount, -linesCount);
+            }
+        }
+        else
+        {
+            for (int i = absoluteLine; i < absoluteLine + linesCount; ++i)
+                m_populatedCount -= m_columns[i].size();
+            m_columns.remove(absoluteLine, linesCount);
+        }
+    }
+
 private:
+    bool isInside(GridID id) const
+    {
+        return id.row >= 0 && id.row < m_rowsCount && id.column >= 0 && id.column < m_columns.size();
+    }
+
+    // moves cells from row and below by delta rows
+    static void shiftRows(Column& column, int row, int delta)
+    {
+        auto it = column.lowerBound(row);
+        if (it == column.end())
+            return;
+
+        QVector<QPair<int, StorageT>> shifted;
+        for (; it != column.end(); it = column.erase(it))
+            shifted.append(qMakePair(it.key() + delta, std::move(it.value())));
+
+        for (auto& cell : shifted)
+            column.insert(column.end(), cell.first, std::move(cell.second));
+    }
+
     void resize()
     {
         auto grid = m_grid.toStrongRef();
-        m_rowsCount = grid->rowsCount();
-        m_values.resize(grid->rowsCount()*grid->columnsCount());
+        int rowsCount = grid->rowsCount();
+        int columnsCount = grid->columnsCount();
+
+        // cells outside of the grid are dropped
+        if (rowsCount < m_rowsCount)
+        {
+            for (auto& column : m_columns)
+            {
+                auto it = column.lowerBound(rowsCount);
+                while (it != column.end())
+                {
+                    it = column.erase(it);
+                    --m_populatedCount;
+                }
+            }
+        }
+
+        for (int i = columnsCount; i < m_columns.size(); ++i)
+            m_populatedCount -= m_columns[i].size();
+
+        m_rowsCount = rowsCount;
+        m_columns.resize(columnsCount);
     }
 
     WeakPtr<SpaceGrid> m_grid;
-    QVector<StorageT> m_values;
+    StorageT m_defaultValue;
+    QVector<Column> m_columns;
+    int m_rowsCount;
+    int m_populatedCount;
+    QMetaObject::Connection m_connection;
+    QMetaObject::Connection m_insertedConnection;
+    QMetaObject::Connection m_removedConnection;
+};
+
+// keeps last capacity rows of the grid in ring buffers by columns,
+// dropping first rows moves ring head without moving values
+template <typename T, typename StorageT = typename std::decay<T>::type>
+class ModelStorageGridRing: public ModelIdTyped<T, GridID>
+{
+public:
+    ModelStorageGridRing(SharedPtr<SpaceGrid> grid, int capacity)
+        : m_grid(std::move(grid)),
+          m_capacity(capacity),
+          m_head(0),
+          m_rowsCount(0)
+    {
+        Q_ASSERT(m_grid);
+        Q_ASSERT(m_capacity > 0);
+        m_connection = QObject::connect(m_grid.data(), &Space::spaceChanged, this, &ModelStorageGridRing::onSpaceChanged);
+        m_insertedConnection = QObject::connect(m_grid.data(), &SpaceGrid::linesInserted, this, &ModelStorageGridRing::onLinesInserted);
+        m_removedConnection = QObject::connect(m_grid.data(), &SpaceGrid::linesRemoved, this, &ModelStorageGridRing::onLinesRemoved);
+        resize();
+    }
+
+    ~ModelStorageGridRing()
+    {
+        QObject::disconnect(m_connection);
+        QObject::disconnect(m_insertedConnection);
+        QObject::disconnect(m_removedConnection);
+    }
+
+    int capacity() const { return m_capacity; }
+    int rowsCount() const { return m_rowsCount; }
+    int columnsCount() const { return m_columns.size(); }
+
+    MemoryUsage memoryUsage() const
+    {
+        qint64 bytes = MemoryUsage::bytes(m_columns);
+        for (const auto& column : m_columns)
+            bytes += MemoryUsage::bytes(column);
+
+        MemoryUsage usage;
+        usage.add("values", bytes);
+        return usage;
+    }
+
+    // typed access without virtual calls, id should be inside the grid
+    const StorageT& valueAt(GridID id) const
+    {
+        Q_ASSERT(isInside(id));
+        return m_columns[id.column][slot(id.row)];
+    }
+
+    // appends rows to the grid and removes first rows above capacity,
+    // returns first appended row
+    int appendRows(int rowsCount)
+    {
+        Q_ASSERT(rowsCount > 0);
+        auto grid = m_grid.toStrongRef();
+        Q_ASSERT(grid);
+
+        rowsCount = qMin(rowsCount, m_capacity);
+        int overflow = grid->rowsCount() + rowsCount - m_capacity;
+        if (overflow > 0)
+            grid->rows()->removeLines(0, overflow);
+
+        grid->rows()->appendLines(rowsCount);
+        return grid->rowsCount() - rowsCount;
+    }
+
+protected:
+    bool isThreadSafeImpl() const override { return true; }
+
+    T valueIdImpl(GridID id) const final
+    {
+        if (!isInside(id))
+            throw std::logic_error("Cannot return value");
+
+        return valueAt(id);
+    }
+
+    bool setValueIdImpl(GridID id, T value) final
+    {
+        if (!isInside(id))
+            return false;
+
+        m_columns[id.column][slot(id.row)] = value;
+        return true;
+    }
+
+private slots:
+    void onSpaceChanged(const Space* space, ChangeReason reason)
+    {
+        Q_UNUSED(space);
+        if (reason & ChangeReasonSpaceStructure)
+        {
+            Q_ASSERT(space == m_grid.data());
+            resize();
+        }
+    }
+
+    void onLinesInserted(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount)
+    {
+        if (lines != grid->rows().data())
+        {
+            m_columns.insert(absoluteLine, linesCount, QVector<StorageT>(m_capacity));
+            return;
+        }
+
+        // rows above capacity are not stored
+        int stored = qMin(linesCount, m_capacity - m_rowsCount);
+        if (stored <= 0 || absoluteLine > m_rowsCount)
+            return;
+
+        m_rowsCount += stored;
+        for (auto& column : m_columns)
+        {
+            for (int row = m_rowsCount - 1; row >= absoluteLine + stored; --row)
+                column[slot(row)] = std::move(column[slot(row - stored)]);
+            for (int row = absoluteLine; row < absoluteLine + stored; ++row)
+                column[slot(row)] = StorageT();
+        }
+    }
+
+    void onLinesRemoved(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount)
+    {
+        if (lines != grid->rows().data())
+        {
+            m_columns.remove(absoluteLine, linesCount);
+            return;
+        }
+
+        if (absoluteLine >= m_rowsCount)
+            return;
+
+        linesCount = qMin(linesCount, m_rowsCount - absoluteLine);
+        if (absoluteLine == 0)
+        {
+            // drop head
+            m_head = slot(linesCount);
+        }
+        else
+        {
+            for (auto& column : m_columns)
+            {
+                for (int row = absoluteLine; row + linesCount < m_rowsCount; ++row)
+                    column[slot(row)] = std::move(column[slot(row + linesCount)]);
+            }
+        }
+
+        m_rowsCount -= linesCount;
+    }
+
+private:
+    int slot(int row) const
+    {
+        int index = m_head + row;
+        return (index >= m_capacity) ? index - m_capacity : index;
+    }
+
+    bool isInside(GridID id) const
+    {
+        return id.row >= 0 && id.row < m_rowsCount && id.column >= 0 && id.column < m_columns.size();
+    }
+
+    void resize()
+    {
+        auto grid = m_grid.toStrongRef();
+        // new rows of not shifting changes keep values left in their slots
+        m_rowsCount = qMin(grid->rowsCount(), m_capacity);
+        m_columns.resize(grid->columnsCount());
+        for (auto& column : m_columns)
+            column.resize(m_capacity);
+    }
+
+    WeakPtr<SpaceGrid> m_grid;
+    // m_columns[column][slot(row)] - value of row
+    QVector<QVector<StorageT>> m_columns;
+    int m_capacity;
+    // slot of the first row
+    int m_head;
     int m_rowsCount;
     QMetaObject::Connection m_connection;
+    QMetaObject::Connection m_insertedConnection;
+    QMetaObject::Connection m_removedConnection;
 };
 
 template <typename T, typename StorageT = typename std::decay<T>::type, typename NotEq = typename std::not_equal_to<T>>
@@ -106,6 +890,8 @@ public:
     }
 
 protected:
+    bool isThreadSafeImpl() const override { return true; }
+
     T valueImpl(ID /*item*/) const override
     {
         return m_value;
@@ -126,50 +912,108 @@ private:
     StorageT m_value;
 };
 
-template <typename T, typename StorageT = typename std::decay<T>::type>
+// stores values of some columns, columns are looked up by direct index from the min column
+// values of columns take memory from the allocator
+template <typename T, typename StorageT = typename std::decay<T>::type, typename Allocator = std::allocator<StorageT>>
 class ModelStorageColumns: public ModelIdTyped<T, GridID>
 {
 public:
-    ModelStorageColumns(const SharedPtr<Lines>& rows, const QSet<int>& columns) { init(rows, std::move(columns)); }
-    ModelStorageColumns(const SharedPtr<Lines>& rows, int minColumn, int maxColumn) { init(rows, minColumn, maxColumn); }
-    ModelStorageColumns(const SharedPtr<SpaceGrid>& grid, const QSet<int>& columns) { init(grid->rows(), std::move(columns)); }
-    ModelStorageColumns(const SharedPtr<SpaceGrid>& grid, int minColumn, int maxColumn) { init(grid->rows(), minColumn, maxColumn); }
+    typedef Allocator Allocator_t;
+
+    ModelStorageColumns(const SharedPtr<Lines>& rows, const QSet<int>& columns, const Allocator& allocator = Allocator())
+        : m_allocator(allocator) { init(rows, std::move(columns)); }
+    ModelStorageColumns(const SharedPtr<Lines>& rows, int minColumn, int maxColumn, const Allocator& allocator = Allocator())
+        : m_allocator(allocator) { init(rows, minColumn, maxColumn); }
+    ModelStorageColumns(const SharedPtr<SpaceGrid>& grid, const QSet<int>& columns, const Allocator& allocator = Allocator())
+        : m_allocator(allocator) { init(grid->rows(), std::move(columns)); }
+    ModelStorageColumns(const SharedPtr<SpaceGrid>& grid, int minColumn, int maxColumn, const Allocator& allocator = Allocator())
+        : m_allocator(allocator) { init(grid->rows(), minColumn, maxColumn); }
 
     ~ModelStorageColumns()
     {
         auto rows = m_rows.toStrongRef();
         if (rows)
-            disconnect(rows.data(), &Lines::linesChanged, this, &ModelStorageColumns::onRowsChanged);
+        {
+            QObject::disconnect(rows.data(), &Lines::linesChanged, this, &ModelStorageColumns::onRowsChanged);
+            QObject::disconnect(rows.data(), &Lines::linesInserted, this, &ModelStorageColumns::onRowsInserted);
+            QObject::disconnect(rows.data(), &Lines::linesRemoved, this, &ModelStorageColumns::onRowsRemoved);
+        }
+    }
+
+    int rowsCount() const { return m_rowsCount; }
+    bool hasColumn(int column) const { return columnValues(column) != nullptr; }
+    const Allocator& allocator() const { return m_allocator; }
+
+    MemoryUsage memoryUsage() const
+    {
+        qint64 bytes = MemoryUsage::bytes(m_columns);
+        for (const auto& column : m_columns)
+            bytes += MemoryUsage::bytes(column);
+
+        MemoryUsage usage;
+        usage.add("values", bytes);
+        return usage;
+    }
+
+    // contiguous values of all rows of the column or nullptr if the column is not stored
+    // for sort, filter and export kernels, valid until values or rows are changed
+    const StorageT* columnData(int column) const
+    {
+        auto values = columnValues(column);
+        return values ? values->data() : nullptr;
     }
 
 protected:
+    bool isThreadSafeImpl() const override { return true; }
+
     T valueIdImpl(GridID id) const override
     {
-        auto it = m_values.find(id.column);
-
-        if (it == m_values.end() || id.row >= (*it).value().size())
+        auto values = columnValues(id.column);
+        if (!values || id.row < 0 || id.row >= int(values->size()))
             throw std::logic_error("Cannot get value");
 
-        return (*it).value()[id.row];
+        return values->at(id.row);
     }
 
     bool setValueIdImpl(GridID id, T value) override
     {
-        auto it = m_values.find(id.column);
+        auto values = columnValues(id.column);
+        if (!values || id.row < 0 || id.row >= int(values->size()))
+            return false;
 
-        if (it != m_values.end() && id.row < (*it).value().size())
-        {
-            (*it).value()[id.row] = value;
-            return true;
-        }
-        else
+        (*values)[id.row] = value;
+        return true;
+    }
+
+    // runs of rows reported by grid iterators look up the column once
+    bool setValueMultipleImpl(IdIterator& it, T value) override
+    {
+        auto gridIt = dynamic_cast<IdIteratorGrid*>(&it);
+        if (!gridIt)
+            return ModelIdTyped<T, GridID>::setValueMultipleImpl(it, value);
+
+        bool result = false;
+        GridColumnSpan span;
+        for (it.atFirst(); gridIt->fetchColumnSpan(span);)
         {
-            return false;
+            auto values = columnValues(span.column);
+            if (!values)
+                continue;
+
+            int row = qMax(span.firstRow, 0);
+            int rowEnd = qMin(span.firstRow + span.rowsCount, int(values->size()));
+            if (row >= rowEnd)
+                continue;
+
+            std::fill(values->begin() + row, values->begin() + rowEnd, value);
+            result = true;
         }
+
+        return result;
     }
 
 private slots:
-    void onRowsChanged(const Lines* lines, ChangeReason reason)
+    void onRowsChanged(const Lines* /*lines*/, ChangeReason reason)
     {
         if (reason & ChangeReasonLinesCount)
         {
@@ -177,48 +1021,108 @@ private slots:
         }
     }
 
+    void onRowsInserted(const Lines* /*lines*/, int row, int rowsCount)
+    {
+        m_rowsCount += rowsCount;
+        for (int i = 0; i < int(m_columns.size()); ++i)
+        {
+            if (m_isColumnStored[i])
+                m_columns[i].insert(m_columns[i].begin() + row, rowsCount, StorageT());
+        }
+    }
+
+    void onRowsRemoved(const Lines* /*lines*/, int row, int rowsCount)
+    {
+        m_rowsCount -= rowsCount;
+        for (int i = 0; i < int(m_columns.size()); ++i)
+        {
+            if (m_isColumnStored[i])
+                m_columns[i].erase(m_columns[i].begin() + row, m_columns[i].begin() + row + rowsCount);
+        }
+    }
+
 private:
+    typedef typename Private::StorageValues<StorageT, Allocator>::type Column;
+
+    const Column* columnValues(int column) const
+    {
+        int index = column - m_minColumn;
+        if (index < 0 || index >= int(m_columns.size()) || !m_isColumnStored[index])
+            return nullptr;
+
+        return &m_columns[index];
+    }
+
+    Column* columnValues(int column)
+    {
+        return const_cast<Column*>(static_cast<const ModelStorageColumns*>(this)->columnValues(column));
+    }
+
+    void connectRows(const SharedPtr<Lines>& rows)
+    {
+        QObject::connect(rows.data(), &Lines::linesChanged, this, &ModelStorageColumns::onRowsChanged);
+        QObject::connect(rows.data(), &Lines::linesInserted, this, &ModelStorageColumns::onRowsInserted);
+        QObject::connect(rows.data(), &Lines::linesRemoved, this, &ModelStorageColumns::onRowsRemoved);
+    }
+
     void init(SharedPtr<Lines> rows, const QSet<int>& columns)
     {
+        connectRows(rows);
         m_rows = std::move(rows);
 
-        QVector<StorageT> emptyValues;
-        for (auto column: columns)
+        if (!columns.isEmpty())
         {
-            m_values[column] = emptyValues;
+            int minColumn = *std::min_element(columns.begin(), columns.end());
+            int maxColumn = *std::max_element(columns.begin(), columns.end());
+            initColumns(minColumn, maxColumn);
+
+            // columns between stored ones stay empty
+            m_isColumnStored.fill(false);
+            for (auto column: columns)
+                m_isColumnStored[column - m_minColumn] = true;
         }
 
-        connect(rows.data(), &Lines::linesChanged, this, &ModelStorageColumns::onRowsChanged);
         resize();
     }
 
     void init(SharedPtr<Lines> rows, int minColumn, int maxColumn)
     {
+        connectRows(rows);
         m_rows = std::move(rows);
 
-        QVector<StorageT> emptyValues;
-        for (int column = minColumn; column <= maxColumn; ++column)
-        {
-            m_values[column] = emptyValues;
-        }
+        if (minColumn <= maxColumn)
+            initColumns(minColumn, maxColumn);
 
-        connect(rows.data(), &Lines::linesChanged, this, &ModelStorageColumns::onRowsChanged);
         resize();
     }
 
+    void initColumns(int minColumn, int maxColumn)
+    {
+        m_minColumn = minColumn;
+        m_columns.resize(maxColumn - minColumn + 1, Private::StorageValues<StorageT, Allocator>::create(m_allocator));
+        m_isColumnStored.fill(true, int(m_columns.size()));
+    }
+
     void resize()
     {
         auto rows = m_rows.toStrongRef();
         Q_ASSERT(rows.data());
 
-        for (auto& values: m_values)
+        m_rowsCount = rows->count();
+        for (int i = 0; i < int(m_columns.size()); ++i)
         {
-            values.value().resize(rows->count());
+            if (m_isColumnStored[i])
+                m_columns[i].resize(m_rowsCount);
         }
     }
 
+    Allocator m_allocator;
     WeakPtr<Lines> m_rows;
-    QMap<int, QVector<StorageT> > m_values;
+    int m_rowsCount = 0;
+    // m_columns[column - m_minColumn] has values of column if m_isColumnStored for it
+    int m_minColumn = 0;
+    std::vector<Column> m_columns;
+    QVector<bool> m_isColumnStored;
 };
 
 template <typename T, typename StorageT = typename std::decay<T>::type>
@@ -229,6 +1133,8 @@ public:
         : m_rows(std::move(rows))
     {
         QObject::connect(m_rows.data(), &Lines::linesChanged, this, &ModelStorageColumn::onRowsChanged);
+        QObject::connect(m_rows.data(), &Lines::linesInserted, this, &ModelStorageColumn::onRowsInserted);
+        QObject::connect(m_rows.data(), &Lines::linesRemoved, this, &ModelStorageColumn::onRowsRemoved);
         resize();
     }
 
@@ -236,25 +1142,38 @@ public:
     {
         auto rows = m_rows.toStrongRef();
         if (rows)
+        {
             QObject::disconnect(rows.data(), &Lines::linesChanged, this, &ModelStorageColumn::onRowsChanged);
+            QObject::disconnect(rows.data(), &Lines::linesInserted, this, &ModelStorageColumn::onRowsInserted);
+            QObject::disconnect(rows.data(), &Lines::linesRemoved, this, &ModelStorageColumn::onRowsRemoved);
+        }
     }
 
     int size() const { return m_values.size(); }
     const QVector<StorageT>& values() const { return m_values; }
+
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage usage;
+        usage.add("values", MemoryUsage::bytes(m_values));
+        return usage;
+    }
     void swapValues(QVector<StorageT>& values)
     {
         Q_ASSERT(m_values.size() == values.size());
         m_values.swap(values);
-        emit modelChanged(this);
+        this->notifyChanged();
     }
 
     void setValueAll(T value)
     {
         m_values.fill(value);
-        emit modelChanged(this);
+        this->notifyChanged();
     }
 
 protected:
+    bool isThreadSafeImpl() const override { return true; }
+
     T valueIdImpl(GridID id) const override
     {
         if (id.row >= m_values.size())
@@ -284,6 +1203,16 @@ private:
             resize();
     }
 
+    void onRowsInserted(const Lines* /*rows*/, int row, int rowsCount)
+    {
+        m_values.insert(row, rowsCount, StorageT());
+    }
+
+    void onRowsRemoved(const Lines* /*rows*/, int row, int rowsCount)
+    {
+        m_values.remove(row, rowsCount);
+    }
+
     void resize()
     {
         auto rows = m_rows.toStrongRef();
@@ -303,6 +1232,8 @@ public:
         : m_columns(std::move(columns))
     {
         connect(m_columns.data(), &Lines::linesChanged, this, ModelStorageRow::onColumnsChanged);
+        connect(m_columns.data(), &Lines::linesInserted, this, &ModelStorageRow::onColumnsInserted);
+        connect(m_columns.data(), &Lines::linesRemoved, this, &ModelStorageRow::onColumnsRemoved);
         resize();
     }
 
@@ -310,25 +1241,38 @@ public:
     {
         auto columns = m_columns.toStrongRef();
         if (columns)
+        {
             disconnect(columns.data(), &Lines::linesChanged, this, ModelStorageRow::onColumnsChanged);
+            disconnect(columns.data(), &Lines::linesInserted, this, &ModelStorageRow::onColumnsInserted);
+            disconnect(columns.data(), &Lines::linesRemoved, this, &ModelStorageRow::onColumnsRemoved);
+        }
     }
 
     int size() const { return m_values.size(); }
     const QVector<StorageT>& values() const { return m_values; }
+
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage usage;
+        usage.add("values", MemoryUsage::bytes(m_values));
+        return usage;
+    }
     void swapValues(QVector<StorageT>& values)
     {
         Q_ASSERT(m_values.size() == values.size());
         m_values.swap(values);
-        emit modelChanged(this);
+        this->notifyChanged();
     }
 
     void setValueAll(T value)
     {
         m_values.fill(value);
-        emit modelChanged(this);
+        this->notifyChanged();
     }
 
 protected:
+    bool isThreadSafeImpl() const override { return true; }
+
     T valueIdImpl(GridID id) const override
     {
         if (id.column >= m_values.size())
@@ -358,6 +1302,16 @@ private:
             resize();
     }
 
+    void onColumnsInserted(const Lines* /*columns*/, int column, int columnsCount)
+    {
+        m_values.insert(column, columnsCount, StorageT());
+    }
+
+    void onColumnsRemoved(const Lines* /*columns*/, int column, int columnsCount)
+    {
+        m_values.remove(column, columnsCount);
+    }
+
     void resize()
     {
         auto columns = m_columns.toStrongRef();
@@ -375,8 +1329,10 @@ template <typename T, typename StorageT = typename std::decay<T>::type>
 class ModelStorageVector: public ModelTyped<T>
 {
 public:
-    ModelStorageVector(ConvertID_t convertID = index)
-        : m_convertID(convertID)
+    // custom convertID should be declared thread safe to let parallel sorting compare values
+    ModelStorageVector(ConvertID_t convertID = index, bool isConvertIDThreadSafe = false)
+        : m_convertID(convertID),
+          m_isConvertIDThreadSafe(isConvertIDThreadSafe || convertID == index)
     {
     }
 
@@ -386,19 +1342,28 @@ public:
 
     size_t size() const { return m_values.size(); }
     const QVector<StorageT>& values() const { return m_values; }
+
+    MemoryUsage memoryUsage() const
+    {
+        MemoryUsage usage;
+        usage.add("values", MemoryUsage::bytes(m_values));
+        return usage;
+    }
     void setValues(QVector<StorageT> values)
     {
         m_values = std::move(values);
-        emit this->modelChanged(this);
+        this->notifyChanged();
     }
 
     void setValueAll(T value, int size = -1)
     {
         m_values.fill(value, size);
-        emit this->modelChanged(this);
+        this->notifyChanged();
     }
 
 protected:
+    bool isThreadSafeImpl() const override { return m_isConvertIDThreadSafe; }
+
     T valueImpl(ID id) const override
     {
         auto index = m_convertID(id);
@@ -426,6 +1391,7 @@ protected:
 private:
     QVector<StorageT> m_values;
     ConvertID_t m_convertID;
+    bool m_isConvertIDThreadSafe;
 };
 
 } // end namespace Qi
@@ -0,0 +1,161 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_MODEL_STORE_SNAPSHOT_H
+#define QI_MODEL_STORE_SNAPSHOT_H
+
+#include "ModelStore.h"
+#include <QHash>
+
+namespace Qi
+{
+
+// applies keyed snapshots of rows to grid rows and ModelStorageGrid
+// as removed and inserted runs of rows plus changed cells only,
+// so cache items, selection and scroll position survive unchanged rows
+template <typename Key, typename T, typename StorageT = typename std::decay<T>::type, typename LayoutT = StorageGridColumns, typename Allocator = std::allocator<StorageT>>
+class ModelStorageSnapshot
+{
+    Q_DISABLE_COPY(ModelStorageSnapshot)
+
+public:
+    struct Stats
+    {
+        int removedRows = 0;
+        int insertedRows = 0;
+        int changedCells = 0;
+    };
+
+    ModelStorageSnapshot(SharedPtr<SpaceGrid> grid, SharedPtr<ModelStorageGrid<T, StorageT, LayoutT, Allocator>> model)
+        : m_grid(std::move(grid)),
+          m_model(std::move(model))
+    {
+        Q_ASSERT(m_grid);
+        Q_ASSERT(m_model);
+    }
+
+    // keys of current grid rows
+    const QVector<Key>& keys() const { return m_keys; }
+
+    // keys should be unique, values[i] has values of the row with keys[i] by columns
+    Stats apply(const QVector<Key>& keys, const QVector<QVector<StorageT>>& values)
+    {
+        Q_ASSERT(keys.size() == values.size());
+
+        Stats stats;
+        auto& rows = *m_grid->rows();
+
+        // rows not produced by previous snapshots are unknown
+        if (m_keys.size() != rows.count())
+        {
+            stats.removedRows += rows.count();
+            rows.removeLines(0, rows.count());
+            m_keys.clear();
+        }
+
+        QHash<Key, int> newRows;
+        newRows.reserve(keys.size());
+        for (int i = 0; i < keys.size(); ++i)
+            newRows.insert(keys[i], i);
+
+        // keep rows which order agrees with the snapshot, others are removed
+        // and inserted back at new positions
+        QVector<bool> isKept(m_keys.size(), false);
+        int lastKept = -1;
+        for (int row = 0; row < m_keys.size(); ++row)
+        {
+            int newRow = newRows.value(m_keys[row], -1);
+            if (newRow > lastKept)
+            {
+                isKept[row] = true;
+                lastKept = newRow;
+            }
+        }
+
+        // remove runs from the end to not shift runs not processed yet
+        for (int row = m_keys.size() - 1; row >= 0;)
+        {
+            if (isKept[row])
+            {
+                --row;
+                continue;
+            }
+
+            int last = row;
+            while (row >= 0 && !isKept[row])
+                --row;
+
+            int count = last - row;
+            rows.removeLines(row + 1, count);
+            m_keys.remove(row + 1, count);
+            stats.removedRows += count;
+        }
+
+        // insert runs of new rows before the next kept row
+        for (int newRow = 0; newRow < keys.size();)
+        {
+            if (newRow < m_keys.size() && m_keys[newRow] == keys[newRow])
+            {
+                ++newRow;
+                continue;
+            }
+
+            // kept keys are a subsequence of the snapshot keys,
+            // so each mismatched key is a new row
+            int first = newRow;
+            while (newRow < keys.size() && (newRow >= m_keys.size() || m_keys[newRow] != keys[newRow]))
+            {
+                m_keys.insert(newRow, keys[newRow]);
+                ++newRow;
+            }
+
+            rows.insertLines(first, newRow - first);
+            stats.insertedRows += newRow - first;
+        }
+
+        Q_ASSERT(m_keys == keys);
+
+        // update changed cells, cache items are notified by changed ids
+        ModelUpdateGuard guard(*m_model);
+        int columnsCount = m_model->columnsCount();
+        for (int row = 0; row < values.size(); ++row)
+        {
+            const auto& rowValues = values[row];
+            int n = qMin(rowValues.size(), columnsCount);
+            for (int column = 0; column < n; ++column)
+            {
+                GridID id(row, column);
+                if (m_model->valueAt(id) == rowValues[column])
+                    continue;
+
+                m_model->setValueId(id, rowValues[column]);
+                ++stats.changedCells;
+            }
+        }
+
+        return stats;
+    }
+
+private:
+    SharedPtr<SpaceGrid> m_grid;
+    SharedPtr<ModelStorageGrid<T, StorageT, LayoutT, Allocator>> m_model;
+    QVector<Key> m_keys;
+};
+
+} // end namespace Qi
+
+#endif // QI_MODEL_STORE_SNAPSHOT_H
@@ -19,6 +19,10 @@
 
 #include "core/Model.h"
 #include "core/ItemsIterator.h"
+#include "utils/RadixSort.h"
+#include "utils/ParallelSort.h"
+#include <vector>
+#include <algorithm>
 
 namespace Qi
 {
@@ -35,6 +39,92 @@ namespace Private
         else
             return 0;
     }
+
+    // stable sorts (key, line) pairs by keys
+    template<typename T>
+    bool sortKeys(std::vector<std::pair<T, int>>& keys, bool ascending, const std::function<bool(int)>& progress, std::false_type /*isNumeric*/)
+    {
+        typedef std::pair<T, int> Key;
+        if (ascending)
+            return stableSortProgressive(keys.begin(), keys.end(), [](const Key& left, const Key& right) { return left.first < right.first; }, progress);
+        else
+            return stableSortProgressive(keys.begin(), keys.end(), [](const Key& left, const Key& right) { return right.first < left.first; }, progress);
+    }
+
+    template<typename T>
+    bool sortKeys(std::vector<std::pair<T, int>>& keys, bool ascending, const std::function<bool(int)>& progress, std::true_type /*isNumeric*/)
+    {
+        if (keys.size() < size_t(RadixSortMinSize))
+            return sortKeys(keys, ascending, progress, std::false_type());
+        else
+            return radixSortKeys(keys, ascending, progress);
+    }
+
+    template<typename T>
+    bool sortKeys(std::vector<std::pair<T, int>>& keys, bool ascending, const std::function<bool(int)>& progress = nullptr)
+    {
+        // numeric keys are sorted by radix sort
+        return sortKeys(keys, ascending, progress, typename std::is_arithmetic<T>::type());
+    }
+
+    // types with tiny value domain map values to ordinal keys in [0, count)
+    template<typename T>
+    struct OrdinalTraits
+    {
+        enum { count = 0 };
+        static int key(const T&) { return 0; }
+    };
+
+    template<>
+    struct OrdinalTraits<bool>
+    {
+        enum { count = 2 };
+        static int key(bool value) { return value ? 1 : 0; }
+    };
+
+    template<>
+    struct OrdinalTraits<Qt::CheckState>
+    {
+        enum { count = 3 };
+        static int key(Qt::CheckState value) { return qBound(0, int(value), 2); }
+    };
+}
+
+template <typename T>
+class ModelSortKeysTyped: public ModelSortKeys
+{
+public:
+    explicit ModelSortKeysTyped(std::vector<std::pair<T, int>> keys)
+        : m_keys(std::move(keys))
+    {}
+
+protected:
+    bool sortImpl(bool ascending, QVector<int>& lines, const std::function<bool(int)>& progress) override
+    {
+        if (!Private::sortKeys(m_keys, ascending, progress))
+            return false;
+
+        lines.resize(int(m_keys.size()));
+        for (int i = 0, n = lines.size(); i < n; ++i)
+            lines[i] = m_keys[i].second;
+
+        return true;
+    }
+
+private:
+    std::vector<std::pair<T, int>> m_keys;
+};
+
+// extracts key for each line once
+template <typename T, typename KeyFn>
+SharedPtr<ModelSortKeys> makeModelSortKeys(const QVector<int>& lines, const std::function<ID(int)>& lineToId, const KeyFn& keyFn)
+{
+    std::vector<std::pair<T, int>> keys;
+    keys.reserve(lines.size());
+    for (int line: lines)
+        keys.emplace_back(keyFn(lineToId(line)), line);
+
+    return makeShared<ModelSortKeysTyped<T>>(std::move(keys));
 }
 
 // typed Model - represents T values
@@ -55,7 +145,7 @@ public:
     {
         if (setValueImpl(id, value))
         {
-            emit modelChanged(this);
+            notifyItemChanged(id);
             return true;
         }
         return false;
@@ -65,7 +155,7 @@ public:
     {
         if (setValueMultipleImpl(itemsIterator, value))
         {
-            emit modelChanged(this);
+            notifyChanged();
             return true;
         }
         return false;
@@ -74,6 +164,16 @@ public:
 protected:
     int compareImpl(ID left, ID right) const override { return Private::compareValues(value(left), value(right)); }
     bool isAscendingDefaultImpl(ID /*item*/) const override { return m_ascendingDefault; }
+    // sorts by values extracted once per line
+    // should be overridden together with compareImpl
+    SharedPtr<ModelSortKeys> sortKeysImpl(const QVector<int>& lines, const std::function<ID(int)>& lineToId) const override
+    {
+        return makeModelSortKeys<ValueType_t>(lines, lineToId, [this](ID id) { return value(id); });
+    }
+    // bool and Qt::CheckState values are counting sorted
+    // should be overridden together with compareImpl
+    int ordinalKeysCountImpl() const override { return Private::OrdinalTraits<typename std::decay<T>::type>::count; }
+    int ordinalKeyImpl(ID id) const override { return Private::OrdinalTraits<typename std::decay<T>::type>::key(value(id)); }
 
     virtual ValueType_t valueImpl(ID id) const = 0;
     virtual bool setValueImpl(ID id, ValueType_t value) = 0;
@@ -81,10 +181,13 @@ protected:
     {
         bool result = false;
 
-        for (it.atFirst(); it.isValid(); it.toNext())
+        // fetch items by batches to not make virtual calls per item
+        ID ids[IdIterator::BatchSize];
+        it.atFirst();
+        while (int count = it.fetchIds(ids, IdIterator::BatchSize))
         {
-            bool itemResult = setValueImpl(it.id(), value);
-            result |= itemResult;
+            for (int i = 0; i < count; ++i)
+                result |= setValueImpl(ids[i], value);
         }
 
         return result;
@@ -103,7 +206,7 @@ public:
     {
         if (setValueIdImpl(id, value))
         {
-            emit modelChanged(this);
+            this->notifyItemChanged(ID(id));
             return true;
         }
         return false;
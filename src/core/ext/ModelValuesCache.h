@@ -0,0 +1,114 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_MODEL_VALUES_CACHE_H
+#define QI_MODEL_VALUES_CACHE_H
+
+#include "core/Model.h"
+#include <QHash>
+
+namespace Qi
+{
+
+// memoizes values computed from a source model per item
+// models forward source notifications through it,
+// so only changed items are dropped and re-notified
+template <typename T>
+class ModelValuesCache
+{
+    Q_DISABLE_COPY(ModelValuesCache)
+
+public:
+    explicit ModelValuesCache(int limit = 16384)
+        : m_limit(limit),
+          m_isEnabled(false),
+          m_isItemsNotified(false)
+    {
+        Q_ASSERT(m_limit > 0);
+    }
+
+    bool isEnabled() const { return m_isEnabled; }
+    void setEnabled(bool isEnabled)
+    {
+        m_isEnabled = isEnabled;
+        clear();
+    }
+
+    template <typename Compute>
+    T value(ID id, const Compute& compute) const
+    {
+        if (!m_isEnabled)
+            return compute(id);
+
+        auto it = m_values.constFind(id);
+        if (it != m_values.constEnd())
+            return it.value();
+
+        // keep memory bounded, visible items are cached again quickly
+        if (m_values.size() >= m_limit)
+            m_values.clear();
+
+        return m_values.insert(id, compute(id)).value();
+    }
+
+    void clear() { m_values.clear(); }
+
+    // forwards source model signals to owner model notifications
+    template <typename NotifyItem, typename NotifyAll>
+    void connectSource(const Model* source, Model* owner, const NotifyItem& notifyItem, const NotifyAll& notifyAll)
+    {
+        QObject::connect(source, &Model::modelItemChanged, owner, [this, notifyItem](const Model*, ID id) {
+            m_values.remove(id);
+            m_isItemsNotified = true;
+            notifyItem(id);
+        });
+        QObject::connect(source, &Model::modelItemsChanged, owner, [this, owner, notifyItem](const Model*, const QVector<ID>& ids) {
+            // single item was reported by modelItemChanged already
+            if (m_isItemsNotified)
+                return;
+
+            m_isItemsNotified = true;
+            ModelUpdateGuard guard(*owner);
+            for (ID id : ids)
+            {
+                m_values.remove(id);
+                notifyItem(id);
+            }
+        });
+        QObject::connect(source, &Model::modelChanged, owner, [this, notifyAll](const Model*) {
+            // modelChanged follows item notifications
+            if (m_isItemsNotified)
+            {
+                m_isItemsNotified = false;
+                return;
+            }
+
+            m_values.clear();
+            notifyAll();
+        });
+    }
+
+private:
+    int m_limit;
+    bool m_isEnabled;
+    bool m_isItemsNotified;
+    mutable QHash<ID, T> m_values;
+};
+
+} // end namespace Qi
+
+#endif // QI_MODEL_VALUES_CACHE_H
@@ -15,6 +15,7 @@
 */
 
 #include "Ranges.h"
+#include <algorithm>
 
 namespace Qi
 {
@@ -22,7 +23,7 @@ namespace Qi
 RangeSelection& RangeSelection::operator=(const RangeSelection& other)
 {
     m_ranges = other.m_ranges;
-    emit rangeChanged(this, ChangeReasonRange);
+    emitRangeChanged(ChangeReasonRange);
 
     return *this;
 }
@@ -30,14 +31,14 @@ RangeSelection& RangeSelection::operator=(const RangeSelection& other)
 void RangeSelection::clear()
 {
     m_ranges.clear();
-    emit rangeChanged(this, ChangeReasonRange);
+    emitRangeChanged(ChangeReasonRange);
 }
 
 void RangeSelection::addRange(SharedPtr<Range> range, bool exclude)
 {
     RangeInfo info = { std::move(range), exclude };
     m_ranges.append(info);
-    emit rangeChanged(this, ChangeReasonRange);
+    emitRangeChanged(ChangeReasonRange);
 }
 
 bool RangeSelection::hasItemImpl(ID id) const
@@ -54,6 +55,33 @@ bool RangeSelection::hasItemImpl(ID id) const
     return !excluded;
 }
 
+void RangeSelection::hasItemsImpl(const ID* ids, bool* results, int count) const
+{
+    std::fill(results, results + count, false);
+
+    // one batch query per range
+    QVector<bool> rangeResults(count);
+    for (const auto& range: m_ranges)
+    {
+        range.range->hasItems(ids, rangeResults.data(), count);
+        for (int i = 0; i < count; ++i)
+        {
+            if (rangeResults[i])
+                results[i] = !range.exclude;
+        }
+    }
+}
+
+int RangeSelection::uniformityImpl() const
+{
+    // uniform only if all ranges are uniform in the same way
+    int uniformity = RangeUniform;
+    for (const auto& range: m_ranges)
+        uniformity &= range.range->uniformity();
+
+    return uniformity;
+}
+
 RangeNone::RangeNone()
 {
 }
@@ -63,6 +91,11 @@ bool RangeNone::hasItemImpl(ID /*id*/) const
     return false;
 }
 
+void RangeNone::hasItemsImpl(const ID* /*ids*/, bool* results, int count) const
+{
+    std::fill(results, results + count, false);
+}
+
 SharedPtr<RangeNone> makeRangeNone()
 {
     return makeShared<RangeNone>();
@@ -77,6 +110,11 @@ bool RangeAll::hasItemImpl(ID /*id*/) const
     return true;
 }
 
+void RangeAll::hasItemsImpl(const ID* /*ids*/, bool* results, int count) const
+{
+    std::fill(results, results + count, true);
+}
+
 SharedPtr<RangeAll> makeRangeAll()
 {
     return makeShared<RangeAll>();
@@ -92,7 +130,7 @@ void RangeID::setId(ID id)
     if (m_id != id)
     {
         m_id = id;
-        emit rangeChanged(this, ChangeReasonRange);
+        emitRangeChanged(ChangeReasonRange);
     }
 }
 
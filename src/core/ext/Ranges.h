@@ -55,16 +55,21 @@ public:
     void clear();
     void addRange(SharedPtr<Range> range, bool exclude);
 
-protected:
-    bool hasItemImpl(ID id) const override;
-
-private:
     struct RangeInfo
     {
         SharedPtr<Range> range;
         bool exclude;
     };
 
+    // ranges in order of addition, later ranges override earlier ones
+    const QVector<RangeInfo>& ranges() const { return m_ranges; }
+
+protected:
+    bool hasItemImpl(ID id) const override;
+    void hasItemsImpl(const ID* ids, bool* results, int count) const override;
+    int uniformityImpl() const override;
+
+private:
     QVector<RangeInfo> m_ranges;
 };
 
@@ -77,6 +82,8 @@ public:
     
 protected:
     bool hasItemImpl(ID id) const override;
+    void hasItemsImpl(const ID* ids, bool* results, int count) const override;
+    int uniformityImpl() const override { return RangeUniform; }
 };
 QI_EXPORT SharedPtr<RangeNone> makeRangeNone();
 
@@ -89,6 +96,8 @@ public:
     
 protected:
     bool hasItemImpl(ID id) const override;
+    void hasItemsImpl(const ID* ids, bool* results, int count) const override;
+    int uniformityImpl() const override { return RangeUniform; }
 };
 QI_EXPORT SharedPtr<RangeAll> makeRangeAll();
 
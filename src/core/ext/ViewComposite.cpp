@@ -21,14 +21,16 @@ namespace Qi
 
 ViewComposite::ViewComposite(const QVector<ViewSchema>& subViews, const QMargins& margins)
     : m_subViews(subViews),
-      m_margins(margins)
+      m_margins(margins),
+      m_isPlanValid(false)
 {
     Q_ASSERT(!m_subViews.isEmpty());
     connectSubViews();
 }
 
 ViewComposite::ViewComposite(SharedPtr<View> subView, const QMargins& margins)
-    : m_margins(margins)
+    : m_margins(margins),
+      m_isPlanValid(false)
 {
     m_subViews.push_back(ViewSchema(makeLayoutClient(), std::move(subView)));
     connectSubViews();
@@ -44,6 +46,7 @@ void ViewComposite::setMargins(const QMargins& margins)
     if (m_margins != margins)
     {
         m_margins = margins;
+        m_isPlanValid = false;
         emitViewChanged(ChangeReasonViewSize);
     }
 }
@@ -65,7 +68,9 @@ CacheView2* ViewComposite::addCacheViewImpl(const Layout& layout, const GuiConte
 
     QRect localRect = selfCacheView->rect().marginsRemoved(m_margins);
 
-    for (const auto& subView: m_subViews)
+    validatePlan();
+    selfCacheView->rSubViews().reserve(m_plan.size());
+    for (const auto& subView: m_plan)
     {
         subView.view->addCacheView(*subView.layout, ctx, id, selfCacheView->rSubViews(), localRect, visibleItemRect);
     }
@@ -88,6 +93,26 @@ QSize ViewComposite::sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMod
                  size.height() + m_margins.top() + m_margins.bottom());
 }
 
+bool ViewComposite::isSizeUniformImpl() const
+{
+    for (const auto& subView: m_subViews)
+    {
+        if (!subView.view->isSizeUniform())
+            return false;
+    }
+    return true;
+}
+
+bool ViewComposite::isCacheViewUniformImpl() const
+{
+    for (const auto& subView: m_subViews)
+    {
+        if (!subView.view->isCacheViewUniform())
+            return false;
+    }
+    return true;
+}
+
 void ViewComposite::drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* /*showTooltip*/) const
 {
     for (const auto& subCacheView: cache.cacheView.subViews())
@@ -137,6 +162,7 @@ void ViewComposite::connectSubViews()
     for (const auto& view: m_subViews)
     {
         connect(view.view.data(), &View::viewChanged, this, &ViewComposite::onSubViewChanged);
+        connect(view.view.data(), &View::viewItemsChanged, this, &ViewComposite::onSubViewItemsChanged);
     }
 }
 
@@ -145,13 +171,53 @@ void ViewComposite::disconnectSubViews()
     for (const auto& view: m_subViews)
     {
         disconnect(view.view.data(), &View::viewChanged, this, &ViewComposite::onSubViewChanged);
+        disconnect(view.view.data(), &View::viewItemsChanged, this, &ViewComposite::onSubViewItemsChanged);
     }
 }
 
+bool ViewComposite::isFlattenable(const Layout& layout) const
+{
+    // composite occupies all remaining item space and has no own behavior
+    return (metaObject() == &ViewComposite::staticMetaObject) && layout.isFinal() && m_margins.isNull()
+            && !hasController() && !tooltipTextCallback;
+}
+
+void ViewComposite::validatePlan() const
+{
+    if (m_isPlanValid)
+        return;
+
+    m_plan = m_subViews;
+
+    // last nested composite draws and cleans up its sub views right before
+    // parent cleanup, so its sub views behave the same way as parent ones
+    while (!m_plan.isEmpty())
+    {
+        const ViewSchema& lastView = m_plan.back();
+        auto nestedComposite = qobject_cast<const ViewComposite*>(lastView.view.data());
+        if (!nestedComposite || !nestedComposite->isFlattenable(*lastView.layout))
+            break;
+
+        QVector<ViewSchema> nestedViews = nestedComposite->m_subViews;
+        m_plan.removeLast();
+        m_plan += nestedViews;
+    }
+
+    m_isPlanValid = true;
+}
+
 void ViewComposite::onSubViewChanged(const View* /*view*/, ChangeReason reason)
 {
+    m_isPlanValid = false;
+
     // forward signal
     emitViewChanged(reason);
 }
 
+void ViewComposite::onSubViewItemsChanged(const View* /*view*/, const QVector<ID>& items)
+{
+    // forward signal
+    emitViewItemsChanged(items);
+}
+
 } // end namespace Qi
@@ -42,20 +42,36 @@ protected:
     void addViewImpl(ID id, QVector<const View*>& views) const override;
     CacheView2* addCacheViewImpl(const Layout& layout, const GuiContext& ctx, ID id, QVector<CacheView2>& cacheViews, QRect& itemRect, QRect* visibleItemRect) const override;
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
+    bool isSizeUniformImpl() const override;
+    bool isCacheViewUniformImpl() const override;
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    // draws sub views in order
+    bool isDrawBatchableImpl() const override { return true; }
+    // sub views are checked by their own cache views
+    bool isDrawThreadSafeImpl() const override { return true; }
     //void cleanupDrawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache) const override;
     bool textImpl(ID id, QString& txt) const override;
 
 private slots:
     void onSubViewChanged(const View* view, ChangeReason reason);
+    void onSubViewItemsChanged(const View* view, const QVector<ID>& items);
 
 private:
     void connectSubViews();
     void disconnectSubViews();
 
+    // true if sub views can be laid out and drawn as sub views of parent composite
+    bool isFlattenable(const Layout& layout) const;
+    void validatePlan() const;
+
     QVector<ViewSchema> m_subViews;
     // TODO: margins should be moved to Layout
     QMargins m_margins;
+
+    // m_subViews with sub views of trailing nested composites instead of them
+    // cache views are created by this flat list without recursion
+    mutable QVector<ViewSchema> m_plan;
+    mutable bool m_isPlanValid;
 };
 
 } // end namespace Qi
@@ -31,11 +31,15 @@ public:
     {
         Q_ASSERT(m_model);
         connect(m_model.data(), &Model::modelChanged, this, &ViewModeled::onModelChanged);
+        connect(m_model.data(), &Model::modelItemChanged, this, &ViewModeled::onModelItemChanged);
+        connect(m_model.data(), &Model::modelItemsChanged, this, &ViewModeled::onModelItemsChanged);
     }
 
     ~ViewModeled()
     {
         disconnect(m_model.data(), &Model::modelChanged, this, &ViewModeled::onModelChanged);
+        disconnect(m_model.data(), &Model::modelItemChanged, this, &ViewModeled::onModelItemChanged);
+        disconnect(m_model.data(), &Model::modelItemsChanged, this, &ViewModeled::onModelItemsChanged);
     }
 
     const SharedPtr<Model_t>& theModel() const { return m_model; }
@@ -44,10 +48,26 @@ protected:
     Model* modelImpl() override { return m_model.data(); }
 
 private slots:
-    void onModelChanged(const Model*) { emitViewChanged(ChangeReasonViewContent); }
+    void onModelChanged(const Model*)
+    {
+        if (m_changedItems.isEmpty())
+        {
+            emitViewChanged(ChangeReasonViewContent);
+            return;
+        }
+
+        // only known items were changed
+        QVector<ID> items;
+        items.swap(m_changedItems);
+        emitViewItemsChanged(items);
+    }
+    // item signals come before modelChanged
+    void onModelItemChanged(const Model*, ID id) { m_changedItems = QVector<ID>(1, id); }
+    void onModelItemsChanged(const Model*, const QVector<ID>& ids) { m_changedItems = ids; }
 
 private:
     SharedPtr<Model_t> m_model;
+    QVector<ID> m_changedItems;
 };
 
 } // end namespace Qi
@@ -0,0 +1,112 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "ViewStaticSchema.h"
+
+namespace Qi
+{
+
+ViewStaticSchemaBase::ViewStaticSchemaBase(const QVector<SharedPtr<View>>& subViews, const QMargins& margins)
+    : m_subViews(subViews),
+      m_margins(margins)
+{
+    Q_ASSERT(!m_subViews.isEmpty());
+
+    for (const auto& subView: m_subViews)
+    {
+        connect(subView.data(), &View::viewChanged, this, &ViewStaticSchemaBase::onSubViewChanged);
+        connect(subView.data(), &View::viewItemsChanged, this, &ViewStaticSchemaBase::onSubViewItemsChanged);
+    }
+}
+
+ViewStaticSchemaBase::~ViewStaticSchemaBase()
+{
+    for (const auto& subView: m_subViews)
+    {
+        disconnect(subView.data(), &View::viewChanged, this, &ViewStaticSchemaBase::onSubViewChanged);
+        disconnect(subView.data(), &View::viewItemsChanged, this, &ViewStaticSchemaBase::onSubViewItemsChanged);
+    }
+}
+
+void ViewStaticSchemaBase::setMargins(const QMargins& margins)
+{
+    if (m_margins != margins)
+    {
+        m_margins = margins;
+        emitViewChanged(ChangeReasonViewSize);
+    }
+}
+
+void ViewStaticSchemaBase::addViewImpl(ID id, QVector<const View*>& views) const
+{
+    View::addViewImpl(id, views);
+    for (const auto& subView: m_subViews)
+    {
+        subView->addView(id, views);
+    }
+}
+
+bool ViewStaticSchemaBase::isSizeUniformImpl() const
+{
+    for (const auto& subView: m_subViews)
+    {
+        if (!subView->isSizeUniform())
+            return false;
+    }
+    return true;
+}
+
+bool ViewStaticSchemaBase::isCacheViewUniformImpl() const
+{
+    for (const auto& subView: m_subViews)
+    {
+        if (!subView->isCacheViewUniform())
+            return false;
+    }
+    return true;
+}
+
+bool ViewStaticSchemaBase::textImpl(ID id, QString& txt) const
+{
+    bool isAnySubText = false;
+
+    for (const auto& subView: m_subViews)
+    {
+        QString subText;
+        if (subView->text(id, subText))
+        {
+            isAnySubText = true;
+            txt += subText;
+        }
+    }
+
+    return isAnySubText;
+}
+
+void ViewStaticSchemaBase::onSubViewChanged(const View* /*view*/, ChangeReason reason)
+{
+    // forward signal
+    emitViewChanged(reason);
+}
+
+void ViewStaticSchemaBase::onSubViewItemsChanged(const View* /*view*/, const QVector<ID>& items)
+{
+    // forward signal
+    emitViewItemsChanged(items);
+}
+
+} // end namespace Qi
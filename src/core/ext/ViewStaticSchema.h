@@ -0,0 +1,454 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_VIEW_STATIC_SCHEMA_H
+#define QI_VIEW_STATIC_SCHEMA_H
+
+#include "core/View.h"
+#include "Layouts.h"
+#include <QMargins>
+#include <tuple>
+#include <type_traits>
+
+namespace Qi
+{
+
+// ViewT which implementation is called without virtual dispatch by ViewStaticSchema
+// it's created instead of ViewT, e.g. makeViewStatic<ViewText>(model)
+template <typename ViewT>
+class ViewStatic final: public ViewT
+{
+public:
+    using ViewT::ViewT;
+
+    // calls ViewT implementation directly (see CacheView2::drawDirect)
+    void drawDirect(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const
+    {
+        ViewT::drawImpl(painter, ctx, cache, showTooltip);
+
+        if (showTooltip && this->tooltipTextCallback)
+            *showTooltip = true;
+    }
+
+    void cleanupDrawDirect(QPainter* painter, const GuiContext& ctx, const CacheContext& cache) const
+    {
+        ViewT::cleanupDrawImpl(painter, ctx, cache);
+    }
+
+    // true if ViewT adds one cache view without sub views by View::addCacheViewImpl
+    static bool isCacheViewPlain()
+    {
+        typedef CacheView2* (View::*AddCacheView)(const Layout&, const GuiContext&, ID, QVector<CacheView2>&, QRect&, QRect*) const;
+        return std::is_same<decltype(&ViewStatic::addCacheViewImpl), AddCacheView>::value;
+    }
+};
+
+template <typename ViewT, typename... Args>
+SharedPtr<ViewStatic<ViewT>> makeViewStatic(Args && ...arguments)
+{
+    return makeShared<ViewStatic<ViewT>>(std::forward<Args>(arguments)...);
+}
+
+namespace Impl
+{
+
+// inline counterparts of layouts from Layouts.h
+// view size is requested by viewSize() only if layout depends on it
+struct StaticLayoutClient
+{
+    template <typename ViewSize>
+    static void doLayout(const ViewSize& /*viewSize*/, QRect& viewRect, QRect& itemRect, bool isTransparent)
+    {
+        viewRect = itemRect;
+        if (!isTransparent)
+            itemRect.setLeft(viewRect.right()+1);
+    }
+
+    static void expandSize(QSize viewSize, QSize& size)
+    {
+        size.rwidth() += (viewSize.width()+1);
+        size.rheight() += (viewSize.height()+1);
+    }
+
+    static SharedPtr<Layout> makeLayout(LayoutBehaviorMask behavior) { return makeShared<LayoutClient>(behavior); }
+};
+
+struct StaticLayoutCenter
+{
+    template <typename ViewSize>
+    static void doLayout(const ViewSize& viewSize, QRect& viewRect, QRect& itemRect, bool /*isTransparent*/)
+    {
+        viewRect = itemRect;
+
+        QSize size = viewSize();
+
+        int deltaHeight = (itemRect.height() - size.height()) / 2;
+        if (deltaHeight > 0)
+        {
+            viewRect.setTop(viewRect.top() + deltaHeight);
+            viewRect.setBottom(viewRect.bottom() - deltaHeight);
+        }
+
+        int deltaWidth = (itemRect.width() - size.width()) / 2;
+        if (deltaWidth > 0)
+        {
+            viewRect.setLeft(viewRect.left() + deltaWidth);
+            viewRect.setRight(viewRect.right() - deltaWidth);
+        }
+    }
+
+    static void expandSize(QSize viewSize, QSize& size)
+    {
+        size.rwidth() = qMax(size.width(), viewSize.width());
+        size.rheight() = qMax(size.height(), viewSize.height());
+    }
+
+    static SharedPtr<Layout> makeLayout(LayoutBehaviorMask behavior) { return makeShared<LayoutCenter>(behavior); }
+};
+
+struct StaticLayoutHor
+{
+    static void expandSize(QSize viewSize, QSize& size)
+    {
+        size.rwidth() += (viewSize.width()+1);
+        size.rheight() = qMax(size.height(), viewSize.height());
+    }
+};
+
+struct StaticLayoutVer
+{
+    static void expandSize(QSize viewSize, QSize& size)
+    {
+        size.rwidth() = qMax(size.width(), viewSize.width());
+        size.rheight() += (viewSize.height()+1);
+    }
+};
+
+struct StaticLayoutLeft: StaticLayoutHor
+{
+    template <typename ViewSize>
+    static void doLayout(const ViewSize& viewSize, QRect& viewRect, QRect& itemRect, bool isTransparent)
+    {
+        viewRect = itemRect;
+        viewRect.setRight(qMin(viewRect.right(), viewRect.left() + viewSize().width()));
+        if (!isTransparent)
+            itemRect.setLeft(viewRect.right()+1);
+    }
+
+    static SharedPtr<Layout> makeLayout(LayoutBehaviorMask behavior) { return makeShared<LayoutLeft>(behavior); }
+};
+
+struct StaticLayoutRight: StaticLayoutHor
+{
+    template <typename ViewSize>
+    static void doLayout(const ViewSize& viewSize, QRect& viewRect, QRect& itemRect, bool isTransparent)
+    {
+        viewRect = itemRect;
+        viewRect.setLeft(qMax(viewRect.left(), viewRect.right() - viewSize().width()));
+        if (!isTransparent)
+            itemRect.setRight(viewRect.left()-1);
+    }
+
+    static SharedPtr<Layout> makeLayout(LayoutBehaviorMask behavior) { return makeShared<LayoutRight>(behavior); }
+};
+
+struct StaticLayoutTop: StaticLayoutVer
+{
+    template <typename ViewSize>
+    static void doLayout(const ViewSize& viewSize, QRect& viewRect, QRect& itemRect, bool isTransparent)
+    {
+        viewRect = itemRect;
+        viewRect.setBottom(qMin(viewRect.bottom(), viewRect.top() + viewSize().height()));
+        if (!isTransparent)
+            itemRect.setTop(viewRect.bottom()+1);
+    }
+
+    static SharedPtr<Layout> makeLayout(LayoutBehaviorMask behavior) { return makeShared<LayoutTop>(behavior); }
+};
+
+struct StaticLayoutBottom: StaticLayoutVer
+{
+    template <typename ViewSize>
+    static void doLayout(const ViewSize& viewSize, QRect& viewRect, QRect& itemRect, bool isTransparent)
+    {
+        viewRect = itemRect;
+        viewRect.setTop(qMax(viewRect.top(), viewRect.bottom() - viewSize().height()));
+        if (!isTransparent)
+            itemRect.setBottom(viewRect.top()-1);
+    }
+
+    static SharedPtr<Layout> makeLayout(LayoutBehaviorMask behavior) { return makeShared<LayoutBottom>(behavior); }
+};
+
+} // end namespace Impl
+
+// sub view of ViewStaticSchema laid out by LayoutT
+template <typename ViewT, typename LayoutT, LayoutBehaviorMask Behavior>
+class StaticSlot
+{
+public:
+    typedef ViewStatic<ViewT> ViewType;
+
+    explicit StaticSlot(SharedPtr<ViewType> view)
+        : m_view(std::move(view))
+    {
+        Q_ASSERT(m_view);
+    }
+
+    const SharedPtr<ViewType>& view() const { return m_view; }
+
+    static bool isTransparent() { return Behavior & LayoutBehaviorTransparent; }
+    static bool isFloat() { return Behavior & LayoutBehaviorFloat; }
+
+    // the same layout as Layout object for views with own sub views
+    static const Layout& layout()
+    {
+        static SharedPtr<Layout> layout = LayoutT::makeLayout(Behavior);
+        return *layout;
+    }
+
+    void addCacheView(const GuiContext& ctx, ID id, QVector<CacheView2>& cacheViews, QRect& itemRect, QRect* visibleItemRect) const
+    {
+        if (!ViewType::isCacheViewPlain())
+        {
+            m_view->addCacheView(layout(), ctx, id, cacheViews, itemRect, visibleItemRect);
+            return;
+        }
+
+        if (ctx.isDraft() && !m_view->isDrawnInDraft())
+            return;
+
+        const ViewType& view = *m_view;
+        auto viewSize = [&view, &ctx, id]()->QSize {
+            return Layout::viewSize(view, ctx, id, ViewSizeModeExact);
+        };
+
+        QRect viewRect(0, 0, 0, 0);
+        LayoutT::doLayout(viewSize, viewRect, itemRect, isTransparent());
+        if (isFloat() && visibleItemRect)
+            LayoutT::doLayout(viewSize, viewRect, *visibleItemRect, isTransparent());
+
+        cacheViews.append(CacheView2(m_view.data(), viewRect));
+    }
+
+    void expandSize(const GuiContext& ctx, ID id, ViewSizeMode sizeMode, QSize& size) const
+    {
+        if (!isTransparent())
+            LayoutT::expandSize(Layout::viewSize(*m_view, ctx, id, sizeMode), size);
+    }
+
+    // cache views of slots are matched in order, views skipped in draft have no cache views
+    void draw(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, int& subViewIndex) const
+    {
+        const auto& subViews = cache.cacheView.subViews();
+        if (subViewIndex >= subViews.size() || subViews[subViewIndex].view() != m_view.data())
+            return;
+
+        subViews[subViewIndex].drawDirect(*m_view, painter, ctx, cache.id, cache.itemRect, cache.visibleRect);
+        ++subViewIndex;
+    }
+
+    void cleanupDraw(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, int& subViewIndex) const
+    {
+        const auto& subViews = cache.cacheView.subViews();
+        if (subViewIndex < 0 || subViews[subViewIndex].view() != m_view.data())
+            return;
+
+        m_view->cleanupDrawDirect(painter, ctx, CacheContext(cache.id, cache.itemRect, subViews[subViewIndex], cache.visibleRect));
+        --subViewIndex;
+    }
+
+private:
+    SharedPtr<ViewType> m_view;
+};
+
+template <typename ViewT>
+using StaticBackground = StaticSlot<ViewT, Impl::StaticLayoutClient, LayoutBehaviorTransparent>;
+template <typename ViewT>
+using StaticClient = StaticSlot<ViewT, Impl::StaticLayoutClient, LayoutBehaviorNone>;
+template <typename ViewT>
+using StaticCenter = StaticSlot<ViewT, Impl::StaticLayoutCenter, LayoutBehaviorNone>;
+template <typename ViewT, LayoutBehaviorMask Behavior = LayoutBehaviorNone>
+using StaticLeft = StaticSlot<ViewT, Impl::StaticLayoutLeft, Behavior>;
+template <typename ViewT, LayoutBehaviorMask Behavior = LayoutBehaviorNone>
+using StaticRight = StaticSlot<ViewT, Impl::StaticLayoutRight, Behavior>;
+template <typename ViewT, LayoutBehaviorMask Behavior = LayoutBehaviorNone>
+using StaticTop = StaticSlot<ViewT, Impl::StaticLayoutTop, Behavior>;
+template <typename ViewT, LayoutBehaviorMask Behavior = LayoutBehaviorNone>
+using StaticBottom = StaticSlot<ViewT, Impl::StaticLayoutBottom, Behavior>;
+
+template <typename ViewT>
+StaticBackground<ViewT> staticBackground(SharedPtr<ViewStatic<ViewT>> view) { return StaticBackground<ViewT>(std::move(view)); }
+template <typename ViewT>
+StaticClient<ViewT> staticClient(SharedPtr<ViewStatic<ViewT>> view) { return StaticClient<ViewT>(std::move(view)); }
+template <typename ViewT>
+StaticCenter<ViewT> staticCenter(SharedPtr<ViewStatic<ViewT>> view) { return StaticCenter<ViewT>(std::move(view)); }
+template <LayoutBehaviorMask Behavior = LayoutBehaviorNone, typename ViewT>
+StaticLeft<ViewT, Behavior> staticLeft(SharedPtr<ViewStatic<ViewT>> view) { return StaticLeft<ViewT, Behavior>(std::move(view)); }
+template <LayoutBehaviorMask Behavior = LayoutBehaviorNone, typename ViewT>
+StaticRight<ViewT, Behavior> staticRight(SharedPtr<ViewStatic<ViewT>> view) { return StaticRight<ViewT, Behavior>(std::move(view)); }
+template <LayoutBehaviorMask Behavior = LayoutBehaviorNone, typename ViewT>
+StaticTop<ViewT, Behavior> staticTop(SharedPtr<ViewStatic<ViewT>> view) { return StaticTop<ViewT, Behavior>(std::move(view)); }
+template <LayoutBehaviorMask Behavior = LayoutBehaviorNone, typename ViewT>
+StaticBottom<ViewT, Behavior> staticBottom(SharedPtr<ViewStatic<ViewT>> view) { return StaticBottom<ViewT, Behavior>(std::move(view)); }
+
+// not template part of ViewStaticSchema, sub views are kept in order of slots
+class QI_EXPORT ViewStaticSchemaBase: public View
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ViewStaticSchemaBase)
+
+public:
+    virtual ~ViewStaticSchemaBase();
+
+    const QMargins& margins() const { return m_margins; }
+    void setMargins(const QMargins& margins);
+
+protected:
+    ViewStaticSchemaBase(const QVector<SharedPtr<View>>& subViews, const QMargins& margins);
+
+    void addViewImpl(ID id, QVector<const View*>& views) const override;
+    bool isSizeUniformImpl() const override;
+    bool isCacheViewUniformImpl() const override;
+    // draws sub views in order
+    bool isDrawBatchableImpl() const override { return true; }
+    // sub views are checked by their own cache views
+    bool isDrawThreadSafeImpl() const override { return true; }
+    bool textImpl(ID id, QString& txt) const override;
+
+private slots:
+    void onSubViewChanged(const View* view, ChangeReason reason);
+    void onSubViewItemsChanged(const View* view, const QVector<ID>& items);
+
+private:
+    QVector<SharedPtr<View>> m_subViews;
+    QMargins m_margins;
+};
+
+// composite view with compile time layouts of sub views, e.g.
+// makeViewStaticSchema(staticLeft(makeViewStatic<ViewCheck>(checks)), staticClient(makeViewStatic<ViewText>(texts)))
+// sub views are laid out, sized and drawn without virtual calls of layouts and views,
+// the schema is added to spaces as one view like ViewComposite
+template <typename... Slots>
+class ViewStaticSchema: public ViewStaticSchemaBase
+{
+    static_assert(sizeof...(Slots) > 0, "ViewStaticSchema needs sub views");
+    static const int SlotsCount = sizeof...(Slots);
+
+public:
+    explicit ViewStaticSchema(Slots... slots, const QMargins& margins = QMargins())
+        : ViewStaticSchemaBase(QVector<SharedPtr<View>>{ slots.view()... }, margins),
+          m_slots(std::move(slots)...)
+    {
+    }
+
+protected:
+    CacheView2* addCacheViewImpl(const Layout& layout, const GuiContext& ctx, ID id, QVector<CacheView2>& cacheViews, QRect& itemRect, QRect* visibleItemRect) const override
+    {
+        CacheView2* selfCacheView = View::addCacheViewImpl(layout, ctx, id, cacheViews, itemRect, visibleItemRect);
+        if (!selfCacheView)
+            return selfCacheView;
+
+        QRect localRect = selfCacheView->rect().marginsRemoved(margins());
+
+        selfCacheView->rSubViews().reserve(SlotsCount);
+        addSlotsCacheViews<0>(ctx, id, selfCacheView->rSubViews(), localRect, visibleItemRect);
+        return selfCacheView;
+    }
+
+    QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override
+    {
+        QSize size(0, 0);
+
+        // expand in reversed order to handle client view first
+        expandSlotsSize<SlotsCount - 1>(ctx, id, sizeMode, size);
+
+        return QSize(size.width() + margins().left() + margins().right(),
+                     size.height() + margins().top() + margins().bottom());
+    }
+
+    void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* /*showTooltip*/) const override
+    {
+        int subViewIndex = 0;
+        drawSlots<0>(painter, ctx, cache, subViewIndex);
+
+        // restore draw state in reversed order
+        subViewIndex = cache.cacheView.subViews().size() - 1;
+        cleanupDrawSlots<SlotsCount - 1>(painter, ctx, cache, subViewIndex);
+    }
+
+private:
+    template <int I>
+    typename std::enable_if<(I < SlotsCount)>::type addSlotsCacheViews(const GuiContext& ctx, ID id, QVector<CacheView2>& cacheViews, QRect& itemRect, QRect* visibleItemRect) const
+    {
+        std::get<I>(m_slots).addCacheView(ctx, id, cacheViews, itemRect, visibleItemRect);
+        addSlotsCacheViews<I + 1>(ctx, id, cacheViews, itemRect, visibleItemRect);
+    }
+
+    template <int I>
+    typename std::enable_if<(I == SlotsCount)>::type addSlotsCacheViews(const GuiContext&, ID, QVector<CacheView2>&, QRect&, QRect*) const
+    {
+    }
+
+    template <int I>
+    typename std::enable_if<(I >= 0)>::type expandSlotsSize(const GuiContext& ctx, ID id, ViewSizeMode sizeMode, QSize& size) const
+    {
+        std::get<I>(m_slots).expandSize(ctx, id, sizeMode, size);
+        expandSlotsSize<I - 1>(ctx, id, sizeMode, size);
+    }
+
+    template <int I>
+    typename std::enable_if<(I < 0)>::type expandSlotsSize(const GuiContext&, ID, ViewSizeMode, QSize&) const
+    {
+    }
+
+    template <int I>
+    typename std::enable_if<(I < SlotsCount)>::type drawSlots(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, int& subViewIndex) const
+    {
+        std::get<I>(m_slots).draw(painter, ctx, cache, subViewIndex);
+        drawSlots<I + 1>(painter, ctx, cache, subViewIndex);
+    }
+
+    template <int I>
+    typename std::enable_if<(I == SlotsCount)>::type drawSlots(QPainter*, const GuiContext&, const CacheContext&, int&) const
+    {
+    }
+
+    template <int I>
+    typename std::enable_if<(I >= 0)>::type cleanupDrawSlots(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, int& subViewIndex) const
+    {
+        std::get<I>(m_slots).cleanupDraw(painter, ctx, cache, subViewIndex);
+        cleanupDrawSlots<I - 1>(painter, ctx, cache, subViewIndex);
+    }
+
+    template <int I>
+    typename std::enable_if<(I < 0)>::type cleanupDrawSlots(QPainter*, const GuiContext&, const CacheContext&, int&) const
+    {
+    }
+
+    std::tuple<Slots...> m_slots;
+};
+
+template <typename... Slots>
+SharedPtr<ViewStaticSchema<Slots...>> makeViewStaticSchema(Slots... slots)
+{
+    return makeShared<ViewStaticSchema<Slots...>>(std::move(slots)...);
+}
+
+} // end namespace Qi
+
+#endif // QI_VIEW_STATIC_SCHEMA_H
@@ -30,6 +30,42 @@ ControllerContext::~ControllerContext()
 {
 }
 
+void ControllerContext::narrowActivationRect(const QRect& rect, bool inside) const
+{
+    if (inside)
+    {
+        activationRect &= rect;
+        return;
+    }
+
+    if (!activationRect.intersects(rect))
+        return;
+
+    // parts of activationRect at each side of rect
+    QRect parts[4] = { activationRect, activationRect, activationRect, activationRect };
+    parts[0].setRight(rect.left() - 1);
+    parts[1].setLeft(rect.right() + 1);
+    parts[2].setBottom(rect.top() - 1);
+    parts[3].setTop(rect.bottom() + 1);
+
+    QRect result;
+    qint64 resultArea = 0;
+    for (const auto& part : parts)
+    {
+        if (!part.contains(point))
+            continue;
+
+        qint64 area = qint64(part.width()) * part.height();
+        if (area > resultArea)
+        {
+            result = part;
+            resultArea = area;
+        }
+    }
+
+    activationRect = result;
+}
+
 void ControllerContext::pushCursor(QCursor cursor, const ControllerMouse* controller) const
 {
     Q_ASSERT(std::find_if(m_cursorInfos.begin(), m_cursorInfos.end(), [controller](const QPair<QCursor, const ControllerMouse*>& elem) {
@@ -39,6 +39,13 @@ public:
     QWidget* widget;
     SpaceWidgetCore* widgetCore;
     QPoint point;
+    // area around point where activated controllers stay the same
+    // narrowed during activation, empty if controllers should be activated on any move
+    mutable QRect activationRect;
+
+    // leaves in activationRect the part of rect (inside is true)
+    // or the largest part outside of rect containing point
+    void narrowActivationRect(const QRect& rect, bool inside) const;
 
     void pushCursor(QCursor cursor, const ControllerMouse* controller) const;
     void popCursor(const ControllerMouse* controller) const;
@@ -0,0 +1,55 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "ViewAuxiliary.h"
+
+namespace Qi
+{
+
+static QPalette::ColorGroup widgetColorGroup(const QWidget* widget)
+{
+    if (!widget->isEnabled())
+        return QPalette::Disabled;
+    else if (!widget->hasFocus())
+        return QPalette::Inactive;
+    else
+        return QPalette::Active;
+}
+
+GuiFrameState::GuiFrameState(const QWidget* widget)
+    : style(widget->style()),
+      palette(widget->palette()),
+      colorGroup(widgetColorGroup(widget)),
+      font(widget->font()),
+      fontMetrics(widget->fontMetrics()),
+      devicePixelRatio(widget->devicePixelRatioF())
+{
+    viewItemOption.initFrom(widget);
+    viewItemOption.state &= ~QStyle::State_MouseOver;
+    viewItemOption.widget = widget;
+    viewItemOption.font = font;
+}
+
+const GuiFrameState& GuiContext::frameState() const
+{
+    if (!m_frameState)
+        m_frameState = makeShared<GuiFrameState>(widget);
+
+    return *m_frameState;
+}
+
+} // end namespace Qi
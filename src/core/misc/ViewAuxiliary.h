@@ -19,7 +19,7 @@
 
 #include "QiAPI.h"
 #include <QWidget>
-#include <QStyleOption>
+#include <QStyleOptionViewItem>
 
 namespace Qi
 {
@@ -37,35 +37,68 @@ enum ViewDefaultController
     ViewDefaultControllerCreate = 0x1
 };
 
+// widget style state prepared once for many views
+struct QI_EXPORT GuiFrameState
+{
+    explicit GuiFrameState(const QWidget* widget);
+
+    QStyle* style;
+    QPalette palette;
+    QPalette::ColorGroup colorGroup;
+    QFont font;
+    QFontMetrics fontMetrics;
+    qreal devicePixelRatio;
+    // initialized from widget without State_MouseOver
+    QStyleOptionViewItem viewItemOption;
+};
+
 class QI_EXPORT GuiContext
 {
 public:
     const QWidget* widget;
 
     GuiContext(const QWidget* widget)
-        : widget(widget)
+        : widget(widget),
+          m_isDraft(false),
+          m_sizeWidthHint(0)
     {
         Q_ASSERT(widget);
     }
 
-    QStyle* style() const { return widget->style(); }
+    // cheap rendering during fast scrolling, views not drawn in draft (see View::isDrawnInDraft)
+    // are skipped and items laid out in draft are laid out again once draft is off
+    bool isDraft() const { return m_isDraft; }
+    void setDraft(bool isDraft) { m_isDraft = isDraft; }
+
+    // width of items which sizes are requested by View::size, 0 if width is not limited
+    // word wrapped texts report their height at this width
+    int sizeWidthHint() const { return m_sizeWidthHint; }
+    void setSizeWidthHint(int width) { m_sizeWidthHint = width; }
+
+    // state is kept until invalidate, owners of widgets
+    // invalidate it every frame and on widget changes
+    const GuiFrameState& frameState() const;
+    void invalidate() { m_frameState.reset(); }
+
+    QStyle* style() const { return frameState().style; }
     void initStyleOption(QStyleOption& option) const
     {
-        option.initFrom(widget);
+        // copies prepared state instead of initFrom
         // State_MouseOver should be set explicitly
-        option.state &= ~QStyle::State_MouseOver;
+        option.QStyleOption::operator=(frameState().viewItemOption);
     }
+    const QStyleOptionViewItem& viewItemOption() const { return frameState().viewItemOption; }
 
-    const QPalette& palette() const { return widget->palette(); }
-    QPalette::ColorGroup colorGroup() const
-    {
-        if (!widget->isEnabled())
-            return QPalette::Disabled;
-        else if (!widget->hasFocus())
-            return QPalette::Inactive;
-        else
-            return QPalette::Active;
-    }
+    const QPalette& palette() const { return frameState().palette; }
+    QPalette::ColorGroup colorGroup() const { return frameState().colorGroup; }
+    const QFont& font() const { return frameState().font; }
+    const QFontMetrics& fontMetrics() const { return frameState().fontMetrics; }
+    qreal devicePixelRatio() const { return frameState().devicePixelRatio; }
+
+private:
+    mutable SharedPtr<GuiFrameState> m_frameState;
+    bool m_isDraft;
+    int m_sizeWidthHint;
 };
 
 } // end namespace Qi
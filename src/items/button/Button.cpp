@@ -16,6 +16,7 @@
 
 #include "Button.h"
 #include "items/misc/ControllerMousePushableCallback.h"
+#include "utils/StylePixmapCache.h"
 #include <QStyleOptionButton>
 
 namespace Qi
@@ -27,12 +28,14 @@ ViewButton::ViewButton(SharedPtr<View> bttnContent, ViewDefaultController create
 {
     if (createDefaultController)
     {
-        auto controller = makeShared<ControllerMousePushableCallback>();
-        controller->onApply = [this] (ID id, const ControllerContext& context) {
-            if (action)
-                action(id, context, this);
-        };
-        setController(controller);
+        setControllerLazy([this]() {
+            auto controller = makeShared<ControllerMousePushableCallback>();
+            controller->onApply = [this] (ID id, const ControllerContext& context) {
+                if (action)
+                    action(id, context, this);
+            };
+            return controller;
+        });
     }
 }
 
@@ -58,12 +61,12 @@ void ViewButton::drawImpl(QPainter* painter, const GuiContext& ctx, const CacheC
         tuneBttnState(cache.id, option.state);
 
     // draw button
-    style->drawControl(QStyle::CE_PushButtonBevel, &option, painter, ctx.widget);
+    drawStyleControlCached(style, QStyle::CE_PushButtonBevel, option, painter, ctx.widget, QString::number(int(option.features)));
 
     // setup standard palette
     auto cg = ctx.colorGroup();
-    painter->setPen(ctx.widget->palette().color(cg, QPalette::ButtonText));
-    painter->setBackground(ctx.widget->palette().brush(cg, QPalette::Button));
+    painter->setPen(ctx.palette().color(cg, QPalette::ButtonText));
+    painter->setBackground(ctx.palette().brush(cg, QPalette::Button));
 
     // shift sub-view's origin if button has pressed
     if (option.state & QStyle::State_Sunken)
@@ -36,6 +36,7 @@ public:
 
 protected:
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawnInDraftImpl() const override { return false; }
 
 private:
     PushableTracker m_pushableTracker;
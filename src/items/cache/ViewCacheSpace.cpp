@@ -24,7 +24,7 @@ ViewCacheSpace::ViewCacheSpace(const SharedPtr<ModelCacheSpace> &model, bool use
     : m_model(model)
 {
     if (useController)
-        setController(makeShared<ControllerMouseCacheSpace>(model));
+        setControllerLazy([model]() { return makeShared<ControllerMouseCacheSpace>(model); });
 
     connect(m_model.data(), &Model::modelChanged, this, &ViewCacheSpace::onModelChanged);
 }
@@ -68,7 +68,16 @@ void ViewCacheSpace::drawImpl(QPainter* painter, const GuiContext& ctx, const Ca
     if (!cacheSpace)
         return;
 
-    cacheSpace->draw(painter, ctx);
+    // painter is clipped to exposed area of the owner cache space
+    if (painter->hasClipping())
+    {
+        QRect exposedRect = painter->clipBoundingRect().toAlignedRect();
+        cacheSpace->draw(painter, ctx, &exposedRect);
+    }
+    else
+    {
+        cacheSpace->draw(painter, ctx);
+    }
 }
 
 bool ViewCacheSpace::tooltipByPointImpl(QPoint point, ID item, TooltipInfo& tooltipInfo) const
@@ -43,6 +43,8 @@ public:
 protected:
     CacheView2* addCacheViewImpl(const Layout& layout, const GuiContext& ctx, ID id, QVector<CacheView2>& cacheViews, QRect& itemRect, QRect* visibleItemRect) const override;
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
+    // cache views depend on item id
+    bool isCacheViewUniformImpl() const override { return false; }
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
     bool tooltipByPointImpl(QPoint point, ID item, TooltipInfo &tooltipInfo) const override;
 
@@ -16,6 +16,7 @@
 
 #include "Check.h"
 #include "items/misc/ControllerMousePushableCallback.h"
+#include "utils/StylePixmapCache.h"
 #include <QStyleOptionButton>
 
 namespace Qi
@@ -56,7 +57,7 @@ void ViewCheck::drawImpl(QPainter* painter, const GuiContext& ctx, const CacheCo
     option.rect = style->subElementRect(QStyle::SE_CheckBoxIndicator, &option, ctx.widget);
 
     // draw check box image
-    style->drawPrimitive(QStyle::PE_IndicatorCheckBox, &option, painter, ctx.widget);
+    drawStylePrimitiveCached(style, QStyle::PE_IndicatorCheckBox, option, painter, ctx.widget);
 }
 
 QStyle::State ViewCheck::styleState(ID id) const
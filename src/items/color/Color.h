@@ -46,6 +46,7 @@ public:
 
 protected:
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawThreadSafeImpl() const override { return theModel()->isThreadSafe(); }
 
 private:
     bool m_withBorder;
@@ -0,0 +1,228 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "Heatmap.h"
+#include "utils/CallLater.h"
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace Qi
+{
+
+ViewHeatmap::ViewHeatmap(SharedPtr<ModelHeatmap> model, int tableSize)
+    : ViewModeled<ModelHeatmap>(std::move(model)),
+      m_minimum(std::numeric_limits<double>::max()),
+      m_maximum(std::numeric_limits<double>::lowest()),
+      m_scale(0.),
+      m_isAutoRange(true)
+{
+    Q_ASSERT(tableSize >= MinTableSize && tableSize <= MaxTableSize);
+
+    m_colors << QColor(0, 0, 255) << QColor(0, 255, 255) << QColor(0, 255, 0) << QColor(255, 255, 0) << QColor(255, 0, 0);
+    m_table.resize(tableSize);
+    updateTable();
+
+    connect(theModel().data(), &Model::modelItemChanged, this, &ViewHeatmap::onModelItemChanged);
+    connect(theModel().data(), &Model::modelItemsChanged, this, &ViewHeatmap::onModelItemsChanged);
+}
+
+void ViewHeatmap::setColors(const QVector<QColor>& colors)
+{
+    Q_ASSERT(!colors.isEmpty());
+    if (m_colors == colors)
+        return;
+
+    m_colors = colors;
+    updateTable();
+
+    emitViewChanged(ChangeReasonViewContent);
+}
+
+void ViewHeatmap::setTableSize(int tableSize)
+{
+    Q_ASSERT(tableSize >= MinTableSize && tableSize <= MaxTableSize);
+    if (m_table.size() == tableSize)
+        return;
+
+    m_table.resize(tableSize);
+    updateTable();
+
+    emitViewChanged(ChangeReasonViewContent);
+}
+
+void ViewHeatmap::setRange(double minimum, double maximum)
+{
+    Q_ASSERT(minimum <= maximum);
+
+    m_isAutoRange = false;
+    if (m_minimum == minimum && m_maximum == maximum)
+        return;
+
+    m_minimum = minimum;
+    m_maximum = maximum;
+    updateTable();
+
+    emitViewChanged(ChangeReasonViewContent);
+}
+
+void ViewHeatmap::resetAutoRange()
+{
+    m_isAutoRange = true;
+    m_minimum = std::numeric_limits<double>::max();
+    m_maximum = std::numeric_limits<double>::lowest();
+    updateTable();
+
+    emitViewChanged(ChangeReasonViewContent);
+}
+
+void ViewHeatmap::updateTable()
+{
+    int tableSize = m_table.size();
+    int lastColor = m_colors.size() - 1;
+    for (int i = 0; i < tableSize; ++i)
+    {
+        // position between neighbour colors
+        double pos = lastColor * double(i) / (tableSize - 1);
+        int color = qMin(int(pos), qMax(0, lastColor - 1));
+        double t = lastColor > 0 ? pos - color : 0.;
+
+        const QColor& from = m_colors[color];
+        const QColor& to = m_colors[qMin(color + 1, lastColor)];
+        m_table[i] = qRgba(qRound(from.red() + (to.red() - from.red()) * t),
+                           qRound(from.green() + (to.green() - from.green()) * t),
+                           qRound(from.blue() + (to.blue() - from.blue()) * t),
+                           qRound(from.alpha() + (to.alpha() - from.alpha()) * t));
+    }
+
+    m_scale = m_maximum > m_minimum ? (tableSize - 1) / (m_maximum - m_minimum) : 0.;
+}
+
+int ViewHeatmap::colorIndex(double value) const
+{
+    if (std::isnan(value))
+        return -1;
+
+    if (m_isAutoRange && (value < m_minimum || value > m_maximum))
+        extendRange(value);
+
+    if (value <= m_minimum)
+        return 0;
+    if (value >= m_maximum)
+        return m_table.size() - 1;
+
+    return int((value - m_minimum) * m_scale);
+}
+
+void ViewHeatmap::extendRange(double value) const
+{
+    if (std::isnan(value) || std::isinf(value))
+        return;
+
+    if (value >= m_minimum && value <= m_maximum)
+        return;
+
+    bool isFirst = m_minimum > m_maximum;
+    m_minimum = qMin(m_minimum, value);
+    m_maximum = qMax(m_maximum, value);
+    m_scale = m_maximum > m_minimum ? (m_table.size() - 1) / (m_maximum - m_minimum) : 0.;
+
+    // items drawn with previous range are repainted once
+    if (!isFirst)
+    {
+        auto self = const_cast<ViewHeatmap*>(this);
+        callLaterOnce(self, "rangeChanged", [self]() {
+            self->emitViewChanged(ChangeReasonViewContent);
+        });
+    }
+}
+
+void ViewHeatmap::drawImpl(QPainter* painter, const GuiContext& /*ctx*/, const CacheContext& cache, bool* /*showTooltip*/) const
+{
+    int index = colorIndex(theModel()->value(cache.id));
+    if (index < 0)
+        return;
+
+    painter->fillRect(cache.cacheView.rect(), QColor::fromRgba(m_table[index]));
+}
+
+void ViewHeatmap::drawBatchImpl(QPainter* painter, const GuiContext& /*ctx*/, const QVector<CacheViewBatchItem>& items, const QRect* /*visibleRect*/) const
+{
+    struct Span
+    {
+        QRect rect;
+        int index;
+    };
+
+    QVector<Span> spans;
+    spans.reserve(items.size());
+    for (const auto& item : items)
+    {
+        int index = colorIndex(theModel()->value(item.id));
+        if (index >= 0)
+            spans.append(Span{item.cacheView->rect(), index});
+    }
+
+    if (spans.isEmpty())
+        return;
+
+    std::sort(spans.begin(), spans.end(), [](const Span& left, const Span& right) {
+        if (left.rect.top() != right.rect.top())
+            return left.rect.top() < right.rect.top();
+        if (left.rect.height() != right.rect.height())
+            return left.rect.height() < right.rect.height();
+        return left.rect.left() < right.rect.left();
+    });
+
+    // merge touching rects of the same line and color
+    int spansCount = 0;
+    for (const auto& span : spans)
+    {
+        if (spansCount > 0)
+        {
+            Span& last = spans[spansCount - 1];
+            if (last.index == span.index && last.rect.top() == span.rect.top() && last.rect.height() == span.rect.height() && span.rect.left() <= last.rect.right() + 1)
+            {
+                last.rect.setRight(qMax(last.rect.right(), span.rect.right()));
+                continue;
+            }
+        }
+
+        spans[spansCount++] = span;
+    }
+
+    for (int i = 0; i < spansCount; ++i)
+        painter->fillRect(spans[i].rect, QColor::fromRgba(m_table[spans[i].index]));
+}
+
+void ViewHeatmap::onModelItemChanged(const Model*, ID id)
+{
+    if (m_isAutoRange)
+        extendRange(theModel()->value(id));
+}
+
+void ViewHeatmap::onModelItemsChanged(const Model*, const QVector<ID>& ids)
+{
+    if (!m_isAutoRange)
+        return;
+
+    for (ID id : ids)
+        extendRange(theModel()->value(id));
+}
+
+} // end namespace Qi
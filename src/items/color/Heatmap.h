@@ -0,0 +1,87 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_HEATMAP_H
+#define QI_HEATMAP_H
+
+#include "core/ext/ModelCallback.h"
+#include "core/ext/ViewModeled.h"
+#include <QColor>
+
+namespace Qi
+{
+
+typedef ModelTyped<double> ModelHeatmap;
+typedef ModelCallback<double> ModelHeatmapCallback;
+
+// fills items with colors of values through precomputed color table
+// adjacent items of the same color are filled at once by drawBatch
+class QI_EXPORT ViewHeatmap: public ViewModeled<ModelHeatmap>
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ViewHeatmap)
+
+public:
+    enum { MinTableSize = 256, MaxTableSize = 4096 };
+
+    ViewHeatmap(SharedPtr<ModelHeatmap> model, int tableSize = MinTableSize);
+
+    // colors evenly spread from minimum to maximum of the range,
+    // interpolated into the table of tableSize entries
+    const QVector<QColor>& colors() const { return m_colors; }
+    void setColors(const QVector<QColor>& colors);
+    int tableSize() const { return m_table.size(); }
+    void setTableSize(int tableSize);
+
+    // values range mapped to colors
+    double minimum() const { return m_minimum; }
+    double maximum() const { return m_maximum; }
+    void setRange(double minimum, double maximum);
+    // range grows by values of changed and drawn items,
+    // setRange turns it off, resetAutoRange forgets values seen
+    bool isAutoRange() const { return m_isAutoRange; }
+    void resetAutoRange();
+
+protected:
+    void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawBatchableImpl() const override { return true; }
+    // auto range is extended while drawing
+    bool isDrawThreadSafeImpl() const override { return !m_isAutoRange && theModel()->isThreadSafe(); }
+    // fills merged spans of adjacent items of each row with the same color
+    void drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* visibleRect) const override;
+
+private:
+    void updateTable();
+    // -1 for values without color
+    int colorIndex(double value) const;
+    void extendRange(double value) const;
+    void onModelItemChanged(const Model*, ID id);
+    void onModelItemsChanged(const Model*, const QVector<ID>& ids);
+
+    QVector<QColor> m_colors;
+    QVector<QRgb> m_table;
+
+    mutable double m_minimum;
+    mutable double m_maximum;
+    // table entries per value unit
+    mutable double m_scale;
+    bool m_isAutoRange;
+};
+
+} // end namespace Qi
+
+#endif // QI_HEATMAP_H
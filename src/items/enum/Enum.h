@@ -31,25 +31,46 @@ class EnumTraits
 public:
     QVector<EnumType> uniqueValues() const { return uniqueValuesImpl(); }
     QString valueText(EnumType value) const { return valueTextImpl(value); }
+
+    // texts and ranks are computed once for all unique values
+    // call invalidateTables if they were changed
+    const QString& internedText(EnumType value) const
+    {
+        validateTables();
+        auto it = m_texts.constFind(value);
+        if (it != m_texts.constEnd())
+            return it.value();
+
+        return m_texts[value] = valueText(value);
+    }
+
+    // position of value in sorted unique values, unknown values go last
+    int rank(EnumType value) const
+    {
+        validateTables();
+        return m_ranks.value(value, m_ranks.size());
+    }
+    // ranks are in [0, ranksCount)
+    int ranksCount() const
+    {
+        validateTables();
+        return m_ranks.size() + 1;
+    }
+
     int compareValues(EnumType left, EnumType right) const
     {
-        if (m_sortedUniqueValues.isEmpty())
-        {
-            m_sortedUniqueValues = uniqueValues();
-            sortUniqueValuesImpl(m_sortedUniqueValues);
-        }
+        return Private::compareValues(rank(left), rank(right));
+    }
 
-        auto leftIndex = std::distance(m_sortedUniqueValues.begin(), std::lower_bound(m_sortedUniqueValues.begin(),
-                                                                                      m_sortedUniqueValues.end(),
-                                                                                      left));
-        auto rightIndex = std::distance(m_sortedUniqueValues.begin(), std::lower_bound(m_sortedUniqueValues.begin(),
-                                                                                       m_sortedUniqueValues.end(),
-                                                                                       right));
-        return Private::compareValues(leftIndex, rightIndex);
+    void invalidateTables() const
+    {
+        m_isTablesValid = false;
+        m_texts.clear();
+        m_ranks.clear();
     }
 
 protected:
-    EnumTraits() {}
+    EnumTraits() : m_isTablesValid(false) {}
     virtual ~EnumTraits() {}
 
     virtual QVector<EnumType> uniqueValuesImpl() const = 0;
@@ -57,12 +78,30 @@ protected:
     virtual void sortUniqueValuesImpl(QVector<EnumType>& uniqueValues) const
     {
         std::sort(uniqueValues.begin(), uniqueValues.end(), [this](EnumType left, EnumType right)->bool {
-            return valueText(left) < valueText(right);
+            return internedText(left) < internedText(right);
         });
     }
 
 private:
-    mutable QVector<EnumType> m_sortedUniqueValues;
+    void validateTables() const
+    {
+        if (m_isTablesValid)
+            return;
+
+        m_isTablesValid = true;
+
+        auto sortedValues = uniqueValues();
+        for (auto value : sortedValues)
+            m_texts[value] = valueText(value);
+
+        sortUniqueValuesImpl(sortedValues);
+        for (int i = 0; i < sortedValues.size(); ++i)
+            m_ranks.insert(sortedValues[i], i);
+    }
+
+    mutable bool m_isTablesValid;
+    mutable QMap<EnumType, QString> m_texts;
+    mutable QMap<EnumType, int> m_ranks;
 };
 
 template <typename EnumType = int>
@@ -90,6 +129,10 @@ protected:
         return m_enumTraits->compareValues(m_enumValues->value(left), m_enumValues->value(right));
     }
 
+    // enum traits define order, sort by ranks
+    int ordinalKeysCountImpl() const override { return m_enumTraits->ranksCount(); }
+    int ordinalKeyImpl(ID id) const override { return m_enumTraits->rank(m_enumValues->value(id)); }
+
     ValueType_t valueImpl(ID id) const override
     {
         return m_enumValues->value(id);
@@ -128,6 +171,10 @@ protected:
     {
         return m_modelEnum->compare(left, right);
     }
+    SharedPtr<ModelSortKeys> sortKeysImpl(const QVector<int>& lines, const std::function<ID(int)>& lineToId) const override
+    {
+        return m_modelEnum->sortKeys(lines, lineToId);
+    }
     bool isAscendingDefaultImpl(ID id) const override
     {
         return m_modelEnum->isAscendingDefault(id);
@@ -135,7 +182,8 @@ protected:
 
     ValueType_t valueImpl(ID id) const override
     {
-        return m_modelEnum->enumTraits().valueText(m_modelEnum->value(id));
+        // shares interned text, no allocation
+        return m_modelEnum->enumTraits().internedText(m_modelEnum->value(id));
     }
 
     bool setValueImpl(ID id, ValueType_t value) override
@@ -157,7 +205,7 @@ private:
             return;
 
         for (auto enumValue : m_modelEnum->enumTraits().uniqueValues())
-            m_text2Enum[m_modelEnum->enumTraits().valueText(enumValue)] = enumValue;
+            m_text2Enum[m_modelEnum->enumTraits().internedText(enumValue)] = enumValue;
     }
 
     SharedPtr<ModelEnum<EnumType>> m_modelEnum;
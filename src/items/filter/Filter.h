@@ -36,13 +36,19 @@ public:
     const SharedPtr<Model>& modelToFilter() const { return m_modelToFilter; }
     bool isItemPassFilter(ID id) const { return isItemPassFilterImpl(id); }
 
+    // isItemPassFilter can be called from several threads simultaneously
+    bool isThreadSafe() const { return isThreadSafeImpl(); }
+
 signals:
     void filterChanged(const ItemsFilter*);
+    // emitted instead of filterChanged if items can only stop passing the filter
+    void filterNarrowed(const ItemsFilter*);
 
 protected:
     ItemsFilter(SharedPtr<Model> modelToFilter);
 
     virtual bool isItemPassFilterImpl(ID id) const = 0;
+    virtual bool isThreadSafeImpl() const { return false; }
 
 private:
     void onModelToFilterChanged(const Model*);
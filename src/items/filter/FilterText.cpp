@@ -15,10 +15,91 @@
 */
 
 #include "FilterText.h"
+#include "FilterTextIndex.h"
+#include <QTimer>
+#include "utils/TaskPool.h"
+#include <atomic>
+#include <algorithm>
 
 namespace Qi
 {
 
+// rows are evaluated in parallel by chunks
+static const int RowsChunkShift = 14;
+static const int RowsChunkSize = 1 << RowsChunkShift;
+// there is no gain to use threads for less rows
+static const int ParallelFilterMinRows = 2 * RowsChunkSize;
+
+// filtering in background thread
+// job owns copies of texts, so it touches neither models nor filters and may outlive RowsFilterByText
+struct RowsFilterByText::FilteringJob
+{
+    // copied texts of filtered columns and their filter texts, texts are empty for columns without filter
+    QVector<QVector<QString>> texts;
+    QVector<TextMatcher> matchers;
+    int linesCount = 0;
+    // filters were narrowed since rows visibility was evaluated
+    bool narrowed = false;
+    // rowsVisible holds previous results to narrow
+    bool narrowing = false;
+    // only candidates may pass filters
+    bool hasCandidates = false;
+    QVector<int> candidates;
+    QVector<BitVector> rowsVisible;
+    TaskToken token;
+
+    bool isRowPassFilters(int row) const
+    {
+        for (int column = 0; column < texts.size(); ++column)
+        {
+            const auto& columnTexts = texts.at(column);
+            if (!columnTexts.isEmpty() && !matchers.at(column).isMatched(columnTexts.at(row)))
+                return false;
+        }
+        return true;
+    }
+
+    void run()
+    {
+        const int chunks = (linesCount + RowsChunkSize - 1) >> RowsChunkShift;
+        rowsVisible.resize(chunks);
+
+        if (hasCandidates)
+        {
+            for (int chunk = 0; chunk < chunks; ++chunk)
+                rowsVisible[chunk].resize(qMin(RowsChunkSize, linesCount - (chunk << RowsChunkShift)));
+
+            for (int i = 0; i < candidates.size() && !token.isCancelled(); ++i)
+            {
+                int row = candidates.at(i);
+                if (row < linesCount && isRowPassFilters(row))
+                    rowsVisible[row >> RowsChunkShift].setValue(row & (RowsChunkSize - 1), true);
+            }
+            return;
+        }
+
+        for (int chunk = 0; chunk < chunks && !token.isCancelled(); ++chunk)
+        {
+            const int begin = chunk << RowsChunkShift;
+            const int end = qMin(begin + RowsChunkSize, linesCount);
+
+            BitVector& bits = rowsVisible[chunk];
+            if (!narrowing)
+                bits.resize(end - begin);
+
+            for (int row = begin; row < end; ++row)
+            {
+                if (narrowing && !bits.value(row - begin))
+                    continue;
+
+                bool passed = isRowPassFilters(row);
+                if (narrowing != passed)
+                    bits.setValue(row - begin, passed);
+            }
+        }
+    }
+};
+
 ItemsFilterByText::ItemsFilterByText(SharedPtr<Model> modelToFilter)
     : ItemsFilter(std::move(modelToFilter))
 {
@@ -29,19 +110,53 @@ bool ItemsFilterByText::setFilterText(const QString& filterText)
     if (m_filterText == filterText)
         return false;
 
+    bool narrowed = isFilterTextNarrowedImpl(m_filterText, filterText);
     m_filterText = filterText;
-    emit filterChanged(this);
+    m_filterMatcher = TextMatcher(m_filterText, m_filterMatcher.caseSensitivity());
+
+    if (narrowed)
+        emit filterNarrowed(this);
+    else
+        emit filterChanged(this);
 
     return true;
 }
 
+void ItemsFilterByText::setCaseSensitivity(Qt::CaseSensitivity cs)
+{
+    if (caseSensitivity() == cs)
+        return;
+
+    // case insensitive filter passes more items
+    bool narrowed = (cs == Qt::CaseSensitive);
+    m_filterMatcher = TextMatcher(m_filterText, cs);
+
+    if (narrowed)
+        emit filterNarrowed(this);
+    else
+        emit filterChanged(this);
+}
+
 RowsFilterByText::RowsFilterByText()
-    : m_isActive(true)
+    : m_isActive(true),
+      m_isParallel(false),
+      m_rowsVisibleCount(0),
+      m_isNarrowing(false),
+      m_linesCount(0),
+      m_hasPendingChanges(false),
+      m_isPendingNarrowed(false),
+      m_debounceInterval(0),
+      m_debounceTimer(new QTimer(this)),
+      m_isAsync(false),
+      m_isFiltering(false)
 {
+    m_debounceTimer->setSingleShot(true);
+    connect(m_debounceTimer, &QTimer::timeout, this, &RowsFilterByText::applyChanges);
 }
 
 RowsFilterByText::~RowsFilterByText()
 {
+    cancelFiltering();
     clearFilters();
 }
 
@@ -64,18 +179,51 @@ bool RowsFilterByText::addFilterByColumn(int column, SharedPtr<ItemsFilterByText
         return false;
 
     connect(filter.data(), &ItemsFilterByText::filterChanged, this, &RowsFilterByText::onFilterChanged);
+    connect(filter.data(), &ItemsFilterByText::filterNarrowed, this, &RowsFilterByText::onFilterNarrowed);
     m_filterByColumn[column] = std::move(filter);
+    cancelFiltering();
+    invalidateRowsVisible();
 
     return true;
 }
 
+SharedPtr<TextTrigramIndex> RowsFilterByText::textIndexByColumn(int column) const
+{
+    if (column < 0 || column >= m_textIndexByColumn.size())
+        return nullptr;
+
+    return m_textIndexByColumn[column];
+}
+
+void RowsFilterByText::setTextIndex(SharedPtr<TextTrigramIndex> index)
+{
+    Q_ASSERT(!index.isNull());
+
+    int column = index->column();
+    if (m_textIndexByColumn.size() <= column)
+        m_textIndexByColumn.resize(column + 1);
+
+    m_textIndexByColumn[column] = std::move(index);
+
+    // rows may have been evaluated with candidates of the previous index
+    cancelFiltering();
+    invalidateRowsVisible();
+    emit visibilityChanged(this);
+}
+
 void RowsFilterByText::clearFilters()
 {
     for (const auto& filter: m_filterByColumn)
     {
         if (!filter.isNull())
+        {
             disconnect(filter.data(), &ItemsFilterByText::filterChanged, this, &RowsFilterByText::onFilterChanged);
+            disconnect(filter.data(), &ItemsFilterByText::filterNarrowed, this, &RowsFilterByText::onFilterNarrowed);
+        }
     }
+    cancelFiltering();
+    invalidateRowsVisible();
+    m_textsByColumn.clear();
 }
 
 void RowsFilterByText::setActive(bool isActive)
@@ -84,26 +232,389 @@ void RowsFilterByText::setActive(bool isActive)
         return;
 
     m_isActive = isActive;
+    cancelFiltering();
+    invalidateRowsVisible();
     emit visibilityChanged(this);
 }
 
+void RowsFilterByText::setParallel(bool isParallel)
+{
+    if (m_isParallel == isParallel)
+        return;
+
+    m_isParallel = isParallel;
+    invalidateRowsVisible();
+}
+
+void RowsFilterByText::setDebounceInterval(int msec)
+{
+    m_debounceInterval = qMax(0, msec);
+}
+
+void RowsFilterByText::setAsync(bool isAsync)
+{
+    if (m_isAsync == isAsync)
+        return;
+
+    m_isAsync = isAsync;
+    if (!m_isAsync)
+        m_textsByColumn.clear();
+
+    if (!m_isAsync && m_job)
+    {
+        // evaluate synchronously
+        cancelFiltering();
+        m_hasPendingChanges = true;
+        m_isPendingNarrowed = false;
+        applyChanges();
+    }
+}
+
 bool RowsFilterByText::isLineVisibleImpl(int row) const
 {
+    if (row >= m_rowsVisibleCount)
+        return isRowPassFilters(row);
+
+    if (!m_rowsVisible.at(row >> RowsChunkShift).value(row & (RowsChunkSize - 1)))
+        return false;
+
+    // row passed previous filters but may fail narrowed ones
+    return !m_isNarrowing || isRowPassFilters(row);
+}
+
+void RowsFilterByText::validateLinesImpl(int linesCount) const
+{
+    m_linesCount = linesCount;
+
+    bool narrowing = m_isNarrowing && m_rowsVisibleCount == linesCount;
+    m_isNarrowing = false;
+
+    if (!narrowing)
+    {
+        if (m_rowsVisibleCount == linesCount)
+            return;
+
+        invalidateRowsVisible();
+    }
+
+    bool hasFilters = false;
+    bool isThreadSafe = true;
+    for (const auto& filter: m_filterByColumn)
+    {
+        if (filter.isNull() || filter->isFilterTextEmpty())
+            continue;
+
+        hasFilters = true;
+        isThreadSafe &= filter->isThreadSafe();
+    }
+
+    // all rows are visible
+    if (!hasFilters)
+    {
+        invalidateRowsVisible();
+        return;
+    }
+
+    const int chunks = (linesCount + RowsChunkSize - 1) >> RowsChunkShift;
+    m_rowsVisible.resize(chunks);
+
+    // test only rows found by text indices
+    QVector<int> candidates;
+    if (!narrowing && candidateRows(candidates))
+    {
+        for (int chunk = 0; chunk < chunks; ++chunk)
+            m_rowsVisible[chunk].resize(qMin(RowsChunkSize, linesCount - (chunk << RowsChunkShift)));
+
+        for (int row: candidates)
+        {
+            if (row < linesCount && isRowPassFilters(row))
+                m_rowsVisible[row >> RowsChunkShift].setValue(row & (RowsChunkSize - 1), true);
+        }
+
+        m_rowsVisibleCount = linesCount;
+        return;
+    }
+
+    // workers fill separate chunks without detaching the vector
+    BitVector* rowsVisible = m_rowsVisible.data();
+
+    // narrowed filters can only hide rows, so only visible rows are tested
+    auto evaluateChunk = [this, rowsVisible, linesCount, narrowing](int chunk) {
+        const int begin = chunk << RowsChunkShift;
+        const int end = qMin(begin + RowsChunkSize, linesCount);
+
+        BitVector& bits = rowsVisible[chunk];
+        if (!narrowing)
+            bits.resize(end - begin);
+
+        for (int row = begin; row < end; ++row)
+        {
+            if (narrowing && !bits.value(row - begin))
+                continue;
+
+            bool passed = isRowPassFilters(row);
+            if (narrowing != passed)
+                bits.setValue(row - begin, passed);
+        }
+    };
+
+    if (m_isParallel && isThreadSafe && linesCount >= ParallelFilterMinRows)
+    {
+        TaskPool::instance().parallelFor(0, chunks, 1, [&evaluateChunk](int chunkBegin, int chunkEnd) {
+            for (int chunk = chunkBegin; chunk < chunkEnd; ++chunk)
+                evaluateChunk(chunk);
+        });
+    }
+    else
+    {
+        for (int chunk = 0; chunk < chunks; ++chunk)
+            evaluateChunk(chunk);
+    }
+
+    m_rowsVisibleCount = linesCount;
+}
+
+void RowsFilterByText::changeFilters(bool narrowed)
+{
+    // newer changes cancel evaluation in progress
+    if (m_job)
+    {
+        // changes of the job were not applied and are pending again
+        Q_ASSERT(!m_hasPendingChanges);
+        m_hasPendingChanges = true;
+        m_isPendingNarrowed = m_job->narrowed;
+
+        m_job->token.cancel();
+        m_job.reset();
+    }
+
+    m_isPendingNarrowed = (m_hasPendingChanges ? m_isPendingNarrowed : true) && narrowed;
+    m_hasPendingChanges = true;
+
+    if (m_debounceInterval > 0)
+    {
+        setFiltering(true);
+        m_debounceTimer->start(m_debounceInterval);
+        return;
+    }
+
+    applyChanges();
+}
+
+void RowsFilterByText::applyChanges()
+{
+    m_debounceTimer->stop();
+
+    if (!m_hasPendingChanges)
+        return;
+
+    bool narrowed = m_isPendingNarrowed;
+    m_hasPendingChanges = false;
+    m_isPendingNarrowed = false;
+
+    if (m_isAsync && startFiltering(narrowed))
+    {
+        setFiltering(true);
+        return;
+    }
+
+    setFiltering(false);
+
+    if (narrowed)
+    {
+        // previous results are refined in validateLinesImpl
+        m_isNarrowing = m_rowsVisibleCount > 0;
+    }
+    else
+    {
+        invalidateRowsVisible();
+    }
+
+    emit visibilityChanged(this);
+}
+
+bool RowsFilterByText::startFiltering(bool narrowed)
+{
+    if (m_linesCount == 0)
+        return false;
+
+    auto job = makeShared<FilteringJob>();
+    job->linesCount = m_linesCount;
+    job->texts.resize(m_filterByColumn.size());
+    job->matchers.resize(m_filterByColumn.size());
+
+    bool hasFilters = false;
+    for (int column = 0; column < m_filterByColumn.size(); ++column)
+    {
+        const auto& filter = m_filterByColumn.at(column);
+        if (filter.isNull() || filter->isFilterTextEmpty())
+            continue;
+
+        // model may be changed by GUI thread while job is running
+        if (!validColumnTexts(column, *filter))
+            return false;
+
+        // implicitly shared with the job
+        job->texts[column] = m_textsByColumn.at(column).texts;
+        job->matchers[column] = filter->filterMatcher();
+        hasFilters = true;
+    }
+
+    // nothing to evaluate
+    if (!hasFilters)
+        return false;
+
+    // previous results contain all rows passing narrowed filters
+    job->narrowed = narrowed;
+    job->narrowing = narrowed && m_rowsVisibleCount == m_linesCount;
+    if (job->narrowing)
+        job->rowsVisible = m_rowsVisible;
+    else
+        job->hasCandidates = candidateRows(job->candidates);
+
+    // filtered rows are visible to user
+    TaskPool::instance().run(this, [job]() {
+        job->run();
+    }, [this, job]() {
+        onFilteringFinished(job);
+    }, TaskPriorityVisible, job->token);
+
+    m_job = job;
+    return true;
+}
+
+bool RowsFilterByText::validColumnTexts(int column, const ItemsFilterByText& filter)
+{
+    if (m_textsByColumn.size() <= column)
+        m_textsByColumn.resize(column + 1);
+
+    // texts are valid until the model is changed
+    ColumnTexts& columnTexts = m_textsByColumn[column];
+    const Model* model = filter.modelToFilter().data();
+    if (model && columnTexts.model == model && columnTexts.modelVersion == model->version() && columnTexts.texts.size() == m_linesCount)
+        return true;
+
+    columnTexts = ColumnTexts();
+
+    QVector<QString> texts(m_linesCount);
+    for (int row = 0; row < m_linesCount; ++row)
+    {
+        if (!filter.itemText(ID(GridID(row, column)), texts[row]))
+            return false;
+    }
+
+    columnTexts.model = model;
+    columnTexts.modelVersion = model ? model->version() : 0;
+    columnTexts.texts.swap(texts);
+
+    return true;
+}
+
+void RowsFilterByText::cancelFiltering()
+{
+    m_debounceTimer->stop();
+    m_hasPendingChanges = false;
+    m_isPendingNarrowed = false;
+
+    if (m_job)
+    {
+        m_job->token.cancel();
+        m_job.reset();
+    }
+
+    setFiltering(false);
+}
+
+void RowsFilterByText::onFilteringFinished(const SharedPtr<FilteringJob>& job)
+{
+    // filtering was cancelled or replaced
+    if (m_job != job)
+        return;
+
+    m_job.reset();
+
+    if (job->linesCount == m_linesCount)
+    {
+        // swap in new visibility of all rows
+        m_rowsVisible = job->rowsVisible;
+        m_rowsVisibleCount = job->linesCount;
+        m_isNarrowing = false;
+    }
+    else
+    {
+        // rows were added or removed while filtering
+        invalidateRowsVisible();
+    }
+
+    setFiltering(false);
+    emit visibilityChanged(this);
+}
+
+void RowsFilterByText::setFiltering(bool isFiltering)
+{
+    if (m_isFiltering == isFiltering)
+        return;
+
+    m_isFiltering = isFiltering;
+    emit filteringChanged(this, m_isFiltering);
+}
+
+bool RowsFilterByText::isRowPassFilters(int row) const
+{
+    // may be called from worker threads, so filters are accessed without detaching
     for (GridID id(row, 0); id.column < m_filterByColumn.size(); ++id.column)
     {
-        if (m_filterByColumn[id.column].isNull())
+        const auto& filter = m_filterByColumn.at(id.column);
+        if (filter.isNull())
             continue;
 
-        if (!m_filterByColumn[id.column]->isItemPassFilter(ID(id)))
+        if (!filter->isItemPassFilter(ID(id)))
             return false;
     }
 
     return true;
 }
 
+bool RowsFilterByText::candidateRows(QVector<int>& rows) const
+{
+    bool hasCandidates = false;
+    QVector<int> columnRows;
+    QVector<int> intersection;
+
+    for (int column = 0; column < m_textIndexByColumn.size() && column < m_filterByColumn.size(); ++column)
+    {
+        const auto& index = m_textIndexByColumn.at(column);
+        const auto& filter = m_filterByColumn.at(column);
+        if (index.isNull() || filter.isNull())
+            continue;
+
+        if (!index->candidateRows(filter->filterText(), columnRows))
+            continue;
+
+        if (!hasCandidates)
+        {
+            rows.swap(columnRows);
+            hasCandidates = true;
+        }
+        else
+        {
+            intersection.clear();
+            std::set_intersection(rows.begin(), rows.end(), columnRows.begin(), columnRows.end(), std::back_inserter(intersection));
+            rows.swap(intersection);
+        }
+    }
+
+    return hasCandidates;
+}
+
 void RowsFilterByText::onFilterChanged(const ItemsFilter*)
 {
-    emit visibilityChanged(this);
+    changeFilters(false);
+}
+
+void RowsFilterByText::onFilterNarrowed(const ItemsFilter*)
+{
+    changeFilters(true);
 }
 
 SharedPtr<View> makeViewRowsFilterByText(SharedPtr<RowsFilterByText> filter)
@@ -152,13 +663,24 @@ ItemsFilterTextByText::ItemsFilterTextByText(SharedPtr<ModelText> modelText)
     Q_ASSERT(m_modelText);
 }
 
-bool ItemsFilterTextByText::isItemPassFilterImpl(ID id) const
+bool ItemsFilterTextByText::isItemPassFilterTextImpl(ID id, const TextMatcher& matcher) const
 {
-    if (isFilterTextEmpty())
+    if (matcher.isEmpty())
         return true;
 
-    QString textValue = m_modelText->value(id);
-    return textValue.contains(filterText());
+    return matcher.isMatched(m_modelText->value(id));
+}
+
+bool ItemsFilterTextByText::itemTextImpl(ID id, QString& text) const
+{
+    text = m_modelText->value(id);
+    return true;
+}
+
+bool ItemsFilterTextByText::isFilterTextNarrowedImpl(const QString& oldText, const QString& newText) const
+{
+    // text containing newText contains oldText as well
+    return newText.contains(oldText, caseSensitivity());
 }
 
 
@@ -20,11 +20,15 @@
 #include "Filter.h"
 #include "space/grid/Lines.h"
 #include "items/text/Text.h"
+#include "utils/TextMatcher.h"
+
+class QTimer;
 
 namespace Qi
 {
 
 class View;
+class TextTrigramIndex;
 
 class QI_EXPORT ItemsFilterByText: public ItemsFilter
 {
@@ -37,11 +41,32 @@ public:
 
     bool isFilterTextEmpty() const { return m_filterText.isEmpty(); }
 
+    Qt::CaseSensitivity caseSensitivity() const { return m_filterMatcher.caseSensitivity(); }
+    void setCaseSensitivity(Qt::CaseSensitivity cs);
+
+    // filter text prepared for searching
+    const TextMatcher& filterMatcher() const { return m_filterMatcher; }
+
+    // tests item against matcher instead of filterText
+    // used to filter in background while filterText is being edited
+    bool isItemPassFilterText(ID id, const TextMatcher& matcher) const { return isItemPassFilterTextImpl(id, matcher); }
+    // text of the item the filter matches, item passes if the text is matched by matcher
+    // returns false if the filter doesn't test items by their texts
+    bool itemText(ID id, QString& text) const { return itemTextImpl(id, text); }
+
 protected:
     ItemsFilterByText(SharedPtr<Model> modelToFilter);
 
+    bool isItemPassFilterImpl(ID id) const override { return isItemPassFilterTextImpl(id, m_filterMatcher); }
+    virtual bool isItemPassFilterTextImpl(ID id, const TextMatcher& matcher) const = 0;
+    virtual bool itemTextImpl(ID /*id*/, QString& /*text*/) const { return false; }
+
+    // returns true if items failed oldText fail newText as well
+    virtual bool isFilterTextNarrowedImpl(const QString& /*oldText*/, const QString& /*newText*/) const { return false; }
+
 private:
     QString m_filterText;
+    TextMatcher m_filterMatcher;
 };
 
 class QI_EXPORT RowsFilterByText: public LinesVisibility
@@ -57,17 +82,89 @@ public:
     bool addFilterByColumn(int column, SharedPtr<ItemsFilterByText> filter);
     void clearFilters();
 
+    // index of column texts to find candidate rows before exact filtering
+    // index should represent the same text model as the column filter
+    SharedPtr<TextTrigramIndex> textIndexByColumn(int column) const;
+    void setTextIndex(SharedPtr<TextTrigramIndex> index);
+
     bool isActive() const { return m_isActive; }
     void setActive(bool isActive);
 
+    // evaluates all rows at once in worker threads
+    // if all column filters are thread safe
+    bool isParallel() const { return m_isParallel; }
+    void setParallel(bool isParallel);
+
+    // delay in milliseconds to collect several filter changes (keystrokes)
+    int debounceInterval() const { return m_debounceInterval; }
+    void setDebounceInterval(int msec);
+
+    // evaluates rows in background thread if all column filters provide item texts
+    // texts are copied in GUI thread once per model change, so models are never read by the thread
+    // rows visibility is replaced at once when evaluation is done
+    // newer filter changes cancel evaluation in progress
+    bool isAsync() const { return m_isAsync; }
+    void setAsync(bool isAsync);
+
+    // filter changes are pending or being evaluated
+    bool isFiltering() const { return m_isFiltering; }
+
+signals:
+    void filteringChanged(const RowsFilterByText*, bool isFiltering);
+
 protected:
     bool isLineVisibleImpl(int row) const override;
+    void validateLinesImpl(int linesCount) const override;
 
 private:
+    struct FilteringJob;
+    // texts of column rows copied for background filtering
+    struct ColumnTexts
+    {
+        const Model* model = nullptr;
+        quint64 modelVersion = 0;
+        QVector<QString> texts;
+    };
+
     void onFilterChanged(const ItemsFilter*);
+    void onFilterNarrowed(const ItemsFilter*);
+    void changeFilters(bool narrowed);
+    void applyChanges();
+    bool startFiltering(bool narrowed);
+    // returns false if filter doesn't provide texts
+    bool validColumnTexts(int column, const ItemsFilterByText& filter);
+    void cancelFiltering();
+    void onFilteringFinished(const SharedPtr<FilteringJob>& job);
+    void setFiltering(bool isFiltering);
+    bool isRowPassFilters(int row) const;
+    // sorted rows which may pass filters, returns false if there is no index to use
+    bool candidateRows(QVector<int>& rows) const;
+    void invalidateRowsVisible() const { m_rowsVisible.clear(); m_rowsVisibleCount = 0; m_isNarrowing = false; }
 
     mutable QVector<SharedPtr<ItemsFilterByText>> m_filterByColumn;
+    QVector<SharedPtr<TextTrigramIndex>> m_textIndexByColumn;
     bool m_isActive;
+    bool m_isParallel;
+
+    // visibility of rows evaluated by chunks of RowsChunkSize
+    // m_rowsVisible.empty - rows are evaluated on request
+    mutable QVector<BitVector> m_rowsVisible;
+    mutable int m_rowsVisibleCount;
+    // filters were narrowed, only rows visible in m_rowsVisible should be tested again
+    mutable bool m_isNarrowing;
+    // lines count of the last validation
+    mutable int m_linesCount;
+
+    // changes collected while debouncing
+    bool m_hasPendingChanges;
+    bool m_isPendingNarrowed;
+    int m_debounceInterval;
+    QTimer* m_debounceTimer;
+
+    bool m_isAsync;
+    bool m_isFiltering;
+    SharedPtr<FilteringJob> m_job;
+    QVector<ColumnTexts> m_textsByColumn;
 };
 
 QI_EXPORT SharedPtr<View> makeViewRowsFilterByText(SharedPtr<RowsFilterByText> filter);
@@ -81,7 +178,10 @@ public:
     ItemsFilterTextByText(SharedPtr<ModelText> modelText);
 
 protected:
-    bool isItemPassFilterImpl(ID id) const override;
+    bool isItemPassFilterTextImpl(ID id, const TextMatcher& matcher) const override;
+    bool itemTextImpl(ID id, QString& text) const override;
+    bool isThreadSafeImpl() const override { return m_modelText->isThreadSafe(); }
+    bool isFilterTextNarrowedImpl(const QString& oldText, const QString& newText) const override;
 
 private:
     SharedPtr<ModelText> m_modelText;
@@ -0,0 +1,235 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "FilterTextIndex.h"
+#include "space/grid/GridID.h"
+#include "utils/TextMatcher.h"
+#include <algorithm>
+
+namespace Qi
+{
+
+// more items are reindexed by full rebuild
+static const int IncrementalIndexLimit = 1024;
+
+TextTrigramIndex::TextTrigramIndex(SharedPtr<ModelText> model, int column, SharedPtr<Lines> rows)
+    : m_model(std::move(model)),
+      m_column(column),
+      m_rows(std::move(rows)),
+      m_isValid(false),
+      m_itemsUpdated(false)
+{
+    Q_ASSERT(m_model);
+    Q_ASSERT(m_rows);
+
+    connect(m_model.data(), &Model::modelChanged, this, &TextTrigramIndex::onModelChanged);
+    connect(m_model.data(), &Model::modelItemChanged, this, &TextTrigramIndex::onModelItemChanged);
+    connect(m_model.data(), &Model::modelItemsChanged, this, &TextTrigramIndex::onModelItemsChanged);
+    connect(m_rows.data(), &Lines::linesChanged, this, &TextTrigramIndex::onRowsChanged);
+}
+
+TextTrigramIndex::~TextTrigramIndex()
+{
+    disconnect(m_model.data(), &Model::modelChanged, this, &TextTrigramIndex::onModelChanged);
+    disconnect(m_model.data(), &Model::modelItemChanged, this, &TextTrigramIndex::onModelItemChanged);
+    disconnect(m_model.data(), &Model::modelItemsChanged, this, &TextTrigramIndex::onModelItemsChanged);
+    disconnect(m_rows.data(), &Lines::linesChanged, this, &TextTrigramIndex::onRowsChanged);
+}
+
+bool TextTrigramIndex::candidateRows(const QString& text, QVector<int>& rows) const
+{
+    if (!isSearchable(text))
+        return false;
+
+    validate();
+
+    QVector<Trigram> textTrigrams;
+    trigrams(text, textTrigrams);
+
+    // intersect posting lists starting from the shortest one
+    QVector<const QVector<int>*> postings;
+    postings.reserve(textTrigrams.size());
+    for (auto trigram: textTrigrams)
+    {
+        auto it = m_postings.constFind(trigram);
+        if (it == m_postings.constEnd())
+        {
+            rows.clear();
+            return true;
+        }
+        postings.append(&it.value());
+    }
+
+    std::sort(postings.begin(), postings.end(), [](const QVector<int>* left, const QVector<int>* right) {
+        return left->size() < right->size();
+    });
+
+    rows = *postings.first();
+    QVector<int> intersection;
+    for (int i = 1; i < postings.size() && !rows.isEmpty(); ++i)
+    {
+        intersection.clear();
+        std::set_intersection(rows.begin(), rows.end(), postings[i]->begin(), postings[i]->end(), std::back_inserter(intersection));
+        rows.swap(intersection);
+    }
+
+    return true;
+}
+
+void TextTrigramIndex::onModelChanged(const Model*)
+{
+    // index was updated by item signals
+    if (m_itemsUpdated)
+    {
+        m_itemsUpdated = false;
+        return;
+    }
+
+    invalidate();
+}
+
+void TextTrigramIndex::onModelItemChanged(const Model*, ID id)
+{
+    updateItems(QVector<ID>(1, id));
+}
+
+void TextTrigramIndex::onModelItemsChanged(const Model*, const QVector<ID>& ids)
+{
+    updateItems(ids);
+}
+
+void TextTrigramIndex::updateItems(const QVector<ID>& items)
+{
+    // items signals come before modelChanged
+    // so index is up to date when filters are notified
+    m_itemsUpdated = true;
+
+    if (!m_isValid)
+        return;
+
+    if (items.size() > IncrementalIndexLimit)
+    {
+        invalidate();
+        return;
+    }
+
+    for (const auto& item: items)
+    {
+        const auto& id = item.as<GridID>();
+        if (id.column == m_column)
+            updateRow(id.row);
+    }
+}
+
+void TextTrigramIndex::onRowsChanged(const Lines*, ChangeReason reason)
+{
+    if (reason & ChangeReasonLinesCount)
+        invalidate();
+}
+
+void TextTrigramIndex::invalidate()
+{
+    m_postings.clear();
+    m_texts.clear();
+    m_isValid = false;
+}
+
+void TextTrigramIndex::validate() const
+{
+    if (m_isValid)
+        return;
+
+    const int count = m_rows->count();
+    m_texts.resize(count);
+    // rows are added in increasing order, so posting lists are sorted
+    for (int row = 0; row < count; ++row)
+        insertRow(row, false);
+
+    m_isValid = true;
+}
+
+void TextTrigramIndex::updateRow(int row)
+{
+    if (row < 0 || row >= m_texts.size())
+        return;
+
+    QString text = m_model->value(ID(GridID(row, m_column)));
+    if (text == m_texts[row])
+        return;
+
+    removeRow(row);
+    insertRow(row, true);
+}
+
+void TextTrigramIndex::insertRow(int row, bool sorted) const
+{
+    m_texts[row] = m_model->value(ID(GridID(row, m_column)));
+
+    QVector<Trigram> rowTrigrams;
+    trigrams(m_texts[row], rowTrigrams);
+    for (auto trigram: rowTrigrams)
+    {
+        auto& rows = m_postings[trigram];
+        if (!sorted)
+            rows.append(row);
+        else
+            rows.insert(int(std::lower_bound(rows.begin(), rows.end(), row) - rows.begin()), row);
+    }
+}
+
+void TextTrigramIndex::removeRow(int row)
+{
+    QVector<Trigram> rowTrigrams;
+    trigrams(m_texts[row], rowTrigrams);
+    for (auto trigram: rowTrigrams)
+    {
+        auto it = m_postings.find(trigram);
+        Q_ASSERT(it != m_postings.end());
+        if (it == m_postings.end())
+            continue;
+
+        auto& rows = it.value();
+        auto rowIt = std::lower_bound(rows.begin(), rows.end(), row);
+        if (rowIt != rows.end() && *rowIt == row)
+            rows.erase(rowIt);
+
+        if (rows.isEmpty())
+            m_postings.erase(it);
+    }
+
+    m_texts[row].clear();
+}
+
+void TextTrigramIndex::trigrams(const QString& text, QVector<Trigram>& result)
+{
+    result.clear();
+    if (text.size() < 3)
+        return;
+
+    result.reserve(text.size() - 2);
+    const QChar* chars = text.constData();
+    for (int i = 0, n = text.size() - 2; i < n; ++i)
+    {
+        result.append((Trigram(TextMatcher::foldCase(chars[i].unicode())) << 32)
+                      | (Trigram(TextMatcher::foldCase(chars[i + 1].unicode())) << 16)
+                      | Trigram(TextMatcher::foldCase(chars[i + 2].unicode())));
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+} // end namespace Qi
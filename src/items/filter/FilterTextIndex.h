@@ -0,0 +1,84 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_FILTER_TEXT_INDEX_H
+#define QI_FILTER_TEXT_INDEX_H
+
+#include "items/text/Text.h"
+#include "space/grid/Lines.h"
+#include <QHash>
+
+namespace Qi
+{
+
+// inverted index of text trigrams of a column
+// trigrams are case folded, so index serves case sensitive and insensitive filters
+// finds rows which may contain a substring without scanning all rows
+// index is updated for changed items if model reports them
+class QI_EXPORT TextTrigramIndex: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(TextTrigramIndex)
+
+public:
+    TextTrigramIndex(SharedPtr<ModelText> model, int column, SharedPtr<Lines> rows);
+    ~TextTrigramIndex();
+
+    const SharedPtr<ModelText>& model() const { return m_model; }
+    int column() const { return m_column; }
+
+    // texts shorter than trigram cannot be searched by index
+    static bool isSearchable(const QString& text) { return text.size() >= 3; }
+
+    // collects sorted rows which may contain text, exact test is still required
+    // returns false if text is not searchable
+    bool candidateRows(const QString& text, QVector<int>& rows) const;
+
+private:
+    typedef quint64 Trigram;
+
+    void onModelChanged(const Model*);
+    void onModelItemChanged(const Model*, ID id);
+    void onModelItemsChanged(const Model*, const QVector<ID>& ids);
+    void onRowsChanged(const Lines*, ChangeReason reason);
+    void updateItems(const QVector<ID>& items);
+
+    void invalidate();
+    void validate() const;
+    void updateRow(int row);
+    void insertRow(int row, bool sorted) const;
+    void removeRow(int row);
+
+    // sorted unique trigrams of the text
+    static void trigrams(const QString& text, QVector<Trigram>& result);
+
+    SharedPtr<ModelText> m_model;
+    int m_column;
+    SharedPtr<Lines> m_rows;
+
+    // m_postings[trigram] - sorted rows containing trigram
+    mutable QHash<Trigram, QVector<int>> m_postings;
+    // indexed text of each row
+    mutable QVector<QString> m_texts;
+    mutable bool m_isValid;
+
+    // items were reported before modelChanged
+    bool m_itemsUpdated;
+};
+
+} // end namespace Qi
+
+#endif // QI_FILTER_TEXT_INDEX_H
@@ -0,0 +1,313 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "GridTextSearch.h"
+#include "FilterTextIndex.h"
+#include "cache/CacheItemFactory.h"
+#include "utils/BitVector.h"
+#include <QTimer>
+#include <QMutex>
+#include "utils/TaskPool.h"
+#include <atomic>
+#include <algorithm>
+
+namespace Qi
+{
+
+struct GridTextSearch::SearchJob
+{
+    SharedPtr<CacheItemFactory> factory;
+    // absolute indexes of visible lines
+    QVector<int> rows;
+    QVector<int> columns;
+    TextMatcher matcher;
+    // candidate absolute rows of visible columns, empty - all rows are tested
+    QVector<BitVector> candidates;
+    TaskToken token;
+    std::atomic<int> progress { 0 };
+    bool completed = false;
+
+    // matches found but not taken by GUI thread yet
+    QMutex mutex;
+    QVector<GridTextMatch> matches;
+};
+
+// rows between publishing matches and progress updates
+static const int SearchChunkRows = 1024;
+// interval to take found matches and update progress
+static const int SearchProgressInterval = 100;
+
+static QVector<int> visibleLines(const Lines& lines)
+{
+    QVector<int> result;
+    int count = lines.visibleCount();
+    result.reserve(count);
+    for (int i = 0; i < count; ++i)
+        result.append(lines.toAbsolute(i));
+    return result;
+}
+
+static bool isMatchBefore(const GridTextMatch& match, GridID visibleId)
+{
+    return match.visibleId.row < visibleId.row ||
+            (match.visibleId.row == visibleId.row && match.visibleId.column < visibleId.column);
+}
+
+GridTextSearch::GridTextSearch(SharedPtr<SpaceGrid> grid, QObject* parent)
+    : QObject(parent),
+      m_grid(std::move(grid)),
+      m_rowsVersion(0),
+      m_columnsVersion(0),
+      m_progressTimer(new QTimer(this))
+{
+    Q_ASSERT(m_grid);
+
+    m_progressTimer->setInterval(SearchProgressInterval);
+    connect(m_progressTimer, &QTimer::timeout, this, &GridTextSearch::onSearchTimeout);
+}
+
+GridTextSearch::~GridTextSearch()
+{
+    // worker thread owns job so it's safe to leave it
+    cancelSearch();
+}
+
+SharedPtr<TextTrigramIndex> GridTextSearch::textIndexByColumn(int column) const
+{
+    if (column < 0 || column >= m_textIndexByColumn.size())
+        return SharedPtr<TextTrigramIndex>();
+
+    return m_textIndexByColumn[column];
+}
+
+void GridTextSearch::setTextIndex(SharedPtr<TextTrigramIndex> index)
+{
+    Q_ASSERT(index);
+    int column = index->column();
+    if (m_textIndexByColumn.size() <= column)
+        m_textIndexByColumn.resize(column + 1);
+
+    m_textIndexByColumn[column] = std::move(index);
+}
+
+int GridTextSearch::search(const QString& pattern, Qt::CaseSensitivity cs)
+{
+    cancelSearch();
+
+    auto job = createJob(pattern, cs);
+    if (!job)
+        return 0;
+
+    runJob(*job);
+    takeMatches(*job);
+    emit searchFinished(this, true);
+
+    return m_matches.size();
+}
+
+bool GridTextSearch::startSearch(const QString& pattern, Qt::CaseSensitivity cs)
+{
+    // new search replaces previous one
+    cancelSearch();
+
+    auto job = createJob(pattern, cs);
+    if (!job)
+        return false;
+
+    TaskPool::instance().run(this, [job]() {
+        runJob(*job);
+    }, [this, job]() {
+        onSearchFinished(job);
+    }, TaskPriorityNormal, job->token);
+
+    m_job = job;
+    m_progressTimer->start();
+
+    return true;
+}
+
+int GridTextSearch::searchProgress() const
+{
+    return m_job ? m_job->progress.load() : 0;
+}
+
+void GridTextSearch::cancelSearch()
+{
+    if (!m_job)
+        return;
+
+    m_job->token.cancel();
+    m_job.reset();
+    m_progressTimer->stop();
+}
+
+void GridTextSearch::clear()
+{
+    cancelSearch();
+    m_matcher = TextMatcher();
+    m_matches.clear();
+}
+
+bool GridTextSearch::isUpToDate() const
+{
+    return m_rowsVersion == m_grid->rows()->version() && m_columnsVersion == m_grid->columns()->version();
+}
+
+int GridTextSearch::findNext(GridID visibleId, bool backward) const
+{
+    if (m_matches.isEmpty())
+        return -1;
+
+    if (backward)
+    {
+        // last match before visibleId
+        auto it = std::lower_bound(m_matches.begin(), m_matches.end(), visibleId, isMatchBefore);
+        return (it == m_matches.begin()) ? m_matches.size() - 1 : int(it - m_matches.begin()) - 1;
+    }
+
+    // first match after visibleId
+    auto it = std::upper_bound(m_matches.begin(), m_matches.end(), visibleId, [](GridID id, const GridTextMatch& match) {
+        return id.row < match.visibleId.row || (id.row == match.visibleId.row && id.column < match.visibleId.column);
+    });
+    return (it == m_matches.end()) ? 0 : int(it - m_matches.begin());
+}
+
+SharedPtr<GridTextSearch::SearchJob> GridTextSearch::createJob(const QString& pattern, Qt::CaseSensitivity cs)
+{
+    m_matcher = TextMatcher(pattern, cs);
+    m_matches.clear();
+    m_rowsVersion = m_grid->rows()->version();
+    m_columnsVersion = m_grid->columns()->version();
+
+    if (m_matcher.isEmpty())
+        return SharedPtr<SearchJob>();
+
+    // Lines, ordered schemas and indexes are not thread safe, so resolve them here
+    m_grid->schemasOrdered();
+
+    auto job = makeShared<SearchJob>();
+    job->factory = m_grid->createCacheItemFactory();
+    job->rows = visibleLines(*m_grid->rows());
+    job->columns = visibleLines(*m_grid->columns());
+    job->matcher = m_matcher;
+
+    job->candidates.resize(job->columns.size());
+    QVector<int> candidateRows;
+    for (int j = 0; j < job->columns.size(); ++j)
+    {
+        auto index = textIndexByColumn(job->columns[j]);
+        if (!index || !index->candidateRows(pattern, candidateRows))
+            continue;
+
+        BitVector& candidates = job->candidates[j];
+        candidates.resize(m_grid->rows()->count());
+        for (int row: candidateRows)
+            candidates.setValue(row, true);
+    }
+
+    return job;
+}
+
+void GridTextSearch::runJob(SearchJob& job)
+{
+    QString text;
+    QVector<GridTextMatch> chunkMatches;
+
+    int rowsCount = job.rows.size();
+    for (int i = 0; i < rowsCount; ++i)
+    {
+        int row = job.rows[i];
+        for (int j = 0; j < job.columns.size(); ++j)
+        {
+            const BitVector& candidates = job.candidates[j];
+            if (!candidates.empty() && !candidates.value(row))
+                continue;
+
+            CacheItemInfo info(ID(GridID(row, job.columns[j])));
+            job.factory->updateSchema(info);
+            if (!info.schema.view)
+                continue;
+
+            text.resize(0);
+            if (info.schema.view->text(info.id, text) && job.matcher.isMatched(text))
+            {
+                GridTextMatch match = { info.id.as<GridID>(), GridID(i, j) };
+                chunkMatches.append(match);
+            }
+        }
+
+        if ((i + 1) % SearchChunkRows == 0 || i + 1 == rowsCount)
+        {
+            if (!chunkMatches.isEmpty())
+            {
+                QMutexLocker locker(&job.mutex);
+                job.matches += chunkMatches;
+                chunkMatches.resize(0);
+            }
+
+            if (job.token.isCancelled())
+                return;
+            job.progress = int(qint64(i + 1) * 100 / rowsCount);
+        }
+    }
+
+    job.progress = 100;
+    job.completed = true;
+}
+
+void GridTextSearch::takeMatches(SearchJob& job)
+{
+    QVector<GridTextMatch> matches;
+    {
+        QMutexLocker locker(&job.mutex);
+        matches.swap(job.matches);
+    }
+
+    if (matches.isEmpty())
+        return;
+
+    int firstIndex = m_matches.size();
+    m_matches += matches;
+    emit matchesFound(this, firstIndex, matches.size());
+}
+
+void GridTextSearch::onSearchFinished(const SharedPtr<SearchJob>& job)
+{
+    // search was cancelled or replaced
+    if (m_job != job)
+        return;
+
+    m_job.reset();
+    m_progressTimer->stop();
+
+    takeMatches(*job);
+    emit searchFinished(this, job->completed);
+}
+
+void GridTextSearch::onSearchTimeout()
+{
+    if (!m_job)
+        return;
+
+    // keep job alive if handlers cancel search
+    auto job = m_job;
+    takeMatches(*job);
+    if (m_job == job)
+        emit searchProgressChanged(this, job->progress);
+}
+
+} // end namespace Qi
@@ -0,0 +1,111 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_GRID_TEXT_SEARCH_H
+#define QI_GRID_TEXT_SEARCH_H
+
+#include "space/grid/SpaceGrid.h"
+#include "utils/TextMatcher.h"
+#include <QObject>
+
+class QTimer;
+
+namespace Qi
+{
+
+class TextTrigramIndex;
+
+struct GridTextMatch
+{
+    // absolute item
+    GridID id;
+    // visible item at the moment search was started
+    GridID visibleId;
+};
+
+// finds visible grid items which text (see View::text) contains pattern
+// rows are scanned in visible order by chunks, found matches are appended
+// incrementally and kept for find next/previous until the next search
+class QI_EXPORT GridTextSearch: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(GridTextSearch)
+
+public:
+    explicit GridTextSearch(SharedPtr<SpaceGrid> grid, QObject* parent = nullptr);
+    virtual ~GridTextSearch();
+
+    const SharedPtr<SpaceGrid>& grid() const { return m_grid; }
+
+    // candidate rows of the column are taken from index (see RowsFilterByText::setTextIndex)
+    // index should represent the same texts as views of the column
+    SharedPtr<TextTrigramIndex> textIndexByColumn(int column) const;
+    void setTextIndex(SharedPtr<TextTrigramIndex> index);
+
+    // searches in GUI thread, returns count of matches
+    int search(const QString& pattern, Qt::CaseSensitivity cs = Qt::CaseInsensitive);
+
+    // searches in background thread, models of grid views should be thread safe
+    // grid schemas should not be changed until searchFinished
+    bool startSearch(const QString& pattern, Qt::CaseSensitivity cs = Qt::CaseInsensitive);
+    bool isSearching() const { return !m_job.isNull(); }
+    int searchProgress() const;
+    void cancelSearch();
+    void clear();
+
+    const TextMatcher& matcher() const { return m_matcher; }
+    // matches in visible order of items at the moment search was started
+    const QVector<GridTextMatch>& matches() const { return m_matches; }
+    // rows and columns weren't changed since search was started,
+    // so visible ids of matches are still actual
+    bool isUpToDate() const;
+
+    // index of the first match after (or before) visible item in visible order,
+    // search wraps around, returns -1 if there are no matches (found yet)
+    int findNext(GridID visibleId, bool backward = false) const;
+
+signals:
+    // matches [firstIndex, firstIndex + count) were appended
+    void matchesFound(const GridTextSearch*, int firstIndex, int count);
+    void searchProgressChanged(const GridTextSearch*, int percent);
+    void searchFinished(const GridTextSearch*, bool completed);
+
+private:
+    struct SearchJob;
+
+    SharedPtr<SearchJob> createJob(const QString& pattern, Qt::CaseSensitivity cs);
+    static void runJob(SearchJob& job);
+    // moves matches found by job so far to m_matches
+    void takeMatches(SearchJob& job);
+    void onSearchFinished(const SharedPtr<SearchJob>& job);
+    void onSearchTimeout();
+
+    SharedPtr<SpaceGrid> m_grid;
+    QVector<SharedPtr<TextTrigramIndex>> m_textIndexByColumn;
+
+    TextMatcher m_matcher;
+    QVector<GridTextMatch> m_matches;
+    quint64 m_rowsVersion;
+    quint64 m_columnsVersion;
+
+    SharedPtr<SearchJob> m_job;
+    QTimer* m_progressTimer;
+};
+
+} // end namespace Qi
+
+#endif // QI_GRID_TEXT_SEARCH_H
@@ -20,24 +20,62 @@ namespace Qi
 {
 
 ViewImage::ViewImage(SharedPtr<ModelImage> model)
-    : ViewModeled<ModelImage>(std::move(model))
+    : ViewModeled<ModelImage>(std::move(model)),
+      m_isScaledToFit(false),
+      m_scaledPixmapCache(new ScaledPixmapCache(16 * 1024, this))
 {
+    connect(m_scaledPixmapCache, &ScaledPixmapCache::pixmapReady, this, [this]() {
+        emitViewChanged(ChangeReasonViewContent);
+    });
+}
+
+void ViewImage::setScaledToFit(bool isScaledToFit)
+{
+    if (m_isScaledToFit == isScaledToFit)
+        return;
+
+    m_isScaledToFit = isScaledToFit;
+    if (!m_isScaledToFit)
+        m_scaledPixmapCache->clear();
+
+    emitViewChanged(ChangeReasonViewContent);
 }
 
 QSize ViewImage::sizeImpl(const GuiContext& /*ctx*/, ID id, ViewSizeMode /*sizeMode*/) const
 {
     QImage image = theModel()->value(id);
-    return image.size();
+    return ScaledPixmapCache::logicalSize(image);
 }
 
 void ViewImage::drawImpl(QPainter* painter, const GuiContext& /*ctx*/, const CacheContext& cache, bool* /*showTooltip*/) const
 {
     QImage image = theModel()->value(cache.id);
     QRect viewRect = cache.cacheView.rect();
-    int x = viewRect.left() + (viewRect.width() - image.width()) / 2;
-    int y = viewRect.top() + (viewRect.height() - image.height()) / 2;
+    QSize imageSize = ScaledPixmapCache::logicalSize(image);
+    qreal pixelRatio = painter->device()->devicePixelRatioF();
+
+    if (m_isScaledToFit && !viewRect.contains(QRect(viewRect.topLeft(), imageSize)))
+    {
+        QRect imageRect(QPoint(0, 0), imageSize.scaled(viewRect.size(), Qt::KeepAspectRatio));
+        imageRect.moveCenter(viewRect.center());
+
+        QPixmap pixmap = m_scaledPixmapCache->scaled(image, imageRect.size(), pixelRatio);
+        if (!pixmap.isNull())
+            painter->drawPixmap(imageRect.topLeft(), pixmap);
+        else // fast scaled placeholder while scaling in background
+            painter->drawImage(imageRect, image);
+        return;
+    }
+
+    int x = viewRect.left() + (viewRect.width() - imageSize.width()) / 2;
+    int y = viewRect.top() + (viewRect.height() - imageSize.height()) / 2;
 
-    painter->drawImage(x, y, image);
+    // image is converted to pixmap of the device ratio once
+    QPixmap pixmap = ScaledPixmapCache::shared().forPixelRatio(image, pixelRatio);
+    if (!pixmap.isNull())
+        painter->drawPixmap(x, y, pixmap);
+    else
+        painter->drawImage(x, y, image);
 }
 
 } // end namespace Qi
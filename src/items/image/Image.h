@@ -19,6 +19,7 @@
 
 #include "core/ext/ViewModeled.h"
 #include "core/ext/ModelCallback.h"
+#include "ScaledPixmapCache.h"
 #include <QImage>
 
 namespace Qi
@@ -44,9 +45,21 @@ class QI_EXPORT ViewImage: public ViewModeled<ModelImage>
 public:
     ViewImage(SharedPtr<ModelImage> model);
 
+    // scale images down to fit view rect keeping aspect ratio
+    bool isScaledToFit() const { return m_isScaledToFit; }
+    void setScaledToFit(bool isScaledToFit);
+
+    // cache of scaled pixmaps used by scaled to fit mode
+    ScaledPixmapCache* scaledPixmapCache() const { return m_scaledPixmapCache; }
+
 protected:
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawnInDraftImpl() const override { return false; }
+
+private:
+    bool m_isScaledToFit;
+    ScaledPixmapCache* m_scaledPixmapCache;
 };
 
 } // end namespace Qi
@@ -0,0 +1,221 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "ImageAsync.h"
+#include <QImageReader>
+#include <QRunnable>
+#include <QTimer>
+#include <QUrl>
+#include <limits>
+#include <stdexcept>
+
+namespace Qi
+{
+
+// prefetched items wait for all painted ones
+static const int PrefetchPriority = 0;
+
+class ImageDecodeTask: public QRunnable
+{
+public:
+    ImageDecodeTask(QObject* receiver, const QString& source)
+        : m_receiver(receiver),
+          m_source(source)
+    {
+    }
+
+    void run() override
+    {
+        QUrl url(m_source);
+        QImageReader reader(url.isLocalFile() ? url.toLocalFile() : m_source);
+        reader.setAutoTransform(true);
+        QImage image = reader.read();
+
+        // receiver outlives thread pool tasks
+        QMetaObject::invokeMethod(m_receiver, "onImageDecoded", Qt::QueuedConnection,
+                                  Q_ARG(QString, m_source), Q_ARG(QImage, image));
+    }
+
+private:
+    QObject* m_receiver;
+    QString m_source;
+};
+
+ModelImageAsync::ModelImageAsync(const SourceFunction_t& sourceFunc, int cacheBudgetKb)
+    : sourceFunction(sourceFunc),
+      m_images(cacheBudgetKb),
+      m_isShowing(false),
+      m_lastPriority(PrefetchPriority)
+{
+}
+
+ModelImageAsync::~ModelImageAsync()
+{
+    m_threadPool.clear();
+    m_threadPool.waitForDone();
+}
+
+void ModelImageAsync::setPlaceholder(const QImage& placeholder)
+{
+    m_placeholder = placeholder;
+    notifyChanged();
+}
+
+void ModelImageAsync::setCacheBudget(int budgetKb)
+{
+    m_images.setMaxCost(budgetKb);
+}
+
+void ModelImageAsync::setMaxThreadCount(int maxThreadCount)
+{
+    m_threadPool.setMaxThreadCount(maxThreadCount);
+}
+
+void ModelImageAsync::prefetch(ID id)
+{
+    if (!sourceFunction)
+        return;
+
+    QString source = sourceFunction(id);
+    if (source.isEmpty() || m_images.contains(source) || m_failedSources.contains(source) || shownImage(source))
+        return;
+
+    request(id, source, PrefetchPriority);
+}
+
+void ModelImageAsync::clear()
+{
+    m_threadPool.clear();
+    m_images.clear();
+    m_failedSources.clear();
+    m_shownImages.clear();
+    m_lastShownImages.clear();
+    // results of running loadings are dropped
+    m_pendingItems.clear();
+    m_lastPriority = PrefetchPriority;
+
+    notifyChanged();
+}
+
+QImage ModelImageAsync::valueImpl(ID id) const
+{
+    if (!sourceFunction)
+        throw std::logic_error("Source function is not set");
+
+    QString source = sourceFunction(id);
+    if (source.isEmpty())
+        return m_placeholder;
+
+    if (!m_isShowing)
+    {
+        // images of the previous paint are kept until this one is done
+        m_lastShownImages.swap(m_shownImages);
+        m_shownImages.clear();
+
+        m_isShowing = true;
+        auto self = const_cast<ModelImageAsync*>(this);
+        QTimer::singleShot(0, self, [self]() { self->m_isShowing = false; });
+    }
+
+    if (auto image = m_images.object(source))
+    {
+        m_shownImages.insert(source, *image);
+        return *image;
+    }
+
+    // evicted by newer images or too large for the budget
+    if (auto image = shownImage(source))
+    {
+        QImage shown = *image;
+        m_shownImages.insert(source, shown);
+        return shown;
+    }
+
+    if (!m_failedSources.contains(source))
+    {
+        // restart priority counter before it overflows
+        if (m_lastPriority == std::numeric_limits<int>::max())
+            m_lastPriority = PrefetchPriority;
+
+        request(id, source, ++m_lastPriority);
+    }
+
+    return m_placeholder;
+}
+
+bool ModelImageAsync::setValueImpl(ID /*id*/, QImage /*value*/)
+{
+    return false;
+}
+
+void ModelImageAsync::onImageDecoded(const QString& source, const QImage& image)
+{
+    // source has been cleared
+    if (!m_pendingItems.contains(source))
+        return;
+
+    QVector<ID> items = m_pendingItems.take(source);
+
+    if (image.isNull())
+    {
+        m_failedSources.insert(source);
+        return;
+    }
+
+    // cost in kilobytes, too large image would be dropped by the cache at once
+    int cost = qMax(1, image.byteCount() / 1024);
+    if (cost <= m_images.maxCost())
+        m_images.insert(source, new QImage(image), cost);
+
+    // image is kept until items are painted with it
+    m_shownImages.insert(source, image);
+
+    ModelUpdateGuard guard(*this);
+    for (ID id : items)
+        notifyItemChanged(id);
+}
+
+const QImage* ModelImageAsync::shownImage(const QString& source) const
+{
+    auto it = m_shownImages.constFind(source);
+    if (it != m_shownImages.constEnd())
+        return &it.value();
+
+    it = m_lastShownImages.constFind(source);
+    if (it != m_lastShownImages.constEnd())
+        return &it.value();
+
+    return nullptr;
+}
+
+void ModelImageAsync::request(ID id, const QString& source, int priority) const
+{
+    auto it = m_pendingItems.find(source);
+    if (it != m_pendingItems.end())
+    {
+        // source is already being loaded
+        if (!it->contains(id))
+            it->append(id);
+        return;
+    }
+
+    m_pendingItems.insert(source, QVector<ID>() << id);
+
+    auto self = const_cast<ModelImageAsync*>(this);
+    m_threadPool.start(new ImageDecodeTask(self, source), priority);
+}
+
+} // end namespace Qi
@@ -0,0 +1,94 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_IMAGE_ASYNC_H
+#define QI_IMAGE_ASYNC_H
+
+#include "Image.h"
+#include <QCache>
+#include <QHash>
+#include <QSet>
+#include <QThreadPool>
+#include <functional>
+
+namespace Qi
+{
+
+// image model loading images from files in thread pool
+// returns placeholder until image is decoded and notifies item change after that
+class QI_EXPORT ModelImageAsync: public ModelImage
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ModelImageAsync)
+
+public:
+    // returns file path or local file url of item image
+    typedef std::function<QString(ID)> SourceFunction_t;
+
+    explicit ModelImageAsync(const SourceFunction_t& sourceFunc, int cacheBudgetKb = 64 * 1024);
+    ~ModelImageAsync();
+
+    SourceFunction_t sourceFunction;
+
+    // image shown while loading or if loading has failed
+    const QImage& placeholder() const { return m_placeholder; }
+    void setPlaceholder(const QImage& placeholder);
+
+    // memory budget for decoded images in kilobytes
+    // images shown by the last paint are kept beyond the budget
+    int cacheBudget() const { return m_images.maxCost(); }
+    void setCacheBudget(int budgetKb);
+
+    int maxThreadCount() const { return m_threadPool.maxThreadCount(); }
+    void setMaxThreadCount(int maxThreadCount);
+
+    // starts loading with lower priority than painted items
+    void prefetch(ID id);
+
+    // drops decoded images, failures and queued loadings
+    void clear();
+
+protected:
+    QImage valueImpl(ID id) const override;
+    bool setValueImpl(ID id, QImage value) override;
+
+private slots:
+    void onImageDecoded(const QString& source, const QImage& image);
+
+private:
+    void request(ID id, const QString& source, int priority) const;
+    // looks up images shown during the current or previous paint
+    const QImage* shownImage(const QString& source) const;
+
+    mutable QCache<QString, QImage> m_images;
+    // items waiting for each source being decoded
+    mutable QHash<QString, QVector<ID>> m_pendingItems;
+    mutable QSet<QString> m_failedSources;
+    // images returned during the current event loop turn and the previous turn with paints
+    // visible images stay even if they don't fit in m_images, so they aren't decoded on each paint
+    mutable QHash<QString, QImage> m_shownImages;
+    mutable QHash<QString, QImage> m_lastShownImages;
+    mutable bool m_isShowing;
+    // recently painted items are loaded first
+    mutable int m_lastPriority;
+    QImage m_placeholder;
+    // destroyed first to wait for running loadings
+    mutable QThreadPool m_threadPool;
+};
+
+} // end namespace Qi
+
+#endif // QI_IMAGE_ASYNC_H
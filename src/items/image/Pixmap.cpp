@@ -20,27 +20,65 @@ namespace Qi
 {
 
 ViewPixmap::ViewPixmap(SharedPtr<ModelPixmap> model)
-    : ViewModeled<ModelPixmap>(std::move(model))
+    : ViewModeled<ModelPixmap>(std::move(model)),
+      m_isScaledToFit(false),
+      m_scaledPixmapCache(new ScaledPixmapCache(16 * 1024, this))
 {
+    connect(m_scaledPixmapCache, &ScaledPixmapCache::pixmapReady, this, [this]() {
+        emitViewChanged(ChangeReasonViewContent);
+    });
+}
+
+void ViewPixmap::setScaledToFit(bool isScaledToFit)
+{
+    if (m_isScaledToFit == isScaledToFit)
+        return;
+
+    m_isScaledToFit = isScaledToFit;
+    if (!m_isScaledToFit)
+        m_scaledPixmapCache->clear();
+
+    emitViewChanged(ChangeReasonViewContent);
 }
 
 QSize ViewPixmap::sizeImpl(const GuiContext& /*ctx*/, ID id, ViewSizeMode /*sizeMode*/) const
 {
     QPixmap pixmap = theModel()->value(id);
-    return pixmap.size();
+    return ScaledPixmapCache::logicalSize(pixmap);
 }
 
 void ViewPixmap::drawImpl(QPainter* painter, const GuiContext& /*ctx*/, const CacheContext& cache, bool* /*showTooltip*/) const
 {
     QPixmap pixmap = theModel()->value(cache.id);
     QRect viewRect = cache.cacheView.rect();
-    int x = viewRect.left() + (viewRect.width() - pixmap.width()) / 2;
-    int y = viewRect.top() + (viewRect.height() - pixmap.height()) / 2;
+    QSize pixmapSize = ScaledPixmapCache::logicalSize(pixmap);
+    qreal pixelRatio = painter->device()->devicePixelRatioF();
+
+    if (m_isScaledToFit && !viewRect.contains(QRect(viewRect.topLeft(), pixmapSize)))
+    {
+        QRect pixmapRect(QPoint(0, 0), pixmapSize.scaled(viewRect.size(), Qt::KeepAspectRatio));
+        pixmapRect.moveCenter(viewRect.center());
+
+        QPixmap scaledPixmap = m_scaledPixmapCache->scaled(pixmap, pixmapRect.size(), pixelRatio);
+        if (!scaledPixmap.isNull())
+            painter->drawPixmap(pixmapRect.topLeft(), scaledPixmap);
+        else // fast scaled placeholder while scaling in background
+            painter->drawPixmap(pixmapRect, pixmap);
+        return;
+    }
+
+    int x = viewRect.left() + (viewRect.width() - pixmapSize.width()) / 2;
+    int y = viewRect.top() + (viewRect.height() - pixmapSize.height()) / 2;
+
+    // pixmap of the device ratio is drawn without scaling
+    QPixmap devicePixmap = ScaledPixmapCache::shared().forPixelRatio(pixmap, pixelRatio);
+    if (devicePixmap.isNull())
+        devicePixmap = pixmap;
 
     painter->save();
     painter->setClipRect(viewRect, Qt::IntersectClip);
 
-    painter->drawPixmap(x, y, pixmap);
+    painter->drawPixmap(x, y, devicePixmap);
 
     painter->restore();
 }
@@ -0,0 +1,173 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "ScaledPixmapCache.h"
+#include "utils/TaskPool.h"
+#include <QGuiApplication>
+#include <QPointer>
+
+namespace Qi
+{
+
+static QString scaledKey(qint64 cacheKey, const QSize& size, qreal pixelRatio)
+{
+    // equal pixel sizes of different ratios are different pixmaps
+    return QString("%1_%2x%3_%4").arg(cacheKey).arg(size.width()).arg(size.height()).arg(pixelRatio);
+}
+
+ScaledPixmapCache::ScaledPixmapCache(int budgetKb, QObject* parent)
+    : QObject(parent),
+      m_pixmaps(budgetKb),
+      m_isBackgroundScaling(false)
+{
+    MemoryBudget::instance().addCache(this, "ScaledPixmapCache", [this]() {
+        return memoryUsage().total();
+    }, [this](qint64 /*bytes*/) {
+        clear();
+    });
+}
+
+ScaledPixmapCache::~ScaledPixmapCache()
+{
+}
+
+ScaledPixmapCache& ScaledPixmapCache::shared()
+{
+    static QPointer<ScaledPixmapCache> cache;
+    if (!cache)
+    {
+        // pixmaps are released with application
+        cache = new ScaledPixmapCache(32 * 1024, qApp);
+
+        // variants for previous screens are not needed anymore
+        connect(qApp, &QGuiApplication::screenAdded, cache.data(), &ScaledPixmapCache::clear);
+        connect(qApp, &QGuiApplication::screenRemoved, cache.data(), &ScaledPixmapCache::clear);
+        connect(qApp, &QGuiApplication::primaryScreenChanged, cache.data(), &ScaledPixmapCache::clear);
+    }
+
+    return *cache;
+}
+
+void ScaledPixmapCache::setBudget(int budgetKb)
+{
+    m_pixmaps.setMaxCost(budgetKb);
+}
+
+void ScaledPixmapCache::setBackgroundScaling(bool isBackgroundScaling)
+{
+    m_isBackgroundScaling = isBackgroundScaling;
+}
+
+QPixmap ScaledPixmapCache::scaled(const QImage& image, const QSize& size, qreal pixelRatio)
+{
+    return scaledImpl(image.cacheKey(), image, size, pixelRatio);
+}
+
+QPixmap ScaledPixmapCache::scaled(const QPixmap& pixmap, const QSize& size, qreal pixelRatio)
+{
+    // convert to image only for cache misses
+    QSize pixelSize = size * pixelRatio;
+    QString key = scaledKey(pixmap.cacheKey(), pixelSize, pixelRatio);
+    if (auto cachedPixmap = m_pixmaps.object(key))
+        return *cachedPixmap;
+
+    if (m_pendingKeys.contains(key))
+        return QPixmap();
+
+    return scaledImpl(pixmap.cacheKey(), pixmap.toImage(), size, pixelRatio);
+}
+
+QPixmap ScaledPixmapCache::forPixelRatio(const QPixmap& pixmap, qreal pixelRatio)
+{
+    if (pixmap.isNull() || qFuzzyCompare(pixmap.devicePixelRatio(), pixelRatio))
+        return pixmap;
+
+    return scaled(pixmap, logicalSize(pixmap), pixelRatio);
+}
+
+QPixmap ScaledPixmapCache::forPixelRatio(const QImage& image, qreal pixelRatio)
+{
+    if (image.isNull())
+        return QPixmap();
+
+    // image of the same ratio is converted once
+    return scaled(image, logicalSize(image), pixelRatio);
+}
+
+void ScaledPixmapCache::clear()
+{
+    m_pixmaps.clear();
+    // drop results of running jobs
+    m_pendingKeys.clear();
+}
+
+MemoryUsage ScaledPixmapCache::memoryUsage() const
+{
+    MemoryUsage usage;
+    // pixmaps cost is in kilobytes
+    usage.add("pixmaps", qint64(m_pixmaps.totalCost()) * 1024);
+    return usage;
+}
+
+QPixmap ScaledPixmapCache::scaledImpl(qint64 cacheKey, const QImage& image, const QSize& size, qreal pixelRatio)
+{
+    QSize pixelSize = size * pixelRatio;
+    if (image.isNull() || pixelSize.isEmpty())
+        return QPixmap();
+
+    QString key = scaledKey(cacheKey, pixelSize, pixelRatio);
+    if (auto cachedPixmap = m_pixmaps.object(key))
+        return *cachedPixmap;
+
+    if (!m_isBackgroundScaling)
+    {
+        return insert(key, image.scaled(pixelSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation), pixelRatio);
+    }
+
+    if (m_pendingKeys.contains(key))
+        return QPixmap();
+
+    m_pendingKeys.insert(key);
+
+    // QImage is safe to scale outside gui thread, pixmaps are requested by visible views
+    auto scaledImage = makeShared<QImage>();
+    TaskPool::instance().run(this, [image, pixelSize, scaledImage]() {
+        *scaledImage = image.scaled(pixelSize, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }, [this, key, pixelRatio, scaledImage]() {
+        if (!m_pendingKeys.remove(key))
+            return;
+
+        insert(key, *scaledImage, pixelRatio);
+        emit pixmapReady();
+    }, TaskPriorityVisible);
+
+    return QPixmap();
+}
+
+QPixmap ScaledPixmapCache::insert(const QString& key, const QImage& image, qreal pixelRatio)
+{
+    QPixmap pixmap = QPixmap::fromImage(image);
+    pixmap.setDevicePixelRatio(pixelRatio);
+
+    // cost in kilobytes
+    int cost = qMax(1, pixmap.width() * pixmap.height() * pixmap.depth() / 8 / 1024);
+    m_pixmaps.insert(key, new QPixmap(pixmap), cost);
+    MemoryBudget::instance().trimLater();
+
+    return pixmap;
+}
+
+} // end namespace Qi
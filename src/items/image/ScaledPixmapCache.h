@@ -0,0 +1,85 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_SCALED_PIXMAP_CACHE_H
+#define QI_SCALED_PIXMAP_CACHE_H
+
+#include "QiAPI.h"
+#include "utils/MemoryUsage.h"
+#include <QObject>
+#include <QCache>
+#include <QSet>
+#include <QImage>
+#include <QPixmap>
+
+namespace Qi
+{
+
+// LRU cache of pre-scaled pixmaps
+// pixmaps are keyed by source cacheKey, target size and device pixel ratio
+class QI_EXPORT ScaledPixmapCache: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ScaledPixmapCache)
+
+public:
+    explicit ScaledPixmapCache(int budgetKb = 16 * 1024, QObject* parent = nullptr);
+    ~ScaledPixmapCache();
+
+    // cache shared by views drawing pixmaps, it's cleared when screens change
+    static ScaledPixmapCache& shared();
+
+    // memory budget in kilobytes
+    int budget() const { return m_pixmaps.maxCost(); }
+    void setBudget(int budgetKb);
+
+    // scale images in thread pool
+    bool isBackgroundScaling() const { return m_isBackgroundScaling; }
+    void setBackgroundScaling(bool isBackgroundScaling);
+
+    // returns image scaled to size in device independent pixels
+    // returns null pixmap if image is being scaled in background
+    QPixmap scaled(const QImage& image, const QSize& size, qreal pixelRatio);
+    QPixmap scaled(const QPixmap& pixmap, const QSize& size, qreal pixelRatio);
+
+    // returns variant of the same device independent size for pixel ratio
+    // pixmap is returned as is if it has this ratio already
+    QPixmap forPixelRatio(const QPixmap& pixmap, qreal pixelRatio);
+    QPixmap forPixelRatio(const QImage& image, qreal pixelRatio);
+
+    // size in device independent pixels
+    static QSize logicalSize(const QPixmap& pixmap) { return pixmap.size() / pixmap.devicePixelRatio(); }
+    static QSize logicalSize(const QImage& image) { return image.size() / image.devicePixelRatio(); }
+
+    void clear();
+    MemoryUsage memoryUsage() const;
+
+signals:
+    // background scaled pixmap has been added to the cache
+    void pixmapReady();
+
+private:
+    QPixmap scaledImpl(qint64 cacheKey, const QImage& image, const QSize& size, qreal pixelRatio);
+    QPixmap insert(const QString& key, const QImage& image, qreal pixelRatio);
+
+    QCache<QString, QPixmap> m_pixmaps;
+    QSet<QString> m_pendingKeys;
+    bool m_isBackgroundScaling;
+};
+
+} // end namespace Qi
+
+#endif // QI_SCALED_PIXMAP_CACHE_H
@@ -16,6 +16,7 @@
 
 #include "StyleStandardPixmap.h"
 #include "items/misc/ControllerMousePushableCallback.h"
+#include "utils/StylePixmapCache.h"
 #include <QStyleOptionButton>
 
 namespace Qi
@@ -27,12 +28,14 @@ ViewStyleStandardPixmap::ViewStyleStandardPixmap(QStyle::StandardPixmap standard
 {
     if (useDefaultController)
     {
-        auto controller = makeShared<ControllerMousePushableCallback>();
-        controller->onApply = [this] (ID id, const ControllerContext& context) {
-            if (action)
-                action(id, context, this);
-        };
-        setController(controller);
+        setControllerLazy([this]() {
+            auto controller = makeShared<ControllerMousePushableCallback>();
+            controller->onApply = [this] (ID id, const ControllerContext& context) {
+                if (action)
+                    action(id, context, this);
+            };
+            return controller;
+        });
     }
 }
 
@@ -63,7 +66,6 @@ void ViewStyleStandardPixmap::drawImpl(QPainter* painter, const GuiContext& ctx,
     option.rect = cache.cacheView.rect();
 
     // draw button
-    QIcon standardIcon = style->standardIcon(m_standardPixmap, &option, ctx.widget);
     QIcon::Mode mode = QIcon::Disabled;
     if (option.state & QStyle::State_Enabled)
         mode = QIcon::Normal;
@@ -72,7 +74,13 @@ void ViewStyleStandardPixmap::drawImpl(QPainter* painter, const GuiContext& ctx,
     if (option.state & QStyle::State_MouseOver)
         mode = QIcon::Active;
 
-    standardIcon.paint(painter, option.rect, Qt::AlignCenter, mode);
+    // icon is requested from style only when cached pixmap is missing
+    auto standardPixmap = m_standardPixmap;
+    drawStyleCached(style, painter, option, QString("s%1_%2").arg(int(standardPixmap)).arg(int(mode)),
+                    [style, standardPixmap, &option, mode, &ctx](QPainter* pixmapPainter, const QRect& rect) {
+        QIcon standardIcon = style->standardIcon(standardPixmap, &option, ctx.widget);
+        standardIcon.paint(pixmapPainter, rect, Qt::AlignCenter, mode);
+    });
 }
 
 } // end namespace Qi
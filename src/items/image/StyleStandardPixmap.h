@@ -35,7 +35,9 @@ public:
 
 protected:
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
+    bool isSizeUniformImpl() const override { return true; }
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawnInDraftImpl() const override { return false; }
 
 private:
     QStyle::StandardPixmap m_standardPixmap;
@@ -26,12 +26,14 @@ ViewLink::ViewLink(SharedPtr<ModelText> model, ViewDefaultController createDefau
 {
     if (createDefaultController)
     {
-        auto controller = makeShared<ControllerMouseLink>();
-        controller->onApply = [this] (ID id, const ControllerContext& context) {
-            if (action)
-                action(id, context, this);
-        };
-        setController(controller);
+        setControllerLazy([this]() {
+            auto controller = makeShared<ControllerMouseLink>();
+            controller->onApply = [this] (ID id, const ControllerContext& context) {
+                if (action)
+                    action(id, context, this);
+            };
+            return controller;
+        });
     }
 }
 
@@ -39,12 +41,14 @@ ViewLink::ViewLink(SharedPtr<ModelText> model, SharedPtr<ModelUrl> modelUrl, Qt:
     : ViewText(model, ViewDefaultControllerNone, alignment, textElideMode),
       m_pushableTracker(this)
 {
-    auto controller = makeShared<ControllerMouseLink>();
-    controller->onApply = [this] (ID id, const ControllerContext& context) {
-        if (action)
-            action(id, context, this);
-    };
-    setController(controller);
+    setControllerLazy([this]() {
+        auto controller = makeShared<ControllerMouseLink>();
+        controller->onApply = [this] (ID id, const ControllerContext& context) {
+            if (action)
+                action(id, context, this);
+        };
+        return controller;
+    });
 
     action = [modelUrl = std::move(modelUrl)](ID id, const ControllerContext& /*context*/, const ViewLink* /*viewLink*/) {
         QDesktopServices::openUrl(modelUrl->value(id));
@@ -56,8 +60,16 @@ void ViewLink::drawImpl(QPainter* painter, const GuiContext& ctx, const CacheCon
     PainterState pState;
     pState.save(painter);
 
+    painter->setPen(textPenImpl(painter, ctx, cache.id));
+    drawText(displayTextImpl(cache.id), painter, ctx, cache, showTooltip);
+
+    pState.restore(painter);
+}
+
+QPen ViewLink::textPenImpl(const QPainter* /*painter*/, const GuiContext& ctx, ID id) const
+{
     QColor linkColor = ctx.palette().color(ctx.colorGroup(), QPalette::Link);
-    MousePushState state = m_pushableTracker.pushStateByItem(cache.id);
+    MousePushState state = m_pushableTracker.pushStateByItem(id);
     switch (state)
     {
     case MousePushStateHot:
@@ -71,28 +83,7 @@ void ViewLink::drawImpl(QPainter* painter, const GuiContext& ctx, const CacheCon
     default:;
     }
 
-    painter->setPen(linkColor);
-
-    QRect rect = cache.cacheView.rect();
-    QString text = theModel()->value(cache.id);
-    Qt::TextElideMode elideMode = textElideMode(cache.id);
-    if (elideMode != Qt::ElideNone)
-    {
-        QString elidedText = painter->fontMetrics().elidedText(text, elideMode, rect.width());
-        if (showTooltip)
-            *showTooltip = (elidedText != text);
-
-        text = elidedText;
-    }
-    else
-    {
-        if (showTooltip)
-            *showTooltip = (painter->fontMetrics().width(text) > rect.width());
-    }
-
-    painter->drawText(rect, alignment(cache.id), text);
-
-    pState.restore(painter);
+    return linkColor;
 }
 
 ControllerMouseLink::ControllerMouseLink(ControllerMousePriority priority, bool processDblClick)
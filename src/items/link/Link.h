@@ -38,6 +38,7 @@ public:
 
 protected:
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    QPen textPenImpl(const QPainter* painter, const GuiContext& ctx, ID id) const override;
 
 private:
     PushableTracker m_pushableTracker;
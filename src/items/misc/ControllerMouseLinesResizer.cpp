@@ -34,12 +34,20 @@ ControllerMouseColumnsResizer::ControllerMouseColumnsResizer(SharedPtr<Lines> co
       m_position(0),
       m_trackPosition(0),
       m_columnIndex(InvalidIndex),
-      m_rubberBand(nullptr)
+      m_rubberBand(nullptr),
+      m_isLiveResize(false)
 {
 }
 
 bool ControllerMouseColumnsResizer::processMouseMove(QMouseEvent* event)
 {
+    if (m_isLiveResize && isCapturing())
+    {
+        // lines update sizes incrementally and cache keeps items of other columns
+        m_columns->setLineSize(m_columnIndex, columnSize(event->x()));
+        return true;
+    }
+
     if (m_rubberBand)
     {
         QRect rect = activationState().context.widget->rect();
@@ -55,11 +63,15 @@ bool ControllerMouseColumnsResizer::processMouseMove(QMouseEvent* event)
 
 bool ControllerMouseColumnsResizer::acceptImpl(const ActivationInfo& activationInfo) const
 {
-    m_delta = activationInfo.cache.cacheView.rect().right() - activationInfo.context.point.x();
-    if (abs(m_delta) <= ToleranseZone)
-        return true;
+    const QRect& viewRect = activationInfo.cache.cacheView.rect();
+    m_delta = viewRect.right() - activationInfo.context.point.x();
+    bool accepted = abs(m_delta) <= ToleranseZone;
 
-    return false;
+    // acceptance changes at tolerance zone bounds
+    QRect zone(QPoint(viewRect.right() - ToleranseZone, viewRect.top()), QPoint(viewRect.right() + ToleranseZone, viewRect.bottom()));
+    activationInfo.context.narrowActivationRect(zone, accepted);
+
+    return accepted;
 }
 
 void ControllerMouseColumnsResizer::activateImpl(const ActivationInfo& activationInfo)
@@ -87,6 +99,9 @@ void ControllerMouseColumnsResizer::startCapturingImpl()
 {
     ControllerMouseCaptured::startCapturingImpl();
 
+    if (m_isLiveResize)
+        return;
+
     Q_ASSERT(!m_rubberBand);
     auto widget = activationState().context.widget;
 
@@ -101,7 +116,7 @@ void ControllerMouseColumnsResizer::startCapturingImpl()
 
 void ControllerMouseColumnsResizer::stopCapturingImpl()
 {
-    Q_ASSERT(m_rubberBand);
+    Q_ASSERT(m_rubberBand || m_isLiveResize);
     delete m_rubberBand;
     m_rubberBand = nullptr;
 
@@ -113,8 +128,12 @@ void ControllerMouseColumnsResizer::applyImpl()
     Q_ASSERT(isActive());
     Q_ASSERT(m_columnIndex != InvalidIndex);
 
-    int size = qMax(MinLineSize, activationState().point().x() - m_position + m_delta);
-    m_columns->setLineSize(m_columnIndex, size);
+    m_columns->setLineSize(m_columnIndex, columnSize(activationState().point().x()));
+}
+
+int ControllerMouseColumnsResizer::columnSize(int x) const
+{
+    return qMax(MinLineSize, x - m_position + m_delta);
 }
 
 ControllerMouseRowsResizer::ControllerMouseRowsResizer(SharedPtr<Lines> rows, ControllerMousePriority priority)
@@ -35,6 +35,11 @@ class QI_EXPORT ControllerMouseColumnsResizer: public ControllerMouseCaptured
 public:
     ControllerMouseColumnsResizer(SharedPtr<Lines> columns, ControllerMousePriority priority = ControllerMousePriorityNormal);
 
+    // column is resized on each mouse move instead of showing rubber band,
+    // only cache items of the column and columns to the right are updated
+    bool isLiveResize() const { return m_isLiveResize; }
+    void setLiveResize(bool isLiveResize) { m_isLiveResize = isLiveResize; }
+
     bool processMouseMove(QMouseEvent* event) override;
 
 protected:
@@ -49,12 +54,15 @@ protected:
     bool canApplyImpl() const override { return true; }
 
 private:
+    int columnSize(int x) const;
+
     SharedPtr<Lines> m_columns;
     mutable int m_delta;
     int m_position;
     int m_trackPosition;
     int m_columnIndex;
     QRubberBand* m_rubberBand;
+    bool m_isLiveResize;
 };
 
 class QI_EXPORT ControllerMouseRowsResizer: public ControllerMouseCaptured
@@ -16,6 +16,7 @@
 
 #include "ViewAlternateBackground.h"
 #include "space/grid/GridID.h"
+#include <algorithm>
 
 namespace Qi
 {
@@ -32,4 +33,47 @@ void ViewAlternateBackground::drawImpl(QPainter* painter, const GuiContext& ctx,
     }
 }
 
+void ViewAlternateBackground::drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* /*visibleRect*/) const
+{
+    QVector<QRect> rects;
+    rects.reserve(items.size());
+    for (const auto& item : items)
+    {
+        if (row(item.id) % 2 == 0)
+            rects.append(item.cacheView->rect());
+    }
+
+    if (rects.isEmpty())
+        return;
+
+    std::sort(rects.begin(), rects.end(), [](const QRect& left, const QRect& right) {
+        if (left.top() != right.top())
+            return left.top() < right.top();
+        if (left.height() != right.height())
+            return left.height() < right.height();
+        return left.left() < right.left();
+    });
+
+    // merge touching rects of the same line
+    int spansCount = 0;
+    for (const auto& rect : rects)
+    {
+        if (spansCount > 0)
+        {
+            QRect& span = rects[spansCount - 1];
+            if (span.top() == rect.top() && span.height() == rect.height() && rect.left() <= span.right() + 1)
+            {
+                span.setRight(qMax(span.right(), rect.right()));
+                continue;
+            }
+        }
+
+        rects[spansCount++] = rect;
+    }
+
+    const QBrush& brush = ctx.palette().alternateBase();
+    for (int i = 0; i < spansCount; ++i)
+        painter->fillRect(rects[i], brush);
+}
+
 } // end namespace Qi
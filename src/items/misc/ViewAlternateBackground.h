@@ -32,6 +32,10 @@ public:
 
 protected:
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawBatchableImpl() const override { return true; }
+    bool isDrawThreadSafeImpl() const override { return true; }
+    // fills merged spans of adjacent items of each row
+    void drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* visibleRect) const override;
 };
 
 } // end namespace Qi
@@ -0,0 +1,169 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "ViewChangeFlash.h"
+#include <QPainter>
+
+namespace Qi
+{
+
+ViewChangeFlash::ViewChangeFlash(SharedPtr<Model> model, int capacity)
+    : m_model(std::move(model)),
+      m_color(255, 200, 0),
+      m_duration(1000),
+      m_head(0),
+      m_size(0)
+{
+    Q_ASSERT(m_model);
+    Q_ASSERT(capacity > 0);
+
+    m_ring.resize(capacity);
+    m_clock.start();
+
+    m_frameTimer.setInterval(16);
+    connect(&m_frameTimer, &QTimer::timeout, this, &ViewChangeFlash::onFrame);
+
+    connect(m_model.data(), &Model::modelItemChanged, this, &ViewChangeFlash::onModelItemChanged);
+    connect(m_model.data(), &Model::modelItemsChanged, this, &ViewChangeFlash::onModelItemsChanged);
+}
+
+ViewChangeFlash::~ViewChangeFlash()
+{
+    disconnect(m_model.data(), &Model::modelItemChanged, this, &ViewChangeFlash::onModelItemChanged);
+    disconnect(m_model.data(), &Model::modelItemsChanged, this, &ViewChangeFlash::onModelItemsChanged);
+}
+
+void ViewChangeFlash::setColor(QColor color)
+{
+    if (m_color == color)
+        return;
+
+    m_color = color;
+    emitViewChanged(ChangeReasonViewContent);
+}
+
+void ViewChangeFlash::setDuration(int duration)
+{
+    Q_ASSERT(duration > 0);
+    m_duration = duration;
+}
+
+void ViewChangeFlash::flash(ID id)
+{
+    qint64 now = m_clock.elapsed();
+
+    // the oldest change is overwritten if the ring is full
+    if (m_size == m_ring.size())
+    {
+        const Change& oldest = m_ring[m_head];
+        auto it = m_lastChange.find(oldest.id);
+        if (it != m_lastChange.end() && it.value() == oldest.time)
+            m_lastChange.erase(it);
+
+        m_head = (m_head + 1) % m_ring.size();
+        --m_size;
+    }
+
+    m_ring[(m_head + m_size) % m_ring.size()] = Change{id, now};
+    ++m_size;
+    m_lastChange[id] = now;
+
+    if (!m_frameTimer.isActive())
+        m_frameTimer.start();
+}
+
+void ViewChangeFlash::clear()
+{
+    if (m_size == 0)
+        return;
+
+    QVector<ID> ids;
+    ids.reserve(m_lastChange.size());
+    for (auto it = m_lastChange.constBegin(); it != m_lastChange.constEnd(); ++it)
+        ids.append(it.key());
+
+    m_head = 0;
+    m_size = 0;
+    m_lastChange.clear();
+    m_frameTimer.stop();
+
+    emitViewItemsChanged(ids);
+}
+
+void ViewChangeFlash::drawImpl(QPainter* painter, const GuiContext& /*ctx*/, const CacheContext& cache, bool* /*showTooltip*/) const
+{
+    auto it = m_lastChange.constFind(cache.id);
+    if (it == m_lastChange.constEnd())
+        return;
+
+    qint64 elapsed = m_clock.elapsed() - it.value();
+    if (elapsed >= m_duration)
+        return;
+
+    // linear fade out
+    QColor color = m_color;
+    color.setAlphaF(color.alphaF() * (1.0 - qreal(elapsed) / m_duration));
+    painter->fillRect(cache.cacheView.rect(), color);
+}
+
+void ViewChangeFlash::onModelItemChanged(const Model*, ID id)
+{
+    flash(id);
+}
+
+void ViewChangeFlash::onModelItemsChanged(const Model*, const QVector<ID>& ids)
+{
+    for (ID id : ids)
+        flash(id);
+}
+
+void ViewChangeFlash::onFrame()
+{
+    qint64 now = m_clock.elapsed();
+
+    // items faded out since the last frame are repainted once more to erase them
+    QVector<ID> ids;
+    ids.reserve(m_lastChange.size());
+    for (auto it = m_lastChange.constBegin(); it != m_lastChange.constEnd(); ++it)
+        ids.append(it.key());
+
+    dropExpired(now);
+    if (m_size == 0)
+        m_frameTimer.stop();
+
+    if (!ids.isEmpty())
+        emitViewItemsChanged(ids);
+}
+
+void ViewChangeFlash::dropExpired(qint64 now)
+{
+    while (m_size > 0)
+    {
+        const Change& oldest = m_ring[m_head];
+        if (now - oldest.time < m_duration)
+            break;
+
+        auto it = m_lastChange.find(oldest.id);
+        if (it != m_lastChange.end() && it.value() == oldest.time)
+            m_lastChange.erase(it);
+
+        m_head = (m_head + 1) % m_ring.size();
+        --m_size;
+    }
+}
+
+} // end namespace Qi
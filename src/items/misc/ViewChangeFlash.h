@@ -0,0 +1,92 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_VIEW_CHANGE_FLASH_H
+#define QI_VIEW_CHANGE_FLASH_H
+
+#include "core/View.h"
+#include "core/Model.h"
+#include <QColor>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+
+namespace Qi
+{
+
+// paints fading background over items recently changed in the model,
+// changes are taken from item notifications of the model only
+// recent changes are kept in a ring of bounded capacity,
+// each frame repaints only items which are still fading
+class QI_EXPORT ViewChangeFlash: public View
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ViewChangeFlash)
+
+public:
+    explicit ViewChangeFlash(SharedPtr<Model> model, int capacity = 4096);
+    ~ViewChangeFlash();
+
+    QColor color() const { return m_color; }
+    void setColor(QColor color);
+
+    // fading time in milliseconds
+    int duration() const { return m_duration; }
+    void setDuration(int duration);
+
+    // starts flash of the item now
+    void flash(ID id);
+    // stops all flashes
+    void clear();
+
+    int fadingCount() const { return m_size; }
+
+protected:
+    void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+
+private:
+    void onModelItemChanged(const Model*, ID id);
+    void onModelItemsChanged(const Model*, const QVector<ID>& ids);
+    void onFrame();
+
+    // drops not fading changes from the ring tail
+    void dropExpired(qint64 now);
+
+    struct Change
+    {
+        ID id;
+        qint64 time;
+    };
+
+    SharedPtr<Model> m_model;
+    QColor m_color;
+    int m_duration;
+
+    // changes in time order, m_head is the oldest
+    QVector<Change> m_ring;
+    int m_head;
+    int m_size;
+    // time of the last change of the item in the ring
+    QHash<ID, qint64> m_lastChange;
+
+    QElapsedTimer m_clock;
+    QTimer m_frameTimer;
+};
+
+} // end namespace Qi
+
+#endif // QI_VIEW_CHANGE_FLASH_H
@@ -26,9 +26,7 @@ static void validateGridColor(QColor& gridColor, const GuiContext& ctx)
 
     auto style = ctx.style();
 
-    QStyleOptionViewItem option;
-    ctx.initStyleOption(option);
-    option.widget = ctx.widget;
+    const QStyleOptionViewItem& option = ctx.viewItemOption();
 
     const int gridHint = style->styleHint(QStyle::SH_Table_GridLineColor, &option, ctx.widget);
     gridColor = static_cast<QRgb>(gridHint);
@@ -56,6 +54,24 @@ void ViewRowBorder::drawImpl(QPainter* painter, const GuiContext& ctx, const Cac
     painter->setPen(oldPen);
 }
 
+void ViewRowBorder::drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* /*visibleRect*/) const
+{
+    validateGridColor(m_gridColor, ctx);
+
+    QVector<QLine> lines;
+    lines.reserve(items.size());
+    for (const auto& item : items)
+    {
+        const QRect& rect = item.cacheView->rect();
+        lines.append(QLine(rect.right(), rect.bottom(), rect.left(), rect.bottom()));
+    }
+
+    QPen oldPen = painter->pen();
+    painter->setPen(m_gridColor);
+    painter->drawLines(lines);
+    painter->setPen(oldPen);
+}
+
 ViewColumnBorder::ViewColumnBorder()
 {
 }
@@ -78,6 +94,24 @@ void ViewColumnBorder::drawImpl(QPainter* painter, const GuiContext& ctx, const
     painter->setPen(oldPen);
 }
 
+void ViewColumnBorder::drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* /*visibleRect*/) const
+{
+    validateGridColor(m_gridColor, ctx);
+
+    QVector<QLine> lines;
+    lines.reserve(items.size());
+    for (const auto& item : items)
+    {
+        const QRect& rect = item.cacheView->rect();
+        lines.append(QLine(rect.right(), rect.top(), rect.right(), rect.bottom()));
+    }
+
+    QPen oldPen = painter->pen();
+    painter->setPen(m_gridColor);
+    painter->drawLines(lines);
+    painter->setPen(oldPen);
+}
+
 ViewRectBorder::ViewRectBorder()
 {
 }
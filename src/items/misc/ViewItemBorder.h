@@ -32,7 +32,12 @@ public:
 
 protected:
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
+    bool isSizeUniformImpl() const override { return true; }
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawBatchableImpl() const override { return true; }
+    // grid color is taken from style on first draw
+    bool isDrawThreadSafeImpl() const override { return m_gridColor.isValid(); }
+    void drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* visibleRect) const override;
 
 private:
     mutable QColor m_gridColor;
@@ -48,7 +53,12 @@ public:
 
 protected:
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
+    bool isSizeUniformImpl() const override { return true; }
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawBatchableImpl() const override { return true; }
+    // grid color is taken from style on first draw
+    bool isDrawThreadSafeImpl() const override { return m_gridColor.isValid(); }
+    void drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* visibleRect) const override;
 
 private:
     mutable QColor m_gridColor;
@@ -64,7 +74,9 @@ public:
 
 protected:
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
+    bool isSizeUniformImpl() const override { return true; }
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawThreadSafeImpl() const override { return m_gridColor.isValid(); }
 
 private:
     mutable QColor m_gridColor;
@@ -16,10 +16,180 @@
 
 #include "Numeric.h"
 #include "space/grid/GridID.h"
+#include <cmath>
 
 namespace Qi
 {
 
+namespace Private
+{
+
+static const double powersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                     1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+// writes digits of value backward from end, returns the first written char
+static char* writeDigits(qulonglong value, char* end)
+{
+    do
+    {
+        *--end = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    return end;
+}
+
+QString integerToText(qlonglong value)
+{
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    qulonglong absValue = (value < 0) ? (qulonglong(0) - qulonglong(value)) : qulonglong(value);
+    char* begin = writeDigits(absValue, end);
+    if (value < 0)
+        *--begin = '-';
+
+    return QString::fromLatin1(begin, int(end - begin));
+}
+
+QString integerToText(qulonglong value)
+{
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* begin = writeDigits(value, end);
+    return QString::fromLatin1(begin, int(end - begin));
+}
+
+QString fixedToText(double value, int decimals)
+{
+    // scaled value should be exactly representable by integer
+    if (decimals < 0 || decimals > 9 || !(std::fabs(value) < 1e15 / powersOf10[decimals]))
+        return QString::number(value, 'f', decimals);
+
+    qlonglong scaled = std::llround(value * powersOf10[decimals]);
+    bool isNegative = scaled < 0;
+    qulonglong absScaled = isNegative ? qulonglong(-scaled) : qulonglong(scaled);
+
+    char buffer[32];
+    char* end = buffer + sizeof(buffer);
+    char* begin = end;
+    for (int i = 0; i < decimals; ++i)
+    {
+        *--begin = char('0' + absScaled % 10);
+        absScaled /= 10;
+    }
+    if (decimals > 0)
+        *--begin = '.';
+    begin = writeDigits(absScaled, begin);
+    // keep sign of values rounded to zero like Qt does
+    if (isNegative || (scaled == 0 && std::signbit(value)))
+        *--begin = '-';
+
+    return QString::fromLatin1(begin, int(end - begin));
+}
+
+// parses [+-]digits with at most 18 digits
+static bool parseInteger(const QString& text, qulonglong& value, bool& isNegative)
+{
+    const QChar* it = text.constData();
+    const QChar* end = it + text.size();
+
+    isNegative = false;
+    if (it != end && (*it == QLatin1Char('-') || *it == QLatin1Char('+')))
+    {
+        isNegative = (*it == QLatin1Char('-'));
+        ++it;
+    }
+
+    if (it == end || end - it > 18)
+        return false;
+
+    qulonglong result = 0;
+    for (; it != end; ++it)
+    {
+        ushort digit = it->unicode() - '0';
+        if (digit > 9)
+            return false;
+        result = result * 10 + digit;
+    }
+
+    value = result;
+    return true;
+}
+
+bool textToInteger(const QString& text, qlonglong& value)
+{
+    qulonglong absValue;
+    bool isNegative;
+    if (!parseInteger(text, absValue, isNegative))
+        return false;
+
+    value = isNegative ? -qlonglong(absValue) : qlonglong(absValue);
+    return true;
+}
+
+bool textToInteger(const QString& text, qulonglong& value)
+{
+    qulonglong absValue;
+    bool isNegative;
+    if (!parseInteger(text, absValue, isNegative) || (isNegative && absValue != 0))
+        return false;
+
+    value = absValue;
+    return true;
+}
+
+bool textToDouble(const QString& text, double& value)
+{
+    const QChar* it = text.constData();
+    const QChar* end = it + text.size();
+
+    bool isNegative = false;
+    if (it != end && (*it == QLatin1Char('-') || *it == QLatin1Char('+')))
+    {
+        isNegative = (*it == QLatin1Char('-'));
+        ++it;
+    }
+
+    // mantissa up to 15 digits is exact in double and
+    // single division by exact power of 10 gives correctly rounded result
+    qulonglong mantissa = 0;
+    int digits = 0;
+    int fractionDigits = 0;
+    bool hasPoint = false;
+    bool hasDigits = false;
+    for (; it != end; ++it)
+    {
+        if (*it == QLatin1Char('.') && !hasPoint)
+        {
+            hasPoint = true;
+            continue;
+        }
+
+        ushort digit = it->unicode() - '0';
+        if (digit > 9)
+            return false;
+
+        hasDigits = true;
+        if (mantissa != 0 || digit != 0)
+            ++digits;
+        if (digits > 15)
+            return false;
+
+        mantissa = mantissa * 10 + digit;
+        if (hasPoint)
+            ++fractionDigits;
+    }
+
+    if (!hasDigits || fractionDigits > 22)
+        return false;
+
+    double result = double(mantissa) / powersOf10[fractionDigits];
+    value = isNegative ? -result : result;
+    return true;
+}
+
+} // end namespace Private
+
 ModelRowNumber::ModelRowNumber(bool ascendingDefault)
 {
     m_ascendingDefault = ascendingDefault;
@@ -18,31 +18,109 @@
 #define QI_NUMERIC_H
 
 #include "core/ext/ModelTyped.h"
+#include "core/ext/ModelValuesCache.h"
+#include <QLocale>
 #include <limits>
+#include <type_traits>
 
 namespace Qi
 {
 
 namespace Private
 {
-    template<typename T> QString numericToText(const T& value)
+    // fast C locale conversions without intermediate allocations,
+    // text functions return false if text is not a plain number and Qt conversion should be used
+    QI_EXPORT QString integerToText(qlonglong value);
+    QI_EXPORT QString integerToText(qulonglong value);
+    // decimals digits after the point
+    QI_EXPORT QString fixedToText(double value, int decimals);
+    QI_EXPORT bool textToInteger(const QString& text, qlonglong& value);
+    QI_EXPORT bool textToInteger(const QString& text, qulonglong& value);
+    QI_EXPORT bool textToDouble(const QString& text, double& value);
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, QString>::type numericToText(const T& value)
+    {
+        return integerToText(qlonglong(value));
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, QString>::type numericToText(const T& value)
+    {
+        return integerToText(qulonglong(value));
+    }
+
+    template <typename T>
+    typename std::enable_if<!std::is_integral<T>::value, QString>::type numericToText(const T& value)
     {
         QString text;
         text.setNum(value);
         return text;
     }
 
+    template <typename T>
+    bool textToIntegerChecked(const QString& text, T& value)
+    {
+        typedef typename std::conditional<std::is_signed<T>::value, qlonglong, qulonglong>::type Integer_t;
+        Integer_t result;
+        if (!textToInteger(text, result) || result < Integer_t(std::numeric_limits<T>::min()) || result > Integer_t(std::numeric_limits<T>::max()))
+            return false;
+
+        value = T(result);
+        return true;
+    }
+
     template <typename T> T textToNumeric(const QString& text);
-    template<> inline short textToNumeric<short>(const QString& text) { return text.toShort(); }
-    template<> inline ushort textToNumeric<ushort>(const QString& text) { return text.toUShort(); }
-    template<> inline int textToNumeric<int>(const QString& text) { return text.toInt(); }
-    template<> inline uint textToNumeric<uint>(const QString& text) { return text.toUInt(); }
-    template<> inline long textToNumeric<long>(const QString& text) { return text.toLong(); }
-    template<> inline ulong textToNumeric<ulong>(const QString& text) { return text.toULong(); }
-    template<> inline qlonglong textToNumeric<qlonglong>(const QString& text) { return text.toLongLong(); }
-    template<> inline qulonglong textToNumeric<qulonglong>(const QString& text) { return text.toULongLong(); }
-    template<> inline float textToNumeric<float>(const QString& text) { return text.toFloat(); }
-    template<> inline double textToNumeric<double>(const QString& text) { return text.toDouble(); }
+    template<> inline short textToNumeric<short>(const QString& text) { short value; return textToIntegerChecked(text, value) ? value : text.toShort(); }
+    template<> inline ushort textToNumeric<ushort>(const QString& text) { ushort value; return textToIntegerChecked(text, value) ? value : text.toUShort(); }
+    template<> inline int textToNumeric<int>(const QString& text) { int value; return textToIntegerChecked(text, value) ? value : text.toInt(); }
+    template<> inline uint textToNumeric<uint>(const QString& text) { uint value; return textToIntegerChecked(text, value) ? value : text.toUInt(); }
+    template<> inline long textToNumeric<long>(const QString& text) { long value; return textToIntegerChecked(text, value) ? value : text.toLong(); }
+    template<> inline ulong textToNumeric<ulong>(const QString& text) { ulong value; return textToIntegerChecked(text, value) ? value : text.toULong(); }
+    template<> inline qlonglong textToNumeric<qlonglong>(const QString& text) { qlonglong value; return textToInteger(text, value) ? value : text.toLongLong(); }
+    template<> inline qulonglong textToNumeric<qulonglong>(const QString& text) { qulonglong value; return textToInteger(text, value) ? value : text.toULongLong(); }
+    template<> inline float textToNumeric<float>(const QString& text) { double value; return textToDouble(text, value) ? float(value) : text.toFloat(); }
+    template<> inline double textToNumeric<double>(const QString& text) { double value; return textToDouble(text, value) ? value : text.toDouble(); }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, QString>::type localeNumericToText(const T& value)
+    {
+        return QLocale().toString(qlonglong(value));
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, QString>::type localeNumericToText(const T& value)
+    {
+        return QLocale().toString(qulonglong(value));
+    }
+
+    template <typename T>
+    typename std::enable_if<!std::is_integral<T>::value, QString>::type localeNumericToText(const T& value)
+    {
+        return QLocale().toString(double(value));
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, T>::type localeTextToNumeric(const QString& text)
+    {
+        bool ok = false;
+        qlonglong value = QLocale().toLongLong(text, &ok);
+        return (ok && value >= qlonglong(std::numeric_limits<T>::min()) && value <= qlonglong(std::numeric_limits<T>::max())) ? T(value) : T(0);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, T>::type localeTextToNumeric(const QString& text)
+    {
+        bool ok = false;
+        qulonglong value = QLocale().toULongLong(text, &ok);
+        return (ok && value <= qulonglong(std::numeric_limits<T>::max())) ? T(value) : T(0);
+    }
+
+    template <typename T>
+    typename std::enable_if<!std::is_integral<T>::value, T>::type localeTextToNumeric(const QString& text)
+    {
+        return T(QLocale().toDouble(text));
+    }
 }
 
 // If you need more customized text representation - use ModelCallback or ModelConversion classes
@@ -58,6 +136,44 @@ public:
         static_assert(std::numeric_limits<NumericType>::is_specialized, "NumericType should be numeric.");
         Q_ASSERT(m_modelNumeric);
         m_ascendingDefault = ascendingDefault;
+
+        m_cache.connectSource(m_modelNumeric.data(), this, [this](ID id) { notifyItemChanged(id); }, [this]() { notifyChanged(); });
+    }
+
+    // keeps texts of numeric values until numeric model changes them
+    bool isCaching() const { return m_cache.isEnabled(); }
+    void setCaching(bool isCaching) { m_cache.setEnabled(isCaching); }
+
+    // floating values are formatted by 'g' with 6 significant digits by default
+    enum FloatFormat
+    {
+        FloatFormatDefault,
+        // shortest text which reads back to the same value
+        FloatFormatShortest,
+        // fixed count of decimals
+        FloatFormatFixed
+    };
+
+    FloatFormat floatFormat() const { return m_floatFormat; }
+    int decimals() const { return m_decimals; }
+    void setFloatFormat(FloatFormat floatFormat, int decimals = 2)
+    {
+        m_floatFormat = floatFormat;
+        m_decimals = decimals;
+        m_cache.clear();
+        notifyChanged();
+    }
+
+    // texts are formatted and parsed by default QLocale instead of C locale
+    bool isLocaleAware() const { return m_isLocaleAware; }
+    void setLocaleAware(bool isLocaleAware)
+    {
+        if (m_isLocaleAware == isLocaleAware)
+            return;
+
+        m_isLocaleAware = isLocaleAware;
+        m_cache.clear();
+        notifyChanged();
     }
 
 protected:
@@ -67,23 +183,65 @@ protected:
         return Private::compareValues(m_modelNumeric->value(left), m_modelNumeric->value(right));
     }
 
+    SharedPtr<ModelSortKeys> sortKeysImpl(const QVector<int>& lines, const std::function<ID(int)>& lineToId) const override
+    {
+        // sort by numeric values
+        return m_modelNumeric->sortKeys(lines, lineToId);
+    }
+
     ValueType_t valueImpl(ID id) const override
     {
-        return Private::numericToText<NumericType>(m_modelNumeric->value(id));
+        return m_cache.value(id, [this](ID itemId) {
+            return toText(m_modelNumeric->value(itemId));
+        });
     }
 
     bool setValueImpl(ID id, ValueType_t value) override
     {
-        return m_modelNumeric->setValue(id, Private::textToNumeric<NumericType>(value));
+        return m_modelNumeric->setValue(id, toNumeric(value));
     }
 
     bool setValueMultipleImpl(IdIterator& itemsIterator, ValueType_t value) override
     {
-        return m_modelNumeric->setValueMultiple(itemsIterator, Private::textToNumeric<NumericType>(value));
+        return m_modelNumeric->setValueMultiple(itemsIterator, toNumeric(value));
     }
 
 private:
+    QString toText(NumericType value) const
+    {
+        if (!std::is_integral<NumericType>::value)
+        {
+            int precision = (m_floatFormat == FloatFormatShortest) ? int(QLocale::FloatingPointShortest) : m_decimals;
+            switch (m_floatFormat)
+            {
+            case FloatFormatShortest:
+                return m_isLocaleAware ? QLocale().toString(double(value), 'g', precision) : QString::number(double(value), 'g', precision);
+            case FloatFormatFixed:
+                return m_isLocaleAware ? QLocale().toString(double(value), 'f', precision) : Private::fixedToText(double(value), precision);
+            default:
+                break;
+            }
+        }
+
+        if (m_isLocaleAware)
+            return Private::localeNumericToText<NumericType>(value);
+
+        return Private::numericToText<NumericType>(value);
+    }
+
+    NumericType toNumeric(const QString& text) const
+    {
+        if (m_isLocaleAware)
+            return Private::localeTextToNumeric<NumericType>(text);
+
+        return Private::textToNumeric<NumericType>(text);
+    }
+
     SharedPtr<ModelTyped<NumericType>> m_modelNumeric;
+    ModelValuesCache<QString> m_cache;
+    FloatFormat m_floatFormat = FloatFormatDefault;
+    int m_decimals = 2;
+    bool m_isLocaleAware = false;
 };
 
 class QI_EXPORT ModelRowNumber: public ModelTyped<int>
@@ -15,6 +15,8 @@
 */
 
 #include "Progress.h"
+#include "utils/StylePixmapCache.h"
+#include "utils/AnimationClock.h"
 #include <QStyleOptionProgressBar>
 
 namespace Qi
@@ -60,8 +62,8 @@ void ViewProgressContents::drawImpl(QPainter* painter, const GuiContext& ctx, co
     option.rect = cache.cacheView.rect();
     option.rect.adjust(2, 2, -2, -2);
 
-    // draw progress
-    style->drawControl(QStyle::CE_ProgressBarContents, &option, painter, ctx.widget);
+    // draw progress, bars are cached per percent and size
+    drawStyleControlCached(style, QStyle::CE_ProgressBarContents, option, painter, ctx.widget, QString::number(option.progress));
 }
 
 ViewProgressLabel::ViewProgressLabel(SharedPtr<ModelProgress> model, ProgressLabelMode mode)
@@ -117,7 +119,7 @@ void ViewProgressLabel::drawImpl(QPainter* painter, const GuiContext& ctx, const
     option.rect.adjust(2, 2, -2, -2);
 
     // draw progress
-    style->drawControl(QStyle::CE_ProgressBarLabel, &option, painter, ctx.widget);
+    drawStyleControlCached(style, QStyle::CE_ProgressBarLabel, option, painter, ctx.widget, QString("%1_%2").arg(option.progress).arg(option.text));
 }
 
 ViewProgressBox::ViewProgressBox(SharedPtr<ModelProgress> model)
@@ -161,4 +163,46 @@ void ViewProgressBox::drawImpl(QPainter* painter, const GuiContext& /*ctx*/, con
     }
 }
 
+ViewProgressBusy::ViewProgressBusy()
+    : period(2000)
+{
+    contentsColor = Qt::magenta;
+    boundsColor = contentsColor.darker();
+}
+
+void ViewProgressBusy::drawImpl(QPainter* painter, const GuiContext& /*ctx*/, const CacheContext& cache, bool* /*showTooltip*/) const
+{
+    if (isBusy && !isBusy(cache.id))
+        return;
+
+    Q_ASSERT(period > 0);
+
+    auto& clock = AnimationClock::instance();
+    // repaint on the next frame while item is visible
+    clock.addFrameItem(this, cache.id);
+
+    QRect rect = cache.cacheView.rect();
+    rect.adjust(0, 2, 0, -2);
+
+    int chunkWidth = qMax(4, rect.width() / 4);
+    int runWidth = rect.width() - chunkWidth;
+    if (runWidth <= 0 || rect.height() <= 0)
+        return;
+
+    // phase in [0, 2), second half runs back
+    qreal phase = qreal(clock.time() % period) * 2 / period;
+    qreal pos = phase < 1 ? phase : 2 - phase;
+
+    QRect chunk(rect.left() + int(pos * runWidth), rect.top(), chunkWidth, rect.height());
+
+    PainterState state;
+    state.save(painter);
+
+    painter->fillRect(chunk, boundsColor);
+    chunk.adjust(1, 1, -1, -1);
+    painter->fillRect(chunk, contentsColor);
+
+    state.restore(painter);
+}
+
 } // end namespace Qi
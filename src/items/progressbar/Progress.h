@@ -47,6 +47,7 @@ public:
 
 protected:
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawnInDraftImpl() const override { return false; }
 };
 
 enum ProgressLabelMode
@@ -84,6 +85,30 @@ public:
 
 protected:
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawnInDraftImpl() const override { return false; }
+};
+
+// indeterminate progress, chunk runs back and forth within the view
+// visible items are repainted by shared AnimationClock
+class QI_EXPORT ViewProgressBusy: public View
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ViewProgressBusy)
+
+public:
+    ViewProgressBusy();
+
+    QColor contentsColor;
+    QColor boundsColor;
+    // milliseconds of one chunk run from left to right and back
+    int period;
+
+    // item is drawn unless it returns false
+    std::function<bool(ID id)> isBusy;
+
+protected:
+    void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawnInDraftImpl() const override { return false; }
 };
 
 } // end namespace Qi
@@ -16,6 +16,7 @@
 
 #include "Radio.h"
 #include "items/misc/ControllerMousePushableCallback.h"
+#include "utils/StylePixmapCache.h"
 #include <QStyleOptionButton>
 
 namespace Qi
@@ -43,7 +44,7 @@ bool ModelRadioCallback::setRadioItemImpl(ID id)
 
     if (setRadioItem(id))
     {
-        emit modelChanged(this);
+        notifyChanged();
         return true;
     }
 
@@ -66,7 +67,7 @@ bool ModelRadioStorage::setRadioItemImpl(ID id)
         return false;
 
     m_radioId = id;
-    emit modelChanged(this);
+    notifyChanged();
 
     return true;
 }
@@ -106,7 +107,7 @@ void ViewRadio::drawImpl(QPainter* painter, const GuiContext& ctx, const CacheCo
     option.rect = style->subElementRect(QStyle::SE_RadioButtonIndicator, &option, ctx.widget);
 
     // draw radio button image
-    style->drawPrimitive(QStyle::PE_IndicatorRadioButton, &option, painter, ctx.widget);
+    drawStylePrimitiveCached(style, QStyle::PE_IndicatorRadioButton, option, painter, ctx.widget);
 }
 
 QStyle::State ViewRadio::styleState(ID id) const
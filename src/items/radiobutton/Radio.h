@@ -39,6 +39,8 @@ protected:
 
     int compareImpl(ID left, ID right) const override;
     bool isAscendingDefaultImpl(ID /*id*/) const override { return false; }
+    int ordinalKeysCountImpl() const override { return 2; }
+    int ordinalKeyImpl(ID id) const override { return isRadioItem(id) ? 1 : 0; }
 
     virtual bool isRadioItemImpl(ID id) const = 0;
     virtual bool setRadioItemImpl(ID id) = 0;
@@ -88,7 +90,9 @@ public:
 
 protected:
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
+    bool isSizeUniformImpl() const override { return true; }
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawnInDraftImpl() const override { return false; }
 
 private:
     QStyle::State styleState(ID id) const;
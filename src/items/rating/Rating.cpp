@@ -16,6 +16,8 @@
 
 #include "Rating.h"
 #include "items/misc/ControllerMousePushableCallback.h"
+#include "items/image/ScaledPixmapCache.h"
+#include <QPainter>
 
 namespace Qi
 {
@@ -37,7 +39,7 @@ protected:
         Q_ASSERT(!m_viewRating.isNull());
 
         const ActivationState& state = activationState();
-        int rate = (state.context.point.x() - state.viewRect.left()) / (m_viewRating->rateImageOn().width() + imageGap) + 1;
+        int rate = (state.context.point.x() - state.viewRect.left()) / (m_viewRating->rateImageSize().width() + imageGap) + 1;
         if (rate < 0)
             rate = 0;
         else if (rate > m_viewRating->maxRate())
@@ -54,42 +56,86 @@ ViewRating::ViewRating(SharedPtr<ModelRating> model, const QPixmap& rateImageOn,
     : ViewModeled<ModelRating>(std::move(model)),
       m_rateImageOn(rateImageOn),
       m_rateImageOff(rateImageOff),
-      m_maxRate(maxRate)
+      m_maxRate(maxRate),
+      m_rateStripsPixelRatio(0.)
 {
     Q_ASSERT(m_rateImageOn.size() == m_rateImageOff.size());
     Q_ASSERT(m_maxRate > 0);
 
     if (useDefaultController)
     {
-        setController(makeShared<ControllerMouseRating>(this));
+        setControllerLazy([this]() { return makeShared<ControllerMouseRating>(this); });
     }
 }
 
+QSize ViewRating::rateImageSize() const
+{
+    return ScaledPixmapCache::logicalSize(m_rateImageOn);
+}
+
 QSize ViewRating::sizeImpl(const GuiContext& /*ctx*/, ID /*id*/, ViewSizeMode /*sizeMode*/) const
 {
-    return QSize((m_rateImageOn.width()+imageGap)*m_maxRate, m_rateImageOn.size().height());
+    QSize imageSize = rateImageSize();
+    return QSize((imageSize.width() + imageGap) * m_maxRate, imageSize.height());
 }
 
 void ViewRating::drawImpl(QPainter* painter, const GuiContext& /*ctx*/, const CacheContext& cache, bool* /*showTooltip*/) const
 {
-    int rating = theModel()->value(cache.id);
+    int rating = qBound(0, theModel()->value(cache.id), m_maxRate);
+    const QPixmap& strip = rateStrip(rating, painter->device()->devicePixelRatioF());
 
-    int rateImageWidth = m_rateImageOn.width() + imageGap;
-    QPoint starPoint(cache.cacheView.rect().topLeft());
+    QRect viewRect = cache.cacheView.rect();
+    if (viewRect.contains(QRect(viewRect.topLeft(), strip.size() / strip.devicePixelRatio())))
+    {
+        painter->drawPixmap(viewRect.topLeft(), strip);
+        return;
+    }
 
     painter->save();
-    painter->setClipRect(cache.cacheView.rect(), Qt::IntersectClip);
+    painter->setClipRect(viewRect, Qt::IntersectClip);
+    painter->drawPixmap(viewRect.topLeft(), strip);
+    painter->restore();
+}
+
+const QPixmap& ViewRating::rateStrip(int rating, qreal pixelRatio) const
+{
+    // strips are composed again for another screen
+    if (m_rateStripsPixelRatio != pixelRatio)
+    {
+        m_rateStrips.clear();
+        m_rateStripsPixelRatio = pixelRatio;
+    }
+
+    if (m_rateStrips.isEmpty())
+        m_rateStrips.resize(m_maxRate + 1);
+
+    QPixmap& strip = m_rateStrips[rating];
+    if (!strip.isNull())
+        return strip;
+
+    QSize imageSize = rateImageSize();
+    QSize stripSize((imageSize.width() + imageGap) * m_maxRate, imageSize.height());
 
+    strip = QPixmap(stripSize * pixelRatio);
+    strip.setDevicePixelRatio(pixelRatio);
+    strip.fill(Qt::transparent);
+
+    // images of the strip ratio are drawn without scaling
+    auto& pixmapCache = ScaledPixmapCache::shared();
+    QPixmap rateImageOn = pixmapCache.forPixelRatio(m_rateImageOn, pixelRatio);
+    QPixmap rateImageOff = pixmapCache.forPixelRatio(m_rateImageOff, pixelRatio);
+
+    int rateImageWidth = imageSize.width() + imageGap;
+    QPoint starPoint(0, 0);
+
+    QPainter painter(&strip);
     for (int i = 0; i < m_maxRate; ++i)
     {
-        if (i < rating)
-            painter->drawPixmap(starPoint, m_rateImageOn);
-        else
-            painter->drawPixmap(starPoint, m_rateImageOff);
-       starPoint.rx() += rateImageWidth;
+        painter.drawPixmap(starPoint, i < rating ? rateImageOn : rateImageOff);
+        starPoint.rx() += rateImageWidth;
     }
 
-    painter->restore();
+    return strip;
 }
 
 } // end namespace Qi
@@ -20,6 +20,7 @@
 #include "core/ext/ViewModeled.h"
 #include "core/ext/ModelCallback.h"
 #include <QPixmap>
+#include <QVector>
 
 namespace Qi
 {
@@ -38,15 +39,25 @@ public:
     QPixmap rateImageOn() const { return m_rateImageOn; }
     QPixmap rateImageOff() const { return m_rateImageOff; }
     int maxRate() const { return m_maxRate; }
+    // size of rate image in device independent pixels
+    QSize rateImageSize() const;
 
 protected:
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
+    bool isSizeUniformImpl() const override { return true; }
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawnInDraftImpl() const override { return false; }
 
 private:
+    // pixmap with all rate images for rating in device pixel ratio
+    const QPixmap& rateStrip(int rating, qreal pixelRatio) const;
+
     QPixmap m_rateImageOn;
     QPixmap m_rateImageOff;
     int m_maxRate;
+    // lazily composed strips for ratings in [0, maxRate]
+    mutable QVector<QPixmap> m_rateStrips;
+    mutable qreal m_rateStripsPixelRatio;
 };
 
 } // end namespace Qi
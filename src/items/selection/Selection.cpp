@@ -18,14 +18,22 @@
 #include "space/grid/CacheSpaceGrid.h"
 #include "space/grid/RangeGrid.h"
 #include "widgets/core/SpaceWidgetCore.h"
+#include "utils/CallLater.h"
+#include "utils/AnimationClock.h"
 #include <QStyleOptionViewItem>
 
 namespace Qi
 {
 
 ModelSelection::ModelSelection(SharedPtr<SpaceGrid> space)
-    : m_space(std::move(space)),
-      m_selectionOperations(0)
+    : m_isSelectionSpans(true),
+      m_space(std::move(space)),
+      m_selectionOperations(0),
+      m_coalesceChanges(false),
+      m_pendingChangeReason(0),
+      m_isPendingSpans(false),
+      m_selectionVersion(0),
+      m_selectedCountsVersion(quint64(-1))
 {
     Q_ASSERT(m_space);
 }
@@ -52,26 +60,36 @@ bool ModelSelection::isVisibleItemSelected(GridID visibleId) const
 
 void ModelSelection::addSelection(SharedPtr<Range> range, bool exclude)
 {
-    m_selection.addRange(std::move(range), exclude);
+    prepareChangedSignals();
+    addSelectionImpl(std::move(range), exclude);
     emitChangedSignals(ChangeReasonSelection);
 }
 
 void ModelSelection::setSelection(SharedPtr<Range> range)
 {
-    m_selection.clear();
-    m_selection.addRange(std::move(range), false);
+    prepareChangedSignals();
+    clearSelectionImpl();
+    addSelectionImpl(std::move(range), false);
     emitChangedSignals(ChangeReasonSelection);
 }
 
 void ModelSelection::clearSelection()
 {
-    m_selection.clear();
+    prepareChangedSignals();
+    clearSelectionImpl();
     emitChangedSignals(ChangeReasonSelection);
 }
 
 void ModelSelection::applySelection(const RangeSelection& selection)
 {
-    m_selection = selection;
+    prepareChangedSignals();
+
+    // selection may refer to m_selection
+    auto ranges = selection.ranges();
+    clearSelectionImpl();
+    for (const auto& info : ranges)
+        addSelectionImpl(info.range, info.exclude);
+
     emitChangedSignals(ChangeReasonSelection);
 }
 
@@ -84,6 +102,7 @@ void ModelSelection::setActiveId(GridID id)
 {
     if (m_activeId != id)
     {
+        prepareChangedSignals();
         m_activeId = id;
         emitChangedSignals(ChangeReasonActiveItem);
     }
@@ -119,23 +138,265 @@ void ModelSelection::stopSelectionOperation()
     }
 }
 
+bool ModelSelection::hasSelectionItem(GridID id) const
+{
+    if (m_isSelectionSpans)
+        return m_selectionSpans.hasItem(id);
+
+    return m_selection.hasItem(ID(id));
+}
+
+void ModelSelection::addSelectionImpl(SharedPtr<Range> range, bool exclude)
+{
+    if (m_isSelectionSpans)
+        m_isSelectionSpans = m_selectionSpans.addRange(*range, exclude);
+
+    m_selection.addRange(std::move(range), exclude);
+}
+
+void ModelSelection::clearSelectionImpl()
+{
+    m_selectionSpans.clear();
+    m_isSelectionSpans = true;
+
+    m_selection.clear();
+}
+
 int ModelSelection::compareImpl(ID left, ID right) const
 {
     return (int)isItemSelected(left.as<GridID>()) - (int)isItemSelected(right.as<GridID>());
 }
 
+void ModelSelection::setCoalesceChanges(bool coalesceChanges)
+{
+    if (m_coalesceChanges == coalesceChanges)
+        return;
+
+    m_coalesceChanges = coalesceChanges;
+    if (!m_coalesceChanges)
+        flushChangedSignals();
+}
+
+void ModelSelection::prepareChangedSignals()
+{
+    // remember state before the first pending change
+    if (m_pendingChangeReason != 0)
+        return;
+
+    auto spans = selectionSpans();
+    m_isPendingSpans = (spans != nullptr);
+    if (m_isPendingSpans)
+        m_pendingSpans = *spans;
+    m_pendingActiveId = m_activeId;
+}
+
 void ModelSelection::emitChangedSignals(ChangeReason changeReason)
 {
-    emit modelChanged(this);
+    bool isScheduled = (m_pendingChangeReason != 0);
+    m_pendingChangeReason |= changeReason;
+    if (changeReason & ChangeReasonSelection)
+        ++m_selectionVersion;
+
+    if (!m_coalesceChanges)
+        flushChangedSignals();
+    else if (!isScheduled)
+        callLater(this, [this]() { flushChangedSignals(); });
+}
+
+void ModelSelection::flushChangedSignals()
+{
+    if (m_pendingChangeReason == 0)
+        return;
+
+    auto changeReason = (ChangeReason)m_pendingChangeReason;
+    auto absRegion = changedRegion(changeReason);
+    m_pendingChangeReason = 0;
+    m_pendingSpans.clear();
+
+    notifyRegionChanged(absRegion);
 
     startSelectionOperation();
     emit selectionChanged(this, changeReason);
+    if (!absRegion.isEmpty())
+        emit selectionRegionChanged(this, absRegion);
     stopSelectionOperation();
 }
 
+QRect ModelSelection::changedRegion(ChangeReason changeReason) const
+{
+    if (!m_space)
+        return QRect();
+
+    const auto& grid = *m_space.data();
+    QRect bounds(0, 0, grid.columns()->count(), grid.rows()->count());
+
+    auto spans = selectionSpans();
+    if (!m_isPendingSpans || !spans)
+        return bounds;
+
+    QRect region;
+    if (changeReason & ChangeReasonSelection)
+        region = SelectionSpans::differenceBounds(m_pendingSpans, *spans, bounds);
+
+    if (m_pendingActiveId != m_activeId)
+    {
+        for (auto id : {m_pendingActiveId, m_activeId})
+        {
+            if (id.isValid() && bounds.contains(id.column, id.row))
+                region |= QRect(id.column, id.row, 1, 1);
+        }
+    }
+
+    return region;
+}
+
+void ModelSelection::notifyRegionChanged(const QRect& absRegion)
+{
+    // larger regions repaint views entirely
+    const qint64 maxRegionItems = 4096;
+    if (absRegion.isEmpty() || qint64(absRegion.width()) * absRegion.height() > maxRegionItems)
+    {
+        notifyChanged();
+        return;
+    }
+
+    ModelUpdateGuard guard(*this);
+    for (int row = absRegion.top(); row <= absRegion.bottom(); ++row)
+        for (int column = absRegion.left(); column <= absRegion.right(); ++column)
+            notifyItemChanged(ID(GridID(row, column)));
+}
+
+int ModelSelection::rowSelectedCount(int row) const
+{
+    if (!m_space || row < 0 || row >= m_space.data()->rows()->count())
+        return 0;
+
+    if (validateSelectedCounts())
+        return m_rowSelectedCounts.at(row);
+
+    int count = 0;
+    for (int column = 0, n = m_space.data()->columns()->count(); column < n; ++column)
+        count += isItemSelected(GridID(row, column)) ? 1 : 0;
+    return count;
+}
+
+int ModelSelection::columnSelectedCount(int column) const
+{
+    if (!m_space || column < 0 || column >= m_space.data()->columns()->count())
+        return 0;
+
+    if (validateSelectedCounts())
+        return m_columnSelectedCounts.at(column);
+
+    int count = 0;
+    for (int row = 0, n = m_space.data()->rows()->count(); row < n; ++row)
+        count += isItemSelected(GridID(row, column)) ? 1 : 0;
+    return count;
+}
+
+bool ModelSelection::isRowSelectedAll(int row) const
+{
+    int count = rowSelectedCount(row);
+    return count > 0 && count == m_space.data()->columns()->count();
+}
+
+bool ModelSelection::isColumnSelectedAll(int column) const
+{
+    int count = columnSelectedCount(column);
+    return count > 0 && count == m_space.data()->rows()->count();
+}
+
+bool ModelSelection::validateSelectedCounts() const
+{
+    auto spans = selectionSpans();
+    if (!spans)
+        return false;
+
+    if (m_selectedCountsVersion == m_selectionVersion)
+        return true;
+
+    const auto& grid = *m_space.data();
+    QRect bounds(0, 0, grid.columns()->count(), grid.rows()->count());
+
+    if (m_rowSelectedCounts.size() != bounds.height() || m_columnSelectedCounts.size() != bounds.width())
+    {
+        // lines were added or removed
+        m_rowSelectedCounts.fill(0, bounds.height());
+        m_columnSelectedCounts.fill(0, bounds.width());
+        updateSelectedCounts(*spans, bounds);
+    }
+    else
+    {
+        // only lines with changed items are counted again
+        updateSelectedCounts(*spans, SelectionSpans::differenceBounds(m_selectedCountsSpans, *spans, bounds));
+    }
+
+    m_selectedCountsSpans = *spans;
+    m_selectedCountsVersion = m_selectionVersion;
+    return true;
+}
+
+void ModelSelection::updateSelectedCounts(const SelectionSpans& spans, const QRect& absRegion) const
+{
+    if (absRegion.isEmpty())
+        return;
+
+    const int rowsCount = m_rowSelectedCounts.size();
+    const int columnsCount = m_columnSelectedCounts.size();
+    const int rowStart = qMax(absRegion.top(), 0);
+    const int rowEnd = qMin(absRegion.bottom(), rowsCount - 1);
+    const int columnStart = qMax(absRegion.left(), 0);
+    const int columnEnd = qMin(absRegion.right(), columnsCount - 1);
+
+    // columns get rows of bands selecting them through differences array
+    QVector<int> columnDeltas(columnsCount + 1, 0);
+
+    const auto& bands = spans.bands();
+    for (int band = 0, n = bands.size(); band < n; ++band)
+    {
+        int firstRow = qMax(bands[band].firstRow, 0);
+        int lastRow = qMin(spans.bandLastRow(band), rowsCount - 1);
+        if (firstRow > lastRow)
+            continue;
+
+        int bandCount = 0;
+        for (const auto& span : bands[band].columns)
+        {
+            int first = qMax(span.first, 0);
+            int last = qMin(span.last, columnsCount - 1);
+            if (first > last)
+                continue;
+
+            bandCount += last - first + 1;
+            columnDeltas[first] += lastRow - firstRow + 1;
+            columnDeltas[last + 1] -= lastRow - firstRow + 1;
+        }
+
+        // rows of band have the same count
+        for (int row = qMax(firstRow, rowStart), end = qMin(lastRow, rowEnd); row <= end; ++row)
+            m_rowSelectedCounts[row] = bandCount;
+    }
+
+    // rows without bands have nothing selected
+    if (bands.isEmpty() || bands.front().firstRow > rowStart)
+    {
+        int end = bands.isEmpty() ? rowEnd : qMin(rowEnd, bands.front().firstRow - 1);
+        for (int row = rowStart; row <= end; ++row)
+            m_rowSelectedCounts[row] = 0;
+    }
+
+    int count = 0;
+    for (int column = 0; column <= columnEnd; ++column)
+    {
+        count += columnDeltas[column];
+        if (column >= columnStart)
+            m_columnSelectedCounts[column] = count;
+    }
+}
+
 bool ModelSelectionRows::isRowSelected(int row) const
 {
-    return m_selection.hasItem(makeID<GridID>(row, InvalidIndex));
+    return hasSelectionItem(GridID(row, InvalidIndex));
 }
 
 void ModelSelectionRows::selectRows(const QSet<int>& rows)
@@ -143,6 +404,97 @@ void ModelSelectionRows::selectRows(const QSet<int>& rows)
     setSelection(makeShared<RangeGridRows>(rows));
 }
 
+void ModelSelectionRowsBitmap::selectRows(int rowBegin, int rowEnd, bool select)
+{
+    prepareChangedSignals();
+    m_rows.setValues(rowBegin, rowEnd, select);
+    updateSelection();
+    emitChangedSignals(ChangeReasonSelection);
+}
+
+void ModelSelectionRowsBitmap::selectAll()
+{
+    prepareChangedSignals();
+    m_rows.fill(true);
+    updateSelection();
+    emitChangedSignals(ChangeReasonSelection);
+}
+
+void ModelSelectionRowsBitmap::invertSelection()
+{
+    prepareChangedSignals();
+    m_rows.invert();
+    updateSelection();
+    emitChangedSignals(ChangeReasonSelection);
+}
+
+void ModelSelectionRowsBitmap::addSelectionImpl(SharedPtr<Range> range, bool exclude)
+{
+    bool select = !exclude;
+    int rowsCount = m_space ? m_space.data()->rows()->count() : 0;
+
+    if (qobject_cast<const RangeAll*>(range.data()))
+    {
+        m_rows.fill(select);
+    }
+    else if (auto rangeBitmap = qobject_cast<const RangeGridRowsBitmap*>(range.data()))
+    {
+        if (select && m_rows.isAll(false))
+            m_rows = rangeBitmap->rows();
+        else
+        {
+            for (int row = 0; row < rowsCount; ++row)
+            {
+                if (rangeBitmap->rows().value(row))
+                    m_rows.setValue(row, select);
+            }
+        }
+    }
+    else
+    {
+        SelectionSpans spans;
+        if (spans.addRange(*range, false))
+        {
+            // row is affected if range has any item in it
+            const auto& bands = spans.bands();
+            for (int i = 0; i < bands.size(); ++i)
+            {
+                if (bands[i].columns.isEmpty())
+                    continue;
+
+                int first = qMax(bands[i].firstRow, 0);
+                int last = qMin(spans.bandLastRow(i), rowsCount - 1);
+                if (first <= last)
+                    m_rows.setValues(first, last + 1, select);
+            }
+        }
+        else
+        {
+            // row is affected if range has item in the first column
+            for (int row = 0; row < rowsCount; ++row)
+            {
+                if (range->hasItem(ID(GridID(row, 0))))
+                    m_rows.setValue(row, select);
+            }
+        }
+    }
+
+    updateSelection();
+}
+
+void ModelSelectionRowsBitmap::clearSelectionImpl()
+{
+    m_rows.fill(false);
+    m_selection.clear();
+}
+
+void ModelSelectionRowsBitmap::updateSelection()
+{
+    // keep selection() in sync for controllers which extend it
+    m_selection.clear();
+    m_selection.addRange(makeRangeGridRowsBitmap(m_rows), false);
+}
+
 void ModelSelectionColumns::selectColumns(const QSet<int>& columns)
 {
     setSelection(makeShared<RangeGridColumns>(columns));
@@ -153,7 +505,7 @@ ViewSelectionClient::ViewSelectionClient(const SharedPtr<ModelSelection> &model,
 {
     if (useDefaultController)
     {
-        setController(makeShared<ControllerMouseSelectionClient>(model));
+        setControllerLazy([model]() { return makeShared<ControllerMouseSelectionClient>(model); });
     }
 }
 
@@ -175,8 +527,8 @@ void ViewSelectionClient::drawImpl(QPainter* painter, const GuiContext& ctx, con
 
         if (theModel()->isItemSelected(id))
         {
-            painter->setPen(ctx.widget->palette().color(cg, QPalette::HighlightedText));
-            painter->fillRect(cache.cacheView.rect(), ctx.widget->palette().brush(cg, QPalette::Highlight));
+            painter->setPen(ctx.palette().color(cg, QPalette::HighlightedText));
+            painter->fillRect(cache.cacheView.rect(), ctx.palette().brush(cg, QPalette::Highlight));
         }
 
         // draw focus rect for active item
@@ -192,16 +544,14 @@ void ViewSelectionClient::drawImpl(QPainter* painter, const GuiContext& ctx, con
         return;
     }
 
-    QStyleOptionViewItem option;
-    ctx.initStyleOption(option);
+    QStyleOptionViewItem option(ctx.viewItemOption());
     option.rect = cache.cacheView.rect();
-    option.widget = ctx.widget;
     option.showDecorationSelected = true;
 
     if (theModel()->isItemSelected(id))
     {
         option.state |= QStyle::State_Selected;
-        painter->setPen(ctx.widget->palette().highlightedText().color());
+        painter->setPen(ctx.palette().highlightedText().color());
 
         style->drawPrimitive(QStyle::PE_PanelItemViewItem, &option, painter, ctx.widget);
     }
@@ -228,8 +578,13 @@ ViewSelectionHeader::ViewSelectionHeader(const SharedPtr<ModelSelection> &model,
 {
     if (useDefaultController)
     {
-        setController(makeShared<ControllerMouseSelectionHeader>(model, type));
+        setControllerLazy([model, type]() { return makeShared<ControllerMouseSelectionHeader>(model, type); });
     }
+
+    // header items don't match changed client items
+    connect(model.data(), &ModelSelection::selectionChanged, this, [this]() {
+        emitViewChanged(ChangeReasonViewContent);
+    });
 }
 
 void ViewSelectionHeader::drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* /*showTooltip*/) const
@@ -252,15 +607,31 @@ void ViewSelectionHeader::drawImpl(QPainter* painter, const GuiContext& ctx, con
         option.orientation = Qt::Vertical;
     }
 
-    ctx.widget->style()->drawControl(QStyle::CE_HeaderSection, &option, painter, ctx.widget);
+    // fully selected lines are highlighted
+    if (    ((m_type == SelectionColumnsHeader) && theModel()->isRowSelectedAll(id.row)) ||
+            ((m_type == SelectionRowsHeader) && theModel()->isColumnSelectedAll(id.column)))
+    {
+        option.state |= QStyle::State_On;
+    }
+
+    ctx.style()->drawControl(QStyle::CE_HeaderSection, &option, painter, ctx.widget);
 }
 
 ControllerMouseSelectionClient::ControllerMouseSelectionClient(SharedPtr<ModelSelection> model)
     : ControllerMouseCaptured(ControllerMousePriorityBackground, true),
       m_model(std::move(model)),
-      m_exclude(false)
+      m_exclude(false),
+      m_autoScrollSpeed(10.0)
 {
     Q_ASSERT(m_model);
+
+    connect(&m_frameTimer, &QTimer::timeout, this, &ControllerMouseSelectionClient::onFrame);
+}
+
+void ControllerMouseSelectionClient::setAutoScrollSpeed(qreal autoScrollSpeed)
+{
+    Q_ASSERT(autoScrollSpeed >= 0.0);
+    m_autoScrollSpeed = autoScrollSpeed;
 }
 
 void ControllerMouseSelectionClient::startCapturingImpl()
@@ -285,6 +656,9 @@ void ControllerMouseSelectionClient::stopCapturingImpl()
     m_trackId = GridID();
     m_exclude = false;
 
+    m_frameTimer.stop();
+    m_autoScrollDelta = QPointF();
+
     m_model->stopSelectionOperation();
 
     ControllerMouseCaptured::stopCapturingImpl();
@@ -344,26 +718,66 @@ bool ControllerMouseSelectionClient::processMouseMove(QMouseEvent* event)
 {
     ControllerMouseCaptured::processMouseMove(event);
 
-    if (isCapturing())
+    // moves are coalesced until the next frame
+    if (isCapturing() && !m_frameTimer.isActive())
     {
-        auto cacheSpaceGrid = qobject_cast<const CacheSpaceGrid*>(&activationState().cacheSpace);
-        GridID itemUnderPoint = cacheSpaceGrid->visibleItemByPosition(activationState().context.point);
+        onFrame();
+        m_frameTimer.start(1000 / AnimationClock::instance().maxFps());
+    }
 
-        if (!cacheSpaceGrid->isItemInFrameStrict(itemUnderPoint))
-        {
-            // user moved mouse out of frame => try to scroll
-            activationState().context.widgetCore->ensureVisible(ID(itemUnderPoint), cacheSpaceGrid, false);
-        }
+    return true;
+}
+
+void ControllerMouseSelectionClient::onFrame()
+{
+    if (!isCapturing())
+    {
+        m_frameTimer.stop();
+        return;
+    }
 
-        if (m_trackId != itemUnderPoint)
+    auto cacheSpaceGrid = qobject_cast<const CacheSpaceGrid*>(&activationState().cacheSpace);
+    const QRect& window = cacheSpaceGrid->window();
+    const QPoint& point = activationState().context.point;
+
+    // user dragged mouse out of frame => scroll faster farther from the edge
+    QPoint framePoint(qBound(window.left(), point.x(), window.right()), qBound(window.top(), point.y(), window.bottom()));
+    QPoint distance = point - framePoint;
+    if (distance.x() == 0)
+        m_autoScrollDelta.rx() = 0.0;
+    if (distance.y() == 0)
+        m_autoScrollDelta.ry() = 0.0;
+
+    if (!distance.isNull())
+    {
+        m_autoScrollDelta += QPointF(distance) * (m_autoScrollSpeed / AnimationClock::instance().maxFps());
+
+        QPoint delta(int(m_autoScrollDelta.x()), int(m_autoScrollDelta.y()));
+        if (!delta.isNull())
         {
-            // update selection if track item has changed
-            m_trackId = itemUnderPoint;
-            applySelection(false);
+            QPoint origin = cacheSpaceGrid->window2Space(window.topLeft());
+            GridID targetId = cacheSpaceGrid->visibleItemByPosition(framePoint + delta);
+            activationState().context.widgetCore->ensureVisible(ID(targetId), cacheSpaceGrid, false);
+
+            // scrolling is made by whole items, overshoot is paid back by next frames
+            QPoint scrolled = cacheSpaceGrid->window2Space(window.topLeft()) - origin;
+            m_autoScrollDelta.rx() = (distance.x() == 0 || scrolled.x() == 0) ? 0.0 : m_autoScrollDelta.x() - scrolled.x();
+            m_autoScrollDelta.ry() = (distance.y() == 0 || scrolled.y() == 0) ? 0.0 : m_autoScrollDelta.y() - scrolled.y();
         }
     }
 
-    return true;
+    GridID itemUnderPoint = cacheSpaceGrid->visibleItemByPosition(point);
+    if (m_trackId != itemUnderPoint)
+    {
+        // update selection if track item has changed
+        m_trackId = itemUnderPoint;
+        applySelection(false);
+    }
+    else if (distance.isNull())
+    {
+        // nothing to do until mouse moves again
+        m_frameTimer.stop();
+    }
 }
 
 bool ControllerMouseSelectionClient::processContextMenu(QContextMenuEvent* /*event*/)
@@ -575,6 +989,10 @@ ControllerKeyboardSelection::ControllerKeyboardSelection(SharedPtr<ModelSelectio
 
     m_trackId = m_model->activeId();
 
+    m_pendingTimer.setSingleShot(true);
+    m_pendingTimer.setInterval(16);
+    connect(&m_pendingTimer, &QTimer::timeout, this, &ControllerKeyboardSelection::flushPendingMove);
+
     connect(m_model.data(), &ModelSelection::selectionChanged, this, &ControllerKeyboardSelection::onSelectionChanged);
 }
 
@@ -595,15 +1013,11 @@ bool ControllerKeyboardSelection::processKeyPress(QKeyEvent* event)
         m_model->startSelectionOperation();
     m_pressedKeys.insert(event->key());
 
-    GridID trackVisibleId(0, 0);
+    // apply accumulated moves before any other key or modifiers change
+    if (m_pendingTrackVisibleId.isValid() && (!event->isAutoRepeat() || event->modifiers() != m_pendingModifiers))
+        flushPendingMove();
 
-    if (m_trackId.isValid())
-    {
-        trackVisibleId = m_model->space().toGridVisible(m_trackId);
-        // if invisible - let start from beginning
-        if (!trackVisibleId.isValid())
-            trackVisibleId = GridID(0, 0);
-    }
+    GridID trackVisibleId = this->trackVisibleId();
 
     const auto& rows = spaceGrid->rows();
     const auto& columns = spaceGrid->columns();
@@ -626,12 +1040,12 @@ bool ControllerKeyboardSelection::processKeyPress(QKeyEvent* event)
 
     case Qt::Key_PageUp:
     {
-        rowOffset = -qMin(10, trackVisibleId.row - 0);
+        rowOffset = pageRowOffset(trackVisibleId, false);
     } break;
 
     case Qt::Key_PageDown:
     {
-        rowOffset = qMin(10, (rows->visibleCount() - 1) - trackVisibleId.row);
+        rowOffset = pageRowOffset(trackVisibleId, true);
     } break;
 
     case Qt::Key_Up:
@@ -688,31 +1102,20 @@ bool ControllerKeyboardSelection::processKeyPress(QKeyEvent* event)
     {
         trackVisibleId = GridID(trackVisibleId.row + rowOffset, trackVisibleId.column + columnOffset);
 
-        if (event->modifiers() & Qt::ShiftModifier)
-        {
-            if (m_selection.isEmpty())
-            {
-                m_selection = m_model->selection();
-            }
-
-            RangeSelection selection(m_selection);
-            selection.addRange(makeRangeGridRect(*spaceGrid, m_model->activeVisibleId(), trackVisibleId), false);
-            m_model->applySelection(selection);
-        }
-        else if (event->modifiers() & Qt::ControlModifier)
+        if (event->isAutoRepeat())
         {
-            m_model->setActiveVisibleId(trackVisibleId);
+            // held key generates events faster than frames - remember
+            // the target and update selection and scrolling once per frame
+            m_pendingTrackVisibleId = trackVisibleId;
+            m_pendingModifiers = event->modifiers();
+            if (!m_pendingTimer.isActive())
+                m_pendingTimer.start();
         }
         else
         {
-            m_model->setActiveVisibleId(trackVisibleId);
-            m_model->setSelection(makeRangeID(ID(m_model->activeId())));
+            moveTrack(trackVisibleId, event->modifiers());
         }
 
-        m_widgetCore->ensureVisible(ID(trackVisibleId), m_cacheSpace, false);
-
-        m_trackId = spaceGrid->toGridAbsolute(trackVisibleId);
-
         return true;
     }
     else if (!eventIsProcessed)
@@ -732,6 +1135,10 @@ bool ControllerKeyboardSelection::processKeyRelease(QKeyEvent* event)
 {
     qDebug() << "ControllerKeyboardSelection::processKeyRelease";
 
+    // some platforms send auto-repeated release events - keep them coalesced
+    if (!event->isAutoRepeat())
+        flushPendingMove();
+
     if (!m_pressedKeys.isEmpty())
     {
         m_pressedKeys.remove(event->key());
@@ -761,6 +1168,8 @@ void ControllerKeyboardSelection::startCapturing()
 
 void ControllerKeyboardSelection::stopCapturing()
 {
+    flushPendingMove();
+
     // number of key presses and releases may be different
     if (!m_pressedKeys.isEmpty())
     {
@@ -781,4 +1190,92 @@ void ControllerKeyboardSelection::onSelectionChanged(const ModelSelection*, Mode
     }
 }
 
+GridID ControllerKeyboardSelection::trackVisibleId() const
+{
+    if (m_pendingTrackVisibleId.isValid())
+        return m_pendingTrackVisibleId;
+
+    GridID trackVisibleId(0, 0);
+
+    if (m_trackId.isValid())
+    {
+        trackVisibleId = m_model->space().toGridVisible(m_trackId);
+        // if invisible - let start from beginning
+        if (!trackVisibleId.isValid())
+            trackVisibleId = GridID(0, 0);
+    }
+
+    return trackVisibleId;
+}
+
+int ControllerKeyboardSelection::pageRowOffset(const GridID& trackVisibleId, bool down) const
+{
+    const auto& rows = static_cast<const SpaceGrid&>(m_model->space()).rows();
+    int lastRow = rows->visibleCount() - 1;
+    int pageHeight = m_cacheSpace->window().height();
+
+    if (pageHeight <= 0)
+        return down ? qMin(10, lastRow - trackVisibleId.row) : -qMin(10, trackVisibleId.row);
+
+    // find the row one page away by position instead of stepping line by line
+    if (down)
+    {
+        int targetRow = rows->findVisibleIDByPos(rows->startPos(trackVisibleId.row) + pageHeight, true);
+        return qMax(targetRow - trackVisibleId.row, qMin(1, lastRow - trackVisibleId.row));
+    }
+    else
+    {
+        int targetRow = rows->findVisibleIDByPos(rows->startPos(trackVisibleId.row) - pageHeight, true);
+        return qMin(targetRow - trackVisibleId.row, -qMin(1, trackVisibleId.row));
+    }
+}
+
+void ControllerKeyboardSelection::moveTrack(const GridID& trackVisibleId, Qt::KeyboardModifiers modifiers)
+{
+    auto spaceGrid = static_cast<const SpaceGrid*>(&m_model->space());
+
+    if (modifiers & Qt::ShiftModifier)
+    {
+        if (m_selection.isEmpty())
+        {
+            m_selection = m_model->selection();
+        }
+
+        RangeSelection selection(m_selection);
+        selection.addRange(makeRangeGridRect(*spaceGrid, m_model->activeVisibleId(), trackVisibleId), false);
+        m_model->applySelection(selection);
+    }
+    else if (modifiers & Qt::ControlModifier)
+    {
+        m_model->setActiveVisibleId(trackVisibleId);
+    }
+    else
+    {
+        m_model->setActiveVisibleId(trackVisibleId);
+        m_model->setSelection(makeRangeID(ID(m_model->activeId())));
+    }
+
+    m_widgetCore->ensureVisible(ID(trackVisibleId), m_cacheSpace, false);
+
+    m_trackId = spaceGrid->toGridAbsolute(trackVisibleId);
+}
+
+void ControllerKeyboardSelection::flushPendingMove()
+{
+    m_pendingTimer.stop();
+
+    if (!m_pendingTrackVisibleId.isValid())
+        return;
+
+    GridID trackVisibleId = m_pendingTrackVisibleId;
+    m_pendingTrackVisibleId = GridID();
+
+    // space may have changed while the move was pending
+    auto spaceGrid = static_cast<const SpaceGrid*>(&m_model->space());
+    if (trackVisibleId.row >= spaceGrid->rows()->visibleCount() || trackVisibleId.column >= spaceGrid->columns()->visibleCount())
+        return;
+
+    moveTrack(trackVisibleId, m_pendingModifiers);
+}
+
 } // end namespace Qi
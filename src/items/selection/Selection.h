@@ -21,8 +21,10 @@
 #include "core/ext/ViewModeled.h"
 #include "core/ext/ControllerMousePushable.h"
 #include "core/ControllerKeyboard.h"
+#include "SelectionSpans.h"
 
 #include <space/grid/SpaceGrid.h>
+#include <QTimer>
 
 namespace Qi
 {
@@ -51,6 +53,18 @@ public:
     const RangeSelection& selection() const { return m_selection; }
     void applySelection(const RangeSelection& selection);
 
+    // normalized selection or nullptr if selection cannot be normalized
+    const SelectionSpans* selectionSpans() const { return selectionSpansImpl(); }
+
+    // numbers of selected items in absolute row or column
+    // counts are kept per line and updated from selection spans for changed lines only,
+    // selections without spans are probed item by item
+    int rowSelectedCount(int row) const;
+    int columnSelectedCount(int column) const;
+    // all items of absolute row or column are selected
+    bool isRowSelectedAll(int row) const;
+    bool isColumnSelectedAll(int column) const;
+
     GridID activeId() const { return m_activeId; }
     GridID activeVisibleId() const;
     void setActiveId(GridID id);
@@ -59,6 +73,10 @@ public:
     void startSelectionOperation();
     void stopSelectionOperation();
 
+    // if true change signals are emitted once per event loop turn
+    bool isCoalesceChanges() const { return m_coalesceChanges; }
+    void setCoalesceChanges(bool coalesceChanges);
+
     enum ChangeReason
     {
         ChangeReasonSelection = 0x1,
@@ -68,19 +86,62 @@ public:
 signals:
     void selectionChanged(const ModelSelection* selection, ChangeReason changeReason);
     void selectionOperationPerformed(const ModelSelection* selection, bool started);
+    // emitted after selectionChanged with bounds of absolute items changed
+    // selected or active state where x is column and y is row
+    void selectionRegionChanged(const ModelSelection* selection, const QRect& absRegion);
 
 protected:
     int compareImpl(ID left, ID right) const override;
     bool isAscendingDefaultImpl(ID /*id*/) const override { return false; }
+    int ordinalKeysCountImpl() const override { return 2; }
+    int ordinalKeyImpl(ID id) const override { return isItemSelected(id.as<GridID>()) ? 1 : 0; }
+
+    virtual bool isItemSelectedImpl(GridID id) const { return hasSelectionItem(id); }
+    // should return nullptr if isItemSelectedImpl doesn't follow selection spans
+    virtual const SelectionSpans* selectionSpansImpl() const { return m_isSelectionSpans ? &m_selectionSpans : nullptr; }
 
-    virtual bool isItemSelectedImpl(GridID id) const { return m_selection.hasItem(ID(id)); }
+    bool hasSelectionItem(GridID id) const;
 
+    // selection storage, isItemSelectedImpl should follow it
+    virtual void addSelectionImpl(SharedPtr<Range> range, bool exclude);
+    virtual void clearSelectionImpl();
+
+    void prepareChangedSignals();
     void emitChangedSignals(ChangeReason changeReason);
 
     RangeSelection m_selection;
+    // normalized m_selection if all ranges are grid ranges
+    SelectionSpans m_selectionSpans;
+    bool m_isSelectionSpans;
     GridID m_activeId;
     QWeakPointer<SpaceGrid> m_space;
     int m_selectionOperations;
+
+private:
+    void flushChangedSignals();
+    QRect changedRegion(ChangeReason changeReason) const;
+    // notifies views about items of small region only, so they repaint them alone
+    void notifyRegionChanged(const QRect& absRegion);
+
+    // returns false if selection has no spans
+    bool validateSelectedCounts() const;
+    // recalculates counts of rows and columns within absRegion
+    void updateSelectedCounts(const SelectionSpans& spans, const QRect& absRegion) const;
+
+    bool m_coalesceChanges;
+    // state before pending changes
+    int m_pendingChangeReason;
+    SelectionSpans m_pendingSpans;
+    bool m_isPendingSpans;
+    GridID m_pendingActiveId;
+
+    // incremented by each selection change
+    quint64 m_selectionVersion;
+    // selected items per absolute line for m_selectedCountsSpans
+    mutable QVector<int> m_rowSelectedCounts;
+    mutable QVector<int> m_columnSelectedCounts;
+    mutable SelectionSpans m_selectedCountsSpans;
+    mutable quint64 m_selectedCountsVersion;
 };
 
 class QI_EXPORT ModelSelectionRows: public ModelSelection
@@ -98,6 +159,38 @@ public:
 
 protected:
     bool isItemSelectedImpl(GridID id) const override { return isRowSelected(id.row); }
+    const SelectionSpans* selectionSpansImpl() const override { return nullptr; }
+};
+
+// rows selection stored as bitmap of absolute rows
+class QI_EXPORT ModelSelectionRowsBitmap: public ModelSelection
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ModelSelectionRowsBitmap)
+
+public:
+    ModelSelectionRowsBitmap(SharedPtr<SpaceGrid> space)
+        : ModelSelection(std::move(space))
+    {}
+
+    bool isRowSelected(int row) const { return row >= 0 && m_rows.value(row); }
+    const SparseBitVector& selectedRows() const { return m_rows; }
+
+    // selects or deselects rows in [rowBegin, rowEnd)
+    void selectRows(int rowBegin, int rowEnd, bool select = true);
+    void selectAll();
+    void invertSelection();
+
+protected:
+    bool isItemSelectedImpl(GridID id) const override { return isRowSelected(id.row); }
+    const SelectionSpans* selectionSpansImpl() const override { return nullptr; }
+    void addSelectionImpl(SharedPtr<Range> range, bool exclude) override;
+    void clearSelectionImpl() override;
+
+private:
+    void updateSelection();
+
+    SparseBitVector m_rows;
 };
 
 class QI_EXPORT ModelSelectionRow: public ModelSelection
@@ -115,6 +208,7 @@ public:
 
 protected:
     bool isItemSelectedImpl(GridID id) const override { return isRowSelected(id.row); }
+    const SelectionSpans* selectionSpansImpl() const override { return nullptr; }
 };
 
 class QI_EXPORT ModelSelectionColumns: public ModelSelection
@@ -132,6 +226,7 @@ public:
 
 protected:
     bool isItemSelectedImpl(GridID id) const override { return isColumnSelected(id.column); }
+    const SelectionSpans* selectionSpansImpl() const override { return nullptr; }
 };
 
 class QI_EXPORT ViewSelectionClient: public ViewModeled<ModelSelection>
@@ -189,18 +284,30 @@ public:
     bool processMouseMove(QMouseEvent* event) override;
     bool processContextMenu(QContextMenuEvent* event) override;
 
+    // pixels per second to scroll for each pixel mouse is dragged past the frame edge
+    qreal autoScrollSpeed() const { return m_autoScrollSpeed; }
+    void setAutoScrollSpeed(qreal autoScrollSpeed);
+
 protected:
     void startCapturingImpl() override;
     void stopCapturingImpl() override;
 
 private:
     void applySelection(bool makeStartItemAsActive);
+    // scrolls toward mouse out of frame and applies selection once per frame
+    void onFrame();
 
     SharedPtr<ModelSelection> m_model;
     RangeSelection m_selection;
     GridID m_startId;
     GridID m_trackId;
     bool m_exclude;
+
+    // runs while mouse is dragged, interval is frame of AnimationClock
+    QTimer m_frameTimer;
+    qreal m_autoScrollSpeed;
+    // pixels to scroll which are not scrolled yet
+    QPointF m_autoScrollDelta;
 };
 
 class QI_EXPORT ControllerMouseSelectionHeader: public ControllerMouseCaptured
@@ -257,6 +364,11 @@ public:
 private:
     void onSelectionChanged(const ModelSelection*, ModelSelection::ChangeReason reason);
 
+    GridID trackVisibleId() const;
+    int pageRowOffset(const GridID& trackVisibleId, bool down) const;
+    void moveTrack(const GridID& trackVisibleId, Qt::KeyboardModifiers modifiers);
+    void flushPendingMove();
+
     SharedPtr<ModelSelection> m_model;
     const CacheSpace* m_cacheSpace;
     SpaceWidgetCore* m_widgetCore;
@@ -264,6 +376,11 @@ private:
     GridID m_trackId;
     RangeSelection m_selection;
     QSet<int> m_pressedKeys;
+
+    // auto-repeated moves are accumulated and applied once per frame
+    GridID m_pendingTrackVisibleId;
+    Qt::KeyboardModifiers m_pendingModifiers;
+    QTimer m_pendingTimer;
 };
 
 } // end namespace Qi
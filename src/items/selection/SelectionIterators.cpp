@@ -15,14 +15,63 @@
 */
 
 #include "SelectionIterators.h"
+#include <algorithm>
 
 namespace Qi
 {
 
+// sorted visible lines of absolute spans
+static QVector<int> toSortedVisible(const LinesSpans& spans, const Lines& lines)
+{
+    QVector<int> result;
+    for (const auto& span : spans)
+    {
+        int first = qMax(span.first, 0);
+        int last = qMin(span.last, lines.count() - 1);
+        for (int line = first; line <= last; ++line)
+        {
+            int visibleLine = lines.toVisible(line);
+            if (visibleLine != InvalidIndex)
+                result.append(visibleLine);
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// sorted visible rows with bands index for bands passed acceptBand
+template <typename Pred>
+static QVector<QPair<int, int>> toSortedVisibleRows(const SelectionSpans& spans, const Lines& rows, const Pred& acceptBand)
+{
+    QVector<QPair<int, int>> result;
+    const auto& bands = spans.bands();
+    for (int i = 0; i < bands.size(); ++i)
+    {
+        if (!acceptBand(bands[i]))
+            continue;
+
+        int first = qMax(bands[i].firstRow, 0);
+        int last = qMin(spans.bandLastRow(i), rows.count() - 1);
+        for (int row = first; row <= last; ++row)
+        {
+            int visibleRow = rows.toVisible(row);
+            if (visibleRow != InvalidIndex)
+                result.append(qMakePair(visibleRow, i));
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
 IdIteratorSelectedVisible::IdIteratorSelectedVisible(const ModelSelection& selection)
     : m_selection(selection),
       m_rows(nullptr),
-      m_columns(nullptr)
+      m_columns(nullptr),
+      m_isSpans(false),
+      m_selectedRow(0),
+      m_selectedColumn(0)
 {
     const auto& spaceGrid = m_selection.space();
     m_rows = spaceGrid.rows().data();
@@ -39,6 +88,12 @@ bool IdIteratorSelectedVisible::atFirstImpl()
         return false;
     }
 
+    // walk selection spans instead of probing each cell
+    auto spans = m_selection.selectionSpans();
+    m_isSpans = (spans != nullptr);
+    if (m_isSpans)
+        return atFirstSpans(*spans);
+
     m_currentVisibleId = GridID(0, 0);
     m_currentAbsId = GridID(m_rows->toAbsolute(m_currentVisibleId.row), m_columns->toAbsolute(m_currentVisibleId.column));
 
@@ -53,6 +108,9 @@ bool IdIteratorSelectedVisible::toNextImpl()
     if (!m_currentAbsId.isValid())
         return false;
 
+    if (m_isSpans)
+        return toNextSpans();
+
     ++m_currentVisibleId.column;
 
     for (;m_currentVisibleId.row < m_rows->visibleCount(); ++m_currentVisibleId.row, m_currentVisibleId.column = 0)
@@ -69,9 +127,53 @@ bool IdIteratorSelectedVisible::toNextImpl()
     return false;
 }
 
+bool IdIteratorSelectedVisible::atFirstSpans(const SelectionSpans& spans)
+{
+    m_selectedRows = toSortedVisibleRows(spans, *m_rows, [](const SelectionSpans::Band& band) {
+        return !band.columns.isEmpty();
+    });
+
+    const auto& bands = spans.bands();
+    m_bandsColumns.clear();
+    m_bandsColumns.resize(bands.size());
+    for (int i = 0; i < bands.size(); ++i)
+    {
+        if (!bands[i].columns.isEmpty())
+            m_bandsColumns[i] = toSortedVisible(bands[i].columns, *m_columns);
+    }
+
+    m_selectedRow = 0;
+    m_selectedColumn = -1;
+    m_currentAbsId = GridID(0, 0);
+    return toNextSpans();
+}
+
+bool IdIteratorSelectedVisible::toNextSpans()
+{
+    ++m_selectedColumn;
+
+    for (; m_selectedRow < m_selectedRows.size(); ++m_selectedRow, m_selectedColumn = 0)
+    {
+        const auto& selectedRow = m_selectedRows[m_selectedRow];
+        const auto& bandColumns = m_bandsColumns[selectedRow.second];
+        if (m_selectedColumn < bandColumns.size())
+        {
+            m_currentVisibleId = GridID(selectedRow.first, bandColumns[m_selectedColumn]);
+            m_currentAbsId = GridID(m_rows->toAbsolute(m_currentVisibleId.row), m_columns->toAbsolute(m_currentVisibleId.column));
+            return true;
+        }
+    }
+
+    m_currentAbsId = GridID();
+    return false;
+}
+
 IdIteratorSelectedVisibleByColumn::IdIteratorSelectedVisibleByColumn(const ModelSelection& selection, int absColumn)
     : m_selection(selection),
-      m_rows(nullptr)
+      m_rows(nullptr),
+      m_absColumn(absColumn),
+      m_isSpans(false),
+      m_selectedRow(0)
 {
     auto spaceGrid = &m_selection.space();
     Q_ASSERT(spaceGrid);
@@ -92,6 +194,23 @@ bool IdIteratorSelectedVisibleByColumn::atFirstImpl()
         return false;
     }
 
+    // walk selection spans instead of probing each cell
+    auto spans = m_selection.selectionSpans();
+    m_isSpans = (spans != nullptr);
+    if (m_isSpans)
+    {
+        int absColumn = m_absColumn;
+        m_selectedRows = toSortedVisibleRows(*spans, *m_rows, [absColumn](const SelectionSpans::Band& band) {
+            return std::any_of(band.columns.begin(), band.columns.end(), [absColumn](const LinesSpan& span) {
+                return span.first <= absColumn && absColumn <= span.last;
+            });
+        });
+
+        m_selectedRow = -1;
+        m_currentAbsId = GridID(0, absColumn);
+        return toNextSpans();
+    }
+
     m_currentVisibleId.row = 0;
     m_currentAbsId.row = m_rows->toAbsolute(m_currentVisibleId.row);
 
@@ -106,6 +225,9 @@ bool IdIteratorSelectedVisibleByColumn::toNextImpl()
     if (!m_currentAbsId.isValid())
         return false;
 
+    if (m_isSpans)
+        return toNextSpans();
+
     ++m_currentVisibleId.row;
 
     for (;m_currentVisibleId.row < m_rows->visibleCount(); ++m_currentVisibleId.row)
@@ -119,4 +241,50 @@ bool IdIteratorSelectedVisibleByColumn::toNextImpl()
     return false;
 }
 
+bool IdIteratorSelectedVisibleByColumn::fetchColumnSpanImpl(GridColumnSpan& span)
+{
+    if (!m_isSpans)
+        return IdIteratorGrid::fetchColumnSpanImpl(span);
+
+    if (!m_currentAbsId.isValid())
+        return false;
+
+    span.column = m_currentAbsId.column;
+    span.firstRow = m_currentAbsId.row;
+    span.rowsCount = 1;
+
+    // extend span over selected rows without virtual calls
+    for (++m_selectedRow; m_selectedRow < m_selectedRows.size(); ++m_selectedRow)
+    {
+        int visibleRow = m_selectedRows[m_selectedRow].first;
+        int absRow = m_rows->toAbsolute(visibleRow);
+        if (absRow != span.firstRow + span.rowsCount)
+        {
+            m_currentVisibleId.row = visibleRow;
+            m_currentAbsId.row = absRow;
+            return true;
+        }
+
+        ++span.rowsCount;
+    }
+
+    m_currentAbsId = GridID();
+    return true;
+}
+
+bool IdIteratorSelectedVisibleByColumn::toNextSpans()
+{
+    ++m_selectedRow;
+
+    if (m_selectedRow < m_selectedRows.size())
+    {
+        m_currentVisibleId.row = m_selectedRows[m_selectedRow].first;
+        m_currentAbsId.row = m_rows->toAbsolute(m_currentVisibleId.row);
+        return true;
+    }
+
+    m_currentAbsId = GridID();
+    return false;
+}
+
 } // end namespace Qi
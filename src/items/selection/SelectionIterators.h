@@ -25,7 +25,7 @@ namespace Qi
 
 class Lines;
 
-class QI_EXPORT IdIteratorSelectedVisible: public IdIterator
+class QI_EXPORT IdIteratorSelectedVisible: public IdIteratorGrid
 {
 public:
     explicit IdIteratorSelectedVisible(const ModelSelection& selection);
@@ -33,19 +33,30 @@ public:
     GridID visibleId() const { return m_currentVisibleId; }
 
 protected:
-    ID idImpl() const override { return ID(m_currentAbsId); }
+    GridID gridIdImpl() const override { return m_currentAbsId; }
     bool atFirstImpl() override;
     bool toNextImpl() override;
 
 private:
+    bool atFirstSpans(const SelectionSpans& spans);
+    bool toNextSpans();
+
     const ModelSelection& m_selection;
     const Lines* m_rows;
     const Lines* m_columns;
     GridID m_currentVisibleId;
     GridID m_currentAbsId;
+
+    // visible rows with band index and visible columns by band
+    // if selection has spans
+    bool m_isSpans;
+    QVector<QPair<int, int>> m_selectedRows;
+    QVector<QVector<int>> m_bandsColumns;
+    int m_selectedRow;
+    int m_selectedColumn;
 };
 
-class QI_EXPORT IdIteratorSelectedVisibleByColumn: public IdIterator
+class QI_EXPORT IdIteratorSelectedVisibleByColumn: public IdIteratorGrid
 {
 public:
     explicit IdIteratorSelectedVisibleByColumn(const ModelSelection& selection, int absColumn = 0);
@@ -53,15 +64,24 @@ public:
     GridID visibleId() const { return m_currentVisibleId; }
 
 protected:
-    ID idImpl() const override { return ID(m_currentAbsId); }
+    GridID gridIdImpl() const override { return m_currentAbsId; }
     bool atFirstImpl() override;
     bool toNextImpl() override;
+    bool fetchColumnSpanImpl(GridColumnSpan& span) override;
 
 private:
+    bool toNextSpans();
+
     const ModelSelection& m_selection;
     const Lines* m_rows;
     GridID m_currentVisibleId;
     GridID m_currentAbsId;
+
+    // visible rows if selection has spans
+    int m_absColumn;
+    bool m_isSpans;
+    QVector<QPair<int, int>> m_selectedRows;
+    int m_selectedRow;
 };
 
 
@@ -0,0 +1,320 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "SelectionMimeData.h"
+#include "Selection.h"
+#include "SelectionIterators.h"
+#include "cache/CacheItemFactory.h"
+#include "utils/TaskPool.h"
+#include <QGuiApplication>
+#include <QClipboard>
+#include <QSet>
+#include <atomic>
+#include <algorithm>
+
+namespace Qi
+{
+
+static const char* const MimeTypeText = "text/plain";
+static const char* const MimeTypeHtml = "text/html";
+
+// bytes of one buffer chunk, chunks are joined once when serialization is done
+static const int SerializeChunkSize = 64 * 1024;
+
+struct SelectionMimeData::Snapshot
+{
+    SharedPtr<CacheItemFactory> factory;
+    // absolute indexes of visible lines with selected items
+    QVector<int> rows;
+    QVector<int> columns;
+
+    // selected absolute items by spans if selection has them
+    bool isSpans = false;
+    SelectionSpans spans;
+    QSet<GridID> items;
+
+    std::atomic<bool> cancelled { false };
+
+    bool isSelected(GridID id) const { return isSpans ? spans.hasItem(id) : items.contains(id); }
+};
+
+// buffer of fixed size chunks without reallocations of the whole data
+class SelectionChunkedBuffer
+{
+public:
+    void append(const QByteArray& data)
+    {
+        if (m_chunks.isEmpty() || m_chunks.last().size() + data.size() > SerializeChunkSize)
+        {
+            m_chunks.append(QByteArray());
+            m_chunks.last().reserve(qMax(SerializeChunkSize, data.size()));
+        }
+        m_chunks.last().append(data);
+        m_size += data.size();
+    }
+
+    QByteArray join() const
+    {
+        QByteArray result;
+        result.reserve(m_size);
+        for (const auto& chunk: m_chunks)
+            result.append(chunk);
+        return result;
+    }
+
+private:
+    QVector<QByteArray> m_chunks;
+    int m_size = 0;
+};
+
+static QVector<int> toAbsoluteLines(const QVector<int>& visibleLines, const Lines& lines)
+{
+    QVector<int> result;
+    result.reserve(visibleLines.size());
+    for (int line: visibleLines)
+        result.append(lines.toAbsolute(line));
+    return result;
+}
+
+QByteArray SelectionMimeData::serialize(const Snapshot& snapshot, bool html)
+{
+    SelectionChunkedBuffer buffer;
+    QString row;
+    QString text;
+
+    if (html)
+        buffer.append(QByteArrayLiteral("<html><body><table>\n"));
+
+    for (int absRow: snapshot.rows)
+    {
+        if (snapshot.cancelled)
+            return QByteArray();
+
+        row.resize(0);
+        if (html)
+            row.append(QLatin1String("<tr>"));
+
+        for (int j = 0; j < snapshot.columns.size(); ++j)
+        {
+            if (html)
+                row.append(QLatin1String("<td>"));
+            else if (j > 0)
+                row.append(QLatin1Char('\t'));
+
+            GridID id(absRow, snapshot.columns[j]);
+            if (snapshot.isSelected(id))
+            {
+                CacheItemInfo info(ID(id));
+                snapshot.factory->updateSchema(info);
+                text.resize(0);
+                if (info.schema.view && info.schema.view->text(info.id, text))
+                {
+                    if (html)
+                        row.append(text.toHtmlEscaped());
+                    else
+                    {
+                        // keep table structure
+                        for (QChar& ch: text)
+                        {
+                            if (ch == QLatin1Char('\t') || ch == QLatin1Char('\n') || ch == QLatin1Char('\r'))
+                                ch = QLatin1Char(' ');
+                        }
+                        row.append(text);
+                    }
+                }
+            }
+
+            if (html)
+                row.append(QLatin1String("</td>"));
+        }
+
+        row.append(html ? QLatin1String("</tr>\n") : QLatin1String("\n"));
+        buffer.append(row.toUtf8());
+    }
+
+    if (html)
+        buffer.append(QByteArrayLiteral("</table></body></html>\n"));
+
+    return buffer.join();
+}
+
+SelectionMimeData::SelectionMimeData(const ModelSelection& selection)
+    : m_snapshot(createSnapshot(selection)),
+      m_hasText(false),
+      m_hasHtml(false)
+{
+}
+
+SelectionMimeData::~SelectionMimeData()
+{
+    // worker thread shares snapshot so it's safe to leave it
+    m_snapshot->cancelled = true;
+}
+
+int SelectionMimeData::rowsCount() const
+{
+    return m_snapshot->rows.size();
+}
+
+int SelectionMimeData::columnsCount() const
+{
+    return m_snapshot->columns.size();
+}
+
+void SelectionMimeData::prefetch()
+{
+    if (m_hasText || m_textTask)
+        return;
+
+    auto snapshot = m_snapshot;
+    auto text = m_prefetchedText = makeShared<QByteArray>();
+    m_textTask.reset(new TaskGroup(TaskPriorityBackground));
+    m_textTask->run([snapshot, text]() {
+        *text = serialize(*snapshot, false);
+    });
+}
+
+QStringList SelectionMimeData::formats() const
+{
+    return QStringList() << QLatin1String(MimeTypeText) << QLatin1String(MimeTypeHtml);
+}
+
+bool SelectionMimeData::hasFormat(const QString& mimeType) const
+{
+    return mimeType == QLatin1String(MimeTypeText) || mimeType == QLatin1String(MimeTypeHtml);
+}
+
+QVariant SelectionMimeData::retrieveData(const QString& mimeType, QVariant::Type type) const
+{
+    if (mimeType == QLatin1String(MimeTypeText))
+    {
+        if (!m_hasText)
+        {
+            // background serialization is waited instead of repeated,
+            // if it is not started yet it runs in this thread
+            if (m_textTask)
+            {
+                m_textTask->wait();
+                m_text = *m_prefetchedText;
+                m_textTask.reset();
+            }
+            else
+            {
+                m_text = serialize(*m_snapshot, false);
+            }
+            m_hasText = true;
+        }
+
+        if (type == QVariant::String)
+            return QString::fromUtf8(m_text);
+        return m_text;
+    }
+
+    if (mimeType == QLatin1String(MimeTypeHtml))
+    {
+        if (!m_hasHtml)
+        {
+            m_html = serialize(*m_snapshot, true);
+            m_hasHtml = true;
+        }
+
+        if (type == QVariant::String)
+            return QString::fromUtf8(m_html);
+        return m_html;
+    }
+
+    return QMimeData::retrieveData(mimeType, type);
+}
+
+SharedPtr<SelectionMimeData::Snapshot> SelectionMimeData::createSnapshot(const ModelSelection& selection)
+{
+    const SpaceGrid& grid = selection.space();
+    const Lines& rows = *grid.rows();
+    const Lines& columns = *grid.columns();
+
+    // ordered schemas are not thread safe, so resolve them here
+    grid.schemasOrdered();
+
+    auto snapshot = makeShared<Snapshot>();
+    snapshot->factory = grid.createCacheItemFactory();
+
+    QVector<int> visibleRows;
+    QVector<int> visibleColumns;
+    if (auto spans = selection.selectionSpans())
+    {
+        // lines are found by spans without visiting selected items
+        snapshot->isSpans = true;
+        snapshot->spans = *spans;
+        const auto& bands = spans->bands();
+
+        for (int row = 0, count = rows.visibleCount(); row < count; ++row)
+        {
+            int absRow = rows.toAbsolute(row);
+            auto band = std::upper_bound(bands.begin(), bands.end(), absRow, [](int line, const SelectionSpans::Band& band) {
+                return line < band.firstRow;
+            });
+            if (band != bands.begin() && !(band - 1)->columns.isEmpty())
+                visibleRows.append(row);
+        }
+
+        for (int column = 0, count = columns.visibleCount(); column < count; ++column)
+        {
+            int absColumn = columns.toAbsolute(column);
+            bool isSelected = std::any_of(bands.begin(), bands.end(), [absColumn](const SelectionSpans::Band& band) {
+                return std::any_of(band.columns.begin(), band.columns.end(), [absColumn](const LinesSpan& span) {
+                    return absColumn >= span.first && absColumn <= span.last;
+                });
+            });
+            if (isSelected)
+                visibleColumns.append(column);
+        }
+    }
+    else
+    {
+        QSet<int> rowsSet;
+        QSet<int> columnsSet;
+        IdIteratorSelectedVisible it(selection);
+        for (; it.isValid(); it.toNext())
+        {
+            snapshot->items.insert(it.gridId());
+            rowsSet.insert(it.visibleId().row);
+            columnsSet.insert(it.visibleId().column);
+        }
+
+        visibleRows = rowsSet.toList().toVector();
+        visibleColumns = columnsSet.toList().toVector();
+        std::sort(visibleRows.begin(), visibleRows.end());
+        std::sort(visibleColumns.begin(), visibleColumns.end());
+    }
+
+    snapshot->rows = toAbsoluteLines(visibleRows, rows);
+    snapshot->columns = toAbsoluteLines(visibleColumns, columns);
+
+    return snapshot;
+}
+
+void copySelectionToClipboard(const ModelSelection& selection, bool prefetch)
+{
+    auto mimeData = new SelectionMimeData(selection);
+    if (prefetch)
+        mimeData->prefetch();
+
+    // clipboard takes ownership
+    QGuiApplication::clipboard()->setMimeData(mimeData);
+}
+
+} // end namespace Qi
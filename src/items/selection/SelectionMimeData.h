@@ -0,0 +1,79 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_SELECTION_MIME_DATA_H
+#define QI_SELECTION_MIME_DATA_H
+
+#include "QiAPI.h"
+#include <QMimeData>
+#include <QScopedPointer>
+
+namespace Qi
+{
+
+class ModelSelection;
+class TaskGroup;
+
+// clipboard data of selected visible grid items as TSV (text/plain) and HTML table
+// rows and columns having selected items make the table, other cells are empty
+// selected items are captured on construction, texts (see View::text) are
+// serialized once on the first request of each format
+class QI_EXPORT SelectionMimeData: public QMimeData
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(SelectionMimeData)
+
+public:
+    explicit SelectionMimeData(const ModelSelection& selection);
+    virtual ~SelectionMimeData();
+
+    int rowsCount() const;
+    int columnsCount() const;
+
+    // starts serialization of text/plain in background thread,
+    // models of grid views should be thread safe
+    void prefetch();
+
+    QStringList formats() const override;
+    bool hasFormat(const QString& mimeType) const override;
+
+protected:
+    QVariant retrieveData(const QString& mimeType, QVariant::Type type) const override;
+
+private:
+    struct Snapshot;
+
+    static SharedPtr<Snapshot> createSnapshot(const ModelSelection& selection);
+    static QByteArray serialize(const Snapshot& snapshot, bool html);
+
+    SharedPtr<Snapshot> m_snapshot;
+    // background serialization of text/plain
+    mutable QScopedPointer<TaskGroup> m_textTask;
+    SharedPtr<QByteArray> m_prefetchedText;
+    mutable QByteArray m_text;
+    mutable QByteArray m_html;
+    mutable bool m_hasText;
+    mutable bool m_hasHtml;
+};
+
+// puts selection to clipboard, texts are serialized when target application reads them
+// or in background thread immediately if prefetch is true
+QI_EXPORT void copySelectionToClipboard(const ModelSelection& selection, bool prefetch = false);
+
+} // end namespace Qi
+
+#endif // QI_SELECTION_MIME_DATA_H
@@ -0,0 +1,227 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "SelectionPaste.h"
+#include "Selection.h"
+#include "SelectionIterators.h"
+#include "utils/TaskPool.h"
+#include <QGuiApplication>
+#include <QClipboard>
+#include <QSet>
+#include <limits>
+
+namespace Qi
+{
+
+// items processed by one worker thread
+static const int PasteChunkSize = 4096;
+
+struct SelectionPasteColumn
+{
+    int absColumn;
+    int visibleColumn;
+    // visible and absolute rows of selected items
+    QVector<QPair<int, int>> rows;
+};
+
+SelectionPaste::SelectionPaste(SharedPtr<ModelSelection> selection)
+    : m_selection(std::move(selection))
+{
+    Q_ASSERT(m_selection);
+}
+
+void SelectionPaste::setColumnModel(int column, SharedPtr<ModelTyped<QString>> model)
+{
+    ColumnWriter writer;
+    writer.model = model;
+    writer.write = [model](const QVector<GridID>& ids, const QVector<QString>& texts) {
+        int written = 0;
+        for (int i = 0; i < ids.size(); ++i)
+        {
+            if (model->setValue(ID(ids[i]), texts[i]))
+                ++written;
+        }
+        return written;
+    };
+    m_writers.insert(column, writer);
+}
+
+void SelectionPaste::clearColumnModels()
+{
+    m_writers.clear();
+}
+
+void SelectionPaste::forChunks(int count, const std::function<void(int begin, int end)>& work)
+{
+    if (count <= PasteChunkSize)
+    {
+        work(0, count);
+        return;
+    }
+
+    TaskPool::instance().parallelFor(0, count, PasteChunkSize, work);
+}
+
+SelectionPasteTable SelectionPaste::parse(const QString& text)
+{
+    SelectionPasteTable table;
+
+    // find lines first, they are split to cells independently
+    QVector<QPair<int, int>> lines;
+    int lineBegin = 0;
+    for (int i = 0, size = text.size(); i <= size; ++i)
+    {
+        if (i < size && text[i] != QLatin1Char('\n'))
+            continue;
+
+        int lineEnd = i;
+        if (lineEnd > lineBegin && text[lineEnd - 1] == QLatin1Char('\r'))
+            --lineEnd;
+
+        // trailing line break doesn't make empty row
+        if (i < size || lineEnd > lineBegin)
+            lines.append(qMakePair(lineBegin, lineEnd - lineBegin));
+        lineBegin = i + 1;
+    }
+
+    if (lines.isEmpty())
+        return table;
+
+    table.rows.resize(lines.size());
+    auto& rows = table.rows;
+    forChunks(lines.size(), [&text, &lines, &rows](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            auto cells = text.midRef(lines[i].first, lines[i].second).split(QLatin1Char('\t'));
+            auto& row = rows[i];
+            row.reserve(cells.size());
+            for (const auto& cell: cells)
+                row.append(cell.toString());
+        }
+    });
+
+    for (const auto& row: table.rows)
+        table.columnsCount = qMax(table.columnsCount, row.size());
+
+    return table;
+}
+
+int SelectionPaste::paste(const QString& text)
+{
+    SelectionPasteTable table = parse(text);
+    if (table.isEmpty() || m_writers.isEmpty())
+        return 0;
+
+    const SpaceGrid& grid = m_selection->space();
+    const Lines& rows = *grid.rows();
+    const Lines& columns = *grid.columns();
+
+    // selected items are collected by column spans
+    QVector<SelectionPasteColumn> selectedColumns;
+    int selectedCount = 0;
+    for (int visibleColumn = 0, count = columns.visibleCount(); visibleColumn < count; ++visibleColumn)
+    {
+        SelectionPasteColumn column;
+        column.absColumn = columns.toAbsolute(visibleColumn);
+        column.visibleColumn = visibleColumn;
+
+        IdIteratorSelectedVisibleByColumn it(*m_selection, column.absColumn);
+        GridColumnSpan span;
+        while (it.fetchColumnSpan(span))
+        {
+            for (int absRow = span.firstRow; absRow < span.firstRow + span.rowsCount; ++absRow)
+                column.rows.append(qMakePair(rows.toVisible(absRow), absRow));
+        }
+
+        if (column.rows.isEmpty())
+            continue;
+
+        selectedCount += column.rows.size();
+        selectedColumns.append(column);
+    }
+
+    // ids and texts to write by absolute column
+    QHash<int, QPair<QVector<GridID>, QVector<QString>>> targets;
+    auto addTarget = [this, &table, &targets](int absColumn, int absRow, int tableRow, int tableColumn) {
+        if (!m_writers.contains(absColumn))
+            return;
+
+        const auto& row = table.rows[tableRow % table.rows.size()];
+        tableColumn %= table.columnsCount;
+        auto& target = targets[absColumn];
+        target.first.append(GridID(absRow, absColumn));
+        target.second.append(tableColumn < row.size() ? row[tableColumn] : QString());
+    };
+
+    if (selectedCount > 1)
+    {
+        // repeat table over selected items
+        int topRow = std::numeric_limits<int>::max();
+        for (const auto& column: selectedColumns)
+            topRow = qMin(topRow, column.rows.first().first);
+        int leftColumn = selectedColumns.first().visibleColumn;
+
+        for (const auto& column: selectedColumns)
+        {
+            for (const auto& row: column.rows)
+                addTarget(column.absColumn, row.second, row.first - topRow, column.visibleColumn - leftColumn);
+        }
+    }
+    else
+    {
+        // paste table once from the anchor item
+        GridID anchor = selectedCount == 1 ? GridID(selectedColumns.first().rows.first().first, selectedColumns.first().visibleColumn)
+                                           : m_selection->activeVisibleId();
+        if (!anchor.isValid())
+            return 0;
+
+        int rowsEnd = qMin(anchor.row + table.rows.size(), rows.visibleCount());
+        int columnsEnd = qMin(anchor.column + table.columnsCount, columns.visibleCount());
+        for (int visibleColumn = anchor.column; visibleColumn < columnsEnd; ++visibleColumn)
+        {
+            int absColumn = columns.toAbsolute(visibleColumn);
+            for (int visibleRow = anchor.row; visibleRow < rowsEnd; ++visibleRow)
+                addTarget(absColumn, rows.toAbsolute(visibleRow), visibleRow - anchor.row, visibleColumn - anchor.column);
+        }
+    }
+
+    // models shared by several columns are notified once too
+    QVector<SharedPtr<ModelUpdateGuard>> guards;
+    QSet<Model*> guardedModels;
+    for (auto it = targets.begin(); it != targets.end(); ++it)
+    {
+        Model* model = m_writers[it.key()].model.data();
+        if (!guardedModels.contains(model))
+        {
+            guardedModels.insert(model);
+            guards.append(makeShared<ModelUpdateGuard>(*model));
+        }
+    }
+
+    int written = 0;
+    for (auto it = targets.begin(); it != targets.end(); ++it)
+        written += m_writers[it.key()].write(it.value().first, it.value().second);
+
+    return written;
+}
+
+int SelectionPaste::pasteFromClipboard()
+{
+    return paste(QGuiApplication::clipboard()->text());
+}
+
+} // end namespace Qi
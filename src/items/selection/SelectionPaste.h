@@ -0,0 +1,109 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_SELECTION_PASTE_H
+#define QI_SELECTION_PASTE_H
+
+#include "core/ext/ModelTyped.h"
+#include "items/numeric/Numeric.h"
+#include "space/grid/GridID.h"
+#include <QHash>
+#include <functional>
+
+namespace Qi
+{
+
+class ModelSelection;
+
+// cells of pasted TSV text by rows, rows may have different count of cells
+struct QI_EXPORT SelectionPasteTable
+{
+    QVector<QVector<QString>> rows;
+    int columnsCount = 0;
+
+    bool isEmpty() const { return rows.isEmpty(); }
+};
+
+// pastes TSV text into models of selected visible items
+// if selection has several items the table is repeated over them starting
+// from the top left selected visible item, otherwise the table is pasted
+// to visible items starting from the selected or active item
+// each model gets one change notification per paste
+class QI_EXPORT SelectionPaste
+{
+    Q_DISABLE_COPY(SelectionPaste)
+
+public:
+    explicit SelectionPaste(SharedPtr<ModelSelection> selection);
+
+    const SharedPtr<ModelSelection>& selection() const { return m_selection; }
+
+    // texts pasted to absolute column are written to model as is
+    void setColumnModel(int column, SharedPtr<ModelTyped<QString>> model);
+    // texts pasted to absolute column are parsed as numbers (see ModelNumericText)
+    template <typename T>
+    void setColumnNumericModel(int column, SharedPtr<ModelTyped<T>> model);
+    void clearColumnModels();
+
+    // returns count of written items
+    int paste(const QString& text);
+    int pasteFromClipboard();
+
+    // splits text into cells, large texts are split by chunks of lines in parallel
+    static SelectionPasteTable parse(const QString& text);
+
+private:
+    struct ColumnWriter
+    {
+        SharedPtr<Model> model;
+        // writes texts to absolute items of the column
+        std::function<int(const QVector<GridID>& ids, const QVector<QString>& texts)> write;
+    };
+
+    // calls work for [begin, end) chunks of count items, in parallel if they are many
+    static void forChunks(int count, const std::function<void(int begin, int end)>& work);
+
+    SharedPtr<ModelSelection> m_selection;
+    QHash<int, ColumnWriter> m_writers;
+};
+
+template <typename T>
+void SelectionPaste::setColumnNumericModel(int column, SharedPtr<ModelTyped<T>> model)
+{
+    ColumnWriter writer;
+    writer.model = model;
+    writer.write = [model](const QVector<GridID>& ids, const QVector<QString>& texts) {
+        QVector<T> values(texts.size());
+        forChunks(texts.size(), [&values, &texts](int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                values[i] = Private::textToNumeric<T>(texts[i]);
+        });
+
+        int written = 0;
+        for (int i = 0; i < ids.size(); ++i)
+        {
+            if (model->setValue(ID(ids[i]), values[i]))
+                ++written;
+        }
+        return written;
+    };
+    m_writers.insert(column, writer);
+}
+
+} // end namespace Qi
+
+#endif // QI_SELECTION_PASTE_H
@@ -0,0 +1,296 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "SelectionSpans.h"
+#include "core/ext/Ranges.h"
+#include "space/grid/RangeGrid.h"
+#include <algorithm>
+#include <limits>
+
+namespace Qi
+{
+
+static const int MinLine = std::numeric_limits<int>::min();
+static const int MaxLine = std::numeric_limits<int>::max();
+
+static LinesSpans uniteSpans(const LinesSpans& left, const LinesSpans& right)
+{
+    LinesSpans result;
+    result.reserve(left.size() + right.size());
+
+    auto itLeft = left.begin();
+    auto itRight = right.begin();
+    while (itLeft != left.end() || itRight != right.end())
+    {
+        LinesSpan span;
+        if (itRight == right.end() || (itLeft != left.end() && itLeft->first < itRight->first))
+            span = *itLeft++;
+        else
+            span = *itRight++;
+
+        // merge overlapped or adjacent spans
+        if (!result.isEmpty() && (qint64)result.back().last + 1 >= span.first)
+            result.back().last = qMax(result.back().last, span.last);
+        else
+            result.append(span);
+    }
+
+    return result;
+}
+
+static LinesSpans subtractSpans(const LinesSpans& left, const LinesSpans& right)
+{
+    LinesSpans result;
+    result.reserve(left.size() + right.size());
+
+    auto itRight = right.begin();
+    for (LinesSpan span : left)
+    {
+        while (itRight != right.end() && itRight->last < span.first)
+            ++itRight;
+
+        bool isConsumed = false;
+        for (auto it = itRight; it != right.end() && it->first <= span.last; ++it)
+        {
+            if (it->first > span.first)
+                result.append({span.first, it->first - 1});
+
+            if (it->last >= span.last)
+            {
+                isConsumed = true;
+                break;
+            }
+
+            span.first = it->last + 1;
+        }
+
+        if (!isConsumed)
+            result.append(span);
+    }
+
+    return result;
+}
+
+SelectionSpans::SelectionSpans()
+{
+    clear();
+}
+
+void SelectionSpans::clear()
+{
+    m_bands.clear();
+    m_bands.append({MinLine, LinesSpans()});
+}
+
+bool SelectionSpans::addRange(const Range& range, bool exclude)
+{
+    if (qobject_cast<const RangeNone*>(&range))
+        return true;
+
+    if (qobject_cast<const RangeAll*>(&range))
+    {
+        apply(allSpans(), allSpans(), exclude);
+        return true;
+    }
+
+    if (auto rangeRect = qobject_cast<const RangeGridRect*>(&range))
+    {
+        apply(toSpans(rangeRect->rows()), toSpans(rangeRect->columns()), exclude);
+        return true;
+    }
+
+    if (auto rangeRows = qobject_cast<const RangeGridRows*>(&range))
+    {
+        apply(toSpans(rangeRows->rows()), allSpans(), exclude);
+        return true;
+    }
+
+    if (auto rangeColumns = qobject_cast<const RangeGridColumns*>(&range))
+    {
+        apply(allSpans(), toSpans(rangeColumns->columns()), exclude);
+        return true;
+    }
+
+    if (auto rangeRow = qobject_cast<const RangeGridRow*>(&range))
+    {
+        apply({{rangeRow->row(), rangeRow->row()}}, allSpans(), exclude);
+        return true;
+    }
+
+    if (auto rangeColumn = qobject_cast<const RangeGridColumn*>(&range))
+    {
+        apply(allSpans(), {{rangeColumn->column(), rangeColumn->column()}}, exclude);
+        return true;
+    }
+
+    if (auto rangeId = qobject_cast<const RangeID*>(&range))
+    {
+        auto id = rangeId->id().as<GridID>();
+        apply({{id.row, id.row}}, {{id.column, id.column}}, exclude);
+        return true;
+    }
+
+    return false;
+}
+
+bool SelectionSpans::hasItem(GridID id) const
+{
+    auto band = std::upper_bound(m_bands.begin(), m_bands.end(), id.row, [](int row, const Band& band) {
+        return row < band.firstRow;
+    });
+    Q_ASSERT(band != m_bands.begin());
+    --band;
+
+    const auto& columns = band->columns;
+    auto span = std::upper_bound(columns.begin(), columns.end(), id.column, [](int column, const LinesSpan& span) {
+        return column < span.first;
+    });
+    if (span == columns.begin())
+        return false;
+    --span;
+
+    return id.column <= span->last;
+}
+
+int SelectionSpans::bandLastRow(int bandIndex) const
+{
+    Q_ASSERT(bandIndex >= 0 && bandIndex < m_bands.size());
+    if (bandIndex + 1 == m_bands.size())
+        return MaxLine;
+
+    return m_bands[bandIndex + 1].firstRow - 1;
+}
+
+QRect SelectionSpans::differenceBounds(const SelectionSpans& left, const SelectionSpans& right, const QRect& bounds)
+{
+    QRect result;
+    if (bounds.isEmpty())
+        return result;
+
+    int leftIndex = 0;
+    int rightIndex = 0;
+    int row = MinLine;
+    for (;;)
+    {
+        int lastRow = qMin(left.bandLastRow(leftIndex), right.bandLastRow(rightIndex));
+
+        const auto& leftColumns = left.m_bands[leftIndex].columns;
+        const auto& rightColumns = right.m_bands[rightIndex].columns;
+        if (!(leftColumns == rightColumns))
+        {
+            auto difference = uniteSpans(subtractSpans(leftColumns, rightColumns), subtractSpans(rightColumns, leftColumns));
+            Q_ASSERT(!difference.isEmpty());
+
+            int firstRow = qMax(row, bounds.top());
+            int clippedLastRow = qMin(lastRow, bounds.bottom());
+            int firstColumn = qMax(difference.front().first, bounds.left());
+            int lastColumn = qMin(difference.back().last, bounds.right());
+            if (firstRow <= clippedLastRow && firstColumn <= lastColumn)
+                result |= QRect(QPoint(firstColumn, firstRow), QPoint(lastColumn, clippedLastRow));
+        }
+
+        if (lastRow == MaxLine)
+            break;
+
+        if (left.bandLastRow(leftIndex) == lastRow)
+            ++leftIndex;
+        if (right.bandLastRow(rightIndex) == lastRow)
+            ++rightIndex;
+        row = lastRow + 1;
+    }
+
+    return result;
+}
+
+LinesSpans SelectionSpans::toSpans(const QSet<int>& lines)
+{
+    QVector<int> sorted;
+    sorted.reserve(lines.size());
+    for (int line : lines)
+        sorted.append(line);
+    std::sort(sorted.begin(), sorted.end());
+
+    LinesSpans result;
+    for (int line : sorted)
+    {
+        if (!result.isEmpty() && result.back().last + 1 == line)
+            result.back().last = line;
+        else
+            result.append({line, line});
+    }
+
+    return result;
+}
+
+const LinesSpans& SelectionSpans::allSpans()
+{
+    static const LinesSpans spans = {{MinLine, MaxLine}};
+    return spans;
+}
+
+void SelectionSpans::apply(const LinesSpans& rows, const LinesSpans& columns, bool exclude)
+{
+    if (columns.isEmpty())
+        return;
+
+    for (const auto& rowsSpan : rows)
+    {
+        int bandFirst = splitBand(rowsSpan.first);
+        int bandEnd = (rowsSpan.last == MaxLine) ? m_bands.size() : splitBand(rowsSpan.last + 1);
+
+        for (int i = bandFirst; i < bandEnd; ++i)
+        {
+            auto& bandColumns = m_bands[i].columns;
+            bandColumns = exclude ? subtractSpans(bandColumns, columns) : uniteSpans(bandColumns, columns);
+        }
+    }
+
+    compactBands();
+}
+
+int SelectionSpans::splitBand(int row)
+{
+    auto band = std::upper_bound(m_bands.begin(), m_bands.end(), row, [](int row, const Band& band) {
+        return row < band.firstRow;
+    });
+    Q_ASSERT(band != m_bands.begin());
+
+    int index = (int)(band - m_bands.begin()) - 1;
+    if (m_bands[index].firstRow == row)
+        return index;
+
+    Band newBand = {row, m_bands[index].columns};
+    m_bands.insert(index + 1, newBand);
+    return index + 1;
+}
+
+void SelectionSpans::compactBands()
+{
+    // merge adjacent bands with the same columns
+    int j = 0;
+    for (int i = 1; i < m_bands.size(); ++i)
+    {
+        if (m_bands[i].columns == m_bands[j].columns)
+            continue;
+
+        ++j;
+        if (j != i)
+            m_bands[j] = std::move(m_bands[i]);
+    }
+    m_bands.resize(j + 1);
+}
+
+} // end namespace Qi
@@ -0,0 +1,79 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_SELECTION_SPANS_H
+#define QI_SELECTION_SPANS_H
+
+#include "core/Range.h"
+#include "space/grid/GridID.h"
+#include <QVector>
+#include <QRect>
+
+namespace Qi
+{
+
+// inclusive interval of lines
+struct QI_EXPORT LinesSpan
+{
+    int first;
+    int last;
+
+    bool operator==(const LinesSpan& other) const { return first == other.first && last == other.last; }
+};
+
+typedef QVector<LinesSpan> LinesSpans;
+
+// normalized grid selection as horizontal bands of rows
+// where each band has disjoint sorted spans of selected columns
+class QI_EXPORT SelectionSpans
+{
+public:
+    struct Band
+    {
+        // band covers rows from firstRow up to next band's firstRow
+        int firstRow;
+        LinesSpans columns;
+    };
+
+    SelectionSpans();
+
+    void clear();
+    // returns false if range cannot be represented by spans
+    bool addRange(const Range& range, bool exclude);
+    bool hasItem(GridID id) const;
+
+    const QVector<Band>& bands() const { return m_bands; }
+    // last row of the band (inclusive)
+    int bandLastRow(int bandIndex) const;
+
+    // bounds of items with different selected state clipped by bounds
+    // where x is column and y is row
+    static QRect differenceBounds(const SelectionSpans& left, const SelectionSpans& right, const QRect& bounds);
+
+    static LinesSpans toSpans(const QSet<int>& lines);
+    static const LinesSpans& allSpans();
+
+private:
+    void apply(const LinesSpans& rows, const LinesSpans& columns, bool exclude);
+    int splitBand(int row);
+    void compactBands();
+
+    QVector<Band> m_bands;
+};
+
+} // end namespace Qi
+
+#endif // QI_SELECTION_SPANS_H
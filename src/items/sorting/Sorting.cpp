@@ -16,21 +16,75 @@
 
 #include "Sorting.h"
 #include "space/grid/SpaceGrid.h"
+#include "core/ext/ModelTyped.h"
+#include "utils/CallLater.h"
+#include "utils/Trace.h"
+#include <QGuiApplication>
+#include <QTimer>
+#include "utils/TaskPool.h"
+#include <atomic>
+#include <algorithm>
+#include <iterator>
 
 namespace Qi
 {
 
+// sorting in background thread
+struct ModelGridSortingBase::SortingJob
+{
+    SharedPtr<ModelSortKeys> keys;
+    QVector<int> lines;
+    // relative positions of lines if visible rows are sorted only
+    QVector<int> positions;
+    quint64 rowsVersion = 0;
+    GridID id;
+    quint64 modelVersion = 0;
+    bool ascending = true;
+    bool sorted = false;
+    TaskToken token;
+    std::atomic<int> progress { 0 };
+};
+
+// interval to update sorting progress
+static const int SortingProgressInterval = 100;
+
 ModelGridSortingBase::ModelGridSortingBase(SharedPtr<SpaceGrid> grid)
     : m_grid(std::move(grid)),
       m_ascending(false),
-      m_sortingExpired(false)
+      m_sortingExpired(false),
+      m_parallel(false),
+      m_async(false),
+      m_incremental(false),
+      m_visibleOnly(false),
+      m_progressiveRows(0),
+      m_itemResorted(false),
+      m_lastSortedRowsVersion(0),
+      m_sortingCacheSize(0),
+      m_progressTimer(new QTimer(this))
+{
+    m_lastSorted.ascending = false;
+    m_lastSorted.modelVersion = 0;
+
+    m_progressTimer->setInterval(SortingProgressInterval);
+    connect(m_progressTimer, &QTimer::timeout, this, &ModelGridSortingBase::onSortingTimeout);
+    connect(m_grid->rows().data(), &Lines::linesChanged, this, &ModelGridSortingBase::onRowsChanged);
+}
+
+ModelGridSortingBase::~ModelGridSortingBase()
 {
+    // worker thread owns job and keys so it's safe to leave it
+    cancelSorting();
 }
 
 void ModelGridSortingBase::clearActiveSortingId()
 {
+    if (!m_activeSortingId.isValid() && m_secondarySortings.isEmpty())
+        return;
+
+    cancelSorting();
     m_activeSortingId = GridID();
-    emit modelChanged(this);
+    m_secondarySortings.clear();
+    notifyChanged();
 }
 
 void ModelGridSortingBase::setSorting(GridID id, bool ascending)
@@ -41,6 +95,8 @@ void ModelGridSortingBase::setSorting(GridID id, bool ascending)
     m_activeSortingId = id;
     m_ascending = ascending;
     m_sortingExpired = true;
+    // single column sorting replaces the multi-column one
+    m_secondarySortings.clear();
 }
 
 bool ModelGridSortingBase::sort()
@@ -50,6 +106,8 @@ bool ModelGridSortingBase::sort()
 
 bool ModelGridSortingBase::sortByItem(GridID id)
 {
+    m_secondarySortings.clear();
+
     if (m_activeSortingId == id)
         return sortByItem(id, m_sortingExpired ? m_ascending : !m_ascending);
     else
@@ -69,14 +127,7 @@ bool ModelGridSortingBase::defaultSortByItem(GridID id)
     m_ascending = model->isAscendingDefault(ID(id));
     m_sortingExpired = false;
 
-    emit willSortItems(this);
-
-    m_grid->sortColumnByModel(id.column, *model, m_ascending, true);
-
-    emit didSortItems(this);
-    emit modelChanged(this);
-
-    return true;
+    return sortByModel(id, *model);
 }
 
 bool ModelGridSortingBase::sortByItem(GridID id, bool ascending)
@@ -92,23 +143,464 @@ bool ModelGridSortingBase::sortByItem(GridID id, bool ascending)
     m_ascending = ascending;
     m_sortingExpired = false;
 
+    return sortByModel(id, *model);
+}
+
+bool ModelGridSortingBase::addSecondarySorting(GridID id)
+{
+    if (!m_activeSortingId.isValid() || m_sortingExpired)
+        return sortByItem(id);
+
+    if (id == m_activeSortingId)
+        return sortByItem(id, !m_ascending);
+
+    auto model = sortingModel(id);
+    if (!model || !id.isValid())
+        return false;
+
+    auto it = std::find_if(m_secondarySortings.begin(), m_secondarySortings.end(), [id](const SecondarySorting& sorting) {
+        return sorting.id == id;
+    });
+    if (it != m_secondarySortings.end())
+    {
+        it->ascending = !it->ascending;
+    }
+    else
+    {
+        SecondarySorting sorting = { id, model->isAscendingDefault(ID(id)) };
+        m_secondarySortings.append(sorting);
+    }
+
+    return sort();
+}
+
+void ModelGridSortingBase::clearSecondarySorting()
+{
+    if (m_secondarySortings.isEmpty())
+        return;
+
+    m_secondarySortings.clear();
+    notifyChanged();
+}
+
+int ModelGridSortingBase::sortingRank(GridID id) const
+{
+    if (!m_activeSortingId.isValid() || m_sortingExpired)
+        return -1;
+
+    if (id == m_activeSortingId)
+        return 0;
+
+    for (int i = 0; i < m_secondarySortings.size(); ++i)
+    {
+        if (m_secondarySortings[i].id == id)
+            return i + 1;
+    }
+
+    return -1;
+}
+
+bool ModelGridSortingBase::isAscending(GridID id) const
+{
+    for (const auto& sorting : m_secondarySortings)
+    {
+        if (sorting.id == id)
+            return sorting.ascending;
+    }
+
+    return m_ascending;
+}
+
+void ModelGridSortingBase::setSortingCacheSize(int size)
+{
+    m_sortingCacheSize = qMax(0, size);
+    if (m_sortingCache.size() > m_sortingCacheSize)
+        m_sortingCache.resize(m_sortingCacheSize);
+}
+
+int ModelGridSortingBase::sortingProgress() const
+{
+    return m_job ? m_job->progress.load() : 0;
+}
+
+void ModelGridSortingBase::cancelSorting()
+{
+    if (!m_job)
+        return;
+
+    m_job->token.cancel();
+    m_job.reset();
+    m_progressTimer->stop();
+}
+
+bool ModelGridSortingBase::sortByModel(GridID id, const ModelComparable& model)
+{
+    // new sorting replaces previous one
+    cancelSorting();
+
+    if (!m_secondarySortings.isEmpty())
+        return sortByKeys();
+
+    if (sortBySortedRows(id, model))
+        return true;
+
+    if (m_async && startSorting(id, model))
+    {
+        notifyChanged();
+        return true;
+    }
+
+    emit willSortItems(this);
+
+    m_grid->sortColumnByModel(id.column, model, m_ascending, true, m_parallel, m_visibleOnly);
+    onRowsSorted(id, m_ascending, model.version());
+
+    emit didSortItems(this);
+    notifyChanged();
+
+    return true;
+}
+
+// reverses order of runs of equal lines keeping order within runs,
+// so result is the same as stable sorting in opposite direction
+template <typename Equal>
+static void reverseSortedLines(QVector<int>& lines, const Equal& equal)
+{
+    std::reverse(lines.begin(), lines.end());
+
+    auto runStart = lines.begin();
+    for (auto it = lines.begin(); it != lines.end(); ++it)
+    {
+        auto next = it + 1;
+        if (next == lines.end() || !equal(*it, *next))
+        {
+            std::reverse(runStart, next);
+            runStart = next;
+        }
+    }
+}
+
+bool ModelGridSortingBase::sortBySortedRows(GridID id, const ModelComparable& model)
+{
+    const Lines& rows = *m_grid->rows();
+    int column = id.column;
+    if (column >= m_grid->columns()->count())
+        return false;
+
+    QVector<int> positions;
+    QVector<int> lines;
+    bool ascending = false;
+    if (m_lastSorted.id == id && m_lastSorted.modelVersion == model.version() && m_lastSortedRowsVersion == rows.version())
+    {
+        // rows are sorted by the item already
+        if (m_visibleOnly)
+        {
+            positions = rows.visibleRelativePositions();
+            lines = rows.permutationAt(positions);
+        }
+        else
+            lines = rows.permutation();
+        ascending = m_lastSorted.ascending;
+    }
+    else if (m_visibleOnly)
+    {
+        // cached orders are made for other visible rows
+        return false;
+    }
+    else
+    {
+        auto it = std::find_if(m_sortingCache.begin(), m_sortingCache.end(), [id, &model, &rows](const SortedRows& sorted) {
+            return sorted.id == id && sorted.modelVersion == model.version() && sorted.permutation.size() == rows.count();
+        });
+        if (it == m_sortingCache.end())
+            return false;
+
+        lines = it->permutation;
+        ascending = it->ascending;
+    }
+
+    if (ascending != m_ascending)
+    {
+        reverseSortedLines(lines, [&model, column](int left, int right) {
+            return model.compareAs(GridID(left, column), GridID(right, column)) == 0;
+        });
+    }
+
     emit willSortItems(this);
 
-    m_grid->sortColumnByModel(id.column, *model, m_ascending, true);
+    if (m_visibleOnly)
+    {
+        m_grid->rows()->setPermutationAt(positions, lines);
+        setSortedRows(id, m_ascending, model.version(), QVector<int>());
+    }
+    else
+    {
+        m_grid->rows()->setPermutation(lines);
+        setSortedRows(id, m_ascending, model.version(), std::move(lines));
+    }
 
     emit didSortItems(this);
-    emit modelChanged(this);
+    notifyChanged();
 
     return true;
 }
 
+void ModelGridSortingBase::setSortedRows(GridID id, bool ascending, quint64 modelVersion, QVector<int> permutation)
+{
+    m_lastSorted.id = id;
+    m_lastSorted.ascending = ascending;
+    m_lastSorted.modelVersion = modelVersion;
+    m_lastSortedRowsVersion = m_grid->rows()->version();
+
+    if (m_sortingCacheSize == 0 || permutation.isEmpty())
+        return;
+
+    // one entry per item, the most recent first
+    auto it = std::find_if(m_sortingCache.begin(), m_sortingCache.end(), [id](const SortedRows& sorted) {
+        return sorted.id == id;
+    });
+    if (it != m_sortingCache.end())
+        m_sortingCache.erase(it);
+    else if (m_sortingCache.size() == m_sortingCacheSize)
+        m_sortingCache.removeLast();
+
+    SortedRows sorted = m_lastSorted;
+    sorted.permutation = std::move(permutation);
+    m_sortingCache.prepend(std::move(sorted));
+}
+
+void ModelGridSortingBase::onRowsSorted(GridID id, bool ascending, quint64 modelVersion)
+{
+    bool isCached = m_sortingCacheSize > 0 && !m_visibleOnly;
+    setSortedRows(id, ascending, modelVersion, isCached ? m_grid->rows()->permutation() : QVector<int>());
+}
+
+// dense ascending ranks of rows by one sorting item, equal rows share rank
+// returns count of distinct ranks
+static int rankRows(const QVector<int>& lines, int linesCount, int column, const ModelComparable& model, QVector<int>& ranks)
+{
+    auto lineToId = [column](int row) { return ID(GridID(row, column)); };
+    auto compare = [&model, column](int left, int right) {
+        return model.compareAs(GridID(left, column), GridID(right, column));
+    };
+
+    QVector<int> sorted = lines;
+    if (!model.sortLines(sorted, lineToId, true))
+        std::stable_sort(sorted.begin(), sorted.end(), [&compare](int left, int right) { return compare(left, right) < 0; });
+
+    // ranks are indexed by absolute rows
+    ranks.resize(linesCount);
+    int rank = 0;
+    for (int i = 0; i < sorted.size(); ++i)
+    {
+        if (i > 0 && compare(sorted[i - 1], sorted[i]) != 0)
+            ++rank;
+        ranks[sorted[i]] = rank;
+    }
+
+    return rank + 1;
+}
+
+static int bitsCount(int values)
+{
+    int bits = 0;
+    while (bits < 32 && (1u << bits) < uint(values))
+        ++bits;
+    return bits;
+}
+
+bool ModelGridSortingBase::sortByKeys()
+{
+    QI_TRACE_SCOPE(TraceCategorySort, "ModelGridSortingBase::sortByKeys");
+    QVector<SecondarySorting> sortings;
+    SecondarySorting activeSorting = { m_activeSortingId, m_ascending };
+    sortings.append(activeSorting);
+    sortings += m_secondarySortings;
+
+    const Lines& rows = *m_grid->rows();
+    QVector<int> positions;
+    if (m_visibleOnly)
+        positions = rows.visibleRelativePositions();
+    QVector<int> lines = m_visibleOnly ? rows.permutationAt(positions) : rows.permutation();
+    if (lines.isEmpty())
+        return false;
+
+    // rank each key once, keys are compared as integers after that
+    QVector<QVector<int>> ranks(sortings.size());
+    QVector<int> ranksCount(sortings.size());
+    QVector<int> ranksBits(sortings.size());
+    int bits = 0;
+    for (int k = 0; k < sortings.size(); ++k)
+    {
+        auto model = sortingModel(sortings[k].id);
+        if (!model)
+            return false;
+
+        ranksCount[k] = rankRows(lines, rows.count(), sortings[k].id.column, *model, ranks[k]);
+        if (!sortings[k].ascending)
+        {
+            for (int& rank : ranks[k])
+                rank = ranksCount[k] - 1 - rank;
+        }
+        ranksBits[k] = bitsCount(ranksCount[k]);
+        bits += ranksBits[k];
+    }
+
+    if (bits <= 64)
+    {
+        // pack ranks into one key, active sorting item is most significant
+        std::vector<std::pair<quint64, int>> keys;
+        keys.reserve(lines.size());
+        for (int line : lines)
+        {
+            quint64 key = 0;
+            for (int k = 0; k < sortings.size(); ++k)
+                key = (key << ranksBits[k]) | quint64(ranks[k][line]);
+            keys.emplace_back(key, line);
+        }
+
+        ModelSortKeysTyped<quint64>(std::move(keys)).sort(true, lines);
+    }
+    else
+    {
+        std::stable_sort(lines.begin(), lines.end(), [&ranks](int left, int right) {
+            for (const auto& keyRanks : ranks)
+            {
+                if (keyRanks[left] != keyRanks[right])
+                    return keyRanks[left] < keyRanks[right];
+            }
+            return false;
+        });
+    }
+
+    emit willSortItems(this);
+    if (m_visibleOnly)
+        m_grid->rows()->setPermutationAt(positions, lines);
+    else
+        m_grid->rows()->setPermutation(lines);
+    emit didSortItems(this);
+    notifyChanged();
+
+    return true;
+}
+
+bool ModelGridSortingBase::startSorting(GridID id, const ModelComparable& model)
+{
+    int column = id.column;
+    if (column >= m_grid->columns()->count())
+        return false;
+
+    // snapshot model values in GUI thread
+    const Lines& rows = *m_grid->rows();
+    QVector<int> positions;
+    if (m_visibleOnly && rows.visibleCount() != rows.count())
+        positions = rows.visibleRelativePositions();
+    QVector<int> lines = positions.isEmpty() ? rows.permutation() : rows.permutationAt(positions);
+    auto keys = model.sortKeys(lines, [column](int row) { return ID(GridID(row, column)); });
+    if (!keys)
+        return false;
+
+    auto job = makeShared<SortingJob>();
+    job->keys = std::move(keys);
+    job->lines = std::move(lines);
+    job->positions = std::move(positions);
+    job->rowsVersion = rows.version();
+    job->id = id;
+    job->modelVersion = model.version();
+    job->ascending = m_ascending;
+
+    // first rows are final already, full permutation is swapped in when ready
+    if (m_progressiveRows > 0 && m_progressiveRows < job->lines.size() && job->positions.isEmpty())
+    {
+        const int sign = m_ascending ? 1 : -1;
+        emit willSortItems(this);
+        m_grid->rows()->sortTop(m_progressiveRows, [&model, column, sign](int left, int right) {
+            return sign * model.compareAs(GridID(left, column), GridID(right, column)) < 0;
+        });
+        emit didSortItems(this);
+    }
+
+    // rows order is visible to user
+    TaskPool::instance().run(this, [job]() {
+        job->sorted = job->keys->sort(job->ascending, job->lines, [&job](int percent) {
+            job->progress = percent;
+            return !job->token.isCancelled();
+        });
+        // release values as soon as possible
+        job->keys.reset();
+    }, [this, job]() {
+        onSortingFinished(job);
+    }, TaskPriorityVisible, job->token);
+
+    m_job = job;
+    m_progressTimer->start();
+
+    return true;
+}
+
+void ModelGridSortingBase::onSortingFinished(const SharedPtr<SortingJob>& job)
+{
+    // sorting was cancelled or replaced
+    if (m_job != job)
+        return;
+
+    m_job.reset();
+    m_progressTimer->stop();
+
+    // rows were added or removed while sorting
+    // sorted visible rows are valid for the same rows state only
+    bool isVisibleOnly = !job->positions.isEmpty();
+    if (!job->sorted || (isVisibleOnly ? job->rowsVersion != m_grid->rows()->version() : job->lines.size() != m_grid->rows()->count()))
+    {
+        notifyChanged();
+        return;
+    }
+
+    emit willSortItems(this);
+
+    if (isVisibleOnly)
+        m_grid->rows()->setPermutationAt(job->positions, job->lines);
+    else
+        m_grid->rows()->setPermutation(job->lines);
+    // result follows model values at the moment of snapshot
+    onRowsSorted(job->id, job->ascending, job->modelVersion);
+
+    emit didSortItems(this);
+    notifyChanged();
+}
+
+void ModelGridSortingBase::onRowsChanged(const Lines* /*rows*/, ChangeReason reason)
+{
+    if (!m_visibleOnly || !(reason & ChangeReasonLinesVisibility) || !activeSortingId().isValid())
+        return;
+
+    // rows shown after sorting are placed by sorting visible rows again
+    callLaterOnce(this, "resortVisibleRows", [this]() {
+        if (m_visibleOnly && activeSortingId().isValid())
+            sort();
+    });
+}
+
+void ModelGridSortingBase::onSortingTimeout()
+{
+    if (!m_job)
+        return;
+
+    emit sortingProgressChanged(this, m_job->progress);
+    notifyChanged();
+}
+
 void ModelGridSortingBase::connectModel(const Model* model)
 {
+    connect(model, &Model::modelItemChanged, this, &ModelGridSortingBase::onSortingModelItemChanged);
+    connect(model, &Model::modelItemsChanged, this, &ModelGridSortingBase::onSortingModelItemsChanged);
     connect(model, &Model::modelChanged, this, &ModelGridSortingBase::onSortingModelChanged);
 }
 
 void ModelGridSortingBase::disconnectModel(const Model* model)
 {
+    disconnect(model, &Model::modelItemChanged, this, &ModelGridSortingBase::onSortingModelItemChanged);
+    disconnect(model, &Model::modelItemsChanged, this, &ModelGridSortingBase::onSortingModelItemsChanged);
     disconnect(model, &Model::modelChanged, this, &ModelGridSortingBase::onSortingModelChanged);
 }
 
@@ -117,13 +609,175 @@ void ModelGridSortingBase::onSortingModelChanged(const Model* model)
     if (!m_activeSortingId.isValid())
         return;
 
+    // edited item was moved to sorted position
+    if (m_itemResorted)
+    {
+        m_itemResorted = false;
+        return;
+    }
+
     if (sortingModel(m_activeSortingId).data() == model)
     {
         // mark sorting as expired
         m_sortingExpired = true;
+        return;
+    }
+
+    for (const auto& sorting : m_secondarySortings)
+    {
+        if (sortingModel(sorting.id).data() == model)
+        {
+            m_sortingExpired = true;
+            return;
+        }
     }
 }
 
+void ModelGridSortingBase::onSortingModelItemChanged(const Model* model, ID id)
+{
+    m_itemResorted = false;
+
+    // edited row may move by any of sorting keys
+    if (!m_incremental || m_sortingExpired || isSorting() || !m_activeSortingId.isValid() || !m_secondarySortings.isEmpty())
+        return;
+
+    auto activeModel = sortingModel(m_activeSortingId);
+    if (activeModel.data() != model)
+        return;
+
+    m_itemResorted = resortRow(id.as<GridID>().row, *activeModel);
+}
+
+void ModelGridSortingBase::onSortingModelItemsChanged(const Model* model, const QVector<ID>& ids)
+{
+    m_itemResorted = false;
+
+    if (!m_incremental || m_sortingExpired || isSorting() || !m_activeSortingId.isValid() || !m_secondarySortings.isEmpty())
+        return;
+
+    auto activeModel = sortingModel(m_activeSortingId);
+    if (activeModel.data() != model)
+        return;
+
+    // items out of sorting column keep rows order
+    QVector<int> rows;
+    for (ID id : ids)
+    {
+        GridID gridId = id.as<GridID>();
+        if (gridId.column == m_activeSortingId.column)
+            rows.append(gridId.row);
+    }
+
+    // many edited rows are cheaper to sort again
+    if (rows.size() > IncrementalRowsMax)
+        return;
+
+    m_itemResorted = rows.isEmpty() || resortRows(rows, *activeModel);
+}
+
+bool ModelGridSortingBase::resortRow(int row, const ModelComparable& model)
+{
+    const auto& lines = m_grid->rows()->permutation();
+    if (row < 0 || row >= lines.size())
+        return false;
+
+    const int pos = int(std::find(lines.begin(), lines.end(), row) - lines.begin());
+    const int column = m_activeSortingId.column;
+    const int sign = m_ascending ? 1 : -1;
+
+    // compares rows in sorting order
+    auto compare = [&model, column, sign](int left, int right) {
+        return sign * model.compareAs(GridID(left, column), GridID(right, column));
+    };
+    // other rows are still sorted, index skips edited row
+    auto other = [&lines, pos](int index) {
+        return lines[index < pos ? index : index + 1];
+    };
+
+    // equal range of edited row among other rows
+    int lower = 0;
+    int upper = lines.size() - 1;
+    while (lower < upper)
+    {
+        int middle = (lower + upper) / 2;
+        if (compare(other(middle), row) < 0)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+
+    int first = lower;
+    upper = lines.size() - 1;
+    while (lower < upper)
+    {
+        int middle = (lower + upper) / 2;
+        if (compare(row, other(middle)) < 0)
+            upper = middle;
+        else
+            lower = middle + 1;
+    }
+
+    // stable sorting keeps order of equal rows
+    int newPos = qBound(first, pos, lower);
+    if (newPos != pos)
+    {
+        emit willSortItems(this);
+        m_grid->rows()->moveLines(row, newPos);
+        emit didSortItems(this);
+    }
+
+    return true;
+}
+
+bool ModelGridSortingBase::resortRows(const QVector<int>& rows, const ModelComparable& model)
+{
+    if (rows.size() == 1)
+        return resortRow(rows.first(), model);
+
+    const auto& lines = m_grid->rows()->permutation();
+
+    QVector<bool> isEdited(lines.size(), false);
+    for (int row : rows)
+    {
+        if (row < 0 || row >= lines.size())
+            return false;
+        isEdited[row] = true;
+    }
+
+    const int column = m_activeSortingId.column;
+    const int sign = m_ascending ? 1 : -1;
+    auto less = [&model, column, sign](int left, int right) {
+        return sign * model.compareAs(GridID(left, column), GridID(right, column)) < 0;
+    };
+
+    // other rows are still sorted, edited rows are sorted
+    // in their current order and merged into them
+    QVector<int> others;
+    QVector<int> edited;
+    others.reserve(lines.size());
+    for (int line : lines)
+    {
+        if (isEdited[line])
+            edited.append(line);
+        else
+            others.append(line);
+    }
+    std::stable_sort(edited.begin(), edited.end(), less);
+
+    QVector<int> permutation;
+    permutation.reserve(lines.size());
+    std::merge(others.begin(), others.end(), edited.begin(), edited.end(), std::back_inserter(permutation), less);
+
+    if (permutation != lines)
+    {
+        emit willSortItems(this);
+        m_grid->rows()->setPermutation(permutation);
+        emit didSortItems(this);
+    }
+
+    return true;
+}
+
 ModelGridSorting::ModelGridSorting(SharedPtr<SpaceGrid> grid)
     : ModelGridSortingBase(std::move(grid))
 {
@@ -281,7 +935,7 @@ ViewGridSorting::ViewGridSorting(SharedPtr<ModelGridSortingBase> model, bool use
 {
     if (useDefaultController)
     {
-        setController(makeShared<ControllerMouseGridSorting>(theModel()));
+        setControllerLazy([this]() { return makeShared<ControllerMouseGridSorting>(theModel()); });
     }
 }
 
@@ -291,14 +945,28 @@ void ViewGridSorting::drawImpl(QPainter* painter, const GuiContext& ctx, const C
     rect.adjust(4, 4, -4, -4);
     painter->drawRoundedRect(rect, 20.f, 20.f, Qt::RelativeSize);
 
-    if (theModel()->activeSortingId() == cache.id.as<GridID>())
+    GridID id = cache.id.as<GridID>();
+    int rank = theModel()->sortingRank(id);
+    if (rank >= 0)
     {
+        if (rank == 0 && theModel()->isSorting())
+        {
+            // draw background sorting progress
+            QRect progressRect = rect;
+            progressRect.setWidth((rect.width() * theModel()->sortingProgress()) / 100);
+            painter->fillRect(progressRect, ctx.palette().highlight());
+        }
+
         QStyleOptionHeader option;
         ctx.initStyleOption(option);
-        option.sortIndicator = theModel()->isAscending() ? QStyleOptionHeader::SortUp : QStyleOptionHeader::SortDown;
+        option.sortIndicator = theModel()->isAscending(id) ? QStyleOptionHeader::SortUp : QStyleOptionHeader::SortDown;
         option.rect = rect;
 
         ctx.style()->drawPrimitive(QStyle::PE_IndicatorHeaderArrow, &option, painter, ctx.widget);
+
+        // order of keys for multi-column sorting
+        if (theModel()->secondarySortingCount() > 0)
+            painter->drawText(rect, Qt::AlignLeft | Qt::AlignVCenter, QString::number(rank + 1));
     }
 
     if (showTooltip) *showTooltip = true;
@@ -306,13 +974,16 @@ void ViewGridSorting::drawImpl(QPainter* painter, const GuiContext& ctx, const C
 
 bool ViewGridSorting::tooltipTextImpl(ID id, QString& txt) const
 {
-    if (theModel()->activeSortingId() == id.as<GridID>())
+    int rank = theModel()->sortingRank(id.as<GridID>());
+    if (rank >= 0)
     {
-        txt = theModel()->isAscending() ? "Ascending" : "Descending";
+        txt = theModel()->isAscending(id.as<GridID>()) ? "Ascending" : "Descending";
+        if (theModel()->secondarySortingCount() > 0)
+            txt += QString(" (%1)").arg(rank + 1);
     }
     else
     {
-        txt = "Click to sort";
+        txt = "Click to sort, Ctrl+Click to add sorting key";
     }
 
     return true;
@@ -325,7 +996,11 @@ ControllerMouseGridSorting::ControllerMouseGridSorting(SharedPtr<ModelGridSortin
 
 void ControllerMouseGridSorting::applyImpl()
 {
-    m_model->sortByItem(activationState().id.as<GridID>());
+    GridID id = activationState().id.as<GridID>();
+    if (QGuiApplication::keyboardModifiers() & Qt::ControlModifier)
+        m_model->addSecondarySorting(id);
+    else
+        m_model->sortByItem(id);
 }
 
 } // end namespace Qi
@@ -23,11 +23,14 @@
 #include "core/ext/ControllerMouseCaptured.h"
 #include "space/grid/GridID.h"
 
+class QTimer;
+
 namespace Qi
 {
 
 class ModelComparable;
 class Range;
+class Lines;
 class SpaceGrid;
 
 class QI_EXPORT ModelGridSortingBase: public Model
@@ -37,6 +40,7 @@ class QI_EXPORT ModelGridSortingBase: public Model
 
 public:
     ModelGridSortingBase(SharedPtr<SpaceGrid> grid);
+    virtual ~ModelGridSortingBase();
 
     SharedPtr<ModelComparable> sortingModel(GridID id) const { return sortingModelImpl(id); }
 
@@ -50,9 +54,56 @@ public:
     bool defaultSortByItem(GridID id);
     bool sortByItem(GridID id, bool ascending);
 
+    // rows equal by active sorting item are ordered by secondary items
+    // sortByItem(id) clicks start new sorting without secondary items
+    int secondarySortingCount() const { return m_secondarySortings.size(); }
+    GridID secondarySortingId(int index) const { return m_secondarySortings[index].id; }
+    // adds item as next sorting key or toggles its order and resorts
+    bool addSecondarySorting(GridID id);
+    void clearSecondarySorting();
+    // 0 for active sorting item, 1 and more for secondary items, -1 otherwise
+    int sortingRank(GridID id) const;
+    bool isAscending(GridID id) const;
+
+    // sort in several threads if sorting model is thread safe
+    bool isParallel() const { return m_parallel; }
+    void setParallel(bool parallel) { m_parallel = parallel; }
+
+    // sort in background thread if sorting model can snapshot its values
+    bool isAsync() const { return m_async; }
+    void setAsync(bool async) { m_async = async; }
+
+    // sorts first rows in GUI thread before background sorting finishes
+    // rows should cover viewport with some margin, 0 disables it
+    int progressiveRows() const { return m_progressiveRows; }
+    void setProgressiveRows(int rows) { m_progressiveRows = qMax(0, rows); }
+
+    // sort visible rows only, hidden rows keep their relative positions
+    // and are placed by sorting again once some rows become visible
+    bool isVisibleOnly() const { return m_visibleOnly; }
+    void setVisibleOnly(bool visibleOnly) { m_visibleOnly = visibleOnly; }
+
+    // resort edited rows only instead of marking sorting as expired,
+    // batches with more than IncrementalRowsMax rows edited in sorting column expire sorting
+    enum { IncrementalRowsMax = 64 };
+    bool isIncremental() const { return m_incremental; }
+    void setIncremental(bool incremental) { m_incremental = incremental; }
+
+    // keeps rows order of last sortings by single item and restores it
+    // instead of sorting again while sorting model has the same version,
+    // rows equal by the item keep order they had when sorted, 0 disables it
+    int sortingCacheSize() const { return m_sortingCacheSize; }
+    void setSortingCacheSize(int size);
+
+    // background sorting state
+    bool isSorting() const { return !m_job.isNull(); }
+    int sortingProgress() const;
+    void cancelSorting();
+
 signals:
     void willSortItems(const ModelGridSortingBase*);
     void didSortItems(const ModelGridSortingBase*);
+    void sortingProgressChanged(const ModelGridSortingBase*, int percent);
 
 protected:
     virtual SharedPtr<ModelComparable> sortingModelImpl(GridID /*id*/) const = 0;
@@ -61,12 +112,60 @@ protected:
     void disconnectModel(const Model* model);
 
 private:
+    struct SortingJob;
+    struct SecondarySorting
+    {
+        GridID id;
+        bool ascending;
+    };
+    struct SortedRows
+    {
+        GridID id;
+        bool ascending;
+        quint64 modelVersion;
+        QVector<int> permutation;
+    };
+
+    bool sortByModel(GridID id, const ModelComparable& model);
+    bool sortByKeys();
+    bool startSorting(GridID id, const ModelComparable& model);
+    void onSortingFinished(const SharedPtr<SortingJob>& job);
+    void onSortingTimeout();
     void onSortingModelChanged(const Model* model);
+    void onSortingModelItemChanged(const Model* model, ID id);
+    void onSortingModelItemsChanged(const Model* model, const QVector<ID>& ids);
+    void onRowsChanged(const Lines* rows, ChangeReason reason);
+    bool resortRow(int row, const ModelComparable& model);
+    // edited rows may be in any order and contain duplicates
+    bool resortRows(const QVector<int>& rows, const ModelComparable& model);
+    // reverses current or cached rows order instead of sorting
+    bool sortBySortedRows(GridID id, const ModelComparable& model);
+    void setSortedRows(GridID id, bool ascending, quint64 modelVersion, QVector<int> permutation);
+    void onRowsSorted(GridID id, bool ascending, quint64 modelVersion);
 
     SharedPtr<SpaceGrid> m_grid;
     bool m_ascending;
     GridID m_activeSortingId;
     bool m_sortingExpired;
+    bool m_parallel;
+    bool m_async;
+    bool m_incremental;
+    bool m_visibleOnly;
+    int m_progressiveRows;
+    // sorting is still valid after last model change
+    bool m_itemResorted;
+
+    QVector<SecondarySorting> m_secondarySortings;
+
+    // rows were sorted by m_lastSorted item and weren't changed since then
+    SortedRows m_lastSorted;
+    quint64 m_lastSortedRowsVersion;
+    // most recently used first
+    QVector<SortedRows> m_sortingCache;
+    int m_sortingCacheSize;
+
+    SharedPtr<SortingJob> m_job;
+    QTimer* m_progressTimer;
 };
 
 class QI_EXPORT ModelGridSorting: public ModelGridSortingBase
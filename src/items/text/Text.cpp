@@ -15,21 +15,198 @@
 */
 
 #include "Text.h"
+#include "utils/TextWidthCache.h"
+#include "utils/InplaceEditing.h"
 #include <QStyleOptionViewItem>
 #include <QLineEdit>
+#include <QStaticText>
+#include <QTextLayout>
+#include <QGlyphRun>
+#include <algorithm>
 
 namespace Qi
 {
 
+// shaped text of a cache view
+// valid until text, font, rect size or drawing options are changed
+class TextDrawData: public CacheViewDrawData
+{
+public:
+    QString text;
+    QFont font;
+    QSize size;
+    Qt::TextElideMode elideMode;
+    Qt::Alignment alignment;
+
+    QStaticText staticText;
+    bool isElided;
+
+    // glyphs of staticText text relative to top left point, shaped on first batch draw
+    QList<QGlyphRun> glyphRuns;
+    bool isGlyphRunsShaped = false;
+
+    const QList<QGlyphRun>& shapedGlyphRuns()
+    {
+        if (!isGlyphRunsShaped)
+        {
+            QTextLayout layout(staticText.text(), font);
+            layout.beginLayout();
+            QTextLine line = layout.createLine();
+            if (line.isValid())
+                line.setPosition(QPointF(0, 0));
+            layout.endLayout();
+
+            glyphRuns = layout.glyphRuns();
+            isGlyphRunsShaped = true;
+        }
+
+        return glyphRuns;
+    }
+
+    bool isValid(const QString& text, const QFont& font, const QSize& size, Qt::TextElideMode elideMode, Qt::Alignment alignment) const
+    {
+        return this->size == size && this->elideMode == elideMode && this->alignment == alignment
+                && this->text == text && this->font == font;
+    }
+
+    // top left point of the text aligned within rect
+    QPoint position(const QRect& rect) const
+    {
+        QSize textSize = staticText.size().toSize();
+        int x = rect.left();
+        if (alignment & Qt::AlignRight)
+            x = rect.right() + 1 - textSize.width();
+        else if (alignment & Qt::AlignHCenter)
+            x = rect.left() + (rect.width() - textSize.width()) / 2;
+
+        int y = rect.top();
+        if (alignment & Qt::AlignBottom)
+            y = rect.bottom() + 1 - textSize.height();
+        else if (alignment & Qt::AlignVCenter)
+            y = rect.top() + (rect.height() - textSize.height()) / 2;
+
+        return QPoint(x, y);
+    }
+
+    // text flags like Qt::TextWordWrap are drawn by QPainter::drawText only
+    bool hasTextFlags() const { return alignment & ~(Qt::AlignHorizontal_Mask | Qt::AlignVertical_Mask); }
+
+    // static text fits rect and can be drawn without clipping
+    bool isFitted(const QRect& rect) const
+    {
+        return !hasTextFlags() && rect.contains(QRect(position(rect), staticText.size().toSize()));
+    }
+
+    // draws text clipped by rect as QPainter::drawText does
+    void draw(QPainter* painter, const QRect& rect) const
+    {
+        if (hasTextFlags())
+        {
+            painter->drawText(rect, int(alignment), staticText.text());
+            return;
+        }
+
+        if (isFitted(rect))
+        {
+            painter->drawStaticText(position(rect), staticText);
+            return;
+        }
+
+        painter->save();
+        painter->setClipRect(rect, Qt::IntersectClip);
+        painter->drawStaticText(position(rect), staticText);
+        painter->restore();
+    }
+};
+
+static SharedPtr<TextDrawData> createTextDrawData(const QString& text, const QFont& font, const QFontMetrics& metrics, const QSize& size, Qt::TextElideMode elideMode, Qt::Alignment alignment)
+{
+    auto drawData = makeShared<TextDrawData>();
+    drawData->text = text;
+    drawData->font = font;
+    drawData->size = size;
+    drawData->elideMode = elideMode;
+    drawData->alignment = alignment;
+
+    QString textToDraw = text;
+    if (elideMode != Qt::ElideNone)
+    {
+        textToDraw = metrics.elidedText(text, elideMode, size.width());
+        drawData->isElided = (textToDraw != text);
+    }
+    else
+    {
+        drawData->isElided = (metrics.width(text) > size.width());
+    }
+
+    drawData->staticText.setTextFormat(Qt::PlainText);
+    drawData->staticText.setText(textToDraw);
+
+    return drawData;
+}
+
+// reuses text elided by layout or shaped by previous draw
+static TextDrawData* validDrawData(const QString& text, QPainter* painter, const CacheContext& cache, const QRect& rect, Qt::TextElideMode elideMode, Qt::Alignment alignment)
+{
+    const QFont& font = painter->font();
+
+    auto drawData = cache.cacheView.drawData<TextDrawData>();
+    if (!drawData || !drawData->isValid(text, font, rect.size(), elideMode, alignment))
+    {
+        auto newDrawData = createTextDrawData(text, font, painter->fontMetrics(), rect.size(), elideMode, alignment);
+        newDrawData->staticText.prepare(painter->transform(), font);
+
+        drawData = newDrawData.data();
+        cache.cacheView.setDrawData(std::move(newDrawData));
+    }
+
+    return drawData;
+}
+
+// glyphs of many texts with the same font and pen
+struct GlyphRunsBatch
+{
+    QRawFont rawFont;
+    QGlyphRun::GlyphRunFlags flags;
+    QPen pen;
+    QVector<quint32> glyphIndexes;
+    QVector<QPointF> positions;
+
+    bool isSame(const QGlyphRun& glyphRun, const QPen& pen) const
+    {
+        return flags == glyphRun.flags() && this->pen == pen && rawFont == glyphRun.rawFont();
+    }
+
+    void append(const QGlyphRun& glyphRun, const QPointF& origin)
+    {
+        glyphIndexes += glyphRun.glyphIndexes();
+        for (const auto& position : glyphRun.positions())
+            positions.append(position + origin);
+    }
+
+    void draw(QPainter* painter) const
+    {
+        QGlyphRun glyphRun;
+        glyphRun.setRawFont(rawFont);
+        glyphRun.setFlags(flags);
+        glyphRun.setGlyphIndexes(glyphIndexes);
+        glyphRun.setPositions(positions);
+
+        painter->setPen(pen);
+        painter->drawGlyphRun(QPointF(0, 0), glyphRun);
+    }
+};
+
 ViewText::ViewText(const SharedPtr<ModelText> &model, ViewDefaultController createDefaultController, Qt::Alignment alignment, Qt::TextElideMode textElideMode)
     : ViewModeled<ModelText>(model),
       m_alignment(alignment),
       m_textElideMode(textElideMode),
-      m_margins(2, 0, 2, 0)
+      m_margins(2, 0, 2, 0),
+      m_batchDraw(false)
 {
     if (createDefaultController)
     {
-        setController(makeShared<ControllerMouseText>(model));
+        setControllerLazy([model]() { return makeShared<ControllerMouseText>(model); });
     }
 }
 
@@ -60,14 +237,77 @@ void ViewText::setMargins(const QMargins& margins)
     emitViewChanged(ChangeReasonViewSize);
 }
 
+void ViewText::setBatchDraw(bool batchDraw)
+{
+    if (m_batchDraw == batchDraw)
+        return;
+
+    m_batchDraw = batchDraw;
+    emitViewChanged(ChangeReasonViewContent);
+}
+
 QSize ViewText::sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const
 {
     return sizeText(theModel()->value(id), ctx, id, sizeMode);
 }
 
+void ViewText::prepareCacheViewImpl(const GuiContext& ctx, ID id, const CacheView2& cacheView) const
+{
+    prepareText(theModel()->value(id), ctx, id, cacheView);
+}
+
 void ViewText::drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const
 {
-    drawText(theModel()->value(cache.id), painter, ctx, cache, showTooltip);
+    drawText(displayTextImpl(cache.id), painter, ctx, cache, showTooltip);
+}
+
+void ViewText::drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* visibleRect) const
+{
+    QVector<GlyphRunsBatch> batches;
+    QPen oldPen = painter->pen();
+
+    for (const auto& item : items)
+    {
+        CacheContext cache(item.id, item.itemRect, *item.cacheView, visibleRect);
+
+        QRect rect = cache.cacheView.rect().marginsRemoved(m_margins);
+        auto drawData = validDrawData(displayTextImpl(cache.id), painter, cache, rect, textElideMode(cache.id), alignment(cache.id));
+        QPen pen = textPenImpl(painter, ctx, cache.id);
+
+        // clipped or wrapped texts are drawn one by one
+        if (!drawData->isFitted(rect))
+        {
+            painter->setPen(pen);
+            drawData->draw(painter, rect);
+            painter->setPen(oldPen);
+            continue;
+        }
+
+        QPointF origin = drawData->position(rect);
+
+        for (const auto& glyphRun : drawData->shapedGlyphRuns())
+        {
+            auto it = std::find_if(batches.begin(), batches.end(), [&glyphRun, &pen](const GlyphRunsBatch& batch) {
+                return batch.isSame(glyphRun, pen);
+            });
+
+            if (it == batches.end())
+            {
+                GlyphRunsBatch batch;
+                batch.rawFont = glyphRun.rawFont();
+                batch.flags = glyphRun.flags();
+                batch.pen = pen;
+                batches.append(batch);
+                it = batches.end() - 1;
+            }
+
+            it->append(glyphRun, origin);
+        }
+    }
+
+    for (const auto& batch : batches)
+        batch.draw(painter);
+    painter->setPen(oldPen);
 }
 
 bool ViewText::textImpl(ID id, QString& txt) const
@@ -76,7 +316,7 @@ bool ViewText::textImpl(ID id, QString& txt) const
     return true;
 }
 
-QSize ViewText::sizeText(const QString& text, const GuiContext& ctx, ID /*id*/, ViewSizeMode /*sizeMode*/) const
+QSize ViewText::sizeText(const QString& text, const GuiContext& ctx, ID id, ViewSizeMode /*sizeMode*/) const
 {
     /*
     QStyleOptionViewItem option;
@@ -88,9 +328,29 @@ QSize ViewText::sizeText(const QString& text, const GuiContext& ctx, ID /*id*/,
 
     return ctx.widget->style()->sizeFromContents(QStyle::CT_ItemViewItem, &option, QSize(0, 0), ctx.widget) + QSize(5, 5);
     */
-    QFontMetrics fontMetrics = ctx.widget->fontMetrics();
-    return QSize(fontMetrics.width(text) + m_margins.left() + m_margins.right(),
-                 fontMetrics.height() + m_margins.top() + m_margins.bottom());
+    const QFont& font = ctx.font();
+    TextWidthCache& widthCache = TextWidthCache::instance();
+
+    // wrapped texts grow in height within the width of item
+    int marginsWidth = m_margins.left() + m_margins.right();
+    if (ctx.sizeWidthHint() > 0 && (alignment(id) & Qt::TextWordWrap))
+    {
+        int width = qMax(ctx.sizeWidthHint() - marginsWidth, 1);
+        return QSize(ctx.sizeWidthHint(), widthCache.wrappedHeight(font, text, width) + m_margins.top() + m_margins.bottom());
+    }
+
+    return QSize(widthCache.width(font, text) + marginsWidth,
+                 widthCache.height(font) + m_margins.top() + m_margins.bottom());
+}
+
+void ViewText::prepareText(const QString& text, const GuiContext& ctx, ID id, const CacheView2& cacheView) const
+{
+    QRect rect = cacheView.rect().marginsRemoved(m_margins);
+    const QFont& font = ctx.font();
+    auto drawData = createTextDrawData(text, font, ctx.fontMetrics(), rect.size(), textElideMode(id), alignment(id));
+    // draw prepares it again if painter has another transform
+    drawData->staticText.prepare(QTransform(), font);
+    cacheView.setDrawData(std::move(drawData));
 }
 
 void ViewText::drawText(const QString& text, QPainter* painter, const GuiContext& /*ctx*/, const CacheContext& cache, bool* showTooltip) const
@@ -109,23 +369,12 @@ void ViewText::drawText(const QString& text, QPainter* painter, const GuiContext
     */
 
     QRect rect = cache.cacheView.rect().marginsRemoved(m_margins);
-    QString textToDraw = text;
-    Qt::TextElideMode elideMode = textElideMode(cache.id);
-    if (elideMode != Qt::ElideNone)
-    {
-        QString elidedText = painter->fontMetrics().elidedText(textToDraw, elideMode, rect.width());
-        if (showTooltip)
-            *showTooltip = (elidedText != textToDraw);
+    auto drawData = validDrawData(text, painter, cache, rect, textElideMode(cache.id), alignment(cache.id));
 
-        textToDraw = elidedText;
-    }
-    else
-    {
-        if (showTooltip)
-            *showTooltip = (painter->fontMetrics().width(text) > rect.width());
-    }
+    if (showTooltip)
+        *showTooltip = drawData->isElided;
 
-    painter->drawText(rect, alignment(cache.id), textToDraw);
+    drawData->draw(painter, rect);
 }
 
 
@@ -145,14 +394,21 @@ QSize ViewTextOrHint::sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMo
         return ViewText::sizeImpl(ctx, id, sizeMode);
 }
 
+void ViewTextOrHint::prepareCacheViewImpl(const GuiContext& ctx, ID id, const CacheView2& cacheView) const
+{
+    if (isItemHint && isItemHint(id, theModel().data()))
+        prepareText(itemHintText ? itemHintText(id, theModel().data()) : QString(), ctx, id, cacheView);
+    else
+        ViewText::prepareCacheViewImpl(ctx, id, cacheView);
+}
+
 void ViewTextOrHint::drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const
 {
-    if (isItemHint && isItemHint(cache.id, theModel().data()))
+    if (isHint(cache.id))
     {
-        QString hintText = itemHintText ? itemHintText(cache.id, theModel().data()) : QString();
         QPen oldPen = painter->pen();
-        painter->setPen(ctx.widget->palette().color(QPalette::Disabled, QPalette::Text));
-        drawText(hintText, painter, ctx, cache, showTooltip);
+        painter->setPen(textPenImpl(painter, ctx, cache.id));
+        drawText(displayTextImpl(cache.id), painter, ctx, cache, showTooltip);
         painter->setPen(oldPen);
 
         if (showTooltip) *showTooltip = true;
@@ -174,6 +430,22 @@ bool ViewTextOrHint::tooltipTextImpl(ID id, QString& txt) const
         return ViewText::tooltipTextImpl(id, txt);
 }
 
+QString ViewTextOrHint::displayTextImpl(ID id) const
+{
+    if (isHint(id))
+        return itemHintText ? itemHintText(id, theModel().data()) : QString();
+    else
+        return ViewText::displayTextImpl(id);
+}
+
+QPen ViewTextOrHint::textPenImpl(const QPainter* painter, const GuiContext& ctx, ID id) const
+{
+    if (isHint(id))
+        return ctx.palette().color(QPalette::Disabled, QPalette::Text);
+    else
+        return ViewText::textPenImpl(painter, ctx, id);
+}
+
 ViewTextFont::ViewTextFont(const SharedPtr<ModelFont> &model)
     : ViewModeled<ModelFont>(model)
 {
@@ -215,7 +487,7 @@ bool ControllerMouseText::acceptInplaceEditImpl(ID /*id*/, const CacheSpace& /*c
 
 QWidget* ControllerMouseText::createInplaceEditorImpl(ID id, const QRect& rect, QWidget* parent, const QKeyEvent* /*keyEvent*/)
 {
-    QLineEdit* editor = new QLineEdit(parent);
+    QLineEdit* editor = inplaceEdit().pooledEditor<QLineEdit>(parent);
     editor->setGeometry(rect);
     editor->setText(m_model->value(id));
 
@@ -48,21 +48,37 @@ public:
     const QMargins& margins() const { return m_margins; }
     void setMargins(const QMargins& margins);
 
+    // draws texts of all items of a frame at once grouped by font and pen
+    // painter state changed by preceding views of an item (like ViewTextFont) is not applied
+    bool isBatchDraw() const { return m_batchDraw; }
+    void setBatchDraw(bool batchDraw);
+
 protected:
     virtual Qt::Alignment alignmentImpl(ID /*id*/) const { return m_alignment; }
     virtual Qt::TextElideMode textElideModeImpl(ID /*id*/) const { return m_textElideMode; }
+    // text and pen used to draw the item
+    virtual QString displayTextImpl(ID id) const { return theModel()->value(id); }
+    virtual QPen textPenImpl(const QPainter* painter, const GuiContext& /*ctx*/, ID /*id*/) const { return painter->pen(); }
 
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
+    void prepareCacheViewImpl(const GuiContext& ctx, ID id, const CacheView2& cacheView) const override;
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
     bool textImpl(ID id, QString& txt) const override;
+    bool isDrawBatchableImpl() const override { return m_batchDraw; }
+    // draw shapes text into cache view draw data lazily, so it is not thread safe
+    bool isDrawThreadSafeImpl() const override { return false; }
+    void drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* visibleRect) const override;
 
     QSize sizeText(const QString& text, const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const;
+    // elides text for cache view rect with widget font
+    void prepareText(const QString& text, const GuiContext& ctx, ID id, const CacheView2& cacheView) const;
     void drawText(const QString& text, QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const;
 
 private:
     Qt::Alignment m_alignment;
     Qt::TextElideMode m_textElideMode;
     QMargins m_margins;
+    bool m_batchDraw;
 };
 
 class QI_EXPORT ViewTextOrHint: public ViewText
@@ -79,8 +95,14 @@ public:
 
 protected:
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
+    void prepareCacheViewImpl(const GuiContext& ctx, ID id, const CacheView2& cacheView) const override;
     void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
     bool tooltipTextImpl(ID id, QString& txt) const override;
+    QString displayTextImpl(ID id) const override;
+    QPen textPenImpl(const QPainter* painter, const GuiContext& ctx, ID id) const override;
+
+private:
+    bool isHint(ID id) const { return isItemHint && isItemHint(id, theModel().data()); }
 };
 
 typedef ModelTyped<QFont> ModelFont;
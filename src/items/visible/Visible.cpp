@@ -26,6 +26,7 @@ ViewVisible::ViewVisible(SharedPtr<View> sourceView, bool reserveSize)
 {
     Q_ASSERT(m_sourceView);
     connect(m_sourceView.data(), &View::viewChanged, this, &ViewVisible::onSourceViewChanged);
+    connect(m_sourceView.data(), &View::viewItemsChanged, this, &ViewVisible::onSourceViewItemsChanged);
 }
 
 void ViewVisible::notifyVisibilityChanged()
@@ -76,6 +77,14 @@ void ViewVisible::onSourceViewChanged(const View* view, ChangeReason reason)
     emit viewChanged(this, reason);
 }
 
+void ViewVisible::onSourceViewItemsChanged(const View* view, const QVector<ID>& items)
+{
+    Q_UNUSED(view);
+    Q_ASSERT(view == m_sourceView.data());
+
+    emit viewItemsChanged(this, items);
+}
+
 ControllerMouseVisible::ControllerMouseVisible(SharedPtr<ViewVisible> view)
     : m_view(std::move(view))
 {
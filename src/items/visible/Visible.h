@@ -39,10 +39,13 @@ protected:
     void addViewImpl(ID id, QVector<const View*>& views) const override;
     CacheView2* addCacheViewImpl(const Layout& layout, const GuiContext& ctx, ID id, QVector<CacheView2>& cacheViews, QRect& itemRect, QRect* visibleItemRect) const override;
     QSize sizeImpl(const GuiContext& ctx, ID id, ViewSizeMode sizeMode) const override;
+    // cache views depend on item id
+    bool isCacheViewUniformImpl() const override { return false; }
 
 private:
     bool safeIsItemVisible(ID id) const;
     void onSourceViewChanged(const View* view, ChangeReason reason);
+    void onSourceViewItemsChanged(const View* view, const QVector<ID>& items);
 
     SharedPtr<View> m_sourceView;
     bool m_reserveSize;
@@ -15,11 +15,10 @@
 */
 
 #include "CacheSpaceAnimation.h"
+#include "cache/CacheItem.h"
 
-#include <QParallelAnimationGroup>
-#include <QSequentialAnimationGroup>
-#include <QPauseAnimation>
-#include <QVariantAnimation>
+#include <QPixmap>
+#include <QWidget>
 
 namespace Qi
 {
@@ -43,8 +42,10 @@ protected:
     void updateCurrentTime(int currentTime) override
     {
         // don't repaint at start
+        // all animations are ticked by one unified timer and update requests
+        // of the same frame are coalesced to one paint of the widget
         if (currentTime != 0)
-            m_owner->m_widget->repaint();
+            m_owner->m_widget->update();
     }
 
     void updateState(QAbstractAnimation::State newState, QAbstractAnimation::State /*oldState*/) override
@@ -59,10 +60,76 @@ private:
     CacheSpaceAnimationAbstract* m_owner;
 };
 
+// moves rects of many cache views from start to end rects
+// each view starts after its delay and moves for viewDuration
+class ViewRectsAnimation: public QAbstractAnimation
+{
+public:
+    ViewRectsAnimation(QObject* parent, const QEasingCurve& easingCurve, int viewDuration)
+        : QAbstractAnimation(parent),
+          m_easingCurve(easingCurve),
+          m_viewDuration(viewDuration),
+          m_duration(viewDuration)
+    {}
+
+    void addView(CacheView2* cacheView, int delay, const QRect& startRect, const QRect& endRect)
+    {
+        m_views.append(cacheView);
+        m_delays.append(delay);
+        m_startRects.append(startRect);
+        m_endRects.append(endRect);
+        m_duration = qMax(m_duration, delay + m_viewDuration);
+    }
+
+    int duration() const override { return m_duration; }
+
+protected:
+    void updateCurrentTime(int currentTime) override
+    {
+        // views of one cache item have the same delay and progress
+        int lastDelay = -1;
+        qreal progress = 0.;
+
+        const int count = m_views.size();
+        for (int i = 0; i < count; ++i)
+        {
+            if (m_delays[i] != lastDelay)
+            {
+                lastDelay = m_delays[i];
+                int time = qBound(0, currentTime - lastDelay, m_viewDuration);
+                progress = m_easingCurve.valueForProgress(qreal(time) / m_viewDuration);
+            }
+
+            const QRect& start = m_startRects[i];
+            const QRect& end = m_endRects[i];
+            m_views[i]->rRect().setCoords(start.left() + qRound((end.left() - start.left()) * progress),
+                                          start.top() + qRound((end.top() - start.top()) * progress),
+                                          start.right() + qRound((end.right() - start.right()) * progress),
+                                          start.bottom() + qRound((end.bottom() - start.bottom()) * progress));
+        }
+    }
+
+private:
+    QEasingCurve m_easingCurve;
+    int m_viewDuration;
+    int m_duration;
+
+    QVector<CacheView2*> m_views;
+    QVector<int> m_delays;
+    QVector<QRect> m_startRects;
+    QVector<QRect> m_endRects;
+};
+
 }
 
+// duration of one view move in milliseconds
+static const int ShiftViewDuration = 1000;
+// delay between moves of consecutive cache items
+static const int ShiftItemDelay = 100;
+
 CacheSpaceAnimationAbstract::CacheSpaceAnimationAbstract(QWidget* widget, CacheSpace* cacheSpace)
     : QObject(widget),
+      m_isSnapshotViews(false),
       m_animation(nullptr),
       m_auxAnimation(nullptr),
       m_widget(widget),
@@ -148,6 +215,29 @@ void CacheSpaceAnimationAbstract::drawCacheSpace(const CacheSpace* cacheSpace, Q
     m_auxAnimation->start(QAbstractAnimation::DeleteWhenStopped);
 }
 
+void CacheSpaceAnimationAbstract::snapshotCacheView(CacheView2* cacheView, ID id, const QRect& itemRect, const GuiContext& ctx) const
+{
+    QRect rect = cacheView->rect();
+    if (rect.isEmpty())
+        return;
+
+    qreal pixelRatio = m_widget->devicePixelRatioF();
+    QPixmap snapshot(rect.size() * pixelRatio);
+    snapshot.setDevicePixelRatio(pixelRatio);
+    snapshot.fill(Qt::transparent);
+
+    {
+        QPainter painter(&snapshot);
+        painter.translate(-rect.topLeft());
+        cacheView->drawRaw(&painter, ctx, id, itemRect);
+    }
+
+    // no view drawing until cache items are recreated at the animation end
+    cacheView->setDrawProxy([snapshot](const CacheView2* cacheView, QPainter* painter, const GuiContext& /*ctx*/, ID /*id*/, const QRect& /*itemRect*/, const QRect* /*visibleRect*/) {
+        painter->drawPixmap(cacheView->rect(), snapshot);
+    });
+}
+
 void CacheSpaceAnimationAbstract::onCacheChanged(const CacheSpace* cache, ChangeReason reason)
 {
     Q_UNUSED(cache);
@@ -200,32 +290,21 @@ QAbstractAnimation* CacheSpaceAnimationShiftViews::createAnimationImpl(CacheSpac
 {
     cacheSpace->validate(ctx);
 
-    auto animation = new QParallelAnimationGroup(this);
+    auto animation = new Impl::ViewRectsAnimation(this, easingCurve(), ShiftViewDuration);
 
     // enumerate all cache views
-    cacheSpace->forEachCacheView([this, animation, cacheSpace](const CacheSpace::IterateInfo& info)->bool {
+    cacheSpace->forEachCacheView([this, animation, cacheSpace, &ctx](const CacheSpace::IterateInfo& info)->bool {
 
         // skip non target views
         if (m_viewToApply && (m_viewToApply != info.cacheView->view()))
             return true;
 
-        auto subAnimation = new QSequentialAnimationGroup(animation);
+        if (isSnapshotViews())
+            snapshotCacheView(info.cacheView, info.cacheItem->id, info.cacheItem->rect, ctx);
 
-        auto rectAnimation = new QVariantAnimation(subAnimation);
-        rectAnimation->setDuration(1000);
-        rectAnimation->setEasingCurve(easingCurve());
         QRect startRect = info.cacheView->rect();
         moveToStart(cacheSpace, startRect);
-        rectAnimation->setStartValue(startRect);
-        rectAnimation->setEndValue(info.cacheView->rect());
-        CacheView2* cv = info.cacheView;
-        connect(rectAnimation, &QVariantAnimation::valueChanged, [cv](const QVariant &value){
-            cv->rRect() = value.toRect();
-        });
-        subAnimation->addPause(info.cacheItemIndex*100);
-        subAnimation->addAnimation(rectAnimation);
-
-        animation->addAnimation(subAnimation);
+        animation->addView(info.cacheView, info.cacheItemIndex * ShiftItemDelay, startRect, info.cacheView->rect());
 
         if (direction() == QAbstractAnimation::Forward)
         {
@@ -268,38 +347,38 @@ QAbstractAnimation* CacheSpaceAnimationShiftViewsRandom::createAnimationImpl(Cac
 {
     cacheSpace->validate(ctx);
 
-    auto animation = new QParallelAnimationGroup(this);
-    QRect randomArea = cacheSpace->window();
+    auto animation = new Impl::ViewRectsAnimation(this, easingCurve(), ShiftViewDuration);
+    QRect window = cacheSpace->window();
+    QRect randomArea = window;
     randomArea.adjust(-2*randomArea.width(), -2*randomArea.height(), 2*randomArea.width(), 2*randomArea.height());
+    if (randomArea.isEmpty())
+        return animation;
 
-    cacheSpace->forEachCacheView([this, &randomArea, animation, cacheSpace](const CacheSpace::IterateInfo& info)->bool {
+    // xorshift generator seeded per animation
+    quint32 seed = quint32(quintptr(this)) ^ quint32(window.width() * 31 + window.height()) ^ 0x9e3779b9u;
+    auto random = [&seed](int bound)->int {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        return int(seed % quint32(bound));
+    };
 
-        auto subAnimation = new QSequentialAnimationGroup(animation);
+    cacheSpace->forEachCacheView([this, &randomArea, &window, &random, animation, &ctx](const CacheSpace::IterateInfo& info)->bool {
 
-        auto rectAnimation = new QVariantAnimation(subAnimation);
-        rectAnimation->setDuration(1000);
-        rectAnimation->setEasingCurve(easingCurve());
+        if (isSnapshotViews())
+            snapshotCacheView(info.cacheView, info.cacheItem->id, info.cacheItem->rect, ctx);
 
         // generate random start rect which is out of visible window
         QRect startRect;
         do
         {
             QPoint randomPoint;
-            randomPoint.rx() = randomArea.left() + std::rand()%randomArea.width();
-            randomPoint.ry() = randomArea.top() + std::rand()%randomArea.height();
+            randomPoint.rx() = randomArea.left() + random(randomArea.width());
+            randomPoint.ry() = randomArea.top() + random(randomArea.height());
             startRect = QRect(randomPoint, QSize(1, 1));
-        } while (startRect.intersects(cacheSpace->window()));
-
-        rectAnimation->setStartValue(startRect);
-        rectAnimation->setEndValue(info.cacheView->rect());
-        CacheView2* cv = info.cacheView;
-        connect(rectAnimation, &QVariantAnimation::valueChanged, [cv](const QVariant &value){
-            cv->rRect() = value.toRect();
-        });
-        subAnimation->addPause(info.cacheItemIndex*100);
-        subAnimation->addAnimation(rectAnimation);
-
-        animation->addAnimation(subAnimation);
+        } while (startRect.intersects(window));
+
+        animation->addView(info.cacheView, info.cacheItemIndex * ShiftItemDelay, startRect, info.cacheView->rect());
 
         if (direction() == QAbstractAnimation::Forward)
         {
@@ -46,6 +46,11 @@ public:
 
     QAbstractAnimation::Direction direction() const { return m_direction; }
 
+    // animated views are rendered to pixmaps once at start
+    // and the pixmaps are composited at animated rects on each frame
+    bool isSnapshotViews() const { return m_isSnapshotViews; }
+    void setSnapshotViews(bool isSnapshotViews) { m_isSnapshotViews = isSnapshotViews; }
+
     bool start(QAbstractAnimation::Direction direction = QAbstractAnimation::Forward, QAbstractAnimation::DeletionPolicy policy = QAbstractAnimation::KeepWhenStopped);
     bool stop();
 
@@ -55,6 +60,10 @@ signals:
 protected:
     virtual QAbstractAnimation* createAnimationImpl(CacheSpace* cacheSpace, QPainter* painter, const GuiContext& ctx) = 0;
 
+    // renders cacheView at its current rect and draws the result instead of the view
+    // call it before animated rect is changed
+    void snapshotCacheView(CacheView2* cacheView, ID id, const QRect& itemRect, const GuiContext& ctx) const;
+
 private:
     friend class Impl::AuxAnimation;
     friend class CacheSpace;
@@ -64,6 +73,7 @@ private:
     void onAuxAnimationStopped();
 
     QEasingCurve m_easingCurve;
+    bool m_isSnapshotViews;
     QAbstractAnimation* m_animation;
     Impl::AuxAnimation* m_auxAnimation;
 
@@ -18,23 +18,81 @@
 #include "widgets/GridWidget.h"
 #include "widgets/ListWidget.h"
 #include "cache/CacheItemFactory.h"
-#include "utils/CallLater.h"
+#include "space/grid/CacheSpaceGrid.h"
+#include "utils/FrameScheduler.h"
+#include "utils/auto_value.h"
+#include "utils/TaskPool.h"
 #include <QEvent>
+#include <QDataStream>
+#include <functional>
+#include <numeric>
 
 namespace Qi
 {
 
 static const int FitSizeCacheInvalid = -1;
+static const int FitSampleSizeDefault = 1000;
 
-int calculateColumnFitWidth(const SpaceGrid& grid, int visibleColumn, const GuiContext& ctx)
+// pseudo random rows, one per each of sampleSize strides
+// seeded by rows count to give the same width on every resize
+static QVector<int> sampleFitRows(int rowsCount, int rowStart, int rowEnd, int sampleSize)
+{
+    QVector<int> rows;
+    if (rowsCount <= sampleSize + (rowEnd - rowStart + 1))
+    {
+        rows.reserve(rowsCount);
+        for (int row = 0; row < rowsCount; ++row)
+            rows.append(row);
+        return rows;
+    }
+
+    rows.reserve(sampleSize + (rowEnd - rowStart + 1));
+    for (int row = rowStart; row <= rowEnd; ++row)
+        rows.append(row);
+
+    quint32 seed = quint32(rowsCount) * 2654435761u + 1u;
+    for (int i = 0; i < sampleSize; ++i)
+    {
+        int strideStart = int(qint64(rowsCount) * i / sampleSize);
+        int strideEnd = int(qint64(rowsCount) * (i + 1) / sampleSize);
+        seed = seed * 1664525u + 1013904223u;
+        rows.append(strideStart + int((seed >> 8) % quint32(strideEnd - strideStart)));
+    }
+
+    return rows;
+}
+
+// measures next portion of absolute rows, hidden rows are skipped and don't spend budget
+static int calculateColumnFitWidthIncremental(const SpaceGrid& grid, int visibleColumn, const GuiContext& ctx, int& rowsMeasured, int& budget)
+{
+    const Lines& rows = *grid.rows();
+    int rowsCount = rows.count();
+
+    QVector<int> visibleRows;
+    int row = rowsMeasured;
+    for (; row < rowsCount && visibleRows.size() < budget; ++row)
+    {
+        if (rows.isLineVisible(row))
+            visibleRows.append(rows.toVisible(row));
+    }
+
+    budget -= visibleRows.size();
+    rowsMeasured = row;
+
+    return calculateColumnFitWidth(grid, visibleColumn, ctx, visibleRows);
+}
+
+// measures visibleRows or all rows if visibleRows is null
+static int measureColumnFitWidth(const SpaceGrid& grid, const CacheItemFactory& factory, int visibleColumn, const GuiContext& ctx, const QVector<int>* visibleRows)
 {
     int fitWidth = 0;
 
-    auto factory = grid.createCacheItemFactory();
-    ViewSizeMode sizeMode = (grid.rowsVisibleCount() <= 1000) ? ViewSizeModeExact : ViewSizeModeFastAverage;
-    for (GridID id(0, visibleColumn); id.row < grid.rowsVisibleCount(); ++id.row)
+    int rowsCount = visibleRows ? visibleRows->size() : grid.rowsVisibleCount();
+    ViewSizeMode sizeMode = (rowsCount <= 1000) ? ViewSizeModeExact : ViewSizeModeFastAverage;
+    for (int i = 0; i < rowsCount; ++i)
     {
-        CacheItem cacheItem(factory->create(ID(id)));
+        int row = visibleRows ? visibleRows->at(i) : i;
+        CacheItem cacheItem(factory.create(ID(GridID(row, visibleColumn))));
         cacheItem.validateCacheView(ctx);
         fitWidth = qMax(fitWidth, cacheItem.calculateItemSize(ctx, sizeMode).width());
     }
@@ -42,6 +100,132 @@ int calculateColumnFitWidth(const SpaceGrid& grid, int visibleColumn, const GuiC
     return fitWidth;
 }
 
+// visible rows in cacheGrid frame and sampleSize rows picked evenly at random
+static QVector<int> sampledVisibleRows(const SpaceGrid& grid, const CacheSpaceGrid* cacheGrid, int sampleSize)
+{
+    int rowsCount = grid.rowsVisibleCount();
+    int rowStart = 0;
+    int rowEnd = -1;
+    if (cacheGrid)
+    {
+        GridID idStart, idEnd;
+        cacheGrid->visibleItemsRange(idStart, idEnd);
+        if (idStart.isValid() && idEnd.isValid())
+        {
+            rowStart = qMin(idStart.row, rowsCount);
+            rowEnd = qMin(idEnd.row, rowsCount - 1);
+        }
+    }
+
+    return sampleFitRows(rowsCount, rowStart, rowEnd, sampleSize);
+}
+
+int calculateColumnFitWidth(const SpaceGrid& grid, int visibleColumn, const GuiContext& ctx)
+{
+    auto factory = grid.createCacheItemFactory();
+    return measureColumnFitWidth(grid, *factory, visibleColumn, ctx, nullptr);
+}
+
+int calculateColumnFitWidth(const SpaceGrid& grid, int visibleColumn, const GuiContext& ctx, const QVector<int>& visibleRows)
+{
+    if (visibleRows.isEmpty())
+        return 0;
+
+    auto factory = grid.createCacheItemFactory();
+    return measureColumnFitWidth(grid, *factory, visibleColumn, ctx, &visibleRows);
+}
+
+int calculateColumnFitWidthSampled(const SpaceGrid& grid, const CacheSpaceGrid* cacheGrid, int visibleColumn, const GuiContext& ctx, int sampleSize)
+{
+    return calculateColumnFitWidth(grid, visibleColumn, ctx, sampledVisibleRows(grid, cacheGrid, sampleSize));
+}
+
+// absolute line and position of the visible line
+struct FitLineInfo
+{
+    int absolute;
+    int start;
+    int end;
+};
+
+static QVector<FitLineInfo> fitLinesInfo(const Lines& lines, const QVector<int>& visibleLines)
+{
+    QVector<FitLineInfo> infos;
+    infos.reserve(visibleLines.size());
+    for (int line : visibleLines)
+        infos.append(FitLineInfo{lines.toAbsolute(line), lines.startPos(line), lines.endPos(line)});
+    return infos;
+}
+
+QVector<int> calculateColumnsFitWidthParallel(const SpaceGrid& grid, const CacheSpaceGrid* cacheGrid, const QVector<int>& visibleColumns, const GuiContext& ctx, int sampleSize)
+{
+    QVector<int> fitWidths(visibleColumns.size(), 0);
+    if (visibleColumns.isEmpty() || grid.rowsVisibleCount() == 0)
+        return fitWidths;
+
+    // lazily initialized state is prepared in GUI thread
+    ctx.frameState();
+    QVector<int> visibleRows;
+    if (sampleSize > 0)
+    {
+        visibleRows = sampledVisibleRows(grid, cacheGrid, sampleSize);
+    }
+    else
+    {
+        visibleRows.resize(grid.rowsVisibleCount());
+        std::iota(visibleRows.begin(), visibleRows.end(), 0);
+    }
+
+    // lines map ids and positions by lazily built caches, so workers get them ready
+    const QVector<FitLineInfo> rows = fitLinesInfo(*grid.rows(), visibleRows);
+    const QVector<FitLineInfo> columns = fitLinesInfo(*grid.columns(), visibleColumns);
+    ViewSizeMode sizeMode = (rows.size() <= 1000) ? ViewSizeModeExact : ViewSizeModeFastAverage;
+
+    // factories cache schemas, so each worker gets its own one
+    struct ColumnsPortion
+    {
+        int begin;
+        int end;
+        SharedPtr<CacheItemFactory> factory;
+    };
+
+    int portionsCount = qBound(1, TaskPool::instance().threadsCount(), visibleColumns.size());
+    QVector<ColumnsPortion> portions;
+    portions.reserve(portionsCount);
+    for (int i = 0; i < portionsCount; ++i)
+    {
+        portions.append(ColumnsPortion{visibleColumns.size() * i / portionsCount,
+                                       visibleColumns.size() * (i + 1) / portionsCount,
+                                       grid.createCacheItemFactory()});
+    }
+
+    int* widths = fitWidths.data();
+    TaskPool::instance().parallelFor(0, portions.size(), 1, [&](int portionBegin, int portionEnd) {
+        for (int p = portionBegin; p < portionEnd; ++p)
+        {
+            const ColumnsPortion& portion = portions[p];
+            for (int i = portion.begin; i < portion.end; ++i)
+            {
+                const FitLineInfo& column = columns[i];
+                int fitWidth = 0;
+                for (const FitLineInfo& row : rows)
+                {
+                    CacheItemInfo info(ID(GridID(row.absolute, column.absolute)));
+                    info.rect = QRect(QPoint(column.start, row.start), QPoint(column.end, row.end));
+                    portion.factory->updateSchema(info);
+
+                    CacheItem cacheItem(info);
+                    cacheItem.validateCacheView(ctx);
+                    fitWidth = qMax(fitWidth, cacheItem.calculateItemSize(ctx, sizeMode).width());
+                }
+                widths[i] = fitWidth;
+            }
+        }
+    });
+
+    return fitWidths;
+}
+
 int calculateGridColumnFitWidth(const GridWidget& gridWidget, int columnsId, int visibleColumn)
 {
     int fitWidth = 0;
@@ -66,27 +250,271 @@ namespace Impl
 ColumnResizeModeInfo::ColumnResizeModeInfo()
     : mode(ColumnResizeModeNone)
 {
+    fitRowsMeasured[0] = fitRowsMeasured[1] = fitRowsMeasured[2] = 0;
+}
+
+void ColumnResizeModeInfo::invalidateFit()
+{
+    param.fitSizeCache = FitSizeCacheInvalid;
+    fitRowsMeasured[0] = fitRowsMeasured[1] = fitRowsMeasured[2] = 0;
 }
 
 } // end namepace Impl
 
 using namespace Impl;
 
+// measured rows are the prefix of absolute rows, rows inserted into it are not measured yet
+static void fitRowsInserted(ColumnResizeModeInfo& info, int rowsId, int absoluteLine)
+{
+    if (info.mode == ColumnResizeModeFit)
+        info.fitRowsMeasured[rowsId] = qMin(info.fitRowsMeasured[rowsId], absoluteLine);
+}
+
+static void fitRowsRemoved(ColumnResizeModeInfo& info, int rowsId, int absoluteLine, int linesCount)
+{
+    int& rowsMeasured = info.fitRowsMeasured[rowsId];
+    if (info.mode == ColumnResizeModeFit && absoluteLine < rowsMeasured)
+        rowsMeasured -= qMin(linesCount, rowsMeasured - absoluteLine);
+}
+
+static bool isSameColumnResize(const ColumnResizeModeInfo& left, const ColumnResizeModeInfo& right)
+{
+    if (left.mode != right.mode)
+        return false;
+
+    switch (left.mode)
+    {
+    case ColumnResizeModeFixed:
+        return left.param.fixedSize == right.param.fixedSize;
+    case ColumnResizeModeFraction:
+        return left.param.fraction == right.param.fraction;
+    case ColumnResizeModeFractionN:
+        return left.param.fractionN == right.param.fractionN;
+    default:
+        return true;
+    }
+}
+
+static QVector<ColumnsResizeRun> createColumnsResizeRuns(const QVector<ColumnResizeModeInfo>& columnsInfo)
+{
+    QVector<ColumnsResizeRun> runs;
+    for (int column = 0; column < columnsInfo.size(); ++column)
+    {
+        if (runs.isEmpty() || !isSameColumnResize(columnsInfo[runs.back().first], columnsInfo[column]))
+            runs.append(ColumnsResizeRun{column, 0});
+        ++runs.back().count;
+    }
+    return runs;
+}
+
+// sets sizes of ColumnResizeModeNone, ColumnResizeModeFixed and ColumnResizeModeFit columns by runs
+// returns width taken by them, it doesn't depend on the viewport width
+static int resizeFixedColumnsByRuns(Lines& columns, QVector<ColumnResizeModeInfo>& columnsInfo, const QVector<ColumnsResizeRun>& runs,
+                                    const std::function<int(int visibleColumn, ColumnResizeModeInfo& info)>& fitWidth)
+{
+    int widthProcessed = 0;
+
+    for (const auto& run : runs)
+    {
+        const auto& info = columnsInfo[run.first];
+        switch (info.mode)
+        {
+        case ColumnResizeModeNone:
+            widthProcessed += columns.visibleLinesSize(run.first, run.count);
+            break;
+
+        case ColumnResizeModeFixed:
+            columns.setLinesSize(run.first, run.count, info.param.fixedSize);
+            widthProcessed += info.param.fixedSize * columns.visibleLinesCount(run.first, run.count);
+            break;
+
+        case ColumnResizeModeFit:
+            for (int column = run.first; column < run.first + run.count; ++column)
+            {
+                if (!columns.isLineVisible(column))
+                    continue;
+
+                columns.setLineSize(column, fitWidth(columns.toVisible(column), columnsInfo[column]));
+                widthProcessed += columns.lineSize(column);
+            }
+            break;
+
+        default:;
+        }
+    }
+
+    return widthProcessed;
+}
+
+// distributes remainsWidth between ColumnResizeModeFraction, ColumnResizeModeFractionN
+// and ColumnResizeModeResidue columns by runs
+// residueMargin is subtracted from the width of the first residue column
+static int resizeFractionColumnsByRuns(Lines& columns, const QVector<ColumnResizeModeInfo>& columnsInfo, const QVector<ColumnsResizeRun>& runs,
+                                       int remainsWidth, int totalColumnsCount, int residueMargin)
+{
+    // process ColumnResizeModeFraction and ColumnResizeModeFractionN
+    {
+        int widthProcessed = 0;
+        for (const auto& run : runs)
+        {
+            const auto& info = columnsInfo[run.first];
+            int size = 0;
+            if (info.mode == ColumnResizeModeFraction)
+                size = int((float)remainsWidth*info.param.fraction);
+            else if (info.mode == ColumnResizeModeFractionN)
+                size = int((float)remainsWidth*info.param.fractionN/(float)totalColumnsCount);
+            else
+                continue;
+
+            columns.setLinesSize(run.first, run.count, size);
+            widthProcessed += size * columns.visibleLinesCount(run.first, run.count);
+        }
+        remainsWidth -= widthProcessed;
+
+        if (remainsWidth <= 0)
+            return 0;
+    }
+
+    // process ColumnResizeModeResidue
+    {
+        for (const auto& run : runs)
+        {
+            if (columnsInfo[run.first].mode != ColumnResizeModeResidue)
+                continue;
+
+            int column = run.first;
+            int end = run.first + run.count;
+            if (remainsWidth > 0)
+            {
+                while (column < end && !columns.isLineVisible(column))
+                    ++column;
+                if (column == end)
+                    continue;
+
+                // first ColumnResizeModeResidue will occupy all free space
+                // all other would got 0
+                columns.setLineSize(column, qMax(0, remainsWidth - residueMargin));
+                remainsWidth = 0;
+                ++column;
+            }
+
+            columns.setLinesSize(column, end - column, 0);
+        }
+    }
+
+    return remainsWidth;
+}
+
+// visible fit columns without cached width
+static void collectFitColumnsToMeasure(const Lines& columns, const QVector<ColumnResizeModeInfo>& columnsInfo, const QVector<ColumnsResizeRun>& runs,
+                                       QVector<int>& fitColumns, QVector<int>& visibleColumns)
+{
+    for (const auto& run : runs)
+    {
+        if (columnsInfo[run.first].mode != ColumnResizeModeFit)
+            continue;
+
+        for (int column = run.first; column < run.first + run.count; ++column)
+        {
+            if (columnsInfo[column].param.fitSizeCache == FitSizeCacheInvalid && columns.isLineVisible(column))
+            {
+                fitColumns.append(column);
+                visibleColumns.append(columns.toVisible(column));
+            }
+        }
+    }
+}
+
 static const int ToleranceZone = 3;
 const GridID GridColumnsResizer::clientID = Qi::clientID;
 
+static const quint32 ColumnsResizerStateMagic = 0x51694372;
+static const quint16 ColumnsResizerStateVersion = 1;
+
+// fit width caches are not saved, they depend on models
+static void writeColumnResizeMode(QDataStream& stream, const ColumnResizeModeInfo& info)
+{
+    stream << qint32(info.mode);
+    if (info.mode == ColumnResizeModeFixed)
+        stream << qint32(info.param.fixedSize);
+    else if (info.mode == ColumnResizeModeFraction)
+        stream << info.param.fraction;
+    else if (info.mode == ColumnResizeModeFractionN)
+        stream << info.param.fractionN;
+}
+
+static bool readColumnResizeMode(QDataStream& stream, ColumnResizeModeInfo& info)
+{
+    qint32 mode = -1;
+    stream >> mode;
+
+    switch (mode)
+    {
+    case ColumnResizeModeNone:
+    case ColumnResizeModeResidue:
+        break;
+    case ColumnResizeModeFit:
+        info.invalidateFit();
+        break;
+    case ColumnResizeModeFixed:
+    {
+        qint32 size = -1;
+        stream >> size;
+        if (size < 0)
+            return false;
+        info.param.fixedSize = size;
+        break;
+    }
+    case ColumnResizeModeFraction:
+    case ColumnResizeModeFractionN:
+    {
+        float fraction = -1.f;
+        stream >> fraction;
+        if (!(fraction >= 0.f))
+            return false;
+        if (mode == ColumnResizeModeFraction)
+            info.param.fraction = fraction;
+        else
+            info.param.fractionN = fraction;
+        break;
+    }
+    default:
+        return false;
+    }
+
+    info.mode = ColumnResizeMode(mode);
+    return stream.status() == QDataStream::Ok;
+}
+
 GridColumnsResizer::GridColumnsResizer(GridWidget* gridWidget)
-    : m_gridWidget(gridWidget)
+    : m_gridWidget(gridWidget),
+      m_isResizing(false),
+      m_fitMode(ColumnFitModeExact),
+      m_fitSampleSize(FitSampleSizeDefault),
+      m_isParallelFitMeasurement(false)
 {
+    invalidateFixedWidths();
+
     Q_ASSERT(!m_gridWidget.isNull());
     m_gridWidget->installEventFilter(this);
 
     for (int id = 0; id < 3; ++id)
     {
         connect(m_gridWidget->rows(id).data(), &Lines::linesChanged, this, &GridColumnsResizer::onRowsChanged);
+        connect(m_gridWidget->rows(id).data(), &Lines::linesInserted, this, &GridColumnsResizer::onRowsInserted);
+        connect(m_gridWidget->rows(id).data(), &Lines::linesRemoved, this, &GridColumnsResizer::onRowsRemoved);
         connect(m_gridWidget->columns(id).data(), &Lines::linesChanged, this, &GridColumnsResizer::onColumnsChanged);
         initColumns(id, m_gridWidget->columns(id)->count());
     }
+
+    for (int rowsId = 0; rowsId < 3; ++rowsId)
+        for (int columnsId = 0; columnsId < 3; ++columnsId)
+        {
+            m_itemsConnections.append(connect(m_gridWidget->subGrid(GridID(rowsId, columnsId)).data(), &Space::spaceItemsChanged,
+                                              this, [this, rowsId, columnsId](const Space* /*space*/, const QVector<ID>& items) {
+                onItemsChanged(rowsId, columnsId, items);
+            }));
+        }
 }
 
 GridColumnsResizer::~GridColumnsResizer()
@@ -98,22 +526,29 @@ GridColumnsResizer::~GridColumnsResizer()
         for (int id = 0; id < 3; ++id)
         {
             disconnect(m_gridWidget->rows(id).data(), &Lines::linesChanged, this, &GridColumnsResizer::onRowsChanged);
+            disconnect(m_gridWidget->rows(id).data(), &Lines::linesInserted, this, &GridColumnsResizer::onRowsInserted);
+            disconnect(m_gridWidget->rows(id).data(), &Lines::linesRemoved, this, &GridColumnsResizer::onRowsRemoved);
             disconnect(m_gridWidget->columns(id).data(), &Lines::linesChanged, this, &GridColumnsResizer::onColumnsChanged);
         }
+
+        for (const auto& connection : m_itemsConnections)
+            disconnect(connection);
     }
 }
 
 void GridColumnsResizer::setColumnResizeModeNone(int column, GridID subGridId)
 {
     auto& info = m_columns[subGridId.column][column];
+    invalidateColumns(subGridId.column);
     info.mode = ColumnResizeModeNone;
 }
 
 void GridColumnsResizer::setColumnResizeModeFit(int column, GridID subGridId)
 {
     auto& info = m_columns[subGridId.column][column];
+    invalidateColumns(subGridId.column);
     info.mode = ColumnResizeModeFit;
-    info.param.fitSizeCache = FitSizeCacheInvalid;
+    info.invalidateFit();
 }
 
 void GridColumnsResizer::setColumnResizeModeFixed(int column, int size, GridID subGridId)
@@ -121,6 +556,7 @@ void GridColumnsResizer::setColumnResizeModeFixed(int column, int size, GridID s
     Q_ASSERT(size >= 0);
 
     auto& info = m_columns[subGridId.column][column];
+    invalidateColumns(subGridId.column);
     info.mode = ColumnResizeModeFixed;
     info.param.fixedSize = size;
 }
@@ -130,6 +566,7 @@ void GridColumnsResizer::setColumnResizeModeFraction(int column, float fraction,
     Q_ASSERT(fraction >= 0);
 
     auto& info = m_columns[subGridId.column][column];
+    invalidateColumns(subGridId.column);
     info.mode = ColumnResizeModeFraction;
     info.param.fraction = fraction;
 }
@@ -139,6 +576,7 @@ void GridColumnsResizer::setColumnResizeModeFractionN(int column, float fraction
     Q_ASSERT(fractionN >= 0);
 
     auto& info = m_columns[subGridId.column][column];
+    invalidateColumns(subGridId.column);
     info.mode = ColumnResizeModeFractionN;
     info.param.fractionN = fractionN;
 }
@@ -146,6 +584,7 @@ void GridColumnsResizer::setColumnResizeModeFractionN(int column, float fraction
 void GridColumnsResizer::setColumnResizeModeResidue(int column, GridID subGridId)
 {
     auto& info = m_columns[subGridId.column][column];
+    invalidateColumns(subGridId.column);
     info.mode = ColumnResizeModeResidue;
 }
 
@@ -154,16 +593,121 @@ void GridColumnsResizer::setAllColumnResizeModeFit(GridID subGridId)
     for (auto& info : m_columns[subGridId.column])
     {
         info.mode = ColumnResizeModeFit;
-        info.param.fitSizeCache = FitSizeCacheInvalid;
+        info.invalidateFit();
+    }
+    invalidateColumns(subGridId.column);
+}
+
+void GridColumnsResizer::setColumnFitMode(ColumnFitMode fitMode)
+{
+    if (m_fitMode == fitMode)
+        return;
+
+    m_fitMode = fitMode;
+    invalidateFitCache();
+}
+
+void GridColumnsResizer::setFitSampleSize(int fitSampleSize)
+{
+    Q_ASSERT(fitSampleSize > 0);
+
+    if (m_fitSampleSize == fitSampleSize)
+        return;
+
+    m_fitSampleSize = fitSampleSize;
+    if (m_fitMode == ColumnFitModeSampled)
+        invalidateFitCache();
+}
+
+void GridColumnsResizer::setParallelFitMeasurement(bool isParallel)
+{
+    m_isParallelFitMeasurement = isParallel;
+}
+
+QByteArray GridColumnsResizer::saveState() const
+{
+    QByteArray state;
+    QDataStream stream(&state, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    stream << ColumnsResizerStateMagic << ColumnsResizerStateVersion;
+    stream << qint32(m_fitMode) << qint32(m_fitSampleSize);
+    for (int id = 0; id < 3; ++id)
+    {
+        stream << qint32(m_columns[id].size());
+        for (const auto& info : m_columns[id])
+            writeColumnResizeMode(stream, info);
+    }
+
+    return state;
+}
+
+bool GridColumnsResizer::restoreState(const QByteArray& state)
+{
+    QDataStream stream(state);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint32 fitMode = -1;
+    qint32 fitSampleSize = 0;
+    stream >> magic >> version >> fitMode >> fitSampleSize;
+    if (stream.status() != QDataStream::Ok || magic != ColumnsResizerStateMagic || version != ColumnsResizerStateVersion)
+        return false;
+    if (fitMode < ColumnFitModeExact || fitMode > ColumnFitModeIncremental || fitSampleSize <= 0)
+        return false;
+
+    QVector<ColumnResizeModeInfo> columns[3];
+    for (int id = 0; id < 3; ++id)
+    {
+        qint32 count = -1;
+        stream >> count;
+        if (count != m_columns[id].size())
+            return false;
+
+        columns[id].resize(count);
+        for (auto& info : columns[id])
+        {
+            if (!readColumnResizeMode(stream, info))
+                return false;
+        }
     }
+
+    m_fitMode = ColumnFitMode(fitMode);
+    m_fitSampleSize = fitSampleSize;
+    for (int id = 0; id < 3; ++id)
+    {
+        m_columns[id] = columns[id];
+        invalidateColumns(id);
+    }
+
+    doResizeLater();
+    return true;
 }
 
 int GridColumnsResizer::doResize()
+{
+    invalidateFixedWidths();
+    return resizeColumns();
+}
+
+void GridColumnsResizer::doResizeLater()
+{
+    invalidateFixedWidths();
+    resizeColumnsLater();
+}
+
+int GridColumnsResizer::resizeColumns()
 {
     int remainsWidth = m_gridWidget->viewport()->width();
     if (remainsWidth <= 0)
         return 0;
 
+    // own changes of columns keep fixed widths
+    auto_value<bool> resizing(m_isResizing, true);
+
     remainsWidth = doResizeColumns(0, remainsWidth);
     remainsWidth = doResizeColumns(2, remainsWidth);
     remainsWidth = doResizeColumns(1, remainsWidth);
@@ -171,9 +715,13 @@ int GridColumnsResizer::doResize()
     return remainsWidth;
 }
 
-void GridColumnsResizer::doResizeLater()
+void GridColumnsResizer::resizeColumnsLater()
 {
-    callLater(this, [this]() { doResize(); });
+    if (!m_gridWidget)
+        return;
+
+    // resize before the layout of the frame
+    FrameScheduler::of(m_gridWidget)->schedule(FramePhaseLines, this, "doResize", [this]() { resizeColumns(); });
 }
 
 void GridColumnsResizer::invalidateFitCache()
@@ -186,7 +734,7 @@ void GridColumnsResizer::invalidateFitCache()
             if (info.mode == ColumnResizeModeFit &&
                 info.param.fitSizeCache != FitSizeCacheInvalid)
             {
-                info.param.fitSizeCache = FitSizeCacheInvalid;
+                info.invalidateFit();
                 isResizingRequired = true;
             }
         }
@@ -201,30 +749,134 @@ bool GridColumnsResizer::eventFilter(QObject* object, QEvent* event)
 
     if (event->type() == QEvent::Resize)
     {
-        doResizeLater();
+        resizeColumnsLater();
     }
 
     return QObject::eventFilter(object, event);
 }
 
-void GridColumnsResizer::onRowsChanged(const Lines* /*lines*/, ChangeReason reason)
+void GridColumnsResizer::onRowsChanged(const Lines* lines, ChangeReason reason)
 {
-    if (reason & (ChangeReasonLinesCount | ChangeReasonLinesCountWeak))
-        invalidateFitCache();
+    bool isCountChanged = reason & (ChangeReasonLinesCount | ChangeReasonLinesCountWeak);
+    bool isVisibilityChanged = reason & ChangeReasonLinesVisibility;
+    if (!isCountChanged && !isVisibilityChanged)
+        return;
+
+    if (m_fitMode != ColumnFitModeIncremental)
+    {
+        if (isCountChanged)
+            invalidateFitCache();
+        return;
+    }
+
+    // keep running max, new rows will be measured on resize
+    for (int rowsId = 0; rowsId < 3; ++rowsId)
+    {
+        if (m_gridWidget->rows(rowsId).data() != lines)
+            continue;
+
+        for (auto& columns : m_columns)
+            for (auto& info : columns)
+            {
+                if (info.mode != ColumnResizeModeFit)
+                    continue;
+
+                // shown rows may be anywhere in measured ones
+                if (isVisibilityChanged)
+                    info.fitRowsMeasured[rowsId] = 0;
+                else
+                    info.fitRowsMeasured[rowsId] = qMin(info.fitRowsMeasured[rowsId], lines->count());
+            }
+    }
+
+    doResizeLater();
+}
+
+void GridColumnsResizer::onRowsInserted(const Lines* lines, int absoluteLine, int /*linesCount*/)
+{
+    if (m_fitMode != ColumnFitModeIncremental)
+        return;
+
+    for (int rowsId = 0; rowsId < 3; ++rowsId)
+    {
+        if (m_gridWidget->rows(rowsId).data() != lines)
+            continue;
+
+        for (auto& columns : m_columns)
+            for (auto& info : columns)
+                fitRowsInserted(info, rowsId, absoluteLine);
+    }
+}
+
+void GridColumnsResizer::onRowsRemoved(const Lines* lines, int absoluteLine, int linesCount)
+{
+    if (m_fitMode != ColumnFitModeIncremental)
+        return;
+
+    for (int rowsId = 0; rowsId < 3; ++rowsId)
+    {
+        if (m_gridWidget->rows(rowsId).data() != lines)
+            continue;
+
+        for (auto& columns : m_columns)
+            for (auto& info : columns)
+                fitRowsRemoved(info, rowsId, absoluteLine, linesCount);
+    }
+}
+
+void GridColumnsResizer::onItemsChanged(int rowsId, int columnsId, const QVector<ID>& items)
+{
+    if (m_fitMode != ColumnFitModeIncremental)
+        return;
+
+    const auto& grid = *m_gridWidget->subGrid(GridID(rowsId, columnsId));
+    const auto& rows = *grid.rows();
+    const auto& columns = *grid.columns();
+    auto& columnsInfo = m_columns[columnsId];
+
+    bool isResizingRequired = false;
+    for (const auto& item : items)
+    {
+        GridID id = item.as<GridID>();
+        if (id.column < 0 || id.column >= columnsInfo.size() || id.row < 0 || id.row >= rows.count())
+            continue;
+
+        // rows not measured yet will be measured on resize
+        auto& info = columnsInfo[id.column];
+        if (info.mode != ColumnResizeModeFit || info.param.fitSizeCache == FitSizeCacheInvalid ||
+            id.row >= info.fitRowsMeasured[rowsId])
+            continue;
+
+        if (!rows.isLineVisible(id.row) || !columns.isLineVisible(id.column))
+            continue;
+
+        int fitWidth = calculateColumnFitWidth(grid, columns.toVisible(id.column), m_gridWidget->guiContext(),
+                                               QVector<int>(1, rows.toVisible(id.row)));
+        if (fitWidth > info.param.fitSizeCache)
+        {
+            info.param.fitSizeCache = fitWidth;
+            isResizingRequired = true;
+        }
+    }
+
+    if (isResizingRequired)
+        doResizeLater();
 }
 
 void GridColumnsResizer::onColumnsChanged(const Lines* lines, ChangeReason reason)
 {
-    if (reason & ChangeReasonLinesCount)
+    for (int id = 0; id < 3; ++id)
     {
-        for (int id = 0; id < 3; ++id)
-        {
-            if (m_gridWidget->columns(id).data() == lines)
-            {
-                initColumns(id, m_gridWidget->columns(id)->count());
-                break;
-            }
-        }
+        if (m_gridWidget->columns(id).data() != lines)
+            continue;
+
+        if (reason & ChangeReasonLinesCount)
+            initColumns(id, m_gridWidget->columns(id)->count());
+
+        // sizes or visibility of columns are changed outside
+        if (!m_isResizing)
+            m_isFixedWidthValid[id] = false;
+        break;
     }
 }
 
@@ -234,6 +886,8 @@ void GridColumnsResizer::initColumns(int columnsId, int count)
     if (columns.size() == count)
         return;
 
+    invalidateColumns(columnsId);
+
     if (count == 0)
     {
         columns.clear();
@@ -266,138 +920,156 @@ int GridColumnsResizer::doResizeColumns(int columnsId, int remainsWidth)
     if (columns.isEmptyVisible())
         return remainsWidth;
 
-    // process ColumnResizeModeNone
-    {
-        int widthProcessed = 0;
-        for (int column = 0; column < columns.count(); ++column)
-        {
-            if (!columns.isLineVisible(column))
-                continue;
-
-            const auto& info = columnsInfo[column];
-            if (info.mode == ColumnResizeModeNone)
-            {
-                widthProcessed += columns.lineSize(column);
-            }
-        }
-        remainsWidth -= widthProcessed;
+    const auto& runs = columnsRuns(columnsId);
 
-        if (remainsWidth <= 0)
-            return 0;
+    if (!m_isFixedWidthValid[columnsId])
+    {
+        measureFitWidthsParallel(columnsId);
+
+        // not completed fit measurement invalidates it again
+        m_isFixedWidthValid[columnsId] = true;
+        m_fixedWidth[columnsId] = resizeFixedColumnsByRuns(columns, columnsInfo, runs,
+                                                           [this, columnsId](int visibleColumn, ColumnResizeModeInfo& info) {
+            return columnFitWidth(columnsId, visibleColumn, info);
+        });
     }
 
-    // process ColumnResizeModeFixed
-    {
-        int widthProcessed = 0;
-        for (int column = 0; column < columns.count(); ++column)
-        {
-            if (!columns.isLineVisible(column))
-                continue;
+    remainsWidth -= m_fixedWidth[columnsId];
+    if (remainsWidth <= 0)
+        return 0;
 
-            const auto& info = columnsInfo[column];
-            if (info.mode == ColumnResizeModeFixed)
-            {
-                columns.setLineSize(column, info.param.fixedSize);
-                widthProcessed += columns.lineSize(column);
-            }
-        }
-        remainsWidth -= widthProcessed;
+    int totalColumnsCount = m_gridWidget->columns(0)->visibleCount();
+    totalColumnsCount += m_gridWidget->columns(1)->visibleCount();
+    totalColumnsCount += m_gridWidget->columns(2)->visibleCount();
 
-        if (remainsWidth <= 0)
-            return 0;
-    }
+    return resizeFractionColumnsByRuns(columns, columnsInfo, runs, remainsWidth, totalColumnsCount, 0);
+}
 
-    // process ColumnResizeModeFit
-    {
-        int widthProcessed = 0;
-        for (int column = 0; column < columns.count(); ++column)
-        {
-            if (!columns.isLineVisible(column))
-                continue;
+void GridColumnsResizer::invalidateColumns(int columnsId)
+{
+    m_columnsRuns[columnsId].clear();
+    m_isFixedWidthValid[columnsId] = false;
+}
 
-            auto& info = columnsInfo[column];
-            if (info.mode == ColumnResizeModeFit)
-            {
-                columns.setLineSize(column, columnFitWidth(columnsId, columns.toVisible(column), info));
-                widthProcessed += columns.lineSize(column);
-            }
-        }
-        remainsWidth -= widthProcessed;
+void GridColumnsResizer::invalidateFixedWidths()
+{
+    for (int id = 0; id < 3; ++id)
+        m_isFixedWidthValid[id] = false;
+}
 
-        if (remainsWidth <= 0)
-            return 0;
-    }
+const QVector<ColumnsResizeRun>& GridColumnsResizer::columnsRuns(int columnsId)
+{
+    auto& runs = m_columnsRuns[columnsId];
+    if (runs.isEmpty())
+        runs = createColumnsResizeRuns(m_columns[columnsId]);
+    return runs;
+}
 
-    // process ColumnResizeModeFraction and ColumnResizeModeFractionN
-    {
-        int totalColumnsCount = m_gridWidget->columns(0)->visibleCount();
-        totalColumnsCount += m_gridWidget->columns(1)->visibleCount();
-        totalColumnsCount += m_gridWidget->columns(2)->visibleCount();
+void GridColumnsResizer::measureFitWidthsParallel(int columnsId)
+{
+    if (!m_isParallelFitMeasurement || m_fitMode == ColumnFitModeIncremental)
+        return;
 
-        int widthProcessed = 0;
-        for (int column = 0; column < columns.count(); ++column)
-        {
-            if (!columns.isLineVisible(column))
-                continue;
+    auto& columnsInfo = m_columns[columnsId];
+    QVector<int> fitColumns;
+    QVector<int> visibleColumns;
+    collectFitColumnsToMeasure(*m_gridWidget->columns(columnsId), columnsInfo, columnsRuns(columnsId), fitColumns, visibleColumns);
 
-            const auto& info = columnsInfo[column];
-            if (info.mode == ColumnResizeModeFraction)
-            {
-                columns.setLineSize(column, int((float)remainsWidth*info.param.fraction));
-                widthProcessed += columns.lineSize(column);
-            }
-            else if (info.mode == ColumnResizeModeFractionN)
-            {
-                columns.setLineSize(column, int((float)remainsWidth*info.param.fractionN/(float)totalColumnsCount));
-                widthProcessed += columns.lineSize(column);
-            }
-        }
-        remainsWidth -= widthProcessed;
+    // single column is measured in place
+    if (fitColumns.size() < 2)
+        return;
 
-        if (remainsWidth <= 0)
-            return 0;
+    int sampleSize = (m_fitMode == ColumnFitModeSampled) ? m_fitSampleSize : 0;
+    QVector<int> fitWidths(fitColumns.size(), 0);
+    for (int rowsId = 0; rowsId < 3; ++rowsId)
+    {
+        GridID subGridId(rowsId, columnsId);
+        auto widths = calculateColumnsFitWidthParallel(*m_gridWidget->subGrid(subGridId),
+                                                       m_gridWidget->cacheSubGrid(subGridId).data(),
+                                                       visibleColumns,
+                                                       m_gridWidget->guiContext(),
+                                                       sampleSize);
+        for (int i = 0; i < widths.size(); ++i)
+            fitWidths[i] = qMax(fitWidths[i], widths[i]);
     }
 
-    // process ColumnResizeModeResidue
+    // columnFitWidth takes measured widths from caches
+    for (int i = 0; i < fitColumns.size(); ++i)
+        columnsInfo[fitColumns[i]].param.fitSizeCache = fitWidths[i];
+}
+
+int GridColumnsResizer::columnFitWidth(int columnsId, int visibleColumn, Impl::ColumnResizeModeInfo& info)
+{
+    Q_ASSERT(info.mode == ColumnResizeModeFit);
+
+    switch (m_fitMode)
     {
-        for (int column = 0; column < columns.count(); ++column)
-        {
-            if (!columns.isLineVisible(column))
-                continue;
+    case ColumnFitModeExact:
+        if (info.param.fitSizeCache == FitSizeCacheInvalid)
+            info.param.fitSizeCache = calculateGridColumnFitWidth(*m_gridWidget, columnsId, visibleColumn);
+        break;
 
-            const auto& info = columnsInfo[column];
-            if (info.mode == ColumnResizeModeResidue)
+    case ColumnFitModeSampled:
+        if (info.param.fitSizeCache == FitSizeCacheInvalid)
+        {
+            int fitWidth = 0;
+            for (int rowsId = 0; rowsId < 3; ++rowsId)
             {
-                // first ColumnResizeModeResidue will occupy all free space
-                // all other would got 0
-                columns.setLineSize(column, remainsWidth);
-                remainsWidth = 0;
+                GridID subGridId(rowsId, columnsId);
+                fitWidth = qMax(fitWidth, calculateColumnFitWidthSampled(*m_gridWidget->subGrid(subGridId),
+                                                                         m_gridWidget->cacheSubGrid(subGridId).data(),
+                                                                         visibleColumn,
+                                                                         m_gridWidget->guiContext(),
+                                                                         m_fitSampleSize));
             }
+            info.param.fitSizeCache = fitWidth;
         }
-    }
+        break;
 
-    return remainsWidth;
-}
+    case ColumnFitModeIncremental:
+    {
+        if (info.param.fitSizeCache == FitSizeCacheInvalid)
+            info.param.fitSizeCache = 0;
 
-int GridColumnsResizer::columnFitWidth(int columnsId, int visibleColumn, Impl::ColumnResizeModeInfo& info)
-{
-    Q_ASSERT(info.mode == ColumnResizeModeFit);
+        bool isCompleted = true;
+        int budget = m_fitSampleSize;
+        for (int rowsId = 0; rowsId < 3; ++rowsId)
+        {
+            const auto& grid = *m_gridWidget->subGrid(GridID(rowsId, columnsId));
+            int fitWidth = calculateColumnFitWidthIncremental(grid, visibleColumn, m_gridWidget->guiContext(),
+                                                              info.fitRowsMeasured[rowsId], budget);
+            info.param.fitSizeCache = qMax(info.param.fitSizeCache, fitWidth);
+            isCompleted = isCompleted && (info.fitRowsMeasured[rowsId] >= grid.rows()->count());
+        }
 
-    if (info.param.fitSizeCache == FitSizeCacheInvalid)
-        info.param.fitSizeCache = calculateGridColumnFitWidth(*m_gridWidget, columnsId, visibleColumn);
+        // measure the rest of rows on next resize
+        if (!isCompleted)
+            doResizeLater();
+    }
+        break;
+    }
 
     return info.param.fitSizeCache;
 }
 
 
 ListColumnsResizer::ListColumnsResizer(ListWidget* listWidget)
-    : m_listWidget(listWidget)
+    : m_listWidget(listWidget),
+      m_fixedWidth(0),
+      m_isFixedWidthValid(false),
+      m_isResizing(false),
+      m_fitMode(ColumnFitModeExact),
+      m_fitSampleSize(FitSampleSizeDefault),
+      m_isParallelFitMeasurement(false)
 {
     Q_ASSERT(!m_listWidget.isNull());
     m_listWidget->viewport()->installEventFilter(this);
 
     connect(m_listWidget->rows().data(), &Lines::linesChanged, this, &ListColumnsResizer::onRowsChanged);
+    connect(m_listWidget->rows().data(), &Lines::linesInserted, this, &ListColumnsResizer::onRowsInserted);
+    connect(m_listWidget->rows().data(), &Lines::linesRemoved, this, &ListColumnsResizer::onRowsRemoved);
     connect(m_listWidget->columns().data(), &Lines::linesChanged, this, &ListColumnsResizer::onColumnsChanged);
+    connect(m_listWidget->grid().data(), &Space::spaceItemsChanged, this, &ListColumnsResizer::onItemsChanged);
     initColumns(m_listWidget->columns()->count());
 }
 
@@ -408,21 +1080,26 @@ ListColumnsResizer::~ListColumnsResizer()
         m_listWidget->viewport()->removeEventFilter(this);
 
         disconnect(m_listWidget->rows().data(), &Lines::linesChanged, this, &ListColumnsResizer::onRowsChanged);
+        disconnect(m_listWidget->rows().data(), &Lines::linesInserted, this, &ListColumnsResizer::onRowsInserted);
+        disconnect(m_listWidget->rows().data(), &Lines::linesRemoved, this, &ListColumnsResizer::onRowsRemoved);
         disconnect(m_listWidget->columns().data(), &Lines::linesChanged, this, &ListColumnsResizer::onColumnsChanged);
+        disconnect(m_listWidget->grid().data(), &Space::spaceItemsChanged, this, &ListColumnsResizer::onItemsChanged);
     }
 }
 
 void ListColumnsResizer::setColumnResizeModeNone(int column)
 {
     auto& info = m_columns[column];
+    invalidateColumns();
     info.mode = ColumnResizeModeNone;
 }
 
 void ListColumnsResizer::setColumnResizeModeFit(int column)
 {
     auto& info = m_columns[column];
+    invalidateColumns();
     info.mode = ColumnResizeModeFit;
-    info.param.fitSizeCache = FitSizeCacheInvalid;
+    info.invalidateFit();
 }
 
 void ListColumnsResizer::setColumnResizeModeFixed(int column, int size)
@@ -430,6 +1107,7 @@ void ListColumnsResizer::setColumnResizeModeFixed(int column, int size)
     Q_ASSERT(size >= 0);
 
     auto& info = m_columns[column];
+    invalidateColumns();
     info.mode = ColumnResizeModeFixed;
     info.param.fixedSize = size;
 }
@@ -439,6 +1117,7 @@ void ListColumnsResizer::setColumnResizeModeFraction(int column, float fraction)
     Q_ASSERT(fraction >= 0);
 
     auto& info = m_columns[column];
+    invalidateColumns();
     info.mode = ColumnResizeModeFraction;
     info.param.fraction = fraction;
 }
@@ -448,6 +1127,7 @@ void ListColumnsResizer::setColumnResizeModeFractionN(int column, float fraction
     Q_ASSERT(fractionN >= 0);
 
     auto& info = m_columns[column];
+    invalidateColumns();
     info.mode = ColumnResizeModeFractionN;
     info.param.fractionN = fractionN;
 }
@@ -455,6 +1135,7 @@ void ListColumnsResizer::setColumnResizeModeFractionN(int column, float fraction
 void ListColumnsResizer::setColumnResizeModeResidue(int column)
 {
     auto& info = m_columns[column];
+    invalidateColumns();
     info.mode = ColumnResizeModeResidue;
 }
 
@@ -463,22 +1144,68 @@ void ListColumnsResizer::setAllColumnResizeModeFit()
     for (auto& info : m_columns)
     {
         info.mode = ColumnResizeModeFit;
-        info.param.fitSizeCache = FitSizeCacheInvalid;
+        info.invalidateFit();
     }
+    invalidateColumns();
+}
+
+void ListColumnsResizer::setColumnFitMode(ColumnFitMode fitMode)
+{
+    if (m_fitMode == fitMode)
+        return;
+
+    m_fitMode = fitMode;
+    invalidateFitCache();
+}
+
+void ListColumnsResizer::setFitSampleSize(int fitSampleSize)
+{
+    Q_ASSERT(fitSampleSize > 0);
+
+    if (m_fitSampleSize == fitSampleSize)
+        return;
+
+    m_fitSampleSize = fitSampleSize;
+    if (m_fitMode == ColumnFitModeSampled)
+        invalidateFitCache();
+}
+
+void ListColumnsResizer::setParallelFitMeasurement(bool isParallel)
+{
+    m_isParallelFitMeasurement = isParallel;
 }
 
 int ListColumnsResizer::doResize()
+{
+    m_isFixedWidthValid = false;
+    return resizeColumns();
+}
+
+void ListColumnsResizer::doResizeLater()
+{
+    m_isFixedWidthValid = false;
+    resizeColumnsLater();
+}
+
+int ListColumnsResizer::resizeColumns()
 {
     int remainsWidth = m_listWidget->viewport()->width();
     if (remainsWidth <= 0)
         return 0;
 
+    // own changes of columns keep fixed width
+    auto_value<bool> resizing(m_isResizing, true);
+
     return doResizeColumns(remainsWidth);
 }
 
-void ListColumnsResizer::doResizeLater()
+void ListColumnsResizer::resizeColumnsLater()
 {
-    callLater(this, [this]() { doResize(); });
+    if (!m_listWidget)
+        return;
+
+    // resize before the layout of the frame
+    FrameScheduler::of(m_listWidget)->schedule(FramePhaseLines, this, "doResize", [this]() { resizeColumns(); });
 }
 
 void ListColumnsResizer::invalidateFitCache()
@@ -490,7 +1217,7 @@ void ListColumnsResizer::invalidateFitCache()
         if (info.mode == ColumnResizeModeFit &&
             info.param.fitSizeCache != FitSizeCacheInvalid)
         {
-            info.param.fitSizeCache = FitSizeCacheInvalid;
+            info.invalidateFit();
             isResizingRequired = true;
         }
     }
@@ -505,17 +1232,96 @@ bool ListColumnsResizer::eventFilter(QObject* object, QEvent* event)
 
     if (event->type() == QEvent::Resize)
     {
-        doResize();
-        //doResizeLater();
+        resizeColumnsLater();
     }
 
     return QObject::eventFilter(object, event);
 }
 
-void ListColumnsResizer::onRowsChanged(const Lines* /*lines*/, ChangeReason reason)
+void ListColumnsResizer::onRowsChanged(const Lines* lines, ChangeReason reason)
 {
-    if (reason & (ChangeReasonLinesCount | ChangeReasonLinesCountWeak))
-        invalidateFitCache();
+    bool isCountChanged = reason & (ChangeReasonLinesCount | ChangeReasonLinesCountWeak);
+    bool isVisibilityChanged = reason & ChangeReasonLinesVisibility;
+    if (!isCountChanged && !isVisibilityChanged)
+        return;
+
+    if (m_fitMode != ColumnFitModeIncremental)
+    {
+        if (isCountChanged)
+            invalidateFitCache();
+        return;
+    }
+
+    // keep running max, new rows will be measured on resize
+    for (auto& info : m_columns)
+    {
+        if (info.mode != ColumnResizeModeFit)
+            continue;
+
+        // shown rows may be anywhere in measured ones
+        if (isVisibilityChanged)
+            info.fitRowsMeasured[0] = 0;
+        else
+            info.fitRowsMeasured[0] = qMin(info.fitRowsMeasured[0], lines->count());
+    }
+
+    doResizeLater();
+}
+
+void ListColumnsResizer::onRowsInserted(const Lines* /*lines*/, int absoluteLine, int /*linesCount*/)
+{
+    if (m_fitMode != ColumnFitModeIncremental)
+        return;
+
+    for (auto& info : m_columns)
+        fitRowsInserted(info, 0, absoluteLine);
+}
+
+void ListColumnsResizer::onRowsRemoved(const Lines* /*lines*/, int absoluteLine, int linesCount)
+{
+    if (m_fitMode != ColumnFitModeIncremental)
+        return;
+
+    for (auto& info : m_columns)
+        fitRowsRemoved(info, 0, absoluteLine, linesCount);
+}
+
+void ListColumnsResizer::onItemsChanged(const Space* /*space*/, const QVector<ID>& items)
+{
+    if (m_fitMode != ColumnFitModeIncremental)
+        return;
+
+    const auto& grid = *m_listWidget->grid();
+    const auto& rows = *grid.rows();
+    const auto& columns = *grid.columns();
+
+    bool isResizingRequired = false;
+    for (const auto& item : items)
+    {
+        GridID id = item.as<GridID>();
+        if (id.column < 0 || id.column >= m_columns.size() || id.row < 0 || id.row >= rows.count())
+            continue;
+
+        // rows not measured yet will be measured on resize
+        auto& info = m_columns[id.column];
+        if (info.mode != ColumnResizeModeFit || info.param.fitSizeCache == FitSizeCacheInvalid ||
+            id.row >= info.fitRowsMeasured[0])
+            continue;
+
+        if (!rows.isLineVisible(id.row) || !columns.isLineVisible(id.column))
+            continue;
+
+        int fitWidth = calculateColumnFitWidth(grid, columns.toVisible(id.column), m_listWidget->guiContext(),
+                                               QVector<int>(1, rows.toVisible(id.row)));
+        if (fitWidth > info.param.fitSizeCache)
+        {
+            info.param.fitSizeCache = fitWidth;
+            isResizingRequired = true;
+        }
+    }
+
+    if (isResizingRequired)
+        doResizeLater();
 }
 
 void ListColumnsResizer::onColumnsChanged(const Lines* /*lines*/, ChangeReason reason)
@@ -524,6 +1330,10 @@ void ListColumnsResizer::onColumnsChanged(const Lines* /*lines*/, ChangeReason r
     {
         initColumns(m_listWidget->columns()->count());
     }
+
+    // sizes or visibility of columns are changed outside
+    if (!m_isResizing)
+        m_isFixedWidthValid = false;
 }
 
 void ListColumnsResizer::initColumns(int count)
@@ -532,6 +1342,8 @@ void ListColumnsResizer::initColumns(int count)
     if (columns.size() == count)
         return;
 
+    invalidateColumns();
+
     if (count == 0)
     {
         columns.clear();
@@ -557,123 +1369,103 @@ int ListColumnsResizer::doResizeColumns(int remainsWidth)
     if (columns.isEmptyVisible())
         return remainsWidth;
 
-    // process ColumnResizeModeNone
-    {
-        int widthProcessed = 0;
-        for (int column = 0; column < columns.count(); ++column)
-        {
-            if (!columns.isLineVisible(column))
-                continue;
-
-            const auto& info = columnsInfo[column];
-            if (info.mode == ColumnResizeModeNone)
-            {
-                widthProcessed += columns.lineSize(column);
-            }
-        }
-        remainsWidth -= widthProcessed;
+    const auto& runs = columnsRuns();
 
-        if (remainsWidth <= 0)
-            return 0;
+    if (!m_isFixedWidthValid)
+    {
+        measureFitWidthsParallel();
+
+        // not completed fit measurement invalidates it again
+        m_isFixedWidthValid = true;
+        m_fixedWidth = resizeFixedColumnsByRuns(columns, columnsInfo, runs,
+                                                [this](int visibleColumn, ColumnResizeModeInfo& info) {
+            return columnFitWidth(visibleColumn, info);
+        });
     }
 
-    // process ColumnResizeModeFixed
-    {
-        int widthProcessed = 0;
-        for (int column = 0; column < columns.count(); ++column)
-        {
-            if (!columns.isLineVisible(column))
-                continue;
+    remainsWidth -= m_fixedWidth;
+    if (remainsWidth <= 0)
+        return 0;
 
-            const auto& info = columnsInfo[column];
-            if (info.mode == ColumnResizeModeFixed)
-            {
-                columns.setLineSize(column, info.param.fixedSize);
-                widthProcessed += columns.lineSize(column);
-            }
-        }
-        remainsWidth -= widthProcessed;
+    return resizeFractionColumnsByRuns(columns, columnsInfo, runs, remainsWidth, columns.visibleCount(), 2);
+}
 
-        if (remainsWidth <= 0)
-            return 0;
-    }
+void ListColumnsResizer::invalidateColumns()
+{
+    m_columnsRuns.clear();
+    m_isFixedWidthValid = false;
+}
 
-    // process ColumnResizeModeFit
-    {
-        int widthProcessed = 0;
-        for (int column = 0; column < columns.count(); ++column)
-        {
-            if (!columns.isLineVisible(column))
-                continue;
+const QVector<ColumnsResizeRun>& ListColumnsResizer::columnsRuns()
+{
+    if (m_columnsRuns.isEmpty())
+        m_columnsRuns = createColumnsResizeRuns(m_columns);
+    return m_columnsRuns;
+}
 
-            auto& info = columnsInfo[column];
-            if (info.mode == ColumnResizeModeFit)
-            {
-                columns.setLineSize(column, columnFitWidth(columns.toVisible(column), info));
-                widthProcessed += columns.lineSize(column);
-            }
-        }
-        remainsWidth -= widthProcessed;
+void ListColumnsResizer::measureFitWidthsParallel()
+{
+    if (!m_isParallelFitMeasurement || m_fitMode == ColumnFitModeIncremental)
+        return;
 
-        if (remainsWidth <= 0)
-            return 0;
-    }
+    QVector<int> fitColumns;
+    QVector<int> visibleColumns;
+    collectFitColumnsToMeasure(*m_listWidget->columns(), m_columns, columnsRuns(), fitColumns, visibleColumns);
 
-    // process ColumnResizeModeFraction and ColumnResizeModeFractionN
-    {
-        int totalColumnsCount = m_listWidget->columns()->visibleCount();
+    // single column is measured in place
+    if (fitColumns.size() < 2)
+        return;
 
-        int widthProcessed = 0;
-        for (int column = 0; column < columns.count(); ++column)
-        {
-            if (!columns.isLineVisible(column))
-                continue;
+    int sampleSize = (m_fitMode == ColumnFitModeSampled) ? m_fitSampleSize : 0;
+    auto fitWidths = calculateColumnsFitWidthParallel(*m_listWidget->grid(),
+                                                      m_listWidget->cacheGrid().data(),
+                                                      visibleColumns,
+                                                      m_listWidget->guiContext(),
+                                                      sampleSize);
 
-            const auto& info = columnsInfo[column];
-            if (info.mode == ColumnResizeModeFraction)
-            {
-                columns.setLineSize(column, int((float)remainsWidth*info.param.fraction));
-                widthProcessed += columns.lineSize(column);
-            }
-            else if (info.mode == ColumnResizeModeFractionN)
-            {
-                columns.setLineSize(column, int((float)remainsWidth*info.param.fractionN/(float)totalColumnsCount));
-                widthProcessed += columns.lineSize(column);
-            }
-        }
-        remainsWidth -= widthProcessed;
+    // columnFitWidth takes measured widths from caches
+    for (int i = 0; i < fitColumns.size(); ++i)
+        m_columns[fitColumns[i]].param.fitSizeCache = fitWidths[i];
+}
 
-        if (remainsWidth <= 0)
-            return 0;
-    }
+int ListColumnsResizer::columnFitWidth(int visibleColumn, Impl::ColumnResizeModeInfo& info)
+{
+    Q_ASSERT(info.mode == ColumnResizeModeFit);
 
-    // process ColumnResizeModeResidue
+    switch (m_fitMode)
     {
-        for (int column = 0; column < columns.count(); ++column)
-        {
-            if (!columns.isLineVisible(column))
-                continue;
+    case ColumnFitModeExact:
+        if (info.param.fitSizeCache == FitSizeCacheInvalid)
+            info.param.fitSizeCache = calculateColumnFitWidth(*m_listWidget->grid(), visibleColumn, m_listWidget->guiContext());
+        break;
 
-            const auto& info = columnsInfo[column];
-            if (info.mode == ColumnResizeModeResidue)
-            {
-                // first ColumnResizeModeResidue will occupy all free space
-                // all other would got 0
-                columns.setLineSize(column, remainsWidth-2);
-                remainsWidth = 0;
-            }
+    case ColumnFitModeSampled:
+        if (info.param.fitSizeCache == FitSizeCacheInvalid)
+        {
+            info.param.fitSizeCache = calculateColumnFitWidthSampled(*m_listWidget->grid(),
+                                                                     m_listWidget->cacheGrid().data(),
+                                                                     visibleColumn,
+                                                                     m_listWidget->guiContext(),
+                                                                     m_fitSampleSize);
         }
-    }
+        break;
 
-    return remainsWidth;
-}
+    case ColumnFitModeIncremental:
+    {
+        if (info.param.fitSizeCache == FitSizeCacheInvalid)
+            info.param.fitSizeCache = 0;
 
-int ListColumnsResizer::columnFitWidth(int visibleColumn, Impl::ColumnResizeModeInfo& info)
-{
-    Q_ASSERT(info.mode == ColumnResizeModeFit);
+        int budget = m_fitSampleSize;
+        int fitWidth = calculateColumnFitWidthIncremental(*m_listWidget->grid(), visibleColumn, m_listWidget->guiContext(),
+                                                          info.fitRowsMeasured[0], budget);
+        info.param.fitSizeCache = qMax(info.param.fitSizeCache, fitWidth);
 
-    if (info.param.fitSizeCache == FitSizeCacheInvalid)
-        info.param.fitSizeCache = calculateColumnFitWidth(*m_listWidget->grid(), visibleColumn, m_listWidget->guiContext());
+        // measure the rest of rows on next resize
+        if (info.fitRowsMeasured[0] < m_listWidget->rows()->count())
+            doResizeLater();
+    }
+        break;
+    }
 
     return info.param.fitSizeCache;
 }
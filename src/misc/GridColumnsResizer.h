@@ -26,9 +26,29 @@ namespace Qi
 class GridWidget;
 class ListWidget;
 class GuiContext;
+class CacheSpaceGrid;
 
 QI_EXPORT int calculateColumnFitWidth(const SpaceGrid& grid, int visibleColumn, const GuiContext& ctx);
 QI_EXPORT int calculateGridColumnFitWidth(const GridWidget& gridWidget, int columnsId, int visibleColumn);
+// measures given visible rows only
+QI_EXPORT int calculateColumnFitWidth(const SpaceGrid& grid, int visibleColumn, const GuiContext& ctx, const QVector<int>& visibleRows);
+// measures rows visible in cacheGrid frame and sampleSize rows picked evenly at random
+QI_EXPORT int calculateColumnFitWidthSampled(const SpaceGrid& grid, const CacheSpaceGrid* cacheGrid, int visibleColumn, const GuiContext& ctx, int sampleSize);
+// measures columns in worker threads, sampleSize <= 0 measures all rows
+// views and models of the columns should be safe to read from worker threads
+QI_EXPORT QVector<int> calculateColumnsFitWidthParallel(const SpaceGrid& grid, const CacheSpaceGrid* cacheGrid, const QVector<int>& visibleColumns, const GuiContext& ctx, int sampleSize);
+
+enum ColumnFitMode
+{
+    // fit width is calculated by all rows
+    ColumnFitModeExact,
+    // fit width is calculated by visible rows and random sample of rows
+    ColumnFitModeSampled,
+    // fit width is running max of rows measured so far,
+    // added rows are measured by portions and edited rows are measured on change
+    // rows hidden when measured are skipped, running max doesn't shrink until invalidateFitCache
+    ColumnFitModeIncremental
+};
 
 enum ColumnResizeMode
 {
@@ -54,7 +74,19 @@ struct ColumnResizeModeInfo
         float fractionN;
     } param;
 
+    // absolute rows of each rows id measured by ColumnFitModeIncremental
+    int fitRowsMeasured[3];
+
     ColumnResizeModeInfo();
+
+    void invalidateFit();
+};
+
+// consecutive columns with the same resize mode and parameter
+struct ColumnsResizeRun
+{
+    int first;
+    int count;
 };
 
 } //end namespace Impl
@@ -77,21 +109,64 @@ public:
 
     void setAllColumnResizeModeFit(GridID subGridId = clientID);
 
+    ColumnFitMode columnFitMode() const { return m_fitMode; }
+    void setColumnFitMode(ColumnFitMode fitMode);
+    // rows measured per column by ColumnFitModeSampled
+    // or per resize by ColumnFitModeIncremental
+    int fitSampleSize() const { return m_fitSampleSize; }
+    void setFitSampleSize(int fitSampleSize);
+    // measures fit columns in worker threads by ColumnFitModeExact and ColumnFitModeSampled
+    // views and models of fit columns should be safe to read from worker threads
+    bool isParallelFitMeasurement() const { return m_isParallelFitMeasurement; }
+    void setParallelFitMeasurement(bool isParallel);
+
+    // recalculates all columns widths
     int doResize();
+    // schedules doResize once per frame
     void doResizeLater();
     void invalidateFitCache();
 
+    // binary state of columns resize modes, fit mode and sample size
+    QByteArray saveState() const;
+    // restores state of saveState and schedules one doResize,
+    // columns should be restored before so columns counts are the same as when saved
+    // returns false and keeps modes unchanged if state is invalid
+    bool restoreState(const QByteArray& state);
+
+    // viewport resize redistributes fraction and residue widths only
     bool eventFilter(QObject* object, QEvent* event) override;
 
 private:
     void onRowsChanged(const Lines* lines, ChangeReason reason);
+    void onRowsInserted(const Lines* lines, int absoluteLine, int linesCount);
+    void onRowsRemoved(const Lines* lines, int absoluteLine, int linesCount);
     void onColumnsChanged(const Lines* lines, ChangeReason reason);
+    void onItemsChanged(int rowsId, int columnsId, const QVector<ID>& items);
     void initColumns(int columnsId, int count);
     int doResizeColumns(int columnsId, int remainsWidth);
     int columnFitWidth(int columnsId, int visibleColumn, Impl::ColumnResizeModeInfo& info);
+    // fills fit width caches of not measured columns
+    void measureFitWidthsParallel(int columnsId);
+    const QVector<Impl::ColumnsResizeRun>& columnsRuns(int columnsId);
+    void invalidateColumns(int columnsId);
+    void invalidateFixedWidths();
+    // resizes by cached fixed widths if they are valid
+    int resizeColumns();
+    // schedules resizeColumns for viewport resize, fixed widths are kept
+    void resizeColumnsLater();
 
     QPointer<GridWidget> m_gridWidget;
     QVector<Impl::ColumnResizeModeInfo> m_columns[3];
+    // runs of m_columns, empty if invalid
+    QVector<Impl::ColumnsResizeRun> m_columnsRuns[3];
+    // width of none, fixed and fit columns which doesn't depend on viewport width
+    int m_fixedWidth[3];
+    bool m_isFixedWidthValid[3];
+    bool m_isResizing;
+    ColumnFitMode m_fitMode;
+    int m_fitSampleSize;
+    bool m_isParallelFitMeasurement;
+    QVector<QMetaObject::Connection> m_itemsConnections;
 
     static const GridID clientID;
 };
@@ -114,21 +189,55 @@ public:
 
     void setAllColumnResizeModeFit();
 
+    ColumnFitMode columnFitMode() const { return m_fitMode; }
+    void setColumnFitMode(ColumnFitMode fitMode);
+    // rows measured per column by ColumnFitModeSampled
+    // or per resize by ColumnFitModeIncremental
+    int fitSampleSize() const { return m_fitSampleSize; }
+    void setFitSampleSize(int fitSampleSize);
+    // measures fit columns in worker threads by ColumnFitModeExact and ColumnFitModeSampled
+    // views and models of fit columns should be safe to read from worker threads
+    bool isParallelFitMeasurement() const { return m_isParallelFitMeasurement; }
+    void setParallelFitMeasurement(bool isParallel);
+
+    // recalculates all columns widths
     int doResize();
+    // schedules doResize once per frame
     void doResizeLater();
     void invalidateFitCache();
 
+    // viewport resize redistributes fraction and residue widths only
     bool eventFilter(QObject* object, QEvent* event) override;
 
 private:
     void onRowsChanged(const Lines* lines, ChangeReason reason);
+    void onRowsInserted(const Lines* lines, int absoluteLine, int linesCount);
+    void onRowsRemoved(const Lines* lines, int absoluteLine, int linesCount);
     void onColumnsChanged(const Lines* lines, ChangeReason reason);
+    void onItemsChanged(const Space* space, const QVector<ID>& items);
     void initColumns(int count);
     int doResizeColumns(int remainsWidth);
     int columnFitWidth(int visibleColumn, Impl::ColumnResizeModeInfo& info);
+    // fills fit width caches of not measured columns
+    void measureFitWidthsParallel();
+    const QVector<Impl::ColumnsResizeRun>& columnsRuns();
+    void invalidateColumns();
+    // resizes by cached fixed width if it is valid
+    int resizeColumns();
+    // schedules resizeColumns for viewport resize, fixed width is kept
+    void resizeColumnsLater();
 
     QPointer<ListWidget> m_listWidget;
     QVector<Impl::ColumnResizeModeInfo> m_columns;
+    // runs of m_columns, empty if invalid
+    QVector<Impl::ColumnsResizeRun> m_columnsRuns;
+    // width of none, fixed and fit columns which doesn't depend on viewport width
+    int m_fixedWidth;
+    bool m_isFixedWidthValid;
+    bool m_isResizing;
+    ColumnFitMode m_fitMode;
+    int m_fitSampleSize;
+    bool m_isParallelFitMeasurement;
 };
 
 class QI_EXPORT ControllerMouseColumnsAutoFit: public ControllerMouse
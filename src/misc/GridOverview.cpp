@@ -0,0 +1,350 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "GridOverview.h"
+#include "utils/CallLater.h"
+#include <QTimer>
+#include "utils/TaskPool.h"
+#include <atomic>
+#include <algorithm>
+
+namespace Qi
+{
+
+struct GridOverview::BuildJob
+{
+    LinesSnapshot rows;
+    QVector<Column> columns;
+    QSize size;
+    int samplesPerBucket = 0;
+    // pixels by image rows, row is ready once bucketsBuilt is greater than its index
+    QVector<QRgb> pixels;
+    TaskToken token;
+    std::atomic<int> bucketsBuilt { 0 };
+};
+
+static const int OverviewSamplesPerBucket = 16;
+// interval to copy built buckets to the image
+static const int OverviewProgressInterval = 50;
+
+GridOverview::GridOverview(SharedPtr<SpaceGrid> grid, QObject* parent)
+    : QObject(parent),
+      m_grid(std::move(grid)),
+      m_samplesPerBucket(OverviewSamplesPerBucket),
+      m_size(0, 0),
+      m_bucketsCopied(0),
+      m_progressTimer(new QTimer(this)),
+      m_isItemsChanged(false)
+{
+    Q_ASSERT(m_grid);
+
+    m_progressTimer->setInterval(OverviewProgressInterval);
+    connect(m_progressTimer, &QTimer::timeout, this, &GridOverview::copyBuiltBuckets);
+    connect(m_grid->rows().data(), &Lines::linesChanged, this, &GridOverview::onRowsChanged);
+}
+
+GridOverview::~GridOverview()
+{
+    // worker thread owns job so it's safe to leave it
+    cancelBuild();
+}
+
+void GridOverview::addColumnColors(int absColumn, SharedPtr<ModelColor> model)
+{
+    addColumn(absColumn, model, [model](GridID id, QColor& color)->bool {
+        color = model->value(ID(id));
+        return color.isValid();
+    });
+}
+
+void GridOverview::addColumn(int absColumn, SharedPtr<Model> model, std::function<bool(GridID, QColor&)> color)
+{
+    Q_ASSERT(model);
+    Q_ASSERT(color);
+
+    // model shared by columns is connected once
+    bool isConnected = std::any_of(m_columns.begin(), m_columns.end(), [&model](const Column& column) {
+        return column.model == model;
+    });
+    if (!isConnected)
+    {
+        connect(model.data(), &Model::modelChanged, this, &GridOverview::onModelChanged);
+        connect(model.data(), &Model::modelItemChanged, this, [this](const Model* model, ID id) {
+            onModelItemsChanged(model, QVector<ID>() << id);
+        });
+        connect(model.data(), &Model::modelItemsChanged, this, &GridOverview::onModelItemsChanged);
+    }
+
+    Column column;
+    column.absColumn = absColumn;
+    column.model = std::move(model);
+    column.color = std::move(color);
+    m_columns.append(column);
+
+    rebuild();
+}
+
+void GridOverview::clearColumns()
+{
+    for (const auto& column : m_columns)
+        disconnect(column.model.data(), nullptr, this, nullptr);
+    m_columns.clear();
+
+    rebuild();
+}
+
+void GridOverview::setSamplesPerBucket(int samplesPerBucket)
+{
+    Q_ASSERT(samplesPerBucket > 0);
+    if (m_samplesPerBucket == samplesPerBucket)
+        return;
+
+    m_samplesPerBucket = samplesPerBucket;
+    rebuild();
+}
+
+void GridOverview::setSize(const QSize& size)
+{
+    if (m_size == size)
+        return;
+
+    m_size = size;
+    rebuild();
+}
+
+void GridOverview::rebuild()
+{
+    callLaterOnce(this, "rebuild", [this]() { startBuild(); });
+}
+
+QColor GridOverview::blendColors(const QColor& low, const QColor& high, double ratio)
+{
+    return QColor::fromRgbF(low.redF() + (high.redF() - low.redF()) * ratio,
+                            low.greenF() + (high.greenF() - low.greenF()) * ratio,
+                            low.blueF() + (high.blueF() - low.blueF()) * ratio,
+                            low.alphaF() + (high.alphaF() - low.alphaF()) * ratio);
+}
+
+void GridOverview::buildBucket(const LinesSnapshot& rows, const QVector<Column>& columns, const QSize& size, int samplesPerBucket, int bucket, QRgb* pixels)
+{
+    int width = size.width();
+    int height = size.height();
+    qint64 totalSize = rows.visibleSize();
+
+    // rows covered by pixel row are found by prefix sums of row sizes
+    int firstRow = rows.findVisibleIDByPos(int(totalSize * bucket / height));
+    int lastRow = rows.findVisibleIDByPos(int(totalSize * (bucket + 1) / height) - 1);
+    if (totalSize == 0 || firstRow == InvalidIndex)
+    {
+        std::fill(pixels, pixels + width, qRgba(0, 0, 0, 0));
+        return;
+    }
+    lastRow = qMax(firstRow, lastRow);
+
+    int rowsCount = lastRow - firstRow + 1;
+    int samples = qMin(rowsCount, samplesPerBucket);
+
+    int x = 0;
+    for (int i = 0; i < columns.size(); ++i)
+    {
+        int xEnd = width * (i + 1) / columns.size();
+        if (xEnd <= x)
+            continue;
+
+        const Column& column = columns[i];
+        double red = 0., green = 0., blue = 0., alpha = 0.;
+        int colorsCount = 0;
+        QColor color;
+        for (int sample = 0; sample < samples; ++sample)
+        {
+            int visibleRow = firstRow + int(qint64(rowsCount) * sample / samples);
+            if (!column.color(GridID(rows.toAbsolute(visibleRow), column.absColumn), color))
+                continue;
+
+            red += color.redF();
+            green += color.greenF();
+            blue += color.blueF();
+            alpha += color.alphaF();
+            ++colorsCount;
+        }
+
+        QRgb pixel = qRgba(0, 0, 0, 0);
+        if (colorsCount > 0)
+            pixel = QColor::fromRgbF(red / colorsCount, green / colorsCount, blue / colorsCount, alpha / colorsCount).rgba();
+        std::fill(pixels + x, pixels + xEnd, pixel);
+        x = xEnd;
+    }
+
+    std::fill(pixels + x, pixels + width, qRgba(0, 0, 0, 0));
+}
+
+void GridOverview::startBuild()
+{
+    cancelBuild();
+    m_dirtyBuckets.clear();
+
+    if (m_size.isEmpty() || m_columns.isEmpty())
+    {
+        m_image = QImage();
+        emit imageChanged(this, QRect());
+        emit buildFinished(this);
+        return;
+    }
+
+    // Lines are not thread safe, so build works with snapshot
+    m_rows = m_grid->rows()->snapshot();
+    if (m_image.size() != m_size)
+    {
+        m_image = QImage(m_size, QImage::Format_ARGB32);
+        m_image.fill(Qt::transparent);
+    }
+
+    auto job = makeShared<BuildJob>();
+    job->rows = m_rows;
+    job->columns = m_columns;
+    job->size = m_size;
+    job->samplesPerBucket = m_samplesPerBucket;
+    job->pixels.resize(m_size.width() * m_size.height());
+
+    // minimap is a secondary view
+    TaskPool::instance().run(this, [job]() {
+        int width = job->size.width();
+        for (int bucket = 0; bucket < job->size.height(); ++bucket)
+        {
+            if (job->token.isCancelled())
+                return;
+
+            buildBucket(job->rows, job->columns, job->size, job->samplesPerBucket, bucket, job->pixels.data() + bucket * width);
+            job->bucketsBuilt.store(bucket + 1, std::memory_order_release);
+        }
+    }, [this, job]() {
+        onBuildFinished(job);
+    }, TaskPriorityBackground, job->token);
+
+    m_job = job;
+    m_bucketsCopied = 0;
+    m_progressTimer->start();
+}
+
+void GridOverview::cancelBuild()
+{
+    if (!m_job)
+        return;
+
+    m_job->token.cancel();
+    m_job.reset();
+    m_progressTimer->stop();
+}
+
+void GridOverview::copyBuiltBuckets()
+{
+    if (!m_job)
+        return;
+
+    int bucketsBuilt = m_job->bucketsBuilt.load(std::memory_order_acquire);
+    if (bucketsBuilt <= m_bucketsCopied)
+        return;
+
+    int width = m_size.width();
+    for (int bucket = m_bucketsCopied; bucket < bucketsBuilt; ++bucket)
+    {
+        const QRgb* pixels = m_job->pixels.constData() + bucket * width;
+        std::copy(pixels, pixels + width, reinterpret_cast<QRgb*>(m_image.scanLine(bucket)));
+    }
+
+    QRect rect(0, m_bucketsCopied, width, bucketsBuilt - m_bucketsCopied);
+    m_bucketsCopied = bucketsBuilt;
+    emit imageChanged(this, rect);
+}
+
+void GridOverview::onBuildFinished(const SharedPtr<BuildJob>& job)
+{
+    // job was canceled or replaced
+    if (m_job != job)
+        return;
+
+    copyBuiltBuckets();
+    m_job.reset();
+    m_progressTimer->stop();
+
+    // items changed during build
+    updateDirtyBuckets();
+
+    emit buildFinished(this);
+}
+
+void GridOverview::updateDirtyBuckets()
+{
+    if (m_dirtyBuckets.isEmpty() || m_image.isNull())
+        return;
+
+    // buckets not built yet will read changed items anyway,
+    // but built ones may be copied later, so wait for the build
+    if (m_job)
+        return;
+
+    int top = m_size.height();
+    int bottom = -1;
+    for (int bucket : m_dirtyBuckets)
+    {
+        buildBucket(m_rows, m_columns, m_size, m_samplesPerBucket, bucket, reinterpret_cast<QRgb*>(m_image.scanLine(bucket)));
+        top = qMin(top, bucket);
+        bottom = qMax(bottom, bucket);
+    }
+    m_dirtyBuckets.clear();
+
+    emit imageChanged(this, QRect(0, top, m_size.width(), bottom - top + 1));
+}
+
+void GridOverview::onModelChanged(const Model* /*model*/)
+{
+    if (m_isItemsChanged)
+    {
+        m_isItemsChanged = false;
+        return;
+    }
+
+    rebuild();
+}
+
+void GridOverview::onModelItemsChanged(const Model* /*model*/, const QVector<ID>& ids)
+{
+    m_isItemsChanged = true;
+
+    qint64 totalSize = m_rows.visibleSize();
+    if (totalSize == 0 || m_size.isEmpty())
+        return;
+
+    for (const auto& id : ids)
+    {
+        int visibleRow = m_rows.toVisibleSafe(id.as<GridID>().row);
+        if (visibleRow == InvalidIndex)
+            continue;
+
+        int bucket = int(qint64(m_rows.startPos(visibleRow)) * m_size.height() / totalSize);
+        m_dirtyBuckets.insert(qMin(bucket, m_size.height() - 1));
+    }
+
+    callLaterOnce(this, "updateDirtyBuckets", [this]() { updateDirtyBuckets(); });
+}
+
+void GridOverview::onRowsChanged(const Lines* /*lines*/, ChangeReason /*reason*/)
+{
+    rebuild();
+}
+
+} // end namespace Qi
@@ -0,0 +1,130 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_GRID_OVERVIEW_H
+#define QI_GRID_OVERVIEW_H
+
+#include "space/grid/SpaceGrid.h"
+#include "items/color/Color.h"
+#include <QImage>
+#include <QSet>
+#include <functional>
+
+class QTimer;
+
+namespace Qi
+{
+
+// downsampled image of grid columns for scrollbar minimaps
+// each pixel row is a bucket of visible rows by their positions (see LinesSnapshot),
+// its color is the average color of items sampled in the bucket
+// image is built progressively in background thread and changed items update their buckets only
+// column models should be safe to read from worker threads
+class QI_EXPORT GridOverview: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(GridOverview)
+
+public:
+    explicit GridOverview(SharedPtr<SpaceGrid> grid, QObject* parent = nullptr);
+    virtual ~GridOverview();
+
+    const SharedPtr<SpaceGrid>& grid() const { return m_grid; }
+
+    // image width is split between columns in order of adding
+    void addColumnColors(int absColumn, SharedPtr<ModelColor> model);
+    // values are mapped to colors between lowColor and highColor
+    template <typename T>
+    void addColumnValues(int absColumn, SharedPtr<ModelTyped<T>> model, T minValue, T maxValue,
+                         QColor lowColor = QColor(Qt::transparent), QColor highColor = QColor(Qt::darkBlue));
+    void clearColumns();
+
+    // rows sampled in one bucket, rows between samples are skipped
+    int samplesPerBucket() const { return m_samplesPerBucket; }
+    void setSamplesPerBucket(int samplesPerBucket);
+
+    QSize size() const { return m_size; }
+    void setSize(const QSize& size);
+
+    const QImage& image() const { return m_image; }
+    bool isBuilding() const { return !m_job.isNull(); }
+    // image is rebuilt on next event loop turn
+    void rebuild();
+
+signals:
+    // pixel rows of image within rect were changed
+    void imageChanged(const GridOverview*, const QRect& rect);
+    void buildFinished(const GridOverview*);
+
+private:
+    struct Column
+    {
+        int absColumn;
+        SharedPtr<Model> model;
+        // returns false if item has no color
+        std::function<bool(GridID id, QColor& color)> color;
+    };
+    struct BuildJob;
+
+    void addColumn(int absColumn, SharedPtr<Model> model, std::function<bool(GridID, QColor&)> color);
+    static QColor blendColors(const QColor& low, const QColor& high, double ratio);
+    static void buildBucket(const LinesSnapshot& rows, const QVector<Column>& columns, const QSize& size, int samplesPerBucket, int bucket, QRgb* pixels);
+
+    void startBuild();
+    void cancelBuild();
+    void copyBuiltBuckets();
+    void onBuildFinished(const SharedPtr<BuildJob>& job);
+    void updateDirtyBuckets();
+
+    void onModelChanged(const Model* model);
+    void onModelItemsChanged(const Model* model, const QVector<ID>& ids);
+    void onRowsChanged(const Lines* lines, ChangeReason reason);
+
+    SharedPtr<SpaceGrid> m_grid;
+    QVector<Column> m_columns;
+    int m_samplesPerBucket;
+    QSize m_size;
+
+    QImage m_image;
+    // rows of the image build
+    LinesSnapshot m_rows;
+    SharedPtr<BuildJob> m_job;
+    // buckets of job copied to image
+    int m_bucketsCopied;
+    QTimer* m_progressTimer;
+
+    // buckets of changed items to rebuild
+    QSet<int> m_dirtyBuckets;
+    // modelChanged follows items change signals
+    bool m_isItemsChanged;
+};
+
+template <typename T>
+void GridOverview::addColumnValues(int absColumn, SharedPtr<ModelTyped<T>> model, T minValue, T maxValue, QColor lowColor, QColor highColor)
+{
+    double low = double(minValue);
+    double range = double(maxValue) - low;
+    addColumn(absColumn, model, [model, low, range, lowColor, highColor](GridID id, QColor& color)->bool {
+        double ratio = range > 0 ? qBound(0., (double(model->value(ID(id))) - low) / range, 1.) : 0.;
+        color = blendColors(lowColor, highColor, ratio);
+        return true;
+    });
+}
+
+} // end namespace Qi
+
+#endif // QI_GRID_OVERVIEW_H
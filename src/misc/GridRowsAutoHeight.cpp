@@ -0,0 +1,343 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "GridRowsAutoHeight.h"
+#include "widgets/GridWidget.h"
+#include "cache/CacheItemFactory.h"
+#include "space/grid/CacheSpaceGrid.h"
+#include "utils/FrameScheduler.h"
+#include "utils/auto_value.h"
+#include <QTimer>
+#include <QElapsedTimer>
+
+namespace Qi
+{
+
+static const int AutoHeightSliceSize = 200;
+// idle slice gives way to events after this time in milliseconds
+static const int AutoHeightSliceTime = 8;
+// rows resized in the frame let other rows in, they are measured by few passes
+static const int AutoHeightFramePasses = 4;
+
+const GridID GridRowsAutoHeight::clientID = Qi::clientID;
+
+GridRowsAutoHeight::GridRowsAutoHeight(GridWidget* gridWidget, GridID subGridId)
+    : m_gridWidget(gridWidget),
+      m_subGridId(subGridId),
+      m_measuredCount(0),
+      m_measuredHeightsSum(0),
+      m_estimatedHeight(0),
+      m_isEstimateApplied(false),
+      m_nextRow(0),
+      m_sliceSize(AutoHeightSliceSize),
+      m_sliceTimer(new QTimer(this)),
+      m_isResizing(false)
+{
+    Q_ASSERT(!m_gridWidget.isNull());
+
+    m_grid = m_gridWidget->subGrid(m_subGridId);
+    m_rows = m_grid->rows();
+    m_columns = m_grid->columns();
+    m_measured.resize(m_rows->count(), false);
+
+    m_sliceTimer->setInterval(0);
+    connect(m_sliceTimer, &QTimer::timeout, this, &GridRowsAutoHeight::measureSlice);
+
+    connect(m_rows.data(), &Lines::linesChanged, this, &GridRowsAutoHeight::onRowsChanged);
+    connect(m_rows.data(), &Lines::linesInserted, this, &GridRowsAutoHeight::onRowsInserted);
+    connect(m_rows.data(), &Lines::linesRemoved, this, &GridRowsAutoHeight::onRowsRemoved);
+    connect(m_columns.data(), &Lines::linesChanged, this, &GridRowsAutoHeight::onColumnsChanged);
+    connect(m_gridWidget->cacheSubGrid(m_subGridId).data(), &CacheSpace::cacheChanged, this, &GridRowsAutoHeight::onCacheChanged);
+    connect(m_grid.data(), &Space::spaceItemsChanged, this, &GridRowsAutoHeight::onItemsChanged);
+
+    measureFrameLater();
+}
+
+GridRowsAutoHeight::~GridRowsAutoHeight()
+{
+}
+
+void GridRowsAutoHeight::setSliceSize(int sliceSize)
+{
+    Q_ASSERT(sliceSize > 0);
+    m_sliceSize = sliceSize;
+}
+
+void GridRowsAutoHeight::invalidate()
+{
+    m_measured.fill(false, m_rows->count());
+    m_measuredCount = 0;
+    m_measuredHeightsSum = 0;
+    m_nextRow = 0;
+    // last estimate is kept for rows until they are measured again
+    m_isEstimateApplied = true;
+
+    measureFrameLater();
+}
+
+void GridRowsAutoHeight::onRowsChanged(const Lines* /*lines*/, ChangeReason reason)
+{
+    if (m_isResizing)
+        return;
+
+    // inserted and removed rows are handled by onRowsInserted and onRowsRemoved
+    if ((reason & ChangeReasonLinesCount) && m_measured.size() != m_rows->count())
+    {
+        int oldCount = m_measured.size();
+        if (oldCount < m_rows->count())
+        {
+            m_measured.insert(oldCount, m_rows->count() - oldCount, false);
+        }
+        else
+        {
+            for (int row = m_rows->count(); row < oldCount; ++row)
+                unmeasureRow(row, m_estimatedHeight);
+            m_measured.remove(m_rows->count(), oldCount - m_rows->count());
+        }
+        m_isEstimateApplied = false;
+    }
+
+    if (reason & (ChangeReasonLinesCount | ChangeReasonLinesVisibility))
+    {
+        // shown rows may be not measured
+        m_nextRow = 0;
+        measureFrameLater();
+    }
+}
+
+void GridRowsAutoHeight::onRowsInserted(const Lines* /*lines*/, int absoluteLine, int linesCount)
+{
+    m_measured.insert(absoluteLine, linesCount, false);
+    m_isEstimateApplied = false;
+    m_nextRow = qMin(m_nextRow, absoluteLine);
+}
+
+void GridRowsAutoHeight::onRowsRemoved(const Lines* /*lines*/, int absoluteLine, int linesCount)
+{
+    // heights of removed rows are not available, so estimate is subtracted
+    for (int row = absoluteLine; row < absoluteLine + linesCount; ++row)
+        unmeasureRow(row, m_estimatedHeight);
+    m_measured.remove(absoluteLine, linesCount);
+    m_nextRow = qMin(m_nextRow, absoluteLine);
+}
+
+void GridRowsAutoHeight::onColumnsChanged(const Lines* /*lines*/, ChangeReason reason)
+{
+    // wrapped texts depend on widths of columns
+    if (reason & (ChangeReasonLinesCount | ChangeReasonLinesVisibility | ChangeReasonLinesSize))
+        invalidate();
+}
+
+void GridRowsAutoHeight::onCacheChanged(const CacheSpace* /*cache*/, ChangeReason reason)
+{
+    if (reason & ChangeReasonCacheFrame)
+        measureFrameLater();
+}
+
+void GridRowsAutoHeight::onItemsChanged(const Space* /*space*/, const QVector<ID>& items)
+{
+    bool isUnmeasured = false;
+    for (const auto& item : items)
+    {
+        GridID id = item.as<GridID>();
+        if (id.row < 0 || id.row >= m_measured.size() || !m_measured.value(id.row))
+            continue;
+
+        unmeasureRow(id.row, m_rows->lineSize(id.row));
+        m_nextRow = qMin(m_nextRow, id.row);
+        isUnmeasured = true;
+    }
+
+    if (isUnmeasured)
+        measureFrameLater();
+}
+
+void GridRowsAutoHeight::measureFrameLater()
+{
+    if (m_gridWidget.isNull())
+        return;
+
+    FrameScheduler::of(m_gridWidget)->schedule(FramePhaseLines, this, "measureFrame", [this]() { measureFrame(); });
+}
+
+void GridRowsAutoHeight::measureFrame()
+{
+    if (m_gridWidget.isNull())
+        return;
+
+    const auto& cacheGrid = *m_gridWidget->cacheSubGrid(m_subGridId);
+
+    for (int pass = 0; pass < AutoHeightFramePasses; ++pass)
+    {
+        if (m_rows->isEmptyVisible() || m_columns->isEmptyVisible())
+            break;
+
+        int visibleStart, visibleEnd;
+        m_rows->visibleRangeByPos(cacheGrid.scrollOffset().y(), cacheGrid.window().height(), visibleStart, visibleEnd);
+        if (visibleStart == InvalidIndex || visibleEnd == InvalidIndex)
+            break;
+
+        QVector<int> rows;
+        for (int visibleRow = visibleStart; visibleRow <= visibleEnd; ++visibleRow)
+        {
+            int row = m_rows->toAbsolute(visibleRow);
+            if (!m_measured.value(row))
+                rows.append(row);
+        }
+
+        if (rows.isEmpty())
+            break;
+
+        measureRows(rows);
+    }
+
+    updateEstimate();
+
+    if (m_nextRow < m_measured.size())
+        m_sliceTimer->start();
+}
+
+void GridRowsAutoHeight::measureSlice()
+{
+    if (m_gridWidget.isNull())
+    {
+        m_sliceTimer->stop();
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<int> rows;
+    rows.reserve(m_sliceSize);
+
+    // hidden rows can't be measured in visible ids space, they are measured once shown
+    int count = m_measured.size();
+    for (; m_nextRow < count && rows.size() < m_sliceSize; ++m_nextRow)
+    {
+        if (!m_measured.value(m_nextRow) && m_rows->isLineVisible(m_nextRow))
+            rows.append(m_nextRow);
+
+        // don't freeze on long runs of measured or hidden rows
+        if ((m_nextRow & 0xFFFF) == 0 && timer.elapsed() > AutoHeightSliceTime)
+            break;
+    }
+
+    measureRows(rows);
+    updateEstimate();
+
+    // rows are scanned once until they are changed
+    if (m_nextRow >= count)
+    {
+        m_sliceTimer->stop();
+        emit measureFinished(this);
+    }
+}
+
+void GridRowsAutoHeight::measureRows(const QVector<int>& rows)
+{
+    if (rows.isEmpty())
+        return;
+
+    // widths hints are set per column, so context is copied
+    GuiContext ctx = m_gridWidget->guiContext();
+    auto factory = m_grid->createCacheItemFactory();
+
+    QVector<int> heights;
+    heights.reserve(rows.size());
+    for (int row : rows)
+    {
+        int height = measureRowHeight(*factory, m_rows->toVisible(row), ctx);
+        heights.append(height);
+
+        m_measured.setValue(row, true);
+        ++m_measuredCount;
+        m_measuredHeightsSum += height;
+    }
+
+    auto_value<bool> resizing(m_isResizing, true);
+    m_rows->setLinesSizes(rows, heights);
+}
+
+int GridRowsAutoHeight::measureRowHeight(const CacheItemFactory& factory, int visibleRow, GuiContext& ctx) const
+{
+    int height = 0;
+    int columnsCount = m_columns->visibleCount();
+    for (int visibleColumn = 0; visibleColumn < columnsCount; ++visibleColumn)
+    {
+        ctx.setSizeWidthHint(m_columns->lineSize(m_columns->toAbsolute(visibleColumn)));
+
+        CacheItem cacheItem(factory.create(ID(GridID(visibleRow, visibleColumn))));
+        cacheItem.validateCacheView(ctx);
+        height = qMax(height, cacheItem.calculateItemSize(ctx).height());
+    }
+
+    return height;
+}
+
+void GridRowsAutoHeight::unmeasureRow(int row, int height)
+{
+    if (!m_measured.value(row))
+        return;
+
+    m_measured.setValue(row, false);
+    --m_measuredCount;
+    m_measuredHeightsSum -= height;
+}
+
+void GridRowsAutoHeight::updateEstimate()
+{
+    if (m_measuredCount == 0)
+        return;
+
+    int estimatedHeight = int((m_measuredHeightsSum + m_measuredCount / 2) / m_measuredCount);
+    if (estimatedHeight != m_estimatedHeight)
+    {
+        m_estimatedHeight = estimatedHeight;
+        m_isEstimateApplied = false;
+    }
+
+    if (!m_isEstimateApplied)
+        applyEstimate();
+}
+
+void GridRowsAutoHeight::applyEstimate()
+{
+    m_isEstimateApplied = true;
+    if (isMeasuredAll())
+        return;
+
+    auto_value<bool> resizing(m_isResizing, true);
+
+    // runs of not measured rows get one size run each
+    int count = m_measured.size();
+    int row = 0;
+    while (row < count)
+    {
+        while (row < count && m_measured.value(row))
+            ++row;
+
+        int runStart = row;
+        while (row < count && !m_measured.value(row))
+            ++row;
+
+        if (row > runStart)
+            m_rows->setLinesSize(runStart, row - runStart, m_estimatedHeight);
+    }
+}
+
+} // end namespace Qi
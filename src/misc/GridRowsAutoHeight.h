@@ -0,0 +1,117 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_GRID_ROWS_AUTO_HEIGHT_H
+#define QI_GRID_ROWS_AUTO_HEIGHT_H
+
+#include "space/grid/SpaceGrid.h"
+#include "utils/BitVector.h"
+#include <QPointer>
+
+class QTimer;
+
+namespace Qi
+{
+
+class GridWidget;
+class GuiContext;
+class CacheSpace;
+class CacheItemFactory;
+
+// sets heights of rows by their content (see View::size and GuiContext::sizeWidthHint)
+// rows in the frame are measured first, not measured rows get running average of measured heights
+// and the rest of rows are measured in idle slices, so the scrollbar converges to the exact size
+// measured heights are kept until columns are resized or items of the row are changed
+// only items of the sub-grid are measured, though its rows are shared with neighbour sub-grids
+class QI_EXPORT GridRowsAutoHeight: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(GridRowsAutoHeight)
+
+public:
+    explicit GridRowsAutoHeight(GridWidget* gridWidget, GridID subGridId = clientID);
+    virtual ~GridRowsAutoHeight();
+
+    // rows measured per idle slice
+    int sliceSize() const { return m_sliceSize; }
+    void setSliceSize(int sliceSize);
+
+    // height of rows not measured yet, 0 if no rows were measured
+    int estimatedHeight() const { return m_estimatedHeight; }
+    bool isMeasuredAll() const { return m_measuredCount == m_measured.size(); }
+    int measuredCount() const { return m_measuredCount; }
+
+    // drops measured heights and measures rows again
+    void invalidate();
+
+signals:
+    // all visible rows were measured
+    void measureFinished(const GridRowsAutoHeight*);
+
+private:
+    void onRowsChanged(const Lines* lines, ChangeReason reason);
+    void onRowsInserted(const Lines* lines, int absoluteLine, int linesCount);
+    void onRowsRemoved(const Lines* lines, int absoluteLine, int linesCount);
+    void onColumnsChanged(const Lines* lines, ChangeReason reason);
+    void onCacheChanged(const CacheSpace* cache, ChangeReason reason);
+    void onItemsChanged(const Space* space, const QVector<ID>& items);
+
+    // schedules measureFrame in the lines phase of the next frame
+    void measureFrameLater();
+    // measures not measured rows in the frame of the cache sub-grid
+    void measureFrame();
+    // measures next slice of rows and stops slices once all rows are measured
+    void measureSlice();
+
+    // measures visible absolute rows and sets their heights by one lines change
+    void measureRows(const QVector<int>& rows);
+    // max height of items in the row, ctx gets width hint of each column
+    int measureRowHeight(const CacheItemFactory& factory, int visibleRow, GuiContext& ctx) const;
+    // height is subtracted from sum of measured heights
+    void unmeasureRow(int row, int height);
+    // sets estimated height to not measured rows if rounded average was changed
+    void updateEstimate();
+    void applyEstimate();
+
+    QPointer<GridWidget> m_gridWidget;
+    GridID m_subGridId;
+    SharedPtr<SpaceGrid> m_grid;
+    SharedPtr<Lines> m_rows;
+    SharedPtr<Lines> m_columns;
+
+    // absolute rows with measured heights
+    BitVector m_measured;
+    int m_measuredCount;
+    qint64 m_measuredHeightsSum;
+    int m_estimatedHeight;
+    // estimate is applied to not measured rows, inserted rows have default size
+    bool m_isEstimateApplied;
+
+    // absolute row to continue idle measurement from, rows count once all rows are scanned
+    int m_nextRow;
+    int m_sliceSize;
+    QTimer* m_sliceTimer;
+
+    // own lines changes are not handled
+    bool m_isResizing;
+
+    static const GridID clientID;
+};
+
+} // end namespace Qi
+
+#endif // QI_GRID_ROWS_AUTO_HEIGHT_H
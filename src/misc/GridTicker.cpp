@@ -0,0 +1,82 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "GridTicker.h"
+#include "widgets/GridWidget.h"
+#include "items/misc/ViewChangeFlash.h"
+#include "items/sorting/Sorting.h"
+#include "core/Layout.h"
+
+namespace Qi
+{
+
+GridTicker::GridTicker(GridWidget* gridWidget, int fps)
+    : QObject(gridWidget),
+      m_gridWidget(gridWidget),
+      m_fps(qMax(1, fps))
+{
+    Q_ASSERT(!m_gridWidget.isNull());
+}
+
+GridTicker::~GridTicker()
+{
+}
+
+void GridTicker::setFps(int fps)
+{
+    Q_ASSERT(fps > 0);
+    if (m_fps == fps)
+        return;
+
+    m_fps = fps;
+    for (const auto& feed : m_feeds)
+        feed->setDrainInterval(frameInterval());
+}
+
+void GridTicker::addFeed(SharedPtr<ModelFeedBase> feed)
+{
+    Q_ASSERT(feed);
+    Q_ASSERT(!m_feeds.contains(feed));
+
+    feed->setDrainInterval(frameInterval());
+    m_feeds.append(std::move(feed));
+}
+
+SharedPtr<ViewChangeFlash> GridTicker::addFlash(SharedPtr<Model> model, SharedPtr<Range> range, int capacity)
+{
+    Q_ASSERT(!m_gridWidget.isNull());
+
+    auto flash = makeShared<ViewChangeFlash>(std::move(model), capacity);
+    m_gridWidget->subGrid()->addSchema(std::move(range), flash, makeLayoutBackground());
+    m_flashes.append(flash);
+    return flash;
+}
+
+void GridTicker::setSorting(SharedPtr<ModelGridSortingBase> sorting)
+{
+    m_sorting = std::move(sorting);
+    if (m_sorting)
+        m_sorting->setIncremental(true);
+}
+
+void GridTicker::drain()
+{
+    for (const auto& feed : m_feeds)
+        feed->drain();
+}
+
+} // end namespace Qi
@@ -0,0 +1,89 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_GRID_TICKER_H
+#define QI_GRID_TICKER_H
+
+#include "core/ext/ModelFeed.h"
+#include "core/Range.h"
+#include <QPointer>
+
+namespace Qi
+{
+
+class GridWidget;
+class ViewChangeFlash;
+class ModelGridSortingBase;
+
+// real-time mode of grid widget for frequently ticking values:
+// - updates are pushed from any thread to feeds and applied once per frame,
+//   latest value of an item wins
+// - changed items are repainted only (see CacheSpace::cacheItemsChanged)
+// - changed items are flashed by ViewChangeFlash if flash is added
+// - changed rows are moved to sorted positions instead of expiring sorting
+class QI_EXPORT GridTicker: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(GridTicker)
+
+public:
+    explicit GridTicker(GridWidget* gridWidget, int fps = 60);
+    ~GridTicker();
+
+    GridWidget* gridWidget() const { return m_gridWidget.data(); }
+
+    // frames per second of applying updates
+    int fps() const { return m_fps; }
+    void setFps(int fps);
+
+    // feed is drained once per frame
+    void addFeed(SharedPtr<ModelFeedBase> feed);
+    template <typename T>
+    SharedPtr<ModelFeed<T>> addFeed(SharedPtr<ModelTyped<T>> model, int capacity = 65536);
+
+    // flashes changed items of the model within the range of client sub grid,
+    // capacity should cover updates of the flash duration
+    SharedPtr<ViewChangeFlash> addFlash(SharedPtr<Model> model, SharedPtr<Range> range, int capacity = 4096);
+
+    // sorting of client sub grid becomes incremental
+    const SharedPtr<ModelGridSortingBase>& sorting() const { return m_sorting; }
+    void setSorting(SharedPtr<ModelGridSortingBase> sorting);
+
+    // applies all queued updates now
+    void drain();
+
+private:
+    int frameInterval() const { return 1000 / m_fps; }
+
+    QPointer<GridWidget> m_gridWidget;
+    int m_fps;
+    QVector<SharedPtr<ModelFeedBase>> m_feeds;
+    QVector<SharedPtr<ViewChangeFlash>> m_flashes;
+    SharedPtr<ModelGridSortingBase> m_sorting;
+};
+
+template <typename T>
+SharedPtr<ModelFeed<T>> GridTicker::addFeed(SharedPtr<ModelTyped<T>> model, int capacity)
+{
+    auto feed = makeShared<ModelFeed<T>>(std::move(model), capacity);
+    addFeed(feed);
+    return feed;
+}
+
+} // end namespace Qi
+
+#endif // QI_GRID_TICKER_H
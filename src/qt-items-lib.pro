@@ -1,6 +1,6 @@
 include(../common.pri)
 
-QT += core gui widgets
+QT += core gui widgets concurrent
 
 TARGET = qt-items
 TEMPLATE = lib
@@ -8,6 +8,9 @@ VERSION = 0.1.0
 
 DEFINES += QT_ITEMS_LIBRARY
 
+# scoped trace markers (see utils/Trace.h)
+qi_trace: DEFINES += QI_TRACE
+
 INCLUDEPATH += $$PWD
 #message($$INCLUDEPATH)
 
@@ -24,21 +27,35 @@ SOURCES += QiAPI.cpp \
     core/ext/Ranges.cpp \
     core/ext/LayoutsAux.cpp \
     core/ext/ViewComposite.cpp \
+    core/ext/ViewStaticSchema.cpp \
     core/ext/ControllerMouseMultiple.cpp \
     core/ext/ControllerMouseCaptured.cpp \
     core/ext/ControllerMousePushable.cpp \
     core/ext/ControllerMouseInplaceEdit.cpp \
+    core/ext/ModelFeed.cpp \
+    core/ext/ModelMapped.cpp \
+    core/ext/ModelAggregate.cpp \
+    core/misc/ViewAuxiliary.cpp \
     core/misc/ControllerMouseAuxiliary.cpp \
     space/Space.cpp \
     space/CacheSpace.cpp \
+    space/CacheSpaceShared.cpp \
+    space/CacheSpaceStatistics.cpp \
     space/grid/Lines.cpp \
+    space/grid/LinesTree.cpp \
+    space/grid/RowsGrouping.cpp \
     space/grid/SpaceGrid.cpp \
     space/grid/RangeGrid.cpp \
     space/grid/CacheSpaceGrid.cpp \
+    space/grid/CacheSpaceGridTiles.cpp \
+    space/grid/GridPageRenderer.cpp \
+    space/grid/GridTextExporter.cpp \
     space/item/SpaceItem.cpp \
     space/item/CacheSpaceItem.cpp \
     space/scene/SpaceScene.cpp \
     space/scene/CacheSpaceScene.cpp \
+    space/scene/ViewSceneLod.cpp \
+    space/scene/ViewSceneConnection.cpp \
     cache/CacheItem.cpp \
     cache/CacheView.cpp \
     cache/CacheControllerMouse.cpp \
@@ -52,13 +69,20 @@ SOURCES += QiAPI.cpp \
     items/button/Button.cpp \
     items/image/StyleStandardPixmap.cpp \
     items/selection/SelectionIterators.cpp \
+    items/selection/SelectionMimeData.cpp \
+    items/selection/SelectionPaste.cpp \
+    items/selection/SelectionSpans.cpp \
     items/image/Pixmap.cpp \
     items/image/Image.cpp \
+    items/image/ScaledPixmapCache.cpp \
+    items/image/ImageAsync.cpp \
     items/link/Link.cpp \
     items/progressbar/Progress.cpp \
     items/color/Color.cpp \
+    items/color/Heatmap.cpp \
     items/misc/ViewItemBorder.cpp \
     items/misc/ViewAlternateBackground.cpp \
+    items/misc/ViewChangeFlash.cpp \
     items/misc/ControllerMouseLinesResizer.cpp \
     items/numeric/Numeric.cpp \
     items/enum/Enum.cpp \
@@ -66,6 +90,8 @@ SOURCES += QiAPI.cpp \
     items/visible/Visible.cpp \
     items/filter/Filter.cpp \
     items/filter/FilterText.cpp \
+    items/filter/FilterTextIndex.cpp \
+    items/filter/GridTextSearch.cpp \
     items/rating/Rating.cpp \
     widgets/ItemWidget.cpp \
     widgets/GridWidget.cpp \
@@ -73,12 +99,28 @@ SOURCES += QiAPI.cpp \
     widgets/SceneWidget.cpp \
     widgets/core/SpaceWidgetAbstract.cpp \
     widgets/core/SpaceWidgetCore.cpp \
+    widgets/core/SpaceWidgetDebugOverlay.cpp \
     widgets/core/SpaceWidgetScrollAbstract.cpp \
     misc/GridColumnsResizer.cpp \
     misc/CacheSpaceAnimation.cpp \
+    misc/GridOverview.cpp \
+    misc/GridTicker.cpp \
+    misc/GridRowsAutoHeight.cpp \
     utils/PainterState.cpp \
     utils/InplaceEditing.cpp \
-    utils/CallLater.cpp
+    utils/CallLater.cpp \
+    utils/TaskPool.cpp \
+    utils/FrameScheduler.cpp \
+    utils/AnimationClock.cpp \
+    utils/MemoryUsage.cpp \
+    utils/MemoryResource.cpp \
+    utils/BitVector.cpp \
+    utils/BlockSearchIndex.cpp \
+    utils/SparseBitVector.cpp \
+    utils/TextMatcher.cpp \
+    utils/TextWidthCache.cpp \
+    utils/Trace.cpp \
+    utils/StylePixmapCache.cpp
 
 HEADERS +=  QiAPI.h \
     core/ID.h \
@@ -97,9 +139,17 @@ HEADERS +=  QiAPI.h \
     core/ext/Layouts.h \
     core/ext/ControllerMouseInplaceEdit.h \
     core/ext/ViewComposite.h \
+    core/ext/ViewStaticSchema.h \
     core/ext/ModelTyped.h \
     core/ext/ModelStore.h \
+    core/ext/ModelStoreSnapshot.h \
+    core/ext/ModelFeed.h \
     core/ext/ModelCallback.h \
+    core/ext/CallbackProfiling.h \
+    core/ext/ModelMapped.h \
+    core/ext/ModelPaged.h \
+    core/ext/ModelValuesCache.h \
+    core/ext/ModelAggregate.h \
     core/ext/ModelConversion.h \
     core/ext/ControllerMouseMultiple.h \
     core/ext/ControllerMouseCaptured.h \
@@ -109,15 +159,24 @@ HEADERS +=  QiAPI.h \
     core/misc/ControllerMouseAuxiliary.h \
     space/Space.h \
     space/CacheSpace.h \
+    space/CacheSpaceShared.h \
+    space/CacheSpaceStatistics.h \
     space/grid/Lines.h \
+    space/grid/LinesTree.h \
+    space/grid/RowsGrouping.h \
     space/grid/SpaceGrid.h \
     space/grid/CacheSpaceGrid.h \
+    space/grid/CacheSpaceGridTiles.h \
+    space/grid/GridPageRenderer.h \
+    space/grid/GridTextExporter.h \
     space/grid/GridID.h \
     space/grid/RangeGrid.h \
     space/item/SpaceItem.h \
     space/item/CacheSpaceItem.h \
     space/scene/CacheSpaceScene.h \
     space/scene/SpaceScene.h \
+    space/scene/ViewSceneLod.h \
+    space/scene/ViewSceneConnection.h \
     cache/CacheItem.h \
     cache/CacheView.h \
     cache/CacheControllerMouse.h \
@@ -130,13 +189,20 @@ HEADERS +=  QiAPI.h \
     items/button/Button.h \
     items/image/StyleStandardPixmap.h \
     items/selection/SelectionIterators.h \
+    items/selection/SelectionMimeData.h \
+    items/selection/SelectionPaste.h \
+    items/selection/SelectionSpans.h \
     items/image/Pixmap.h \
     items/image/Image.h \
+    items/image/ScaledPixmapCache.h \
+    items/image/ImageAsync.h \
     items/link/Link.h \
     items/progressbar/Progress.h \
     items/color/Color.h \
+    items/color/Heatmap.h \
     items/misc/ViewItemBorder.h \
     items/misc/ViewAlternateBackground.h \
+    items/misc/ViewChangeFlash.h \
     items/misc/ControllerMouseLinesResizer.h \
     items/numeric/Numeric.h \
     items/enum/Enum.h \
@@ -144,6 +210,8 @@ HEADERS +=  QiAPI.h \
     items/visible/Visible.h \
     items/filter/Filter.h \
     items/filter/FilterText.h \
+    items/filter/FilterTextIndex.h \
+    items/filter/GridTextSearch.h \
     items/rating/Rating.h \
     widgets/ItemWidget.h \
     widgets/GridWidget.h \
@@ -151,14 +219,33 @@ HEADERS +=  QiAPI.h \
     widgets/SceneWidget.h \
     widgets/core/SpaceWidgetAbstract.h \
     widgets/core/SpaceWidgetCore.h \
+    widgets/core/SpaceWidgetDebugOverlay.h \
     widgets/core/SpaceWidgetScrollAbstract.h \
     misc/GridColumnsResizer.h \
     misc/CacheSpaceAnimation.h \
+    misc/GridOverview.h \
+    misc/GridTicker.h \
+    misc/GridRowsAutoHeight.h \
     utils/CallLater.h \
+    utils/TaskPool.h \
+    utils/FrameScheduler.h \
+    utils/AnimationClock.h \
     utils/MemFunction.h \
+    utils/MemoryUsage.h \
+    utils/MemoryResource.h \
     utils/PainterState.h \
     utils/InplaceEditing.h \
-    utils/auto_value.h
+    utils/auto_value.h \
+    utils/BitVector.h \
+    utils/BlockSearchIndex.h \
+    utils/SparseBitVector.h \
+    utils/ParallelSort.h \
+    utils/RadixSort.h \
+    utils/LockFreeQueue.h \
+    utils/TextMatcher.h \
+    utils/TextWidthCache.h \
+    utils/Trace.h \
+    utils/StylePixmapCache.h
 
 win32 {
     TARGET_EXT = .dll
@@ -15,33 +15,56 @@
 */
 
 #include "CacheSpace.h"
+#include "CacheSpaceStatistics.h"
+#include "CacheSpaceShared.h"
 #include "core/ControllerMouse.h"
 #include "cache/CacheItem.h"
 #include "cache/CacheItemFactory.h"
 #include "misc/CacheSpaceAnimation.h"
+#include "core/Range.h"
 #include "utils/auto_value.h"
+#include "utils/Trace.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QtMath>
 
 namespace Qi
 {
 
+static const int MaxChangedRegionRects = 32;
+
 CacheSpace::CacheSpace(SharedPtr<Space> space)
     : m_space(std::move(space)),
       m_window(0, 0, 0, 0),
+      m_viewWindow(0, 0, 0, 0),
+      m_scale(1.),
       m_scrollOffset(0, 0),
       m_scrollDelta(0, 0),
       m_sizeDelta(0, 0),
       m_itemsCacheInvalid(true),
-      m_cacheIsInUse(false)
+      m_painterScroll(false),
+      m_batchDraw(false),
+      m_itemsOffset(0, 0),
+      m_cacheIsInUse(false),
+      m_itemsPool(makeShared<CacheItemsPool>())
 {
     connect(m_space.data(), &Space::spaceChanged, this, &CacheSpace::onSpaceChanged);
+    connect(m_space.data(), &Space::spaceItemsChanged, this, &CacheSpace::onSpaceItemsChanged);
 
     m_cacheItemsFactory = m_space->createCacheItemFactory();
     Q_ASSERT(m_cacheItemsFactory);
+
+    MemoryBudget::instance().addCache(this, "CacheSpace", [this]() {
+        return memoryUsage().total();
+    }, [this](qint64 /*bytes*/) {
+        trimMemory();
+    });
 }
 
 CacheSpace::~CacheSpace()
 {
     disconnect(m_space.data(), &Space::spaceChanged, this, &CacheSpace::onSpaceChanged);
+    disconnect(m_space.data(), &Space::spaceItemsChanged, this, &CacheSpace::onSpaceItemsChanged);
 }
 
 void CacheSpace::onSpaceChanged(const Space* space, ChangeReason reason)
@@ -51,14 +74,29 @@ void CacheSpace::onSpaceChanged(const Space* space, ChangeReason reason)
 
     if (reason & ChangeReasonSpaceStructure)
     {
-        // invalidate all items
-        clearItemsCache();
+        if (reason & ChangeReasonSpaceItemsOrder)
+        {
+            // items were reordered only
+            Q_ASSERT(!m_cacheIsInUse);
+            reorderItemsCacheImpl();
+        }
+        else if (reason & ChangeReasonSpaceItemsSize)
+        {
+            // items were resized only
+            Q_ASSERT(!m_cacheIsInUse);
+            resizeItemsCacheImpl();
+        }
+        else
+        {
+            // invalidate all items
+            clearItemsCache();
+        }
         invalidateItemsCache(reason|ChangeReasonCacheItems);
     }
     else if (reason & (ChangeReasonSpaceHint | ChangeReasonSpaceItemsStructure))
     {
         // update items factory
-        updateCacheItemsFactory();
+        updateCacheItemsFactory(reason);
         emit cacheChanged(this, reason|ChangeReasonCacheItems);
     }
     else if (reason & ChangeReasonSpaceItemsContent)
@@ -68,12 +106,55 @@ void CacheSpace::onSpaceChanged(const Space* space, ChangeReason reason)
     }
 }
 
-void CacheSpace::setWindow(const QRect& window)
+void CacheSpace::onSpaceItemsChanged(const Space* space, const QVector<ID>& items)
 {
-    if (m_window == window)
+    Q_UNUSED(space);
+    Q_ASSERT(space == m_space.data());
+
+    // items are not known until validation or all of them are animated
+    if (m_itemsCacheInvalid || m_animation)
+    {
+        emit cacheChanged(this, ChangeReasonSpaceItemsContent|ChangeReasonCacheContent);
         return;
+    }
 
-    QRect _window = window.normalized();
+    applyItemsOffset();
+
+    // items out of frame have no cache items
+    // too many rects are merged to bounding rect
+    QRect windowRect;
+    QRegion windowRegion;
+    int rectsCount = 0;
+    for (const auto& item : items)
+    {
+        auto cacheItem = cacheItemImpl(m_space->toVisible(item));
+        if (!cacheItem)
+            continue;
+
+        QRect rect = toView(cacheItem->rect & m_window);
+        if (rect.isEmpty())
+            continue;
+
+        windowRect |= rect;
+        if (++rectsCount <= MaxChangedRegionRects)
+            windowRegion |= rect;
+    }
+
+    if (rectsCount > MaxChangedRegionRects)
+        windowRegion = windowRect;
+
+    if (!windowRegion.isEmpty())
+        emit cacheItemsChanged(this, windowRegion);
+}
+
+void CacheSpace::setWindow(const QRect& window)
+{
+    m_viewWindow = window.normalized();
+
+    // window covers the whole view window in space units
+    QRect _window(m_viewWindow.topLeft(), QSize(qCeil(m_viewWindow.width() / m_scale), qCeil(m_viewWindow.height() / m_scale)));
+    if (m_window == _window)
+        return;
 
     QPoint delta = _window.topLeft() - m_window.topLeft();
     m_scrollDelta += delta;
@@ -83,6 +164,65 @@ void CacheSpace::setWindow(const QRect& window)
     invalidateItemsCache(ChangeReasonCacheItems|ChangeReasonCacheFrame);
 }
 
+void CacheSpace::setScale(qreal scale)
+{
+    Q_ASSERT(scale > 0.);
+    if (qFuzzyCompare(m_scale, scale))
+        return;
+
+    m_scale = scale;
+    // cache items keep their layout, only the frame is changed
+    QRect window = m_window;
+    setWindow(m_viewWindow);
+    if (m_window == window)
+        emit cacheChanged(this, ChangeReasonCacheFrame);
+}
+
+QPoint CacheSpace::fromView(const QPoint& viewPoint) const
+{
+    if (m_scale == 1.)
+        return viewPoint;
+
+    QPointF delta = QPointF(viewPoint - m_viewWindow.topLeft()) / m_scale;
+    return m_viewWindow.topLeft() + QPoint(qFloor(delta.x()), qFloor(delta.y()));
+}
+
+QRect CacheSpace::fromView(const QRect& viewRect) const
+{
+    if (m_scale == 1.)
+        return viewRect;
+
+    // covers all view pixels of the rect
+    QPoint topLeft = fromView(viewRect.topLeft());
+    return QRect(topLeft, fromView(viewRect.bottomRight()));
+}
+
+QPoint CacheSpace::toView(const QPoint& windowPoint) const
+{
+    if (m_scale == 1.)
+        return windowPoint;
+
+    QPointF delta = QPointF(windowPoint - m_window.topLeft()) * m_scale;
+    return m_viewWindow.topLeft() + delta.toPoint();
+}
+
+QRect CacheSpace::toView(const QRect& windowRect) const
+{
+    if (m_scale == 1.)
+        return windowRect;
+
+    return QRect(toView(windowRect.topLeft()), toView(windowRect.bottomRight() + QPoint(1, 1)) - QPoint(1, 1));
+}
+
+void CacheSpace::updateWindowRect(const QRect& windowRect) const
+{
+    QRect rect = toView(windowRect & m_window);
+    if (rect.isEmpty())
+        return;
+
+    emit const_cast<CacheSpace*>(this)->cacheItemsChanged(this, QRegion(rect));
+}
+
 void CacheSpace::setScrollOffset(const QPoint& scrollOffset)
 {
     if (m_scrollOffset == scrollOffset)
@@ -101,6 +241,31 @@ void CacheSpace::set(const QRect& window, const QPoint& scrollOffset)
     setScrollOffset(scrollOffset);
 }
 
+void CacheSpace::setPainterScroll(bool painterScroll)
+{
+    if (m_painterScroll == painterScroll)
+        return;
+
+    m_painterScroll = painterScroll;
+    if (!m_painterScroll)
+        applyItemsOffset();
+}
+
+void CacheSpace::setBatchDraw(bool batchDraw)
+{
+    m_batchDraw = batchDraw;
+}
+
+void CacheSpace::setPrefetchDirection(QPoint direction)
+{
+    direction = QPoint((direction.x() > 0) - (direction.x() < 0), (direction.y() > 0) - (direction.y() < 0));
+    if (m_prefetchDirection == direction)
+        return;
+
+    m_prefetchDirection = direction;
+    prefetchDirectionChangedImpl();
+}
+
 QPoint CacheSpace::window2Space(const QPoint& windowPoint) const
 {
     return windowPoint - m_window.topLeft() + m_scrollOffset;
@@ -117,6 +282,23 @@ void CacheSpace::clear()
     invalidateItemsCache(ChangeReasonCacheItems);
 }
 
+void CacheSpace::invalidateItems(const QVector<ID>& visibleIds)
+{
+    if (visibleIds.isEmpty())
+        return;
+
+    Q_ASSERT(!m_cacheIsInUse);
+    invalidateItemsImpl(visibleIds);
+    invalidateItemsCache(ChangeReasonCacheItems);
+}
+
+void CacheSpace::invalidateItems(const Range& range)
+{
+    Q_ASSERT(!m_cacheIsInUse);
+    invalidateItemsImpl(range);
+    invalidateItemsCache(ChangeReasonCacheItems);
+}
+
 void CacheSpace::invalidateItemsCache(ChangeReason reason)
 {
     Q_ASSERT(!m_cacheIsInUse);
@@ -131,9 +313,206 @@ void CacheSpace::clearItemsCache() const
     clearItemsCacheImpl();
 }
 
+void CacheSpace::reorderItemsCacheImpl() const
+{
+    clearItemsCacheImpl();
+}
+
+void CacheSpace::resizeItemsCacheImpl() const
+{
+    clearItemsCacheImpl();
+}
+
+void CacheSpace::invalidateItemsImpl(const Range& range) const
+{
+    QVector<ID> visibleIds;
+    forEachCacheItemImpl([&range, &visibleIds, this](const SharedPtr<CacheItem>& cacheItem)->bool {
+                             if (range.hasItem(cacheItem->id))
+                                 visibleIds.append(m_space->toVisible(cacheItem->id));
+                             return true;
+                         });
+
+    if (!visibleIds.isEmpty())
+        invalidateItemsImpl(visibleIds);
+}
+
+void CacheSpace::applyItemsOffset() const
+{
+    if (m_itemsOffset.isNull())
+        return;
+
+    applyItemsOffsetImpl(m_itemsOffset);
+    m_itemsOffset = QPoint(0, 0);
+}
+
+void CacheSpace::applyItemsOffsetImpl(const QPoint& offset) const
+{
+    forEachCacheItemImpl([&offset](const SharedPtr<CacheItem>& cacheItem)->bool {
+                             cacheItem->correctRectangles(offset);
+                             return true;
+                         });
+}
+
+void CacheSpace::invalidateItemsImpl(const QVector<ID>& /*visibleIds*/) const
+{
+    clearItemsCacheImpl();
+}
+
+// maximal count of retired cache items to keep
+static const int CacheItemsPoolLimit = 4096;
+
 SharedPtr<CacheItem> CacheSpace::createCacheItem(ID visibleId) const
 {
-    return makeShared<CacheItem>(m_cacheItemsFactory->create(visibleId));
+    if (m_itemsPool->isEmpty())
+    {
+        if (m_statistics)
+            m_statistics->addItemsCreated();
+        return makeShared<CacheItem>(m_cacheItemsFactory->create(visibleId));
+    }
+
+    if (m_statistics)
+        m_statistics->addItemsRecycled();
+    SharedPtr<CacheItem> cacheItem = m_itemsPool->takeLast();
+    cacheItem->recycle(m_cacheItemsFactory->create(visibleId));
+    return cacheItem;
+}
+
+QVector<SharedPtr<CacheItem>> CacheSpace::createCacheItems(const QVector<ID>& visibleIds) const
+{
+    QVector<SharedPtr<CacheItem>> cacheItems;
+    if (visibleIds.isEmpty())
+        return cacheItems;
+
+    // schemas are resolved by one batch
+    auto infos = m_cacheItemsFactory->create(visibleIds);
+    cacheItems.reserve(infos.size());
+    for (const auto& info : infos)
+    {
+        if (m_itemsPool->isEmpty())
+        {
+            if (m_statistics)
+                m_statistics->addItemsCreated();
+            cacheItems.append(makeShared<CacheItem>(info));
+        }
+        else
+        {
+            if (m_statistics)
+                m_statistics->addItemsRecycled();
+            SharedPtr<CacheItem> cacheItem = m_itemsPool->takeLast();
+            cacheItem->recycle(info);
+            cacheItems.append(std::move(cacheItem));
+        }
+    }
+
+    return cacheItems;
+}
+
+void CacheSpace::recycleCacheItem(SharedPtr<CacheItem> cacheItem) const
+{
+    if (cacheItem && m_itemsPool->size() < CacheItemsPoolLimit)
+        m_itemsPool->append(std::move(cacheItem));
+}
+
+void CacheSpace::setItemsPool(SharedPtr<CacheItemsPool> itemsPool)
+{
+    Q_ASSERT(itemsPool);
+    m_itemsPool = std::move(itemsPool);
+}
+
+void CacheSpace::setShared(SharedPtr<CacheSpaceShared> shared)
+{
+    if (m_shared == shared)
+        return;
+
+    Q_ASSERT(!shared || &shared->space() == m_space.data());
+    m_shared = std::move(shared);
+
+    if (m_shared)
+    {
+        // reconnect to be notified after shared cache has updated its factory
+        disconnect(m_space.data(), &Space::spaceChanged, this, &CacheSpace::onSpaceChanged);
+        disconnect(m_space.data(), &Space::spaceItemsChanged, this, &CacheSpace::onSpaceItemsChanged);
+        connect(m_space.data(), &Space::spaceChanged, this, &CacheSpace::onSpaceChanged);
+        connect(m_space.data(), &Space::spaceItemsChanged, this, &CacheSpace::onSpaceItemsChanged);
+
+        m_cacheItemsFactory = m_shared->cacheItemFactory();
+        m_itemsPool = m_shared->itemsPool();
+    }
+    else
+    {
+        m_cacheItemsFactory = m_space->createCacheItemFactory();
+        m_itemsPool = makeShared<CacheItemsPool>();
+    }
+
+    clear();
+}
+
+void CacheSpace::validateCacheItem(CacheItem& cacheItem, const GuiContext& ctx, const QRect* window) const
+{
+    if (cacheItem.isCacheViewValid(ctx))
+        return;
+
+    // partly visible items are laid out by visible part, draft layouts are not shared
+    bool isShared = m_shared && !ctx.isDraft() && (!window || window->contains(cacheItem.rect));
+    QPoint origin = originPos() - m_itemsOffset;
+    ID visibleId = isShared ? m_space->toVisible(cacheItem.id) : ID();
+    if (isShared && m_shared->assignTemplate(visibleId, cacheItem, origin))
+    {
+        if (m_statistics)
+            m_statistics->addViewsShared();
+        return;
+    }
+
+    if (m_statistics)
+        m_statistics->addViewsLaidOut();
+    cacheItem.validateCacheView(ctx, window);
+
+    if (isShared)
+        m_shared->storeTemplate(visibleId, cacheItem, origin);
+}
+
+static qint64 cacheViewBytes(const CacheView2& cacheView)
+{
+    qint64 bytes = MemoryUsage::bytes(cacheView.subViews());
+    for (const auto& subView : cacheView.subViews())
+        bytes += cacheViewBytes(subView);
+    return bytes;
+}
+
+qint64 CacheSpace::cacheItemBytes(const CacheItem& cacheItem)
+{
+    qint64 bytes = sizeof(CacheItem);
+    if (auto cacheView = cacheItem.cacheView())
+        bytes += sizeof(CacheView2) + cacheViewBytes(*cacheView);
+    return bytes;
+}
+
+MemoryUsage CacheSpace::memoryUsage() const
+{
+    MemoryUsage usage;
+
+    qint64 itemsBytes = 0;
+    forEachCacheItemImpl([&itemsBytes](const SharedPtr<CacheItem>& cacheItem)->bool {
+        itemsBytes += cacheItemBytes(*cacheItem);
+        return true;
+    });
+    usage.add("items", itemsBytes);
+
+    qint64 poolBytes = MemoryUsage::bytes(*m_itemsPool);
+    for (const auto& cacheItem : *m_itemsPool)
+        poolBytes += cacheItemBytes(*cacheItem);
+    usage.add("pool", poolBytes);
+
+    memoryUsageImpl(usage);
+    return usage;
+}
+
+void CacheSpace::trimMemory() const
+{
+    Q_ASSERT(!m_cacheIsInUse);
+    trimMemoryImpl();
+    m_itemsPool->clear();
+    m_itemsPool->squeeze();
 }
 
 void CacheSpace::validateItemsCache() const
@@ -142,23 +521,28 @@ void CacheSpace::validateItemsCache() const
         return;
 
     validateItemsCacheImpl();
+    // new items may exceed memory budget
+    MemoryBudget::instance().trimLater();
 }
 
 const CacheItem* CacheSpace::cacheItem(ID visibleId) const
 {
     validateItemsCache();
+    applyItemsOffset();
     return cacheItemImpl(visibleId);
 }
 
 const CacheItem* CacheSpace::cacheItemByPosition(QPoint point) const
 {
     validateItemsCache();
+    applyItemsOffset();
     return cacheItemByPositionImpl(point);
 }
 
 bool CacheSpace::forEachCacheItem(const std::function<bool(const SharedPtr<CacheItem>&)>& visitor) const
 {
     Q_ASSERT(visitor);
+    applyItemsOffset();
     return forEachCacheItemImpl(visitor);
 }
 
@@ -194,40 +578,217 @@ void CacheSpace::validate(const GuiContext& ctx) const
 
     auto_value<bool> inUse(m_cacheIsInUse, true);
 
-    forEachCacheItem([&ctx, this](const SharedPtr<CacheItem>& cacheItem)->bool {
-                         cacheItem->validateCacheView(ctx, &m_window);
-                         return true;
-                     });
+    // window in cache items coordinates
+    QRect window = m_window.translated(-m_itemsOffset);
+    forEachCacheItemImpl([&ctx, &window, this](const SharedPtr<CacheItem>& cacheItem)->bool {
+                             validateCacheItem(*cacheItem, ctx, &window);
+                             return true;
+                         });
+}
+
+bool CacheSpace::validateAhead(const GuiContext& ctx, qint64 budget) const
+{
+    // items will be validated by drawing
+    if (m_itemsCacheInvalid)
+        return true;
+
+    auto_value<bool> inUse(m_cacheIsInUse, true);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    return forEachCacheItemAheadImpl([&ctx, &timer, budget, this](const SharedPtr<CacheItem>& cacheItem)->bool {
+                                         if (cacheItem->isCacheViewValid(ctx))
+                                             return true;
+
+                                         if (timer.nsecsElapsed() / 1000 >= budget)
+                                             return false;
+
+                                         validateCacheItem(*cacheItem, ctx, nullptr);
+                                         return true;
+                                     });
 }
 
-void CacheSpace::draw(QPainter* painter, const GuiContext& ctx) const
+void CacheSpace::draw(QPainter* painter, const GuiContext& ctx, const QRect* exposedRect) const
 {
+    QI_TRACE_SCOPE(TraceCategoryPaint, "CacheSpace::draw");
+
+    QElapsedTimer timer;
+    if (m_statistics)
+        timer.start();
+
     if (!m_animation.isNull())
         m_animation->drawCacheSpace(this, painter, ctx);
 
     if (drawProxy)
         drawProxy(this, painter, ctx);
     else
-        drawRaw(painter, ctx);
+        drawRaw(painter, ctx, exposedRect);
+
+    if (m_statistics)
+        m_statistics->addDraw(timer.nsecsElapsed() / 1000);
 }
 
-void CacheSpace::drawRaw(QPainter* painter, const GuiContext& ctx) const
+void CacheSpace::drawRaw(QPainter* painter, const GuiContext& ctx, const QRect* exposedRect) const
 {
+    QRect drawRect = m_window;
+    if (exposedRect)
+        drawRect &= fromView(*exposedRect);
+
+    if (drawRect.isEmpty())
+        return;
+
     validateItemsCache();
 
     auto_value<bool> inUse(m_cacheIsInUse, true);
 
     painter->save();
-    painter->setClipRect(m_window);
+    if (m_scale != 1.)
+    {
+        painter->translate(m_window.topLeft());
+        painter->scale(m_scale, m_scale);
+        painter->translate(-m_window.topLeft());
+    }
+    painter->setClipRect(drawRect);
 
-    forEachCacheItem([painter, &ctx, this](const SharedPtr<CacheItem>& cacheItem)->bool {
-                         cacheItem->draw(painter, ctx, &m_window);
-                         return true;
-                     });
+    // apply not corrected scroll offset
+    // whole window is used to lay out items
+    QRect window = m_window;
+    if (!m_itemsOffset.isNull())
+    {
+        painter->translate(m_itemsOffset);
+        window.translate(-m_itemsOffset);
+        drawRect.translate(-m_itemsOffset);
+    }
+
+    if (m_batchDraw)
+    {
+        drawBatched(painter, ctx, window, drawRect);
+    }
+    else
+    {
+        forEachCacheItemImpl([painter, &ctx, &window, &drawRect, this](const SharedPtr<CacheItem>& cacheItem)->bool {
+                                 // skip items out of exposed area
+                                 if (!cacheItem->rect.intersects(drawRect))
+                                     return true;
+
+                                 validateCacheItem(*cacheItem, ctx, &window);
+                                 cacheItem->draw(painter, ctx, &window);
+                                 return true;
+                             });
+    }
 
     painter->restore();
 }
 
+// collects views in draw order, batchable views with sub views are expanded
+static void collectDrawnViews(const CacheView2& cacheView, QVector<const CacheView2*>& views)
+{
+    if (!cacheView.subViews().isEmpty() && cacheView.view()->isDrawBatchable() && !cacheView.hasDrawProxy())
+    {
+        for (const auto& cacheSubView : cacheView.subViews())
+            collectDrawnViews(cacheSubView, views);
+    }
+    else
+    {
+        views.append(&cacheView);
+    }
+}
+
+static bool isBatchableLeaf(const CacheView2* cacheView)
+{
+    return cacheView->subViews().isEmpty() && !cacheView->hasDrawProxy() && cacheView->view()->isDrawBatchable();
+}
+
+// views in order of first appearance with their items
+struct ViewBatches
+{
+    QVector<const View*> views;
+    QHash<const View*, QVector<CacheViewBatchItem>> items;
+
+    void add(const CacheItem& cacheItem, const CacheView2* cacheView)
+    {
+        auto& viewItems = items[cacheView->view()];
+        if (viewItems.isEmpty())
+            views.append(cacheView->view());
+        viewItems.append(CacheViewBatchItem(cacheItem.id, cacheItem.rect, cacheView));
+        cacheView->setDrawnByBatch(true);
+    }
+
+    void draw(QPainter* painter, const GuiContext& ctx, const QRect& window) const
+    {
+        for (auto view : views)
+        {
+            const auto& viewItems = items[view];
+            // allow views to be drawn
+            for (const auto& item : viewItems)
+                item.cacheView->setDrawnByBatch(false);
+            view->drawBatch(painter, ctx, viewItems, &window);
+            for (const auto& item : viewItems)
+                item.cacheView->setDrawnByBatch(true);
+        }
+    }
+
+    void reset() const
+    {
+        for (const auto& viewItems : items)
+            for (const auto& item : viewItems)
+                item.cacheView->setDrawnByBatch(false);
+    }
+};
+
+void CacheSpace::drawBatched(QPainter* painter, const GuiContext& ctx, const QRect& window, const QRect& drawRect) const
+{
+    ViewBatches leadingBatches;
+    ViewBatches trailingBatches;
+    QVector<CacheItem*> cacheItems;
+    QVector<const CacheView2*> views;
+
+    forEachCacheItemImpl([&](const SharedPtr<CacheItem>& cacheItem)->bool {
+                             // skip items out of exposed area
+                             if (!cacheItem->rect.intersects(drawRect))
+                                 return true;
+
+                             validateCacheItem(*cacheItem, ctx, &window);
+                             cacheItems.append(cacheItem.data());
+
+                             const CacheView2* rootCacheView = cacheItem->cacheView();
+                             if (!rootCacheView || cacheItem->hasDrawProxy())
+                                 return true;
+
+                             views.clear();
+                             collectDrawnViews(*rootCacheView, views);
+
+                             int first = 0;
+                             while (first < views.size() && isBatchableLeaf(views[first]))
+                                 leadingBatches.add(*cacheItem, views[first++]);
+
+                             int last = views.size() - 1;
+                             while (last >= first && isBatchableLeaf(views[last]))
+                                 --last;
+                             for (int i = last + 1; i < views.size(); ++i)
+                                 trailingBatches.add(*cacheItem, views[i]);
+
+                             return true;
+                         });
+
+    leadingBatches.draw(painter, ctx, window);
+
+    // batched views are skipped
+    for (auto cacheItem : cacheItems)
+        cacheItem->draw(painter, ctx, &window);
+
+    trailingBatches.draw(painter, ctx, window);
+
+    leadingBatches.reset();
+    trailingBatches.reset();
+}
+
+void CacheSpace::setStatistics(SharedPtr<CacheSpaceStatistics> statistics)
+{
+    m_statistics = std::move(statistics);
+}
+
 CacheSpaceAnimationAbstract* CacheSpace::animation() const
 {
     return m_animation.data();
@@ -242,11 +803,23 @@ void CacheSpace::setAnimation(CacheSpaceAnimationAbstract* animation)
 void CacheSpace::tryActivateControllers(const ControllerContext& context, QVector<ControllerMouse*>& controllers) const
 {
     validateItemsCache();
+    applyItemsOffset();
 
     auto_value<bool> inUse(m_cacheIsInUse, true);
 
+    // items of the window cannot appear under the point until it enters the window
+    if (!m_window.contains(context.point))
+    {
+        context.narrowActivationRect(m_window, false);
+        return;
+    }
+
     const CacheItem* cacheItem = cacheItemByPosition(context.point);
 
+    // other items can appear under the point on any move
+    if (!cacheItem || isItemsOverlappedImpl())
+        context.activationRect = QRect();
+
     if (!cacheItem)
         return;
 
@@ -256,6 +829,7 @@ void CacheSpace::tryActivateControllers(const ControllerContext& context, QVecto
 bool CacheSpace::tooltipByPoint(const QPoint& point, TooltipInfo &tooltipInfo) const
 {
     validateItemsCache();
+    applyItemsOffset();
 
     auto_value<bool> inUse(m_cacheIsInUse, true);
 
@@ -267,17 +841,29 @@ bool CacheSpace::tooltipByPoint(const QPoint& point, TooltipInfo &tooltipInfo) c
     return cacheItem->tooltipByPoint(point, tooltipInfo);
 }
 
-void CacheSpace::updateCacheItemsFactory()
+void CacheSpace::updateCacheItemsFactory(ChangeReason reason)
 {
-    m_cacheItemsFactory = m_space->createCacheItemFactory();
-    Q_ASSERT(m_cacheItemsFactory);
+    if (reason & ChangeReasonSpaceHint)
+    {
+        m_cacheItemsFactory = m_shared ? m_shared->cacheItemFactory() : m_space->createCacheItemFactory();
+        Q_ASSERT(m_cacheItemsFactory);
+    }
+
+    // factory validates memoized schemas by schemasVersion of the space
 
     // update schemas
-    forEachCacheItem([this](const SharedPtr<CacheItem>& cacheItem)->bool {
-                         cacheItem->invalidateCacheView();
-                         m_cacheItemsFactory->updateSchema(*cacheItem);
-                         return true;
-                     });
+    updateItemsSchemaImpl();
+}
+
+void CacheSpace::updateItemsSchemaImpl() const
+{
+    forEachCacheItemImpl([this](const SharedPtr<CacheItem>& cacheItem)->bool {
+                             if (m_statistics)
+                                 m_statistics->addSchemaLookups();
+                             cacheItem->invalidateCacheView();
+                             m_cacheItemsFactory->updateSchema(*cacheItem);
+                             return true;
+                         });
 }
 
 
@@ -18,6 +18,8 @@
 #define QI_CACHE_SPACE_H
 
 #include "Space.h"
+#include "utils/MemoryUsage.h"
+#include <QRegion>
 
 namespace Qi
 {
@@ -26,6 +28,12 @@ class ControllerContext;
 class CacheItem;
 class CacheItemFactory;
 class CacheSpaceAnimationAbstract;
+class Range;
+class CacheSpaceStatistics;
+class CacheSpaceShared;
+
+// retired cache items
+typedef QVector<SharedPtr<CacheItem>> CacheItemsPool;
 
 class QI_EXPORT CacheSpace: public QObject
 {
@@ -42,8 +50,23 @@ public:
 
     const CacheItemFactory& cacheItemFactory() const { return *m_cacheItemsFactory; }
 
+    // window in space units, it's the window given to setWindow scaled down by scale
     const QRect& window() const { return m_window; }
+    // window in units of the owner widget
     void setWindow(const QRect& window);
+    const QRect& viewWindow() const { return m_viewWindow; }
+
+    // cache items are laid out in space units and drawn scaled by scale
+    // around top left corner of the window
+    qreal scale() const { return m_scale; }
+    void setScale(qreal scale);
+    // owner widget point or rect to window in space units and back
+    QPoint fromView(const QPoint& viewPoint) const;
+    QRect fromView(const QRect& viewRect) const;
+    QPoint toView(const QPoint& windowPoint) const;
+    QRect toView(const QRect& windowRect) const;
+    // repaints part of the window without items invalidation (see cacheItemsChanged)
+    void updateWindowRect(const QRect& windowRect) const;
 
     const QPoint& scrollOffset() const { return m_scrollOffset; }
     void setScrollOffset(const QPoint& scrollOffset);
@@ -52,18 +75,47 @@ public:
 
     void set(const QRect& window, const QPoint& scrollOffset);
 
+    // scroll cache items by painter translation instead of correcting their rects
+    // rects are corrected once items are accessed
+    bool isPainterScroll() const { return m_painterScroll; }
+    void setPainterScroll(bool painterScroll);
+
+    // draw leading and trailing batchable views (see View::isDrawBatchable)
+    // of all items grouped by view before and after drawing the other views
+    // items should not overlap each other
+    bool isBatchDraw() const { return m_batchDraw; }
+    void setBatchDraw(bool batchDraw);
+
+    // signs of scroll offset changes while scrolling fast, null if not scrolling
+    // items are prepared ahead in this direction only (see CacheSpaceGrid::setPrefetchMargin)
+    const QPoint& prefetchDirection() const { return m_prefetchDirection; }
+    void setPrefetchDirection(QPoint direction);
+
     QPoint window2Space(const QPoint& windowPoint) const;
     QPoint space2Window(const QPoint& spacePoint) const;
 
     void clear();
+    // recreates specified cache items only
+    void invalidateItems(const QVector<ID>& visibleIds);
+    // recreates cache items with absolute ids in range
+    void invalidateItems(const Range& range);
+
     const CacheItem* cacheItem(ID visibleId) const;
     const CacheItem* cacheItemByPosition(QPoint point) const;
 
     std::function<void(const CacheSpace*, QPainter* painter, const GuiContext& ctx)> drawProxy;
 
     void validate(const GuiContext& ctx) const;
-    void draw(QPainter* painter, const GuiContext& ctx) const;
-    void drawRaw(QPainter* painter, const GuiContext& ctx) const;
+    // validates cache views of items prepared ahead of drawing (see CacheSpaceGrid::setPrefetchMargin)
+    // returns false if budget (in microseconds) is over and some items are left
+    bool validateAhead(const GuiContext& ctx, qint64 budget) const;
+    // items out of exposedRect (in owner widget coordinates) are skipped
+    void draw(QPainter* painter, const GuiContext& ctx, const QRect* exposedRect = nullptr) const;
+    void drawRaw(QPainter* painter, const GuiContext& ctx, const QRect* exposedRect = nullptr) const;
+
+    // collects counters of cache work if set
+    const SharedPtr<CacheSpaceStatistics>& statistics() const { return m_statistics; }
+    void setStatistics(SharedPtr<CacheSpaceStatistics> statistics);
 
     CacheSpaceAnimationAbstract* animation() const;
     void setAnimation(CacheSpaceAnimationAbstract* animation);
@@ -81,13 +133,35 @@ public:
         IterateInfo(): cacheItemIndex(0), cacheView(nullptr), cacheViewIndex(0) {}
     };
 
+    // pool of retired cache items to reuse in newly created items
+    const SharedPtr<CacheItemsPool>& itemsPool() const { return m_itemsPool; }
+    void setItemsPool(SharedPtr<CacheItemsPool> itemsPool);
+
+    // cache shared with other cache spaces of the same space (see CacheSpaceShared)
+    // it replaces items factory and items pool of the cache space
+    const SharedPtr<CacheSpaceShared>& shared() const { return m_shared; }
+    void setShared(SharedPtr<CacheSpaceShared> shared);
+
     bool forEachCacheItem(const std::function<bool(const SharedPtr<CacheItem> &)> &visitor) const;
+
+    // memory of cache items with their cache views, items pool shared
+    // with other cache spaces is counted by each of them
+    MemoryUsage memoryUsage() const;
+    // frees items not needed to draw current window (retired and prefetched ones)
+    // cache spaces are trimmed by MemoryBudget::instance()
+    void trimMemory() const;
+    // memory of cache item with its cache view
+    static qint64 cacheItemBytes(const CacheItem& cacheItem);
     bool forEachCacheView(const std::function<bool(const IterateInfo&)>& visitor) const;
     //bool forEachCacheView(const std::function<bool(const makeShared<CacheItem>&, CacheView2*)>& visitor);
 
 
 signals:
     void cacheChanged(const CacheSpace* cache, ChangeReason reason);
+    // content of cache items within windowRegion was changed or they were moved there
+    // windowRegion is in owner widget units (see viewWindow)
+    // emitted instead of cacheChanged with ChangeReasonCacheContent
+    void cacheItemsChanged(const CacheSpace* cache, const QRegion& windowRegion);
 
 protected:
     explicit CacheSpace(SharedPtr<Space> space);
@@ -95,12 +169,38 @@ protected:
     void validateItemsCache() const;
     void clearItemsCache() const;
     SharedPtr<CacheItem> createCacheItem(ID visibleId) const;
+    // batch version of createCacheItem
+    QVector<SharedPtr<CacheItem>> createCacheItems(const QVector<ID>& visibleIds) const;
+    // puts retired item to the pool to reuse it in createCacheItem
+    void recycleCacheItem(SharedPtr<CacheItem> cacheItem) const;
 
     virtual void clearItemsCacheImpl() const = 0;
+    // items were reordered, by default all items are cleared
+    virtual void reorderItemsCacheImpl() const;
+    // items were resized, by default all items are cleared
+    virtual void resizeItemsCacheImpl() const;
+    // items should be recreated, by default all items are cleared
+    virtual void invalidateItemsImpl(const QVector<ID>& visibleIds) const;
+    virtual void invalidateItemsImpl(const Range& range) const;
+    // cache items factory was changed, by default schemas of all items are updated
+    virtual void updateItemsSchemaImpl() const;
+    // applies offset to all cache items, see m_itemsOffset
+    void applyItemsOffset() const;
+    virtual void applyItemsOffsetImpl(const QPoint& offset) const;
     virtual void validateItemsCacheImpl() const = 0;
     virtual bool forEachCacheItemImpl(const std::function<bool(const SharedPtr<CacheItem>&)>& visitor) const = 0;
+    // visits items which are not drawn yet, returns false if visitor stopped or more items are expected
+    virtual bool forEachCacheItemAheadImpl(const std::function<bool(const SharedPtr<CacheItem>&)>& /*visitor*/) const { return true; }
     virtual const CacheItem* cacheItemImpl(ID visibleId) const = 0;
     virtual const CacheItem* cacheItemByPositionImpl(QPoint point) const = 0;
+    // items rects may overlap each other
+    virtual bool isItemsOverlappedImpl() const { return false; }
+    // adds memory of items kept besides forEachCacheItemImpl ones
+    virtual void memoryUsageImpl(MemoryUsage& /*usage*/) const {}
+    // frees items kept besides forEachCacheItemImpl ones
+    virtual void trimMemoryImpl() const {}
+    // m_prefetchDirection was changed
+    virtual void prefetchDirectionChangedImpl() const {}
 
     // space
     SharedPtr<Space> m_space;
@@ -110,6 +210,8 @@ protected:
 
     // visible frame
     QRect m_window;
+    QRect m_viewWindow;
+    qreal m_scale;
     // offset within frame
     QPoint m_scrollOffset;
 
@@ -119,16 +221,35 @@ protected:
     // items cache validation flag
     mutable bool m_itemsCacheInvalid;
 
+    // scroll by painter translation
+    bool m_painterScroll;
+    // draw batchable views grouped by view
+    bool m_batchDraw;
+    QPoint m_prefetchDirection;
+    // offset not applied to cache items yet, painter is translated by it while drawing
+    mutable QPoint m_itemsOffset;
+
     // flag for debugging
     mutable bool m_cacheIsInUse;
 
+    // retired cache items, may be shared with other cache spaces
+    SharedPtr<CacheItemsPool> m_itemsPool;
+
     QPointer<CacheSpaceAnimationAbstract> m_animation;
 
+    SharedPtr<CacheSpaceStatistics> m_statistics;
+
+    SharedPtr<CacheSpaceShared> m_shared;
+
 private:
+    // lays out cache view or takes it from shared cache if item is fully visible in window
+    void validateCacheItem(CacheItem& cacheItem, const GuiContext& ctx, const QRect* window) const;
     void invalidateItemsCache(ChangeReason reason);
+    void drawBatched(QPainter* painter, const GuiContext& ctx, const QRect& window, const QRect& drawRect) const;
 
     void onSpaceChanged(const Space* space, ChangeReason reason);
-    void updateCacheItemsFactory();
+    void onSpaceItemsChanged(const Space* space, const QVector<ID>& items);
+    void updateCacheItemsFactory(ChangeReason reason);
 };
 
 } // end namespace Qi 
@@ -0,0 +1,143 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "CacheSpaceShared.h"
+#include "cache/CacheItem.h"
+#include "cache/CacheItemFactory.h"
+
+namespace Qi
+{
+
+// default count of laid out items to keep
+static const int CacheTemplatesLimit = 16 * 1024;
+
+CacheSpaceShared::CacheSpaceShared(SharedPtr<Space> space)
+    : m_space(std::move(space)),
+      m_itemsPool(makeShared<CacheItemsPool>()),
+      m_templatesLimit(CacheTemplatesLimit)
+{
+    Q_ASSERT(m_space);
+    connect(m_space.data(), &Space::spaceChanged, this, &CacheSpaceShared::onSpaceChanged);
+    connect(m_space.data(), &Space::spaceItemsChanged, this, &CacheSpaceShared::onSpaceItemsChanged);
+
+    m_cacheItemsFactory = m_space->createCacheItemFactory();
+    Q_ASSERT(m_cacheItemsFactory);
+
+    MemoryBudget::instance().addCache(this, "CacheSpaceShared", [this]() {
+        return memoryUsage().total();
+    }, [this](qint64 /*bytes*/) {
+        clear();
+        m_itemsPool->clear();
+    });
+}
+
+CacheSpaceShared::~CacheSpaceShared()
+{
+    disconnect(m_space.data(), &Space::spaceChanged, this, &CacheSpaceShared::onSpaceChanged);
+    disconnect(m_space.data(), &Space::spaceItemsChanged, this, &CacheSpaceShared::onSpaceItemsChanged);
+}
+
+void CacheSpaceShared::setTemplatesLimit(int templatesLimit)
+{
+    Q_ASSERT(templatesLimit >= 0);
+    m_templatesLimit = templatesLimit;
+    if (m_templates.size() > m_templatesLimit)
+        m_templates.clear();
+}
+
+void CacheSpaceShared::clear()
+{
+    m_templates.clear();
+}
+
+MemoryUsage CacheSpaceShared::memoryUsage() const
+{
+    MemoryUsage usage;
+
+    qint64 templatesBytes = MemoryUsage::bytes(m_templates);
+    for (const auto& cacheTemplate : m_templates)
+        templatesBytes += CacheSpace::cacheItemBytes(*cacheTemplate);
+    usage.add("templates", templatesBytes);
+
+    qint64 poolBytes = MemoryUsage::bytes(*m_itemsPool);
+    for (const auto& cacheItem : *m_itemsPool)
+        poolBytes += CacheSpace::cacheItemBytes(*cacheItem);
+    usage.add("pool", poolBytes);
+
+    return usage;
+}
+
+bool CacheSpaceShared::assignTemplate(ID visibleId, CacheItem& cacheItem, const QPoint& originPos) const
+{
+    auto it = m_templates.find(visibleId);
+    if (it == m_templates.end())
+        return false;
+
+    // visible id may point to another item after reordering
+    const CacheItem& cacheTemplate = *it.value();
+    if (cacheTemplate.id != cacheItem.id
+            || cacheTemplate.schema.view != cacheItem.schema.view
+            || cacheTemplate.schema.layout != cacheItem.schema.layout
+            || cacheTemplate.rect.translated(originPos) != cacheItem.rect)
+        return false;
+
+    cacheItem = cacheTemplate;
+    cacheItem.correctRectangles(originPos);
+    return true;
+}
+
+void CacheSpaceShared::storeTemplate(ID visibleId, const CacheItem& cacheItem, const QPoint& originPos)
+{
+    if (!cacheItem.isCacheViewValid() || m_templatesLimit == 0)
+        return;
+
+    if (m_templates.size() >= m_templatesLimit && !m_templates.contains(visibleId))
+        m_templates.clear();
+
+    auto& cacheTemplate = m_templates[visibleId];
+    if (cacheTemplate)
+        *cacheTemplate = cacheItem;
+    else
+        cacheTemplate = makeShared<CacheItem>(cacheItem);
+    cacheTemplate->correctRectangles(-originPos);
+}
+
+void CacheSpaceShared::onSpaceChanged(const Space* space, ChangeReason reason)
+{
+    Q_UNUSED(space);
+    Q_ASSERT(space == m_space.data());
+
+    // cache spaces take new factory after this slot (see CacheSpace::setShared)
+    if (reason & ChangeReasonSpaceHint)
+    {
+        m_cacheItemsFactory = m_space->createCacheItemFactory();
+        Q_ASSERT(m_cacheItemsFactory);
+    }
+
+    m_templates.clear();
+}
+
+void CacheSpaceShared::onSpaceItemsChanged(const Space* space, const QVector<ID>& items)
+{
+    Q_UNUSED(space);
+    Q_ASSERT(space == m_space.data());
+
+    for (const auto& item : items)
+        m_templates.remove(m_space->toVisible(item));
+}
+
+} // end namespace Qi
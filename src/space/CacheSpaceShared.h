@@ -0,0 +1,73 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_CACHE_SPACE_SHARED_H
+#define QI_CACHE_SPACE_SHARED_H
+
+#include "CacheSpace.h"
+#include <QHash>
+
+namespace Qi
+{
+
+// cache shared by cache spaces of one space shown in several widgets (split views)
+// cache spaces share items factory with memoized schemas, pool of retired items
+// and laid out cache views of fully visible items, so overlapped regions are laid out once
+// cache items of each cache space keep window specific rects only
+// (see CacheSpace::setShared)
+class QI_EXPORT CacheSpaceShared: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(CacheSpaceShared)
+
+public:
+    explicit CacheSpaceShared(SharedPtr<Space> space);
+    ~CacheSpaceShared();
+
+    const Space& space() const { return *m_space; }
+    const SharedPtr<CacheItemFactory>& cacheItemFactory() const { return m_cacheItemsFactory; }
+    const SharedPtr<CacheItemsPool>& itemsPool() const { return m_itemsPool; }
+
+    // templates are dropped once count of them exceeds the limit
+    int templatesCount() const { return m_templates.size(); }
+    int templatesLimit() const { return m_templatesLimit; }
+    void setTemplatesLimit(int templatesLimit);
+    void clear();
+    MemoryUsage memoryUsage() const;
+
+    // copies laid out cache view of the same item with the same rect
+    // relative to originPos, returns false if there is no such template
+    bool assignTemplate(ID visibleId, CacheItem& cacheItem, const QPoint& originPos) const;
+    // keeps laid out cache view of cacheItem with rect relative to originPos
+    void storeTemplate(ID visibleId, const CacheItem& cacheItem, const QPoint& originPos);
+
+private:
+    void onSpaceChanged(const Space* space, ChangeReason reason);
+    void onSpaceItemsChanged(const Space* space, const QVector<ID>& items);
+
+    SharedPtr<Space> m_space;
+    SharedPtr<CacheItemFactory> m_cacheItemsFactory;
+    SharedPtr<CacheItemsPool> m_itemsPool;
+
+    // laid out items by visible ids in space coordinates
+    QHash<ID, SharedPtr<CacheItem>> m_templates;
+    int m_templatesLimit;
+};
+
+} // end namespace Qi
+
+#endif // QI_CACHE_SPACE_SHARED_H
@@ -0,0 +1,57 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "CacheSpaceStatistics.h"
+
+namespace Qi
+{
+
+CacheSpaceStatistics::CacheSpaceStatistics()
+{
+}
+
+void CacheSpaceStatistics::reset()
+{
+    m_counters = Counters();
+    emit statisticsChanged(this);
+}
+
+void CacheSpaceStatistics::addValidation(bool rebuilt)
+{
+    if (rebuilt)
+        ++m_counters.validationsRebuilt;
+    else
+        ++m_counters.validationsOffset;
+}
+
+void CacheSpaceStatistics::addDraw(qint64 duration)
+{
+    Q_ASSERT(duration >= 0);
+
+    ++m_counters.draws;
+    m_counters.drawTime += duration;
+    m_counters.drawTimeMax = qMax(m_counters.drawTimeMax, quint64(duration));
+
+    // find exponential bucket
+    int bucket = 0;
+    for (qint64 bound = 128; duration >= bound && bucket < DrawHistogramSize - 1; bound *= 2)
+        ++bucket;
+    ++m_counters.drawHistogram[bucket];
+
+    emit statisticsChanged(this);
+}
+
+} // end namespace Qi
@@ -0,0 +1,87 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_CACHE_SPACE_STATISTICS_H
+#define QI_CACHE_SPACE_STATISTICS_H
+
+#include "QiAPI.h"
+#include <QObject>
+
+namespace Qi
+{
+
+// opt-in counters of cache space work (see CacheSpace::setStatistics)
+class QI_EXPORT CacheSpaceStatistics: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(CacheSpaceStatistics)
+
+public:
+    // histogram buckets: draw duration is less than 2^i * 128 microseconds
+    static const int DrawHistogramSize = 12;
+
+    struct QI_EXPORT Counters
+    {
+        // items cache validations which recreated frame
+        quint64 validationsRebuilt = 0;
+        // items cache validations which offset items only
+        quint64 validationsOffset = 0;
+        // cache items created from scratch
+        quint64 itemsCreated = 0;
+        // cache items taken from the pool
+        quint64 itemsRecycled = 0;
+        // cache items moved to the new frame position or taken from prefetched items
+        quint64 itemsReused = 0;
+        // schema lookups by cache items factory
+        quint64 schemaLookups = 0;
+        // cache views laid out
+        quint64 viewsLaidOut = 0;
+        // cache views copied from shared cache (see CacheSpaceShared)
+        quint64 viewsShared = 0;
+
+        // draw calls and total duration in microseconds
+        quint64 draws = 0;
+        quint64 drawTime = 0;
+        quint64 drawTimeMax = 0;
+        quint64 drawHistogram[DrawHistogramSize] = {};
+    };
+
+    CacheSpaceStatistics();
+
+    const Counters& counters() const { return m_counters; }
+    void reset();
+
+    void addValidation(bool rebuilt);
+    void addItemsCreated(int count = 1) { m_counters.itemsCreated += count; m_counters.schemaLookups += count; }
+    void addItemsRecycled(int count = 1) { m_counters.itemsRecycled += count; m_counters.schemaLookups += count; }
+    void addItemsReused(int count = 1) { m_counters.itemsReused += count; }
+    void addSchemaLookups(int count = 1) { m_counters.schemaLookups += count; }
+    void addViewsLaidOut(int count = 1) { m_counters.viewsLaidOut += count; }
+    void addViewsShared(int count = 1) { m_counters.viewsShared += count; }
+    // duration in microseconds
+    void addDraw(qint64 duration);
+
+signals:
+    // emitted after each draw
+    void statisticsChanged(const CacheSpaceStatistics*);
+
+private:
+    Counters m_counters;
+};
+
+} // end namespace Qi
+
+#endif // QI_CACHE_SPACE_STATISTICS_H
@@ -15,11 +15,15 @@
 */
 
 #include "Space.h"
+#include <algorithm>
 
 namespace Qi
 {
 
 Space::Space()
+    : m_schemasVersion(0),
+      m_schemasUpdates(0),
+      m_isSchemasChanged(false)
 {
 }
 
@@ -28,33 +32,24 @@ Space::~Space()
     clearSchemas();
 }
 
+QVector<QRect> Space::itemRects(const QVector<ID>& visibleItems) const
+{
+    QVector<QRect> rects;
+    rects.reserve(visibleItems.size());
+    for (ID visibleItem : visibleItems)
+        rects.append(itemRect(visibleItem));
+    return rects;
+}
+
 const QVector<ItemSchema>& Space::schemasOrdered() const
 {
     if (m_schemasOrdered.isEmpty() && !m_schemas.isEmpty())
     {
-        m_schemasOrdered.resize(m_schemas.size());
-
-        auto o_it = m_schemasOrdered.begin();
-
-        // copy non-final (CLIENT) views
-        for (const auto& schema: m_schemas)
-        {
-            if (!schema.layout->isFinal())
-            {
-                *o_it = schema;
-                ++o_it;
-            }
-        }
-
-        // copy final (CLIENT) views at the end
-        for (const auto& schema: m_schemas)
-        {
-            if (schema.layout->isFinal())
-            {
-                *o_it = schema;
-                ++o_it;
-            }
-        }
+        // non-final (CLIENT) views first and final views at the end in one pass
+        m_schemasOrdered = m_schemas;
+        std::stable_partition(m_schemasOrdered.begin(), m_schemasOrdered.end(), [](const ItemSchema& schema) {
+            return !schema.layout->isFinal();
+        });
     }
 
     return m_schemasOrdered;
@@ -66,8 +61,7 @@ int Space::addSchema(const ItemSchema& schema)
     m_schemasOrdered.clear();
 
     connectSchema(schema);
-
-    emit spaceChanged(this, ChangeReasonSpaceItemsStructure);
+    emitSchemasChanged();
 
     return m_schemas.size() - 1;
 }
@@ -80,8 +74,7 @@ int Space::insertSchema(int index, SharedPtr<Range> range, SharedPtr<View> view,
     m_schemasOrdered.clear();
 
     connectSchema(schema);
-
-    emit spaceChanged(this, ChangeReasonSpaceItemsStructure);
+    emitSchemasChanged();
 
     return index;
 }
@@ -96,7 +89,7 @@ void Space::removeSchema(SharedPtr<View> view)
             disconnectSchema(schema);
             m_schemas.remove(i);
             m_schemasOrdered.clear();
-            emit spaceChanged(this, ChangeReasonSpaceItemsStructure);
+            emitSchemasChanged();
             return;
         }
     }
@@ -112,39 +105,134 @@ void Space::clearSchemas()
     m_schemas.clear();
     m_schemasOrdered.clear();
 
-    emit spaceChanged(this, ChangeReasonSpaceItemsStructure);
+    emitSchemasChanged();
+}
+
+void Space::addSchemas(const QVector<ItemSchema>& schemas)
+{
+    if (schemas.isEmpty())
+        return;
+
+    m_schemas += schemas;
+    m_schemasOrdered.clear();
+
+    for (const auto& schema: schemas)
+        connectSchema(schema);
+    emitSchemasChanged();
+}
+
+void Space::setSchemas(const QVector<ItemSchema>& schemas)
+{
+    if (schemas.isEmpty() && m_schemas.isEmpty())
+        return;
+
+    // connect new schemas first, so objects kept by them stay connected
+    for (const auto& schema: schemas)
+        connectSchema(schema);
+    for (const auto& schema: m_schemas)
+        disconnectSchema(schema);
+
+    m_schemas = schemas;
+    m_schemasOrdered.clear();
+
+    emitSchemasChanged();
+}
+
+void Space::beginSchemasUpdate()
+{
+    ++m_schemasUpdates;
+}
+
+void Space::endSchemasUpdate()
+{
+    Q_ASSERT(m_schemasUpdates > 0);
+    if (--m_schemasUpdates > 0)
+        return;
+
+    if (m_isSchemasChanged)
+    {
+        m_isSchemasChanged = false;
+        emit spaceChanged(this, ChangeReasonSpaceItemsStructure);
+    }
+}
+
+void Space::emitSchemasChanged()
+{
+    ++m_schemasVersion;
+    if (m_schemasUpdates > 0)
+        m_isSchemasChanged = true;
+    else
+        emit spaceChanged(this, ChangeReasonSpaceItemsStructure);
 }
 
 void Space::connectSchema(const ItemSchema& schema)
 {
-    connect(schema.range.data(), &Range::rangeChanged, this, &Space::onRangeChanged);
-    connect(schema.layout.data(), &Layout::layoutChanged, this, &Space::onLayoutChanged);
-    connect(schema.view.data(), &View::viewChanged, this, &Space::onViewChanged);
+    if (m_schemaObjects[schema.range.data()]++ == 0)
+        schema.range->addListener(this);
+
+    if (m_schemaObjects[schema.layout.data()]++ == 0)
+        schema.layout->addListener(this);
+
+    if (m_schemaObjects[schema.view.data()]++ == 0)
+    {
+        connect(schema.view.data(), &View::viewChanged, this, &Space::onViewChanged);
+        connect(schema.view.data(), &View::viewItemsChanged, this, &Space::onViewItemsChanged);
+    }
+}
+
+// returns true if object is not referenced by schemas anymore
+static bool releaseSchemaObject(QHash<const QObject*, int>& schemaObjects, const QObject* object)
+{
+    auto it = schemaObjects.find(object);
+    Q_ASSERT(it != schemaObjects.end());
+    if (it == schemaObjects.end() || --it.value() > 0)
+        return false;
+
+    schemaObjects.erase(it);
+    return true;
 }
 
 void Space::disconnectSchema(const ItemSchema& schema)
 {
-    disconnect(schema.range.data(), &Range::rangeChanged, this, &Space::onRangeChanged);
-    disconnect(schema.layout.data(), &Layout::layoutChanged, this, &Space::onLayoutChanged);
-    disconnect(schema.view.data(), &View::viewChanged, this, &Space::onViewChanged);
+    if (releaseSchemaObject(m_schemaObjects, schema.range.data()))
+        schema.range->removeListener(this);
+
+    if (releaseSchemaObject(m_schemaObjects, schema.layout.data()))
+        schema.layout->removeListener(this);
+
+    if (releaseSchemaObject(m_schemaObjects, schema.view.data()))
+    {
+        disconnect(schema.view.data(), &View::viewChanged, this, &Space::onViewChanged);
+        disconnect(schema.view.data(), &View::viewItemsChanged, this, &Space::onViewItemsChanged);
+    }
 }
 
 void Space::onRangeChanged(const Range* /*range*/, ChangeReason reason)
 {
+    ++m_schemasVersion;
     emit spaceChanged(this, reason | ChangeReasonSpaceItemsStructure);
 }
 
 void Space::onLayoutChanged(const Layout* /*layout*/, ChangeReason reason)
 {
+    ++m_schemasVersion;
     emit spaceChanged(this, reason | ChangeReasonSpaceItemsStructure);
 }
 
 void Space::onViewChanged(const View* /*view*/, ChangeReason reason)
 {
     if (reason & ChangeReasonViewSize)
+    {
+        ++m_schemasVersion;
         emit spaceChanged(this, reason | ChangeReasonSpaceItemsStructure);
+    }
     else
         emit spaceChanged(this, reason | ChangeReasonSpaceItemsContent);
 }
 
+void Space::onViewItemsChanged(const View* /*view*/, const QVector<ID>& items)
+{
+    emit spaceItemsChanged(this, items);
+}
+
 } // end namespace Qi
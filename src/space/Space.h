@@ -22,13 +22,16 @@
 #include "core/View.h"
 #include <QSize>
 #include <QPoint>
+#include <QHash>
 
 namespace Qi
 {
 
 class CacheItemFactory;
 
-class QI_EXPORT Space: public QObject
+// ranges and layouts of schemas are observed by listeners instead of connections
+// to keep thousands of dynamic schemas cheap
+class QI_EXPORT Space: public QObject, private RangeListener, private LayoutListener
 {
     Q_OBJECT
     Q_DISABLE_COPY(Space)
@@ -41,6 +44,8 @@ public:
     virtual ID toAbsolute(ID visibleItem) const = 0;
     virtual ID toVisible(ID absoluteItem) const = 0;
     virtual QRect itemRect(ID visibleItem) const = 0;
+    // batch version of itemRect, spaces may share lookups between items
+    virtual QVector<QRect> itemRects(const QVector<ID>& visibleItems) const;
     virtual SharedPtr<CacheItemFactory> createCacheItemFactory() const = 0;
 
     const QVector<ItemSchema>& schemas() const { return m_schemas; }
@@ -49,23 +54,69 @@ public:
     int insertSchema(int index, SharedPtr<Range> range, SharedPtr<View> view, SharedPtr<Layout> layout = makeLayoutClient());
     void removeSchema(SharedPtr<View> view);
     void clearSchemas();
+    // bulk changes reconnect shared objects once and emit one spaceChanged
+    void addSchemas(const QVector<ItemSchema>& schemas);
+    void setSchemas(const QVector<ItemSchema>& schemas);
 
     const QVector<ItemSchema>& schemasOrdered() const;
 
+    // postpones spaceChanged of schemas changes until the outermost endSchemasUpdate
+    void beginSchemasUpdate();
+    void endSchemasUpdate();
+
+    // incremented by changes of schemas, their ranges, layouts and views sizes
+    // (each change with ChangeReasonSpaceItemsStructure) even during schemas update,
+    // memoized schemas of items are valid while it's the same
+    quint64 schemasVersion() const { return m_schemasVersion; }
+
 signals:
     void spaceChanged(const Space* space, ChangeReason reason);
+    // emitted instead of spaceChanged if only content of absolute items was changed
+    void spaceItemsChanged(const Space* space, const QVector<ID>& items);
 
 private slots:
-    void onRangeChanged(const Range* range, ChangeReason reason);
-    void onLayoutChanged(const Layout* layout, ChangeReason reason);
     void onViewChanged(const View* view, ChangeReason reason);
+    void onViewItemsChanged(const View* view, const QVector<ID>& items);
 
 private:
+    void onRangeChanged(const Range* range, ChangeReason reason) override;
+    void onLayoutChanged(const Layout* layout, ChangeReason reason) override;
+
     void connectSchema(const ItemSchema& schema);
     void disconnectSchema(const ItemSchema& schema);
+    void emitSchemasChanged();
 
     QVector<ItemSchema> m_schemas;
     mutable QVector<ItemSchema> m_schemasOrdered;
+
+    // ranges, layouts and views shared by schemas are connected once
+    // object -> count of schemas referencing it
+    QHash<const QObject*, int> m_schemaObjects;
+
+    quint64 m_schemasVersion;
+    int m_schemasUpdates;
+    bool m_isSchemasChanged;
+};
+
+// calls beginSchemasUpdate/endSchemasUpdate in scope
+class SpaceSchemasUpdateGuard
+{
+    Q_DISABLE_COPY(SpaceSchemasUpdateGuard)
+
+public:
+    explicit SpaceSchemasUpdateGuard(Space& space)
+        : m_space(space)
+    {
+        m_space.beginSchemasUpdate();
+    }
+
+    ~SpaceSchemasUpdateGuard()
+    {
+        m_space.endSchemasUpdate();
+    }
+
+private:
+    Space& m_space;
 };
 
 } // end namespace Qi 
@@ -16,15 +16,28 @@
 
 #include "CacheSpaceGrid.h"
 #include "cache/CacheItem.h"
+#include "core/Range.h"
+#include "space/CacheSpaceStatistics.h"
 #include "utils/auto_value.h"
+#include "utils/CallLater.h"
+#include "utils/Trace.h"
+#include <algorithm>
 
 namespace Qi
 {
 
 CacheSpaceGrid::CacheSpaceGrid(SharedPtr<SpaceGrid> grid)
     : CacheSpace(grid),
-      m_grid(grid)
+      m_grid(grid),
+      m_itemsReordered(false),
+      m_itemsDirty(false),
+      m_prefetchRows(0),
+      m_prefetchColumns(0),
+      m_prefetchScheduled(false)
 {
+    connect(m_grid.data(), &SpaceGrid::linesInserted, this, &CacheSpaceGrid::onLinesInserted);
+    connect(m_grid.data(), &SpaceGrid::linesRemoved, this, &CacheSpaceGrid::onLinesRemoved);
+    connect(m_grid.data(), &SpaceGrid::lineResized, this, &CacheSpaceGrid::onLineResized);
 }
 
 CacheSpaceGrid::~CacheSpaceGrid()
@@ -64,6 +77,22 @@ void CacheSpaceGrid::visibleItemsRange(GridID& idStart, GridID& idEnd) const
     idEnd = m_idEnd;
 }
 
+void CacheSpaceGrid::setPrefetchMargin(int rows, int columns)
+{
+    Q_ASSERT(rows >= 0 && columns >= 0);
+
+    if (m_prefetchRows == rows && m_prefetchColumns == columns)
+        return;
+
+    m_prefetchRows = rows;
+    m_prefetchColumns = columns;
+
+    if (m_prefetchRows == 0 && m_prefetchColumns == 0)
+        clearPrefetchedItems();
+    else
+        schedulePrefetch();
+}
+
 GridID CacheSpaceGrid::visibleItemByPosition(QPoint point) const
 {
     if (m_grid->isEmptyVisible())
@@ -83,13 +112,159 @@ void CacheSpaceGrid::clearItemsCacheImpl() const
     Q_ASSERT(!m_cacheIsInUse);
 
     m_idStart = m_idEnd = GridID();
+    for (auto& item: m_items)
+        recycleCacheItem(std::move(item));
     m_items.clear();
+    m_rowsInFrame.clear();
+    m_columnsInFrame.clear();
+    m_itemsReordered = false;
+    m_itemsDirty = false;
+    m_itemsOffset = QPoint(0, 0);
+    clearPrefetchedItems();
     m_scrollDelta = QPoint(0, 0);
     m_sizeDelta = QSize(0, 0);
 }
 
+void CacheSpaceGrid::reorderItemsCacheImpl() const
+{
+    Q_ASSERT(!m_cacheIsInUse);
+
+    // keep items to reuse them by absolute ids
+    if (!m_items.isEmpty())
+        m_itemsReordered = true;
+
+    // prefetched items are stored by visible ids
+    clearPrefetchedItems();
+}
+
+void CacheSpaceGrid::onLinesInserted(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount)
+{
+    Q_UNUSED(grid);
+    Q_ASSERT(grid == m_grid.data());
+    shiftItems(lines == m_grid->rows().data(), absoluteLine, linesCount);
+}
+
+void CacheSpaceGrid::onLinesRemoved(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount)
+{
+    Q_UNUSED(grid);
+    Q_ASSERT(grid == m_grid.data());
+    shiftItems(lines == m_grid->rows().data(), absoluteLine, -linesCount);
+}
+
+void CacheSpaceGrid::onLineResized(const SpaceGrid* grid, const Lines* lines, int absoluteLine)
+{
+    Q_UNUSED(grid);
+    Q_ASSERT(grid == m_grid.data());
+    Q_ASSERT(!m_cacheIsInUse);
+
+    bool isRows = (lines == m_grid->rows().data());
+    for (auto& item: m_items)
+    {
+        if (!item)
+            continue;
+
+        GridID id = item->id.as<GridID>();
+        if ((isRows ? id.row : id.column) != absoluteLine)
+            continue;
+
+        // item should be laid out with the new size
+        recycleCacheItem(std::move(item));
+        item.reset();
+    }
+}
+
+void CacheSpaceGrid::shiftItems(bool isRows, int absoluteLine, int delta) const
+{
+    Q_ASSERT(!m_cacheIsInUse);
+
+    // prefetched items are stored by visible ids
+    clearPrefetchedItems();
+
+    // keep frame lines in sync with items to reuse them after reordering
+    (isRows ? m_rowsInFrame : m_columnsInFrame).shift(absoluteLine, delta);
+
+    for (auto& item: m_items)
+    {
+        if (!item)
+            continue;
+
+        GridID id = item->id.as<GridID>();
+        int& line = isRows ? id.row : id.column;
+        if (line < absoluteLine)
+            continue;
+
+        if (delta < 0 && line < absoluteLine - delta)
+        {
+            // item of removed line
+            recycleCacheItem(std::move(item));
+            item.reset();
+            continue;
+        }
+
+        // values of models are shifted with lines, so cache views stay valid
+        line += delta;
+        item->id = ID(id);
+    }
+}
+
+void CacheSpaceGrid::updateItemsSchemaImpl() const
+{
+    CacheSpace::updateItemsSchemaImpl();
+    clearPrefetchedItems();
+}
+
+void CacheSpaceGrid::invalidateItemsImpl(const QVector<ID>& visibleIds) const
+{
+    Q_ASSERT(!m_cacheIsInUse);
+
+    for (const auto& visibleId: visibleIds)
+        recycleCacheItem(m_prefetchedItems.take(visibleId.as<GridID>()));
+
+    if (m_items.isEmpty())
+        return;
+
+    // reset items in frame, they will be recreated on validation
+    int idColumns = m_idEnd.column - m_idStart.column + 1;
+    for (const auto& visibleId: visibleIds)
+    {
+        auto visId = visibleId.as<GridID>();
+        if (visId.row < m_idStart.row || visId.row > m_idEnd.row ||
+            visId.column < m_idStart.column || visId.column > m_idEnd.column)
+            continue;
+
+        auto id = visId - m_idStart;
+        recycleCacheItem(std::move(m_items[id.row * idColumns + id.column]));
+        m_items[id.row * idColumns + id.column].reset();
+        m_itemsDirty = true;
+    }
+}
+
+void CacheSpaceGrid::invalidateItemsImpl(const Range& range) const
+{
+    CacheSpace::invalidateItemsImpl(range);
+
+    for (auto it = m_prefetchedItems.begin(); it != m_prefetchedItems.end(); )
+    {
+        if (range.hasItem(it.value()->id))
+        {
+            recycleCacheItem(std::move(it.value()));
+            it = m_prefetchedItems.erase(it);
+        }
+        else
+            ++it;
+    }
+}
+
+void CacheSpaceGrid::applyItemsOffsetImpl(const QPoint& offset) const
+{
+    CacheSpace::applyItemsOffsetImpl(offset);
+    m_rowsInFrame.translate(offset.y());
+    m_columnsInFrame.translate(offset.x());
+}
+
 void CacheSpaceGrid::validateItemsCacheImpl() const
 {
+    QI_TRACE_SCOPE(TraceCategoryCache, "CacheSpaceGrid::validateItemsCacheImpl");
     Q_ASSERT(m_itemsCacheInvalid);
 
     if (m_grid->isEmptyVisible())
@@ -104,10 +279,11 @@ void CacheSpaceGrid::validateItemsCacheImpl() const
     const Lines& rows = *m_grid->rows();
     const Lines& columns = *m_grid->columns();
 
-    int visibleRowStart = rows.findVisibleIDByPos(m_scrollOffset.y());
-    int visibleRowEnd = rows.findVisibleIDByPos(m_scrollOffset.y() + m_window.height());
-    int visibleColumnStart = columns.findVisibleIDByPos(m_scrollOffset.x());
-    int visibleColumnEnd = columns.findVisibleIDByPos(m_scrollOffset.x() + m_window.width());
+    // lines may be shared with neighbour grids which use the same range
+    int visibleRowStart, visibleRowEnd;
+    rows.visibleRangeByPos(m_scrollOffset.y(), m_window.height(), visibleRowStart, visibleRowEnd);
+    int visibleColumnStart, visibleColumnEnd;
+    columns.visibleRangeByPos(m_scrollOffset.x(), m_window.width(), visibleColumnStart, visibleColumnEnd);
 
     Q_ASSERT(visibleRowStart != InvalidIndex);
     Q_ASSERT(visibleRowEnd != InvalidIndex);
@@ -117,11 +293,55 @@ void CacheSpaceGrid::validateItemsCacheImpl() const
     GridID newIdStart(visibleRowStart, visibleColumnStart);
     GridID newIdEnd(visibleRowEnd, visibleColumnEnd);
 
-    if ((m_idStart == newIdStart) && (m_idEnd == newIdEnd))
+    // reordered items are found by absolute rows and columns of old frame,
+    // so moved lines permute items without recreating them
+    QVector<SharedPtr<CacheItem>> reorderedItems;
+    QHash<int, int> reorderedRows;
+    QHash<int, int> reorderedColumns;
+    int reorderedColumnsCount = 0;
+    if (m_itemsReordered)
     {
+        reorderedRows.reserve(m_rowsInFrame.absolute.size());
+        for (int i = 0; i < m_rowsInFrame.absolute.size(); ++i)
+        {
+            if (m_rowsInFrame.absolute[i] != InvalidIndex)
+                reorderedRows.insert(m_rowsInFrame.absolute[i], i);
+        }
+        reorderedColumns.reserve(m_columnsInFrame.absolute.size());
+        for (int i = 0; i < m_columnsInFrame.absolute.size(); ++i)
+        {
+            if (m_columnsInFrame.absolute[i] != InvalidIndex)
+                reorderedColumns.insert(m_columnsInFrame.absolute[i], i);
+        }
+        reorderedColumnsCount = m_columnsInFrame.absolute.size();
+        reorderedItems.swap(m_items);
+
+        m_idStart = m_idEnd = GridID();
+        m_rowsInFrame.clear();
+        m_columnsInFrame.clear();
+        m_itemsReordered = false;
+    }
+
+    // painter will be translated instead of correcting items
+    if (m_painterScroll)
+    {
+        m_itemsOffset += m_scrollDelta;
+        m_scrollDelta = QPoint(0, 0);
+    }
+
+    if ((m_idStart == newIdStart) && (m_idEnd == newIdEnd) && !m_itemsDirty)
+    {
+        if (m_statistics)
+            m_statistics->addValidation(false);
+
         // just offset rectangles
-        for (const auto& item: m_items)
-            item->correctRectangles(m_scrollDelta);
+        if (!m_scrollDelta.isNull())
+        {
+            for (const auto& item: m_items)
+                item->correctRectangles(m_scrollDelta);
+        }
+        m_rowsInFrame.translate(m_scrollDelta.y());
+        m_columnsInFrame.translate(m_scrollDelta.x());
 
         // clear offset
         m_scrollDelta = QPoint(0, 0);
@@ -131,6 +351,9 @@ void CacheSpaceGrid::validateItemsCacheImpl() const
         return;
     }
 
+    if (m_statistics)
+        m_statistics->addValidation(true);
+
     // init new items with empty caches
     int newIdRows = newIdEnd.row - newIdStart.row + 1;
     int newIdColumns = newIdEnd.column - newIdStart.column + 1;
@@ -152,12 +375,22 @@ void CacheSpaceGrid::validateItemsCacheImpl() const
                 auto& oldCacheItem = m_items[idOld.row * oldIdColumns + idOld.column];
                 auto& newCacheItem = newItems[idNew.row * newIdColumns + idNew.column];
                 newCacheItem.swap(oldCacheItem);
-                newCacheItem->correctRectangles(m_scrollDelta);
+                // dirty items are recreated below
+                if (newCacheItem)
+                    newCacheItem->correctRectangles(m_scrollDelta);
             }
     }
 
+    // layout lines of new frame in cache items coordinates
+    QPoint origin = originPos() - m_itemsOffset;
+    m_rowsInFrame.update(rows, newIdStart.row, newIdEnd.row, origin.y());
+    m_columnsInFrame.update(columns, newIdStart.column, newIdEnd.column, origin.x());
+
+    // non-intersected cells are created below by one batch
+    QVector<ID> idsToCreate;
+    QVector<int> indexesToCreate;
+
     // initialize non-intersected cells
-    QPoint origin = originPos();
     for (GridID idVisible = newIdStart; idVisible.column <= newIdEnd.column; ++idVisible.column)
     {
         for (idVisible.row = newIdStart.row; idVisible.row <= newIdEnd.row; ++idVisible.row)
@@ -168,15 +401,82 @@ void CacheSpaceGrid::validateItemsCacheImpl() const
             if (cacheItem)
                 continue;
 
-            cacheItem = createCacheItem(ID(idVisible));
-            // correct rectangle
-            cacheItem->rect.translate(origin);
+            if (!reorderedItems.isEmpty())
+            {
+                // reuse item at the new position
+                auto itRow = reorderedRows.find(m_rowsInFrame.absolute[id.row]);
+                auto itColumn = reorderedColumns.find(m_columnsInFrame.absolute[id.column]);
+                auto* reorderedItem = (itRow != reorderedRows.end() && itColumn != reorderedColumns.end()) ?
+                                        &reorderedItems[itRow.value() * reorderedColumnsCount + itColumn.value()] : nullptr;
+                if (reorderedItem && *reorderedItem)
+                {
+                    Q_ASSERT((*reorderedItem)->id.as<GridID>() == GridID(m_rowsInFrame.absolute[id.row], m_columnsInFrame.absolute[id.column]));
+                    cacheItem.swap(*reorderedItem);
+                    if (m_statistics)
+                        m_statistics->addItemsReused();
+
+                    QRect rect = itemRectInFrame(id);
+                    cacheItem->correctRectangles(rect.topLeft() - cacheItem->rect.topLeft());
+                    continue;
+                }
+            }
+
+            if (!m_prefetchedItems.isEmpty())
+            {
+                // use prefetched item
+                auto prefetchedItem = m_prefetchedItems.take(idVisible);
+                if (prefetchedItem)
+                {
+                    cacheItem.swap(prefetchedItem);
+                    if (m_statistics)
+                        m_statistics->addItemsReused();
+
+                    QRect rect = itemRectInFrame(id);
+                    cacheItem->correctRectangles(rect.topLeft() - cacheItem->rect.topLeft());
+                    continue;
+                }
+            }
+
+            idsToCreate.append(ID(idVisible));
+            indexesToCreate.append(id.row * newIdColumns + id.column);
+        }
+    }
+
+    auto createdItems = createCacheItems(idsToCreate);
+    for (int i = 0; i < createdItems.size(); ++i)
+    {
+        auto& cacheItem = newItems[indexesToCreate[i]];
+        cacheItem = std::move(createdItems[i]);
+        // correct rectangle
+        cacheItem->rect.translate(origin);
+    }
+
+    // keep items around new frame or recycle them
+    if (!m_items.isEmpty())
+    {
+        int oldIdColumns = m_idEnd.column - m_idStart.column + 1;
+        for (int i = 0, n = m_items.size(); i < n; ++i)
+        {
+            auto& item = m_items[i];
+            if (!item)
+                continue;
+
+            GridID idVisible(m_idStart.row + i / oldIdColumns, m_idStart.column + i % oldIdColumns);
+            if (isInPrefetchRing(idVisible, newIdStart, newIdEnd))
+                m_prefetchedItems.insert(idVisible, std::move(item));
+            else
+                recycleCacheItem(std::move(item));
         }
     }
+    for (auto& item: reorderedItems)
+        recycleCacheItem(std::move(item));
 
     m_idStart.swap(newIdStart);
     m_idEnd.swap(newIdEnd);
     m_items.swap(newItems);
+    m_itemsDirty = false;
+
+    schedulePrefetch();
 
     // clear offset
     m_scrollDelta = QPoint(0, 0);
@@ -189,12 +489,28 @@ bool CacheSpaceGrid::forEachCacheItemImpl(const std::function<bool (const Shared
 {
     for (const auto& cacheItem : m_items)
     {
+        // skip dirty items
+        if (!cacheItem)
+            continue;
+
         if (!visitor(cacheItem))
             return false;
     }
     return true;
 }
 
+bool CacheSpaceGrid::forEachCacheItemAheadImpl(const std::function<bool(const SharedPtr<CacheItem>&)>& visitor) const
+{
+    for (const auto& cacheItem : m_prefetchedItems)
+    {
+        if (!visitor(cacheItem))
+            return false;
+    }
+
+    // more items will be prefetched
+    return !m_prefetchScheduled;
+}
+
 const CacheItem* CacheSpaceGrid::cacheItemImpl(ID visibleId) const
 {
     auto visId = visibleId.as<GridID>();
@@ -216,13 +532,216 @@ const CacheItem* CacheSpaceGrid::cacheItemByPositionImpl(QPoint point) const
     if (isEmpty())
         return nullptr;
 
-    QPoint gridPoint = window2Space(point);
+    // search lines in frame directly
+    int row = m_rowsInFrame.find(point.y());
+    int column = m_columnsInFrame.find(point.x());
+    if (row == InvalidIndex || column == InvalidIndex)
+        return nullptr;
+
+    int idColumns = m_idEnd.column - m_idStart.column + 1;
+    return m_items[row * idColumns + column].data();
+}
+
+QRect CacheSpaceGrid::itemRectInFrame(GridID idInFrame) const
+{
+    QRect rect(0, 0, 0, 0);
+    rect.setTop(m_rowsInFrame.starts[idInFrame.row]);
+    rect.setLeft(m_columnsInFrame.starts[idInFrame.column]);
+    rect.setBottom(m_rowsInFrame.starts[idInFrame.row + 1]);
+    rect.setRight(m_columnsInFrame.starts[idInFrame.column + 1]);
+
+    return rect;
+}
+
+// margin before and after frame, whole margin goes ahead if direction is set
+static void prefetchMargins(int margin, int direction, int& before, int& after)
+{
+    before = (direction > 0) ? 0 : (direction < 0) ? margin * 2 : margin;
+    after = (direction < 0) ? 0 : (direction > 0) ? margin * 2 : margin;
+}
+
+void CacheSpaceGrid::prefetchBounds(GridID idStart, GridID idEnd, GridID& ringStart, GridID& ringEnd) const
+{
+    int rowsBefore, rowsAfter, columnsBefore, columnsAfter;
+    prefetchMargins(m_prefetchRows, m_prefetchDirection.y(), rowsBefore, rowsAfter);
+    prefetchMargins(m_prefetchColumns, m_prefetchDirection.x(), columnsBefore, columnsAfter);
+
+    ringStart = GridID(idStart.row - rowsBefore, idStart.column - columnsBefore);
+    ringEnd = GridID(idEnd.row + rowsAfter, idEnd.column + columnsAfter);
+}
+
+bool CacheSpaceGrid::isInPrefetchRing(GridID visibleId, GridID idStart, GridID idEnd) const
+{
+    GridID ringStart, ringEnd;
+    prefetchBounds(idStart, idEnd, ringStart, ringEnd);
+
+    if (visibleId.row < ringStart.row || visibleId.row > ringEnd.row)
+        return false;
+    if (visibleId.column < ringStart.column || visibleId.column > ringEnd.column)
+        return false;
+
+    // items in frame are not prefetched
+    return visibleId.row < idStart.row || visibleId.row > idEnd.row ||
+            visibleId.column < idStart.column || visibleId.column > idEnd.column;
+}
+
+void CacheSpaceGrid::prefetchDirectionChangedImpl() const
+{
+    // items behind are dropped and items ahead are added
+    schedulePrefetch();
+}
+
+void CacheSpaceGrid::schedulePrefetch() const
+{
+    if ((m_prefetchRows == 0 && m_prefetchColumns == 0) || m_prefetchScheduled)
+        return;
+
+    m_prefetchScheduled = true;
+    callLater(const_cast<CacheSpaceGrid*>(this), [this]() {
+        m_prefetchScheduled = false;
+        prefetchItems();
+    });
+}
+
+// maximal count of cache items to prefetch at once
+static const int PrefetchBatchSize = 256;
+
+void CacheSpaceGrid::prefetchItems() const
+{
+    // prefetch around valid frame only
+    if (m_itemsCacheInvalid || m_items.isEmpty())
+        return;
+
+    Q_ASSERT(!m_cacheIsInUse);
+
+    // drop items far from frame
+    for (auto it = m_prefetchedItems.begin(); it != m_prefetchedItems.end(); )
+    {
+        if (isInPrefetchRing(it.key(), m_idStart, m_idEnd))
+            ++it;
+        else
+        {
+            recycleCacheItem(std::move(it.value()));
+            it = m_prefetchedItems.erase(it);
+        }
+    }
+
+    GridID ringStart, ringEnd;
+    prefetchBounds(m_idStart, m_idEnd, ringStart, ringEnd);
+    ringStart = GridID(qMax(0, ringStart.row), qMax(0, ringStart.column));
+    ringEnd = GridID(qMin(m_grid->rows()->visibleCount() - 1, ringEnd.row), qMin(m_grid->columns()->visibleCount() - 1, ringEnd.column));
+
+    QVector<ID> idsToCreate;
+    bool isComplete = true;
+    for (GridID idVisible = ringStart; idVisible.row <= ringEnd.row && isComplete; ++idVisible.row)
+    {
+        for (idVisible.column = ringStart.column; idVisible.column <= ringEnd.column; ++idVisible.column)
+        {
+            if (!isInPrefetchRing(idVisible, m_idStart, m_idEnd))
+            {
+                // skip frame
+                idVisible.column = m_idEnd.column;
+                continue;
+            }
+
+            if (m_prefetchedItems.contains(idVisible))
+                continue;
+
+            // continue in the next event loop turn
+            if (idsToCreate.size() == PrefetchBatchSize)
+            {
+                isComplete = false;
+                break;
+            }
 
-    GridID visibleId;
-    visibleId.row = m_grid->rows()->findVisibleIDByPos(gridPoint.y(), m_idStart.row, m_idEnd.row);
-    visibleId.column = m_grid->columns()->findVisibleIDByPos(gridPoint.x(), m_idStart.column, m_idEnd.column);
+            idsToCreate.append(ID(idVisible));
+        }
+    }
+
+    auto createdItems = createCacheItems(idsToCreate);
+    for (int i = 0; i < createdItems.size(); ++i)
+        m_prefetchedItems.insert(idsToCreate[i].as<GridID>(), std::move(createdItems[i]));
+
+    if (!isComplete)
+        schedulePrefetch();
+}
+
+void CacheSpaceGrid::memoryUsageImpl(MemoryUsage& usage) const
+{
+    qint64 prefetchedBytes = MemoryUsage::bytes(m_prefetchedItems);
+    for (const auto& cacheItem : m_prefetchedItems)
+        prefetchedBytes += cacheItemBytes(*cacheItem);
+    usage.add("prefetched", prefetchedBytes);
+
+    usage.add("frame", MemoryUsage::bytes(m_items)
+              + MemoryUsage::bytes(m_rowsInFrame.starts) + MemoryUsage::bytes(m_rowsInFrame.absolute)
+              + MemoryUsage::bytes(m_columnsInFrame.starts) + MemoryUsage::bytes(m_columnsInFrame.absolute));
+}
+
+void CacheSpaceGrid::trimMemoryImpl() const
+{
+    // prefetched items are recreated in idle time
+    clearPrefetchedItems();
+}
+
+void CacheSpaceGrid::clearPrefetchedItems() const
+{
+    for (auto& item: m_prefetchedItems)
+        recycleCacheItem(std::move(item));
+    m_prefetchedItems.clear();
+}
+
+void CacheSpaceGrid::LinesInFrame::clear()
+{
+    starts.clear();
+    absolute.clear();
+}
+
+void CacheSpaceGrid::LinesInFrame::update(const Lines& lines, int lineStart, int lineEnd, int origin)
+{
+    int count = lineEnd - lineStart + 1;
+    starts.resize(count + 1);
+    absolute.resize(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        starts[i] = origin + lines.startPos(lineStart + i);
+        absolute[i] = lines.toAbsolute(lineStart + i);
+    }
+    starts[count] = origin + lines.endPos(lineEnd);
+}
+
+void CacheSpaceGrid::LinesInFrame::shift(int absoluteLine, int delta)
+{
+    for (int& line: absolute)
+    {
+        if (line == InvalidIndex || line < absoluteLine)
+            continue;
+
+        if (delta < 0 && line < absoluteLine - delta)
+            line = InvalidIndex;
+        else
+            line += delta;
+    }
+}
+
+void CacheSpaceGrid::LinesInFrame::translate(int offset)
+{
+    if (offset == 0)
+        return;
+
+    for (int& start: starts)
+        start += offset;
+}
+
+int CacheSpaceGrid::LinesInFrame::find(int position) const
+{
+    if (absolute.isEmpty() || position < starts.front() || position > starts.back())
+        return InvalidIndex;
 
-    return cacheItem(ID(visibleId));
+    // line with start position not greater than position
+    int index = int(std::upper_bound(starts.begin(), starts.end(), position) - starts.begin()) - 1;
+    return qBound(0, index, absolute.size() - 1);
 }
 
 } // end namespace Qi
@@ -19,6 +19,7 @@
 
 #include "space/CacheSpace.h"
 #include "SpaceGrid.h"
+#include <QHash>
 
 namespace Qi
 {
@@ -40,14 +41,62 @@ public:
     bool isItemAbsInFrame(GridID absId) const;
 
     void visibleItemsRange(GridID& idStart, GridID& idEnd) const;
+
+    // rows and columns around frame to prepare cache items in idle time
+    int prefetchRows() const { return m_prefetchRows; }
+    int prefetchColumns() const { return m_prefetchColumns; }
+    void setPrefetchMargin(int rows, int columns);
     GridID visibleItemByPosition(QPoint point) const;
 
 private:
     void clearItemsCacheImpl() const override;
+    void reorderItemsCacheImpl() const override;
+    void invalidateItemsImpl(const QVector<ID>& visibleIds) const override;
+    void invalidateItemsImpl(const Range& range) const override;
+    void updateItemsSchemaImpl() const override;
+    void applyItemsOffsetImpl(const QPoint& offset) const override;
     void validateItemsCacheImpl() const override;
     bool forEachCacheItemImpl(const std::function<bool(const SharedPtr<CacheItem>&)>& visitor) const override;
+    bool forEachCacheItemAheadImpl(const std::function<bool(const SharedPtr<CacheItem>&)>& visitor) const override;
     const CacheItem* cacheItemImpl(ID visibleId) const override;
     const CacheItem* cacheItemByPositionImpl(QPoint point) const override;
+    void memoryUsageImpl(MemoryUsage& usage) const override;
+    void trimMemoryImpl() const override;
+    void prefetchDirectionChangedImpl() const override;
+
+    // flat geometry of lines in frame (in window coordinates)
+    // cache item rect is intersection of its row and column
+    struct LinesInFrame
+    {
+        // starts[i] - start position of i-th line in frame, last value is end position
+        QVector<int> starts;
+        // absolute line of i-th line in frame
+        QVector<int> absolute;
+
+        void clear();
+        void update(const Lines& lines, int lineStart, int lineEnd, int origin);
+        void translate(int offset);
+        // shifts absolute lines like shiftItems does, removed lines become InvalidIndex
+        void shift(int absoluteLine, int delta);
+        // returns index of line in frame or InvalidIndex
+        int find(int position) const;
+    };
+
+    QRect itemRectInFrame(GridID idInFrame) const;
+
+    void onLinesInserted(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount);
+    void onLinesRemoved(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount);
+    // items of resized line are recycled, other items are moved to new rects on validation
+    void onLineResized(const SpaceGrid* grid, const Lines* lines, int absoluteLine);
+    // shifts absolute ids of cache items, items of removed lines are recycled
+    void shiftItems(bool isRows, int absoluteLine, int delta) const;
+
+    // bounds of prefetched items around frame, margins are moved ahead of prefetch direction
+    void prefetchBounds(GridID idStart, GridID idEnd, GridID& ringStart, GridID& ringEnd) const;
+    bool isInPrefetchRing(GridID visibleId, GridID idStart, GridID idEnd) const;
+    void schedulePrefetch() const;
+    void prefetchItems() const;
+    void clearPrefetchedItems() const;
 
     // source grid space
     SharedPtr<SpaceGrid> m_grid;
@@ -57,6 +106,20 @@ private:
     mutable GridID m_idEnd;
     // caches items
     mutable QVector<SharedPtr<CacheItem>> m_items;
+    // rows and columns of m_items
+    mutable LinesInFrame m_rowsInFrame;
+    mutable LinesInFrame m_columnsInFrame;
+    // items were reordered and m_items should be reused by absolute lines of old frame
+    mutable bool m_itemsReordered;
+    // some of m_items were reset and should be recreated
+    mutable bool m_itemsDirty;
+
+    // prefetch margin
+    int m_prefetchRows;
+    int m_prefetchColumns;
+    // cache items around frame by visible ids, rects are corrected on use
+    mutable QHash<GridID, SharedPtr<CacheItem>> m_prefetchedItems;
+    mutable bool m_prefetchScheduled;
 };
 
 } // end namespace Qi 
@@ -0,0 +1,338 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "CacheSpaceGridTiles.h"
+#include "cache/CacheItem.h"
+#include "cache/CacheItemFactory.h"
+#include "utils/TaskPool.h"
+#include <QPainter>
+#include <QImage>
+
+namespace Qi
+{
+
+static const QSize TileSizeDefault(256, 256);
+static const int MaxTilesDefault = 64;
+
+// tile rendered by worker from cache items laid out in GUI thread
+struct TileJob
+{
+    quint64 key = 0;
+    QRect tileRect;
+    QVector<SharedPtr<CacheItem>> items;
+    QImage image;
+};
+
+static bool isDrawThreadSafe(const QVector<SharedPtr<CacheItem>>& items)
+{
+    for (const auto& item : items)
+    {
+        const CacheView2* cacheView = item->cacheView();
+        if (cacheView && !cacheView->forEachCacheView([](const CacheView2* view) { return view->view()->isDrawThreadSafe(); }))
+            return false;
+    }
+
+    return true;
+}
+
+// items are drawn in space coordinates
+static void drawTileItems(QPaintDevice* device, const QRect& tileRect, const QVector<SharedPtr<CacheItem>>& items, const GuiContext& ctx)
+{
+    QPainter painter(device);
+    painter.translate(-tileRect.topLeft());
+    painter.setClipRect(tileRect);
+
+    for (const auto& item : items)
+        item->draw(&painter, ctx, &tileRect);
+}
+
+CacheSpaceGridTiles::CacheSpaceGridTiles(SharedPtr<CacheSpaceGrid> cacheGrid, QObject* parent)
+    : QObject(parent),
+      m_cacheGrid(std::move(cacheGrid)),
+      m_tileSize(TileSizeDefault),
+      m_maxTiles(MaxTilesDefault),
+      m_isParallelRendering(false),
+      m_tiles(MaxTilesDefault),
+      m_tilesPixelRatio(1)
+{
+    Q_ASSERT(m_cacheGrid);
+    Q_ASSERT(!m_cacheGrid->drawProxy);
+
+    m_cacheGrid->drawProxy = [this](const CacheSpace* cache, QPainter* painter, const GuiContext& ctx) {
+        draw(cache, painter, ctx);
+    };
+
+    connect(m_cacheGrid.data(), &CacheSpace::cacheChanged, this, &CacheSpaceGridTiles::onCacheChanged);
+    connect(&m_cacheGrid->space(), &Space::spaceItemsChanged, this, &CacheSpaceGridTiles::onSpaceItemsChanged);
+    connect(m_cacheGrid.data(), &CacheSpace::cacheItemsChanged, this, &CacheSpaceGridTiles::onCacheItemsChanged);
+
+    MemoryBudget::instance().addCache(this, "CacheSpaceGridTiles", [this]() {
+        return memoryUsage().total();
+    }, [this](qint64 /*bytes*/) {
+        invalidate();
+    });
+}
+
+CacheSpaceGridTiles::~CacheSpaceGridTiles()
+{
+    m_cacheGrid->drawProxy = nullptr;
+
+    disconnect(m_cacheGrid.data(), &CacheSpace::cacheChanged, this, &CacheSpaceGridTiles::onCacheChanged);
+    disconnect(&m_cacheGrid->space(), &Space::spaceItemsChanged, this, &CacheSpaceGridTiles::onSpaceItemsChanged);
+    disconnect(m_cacheGrid.data(), &CacheSpace::cacheItemsChanged, this, &CacheSpaceGridTiles::onCacheItemsChanged);
+}
+
+void CacheSpaceGridTiles::setTileSize(const QSize& tileSize)
+{
+    Q_ASSERT(!tileSize.isEmpty());
+
+    if (m_tileSize == tileSize)
+        return;
+
+    m_tileSize = tileSize;
+    invalidate();
+}
+
+void CacheSpaceGridTiles::setMaxTiles(int maxTiles)
+{
+    Q_ASSERT(maxTiles >= 0);
+    m_maxTiles = maxTiles;
+}
+
+void CacheSpaceGridTiles::setParallelRendering(bool isParallelRendering)
+{
+    m_isParallelRendering = isParallelRendering;
+}
+
+void CacheSpaceGridTiles::invalidate()
+{
+    m_tiles.clear();
+}
+
+MemoryUsage CacheSpaceGridTiles::memoryUsage() const
+{
+    MemoryUsage usage;
+    // tiles are 32-bit pixmaps of tile size in device pixels
+    qint64 tileBytes = qint64(m_tileSize.width()) * m_tileSize.height() * m_tilesPixelRatio * m_tilesPixelRatio * 4;
+    usage.add("tiles", m_tiles.size() * tileBytes);
+    return usage;
+}
+
+void CacheSpaceGridTiles::invalidate(const QRect& spaceRect)
+{
+    if (spaceRect.isEmpty() || m_tiles.isEmpty())
+        return;
+
+    int tileRowStart = spaceRect.top() / m_tileSize.height();
+    int tileRowEnd = spaceRect.bottom() / m_tileSize.height();
+    int tileColumnStart = spaceRect.left() / m_tileSize.width();
+    int tileColumnEnd = spaceRect.right() / m_tileSize.width();
+
+    // tiles range may be huge for wide rects
+    if ((qint64(tileRowEnd - tileRowStart + 1) * (tileColumnEnd - tileColumnStart + 1)) > m_tiles.size())
+    {
+        for (auto key : m_tiles.keys())
+        {
+            int tileRow = int(key >> 32);
+            int tileColumn = int(key & 0xFFFFFFFF);
+            if (tileRow >= tileRowStart && tileRow <= tileRowEnd && tileColumn >= tileColumnStart && tileColumn <= tileColumnEnd)
+                m_tiles.remove(key);
+        }
+        return;
+    }
+
+    for (int tileRow = tileRowStart; tileRow <= tileRowEnd; ++tileRow)
+        for (int tileColumn = tileColumnStart; tileColumn <= tileColumnEnd; ++tileColumn)
+            m_tiles.remove(tileKey(tileRow, tileColumn));
+}
+
+void CacheSpaceGridTiles::draw(const CacheSpace* cache, QPainter* painter, const GuiContext& ctx) const
+{
+    Q_ASSERT(cache == m_cacheGrid.data());
+
+    // animated items are drawn as is
+    if (cache->animation())
+    {
+        cache->drawRaw(painter, ctx);
+        return;
+    }
+
+    // cache items are used by controllers and tooltips
+    cache->validate(ctx);
+
+    const QRect& window = cache->window();
+    QRect spaceRect = QRect(cache->window2Space(window.topLeft()), window.size()) & QRect(QPoint(0, 0), cache->space().size());
+    if (spaceRect.isEmpty())
+        return;
+
+    int pixelRatio = painter->device() ? painter->device()->devicePixelRatio() : 1;
+    if (m_tilesPixelRatio != pixelRatio)
+    {
+        m_tiles.clear();
+        m_tilesPixelRatio = pixelRatio;
+    }
+
+    int tileRowStart = spaceRect.top() / m_tileSize.height();
+    int tileRowEnd = spaceRect.bottom() / m_tileSize.height();
+    int tileColumnStart = spaceRect.left() / m_tileSize.width();
+    int tileColumnEnd = spaceRect.right() / m_tileSize.width();
+
+    // visible tiles should fit in cache
+    int maxCost = m_maxTiles + (tileRowEnd - tileRowStart + 1) * (tileColumnEnd - tileColumnStart + 1);
+    if (m_tiles.maxCost() != maxCost)
+        m_tiles.setMaxCost(maxCost);
+
+    if (m_isParallelRendering)
+        renderTilesParallel(QRect(QPoint(tileColumnStart, tileRowStart), QPoint(tileColumnEnd, tileRowEnd)), pixelRatio, ctx);
+
+    painter->save();
+    painter->setClipRect(window);
+
+    for (int tileRow = tileRowStart; tileRow <= tileRowEnd; ++tileRow)
+        for (int tileColumn = tileColumnStart; tileColumn <= tileColumnEnd; ++tileColumn)
+        {
+            QPoint tileOrigin(tileColumn * m_tileSize.width(), tileRow * m_tileSize.height());
+            painter->drawPixmap(cache->space2Window(tileOrigin), tile(tileRow, tileColumn, pixelRatio, ctx));
+        }
+
+    painter->restore();
+}
+
+QPixmap CacheSpaceGridTiles::tile(int tileRow, int tileColumn, int pixelRatio, const GuiContext& ctx) const
+{
+    quint64 key = tileKey(tileRow, tileColumn);
+    if (const QPixmap* pixmap = m_tiles.object(key))
+        return *pixmap;
+
+    QPixmap pixmap(m_tileSize * pixelRatio);
+    pixmap.setDevicePixelRatio(pixelRatio);
+    renderTile(pixmap, QRect(QPoint(tileColumn * m_tileSize.width(), tileRow * m_tileSize.height()), m_tileSize), ctx);
+
+    m_tiles.insert(key, new QPixmap(pixmap));
+    MemoryBudget::instance().trimLater();
+    return pixmap;
+}
+
+void CacheSpaceGridTiles::renderTile(QPixmap& pixmap, const QRect& tileRect, const GuiContext& ctx) const
+{
+    pixmap.fill(Qt::transparent);
+    drawTileItems(&pixmap, tileRect, tileItems(tileRect, ctx), ctx);
+}
+
+void CacheSpaceGridTiles::renderTilesParallel(const QRect& tiles, int pixelRatio, const GuiContext& ctx) const
+{
+    // views may lay out cache items in GUI thread only
+    // each job gets own cache items, so cache views aren't shared by workers
+    QVector<TileJob> jobs;
+    for (int tileRow = tiles.top(); tileRow <= tiles.bottom(); ++tileRow)
+        for (int tileColumn = tiles.left(); tileColumn <= tiles.right(); ++tileColumn)
+        {
+            quint64 key = tileKey(tileRow, tileColumn);
+            if (m_tiles.contains(key))
+                continue;
+
+            TileJob job;
+            job.key = key;
+            job.tileRect = QRect(QPoint(tileColumn * m_tileSize.width(), tileRow * m_tileSize.height()), m_tileSize);
+            job.items = tileItems(job.tileRect, ctx);
+
+            // such tile is rendered in GUI thread by tile()
+            if (!isDrawThreadSafe(job.items))
+                continue;
+
+            jobs.append(job);
+        }
+
+    // nothing to share with workers
+    if (jobs.size() < 2)
+        return;
+
+    QSize imageSize = m_tileSize * pixelRatio;
+    TaskPool::instance().parallelFor(0, jobs.size(), 1, [&jobs, imageSize, pixelRatio, &ctx](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+        {
+            TileJob& job = jobs[i];
+            job.image = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+            job.image.setDevicePixelRatio(pixelRatio);
+            job.image.fill(Qt::transparent);
+            drawTileItems(&job.image, job.tileRect, job.items, ctx);
+        }
+    });
+
+    // GUI thread only composites rendered tiles
+    for (const auto& job : jobs)
+        m_tiles.insert(job.key, new QPixmap(QPixmap::fromImage(job.image)));
+
+    MemoryBudget::instance().trimLater();
+}
+
+QVector<SharedPtr<CacheItem>> CacheSpaceGridTiles::tileItems(const QRect& tileRect, const GuiContext& ctx) const
+{
+    QVector<SharedPtr<CacheItem>> items;
+
+    const SpaceGrid& grid = *m_cacheGrid->spaceGrid();
+    const Lines& rows = *grid.rows();
+    const Lines& columns = *grid.columns();
+    if (rows.isEmptyVisible() || columns.isEmptyVisible())
+        return items;
+
+    int rowStart = rows.findVisibleIDByPos(tileRect.top());
+    int rowEnd = rows.findVisibleIDByPos(tileRect.bottom());
+    int columnStart = columns.findVisibleIDByPos(tileRect.left());
+    int columnEnd = columns.findVisibleIDByPos(tileRect.right());
+
+    const CacheItemFactory& factory = m_cacheGrid->cacheItemFactory();
+    items.reserve((rowEnd - rowStart + 1) * (columnEnd - columnStart + 1));
+    for (int row = rowStart; row <= rowEnd; ++row)
+        for (int column = columnStart; column <= columnEnd; ++column)
+        {
+            auto cacheItem = makeShared<CacheItem>(factory.create(ID(GridID(row, column))));
+            cacheItem->validateCacheView(ctx, &tileRect);
+            items.append(cacheItem);
+        }
+
+    return items;
+}
+
+void CacheSpaceGridTiles::onCacheChanged(const CacheSpace* /*cache*/, ChangeReason reason)
+{
+    // window and scroll offset changes keep tiles
+    if ((reason & ~(ChangeReasonCacheItems | ChangeReasonCacheFrame)) || !(reason & ChangeReasonCacheFrame))
+        invalidate();
+}
+
+void CacheSpaceGridTiles::onSpaceItemsChanged(const Space* space, const QVector<ID>& items)
+{
+    for (const auto& item : items)
+    {
+        ID visibleId = space->toVisible(item);
+        if (visibleId.as<GridID>().isValid())
+            invalidate(space->itemRect(visibleId));
+    }
+}
+
+void CacheSpaceGridTiles::onCacheItemsChanged(const CacheSpace* cache, const QRegion& windowRegion)
+{
+    // repainted parts of the window (e.g. hot views of controllers) are rendered again
+    QRect spaceBounds(QPoint(0, 0), cache->space().size());
+    for (const auto& viewRect : windowRegion.rects())
+    {
+        QRect windowRect = cache->fromView(viewRect);
+        invalidate(QRect(cache->window2Space(windowRect.topLeft()), windowRect.size()) & spaceBounds);
+    }
+}
+
+} // end namespace Qi
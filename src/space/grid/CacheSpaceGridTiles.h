@@ -0,0 +1,91 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_CACHE_SPACE_GRID_TILES_H
+#define QI_CACHE_SPACE_GRID_TILES_H
+
+#include "CacheSpaceGrid.h"
+#include <QCache>
+#include <QPixmap>
+
+namespace Qi
+{
+
+// off-screen render cache of CacheSpaceGrid
+// grid is rendered into fixed size pixmap tiles in space coordinates
+// and tiles are composited on paint, so scrolling redraws no items
+// tiles of changed items are dropped, any other content change drops all tiles
+// installs drawProxy of the cache grid while alive
+// missing tiles may be rendered concurrently (see setParallelRendering)
+class QI_EXPORT CacheSpaceGridTiles: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(CacheSpaceGridTiles)
+
+public:
+    explicit CacheSpaceGridTiles(SharedPtr<CacheSpaceGrid> cacheGrid, QObject* parent = nullptr);
+    ~CacheSpaceGridTiles();
+
+    const SharedPtr<CacheSpaceGrid>& cacheGrid() const { return m_cacheGrid; }
+
+    QSize tileSize() const { return m_tileSize; }
+    void setTileSize(const QSize& tileSize);
+
+    // tiles kept besides visible ones
+    int maxTiles() const { return m_maxTiles; }
+    void setMaxTiles(int maxTiles);
+
+    // missing visible tiles are rendered into images by TaskPool workers
+    // if all their views are thread safe for drawing (see View::isDrawThreadSafe),
+    // other tiles are rendered in GUI thread, cache items are laid out in GUI thread anyway
+    bool isParallelRendering() const { return m_isParallelRendering; }
+    void setParallelRendering(bool isParallelRendering);
+
+    // drops all tiles
+    void invalidate();
+    // drops tiles intersecting rect in space coordinates
+    void invalidate(const QRect& spaceRect);
+
+    MemoryUsage memoryUsage() const;
+
+private:
+    void draw(const CacheSpace* cache, QPainter* painter, const GuiContext& ctx) const;
+    QPixmap tile(int tileRow, int tileColumn, int pixelRatio, const GuiContext& ctx) const;
+    void renderTile(QPixmap& pixmap, const QRect& tileRect, const GuiContext& ctx) const;
+    // renders missing tiles of tiles range concurrently
+    void renderTilesParallel(const QRect& tiles, int pixelRatio, const GuiContext& ctx) const;
+    // cache items intersecting tile with valid cache views
+    QVector<SharedPtr<CacheItem>> tileItems(const QRect& tileRect, const GuiContext& ctx) const;
+
+    void onCacheChanged(const CacheSpace* cache, ChangeReason reason);
+    void onSpaceItemsChanged(const Space* space, const QVector<ID>& items);
+    void onCacheItemsChanged(const CacheSpace* cache, const QRegion& windowRegion);
+
+    static quint64 tileKey(int tileRow, int tileColumn) { return (quint64(quint32(tileRow)) << 32) | quint32(tileColumn); }
+
+    SharedPtr<CacheSpaceGrid> m_cacheGrid;
+    QSize m_tileSize;
+    int m_maxTiles;
+    bool m_isParallelRendering;
+
+    mutable QCache<quint64, QPixmap> m_tiles;
+    // device pixel ratio tiles were rendered for
+    mutable int m_tilesPixelRatio;
+};
+
+} // end namespace Qi
+
+#endif // QI_CACHE_SPACE_GRID_TILES_H
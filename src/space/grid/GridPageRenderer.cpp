@@ -0,0 +1,206 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "GridPageRenderer.h"
+#include "CacheSpaceGrid.h"
+#include "utils/PainterState.h"
+#include <QWidget>
+#include <QPainter>
+#include <QPagedPaintDevice>
+#include <QImageWriter>
+
+namespace Qi
+{
+
+GridPageRenderer::GridPageRenderer(SharedPtr<SpaceGrid> grid, const QWidget* styleWidget)
+    : m_grid(std::move(grid)),
+      m_styleWidget(styleWidget),
+      m_pageSize(800, 1000),
+      m_isPagesValid(false)
+{
+    Q_ASSERT(m_grid);
+
+    if (!m_styleWidget)
+    {
+        m_ownStyleWidget.reset(new QWidget());
+        m_styleWidget = m_ownStyleWidget.data();
+    }
+
+    m_cacheGrid.reset(new CacheSpaceGrid(m_grid));
+    m_gridConnection = QObject::connect(m_grid.data(), &Space::spaceChanged, [this]() {
+        onGridChanged();
+    });
+}
+
+GridPageRenderer::~GridPageRenderer()
+{
+    QObject::disconnect(m_gridConnection);
+}
+
+void GridPageRenderer::setPageSize(const QSize& pageSize)
+{
+    Q_ASSERT(!pageSize.isEmpty());
+    if (m_pageSize == pageSize)
+        return;
+
+    m_pageSize = pageSize;
+    m_isPagesValid = false;
+}
+
+int GridPageRenderer::pagesCount() const
+{
+    validatePages();
+    return (m_rowBreaks.size() - 1) * (m_columnBreaks.size() - 1);
+}
+
+QRect GridPageRenderer::pageRect(int page) const
+{
+    validatePages();
+
+    int columnPages = m_columnBreaks.size() - 1;
+    if (page < 0 || page >= pagesCount())
+    {
+        Q_ASSERT(false);
+        return QRect();
+    }
+
+    int rowPage = page / columnPages;
+    int columnPage = page % columnPages;
+    return QRect(QPoint(m_columnBreaks[columnPage], m_rowBreaks[rowPage]),
+                 QPoint(m_columnBreaks[columnPage + 1] - 1, m_rowBreaks[rowPage + 1] - 1));
+}
+
+void GridPageRenderer::renderPage(int page, QPainter* painter) const
+{
+    QRect rect = pageRect(page);
+    if (rect.isEmpty())
+        return;
+
+    GuiContext ctx(m_styleWidget);
+
+    // cache items of the page only
+    m_cacheGrid->set(QRect(QPoint(0, 0), rect.size()), rect.topLeft());
+
+    painter->save();
+    copyPainterState(m_styleWidget, painter);
+    painter->setClipRect(m_cacheGrid->window(), Qt::IntersectClip);
+    m_cacheGrid->draw(painter, ctx);
+    painter->restore();
+
+    m_cacheGrid->clear();
+}
+
+bool GridPageRenderer::print(QPagedPaintDevice* device) const
+{
+    Q_ASSERT(device);
+
+    int pages = pagesCount();
+    if (pages == 0)
+        return false;
+
+    QPainter painter;
+    if (!painter.begin(device))
+        return false;
+
+    QRect deviceRect = painter.viewport();
+    for (int page = 0; page < pages; ++page)
+    {
+        if (page > 0 && !device->newPage())
+            return false;
+
+        QSize size = pageRect(page).size();
+        qreal scale = qMin(1.0, qMin(qreal(deviceRect.width()) / size.width(), qreal(deviceRect.height()) / size.height()));
+
+        painter.save();
+        painter.scale(scale, scale);
+        renderPage(page, &painter);
+        painter.restore();
+    }
+
+    return painter.end();
+}
+
+bool GridPageRenderer::exportImages(const QString& fileNamePattern, const QByteArray& format) const
+{
+    int pages = pagesCount();
+    for (int page = 0; page < pages; ++page)
+    {
+        QImage image(pageRect(page).size(), QImage::Format_ARGB32_Premultiplied);
+        image.fill(m_styleWidget->palette().color(QPalette::Base));
+
+        {
+            QPainter painter(&image);
+            renderPage(page, &painter);
+        }
+
+        QImageWriter writer(fileNamePattern.arg(page + 1), format);
+        if (!writer.write(image))
+            return false;
+    }
+
+    return pages > 0;
+}
+
+// returns start positions of pages which don't cut lines
+static QVector<int> pageBreaks(const Lines& lines, int pageSize)
+{
+    QVector<int> breaks;
+    breaks.append(0);
+
+    int size = lines.visibleSize();
+    if (lines.isEmptyVisible() || size <= 0)
+        return breaks;
+
+    int start = 0;
+    while (start < size)
+    {
+        int end = start + pageSize;
+        if (end >= size)
+        {
+            end = size;
+        }
+        else
+        {
+            // move the cut line to the next page if it's not larger than page
+            int line = lines.findVisibleIDByPos(end - 1);
+            if (line != InvalidIndex && lines.endPos(line) > end && lines.startPos(line) > start)
+                end = lines.startPos(line);
+        }
+
+        breaks.append(end);
+        start = end;
+    }
+
+    return breaks;
+}
+
+void GridPageRenderer::validatePages() const
+{
+    if (m_isPagesValid)
+        return;
+
+    m_rowBreaks = pageBreaks(*m_grid->rows(), m_pageSize.height());
+    m_columnBreaks = pageBreaks(*m_grid->columns(), m_pageSize.width());
+    m_isPagesValid = true;
+}
+
+void GridPageRenderer::onGridChanged()
+{
+    m_isPagesValid = false;
+}
+
+} // end namespace Qi
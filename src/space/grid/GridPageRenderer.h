@@ -0,0 +1,83 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_GRID_PAGE_RENDERER_H
+#define QI_GRID_PAGE_RENDERER_H
+
+#include "SpaceGrid.h"
+#include <QScopedPointer>
+
+class QWidget;
+class QPainter;
+class QPagedPaintDevice;
+
+namespace Qi
+{
+
+class CacheSpaceGrid;
+
+// renders grid page by page without visible widget (printing, export)
+// pages are laid out in space coordinates, lines are not cut by page breaks
+// unless a line is larger than the page
+// one page of cache items is alive at a time, so memory doesn't depend on grid size
+class QI_EXPORT GridPageRenderer
+{
+    Q_DISABLE_COPY(GridPageRenderer)
+
+public:
+    // styleWidget provides style, palette and font, hidden widget is used if it's null
+    explicit GridPageRenderer(SharedPtr<SpaceGrid> grid, const QWidget* styleWidget = nullptr);
+    ~GridPageRenderer();
+
+    const SharedPtr<SpaceGrid>& grid() const { return m_grid; }
+
+    // maximal page size in space coordinates
+    QSize pageSize() const { return m_pageSize; }
+    void setPageSize(const QSize& pageSize);
+
+    // pages go left to right, then top to bottom
+    int pagesCount() const;
+    QRect pageRect(int page) const;
+
+    // draws page at painter origin
+    void renderPage(int page, QPainter* painter) const;
+
+    // draws all pages scaled down to fit device pages
+    bool print(QPagedPaintDevice* device) const;
+    // writes each page to file named by fileNamePattern.arg(page + 1)
+    bool exportImages(const QString& fileNamePattern, const QByteArray& format = "png") const;
+
+private:
+    void validatePages() const;
+    void onGridChanged();
+
+    SharedPtr<SpaceGrid> m_grid;
+    QScopedPointer<QWidget> m_ownStyleWidget;
+    const QWidget* m_styleWidget;
+    QScopedPointer<CacheSpaceGrid> m_cacheGrid;
+    QSize m_pageSize;
+
+    // start positions of pages, last value is the end of the last page
+    mutable QVector<int> m_rowBreaks;
+    mutable QVector<int> m_columnBreaks;
+    mutable bool m_isPagesValid;
+    QMetaObject::Connection m_gridConnection;
+};
+
+} // end namespace Qi
+
+#endif // QI_GRID_PAGE_RENDERER_H
@@ -0,0 +1,229 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "GridTextExporter.h"
+#include "cache/CacheItemFactory.h"
+#include <QIODevice>
+#include <QTimer>
+#include "utils/TaskPool.h"
+#include <atomic>
+
+namespace Qi
+{
+
+struct GridTextExporter::ExportJob
+{
+    SharedPtr<CacheItemFactory> factory;
+    // absolute indexes of visible lines
+    QVector<int> rows;
+    QVector<int> columns;
+    QIODevice* device = nullptr;
+    QChar separator;
+    bool quoting = true;
+    bool succeeded = false;
+    TaskToken token;
+    std::atomic<int> progress { 0 };
+};
+
+// rows between buffer flushes and progress updates
+static const int ExportChunkRows = 1024;
+static const int ExportBufferSize = 64 * 1024;
+// interval to update export progress
+static const int ExportProgressInterval = 100;
+
+static QVector<int> visibleLines(const Lines& lines)
+{
+    QVector<int> result;
+    int count = lines.visibleCount();
+    result.reserve(count);
+    for (int i = 0; i < count; ++i)
+        result.append(lines.toAbsolute(i));
+    return result;
+}
+
+static void appendField(QString& row, const QString& text, QChar separator, bool quoting)
+{
+    bool quote = quoting && (text.contains(separator) || text.contains(QLatin1Char('"')) ||
+                             text.contains(QLatin1Char('\n')) || text.contains(QLatin1Char('\r')));
+    if (!quote)
+    {
+        row.append(text);
+        return;
+    }
+
+    row.append(QLatin1Char('"'));
+    for (QChar ch : text)
+    {
+        if (ch == QLatin1Char('"'))
+            row.append(QLatin1Char('"'));
+        row.append(ch);
+    }
+    row.append(QLatin1Char('"'));
+}
+
+GridTextExporter::GridTextExporter(SharedPtr<SpaceGrid> grid, QObject* parent)
+    : QObject(parent),
+      m_grid(std::move(grid)),
+      m_separator(QLatin1Char(',')),
+      m_quoting(true),
+      m_progressTimer(new QTimer(this))
+{
+    Q_ASSERT(m_grid);
+
+    m_progressTimer->setInterval(ExportProgressInterval);
+    connect(m_progressTimer, &QTimer::timeout, this, &GridTextExporter::onExportTimeout);
+}
+
+GridTextExporter::~GridTextExporter()
+{
+    // worker thread owns job so it's safe to leave it
+    cancelExport();
+}
+
+bool GridTextExporter::exportTo(QIODevice* device) const
+{
+    auto job = createJob(device);
+    return job && runJob(*job);
+}
+
+bool GridTextExporter::startExport(QIODevice* device)
+{
+    // new export replaces previous one
+    cancelExport();
+
+    auto job = createJob(device);
+    if (!job)
+        return false;
+
+    TaskPool::instance().run(this, [job]() {
+        job->succeeded = runJob(*job);
+    }, [this, job]() {
+        onExportFinished(job);
+    }, TaskPriorityNormal, job->token);
+
+    m_job = job;
+    m_progressTimer->start();
+
+    return true;
+}
+
+int GridTextExporter::exportProgress() const
+{
+    return m_job ? m_job->progress.load() : 0;
+}
+
+void GridTextExporter::cancelExport()
+{
+    if (!m_job)
+        return;
+
+    m_job->token.cancel();
+    m_job.reset();
+    m_progressTimer->stop();
+}
+
+SharedPtr<GridTextExporter::ExportJob> GridTextExporter::createJob(QIODevice* device) const
+{
+    Q_ASSERT(device);
+    if (!device->isWritable())
+        return SharedPtr<ExportJob>();
+
+    // Lines and ordered schemas are not thread safe, so resolve them here
+    m_grid->schemasOrdered();
+
+    auto job = makeShared<ExportJob>();
+    job->factory = m_grid->createCacheItemFactory();
+    job->rows = visibleLines(*m_grid->rows());
+    job->columns = visibleLines(*m_grid->columns());
+    job->device = device;
+    job->separator = m_separator;
+    job->quoting = m_quoting;
+
+    return job;
+}
+
+bool GridTextExporter::runJob(ExportJob& job)
+{
+    QString row;
+    QString text;
+    QByteArray buffer;
+    buffer.reserve(ExportBufferSize + ExportBufferSize / 4);
+
+    int rowsCount = job.rows.size();
+    for (int i = 0; i < rowsCount; ++i)
+    {
+        row.resize(0);
+        for (int j = 0; j < job.columns.size(); ++j)
+        {
+            if (j > 0)
+                row.append(job.separator);
+
+            CacheItemInfo info(ID(GridID(job.rows[i], job.columns[j])));
+            job.factory->updateSchema(info);
+            if (!info.schema.view)
+                continue;
+
+            text.resize(0);
+            if (info.schema.view->text(info.id, text))
+                appendField(row, text, job.separator, job.quoting);
+        }
+        row.append(QLatin1Char('\n'));
+
+        buffer.append(row.toUtf8());
+        if (buffer.size() >= ExportBufferSize)
+        {
+            if (job.device->write(buffer) != buffer.size())
+                return false;
+            buffer.resize(0);
+        }
+
+        if ((i + 1) % ExportChunkRows == 0)
+        {
+            if (job.token.isCancelled())
+                return false;
+            job.progress = int(qint64(i + 1) * 100 / rowsCount);
+        }
+    }
+
+    if (!buffer.isEmpty() && job.device->write(buffer) != buffer.size())
+        return false;
+
+    job.progress = 100;
+    return true;
+}
+
+void GridTextExporter::onExportFinished(const SharedPtr<ExportJob>& job)
+{
+    // export was cancelled or replaced
+    if (m_job != job)
+        return;
+
+    m_job.reset();
+    m_progressTimer->stop();
+
+    emit exportFinished(this, job->succeeded);
+}
+
+void GridTextExporter::onExportTimeout()
+{
+    if (!m_job)
+        return;
+
+    emit exportProgressChanged(this, m_job->progress);
+}
+
+} // end namespace Qi
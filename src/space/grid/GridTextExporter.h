@@ -0,0 +1,84 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_GRID_TEXT_EXPORTER_H
+#define QI_GRID_TEXT_EXPORTER_H
+
+#include "SpaceGrid.h"
+#include <QObject>
+
+class QIODevice;
+class QTimer;
+
+namespace Qi
+{
+
+// writes text of visible grid items (see View::text) as CSV or TSV
+// rows are processed in chunks and written through one reused buffer,
+// so memory doesn't depend on the number of rows
+class QI_EXPORT GridTextExporter: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(GridTextExporter)
+
+public:
+    explicit GridTextExporter(SharedPtr<SpaceGrid> grid, QObject* parent = nullptr);
+    virtual ~GridTextExporter();
+
+    const SharedPtr<SpaceGrid>& grid() const { return m_grid; }
+
+    // ',' for CSV (default), '\t' for TSV
+    QChar separator() const { return m_separator; }
+    void setSeparator(QChar separator) { m_separator = separator; }
+
+    // quote fields with separators, quotes or line breaks
+    bool isQuoting() const { return m_quoting; }
+    void setQuoting(bool quoting) { m_quoting = quoting; }
+
+    // writes utf-8 text in GUI thread
+    bool exportTo(QIODevice* device) const;
+
+    // writes text in background thread, models of grid views should be thread safe
+    // grid schemas and device should not be touched until exportFinished
+    bool startExport(QIODevice* device);
+    bool isExporting() const { return !m_job.isNull(); }
+    int exportProgress() const;
+    void cancelExport();
+
+signals:
+    void exportProgressChanged(const GridTextExporter*, int percent);
+    void exportFinished(const GridTextExporter*, bool succeeded);
+
+private:
+    struct ExportJob;
+
+    SharedPtr<ExportJob> createJob(QIODevice* device) const;
+    static bool runJob(ExportJob& job);
+    void onExportFinished(const SharedPtr<ExportJob>& job);
+    void onExportTimeout();
+
+    SharedPtr<SpaceGrid> m_grid;
+    QChar m_separator;
+    bool m_quoting;
+
+    SharedPtr<ExportJob> m_job;
+    QTimer* m_progressTimer;
+};
+
+} // end namespace Qi
+
+#endif // QI_GRID_TEXT_EXPORTER_H
@@ -15,15 +15,226 @@
 */
 
 #include "Lines.h"
+#include "utils/Trace.h"
+#include <QDataStream>
+#include <numeric>
+#include <algorithm>
+#include <iterator>
 
 namespace Qi
 {
 
 static const int DefaultLineSize = 0;
 static const bool DefaultLineVisibility = true;
+// max size runs count to calculate positions without Fenwick tree
+static const int ArithmeticSizesLimit = 64;
+// max lines count which visibility changes are patched into visible lines caches
+static const int IncrementalVisibilityLimit = 64;
+// min visible lines count to build sizes index, smaller trees stay in cpu caches
+static const int SizesIndexMinLines = 16 * 1024;
+// tree lookups per visible line to build sizes index, building costs about the same
+static const int SizesIndexQueriesRatio = 1024;
+
+// helpers over lines data shared by Lines and LinesSnapshot
+
+static int sizeRunsValue(const QMap<int, int>& runs, int line)
+{
+    if (runs.empty())
+        return DefaultLineSize;
+    else if (runs.size() == 1)
+        return runs.begin().value();
+    else
+        return (runs.upperBound(line) - 1).value();
+}
+
+// removes runs which continue previous run
+static void compactSizeRuns(QMap<int, int>& runs)
+{
+    if (runs.empty())
+        return;
+
+    int size = runs.begin().value();
+    for (auto it = runs.begin() + 1; it != runs.end(); )
+    {
+        if (it.value() == size)
+        {
+            it = runs.erase(it);
+        }
+        else
+        {
+            size = it.value();
+            ++it;
+        }
+    }
+}
+
+static int sizeRunsPrefixSum(const QMap<int, int>& runs, int linesCount)
+{
+    if (runs.empty())
+        return linesCount * DefaultLineSize;
+
+    int sum = 0;
+    for (auto it = runs.begin(); it != runs.end() && it.key() < linesCount; ++it)
+    {
+        auto itNext = it + 1;
+        int runEnd = (itNext == runs.end()) ? linesCount : qMin(itNext.key(), linesCount);
+        sum += (runEnd - it.key()) * it.value();
+    }
+
+    return sum;
+}
+
+static int sizeRunsLowerBound(const QMap<int, int>& runs, int count, int position)
+{
+    if (runs.empty())
+        return (DefaultLineSize > 0) ? qBound(0, position / DefaultLineSize, count) : count;
+
+    int result = 0;
+    int runStartPos = 0;
+    for (auto it = runs.begin(); it != runs.end(); ++it)
+    {
+        if (runStartPos > position)
+            break;
+
+        auto itNext = it + 1;
+        int runStart = it.key();
+        int runEnd = (itNext == runs.end()) ? count : itNext.key();
+        int size = it.value();
+
+        // greatest line in [runStart, runEnd] which starts before position
+        result = (size == 0) ? runEnd : qMin(runEnd, runStart + (position - runStartPos) / size);
+        if (result < runEnd)
+            break;
+
+        runStartPos += (runEnd - runStart) * size;
+    }
+
+    return result;
+}
+
+static int fenwickPrefixSum(const QVector<int>& tree, int visibleLinesCount)
+{
+    Q_ASSERT(visibleLinesCount >= 0 && visibleLinesCount < tree.size());
+
+    int sum = 0;
+    for (int i = visibleLinesCount; i > 0; i -= (i & -i))
+        sum += tree[i];
+    return sum;
+}
+
+static int fenwickLowerBound(const QVector<int>& tree, int position)
+{
+    int n = tree.size() - 1;
+
+    int step = 1;
+    while ((step << 1) <= n)
+        step <<= 1;
+
+    int index = 0;
+    for (; step > 0; step >>= 1)
+    {
+        int next = index + step;
+        if (next <= n && tree[next] <= position)
+        {
+            index = next;
+            position -= tree[next];
+        }
+    }
+
+    return index;
+}
+
+LinesSnapshot::LinesSnapshot()
+    : m_count(0),
+      m_visibleCount(0),
+      m_isVisiblesBitwise(true),
+      m_uniformLineSize(DefaultLineSize),
+      m_isSizesArithmetic(false)
+{
+}
+
+int LinesSnapshot::lineSize(int line) const
+{
+    Q_ASSERT(line >= 0 && line < m_count);
+    return sizeRunsValue(m_linesSizeRuns, line);
+}
+
+int LinesSnapshot::toAbsolute(int visibleLine) const
+{
+    Q_ASSERT(visibleLine >= 0 && visibleLine < m_visibleCount);
+
+    if (m_isVisiblesBitwise)
+        return (m_linesVisible.size() > 1) ? m_linesVisible.select(visibleLine) : visibleLine;
+
+    return m_visible2absolute[visibleLine];
+}
+
+int LinesSnapshot::toVisible(int absoluteLine) const
+{
+    Q_ASSERT(absoluteLine >= 0 && absoluteLine < m_count);
+
+    if (m_isVisiblesBitwise)
+    {
+        if (m_linesVisible.size() > 1)
+            return m_linesVisible.value(absoluteLine) ? m_linesVisible.rank(absoluteLine) : InvalidIndex;
+
+        return (m_visibleCount > 0) ? absoluteLine : InvalidIndex;
+    }
+
+    return m_absolute2visible[absoluteLine];
+}
+
+int LinesSnapshot::findVisibleIDByPos(int position, bool noTailLine) const
+{
+    if (isEmptyVisible())
+        return InvalidIndex;
+
+    if (position <= 0)
+        return 0;
+
+    if (position > endPos(m_visibleCount - 1))
+        return noTailLine ? m_visibleCount - 1 : m_visibleCount;
+
+    int line = 0;
+    if (m_uniformLineSize != InvalidIndex)
+        line = (m_uniformLineSize > 0) ? position / m_uniformLineSize : m_visibleCount;
+    else if (m_isSizesArithmetic)
+        line = sizeRunsLowerBound(m_linesSizeRuns, m_count, position);
+    else if (!m_sizesIndex.empty())
+        line = m_sizesIndex.upperBound(position) - 1;
+    else
+        line = fenwickLowerBound(m_visibleLinesTree, position);
+
+    return qBound(0, line, m_visibleCount - 1);
+}
+
+int LinesSnapshot::sizesPrefixSum(int visibleLinesCount) const
+{
+    Q_ASSERT(visibleLinesCount >= 0 && visibleLinesCount <= m_visibleCount);
+
+    if (m_uniformLineSize != InvalidIndex)
+        return visibleLinesCount * m_uniformLineSize;
+
+    if (m_isSizesArithmetic)
+        return sizeRunsPrefixSum(m_linesSizeRuns, visibleLinesCount);
+
+    if (!m_sizesIndex.empty())
+        return m_sizesIndex.key(visibleLinesCount);
+
+    return fenwickPrefixSum(m_visibleLinesTree, visibleLinesCount);
+}
 
 Lines::Lines(int count)
-    : m_count(0)
+    : m_count(0),
+      m_version(0),
+      m_isIdentityPermutation(true),
+      m_visibleRangeVersion(quint64(-1)),
+      m_visibleRangePosition(0),
+      m_visibleRangeSize(0),
+      m_visibleRangeStart(InvalidIndex),
+      m_visibleRangeEnd(InvalidIndex),
+      m_treeQueries(0),
+      m_isSizesIndexEnabled(true)
 {
     setCount(count);
 }
@@ -31,20 +242,223 @@ Lines::Lines(int count)
 Lines::Lines(const Lines& lines)
     : QObject(),
       m_count(lines.m_count),
-      m_linesSize(lines.m_linesSize),
+      m_version(lines.m_version),
+      m_linesSizeRuns(lines.m_linesSizeRuns),
       m_linesVisible(lines.m_linesVisible),
       m_relative2absolute(lines.m_relative2absolute),
+      m_isIdentityPermutation(lines.m_isIdentityPermutation),
       m_visible2absolute(lines.m_visible2absolute),
       m_absolute2visible(lines.m_absolute2visible),
-      m_visibleLinesSizes(lines.m_visibleLinesSizes)
+      m_visibleLinesTree(lines.m_visibleLinesTree),
+      m_sizesIndex(lines.m_sizesIndex),
+      m_visibleRangeVersion(quint64(-1)),
+      m_visibleRangePosition(0),
+      m_visibleRangeSize(0),
+      m_visibleRangeStart(InvalidIndex),
+      m_visibleRangeEnd(InvalidIndex),
+      m_treeQueries(0),
+      m_isSizesIndexEnabled(lines.m_isSizesIndexEnabled)
 {
 }
 
 SharedPtr<Lines> Lines::clone() const
 {
+    // containers are implicitly shared, so clone copies storage
+    // only when it or the source is changed
     return SharedPtr<Lines>(new Lines(*this));
 }
 
+static const quint32 LinesStateMagic = 0x51694c6e;
+static const quint16 LinesStateVersion = 1;
+
+// arrays are written as is on little endian hosts
+template <typename T>
+static void writeStateArray(QDataStream& stream, const QVector<T>& array)
+{
+    stream << qint32(array.size());
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    stream.writeRawData(reinterpret_cast<const char*>(array.constData()), array.size() * int(sizeof(T)));
+#else
+    for (const T& value : array)
+        stream << value;
+#endif
+}
+
+template <typename T>
+static bool readStateArray(QDataStream& stream, QVector<T>& array)
+{
+    qint32 size = -1;
+    stream >> size;
+    // size should fit into remaining data
+    if (stream.status() != QDataStream::Ok || size < 0 || (stream.device() && qint64(size) * qint64(sizeof(T)) > stream.device()->bytesAvailable()))
+        return false;
+
+    array.resize(size);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    int bytes = size * int(sizeof(T));
+    return stream.readRawData(reinterpret_cast<char*>(array.data()), bytes) == bytes;
+#else
+    for (T& value : array)
+        stream >> value;
+    return stream.status() == QDataStream::Ok;
+#endif
+}
+
+QByteArray Lines::saveState() const
+{
+    // size runs as pairs of first line and size
+    QVector<qint32> runs;
+    runs.reserve(m_linesSizeRuns.size() * 2);
+    for (auto it = m_linesSizeRuns.begin(); it != m_linesSizeRuns.end(); ++it)
+    {
+        runs.append(it.key());
+        runs.append(it.value());
+    }
+
+    QByteArray state;
+    QDataStream stream(&state, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream << LinesStateMagic << LinesStateVersion << qint32(m_count);
+    writeStateArray(stream, runs);
+    stream << qint32(m_linesVisible.size());
+    writeStateArray(stream, m_linesVisible.words());
+    // identity permutation is not saved
+    writeStateArray(stream, m_isIdentityPermutation ? QVector<int>() : m_relative2absolute);
+
+    return state;
+}
+
+bool Lines::restoreState(const QByteArray& state)
+{
+    QDataStream stream(state);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint32 count = -1;
+    stream >> magic >> version >> count;
+    if (stream.status() != QDataStream::Ok || magic != LinesStateMagic || version != LinesStateVersion || count < 0)
+        return false;
+
+    // lines data is stored for one line at least as in setCount
+    int storeCount = qMax(count, 1);
+
+    QVector<qint32> runs;
+    if (!readStateArray(stream, runs) || runs.size() % 2)
+        return false;
+
+    QMap<int, int> linesSizeRuns;
+    for (int i = 0; i < runs.size(); i += 2)
+    {
+        int line = runs[i];
+        int size = runs[i + 1];
+        bool isLineValid = (i == 0) ? line == 0 : (line > runs[i - 2] && line < storeCount);
+        if (!isLineValid || size < 0)
+            return false;
+        linesSizeRuns.insert(linesSizeRuns.end(), line, size);
+    }
+
+    qint32 visibleSize = -1;
+    stream >> visibleSize;
+    QVector<quint64> visibleWords;
+    if (!readStateArray(stream, visibleWords))
+        return false;
+    if (visibleSize != 0 && visibleSize != 1 && visibleSize != storeCount)
+        return false;
+    if (visibleWords.size() != (visibleSize + 63) / 64)
+        return false;
+
+    QVector<int> permutation;
+    if (!readStateArray(stream, permutation))
+        return false;
+    if (!permutation.isEmpty())
+    {
+        if (permutation.size() != count)
+            return false;
+
+        BitVector lines;
+        lines.resize(count);
+        for (int line : permutation)
+        {
+            if (line < 0 || line >= count || lines.value(line))
+                return false;
+            lines.setValue(line, true);
+        }
+    }
+
+    m_count = count;
+    m_linesSizeRuns = linesSizeRuns;
+    m_linesVisible.assign(visibleWords, visibleSize);
+    m_relative2absolute = permutation;
+    m_isIdentityPermutation = permutation.isEmpty();
+
+    invalidateLinesVisibility();
+    invalidateVisibles();
+
+    // one notification for all restored data
+    emitLinesChanged(ChangeReasonLinesCount|ChangeReasonLinesVisibility|ChangeReasonLinesSize|ChangeReasonLinesOrder);
+    return true;
+}
+
+MemoryUsage Lines::memoryUsage() const
+{
+    MemoryUsage usage;
+    usage.add("sizes", MemoryUsage::bytes(m_linesSizeRuns));
+    usage.add("sizesTree", MemoryUsage::bytes(m_visibleLinesTree));
+    usage.add("sizesIndex", m_sizesIndex.memoryBytes());
+    usage.add("visibility", m_linesVisible.memoryBytes());
+    qint64 filtersBytes = m_linesVisibleCombined.memoryBytes();
+    for (const auto& bits : m_linesVisibilityBits)
+        filtersBytes += bits.memoryBytes();
+    usage.add("visibilityFilters", filtersBytes);
+    usage.add("permutation", MemoryUsage::bytes(m_relative2absolute));
+    usage.add("visibles", MemoryUsage::bytes(m_visible2absolute) + MemoryUsage::bytes(m_absolute2visible));
+    return usage;
+}
+
+LinesSnapshot Lines::snapshot() const
+{
+    LinesSnapshot snapshot;
+    snapshot.m_count = m_count;
+    snapshot.m_visibleCount = visibleCount();
+    snapshot.m_relative2absolute = permutation();
+
+    snapshot.m_isVisiblesBitwise = isVisiblesBitwise();
+    if (snapshot.m_isVisiblesBitwise)
+    {
+        snapshot.m_linesVisible = m_linesVisible;
+        // build ranks now, snapshot readers must not modify shared data
+        if (snapshot.m_linesVisible.size() > 1)
+            snapshot.m_linesVisible.count();
+    }
+    else
+    {
+        validateVisibles();
+        snapshot.m_visible2absolute = m_visible2absolute;
+        snapshot.m_absolute2visible = m_absolute2visible;
+    }
+
+    snapshot.m_linesSizeRuns = m_linesSizeRuns;
+    if (isSizesUniform())
+    {
+        snapshot.m_uniformLineSize = uniformLineSize();
+    }
+    else
+    {
+        snapshot.m_uniformLineSize = InvalidIndex;
+        snapshot.m_isSizesArithmetic = isSizesArithmetic();
+        if (!snapshot.m_isSizesArithmetic)
+        {
+            validateSizes();
+            snapshot.m_visibleLinesTree = m_visibleLinesTree;
+            snapshot.m_sizesIndex = m_sizesIndex;
+        }
+    }
+
+    return snapshot;
+}
+
 void Lines::setCount(int _count)
 {
     int count = _count;
@@ -52,79 +466,251 @@ void Lines::setCount(int _count)
     if (m_count == count)
     {
         // fire events for listeners who is interested if even actual count wasn't changed
-        emit linesChanged(this, ChangeReasonLinesCountWeak);
+        emitLinesChanged(ChangeReasonLinesCountWeak);
         return;
     }
 
+    int oldCount = m_count;
     m_count = count;
 
     int storeCount = qMax(m_count, 1);
 
     // resize all lines data
-    if (m_linesSize.size() > 1)
+    if (m_linesSizeRuns.size() > 1)
     {
-        int oldSize = m_linesSize.size();
-        m_linesSize.resize(storeCount);
-        for (int i = oldSize; i < storeCount; ++i)
-            m_linesSize[i] = DefaultLineSize;
+        // drop runs of removed lines
+        for (auto it = m_linesSizeRuns.lowerBound(storeCount); it != m_linesSizeRuns.end(); )
+            it = m_linesSizeRuns.erase(it);
+
+        // new lines has default size
+        if (m_count > oldCount && (m_linesSizeRuns.end() - 1).value() != DefaultLineSize)
+            m_linesSizeRuns[oldCount] = DefaultLineSize;
     }
 
     if (m_linesVisible.size() > 1)
     {
-        int oldSize = m_linesVisible.size();
-        m_linesVisible.resize(storeCount);
-        for (int i = oldSize; i < storeCount; ++i)
-            m_linesVisible[i] = DefaultLineVisibility;
+        m_linesVisible.resize(storeCount, DefaultLineVisibility);
     }
 
-    // initialize permutation
-    m_relative2absolute.resize(count);
-    for (int i = 0; i < count; ++i)
-        m_relative2absolute[i] = i;
+    // identity permutation is materialized on demand
+    m_relative2absolute.clear();
+    m_isIdentityPermutation = true;
 
     // invalidate caches
+    invalidateLinesVisibility();
     invalidateVisibles();
 
     // fire signal
-    linesChanged(this, ChangeReasonLinesCount|ChangeReasonLinesCountWeak);
+    emitLinesChanged(ChangeReasonLinesCount|ChangeReasonLinesCountWeak);
 }
 
-static int moveValues(QVector<int>& values, int oldIndex, int newIndex, int count)
+bool Lines::insertLines(int absoluteLine, int linesCount)
 {
-    Q_ASSERT(oldIndex >= 0 && oldIndex < values.size());
-    Q_ASSERT(newIndex >= 0 && newIndex < values.size());
-    Q_ASSERT(count > 0);
+    if (absoluteLine < 0 || absoluteLine > m_count || linesCount <= 0)
+        return false;
+
+    int oldCount = m_count;
 
-    int index = InvalidIndex;
+    // shift size runs, new lines has default size as in setCount
+    if (m_linesSizeRuns.size() > 1)
+    {
+        int sizeAfter = (absoluteLine < oldCount) ? lineSize(absoluteLine) : DefaultLineSize;
 
-    QVector<int> newValues;
-    newValues.resize(values.size());
+        QMap<int, int> runs;
+        for (auto it = m_linesSizeRuns.begin(); it != m_linesSizeRuns.end(); ++it)
+            runs.insert((it.key() < absoluteLine) ? it.key() : it.key() + linesCount, it.value());
 
-    if (newIndex < oldIndex)
+        runs[absoluteLine] = DefaultLineSize;
+        if (absoluteLine < oldCount)
+            runs[absoluteLine + linesCount] = sizeAfter;
+
+        compactSizeRuns(runs);
+        m_linesSizeRuns.swap(runs);
+    }
+
+    if (m_linesVisible.size() > 1)
     {
-        std::copy(values.begin(),                           values.begin() + newIndex,              newValues.begin());
-        std::copy(values.begin() + newIndex,                values.begin() + oldIndex,              newValues.begin() + newIndex + count);
-        std::copy(values.begin() + oldIndex,                values.begin() + oldIndex + count,      newValues.begin() + newIndex);
-        std::copy(values.begin() + oldIndex + count,        values.end(),                           newValues.begin() + oldIndex + count);
-        index = newIndex;
+        m_linesVisible.insert(absoluteLine, linesCount, DefaultLineVisibility);
     }
-    else // newLine > oldLine + lineCount
+
+    bool isAppend = (absoluteLine == oldCount);
+
+    if (isAppend)
     {
-        int midSize = qMin(newIndex - oldIndex, values.size() - (oldIndex + count));
-        std::copy(values.begin(),                           values.begin() + oldIndex,                      newValues.begin());
-        std::copy(values.begin() + oldIndex + count,        values.begin() + oldIndex + count + midSize,    newValues.begin() + oldIndex);
-        std::copy(values.begin() + oldIndex,                values.begin() + oldIndex + count,              newValues.begin() + oldIndex + midSize);
+        // new lines go to the end of relative order, materialized identity is kept
+        if (!m_isIdentityPermutation || m_relative2absolute.size() == oldCount)
+        {
+            m_relative2absolute.resize(oldCount + linesCount);
+            std::iota(m_relative2absolute.begin() + oldCount, m_relative2absolute.end(), oldCount);
+        }
+    }
+    else if (m_isIdentityPermutation)
+    {
+        // stays identity
+        m_relative2absolute.clear();
+    }
+    else
+    {
+        // shift absolute lines and put new lines before shifted absoluteLine
+        int relativeLine = m_relative2absolute.size();
+        for (int i = 0, n = m_relative2absolute.size(); i < n; ++i)
+        {
+            int& line = m_relative2absolute[i];
+            if (line == absoluteLine)
+                relativeLine = i;
+            if (line >= absoluteLine)
+                line += linesCount;
+        }
+
+        m_relative2absolute.insert(relativeLine, linesCount, absoluteLine);
+        std::iota(m_relative2absolute.begin() + relativeLine, m_relative2absolute.begin() + relativeLine + linesCount, absoluteLine);
+    }
+
+    m_count += linesCount;
+    if (isAppend)
+    {
+        appendLinesVisibility(oldCount);
+        appendVisibles(oldCount);
+    }
+    else
+    {
+        invalidateLinesVisibility();
+        invalidateVisibles();
+    }
+
+    emit linesInserted(this, absoluteLine, linesCount);
+    emitLinesChanged(ChangeReasonLinesCount|ChangeReasonLinesCountWeak);
+
+    return true;
+}
+
+void Lines::appendVisibles(int oldCount)
+{
+    if (!isVisiblesBitwise())
+    {
+        if (m_absolute2visible.empty())
+        {
+            invalidateSizes();
+            return;
+        }
 
-        if (midSize < values.size() - (oldIndex + count))
+        // appended lines are last in relative order
+        m_absolute2visible.resize(m_count);
+        for (int line = oldCount; line < m_count; ++line)
         {
-            std::copy(values.begin() + oldIndex + count + midSize, values.end(), newValues.begin() + oldIndex + count + midSize);
+            if (isLineVisible(line))
+            {
+                m_absolute2visible[line] = m_visible2absolute.size();
+                m_visible2absolute.append(line);
+            }
+            else
+            {
+                m_absolute2visible[line] = InvalidIndex;
+            }
         }
-        index = oldIndex + midSize;
     }
 
-    values.swap(newValues);
+    if (m_visibleLinesTree.empty())
+        return;
 
-    return index;
+    // caches may switch to uniform or arithmetic sizes
+    if (isSizesUniform() || isSizesArithmetic())
+    {
+        invalidateSizes();
+        return;
+    }
+
+    for (int line = oldCount; line < m_count; ++line)
+    {
+        if (toVisible(line) != InvalidIndex)
+            treeAppend(lineSize(line));
+    }
+
+    Q_ASSERT(m_visibleLinesTree.size() == visibleCount() + 1);
+}
+
+bool Lines::removeLines(int absoluteLine, int linesCount)
+{
+    if (absoluteLine < 0 || linesCount <= 0 || absoluteLine + linesCount > m_count)
+        return false;
+
+    int oldCount = m_count;
+    int endLine = absoluteLine + linesCount;
+
+    if (m_linesSizeRuns.size() > 1)
+    {
+        int sizeAfter = (endLine < oldCount) ? lineSize(endLine) : DefaultLineSize;
+
+        QMap<int, int> runs;
+        for (auto it = m_linesSizeRuns.begin(); it != m_linesSizeRuns.end(); ++it)
+        {
+            if (it.key() < absoluteLine)
+                runs.insert(it.key(), it.value());
+            else if (it.key() >= endLine)
+                runs.insert(it.key() - linesCount, it.value());
+        }
+
+        // lines after removed ones keep their size
+        if (endLine < oldCount && !runs.contains(absoluteLine))
+            runs[absoluteLine] = sizeAfter;
+
+        compactSizeRuns(runs);
+        m_linesSizeRuns.swap(runs);
+    }
+
+    if (m_linesVisible.size() > 1)
+    {
+        m_linesVisible.remove(absoluteLine, linesCount);
+        if (m_linesVisible.empty())
+            m_linesVisible.resize(1, DefaultLineVisibility);
+    }
+
+    if (m_isIdentityPermutation)
+    {
+        m_relative2absolute.clear();
+    }
+    else
+    {
+        auto it = std::remove_if(m_relative2absolute.begin(), m_relative2absolute.end(), [absoluteLine, endLine](int line) {
+            return line >= absoluteLine && line < endLine;
+        });
+        m_relative2absolute.erase(it, m_relative2absolute.end());
+
+        for (auto& line : m_relative2absolute)
+        {
+            if (line >= endLine)
+                line -= linesCount;
+        }
+    }
+
+    m_count -= linesCount;
+    invalidateLinesVisibility();
+    invalidateVisibles();
+
+    emit linesRemoved(this, absoluteLine, linesCount);
+    emitLinesChanged(ChangeReasonLinesCount|ChangeReasonLinesCountWeak);
+
+    return true;
+}
+
+static int moveValues(QVector<int>& values, int oldIndex, int newIndex, int count)
+{
+    Q_ASSERT(oldIndex >= 0 && oldIndex < values.size());
+    Q_ASSERT(newIndex >= 0 && newIndex <= values.size());
+    Q_ASSERT(count > 0);
+
+    // rotate only affected span in place
+    if (newIndex < oldIndex)
+    {
+        std::rotate(values.begin() + newIndex, values.begin() + oldIndex, values.begin() + oldIndex + count);
+        return newIndex;
+    }
+    else // newLine > oldLine + lineCount
+    {
+        int midSize = qMin(newIndex - oldIndex, values.size() - (oldIndex + count));
+        std::rotate(values.begin() + oldIndex, values.begin() + oldIndex + count, values.begin() + oldIndex + count + midSize);
+        return oldIndex + midSize;
+    }
 }
 
 int Lines::moveLines(int oldAbsoluteLine, int newRelativeLine, int linesCount)
@@ -133,6 +719,8 @@ int Lines::moveLines(int oldAbsoluteLine, int newRelativeLine, int linesCount)
     if (oldAbsoluteLine >= count())
         return InvalidIndex;
 
+    validatePermutation();
+
     // convert absolute line to relative line
     int oldLine = (int)std::distance(m_relative2absolute.begin(), std::find(m_relative2absolute.begin(), m_relative2absolute.end(), oldAbsoluteLine));
     int newLine = newRelativeLine;
@@ -141,156 +729,403 @@ int Lines::moveLines(int oldAbsoluteLine, int newRelativeLine, int linesCount)
     if (((oldLine + linesCount) > count()) || (newLine > count()) || (newLine > oldLine && newLine < (oldLine + linesCount)))
         return InvalidIndex;
 
-    int index = moveValues(m_relative2absolute, oldLine, newLine, linesCount);
+    int index = moveValues(m_relative2absolute, oldLine, newLine, linesCount);
+
+    m_isIdentityPermutation = false;
+    invalidateVisibles();
+
+    emit linesMoved(this, oldLine, index, linesCount);
+    emitLinesChanged(ChangeReasonLinesOrder);
+
+    return index;
+}
+
+int Lines::moveVisibleLines(int oldLine, int newLine, int linesCount)
+{
+    Q_ASSERT(linesCount > 0);
+    // cannot perform moving
+    if (((oldLine + linesCount) > count()) || (newLine > count()) || (newLine > oldLine && newLine < (oldLine + linesCount)))
+        return InvalidIndex;
+
+    validatePermutation();
+
+    // convert visible lines to relative lines
+    oldLine = (int)std::distance(m_relative2absolute.begin(), std::find(m_relative2absolute.begin(), m_relative2absolute.end(), toAbsolute(oldLine)));
+    newLine = (int)std::distance(m_relative2absolute.begin(), std::find(m_relative2absolute.begin(), m_relative2absolute.end(), toAbsolute(newLine)));
+
+    int index = moveValues(m_relative2absolute, oldLine, newLine, linesCount);
+
+    m_isIdentityPermutation = false;
+    invalidateVisibles();
+
+    emit linesMoved(this, oldLine, index, linesCount);
+    emitLinesChanged(ChangeReasonLinesOrder);
+
+    return index;
+}
+
+int Lines::insertVisibleLines(int lineBefore, int linesCount)
+{
+    bool justAppend = lineBefore >= count();
+
+    // append keeping permutation
+    insertLines(count(), linesCount);
+
+    if (justAppend)
+    {
+        return visibleCount() - linesCount;
+    }
+    else
+    {
+        return moveVisibleLines(visibleCount() - linesCount, lineBefore, linesCount);
+    }
+}
+
+int Lines::findVisibleIDByPos(int position, bool noTailLine) const
+{
+    if (isEmptyVisible())
+        return InvalidIndex;
+
+    if (position <= 0)
+        return 0;
+
+    if (position > endPos(visibleCount() - 1))
+        return noTailLine ? visibleCount() - 1 : visibleCount();
+
+    return findVisibleIDByPosImpl(position, 0, visibleCount() - 1);
+}
+
+int Lines::findVisibleIDByPos(int position, int fromVisibleLine, int toVisibleLine) const
+{
+    Q_ASSERT(fromVisibleLine < m_count && toVisibleLine < m_count && fromVisibleLine <= toVisibleLine);
+
+    if (position < startPos(fromVisibleLine))
+        return InvalidIndex;
+    else if (position > endPos(toVisibleLine))
+        return InvalidIndex;
+    else
+        return findVisibleIDByPosImpl(position, fromVisibleLine, toVisibleLine);
+}
+
+void Lines::visibleRangeByPos(int position, int size, int& visibleStart, int& visibleEnd) const
+{
+    if (m_visibleRangeVersion != m_version || m_visibleRangePosition != position || m_visibleRangeSize != size)
+    {
+        m_visibleRangeStart = findVisibleIDByPos(position);
+        m_visibleRangeEnd = findVisibleIDByPos(position + size);
+        m_visibleRangePosition = position;
+        m_visibleRangeSize = size;
+        m_visibleRangeVersion = m_version;
+    }
+
+    visibleStart = m_visibleRangeStart;
+    visibleEnd = m_visibleRangeEnd;
+}
+
+int Lines::findVisibleIDByPosImpl(int position, int fromVisibleLine, int toVisibleLine) const
+{
+    Q_ASSERT(fromVisibleLine < m_count && toVisibleLine < m_count && fromVisibleLine <= toVisibleLine);
+
+    // line with start position not greater than position
+    int line = sizesLowerBound(position);
+    return qBound(fromVisibleLine, line, toVisibleLine);
+}
+
+int Lines::toAbsolute(int visibleLine) const
+{
+    Q_ASSERT(visibleLine >= 0 && visibleLine < visibleCount());
+
+    if (isVisiblesBitwise())
+        return (m_linesVisible.size() > 1) ? m_linesVisible.select(visibleLine) : visibleLine;
+
+    validateVisibles();
+    return m_visible2absolute.at(visibleLine);
+}
+
+int Lines::toVisible(int absoluteLine) const
+{
+    Q_ASSERT(absoluteLine >= 0 && absoluteLine < m_count);
+
+    if (isVisiblesBitwise())
+    {
+        if (!isLineVisibleRaw(absoluteLine))
+            return InvalidIndex;
+
+        return (m_linesVisible.size() > 1) ? m_linesVisible.rank(absoluteLine) : absoluteLine;
+    }
+
+    validateVisibles();
+    return m_absolute2visible.at(absoluteLine);
+}
+
+void Lines::validateVisibles() const
+{
+    if (isVisiblesBitwise() || !m_absolute2visible.empty())
+        return;
+
+    validateLinesVisibility();
+
+    m_visible2absolute.clear();
+    m_absolute2visible.fill(InvalidIndex, m_count);
+    for (int i = 0; i < m_count; ++i)
+    {
+        int absoluteLine = m_isIdentityPermutation ? i : m_relative2absolute.at(i);
+        if (m_linesVisibleCombined.value(absoluteLine))
+        {
+            m_visible2absolute.append(absoluteLine);
+            m_absolute2visible[absoluteLine] = m_visible2absolute.size() - 1;
+        }
+    }
+}
+
+void Lines::updateVisibles(const QVector<int>& lines)
+{
+    // nothing to patch
+    if (isVisiblesBitwise() || m_absolute2visible.empty())
+    {
+        invalidateSizes();
+        return;
+    }
+
+    if (lines.size() > IncrementalVisibilityLimit)
+    {
+        invalidateVisibles();
+        return;
+    }
+
+    for (auto line: lines)
+        updateVisible(line);
+}
+
+void Lines::updateVisible(int line)
+{
+    Q_ASSERT(!m_absolute2visible.empty());
+    Q_ASSERT(line >= 0 && line < m_count);
+
+    bool visible = isLineVisible(line);
+    int visibleLine = m_absolute2visible[line];
+
+    if (visible == (visibleLine != InvalidIndex))
+        return;
+
+    if (visible)
+    {
+        // find nearest visible line before line in relative order
+        int relativeLine = m_isIdentityPermutation ? line : m_relative2absolute.indexOf(line);
+        Q_ASSERT(relativeLine != -1);
+
+        visibleLine = 0;
+        for (int i = relativeLine - 1; i >= 0; --i)
+        {
+            int prevVisibleLine = m_absolute2visible[m_isIdentityPermutation ? i : m_relative2absolute[i]];
+            if (prevVisibleLine != InvalidIndex)
+            {
+                visibleLine = prevVisibleLine + 1;
+                break;
+            }
+        }
+
+        m_visible2absolute.insert(visibleLine, 1, line);
+    }
+    else
+    {
+        m_visible2absolute.remove(visibleLine);
+        m_absolute2visible[line] = InvalidIndex;
+    }
+
+    // renumber shifted lines
+    for (int i = visibleLine, n = m_visible2absolute.size(); i < n; ++i)
+        m_absolute2visible[m_visible2absolute[i]] = i;
+
+    // visible lines were shifted
+    invalidateSizes();
+}
+
+void Lines::validateSizes() const
+{
+    if (!m_visibleLinesTree.empty() || isSizesUniform() || isSizesArithmetic())
+        return;
+
+    QI_TRACE_SCOPE(TraceCategoryLines, "Lines::validateSizes");
 
-    invalidateVisibles();
+    validateVisibles();
 
-    emit linesChanged(this, ChangeReasonLinesOrder);
+    // build Fenwick tree in linear time
+    int n = visibleCount();
+    m_visibleLinesTree.fill(DefaultLineSize, n + 1);
+    m_visibleLinesTree[0] = 0;
 
-    return index;
+    for (auto it = m_linesSizeRuns.begin(); it != m_linesSizeRuns.end(); ++it)
+    {
+        auto itNext = it + 1;
+        int runEnd = (itNext == m_linesSizeRuns.end()) ? m_count : itNext.key();
+        for (int line = it.key(); line < runEnd; ++line)
+        {
+            int visibleLine = toVisible(line);
+            if (visibleLine != InvalidIndex)
+                m_visibleLinesTree[visibleLine + 1] = it.value();
+        }
+    }
+
+    for (int i = 1; i <= n; ++i)
+    {
+        int parent = i + (i & -i);
+        if (parent <= n)
+            m_visibleLinesTree[parent] += m_visibleLinesTree[i];
+    }
 }
 
-int Lines::moveVisibleLines(int oldLine, int newLine, int linesCount)
+int Lines::sizesPrefixSum(int visibleLinesCount) const
 {
-    Q_ASSERT(linesCount > 0);
-    // cannot perform moving
-    if (((oldLine + linesCount) > count()) || (newLine > count()) || (newLine > oldLine && newLine < (oldLine + linesCount)))
-        return InvalidIndex;
+    if (isSizesUniform())
+        return visibleLinesCount * uniformLineSize();
 
-    // convert visible lines to relative lines
-    oldLine = (int)std::distance(m_relative2absolute.begin(), std::find(m_relative2absolute.begin(), m_relative2absolute.end(), toAbsolute(oldLine)));
-    newLine = (int)std::distance(m_relative2absolute.begin(), std::find(m_relative2absolute.begin(), m_relative2absolute.end(), toAbsolute(newLine)));
+    if (isSizesArithmetic())
+        return runsPrefixSum(visibleLinesCount);
 
-    int index = moveValues(m_relative2absolute, oldLine, newLine, linesCount);
+    validateSizes();
+    return treePrefixSum(visibleLinesCount);
+}
 
-    invalidateVisibles();
+int Lines::sizesLowerBound(int position) const
+{
+    if (isSizesUniform())
+    {
+        int size = uniformLineSize();
+        return (size > 0) ? qBound(0, position / size, visibleCount()) : visibleCount();
+    }
 
-    emit linesChanged(this, ChangeReasonLinesOrder);
+    if (isSizesArithmetic())
+        return runsLowerBound(position);
 
-    return index;
+    validateSizes();
+    return treeLowerBound(position);
 }
 
-int Lines::insertVisibleLines(int lineBefore, int linesCount)
+int Lines::uniformLineSize() const
 {
-    bool justAppend = lineBefore >= count();
-
-    // append
-    setCount(count() + linesCount);
+    Q_ASSERT(isSizesUniform());
+    return m_linesSizeRuns.empty() ? DefaultLineSize : m_linesSizeRuns.first();
+}
 
-    if (justAppend)
-    {
-        return visibleCount() - linesCount;
-    }
-    else
-    {
-        return moveVisibleLines(visibleCount() - linesCount, lineBefore, linesCount);
-    }
+bool Lines::isSizesArithmetic() const
+{
+    return isVisiblesBitwise()
+            && m_linesVisible.size() <= 1 && (m_count == 0 || isLineVisibleRaw(0))
+            && m_linesSizeRuns.size() <= ArithmeticSizesLimit;
 }
 
-int Lines::findVisibleIDByPos(int position, bool noTailLine) const
+int Lines::runsPrefixSum(int linesCount) const
 {
-    if (isEmptyVisible())
-        return InvalidIndex;
+    Q_ASSERT(linesCount >= 0 && linesCount <= m_count);
+    return sizeRunsPrefixSum(m_linesSizeRuns, linesCount);
+}
 
-    if (position <= 0)
-        return 0;
+int Lines::runsLowerBound(int position) const
+{
+    return sizeRunsLowerBound(m_linesSizeRuns, m_count, position);
+}
 
-    if (position > endPos(visibleCount() - 1))
-        return noTailLine ? visibleCount() - 1 : visibleCount();
+int Lines::treePrefixSum(int visibleLinesCount) const
+{
+    if (!m_sizesIndex.empty())
+        return m_sizesIndex.key(visibleLinesCount);
 
-    validateSizes();
-    return findVisibleIDByPosImpl(position, 0, visibleCount() - 1);
+    countTreeQuery();
+    return fenwickPrefixSum(m_visibleLinesTree, visibleLinesCount);
 }
 
-int Lines::findVisibleIDByPos(int position, int fromVisibleLine, int toVisibleLine) const
+void Lines::treeAdd(int visibleLine, int delta) const
 {
-    Q_ASSERT(fromVisibleLine < m_count && toVisibleLine < m_count && fromVisibleLine <= toVisibleLine);
+    Q_ASSERT(visibleLine >= 0 && visibleLine + 1 < m_visibleLinesTree.size());
 
-    validateSizes();
+    invalidateSizesIndex();
 
-    if (position < m_visibleLinesSizes[fromVisibleLine])
-        return InvalidIndex;
-    else if (position > m_visibleLinesSizes[toVisibleLine + 1])
-        return InvalidIndex;
-    else
-        return findVisibleIDByPosImpl(position, fromVisibleLine, toVisibleLine);
+    for (int i = visibleLine + 1, n = m_visibleLinesTree.size(); i < n; i += (i & -i))
+        m_visibleLinesTree[i] += delta;
 }
 
-int Lines::findVisibleIDByPosImpl(int position, int fromVisibleLine, int toVisibleLine) const
+void Lines::treeAppend(int size) const
 {
-    Q_ASSERT(fromVisibleLine < m_count && toVisibleLine < m_count && fromVisibleLine <= toVisibleLine);
+    invalidateSizesIndex();
 
-    if (fromVisibleLine == toVisibleLine)
-    {
-        return fromVisibleLine;
-    }
-    else if ((toVisibleLine - fromVisibleLine) == 1)
-    {
-        if (position < m_visibleLinesSizes[toVisibleLine])
-            return fromVisibleLine;
-        else
-            return toVisibleLine;
-    }
+    // new node covers (i - lowbit(i), i] range of visible lines
+    int i = m_visibleLinesTree.size();
+    int lowBit = i & -i;
+    m_visibleLinesTree.append(size + fenwickPrefixSum(m_visibleLinesTree, i - 1) - fenwickPrefixSum(m_visibleLinesTree, i - lowBit));
+}
 
-    Q_ASSERT(position >= m_visibleLinesSizes[fromVisibleLine]);
+int Lines::treeLowerBound(int position) const
+{
+    if (!m_sizesIndex.empty())
+        return qMax(0, m_sizesIndex.upperBound(position) - 1);
 
-    int middleLine = (fromVisibleLine + toVisibleLine) / 2;
-    if (position < m_visibleLinesSizes[middleLine])
-    {
-        return findVisibleIDByPosImpl(position, fromVisibleLine, middleLine);
-    }
-    else
-    {
-        return findVisibleIDByPosImpl(position, middleLine, toVisibleLine);
-    }
+    countTreeQuery();
+    return fenwickLowerBound(m_visibleLinesTree, position);
 }
 
-void Lines::validateVisibles() const
+void Lines::countTreeQuery() const
 {
-    if (!m_absolute2visible.empty())
+    int n = m_visibleLinesTree.size() - 1;
+    if (!m_isSizesIndexEnabled || n < SizesIndexMinLines)
         return;
 
-    m_visible2absolute.clear();
-    m_absolute2visible.fill(InvalidIndex, m_relative2absolute.size());
-    for (int i = 0, count = m_relative2absolute.size(); i < count; ++i)
-    {
-        int absoluteLine = m_relative2absolute[i];
-        if (isLineVisible(absoluteLine))
-        {
-            m_visible2absolute.append(absoluteLine);
-            m_absolute2visible[absoluteLine] = m_visible2absolute.size() - 1;
-        }
-    }
+    if (++m_treeQueries >= n / SizesIndexQueriesRatio)
+        buildSizesIndex();
 }
 
-void Lines::validateSizes() const
+void Lines::buildSizesIndex() const
 {
-    if (!m_visibleLinesSizes.empty())
-        return;
-
-    validateVisibles();
+    QI_TRACE_SCOPE(TraceCategoryLines, "Lines::buildSizesIndex");
 
-    int size = 0;
-    m_visibleLinesSizes.resize(visibleCount() + 1);
+    // restore line sizes from the tree in linear time
+    QVector<int> starts = m_visibleLinesTree;
+    int n = starts.size() - 1;
+    for (int i = n; i > 0; --i)
+    {
+        int parent = i + (i & -i);
+        if (parent <= n)
+            starts[parent] -= starts[i];
+    }
 
-    for (int line = 0; line < m_visibleLinesSizes.size() - 1; ++line)
+    // starts[line] = start position of visible line, starts[n] = visible size
+    int sum = 0;
+    for (int i = 0; i <= n; ++i)
     {
-        m_visibleLinesSizes[line] = size;
-        size += lineSize(toAbsolute(line));
+        int size = (i < n) ? starts[i + 1] : 0;
+        starts[i] = sum;
+        sum += size;
     }
-    m_visibleLinesSizes.back() = size;
+
+    m_sizesIndex.build(starts);
 }
 
+void Lines::setSizesIndexEnabled(bool enabled)
+{
+    if (m_isSizesIndexEnabled == enabled)
+        return;
+
+    m_isSizesIndexEnabled = enabled;
+    invalidateSizesIndex();
+}
 
 void Lines::setLinesVisible(const QVector<int>& lines, bool visible)
 {
+    if (m_linesVisible.size() <= 1)
+    {
+        // make explicit copy of front
+        bool visibility = isLineVisibleRaw(0);
+        m_linesVisible.fill(visibility, m_count);
+    }
+
     for (auto line: lines)
     {
-        m_linesVisible[line] = visible;
+        m_linesVisible.setValue(line, visible);
+        updateLineVisibleCombined(line);
     }
 
-    invalidateVisibles();
-    emit linesChanged(this, ChangeReasonLinesVisibility);
+    updateVisibles(lines);
+    emitLinesChanged(ChangeReasonLinesVisibility);
 }
 
 void Lines::setLinesVisibleExact(const QVector<int>& lines, bool visible)
@@ -299,56 +1134,171 @@ void Lines::setLinesVisibleExact(const QVector<int>& lines, bool visible)
 
     for (auto line: lines)
     {
-        m_linesVisible[line] = visible;
+        m_linesVisible.setValue(line, visible);
     }
 
     invalidateVisibles();
-    emit linesChanged(this, ChangeReasonLinesVisibility);
+    emitLinesChanged(ChangeReasonLinesVisibility);
 }
 
 int Lines::lineSize(int line) const
 {
     Q_ASSERT(line < m_count);
-
-    if (m_linesSize.empty())
-        return DefaultLineSize;
-    else if (m_linesSize.size() == 1)
-        return m_linesSize.front();
-    else
-        return m_linesSize[line];
+    return sizeRunsValue(m_linesSizeRuns, line);
 }
 
 void Lines::setLineSize(int line, int size)
 {
-    Q_ASSERT(line < m_count);
+    if (!resizeLine(line, size))
+        return;
+
+    emit lineResized(this, line);
+    emitLinesChanged(ChangeReasonLinesSize);
+}
+
+void Lines::setLinesSizes(const QVector<int>& lines, const QVector<int>& sizes)
+{
+    Q_ASSERT(lines.size() == sizes.size());
+
+    bool isResized = false;
+    for (int i = 0; i < lines.size(); ++i)
+        isResized |= resizeLine(lines[i], sizes[i]);
+
+    if (isResized)
+        emitLinesChanged(ChangeReasonLinesSize);
+}
+
+bool Lines::resizeLine(int line, int size)
+{
+    Q_ASSERT(line >= 0 && line < m_count);
     Q_ASSERT(size >= 0);
 
-    if (m_linesSize.empty())
+    int oldSize = lineSize(line);
+    if (oldSize == size)
+        return false;
+
+    if (m_linesSizeRuns.empty())
+        m_linesSizeRuns[0] = DefaultLineSize;
+
+    // split run at line
+    if (line + 1 < m_count && !m_linesSizeRuns.contains(line + 1))
+        m_linesSizeRuns[line + 1] = oldSize;
+    m_linesSizeRuns[line] = size;
+
+    // merge with adjacent runs
+    auto itNext = m_linesSizeRuns.find(line + 1);
+    if (itNext != m_linesSizeRuns.end() && itNext.value() == size)
+        m_linesSizeRuns.erase(itNext);
+    if (line > 0 && lineSize(line - 1) == size)
+        m_linesSizeRuns.remove(line);
+
+    // update sizes cache incrementally
+    if (isSizesArithmetic())
     {
-        m_linesSize.fill(DefaultLineSize, m_count);
+        invalidateSizes();
     }
-    else if (m_linesSize.size() == 1)
+    else if (!m_visibleLinesTree.empty())
     {
-        // make explicit copy of front
-        int size = m_linesSize.front();
-        m_linesSize.fill(size, m_count);
+        int visibleLine = toVisible(line);
+        if (visibleLine != InvalidIndex)
+            treeAdd(visibleLine, size - oldSize);
     }
 
-    if (m_linesSize[line] != size)
-    {
-        m_linesSize[line] = size;
-        invalidateSizes();
-        emit linesChanged(this, ChangeReasonLinesSize);
-    }
+    return true;
 }
 
 void Lines::setLineSizeAll(int size)
 {
     Q_ASSERT(size >= 0);
-    m_linesSize.fill(size, 1);
+    m_linesSizeRuns.clear();
+    m_linesSizeRuns[0] = size;
+
+    invalidateSizes();
+    emitLinesChanged(ChangeReasonLinesSize);
+}
+
+void Lines::setLinesSize(int line, int linesCount, int size)
+{
+    Q_ASSERT(line >= 0 && linesCount >= 0 && line + linesCount <= m_count);
+    Q_ASSERT(size >= 0);
+
+    if (linesCount == 1)
+        setLineSize(line, size);
+    if (linesCount <= 1)
+        return;
+
+    if (m_linesSizeRuns.empty())
+        m_linesSizeRuns[0] = DefaultLineSize;
+
+    int end = line + linesCount;
 
+    // lines are within one run of the size already
+    auto itRun = m_linesSizeRuns.upperBound(line);
+    if (itRun == m_linesSizeRuns.end() || itRun.key() >= end)
+    {
+        if ((itRun - 1).value() == size)
+            return;
+    }
+
+    // replace runs of lines by one run
+    int sizeAfter = (end < m_count) ? lineSize(end) : size;
+    auto it = m_linesSizeRuns.lowerBound(line);
+    while (it != m_linesSizeRuns.end() && it.key() < end)
+        it = m_linesSizeRuns.erase(it);
+    m_linesSizeRuns[line] = size;
+    if (end < m_count && !m_linesSizeRuns.contains(end))
+        m_linesSizeRuns[end] = sizeAfter;
+
+    // merge with adjacent runs
+    auto itNext = m_linesSizeRuns.find(end);
+    if (itNext != m_linesSizeRuns.end() && itNext.value() == size)
+        m_linesSizeRuns.erase(itNext);
+    if (line > 0 && lineSize(line - 1) == size)
+        m_linesSizeRuns.remove(line);
+
+    // tree is rebuilt once on demand
     invalidateSizes();
-    emit linesChanged(this, ChangeReasonLinesSize);
+    emitLinesChanged(ChangeReasonLinesSize);
+}
+
+int Lines::visibleLinesCount(int line, int linesCount) const
+{
+    Q_ASSERT(line >= 0 && linesCount >= 0 && line + linesCount <= m_count);
+
+    if (!m_linesVisibility.empty())
+    {
+        validateLinesVisibility();
+        return m_linesVisibleCombined.rank(line + linesCount) - m_linesVisibleCombined.rank(line);
+    }
+
+    if (m_linesVisible.empty())
+        return DefaultLineVisibility ? linesCount : 0;
+    else if (m_linesVisible.size() == 1)
+        return m_linesVisible.front() ? linesCount : 0;
+    else
+        return m_linesVisible.rank(line + linesCount) - m_linesVisible.rank(line);
+}
+
+int Lines::visibleLinesSize(int line, int linesCount) const
+{
+    Q_ASSERT(line >= 0 && linesCount >= 0 && line + linesCount <= m_count);
+
+    if (isSizesUniform())
+        return uniformLineSize() * visibleLinesCount(line, linesCount);
+
+    int end = line + linesCount;
+    int size = 0;
+    auto it = m_linesSizeRuns.upperBound(line) - 1;
+    while (it != m_linesSizeRuns.end() && it.key() < end)
+    {
+        int runStart = qMax(it.key(), line);
+        int runSize = it.value();
+        ++it;
+        int runEnd = (it == m_linesSizeRuns.end()) ? end : qMin(it.key(), end);
+        size += runSize * visibleLinesCount(runStart, runEnd - runStart);
+    }
+
+    return size;
 }
 
 bool Lines::isLineVisibleRaw(int line) const
@@ -360,21 +1310,16 @@ bool Lines::isLineVisibleRaw(int line) const
     else if (m_linesVisible.size() == 1)
         return m_linesVisible.front();
     else
-        return m_linesVisible[line];
+        return m_linesVisible.value(line);
 }
 
 bool Lines::isLineVisible(int line) const
 {
-    if (!isLineVisibleRaw(line))
-        return false;
-
-    for (const auto& linesVisibility: m_linesVisibility)
-    {
-        if (!linesVisibility->isLineVisible(line))
-            return false;
-    }
+    if (m_linesVisibility.empty())
+        return isLineVisibleRaw(line);
 
-    return true;
+    validateLinesVisibility();
+    return m_linesVisibleCombined.value(line);
 }
 
 int Lines::isLinesVisibleAll() const
@@ -389,22 +1334,18 @@ int Lines::isLinesVisibleAll() const
     if (m_linesVisibility.empty())
     {
         const bool visibility = m_linesVisible.front();
-        for (auto it = m_linesVisible.begin()+1; it != m_linesVisible.end(); ++it)
-        {
-            if ((*it) != visibility)
-                return -1;
-        }
+        if (!m_linesVisible.isAll(visibility))
+            return -1;
 
         return visibility ? 1 : 0;
     }
     else
     {
-        const bool visibility = isLineVisible(0);
-        for (int line = 1, n = count(); line < n; ++line)
-        {
-            if (isLineVisible(line) != visibility)
-                return -1;
-        }
+        validateLinesVisibility();
+
+        const bool visibility = m_linesVisibleCombined.front();
+        if (!m_linesVisibleCombined.isAll(visibility))
+            return -1;
 
         return visibility ? 1 : 0;
     }
@@ -425,11 +1366,15 @@ void Lines::setLineVisible(int line, bool visible)
         m_linesVisible.fill(visibility, m_count);
     }
 
-    if (m_linesVisible[line] != visible)
+    if (m_linesVisible.value(line) != visible)
     {
-        m_linesVisible[line] = visible;
-        invalidateVisibles();
-        emit linesChanged(this, ChangeReasonLinesVisibility);
+        m_linesVisible.setValue(line, visible);
+        updateLineVisibleCombined(line);
+        if (isVisiblesBitwise())
+            invalidateSizes();
+        else if (!m_absolute2visible.empty())
+            updateVisible(line);
+        emitLinesChanged(ChangeReasonLinesVisibility);
     }
 }
 
@@ -438,7 +1383,7 @@ void Lines::setLineVisibleAll(bool visible)
     m_linesVisible.fill(visible, 1);
 
     invalidateVisibles();
-    emit linesChanged(this, ChangeReasonLinesVisibility);
+    emitLinesChanged(ChangeReasonLinesVisibility);
 }
 
 bool Lines::addLinesVisibility(SharedPtr<LinesVisibility> linesVisibility)
@@ -447,10 +1392,12 @@ bool Lines::addLinesVisibility(SharedPtr<LinesVisibility> linesVisibility)
         return false;
 
     connect(linesVisibility.data(), &LinesVisibility::visibilityChanged, this, &Lines::onLinesVisibilityChanged);
+    connect(linesVisibility.data(), &LinesVisibility::visibilityChangedPartial, this, &Lines::onLinesVisibilityChangedPartial);
     m_linesVisibility.append(std::move(linesVisibility));
+    m_linesVisibilityBits.append(BitVector());
 
     invalidateVisibles();
-    emit linesChanged(this, ChangeReasonLinesVisibility);
+    emitLinesChanged(ChangeReasonLinesVisibility);
 
     return true;
 }
@@ -461,11 +1408,13 @@ bool Lines::removeLinesVisibility(SharedPtr<LinesVisibility> linesVisibility)
     if (it == m_linesVisibility.end())
         return false;
 
+    m_linesVisibilityBits.remove(int(std::distance(m_linesVisibility.begin(), it)));
     m_linesVisibility.erase(it);
     disconnect(linesVisibility.data(), &LinesVisibility::visibilityChanged, this, &Lines::onLinesVisibilityChanged);
+    disconnect(linesVisibility.data(), &LinesVisibility::visibilityChangedPartial, this, &Lines::onLinesVisibilityChangedPartial);
 
     invalidateVisibles();
-    emit linesChanged(this, ChangeReasonLinesVisibility);
+    emitLinesChanged(ChangeReasonLinesVisibility);
 
     return true;
 }
@@ -475,49 +1424,226 @@ void Lines::clearLinesVisibility()
     for (const auto& linesVisibility: m_linesVisibility)
     {
         disconnect(linesVisibility.data(), &LinesVisibility::visibilityChanged, this, &Lines::onLinesVisibilityChanged);
+        disconnect(linesVisibility.data(), &LinesVisibility::visibilityChangedPartial, this, &Lines::onLinesVisibilityChangedPartial);
     }
     m_linesVisibility.clear();
+    m_linesVisibilityBits.clear();
 
     invalidateVisibles();
-    emit linesChanged(this, ChangeReasonLinesVisibility);
+    emitLinesChanged(ChangeReasonLinesVisibility);
+}
+
+void Lines::validateLinesVisibility() const
+{
+    Q_ASSERT(m_linesVisibilityBits.size() == m_linesVisibility.size());
+
+    if (m_linesVisibleCombined.size() == m_count)
+        return;
+
+    const int wordsCount = (m_count + 63) / 64;
+
+    QVector<quint64> words;
+    if (m_linesVisible.size() > 1)
+        words = m_linesVisible.words();
+    else
+        words.fill((m_count > 0 && isLineVisibleRaw(0)) ? ~quint64(0) : 0, wordsCount);
+
+    for (int i = 0, n = m_linesVisibility.size(); i < n; ++i)
+    {
+        BitVector& bits = m_linesVisibilityBits[i];
+        if (bits.size() != m_count)
+        {
+            const auto& linesVisibility = m_linesVisibility.at(i);
+            linesVisibility->validateLines(m_count);
+
+            QVector<quint64> visibilityWords(wordsCount, 0);
+            for (int line = 0; line < m_count; ++line)
+            {
+                if (linesVisibility->isLineVisible(line))
+                    visibilityWords[line >> 6] |= quint64(1) << (line & 63);
+            }
+            bits.assign(visibilityWords, m_count);
+        }
+
+        const auto& bitsWords = bits.words();
+        for (int word = 0; word < wordsCount; ++word)
+            words[word] &= bitsWords.at(word);
+    }
+
+    m_linesVisibleCombined.assign(words, m_count);
+}
+
+void Lines::invalidateLinesVisibility()
+{
+    for (auto& bits: m_linesVisibilityBits)
+        bits.clear();
+    m_linesVisibleCombined.clear();
+}
+
+void Lines::appendLinesVisibility(int oldCount)
+{
+    if (m_linesVisibility.empty())
+        return;
+
+    bool isCombinedValid = (m_linesVisibleCombined.size() == oldCount);
+    for (int i = 0, n = m_linesVisibility.size(); i < n; ++i)
+    {
+        BitVector& bits = m_linesVisibilityBits[i];
+        if (bits.size() != oldCount)
+        {
+            isCombinedValid = false;
+            continue;
+        }
+
+        const auto& linesVisibility = m_linesVisibility.at(i);
+        linesVisibility->validateLines(m_count);
+
+        bits.resize(m_count);
+        for (int line = oldCount; line < m_count; ++line)
+            bits.setValue(line, linesVisibility->isLineVisible(line));
+    }
+
+    if (!isCombinedValid)
+    {
+        m_linesVisibleCombined.clear();
+        return;
+    }
+
+    m_linesVisibleCombined.resize(m_count);
+    for (int line = oldCount; line < m_count; ++line)
+        updateLineVisibleCombined(line);
 }
 
-void Lines::onLinesVisibilityChanged(const LinesVisibility*)
+void Lines::updateLineVisibleCombined(int line)
 {
+    if (m_linesVisibleCombined.size() != m_count)
+        return;
+
+    bool visible = isLineVisibleRaw(line);
+    for (int i = 0, n = m_linesVisibilityBits.size(); visible && i < n; ++i)
+        visible = m_linesVisibilityBits.at(i).value(line);
+
+    m_linesVisibleCombined.setValue(line, visible);
+}
+
+void Lines::onLinesVisibilityChanged(const LinesVisibility* linesVisibility)
+{
+    // only changed visibility is evaluated again
+    for (int i = 0, n = m_linesVisibility.size(); i < n; ++i)
+    {
+        if (m_linesVisibility.at(i).data() == linesVisibility)
+            m_linesVisibilityBits[i].clear();
+    }
+
     invalidateVisibles();
-    emit linesChanged(this, ChangeReasonLinesVisibility);
+    emitLinesChanged(ChangeReasonLinesVisibility);
+}
+
+void Lines::onLinesVisibilityChangedPartial(const LinesVisibility* linesVisibility, const QVector<int>& lines)
+{
+    for (int i = 0, n = m_linesVisibility.size(); i < n; ++i)
+    {
+        BitVector& bits = m_linesVisibilityBits[i];
+        if (m_linesVisibility.at(i).data() != linesVisibility || bits.size() != m_count)
+            continue;
+
+        for (auto line: lines)
+            bits.setValue(line, linesVisibility->isLineVisible(line));
+    }
+
+    for (auto line: lines)
+        updateLineVisibleCombined(line);
+
+    updateVisibles(lines);
+    emitLinesChanged(ChangeReasonLinesVisibility);
 }
 
 int Lines::visibleCount() const
 {
+    if (isVisiblesBitwise())
+    {
+        if (m_linesVisible.size() > 1)
+            return m_linesVisible.count();
+        else
+            return (m_count > 0 && isLineVisibleRaw(0)) ? m_count : 0;
+    }
+
     validateVisibles();
     return m_visible2absolute.size();
 }
 
 int Lines::visibleSize() const
 {
-    validateSizes();
-    return m_visibleLinesSizes.back();
+    return sizesPrefixSum(visibleCount());
 }
 
 int Lines::startPos(int visibleLine) const
 {
-    validateSizes();
-    return m_visibleLinesSizes[visibleLine];
+    return sizesPrefixSum(visibleLine);
 }
 
 int Lines::endPos(int visibleLine) const
 {
-    validateSizes();
-    return m_visibleLinesSizes[visibleLine + 1];
+    return sizesPrefixSum(visibleLine + 1);
+}
+
+void Lines::validatePermutation() const
+{
+    if (!m_isIdentityPermutation || m_relative2absolute.size() == m_count)
+        return;
+
+    m_relative2absolute.resize(m_count);
+    std::iota(m_relative2absolute.begin(), m_relative2absolute.end(), 0);
 }
 
 void Lines::setPermutation(const QVector<int>& permutation)
 {
     Q_ASSERT(permutation.size() == count());
     m_relative2absolute = permutation;
+    m_isIdentityPermutation = false;
+    invalidateVisibles();
+    emitLinesChanged(ChangeReasonLinesOrder);
+}
+
+QVector<int> Lines::visibleRelativePositions() const
+{
+    validatePermutation();
+
+    QVector<int> positions;
+    positions.reserve(visibleCount());
+    for (int i = 0; i < m_relative2absolute.size(); ++i)
+    {
+        // visible lines map is validated once, filters are not called per line
+        if (toVisible(m_relative2absolute[i]) != InvalidIndex)
+            positions.append(i);
+    }
+
+    return positions;
+}
+
+QVector<int> Lines::permutationAt(const QVector<int>& positions) const
+{
+    validatePermutation();
+
+    QVector<int> lines;
+    lines.reserve(positions.size());
+    for (int position: positions)
+        lines.append(m_relative2absolute[position]);
+
+    return lines;
+}
+
+void Lines::setPermutationAt(const QVector<int>& positions, const QVector<int>& lines)
+{
+    Q_ASSERT(positions.size() == lines.size());
+    validatePermutation();
+
+    for (int i = 0; i < positions.size(); ++i)
+        m_relative2absolute[positions[i]] = lines[i];
+
+    m_isIdentityPermutation = false;
     invalidateVisibles();
-    emit linesChanged(this, ChangeReasonLinesOrder);
+    emitLinesChanged(ChangeReasonLinesOrder);
 }
 
 } // end namespace Qi
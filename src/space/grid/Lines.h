@@ -18,8 +18,13 @@
 #define QI_LINES_H
 
 #include "QiAPI.h"
+#include "utils/BitVector.h"
+#include "utils/BlockSearchIndex.h"
+#include "utils/ParallelSort.h"
+#include "utils/MemoryUsage.h"
 #include <QObject>
 #include <QVector>
+#include <QMap>
 #include <functional>
 
 namespace Qi
@@ -27,6 +32,63 @@ namespace Qi
 
 class LinesVisibility;
 
+// immutable copy of lines permutation, visibility and sizes
+// copies share data, so snapshot can be read from other threads
+// while the source Lines is changed in its own thread
+class QI_EXPORT LinesSnapshot
+{
+public:
+    LinesSnapshot();
+
+    int count() const { return m_count; }
+    int visibleCount() const { return m_visibleCount; }
+    int visibleSize() const { return sizesPrefixSum(m_visibleCount); }
+
+    bool isEmpty() const { return m_count == 0; }
+    bool isEmptyVisible() const { return m_visibleCount == 0; }
+
+    int lineSize(int line) const;
+    bool isLineVisible(int line) const { return toVisible(line) != InvalidIndex; }
+
+    int toAbsolute(int visibleLine) const;
+    int toVisible(int absoluteLine) const;
+
+    int toAbsoluteSafe(int visibleLine) const { return (visibleLine >= 0 && visibleLine < m_visibleCount) ? toAbsolute(visibleLine) : InvalidIndex; }
+    int toVisibleSafe(int absoluteLine) const { return (absoluteLine >= 0 && absoluteLine < m_count) ? toVisible(absoluteLine) : InvalidIndex; }
+
+    int findVisibleIDByPos(int position, bool noTailLine = true) const;
+
+    int startPos(int visibleLine) const { return sizesPrefixSum(visibleLine); }
+    int endPos(int visibleLine) const { return sizesPrefixSum(visibleLine + 1); }
+
+    // permutation[relativeID] == absoluteID
+    const QVector<int>& permutation() const { return m_relative2absolute; }
+
+private:
+    friend class Lines;
+
+    int sizesPrefixSum(int visibleLinesCount) const;
+
+    int m_count;
+    int m_visibleCount;
+
+    QVector<int> m_relative2absolute;
+
+    // visibility is kept as rank/select bits (see Lines::isVisiblesBitwise)
+    bool m_isVisiblesBitwise;
+    BitVector m_linesVisible;
+    QVector<int> m_visible2absolute;
+    QVector<int> m_absolute2visible;
+
+    // sizes are kept as uniform size, size runs or Fenwick tree
+    int m_uniformLineSize;
+    bool m_isSizesArithmetic;
+    QMap<int, int> m_linesSizeRuns;
+    QVector<int> m_visibleLinesTree;
+    // start positions index of the tree if it was built (see Lines::m_sizesIndex)
+    BlockSearchIndex m_sizesIndex;
+};
+
 class QI_EXPORT Lines: public QObject
 {
     Q_OBJECT
@@ -35,6 +97,19 @@ public:
     Lines(int count = 0);
 
     SharedPtr<Lines> clone() const;
+    // validates caches and makes snapshot of current state
+    // should be called from the thread of the lines
+    LinesSnapshot snapshot() const;
+
+    // containers shared with clones and snapshots are counted by each of them
+    MemoryUsage memoryUsage() const;
+
+    // binary state of count, sizes, visibility and permutation
+    // LinesVisibility filters are not saved, they are applied over restored state
+    QByteArray saveState() const;
+    // restores state of saveState by one linesChanged,
+    // returns false and keeps lines unchanged if state is invalid
+    bool restoreState(const QByteArray& state);
 
     int count() const { return m_count; }
     void setCount(int count);
@@ -48,6 +123,14 @@ public:
     int lineSize(int line) const;
     void setLineSize(int line, int size);
     void setLineSizeAll(int size);
+    // sets size of absolute lines [line, line + linesCount) as one size run
+    void setLinesSize(int line, int linesCount, int size);
+    // sets sizes[i] to absolute lines[i] and emits one linesChanged without lineResized
+    void setLinesSizes(const QVector<int>& lines, const QVector<int>& sizes);
+    // visible lines count and sizes sum over absolute lines [line, line + linesCount)
+    // costs are proportional to size runs in range if lines have no LinesVisibility
+    int visibleLinesCount(int line, int linesCount) const;
+    int visibleLinesSize(int line, int linesCount) const;
 
     bool isLineVisible(int line) const;
     // returns 0 - all invisible
@@ -64,41 +147,131 @@ public:
     bool removeLinesVisibility(SharedPtr<LinesVisibility> linesVisibility);
     void clearLinesVisibility();
 
+    // appends lines to the end keeping visible lines and sizes caches valid
+    // costs are proportional to linesCount, so frequent appends stay cheap
+    bool appendLines(int linesCount = 1) { return insertLines(m_count, linesCount); }
+    // inserts lines before absoluteLine, absolute lines after it are shifted
+    // new lines follow in relative order lines before shifted absoluteLine
+    bool insertLines(int absoluteLine, int linesCount = 1);
+    // removes lines keeping order and state of the rest lines
+    bool removeLines(int absoluteLine, int linesCount = 1);
+
     int moveLines(int oldAbsoluteLine, int newRelativeLine, int linesCount = 1);
     int moveVisibleLines(int oldLine, int newLine, int linesCount = 1);
     int insertVisibleLines(int lineBefore, int linesCount = 1);
 
-    int toAbsolute(int visibleLine) const { validateVisibles(); Q_ASSERT(visibleLine >= 0 && visibleLine < m_visible2absolute.size()); return m_visible2absolute[visibleLine]; }
-    int toVisible(int absoluteLine) const { validateVisibles(); Q_ASSERT(absoluteLine >= 0 && absoluteLine < m_absolute2visible.size()); return m_absolute2visible[absoluteLine]; }
+    int toAbsolute(int visibleLine) const;
+    int toVisible(int absoluteLine) const;
 
-    int toAbsoluteSafe(int visibleLine) const { validateVisibles(); return (visibleLine < m_visible2absolute.size()) ? m_visible2absolute[visibleLine] : InvalidIndex; }
-    int toVisibleSafe(int absoluteLine) const { validateVisibles(); return (absoluteLine < m_absolute2visible.size()) ? m_absolute2visible[absoluteLine] : InvalidIndex; }
+    int toAbsoluteSafe(int visibleLine) const { return (visibleLine >= 0 && visibleLine < visibleCount()) ? toAbsolute(visibleLine) : InvalidIndex; }
+    int toVisibleSafe(int absoluteLine) const { return (absoluteLine >= 0 && absoluteLine < m_count) ? toVisible(absoluteLine) : InvalidIndex; }
 
-    // see m_visibleLinesSizes for possible return values
+    // returns visible line which contains position (see m_visibleLinesTree)
     int findVisibleIDByPos(int position, bool noTailLine = true) const;
     int findVisibleIDByPos(int position, int fromVisibleLine, int toVisibleLine) const;
+    // visible lines which cover [position, position + size]
+    // last result is kept until lines are changed, so grids sharing lines look it up once
+    void visibleRangeByPos(int position, int size, int& visibleStart, int& visibleEnd) const;
 
     int startPos(int visibleLine) const;
     int endPos(int visibleLine) const;
 
+    // start positions index built after many position lookups without size changes,
+    // it costs one int per visible line and makes lookups cache friendly for big lines counts
+    bool isSizesIndexEnabled() const { return m_isSizesIndexEnabled; }
+    void setSizesIndexEnabled(bool enabled);
+
     // pred has less operator - bool operator() (int leftLine, int rightLine) const;
-    template <typename Pred> void sort(bool stable, const Pred& pred)
+    // parallel sorting is always stable and copies pred for each thread
+    template <typename Pred> void sort(bool stable, const Pred& pred, bool parallel = false)
     {
-        if (stable)
+        validatePermutation();
+
+        if (parallel)
+            parallelStableSort(m_relative2absolute.begin(), m_relative2absolute.end(), pred);
+        else if (stable)
             std::stable_sort(m_relative2absolute.begin(), m_relative2absolute.end(), pred);
         else
             std::sort(m_relative2absolute.begin(), m_relative2absolute.end(), pred);
 
+        m_isIdentityPermutation = false;
+        invalidateVisibles();
+        emitLinesChanged(ChangeReasonLinesOrder);
+    }
+
+    // moves first topCount lines of stable sorting to the top, rest lines follow in unspecified order
+    // shows first page of sorted lines quickly, full sorting should replace it later
+    template <typename Pred> void sortTop(int topCount, const Pred& pred)
+    {
+        validatePermutation();
+
+        topCount = qBound(0, topCount, m_relative2absolute.size());
+        if (topCount == 0)
+            return;
+
+        // equal lines are ordered by current position as stable sorting does
+        QVector<int> positions(m_count);
+        for (int i = 0; i < m_relative2absolute.size(); ++i)
+            positions[m_relative2absolute[i]] = i;
+
+        std::partial_sort(m_relative2absolute.begin(), m_relative2absolute.begin() + topCount, m_relative2absolute.end(),
+                          [&pred, &positions](int left, int right) {
+            if (pred(left, right))
+                return true;
+            if (pred(right, left))
+                return false;
+            return positions[left] < positions[right];
+        });
+
+        m_isIdentityPermutation = false;
         invalidateVisibles();
-        emit linesChanged(this, ChangeReasonLinesOrder);
+        emitLinesChanged(ChangeReasonLinesOrder);
+    }
+
+    // sorts visible lines between their relative positions, invisible lines keep their positions
+    // compares are proportional to visible lines count, so heavily filtered lines sort fast
+    template <typename Pred> void sortVisible(bool stable, const Pred& pred, bool parallel = false)
+    {
+        QVector<int> positions = visibleRelativePositions();
+        QVector<int> lines = permutationAt(positions);
+
+        if (parallel)
+            parallelStableSort(lines.begin(), lines.end(), pred);
+        else if (stable)
+            std::stable_sort(lines.begin(), lines.end(), pred);
+        else
+            std::sort(lines.begin(), lines.end(), pred);
+
+        setPermutationAt(positions, lines);
     }
 
     // permutation[relativeID] == absoluteID
-    const QVector<int>& permutation() const { return m_relative2absolute; }
+    const QVector<int>& permutation() const { validatePermutation(); return m_relative2absolute; }
     void setPermutation(const QVector<int>& permutation);
 
+    // ascending relative positions of visible lines
+    QVector<int> visibleRelativePositions() const;
+    // absolute lines at relative positions
+    QVector<int> permutationAt(const QVector<int>& positions) const;
+    // places absolute lines to relative positions,
+    // lines should be reordered permutationAt(positions)
+    void setPermutationAt(const QVector<int>& positions, const QVector<int>& lines);
+
+    // incremented before each linesChanged, caches over lines are valid while it's the same
+    quint64 version() const { return m_version; }
+
 signals:
     void linesChanged(const Lines*, ChangeReason);
+    // linesCount relative lines from oldLine were moved to newLine
+    // emitted before linesChanged with ChangeReasonLinesOrder
+    void linesMoved(const Lines*, int oldLine, int newLine, int linesCount);
+    // linesCount absolute lines were inserted before or removed from absoluteLine
+    // emitted before linesChanged with ChangeReasonLinesCount
+    void linesInserted(const Lines*, int absoluteLine, int linesCount);
+    void linesRemoved(const Lines*, int absoluteLine, int linesCount);
+    // size of one absolute line was changed by setLineSize
+    // emitted before linesChanged with ChangeReasonLinesSize
+    void lineResized(const Lines*, int absoluteLine);
 
 private:
     Lines(const Lines& lines);
@@ -106,44 +279,129 @@ private:
 
     bool isLineVisibleRaw(int line) const;
 
+    void emitLinesChanged(ChangeReason reason) { ++m_version; emit linesChanged(this, reason); }
+
+    // materializes identity permutation
+    void validatePermutation() const;
+
+    // visible lines are calculated by rank/select over m_linesVisible
+    // without m_visible2absolute and m_absolute2visible maps
+    bool isVisiblesBitwise() const { return m_isIdentityPermutation && m_linesVisibility.empty(); }
+
     int findVisibleIDByPosImpl(int position, int fromVisibleLine, int toVisibleLine) const;
 
-    void invalidateVisibles() { m_visible2absolute.clear(); m_absolute2visible.clear(); invalidateSizes(); }
+    void invalidateVisibles() { m_visible2absolute.clear(); m_absolute2visible.clear(); m_linesVisibleCombined.clear(); invalidateSizes(); }
     void validateVisibles() const;
+    // patches visible lines caches for changed lines or invalidates them
+    void updateVisibles(const QVector<int>& lines);
+    void updateVisible(int line);
+    // patches visible lines caches for lines appended after oldCount
+    void appendVisibles(int oldCount);
+
+    // updates size runs and sizes cache without signals, returns false if size is the same
+    bool resizeLine(int line, int size);
 
-    void invalidateSizes() { m_visibleLinesSizes.clear(); }
+    void invalidateSizes() { m_visibleLinesTree.clear(); invalidateSizesIndex(); }
     void validateSizes() const;
 
+    void invalidateSizesIndex() const { m_sizesIndex.clear(); m_treeQueries = 0; }
+    // counts tree lookup and builds m_sizesIndex when lookups outweigh its building
+    void countTreeQuery() const;
+    void buildSizesIndex() const;
+
+    // sum of sizes of first visibleLinesCount visible lines
+    int sizesPrefixSum(int visibleLinesCount) const;
+    // returns greatest visible lines count which prefix sum is not greater than position
+    int sizesLowerBound(int position) const;
+
+    // all lines have the same size, so positions are calculated as
+    // visible lines count * size for any permutation and visibility
+    bool isSizesUniform() const { return m_linesSizeRuns.size() <= 1; }
+    int uniformLineSize() const;
+
+    // all lines are visible in natural order and there are few size runs,
+    // so positions are calculated over m_linesSizeRuns without m_visibleLinesTree
+    bool isSizesArithmetic() const;
+    int runsPrefixSum(int linesCount) const;
+    int runsLowerBound(int position) const;
+
+    // Fenwick tree helpers over visible line sizes
+    int treePrefixSum(int visibleLinesCount) const;
+    // adds delta to size of visibleLine
+    void treeAdd(int visibleLine, int delta) const;
+    // adds size of new last visible line
+    void treeAppend(int size) const;
+    int treeLowerBound(int position) const;
+
+    // evaluates invalid LinesVisibility bits and ANDs them with own visibility
+    void validateLinesVisibility() const;
+    // LinesVisibility bits are dropped when absolute lines are shifted
+    void invalidateLinesVisibility();
+    // evaluates LinesVisibility for lines appended after oldCount
+    void appendLinesVisibility(int oldCount);
+    // patches combined visibility of changed line if it is valid
+    void updateLineVisibleCombined(int line);
+
     void onLinesVisibilityChanged(const LinesVisibility*);
+    void onLinesVisibilityChangedPartial(const LinesVisibility*, const QVector<int>& lines);
+
+    // containers below are implicitly shared with clones and snapshots,
+    // const methods read mutable caches by at() to not detach them
 
     // lines count
     int m_count;
+    quint64 m_version;
 
-    // lines sizes
-    // m_linesSize.empty - all lines has DEFAULT_LINE_SIZE size
-    // m_linesSize.size() == 1 - all lines has size m_linesSize[0]
-    QVector<int> m_linesSize;
+    // lines sizes (run-length encoded)
+    // m_linesSizeRuns.empty - all lines has DEFAULT_LINE_SIZE size
+    // m_linesSizeRuns[line] = size of lines from line up to the next run
+    // m_linesSizeRuns always contains run for line 0 if not empty
+    QMap<int, int> m_linesSizeRuns;
     // lines visible
     // m_linesVisible.empty - all lines has DEFAULT_LINE_VISIBILITY visibility
     // m_linesVisible.size() == 1 - all lines has m_linesVisible[0] visibility
-    QVector<bool> m_linesVisible;
+    BitVector m_linesVisible;
 
     // lines permutation (m_indices[relativeLine] = absoluteLine)
+    // m_relative2absolute.empty - identity permutation is not materialized yet
     mutable QVector<int> m_relative2absolute;
+    // m_relative2absolute[line] == line
+    bool m_isIdentityPermutation;
+    // m_visible2absolute and m_absolute2visible are not used if isVisiblesBitwise()
     // m_visible2absolute[visible line] = absolute line
     mutable QVector<int> m_visible2absolute;
     // m_absolute2visible[absolute line] = { visible line | INVALID_INDEX }
     mutable QVector<int> m_absolute2visible;
 
     // cache for line sizes
-    // m_visibleLinesSizes[line] - start position of the visible line
-    // m_visibleLinesSizes[visibleLineCount] - end position of the last visible line
-    mutable QVector<int> m_visibleLinesSizes;
+    // Fenwick (binary indexed) tree over visible line sizes
+    // m_visibleLinesTree.size() == visibleLineCount + 1, m_visibleLinesTree[0] is unused
+    // start position of the visible line is treePrefixSum(line)
+    // m_visibleLinesTree.empty - cache is invalid, isSizesUniform() or isSizesArithmetic()
+    mutable QVector<int> m_visibleLinesTree;
+    // start positions of visible lines (m_sizesIndex.key(line) == treePrefixSum(line))
+    // m_sizesIndex.empty - index is not built, it is dropped by any tree change
+    mutable BlockSearchIndex m_sizesIndex;
+    // tree lookups since the last tree change
+    mutable int m_treeQueries;
+    bool m_isSizesIndexEnabled;
+
+    // last visibleRangeByPos call, valid while m_visibleRangeVersion == m_version
+    mutable quint64 m_visibleRangeVersion;
+    mutable int m_visibleRangePosition;
+    mutable int m_visibleRangeSize;
+    mutable int m_visibleRangeStart;
+    mutable int m_visibleRangeEnd;
 
     //
     // lines visibility stuff
     //
     QVector<SharedPtr<LinesVisibility>> m_linesVisibility;
+    // m_linesVisibilityBits[i] - cached visibility of lines by m_linesVisibility[i]
+    // bits are valid if size() == m_count, so only changed LinesVisibility is re-evaluated
+    mutable QVector<BitVector> m_linesVisibilityBits;
+    // m_linesVisible AND all m_linesVisibilityBits, valid if size() == m_count
+    mutable BitVector m_linesVisibleCombined;
 };
 
 // interface for handle line visible state
@@ -156,14 +414,19 @@ public:
     virtual ~LinesVisibility() {}
 
     bool isLineVisible(int line) const { return isLineVisibleImpl(line); }
+    // called before visibility of all lines is requested one by one
+    void validateLines(int linesCount) const { validateLinesImpl(linesCount); }
 
 signals:
     void visibilityChanged(const LinesVisibility* visibility);
+    // emit if visibility was changed only for some lines
+    void visibilityChangedPartial(const LinesVisibility* visibility, const QVector<int>& lines);
 
 protected:
     LinesVisibility() {}
 
     virtual bool isLineVisibleImpl(int line) const = 0;
+    virtual void validateLinesImpl(int /*linesCount*/) const {}
 };
 
 class QI_EXPORT LinesVisibilityCallback: public LinesVisibility
@@ -0,0 +1,145 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "LinesTree.h"
+
+namespace Qi
+{
+
+LinesTree::LinesTree(SharedPtr<Lines> rows, ChildrenCountCallback childrenCount, ChildCallback child)
+    : m_rows(std::move(rows)),
+      m_childrenCount(std::move(childrenCount)),
+      m_child(std::move(child))
+{
+    Q_ASSERT(m_rows);
+    Q_ASSERT(m_childrenCount);
+    Q_ASSERT(m_child);
+
+    reset();
+}
+
+LinesTree::~LinesTree()
+{
+}
+
+void LinesTree::reset()
+{
+    m_nodes.clear();
+    m_depths.clear();
+    collectChildren(InvalidIndex, 0, m_nodes, m_depths);
+
+    m_rows->setCount(m_nodes.size());
+}
+
+int LinesTree::parentRow(int row) const
+{
+    int rowDepth = depth(row);
+    for (int i = row - 1; i >= 0; --i)
+    {
+        if (m_depths[i] < rowDepth)
+            return i;
+    }
+
+    return InvalidIndex;
+}
+
+bool LinesTree::hasChildren(int row) const
+{
+    if (row < 0 || row >= m_nodes.size())
+        return false;
+
+    return m_childrenCount(m_nodes[row]) > 0;
+}
+
+bool LinesTree::expand(int row)
+{
+    if (isExpanded(row) || !hasChildren(row))
+        return false;
+
+    int node = m_nodes[row];
+    m_expandedNodes.insert(node);
+
+    QVector<int> nodes;
+    QVector<int> depths;
+    collectChildren(node, m_depths[row] + 1, nodes, depths);
+
+    // nodes are known before listeners of lines are notified
+    int firstRow = row + 1;
+    m_nodes.insert(firstRow, nodes.size(), InvalidIndex);
+    std::copy(nodes.begin(), nodes.end(), m_nodes.begin() + firstRow);
+    m_depths.insert(firstRow, depths.size(), 0);
+    std::copy(depths.begin(), depths.end(), m_depths.begin() + firstRow);
+
+    if (!nodes.isEmpty())
+        m_rows->insertLines(firstRow, nodes.size());
+
+    emit expandedChanged(this, row, true);
+    return true;
+}
+
+bool LinesTree::collapse(int row)
+{
+    if (!isExpanded(row))
+        return false;
+
+    // expanded descendants stay expanded to be restored with the row
+    m_expandedNodes.remove(m_nodes[row]);
+
+    int firstRow = row + 1;
+    int rowsCount = subtreeEnd(row) - firstRow;
+    m_nodes.remove(firstRow, rowsCount);
+    m_depths.remove(firstRow, rowsCount);
+
+    if (rowsCount > 0)
+        m_rows->removeLines(firstRow, rowsCount);
+
+    emit expandedChanged(this, row, false);
+    return true;
+}
+
+void LinesTree::collapseAll()
+{
+    if (m_expandedNodes.isEmpty())
+        return;
+
+    m_expandedNodes.clear();
+    reset();
+}
+
+int LinesTree::subtreeEnd(int row) const
+{
+    int rowDepth = m_depths[row];
+    int end = row + 1;
+    while (end < m_depths.size() && m_depths[end] > rowDepth)
+        ++end;
+    return end;
+}
+
+void LinesTree::collectChildren(int node, int depth, QVector<int>& nodes, QVector<int>& depths) const
+{
+    for (int i = 0, n = m_childrenCount(node); i < n; ++i)
+    {
+        int child = m_child(node, i);
+        nodes.append(child);
+        depths.append(depth);
+
+        if (m_expandedNodes.contains(child))
+            collectChildren(child, depth + 1, nodes, depths);
+    }
+}
+
+} // end namespace Qi
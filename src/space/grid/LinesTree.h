@@ -0,0 +1,84 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_LINES_TREE_H
+#define QI_LINES_TREE_H
+
+#include "Lines.h"
+#include <QSet>
+
+namespace Qi
+{
+
+// tree of nodes laid out as lines, children of collapsed nodes
+// are not queried and have no lines, so collapsed subtree takes one line
+// expanding or collapsing node inserts or removes lines of its subtree only
+// tree is laid out in absolute order of lines, so rows should not be sorted
+class QI_EXPORT LinesTree: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(LinesTree)
+
+public:
+    // returns count of node children, node is InvalidIndex for top level nodes
+    typedef std::function<int(int node)> ChildrenCountCallback;
+    // returns child node by its index
+    typedef std::function<int(int node, int index)> ChildCallback;
+
+    LinesTree(SharedPtr<Lines> rows, ChildrenCountCallback childrenCount, ChildCallback child);
+    ~LinesTree();
+
+    const SharedPtr<Lines>& rows() const { return m_rows; }
+
+    // rebuilds all lines, expanded nodes stay expanded
+    void reset();
+
+    int node(int row) const { return m_nodes.value(row, InvalidIndex); }
+    int depth(int row) const { return m_depths.value(row, InvalidIndex); }
+    int parentRow(int row) const;
+    // returns row of the node if it has line or InvalidIndex
+    int findRow(int node) const { return m_nodes.indexOf(node); }
+
+    bool hasChildren(int row) const;
+    bool isExpanded(int row) const { return m_expandedNodes.contains(node(row)); }
+    bool expand(int row);
+    bool collapse(int row);
+    bool toggle(int row) { return isExpanded(row) ? collapse(row) : expand(row); }
+    void collapseAll();
+
+signals:
+    void expandedChanged(const LinesTree* tree, int row, bool isExpanded);
+
+private:
+    // first row after subtree of the row
+    int subtreeEnd(int row) const;
+    // collects children of the node and children of expanded descendants
+    void collectChildren(int node, int depth, QVector<int>& nodes, QVector<int>& depths) const;
+
+    SharedPtr<Lines> m_rows;
+    ChildrenCountCallback m_childrenCount;
+    ChildCallback m_child;
+
+    // node and depth of each row
+    QVector<int> m_nodes;
+    QVector<int> m_depths;
+    QSet<int> m_expandedNodes;
+};
+
+} // end namespace Qi
+
+#endif // QI_LINES_TREE_H
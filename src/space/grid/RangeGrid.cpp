@@ -19,6 +19,26 @@
 namespace Qi
 {
 
+void RangeGrid::hasItemsImpl(const ID* ids, bool* results, int count) const
+{
+    // convert ids by blocks to make one virtual call per block
+    const int blockSize = 256;
+    GridID gridIds[blockSize];
+    for (int first = 0; first < count; first += blockSize)
+    {
+        int n = qMin(blockSize, count - first);
+        for (int i = 0; i < n; ++i)
+            gridIds[i] = ids[first + i].as<GridID>();
+        hasItemsImpl(gridIds, results + first, n);
+    }
+}
+
+void RangeGrid::hasItemsImpl(const GridID* ids, bool* results, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        results[i] = hasItemImpl(ids[i]);
+}
+
 RangeGridColumn::RangeGridColumn(int column)
     : m_column(column)
 {
@@ -29,7 +49,7 @@ void RangeGridColumn::setColumn(int column)
     if (column != m_column)
     {
         m_column = column;
-        emit rangeChanged(this, ChangeReasonRange);
+        emitRangeChanged(ChangeReasonRange);
     }
 }
 
@@ -38,6 +58,12 @@ bool RangeGridColumn::hasItemImpl(GridID id) const
     return id.column == m_column;
 }
 
+void RangeGridColumn::hasItemsImpl(const GridID* ids, bool* results, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        results[i] = ids[i].column == m_column;
+}
+
 SharedPtr<RangeGridColumn> makeRangeGridColumn(int column)
 {
     return makeShared<RangeGridColumn>(column);
@@ -60,7 +86,7 @@ void RangeGridColumns::setColumns(QSet<int> columns)
     if (m_columns != columns)
     {
         m_columns = std::move(columns);
-        emit rangeChanged(this, ChangeReasonRange);
+        emitRangeChanged(ChangeReasonRange);
     }
 }
 
@@ -69,6 +95,12 @@ bool RangeGridColumns::hasItemImpl(GridID id) const
     return m_columns.contains(id.column);
 }
 
+void RangeGridColumns::hasItemsImpl(const GridID* ids, bool* results, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        results[i] = m_columns.contains(ids[i].column);
+}
+
 SharedPtr<RangeGridColumns> makeRangeGridColumns(const QSet<int>& columns)
 {
     return makeShared<RangeGridColumns>(columns);
@@ -89,7 +121,7 @@ void RangeGridRow::setRow(int row)
     if (row != m_row)
     {
         m_row = row;
-        emit rangeChanged(this, ChangeReasonRange);
+        emitRangeChanged(ChangeReasonRange);
     }
 }
 
@@ -98,6 +130,12 @@ bool RangeGridRow::hasItemImpl(GridID id) const
     return id.row == m_row;
 }
 
+void RangeGridRow::hasItemsImpl(const GridID* ids, bool* results, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        results[i] = ids[i].row == m_row;
+}
+
 SharedPtr<RangeGridRow> makeRangeGridRow(int row)
 {
     return makeShared<RangeGridRow>(row);
@@ -120,7 +158,7 @@ void RangeGridRows::setRows(QSet<int> rows)
     if (m_rows != rows)
     {
         m_rows = std::move(rows);
-        emit rangeChanged(this, ChangeReasonRange);
+        emitRangeChanged(ChangeReasonRange);
     }
 }
 
@@ -129,6 +167,12 @@ bool RangeGridRows::hasItemImpl(GridID id) const
     return m_rows.contains(id.row);
 }
 
+void RangeGridRows::hasItemsImpl(const GridID* ids, bool* results, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        results[i] = m_rows.contains(ids[i].row);
+}
+
 SharedPtr<RangeGridRows> makeRangeGridRows(const QSet<int>& rows)
 {
     return makeShared<RangeGridRows>(rows);
@@ -139,6 +183,27 @@ SharedPtr<RangeGridRows> makeRangeGridRows(int rowBegin, int rowEnd)
     return makeShared<RangeGridRows>(rowBegin, rowEnd);
 }
 
+RangeGridRowsBitmap::RangeGridRowsBitmap(SparseBitVector rows)
+    : m_rows(std::move(rows))
+{
+}
+
+bool RangeGridRowsBitmap::hasItemImpl(GridID id) const
+{
+    return id.row >= 0 && m_rows.value(id.row);
+}
+
+void RangeGridRowsBitmap::hasItemsImpl(const GridID* ids, bool* results, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        results[i] = ids[i].row >= 0 && m_rows.value(ids[i].row);
+}
+
+SharedPtr<RangeGridRowsBitmap> makeRangeGridRowsBitmap(SparseBitVector rows)
+{
+    return makeShared<RangeGridRowsBitmap>(std::move(rows));
+}
+
 RangeGridRect::RangeGridRect(const QSet<int>& rows, const QSet<int>& columns)
     : m_rows(rows),
       m_columns(columns)
@@ -162,7 +227,7 @@ void RangeGridRect::setRows(QSet<int> rows)
     if (m_rows != rows)
     {
         m_rows = std::move(rows);
-        emit rangeChanged(this, ChangeReasonRange);
+        emitRangeChanged(ChangeReasonRange);
     }
 }
 
@@ -171,7 +236,7 @@ void RangeGridRect::setColumns(QSet<int> columns)
     if (m_columns != columns)
     {
         m_columns = std::move(columns);
-        emit rangeChanged(this, ChangeReasonRange);
+        emitRangeChanged(ChangeReasonRange);
     }
 }
 
@@ -180,6 +245,12 @@ bool RangeGridRect::hasItemImpl(GridID id) const
      return m_rows.contains(id.row) && m_columns.contains(id.column);
 }
 
+void RangeGridRect::hasItemsImpl(const GridID* ids, bool* results, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        results[i] = m_rows.contains(ids[i].row) && m_columns.contains(ids[i].column);
+}
+
 SharedPtr<RangeGridRect> makeRangeGridRect(const QSet<int>& rows, const QSet<int>& columns)
 {
     return makeShared<RangeGridRect>(rows, columns);
@@ -190,4 +261,73 @@ SharedPtr<RangeGridRect> makeRangeGridRect(int rowBegin, int rowEnd, int columnB
     return makeShared<RangeGridRect>(rowBegin, rowEnd, columnBegin, columnEnd);
 }
 
+RangeGridLinesCallback::RangeGridLinesCallback(bool isRows, std::function<bool(int)> hasLineCallback)
+    : m_isRows(isRows),
+      m_hasLineCallback(std::move(hasLineCallback))
+{
+}
+
+bool RangeGridLinesCallback::hasLine(int line) const
+{
+    if (line < 0)
+        return false;
+
+    if (line < m_isEvaluated.size() && m_isEvaluated.value(line))
+        return m_values.value(line);
+
+    return evaluate(line);
+}
+
+void RangeGridLinesCallback::setHasLineCallback(std::function<bool(int)> hasLineCallback)
+{
+    m_hasLineCallback = std::move(hasLineCallback);
+    invalidate();
+}
+
+void RangeGridLinesCallback::invalidate()
+{
+    m_values.clear();
+    m_isEvaluated.clear();
+    emitRangeChanged(ChangeReasonRange);
+}
+
+void RangeGridLinesCallback::invalidateLine(int line)
+{
+    if (line >= 0 && line < m_isEvaluated.size())
+        m_isEvaluated.setValue(line, false);
+    emitRangeChanged(ChangeReasonRange);
+}
+
+void RangeGridLinesCallback::hasItemsImpl(const GridID* ids, bool* results, int count) const
+{
+    for (int i = 0; i < count; ++i)
+        results[i] = hasLine(m_isRows ? ids[i].row : ids[i].column);
+}
+
+bool RangeGridLinesCallback::evaluate(int line) const
+{
+    if (line >= m_isEvaluated.size())
+    {
+        // grow by doubling to keep resizes rare
+        int size = qMax(line + 1, m_isEvaluated.size() * 2);
+        m_values.resize(size);
+        m_isEvaluated.resize(size);
+    }
+
+    bool value = m_hasLineCallback ? m_hasLineCallback(line) : false;
+    m_values.setValue(line, value);
+    m_isEvaluated.setValue(line, true);
+    return value;
+}
+
+SharedPtr<RangeGridLinesCallback> makeRangeGridRowsCallback(std::function<bool(int)> hasRowCallback)
+{
+    return makeShared<RangeGridLinesCallback>(true, std::move(hasRowCallback));
+}
+
+SharedPtr<RangeGridLinesCallback> makeRangeGridColumnsCallback(std::function<bool(int)> hasColumnCallback)
+{
+    return makeShared<RangeGridLinesCallback>(false, std::move(hasColumnCallback));
+}
+
 } // end namespace Qi
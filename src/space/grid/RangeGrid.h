@@ -20,6 +20,8 @@
 #include "core/Range.h"
 #include "GridID.h"
 #include "Lines.h"
+#include "utils/SparseBitVector.h"
+#include "utils/BitVector.h"
 
 namespace Qi
 {
@@ -31,12 +33,17 @@ class QI_EXPORT RangeGrid: public Range
 public:
     bool hasItem(GridID id) const { return hasItemImpl(id); }
     bool hasItem(int row, int column) const { return hasItem(GridID(row, column)); }
+    // batch version of hasItem without virtual call per item
+    void hasItems(const GridID* ids, bool* results, int count) const { hasItemsImpl(ids, results, count); }
 
 protected:
     RangeGrid() = default;
 
     bool hasItemImpl(ID id) const final { return hasItem(id.as<GridID>()); }
+    void hasItemsImpl(const ID* ids, bool* results, int count) const final;
     virtual bool hasItemImpl(GridID id) const = 0;
+    // calls hasItemImpl for each item by default
+    virtual void hasItemsImpl(const GridID* ids, bool* results, int count) const;
 };
 
 class QI_EXPORT RangeGridCallback: public RangeGrid
@@ -53,6 +60,11 @@ public:
 
 protected:
     bool hasItemImpl(GridID id) const final { return hasItemCallback ? hasItemCallback(id) : false; }
+    void hasItemsImpl(const GridID* ids, bool* results, int count) const final
+    {
+        for (int i = 0; i < count; ++i)
+            results[i] = hasItemCallback ? hasItemCallback(ids[i]) : false;
+    }
 };
 
 class QI_EXPORT RangeGridColumn: public RangeGrid
@@ -67,6 +79,8 @@ public:
 
 protected:
     bool hasItemImpl(GridID id) const override;
+    void hasItemsImpl(const GridID* ids, bool* results, int count) const override;
+    int uniformityImpl() const override { return RangeUniformByColumn; }
 
 private:
     int m_column;
@@ -86,6 +100,8 @@ public:
 
 protected:
     bool hasItemImpl(GridID id) const override;
+    void hasItemsImpl(const GridID* ids, bool* results, int count) const override;
+    int uniformityImpl() const override { return RangeUniformByColumn; }
 
 private:
     QSet<int> m_columns;
@@ -105,6 +121,8 @@ public:
 
 protected:
     bool hasItemImpl(GridID id) const override;
+    void hasItemsImpl(const GridID* ids, bool* results, int count) const override;
+    int uniformityImpl() const override { return RangeUniformByRow; }
 
 private:
     int m_row;
@@ -124,12 +142,33 @@ public:
 
 protected:
     bool hasItemImpl(GridID id) const override;
+    void hasItemsImpl(const GridID* ids, bool* results, int count) const override;
+    int uniformityImpl() const override { return RangeUniformByRow; }
 private:
     QSet<int> m_rows;
 };
 QI_EXPORT SharedPtr<RangeGridRows> makeRangeGridRows(const QSet<int>& rows);
 QI_EXPORT SharedPtr<RangeGridRows> makeRangeGridRows(int rowBegin, int rowEnd);
 
+class QI_EXPORT RangeGridRowsBitmap: public RangeGrid
+{
+    Q_OBJECT
+
+public:
+    explicit RangeGridRowsBitmap(SparseBitVector rows);
+
+    const SparseBitVector& rows() const { return m_rows; }
+
+protected:
+    bool hasItemImpl(GridID id) const override;
+    void hasItemsImpl(const GridID* ids, bool* results, int count) const override;
+    int uniformityImpl() const override { return RangeUniformByRow; }
+
+private:
+    SparseBitVector m_rows;
+};
+QI_EXPORT SharedPtr<RangeGridRowsBitmap> makeRangeGridRowsBitmap(SparseBitVector rows);
+
 class QI_EXPORT RangeGridRect: public RangeGrid
 {
     Q_OBJECT
@@ -146,6 +185,7 @@ public:
 
 protected:
     bool hasItemImpl(GridID id) const override;
+    void hasItemsImpl(const GridID* ids, bool* results, int count) const override;
 
 private:
     QSet<int> m_rows;
@@ -154,6 +194,38 @@ private:
 QI_EXPORT SharedPtr<RangeGridRect> makeRangeGridRect(const QSet<int>& rows, const QSet<int>& columns);
 QI_EXPORT SharedPtr<RangeGridRect> makeRangeGridRect(int rowBegin, int rowEnd, int columnBegin, int columnEnd);
 
+// callback of a row or column is evaluated once and its result is kept in bitmap
+// callback should depend on the line only, invalidate forgets kept results
+class QI_EXPORT RangeGridLinesCallback: public RangeGrid
+{
+    Q_OBJECT
+
+public:
+    RangeGridLinesCallback(bool isRows, std::function<bool(int)> hasLineCallback);
+
+    bool isRows() const { return m_isRows; }
+    bool hasLine(int line) const;
+
+    void setHasLineCallback(std::function<bool(int)> hasLineCallback);
+    void invalidate();
+    void invalidateLine(int line);
+
+protected:
+    bool hasItemImpl(GridID id) const override { return hasLine(m_isRows ? id.row : id.column); }
+    void hasItemsImpl(const GridID* ids, bool* results, int count) const override;
+    int uniformityImpl() const override { return m_isRows ? RangeUniformByRow : RangeUniformByColumn; }
+
+private:
+    bool evaluate(int line) const;
+
+    bool m_isRows;
+    std::function<bool(int)> m_hasLineCallback;
+    mutable BitVector m_values;
+    mutable BitVector m_isEvaluated;
+};
+QI_EXPORT SharedPtr<RangeGridLinesCallback> makeRangeGridRowsCallback(std::function<bool(int)> hasRowCallback);
+QI_EXPORT SharedPtr<RangeGridLinesCallback> makeRangeGridColumnsCallback(std::function<bool(int)> hasColumnCallback);
+
 } // end namespace Qi 
 
 #endif // QI_RANGE_GRID_H
@@ -0,0 +1,411 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "RowsGrouping.h"
+#include <algorithm>
+#include <numeric>
+
+namespace Qi
+{
+
+RowsGrouping::RowsGrouping(SharedPtr<Lines> rows, SharedPtr<ModelComparable> keyModel, int keyColumn, int dataRowsCount)
+    : m_keyModel(std::move(keyModel)),
+      m_keyColumn(keyColumn),
+      m_dataRowsCount(dataRowsCount),
+      m_keysUpdated(false),
+      m_tree(std::move(rows), [this](int node) { return childrenCount(node); }, [this](int node, int index) { return child(node, index); })
+{
+    Q_ASSERT(m_keyModel);
+    Q_ASSERT(m_dataRowsCount >= 0);
+
+    connect(m_keyModel.data(), &Model::modelChanged, this, &RowsGrouping::onKeyModelChanged);
+    connect(m_keyModel.data(), &Model::modelItemChanged, this, &RowsGrouping::onKeyModelItemChanged);
+    connect(m_keyModel.data(), &Model::modelItemsChanged, this, &RowsGrouping::onKeyModelItemsChanged);
+
+    regroup();
+}
+
+RowsGrouping::~RowsGrouping()
+{
+    disconnect(m_keyModel.data(), &Model::modelChanged, this, &RowsGrouping::onKeyModelChanged);
+    disconnect(m_keyModel.data(), &Model::modelItemChanged, this, &RowsGrouping::onKeyModelItemChanged);
+    disconnect(m_keyModel.data(), &Model::modelItemsChanged, this, &RowsGrouping::onKeyModelItemsChanged);
+
+    for (auto connection : m_connections)
+        disconnect(connection);
+}
+
+void RowsGrouping::setDataRowsCount(int dataRowsCount)
+{
+    Q_ASSERT(dataRowsCount >= 0);
+    if (m_dataRowsCount == dataRowsCount)
+        return;
+
+    m_dataRowsCount = dataRowsCount;
+    regroup();
+}
+
+double RowsGrouping::aggregate(int group, int aggregateIndex, AggregateType type) const
+{
+    const auto& theGroup = m_groups[group];
+    if (theGroup.dataRows.isEmpty())
+        return 0.;
+
+    const auto& value = theGroup.aggregates[aggregateIndex];
+    switch (type)
+    {
+    case AggregateSum:
+        return value.sum;
+    case AggregateMin:
+        return value.min;
+    case AggregateMax:
+        return value.max;
+    }
+
+    Q_ASSERT(false);
+    return 0.;
+}
+
+int RowsGrouping::dataRow(int row) const
+{
+    int node = m_tree.node(row);
+    return node >= 0 ? node : InvalidIndex;
+}
+
+int RowsGrouping::groupOfRow(int row) const
+{
+    int node = m_tree.node(row);
+    if (isGroupNode(node))
+        return groupNode(node);
+
+    return m_dataRowGroups.value(node, InvalidIndex);
+}
+
+void RowsGrouping::regroup()
+{
+    m_groups.clear();
+    m_order.clear();
+    m_dataRowGroups.fill(InvalidIndex, m_dataRowsCount);
+
+    for (auto& source : m_sources)
+    {
+        source.values.resize(m_dataRowsCount);
+        for (int dataRow = 0; dataRow < m_dataRowsCount; ++dataRow)
+            source.values[dataRow] = source.value(dataRow);
+    }
+
+    // equal keys become adjacent, stable sort keeps data order inside groups
+    // ordinal keys are counting sorted in O(N + K)
+    QVector<int> dataRows(m_dataRowsCount);
+    std::iota(dataRows.begin(), dataRows.end(), 0);
+    if (!m_keyModel->sortLines(dataRows, [this](int dataRow) { return ID(GridID(dataRow, m_keyColumn)); }, true))
+    {
+        std::stable_sort(dataRows.begin(), dataRows.end(), [this](int left, int right) {
+            return compareKeys(left, right) < 0;
+        });
+    }
+
+    for (int i = 0; i < dataRows.size(); ++i)
+    {
+        int dataRow = dataRows[i];
+        if (i == 0 || compareKeys(dataRows[i - 1], dataRow) != 0)
+        {
+            m_order.append(m_groups.size());
+            m_groups.append(Group());
+            m_groups.last().aggregates.resize(m_sources.size());
+        }
+
+        m_groups.last().dataRows.append(dataRow);
+        m_dataRowGroups[dataRow] = m_groups.size() - 1;
+        addToAggregates(m_groups.size() - 1, dataRow);
+    }
+
+    relayout();
+}
+
+int RowsGrouping::addAggregateImpl(SharedPtr<Model> model, int column, std::function<double(int)> value)
+{
+    int index = m_sources.size();
+
+    Source source;
+    source.model = model;
+    source.value = std::move(value);
+    source.column = column;
+    source.itemsUpdated = false;
+    m_sources.append(source);
+
+    m_connections.append(connect(model.data(), &Model::modelItemChanged, this, [this, index](const Model*, ID id) {
+        updateValues(index, QVector<ID>(1, id));
+    }));
+    m_connections.append(connect(model.data(), &Model::modelItemsChanged, this, [this, index](const Model*, const QVector<ID>& ids) {
+        updateValues(index, ids);
+    }));
+    m_connections.append(connect(model.data(), &Model::modelChanged, this, [this, index](const Model*) {
+        // aggregates were updated by item signals
+        if (m_sources[index].itemsUpdated)
+        {
+            m_sources[index].itemsUpdated = false;
+            return;
+        }
+
+        reloadValues(index);
+    }));
+
+    for (auto& group : m_groups)
+        group.aggregates.append(AggregateValue());
+    reloadValues(index);
+
+    return index;
+}
+
+void RowsGrouping::onKeyModelChanged(const Model*)
+{
+    // groups were updated by item signals
+    if (m_keysUpdated)
+    {
+        m_keysUpdated = false;
+        return;
+    }
+
+    regroup();
+}
+
+void RowsGrouping::onKeyModelItemChanged(const Model*, ID id)
+{
+    updateKeys(QVector<ID>(1, id));
+}
+
+void RowsGrouping::onKeyModelItemsChanged(const Model*, const QVector<ID>& ids)
+{
+    updateKeys(ids);
+}
+
+void RowsGrouping::updateKeys(const QVector<ID>& ids)
+{
+    m_keysUpdated = true;
+
+    bool isChanged = false;
+    for (const auto& item : ids)
+    {
+        const auto& id = item.as<GridID>();
+        if (id.column == m_keyColumn && id.row >= 0 && id.row < m_dataRowsCount)
+            isChanged |= updateKey(id.row);
+    }
+
+    if (isChanged)
+        relayout();
+}
+
+bool RowsGrouping::updateKey(int dataRow)
+{
+    int oldGroup = m_dataRowGroups[dataRow];
+    auto& oldRows = m_groups[oldGroup].dataRows;
+
+    if (oldRows.size() > 1)
+    {
+        // row keeps the key of its group
+        int otherRow = oldRows.first() != dataRow ? oldRows.first() : oldRows[1];
+        if (compareKeys(dataRow, otherRow) == 0)
+            return false;
+    }
+    else
+    {
+        // key of single row group has changed in place
+        int position = m_order.indexOf(oldGroup);
+        bool isAfterPrev = position == 0 || compareKeys(m_groups[m_order[position - 1]].dataRows.first(), dataRow) < 0;
+        bool isBeforeNext = position == m_order.size() - 1 || compareKeys(dataRow, m_groups[m_order[position + 1]].dataRows.first()) < 0;
+        if (isAfterPrev && isBeforeNext)
+            return false;
+    }
+
+    oldRows.erase(std::lower_bound(oldRows.begin(), oldRows.end(), dataRow));
+    if (oldRows.isEmpty())
+        m_order.removeOne(oldGroup);
+    else
+        removeFromAggregates(oldGroup, dataRow);
+
+    auto it = std::lower_bound(m_order.begin(), m_order.end(), dataRow, [this](int group, int row) {
+        return compareKeys(m_groups[group].dataRows.first(), row) < 0;
+    });
+
+    int newGroup = InvalidIndex;
+    if (it != m_order.end() && compareKeys(m_groups[*it].dataRows.first(), dataRow) == 0)
+    {
+        newGroup = *it;
+    }
+    else
+    {
+        newGroup = m_groups.size();
+        m_order.insert(it - m_order.begin(), newGroup);
+        m_groups.append(Group());
+        m_groups.last().aggregates.resize(m_sources.size());
+    }
+
+    auto& newRows = m_groups[newGroup].dataRows;
+    newRows.insert(std::lower_bound(newRows.begin(), newRows.end(), dataRow), dataRow);
+    m_dataRowGroups[dataRow] = newGroup;
+    addToAggregates(newGroup, dataRow);
+
+    return true;
+}
+
+void RowsGrouping::updateValues(int sourceIndex, const QVector<ID>& ids)
+{
+    auto& source = m_sources[sourceIndex];
+    source.itemsUpdated = true;
+
+    QVector<int> changedGroups;
+    for (const auto& item : ids)
+    {
+        const auto& id = item.as<GridID>();
+        if (id.column != source.column || id.row < 0 || id.row >= m_dataRowsCount)
+            continue;
+
+        double oldValue = source.values[id.row];
+        double newValue = source.value(id.row);
+        if (oldValue == newValue)
+            continue;
+
+        source.values[id.row] = newValue;
+
+        int group = m_dataRowGroups[id.row];
+        auto& value = m_groups[group].aggregates[sourceIndex];
+        value.sum += newValue - oldValue;
+        if ((oldValue == value.min && newValue > oldValue) || (oldValue == value.max && newValue < oldValue))
+        {
+            recalculateMinMax(group, sourceIndex);
+        }
+        else
+        {
+            value.min = qMin(value.min, newValue);
+            value.max = qMax(value.max, newValue);
+        }
+
+        if (!changedGroups.contains(group))
+            changedGroups.append(group);
+    }
+
+    for (int group : changedGroups)
+        emit aggregatesChanged(this, group);
+}
+
+void RowsGrouping::reloadValues(int sourceIndex)
+{
+    auto& source = m_sources[sourceIndex];
+    source.values.resize(m_dataRowsCount);
+    for (int dataRow = 0; dataRow < m_dataRowsCount; ++dataRow)
+        source.values[dataRow] = source.value(dataRow);
+
+    for (int group : m_order)
+    {
+        auto& value = m_groups[group].aggregates[sourceIndex];
+        value.sum = 0.;
+        for (int dataRow : m_groups[group].dataRows)
+            value.sum += source.values[dataRow];
+        recalculateMinMax(group, sourceIndex);
+
+        emit aggregatesChanged(this, group);
+    }
+}
+
+int RowsGrouping::compareKeys(int dataRowLeft, int dataRowRight) const
+{
+    return m_keyModel->compare(ID(GridID(dataRowLeft, m_keyColumn)), ID(GridID(dataRowRight, m_keyColumn)));
+}
+
+void RowsGrouping::addToAggregates(int group, int dataRow)
+{
+    auto& theGroup = m_groups[group];
+    bool isFirst = theGroup.dataRows.size() == 1;
+
+    for (int i = 0; i < m_sources.size(); ++i)
+    {
+        double newValue = m_sources[i].values[dataRow];
+        auto& value = theGroup.aggregates[i];
+        if (isFirst)
+        {
+            value.sum = newValue;
+            value.min = newValue;
+            value.max = newValue;
+        }
+        else
+        {
+            value.sum += newValue;
+            value.min = qMin(value.min, newValue);
+            value.max = qMax(value.max, newValue);
+        }
+    }
+}
+
+void RowsGrouping::removeFromAggregates(int group, int dataRow)
+{
+    for (int i = 0; i < m_sources.size(); ++i)
+    {
+        double oldValue = m_sources[i].values[dataRow];
+        auto& value = m_groups[group].aggregates[i];
+        value.sum -= oldValue;
+        // min or max goes away with the row
+        if (oldValue <= value.min || oldValue >= value.max)
+            recalculateMinMax(group, i);
+    }
+}
+
+void RowsGrouping::recalculateMinMax(int group, int sourceIndex)
+{
+    const auto& values = m_sources[sourceIndex].values;
+    const auto& dataRows = m_groups[group].dataRows;
+    auto& value = m_groups[group].aggregates[sourceIndex];
+    if (dataRows.isEmpty())
+        return;
+
+    value.min = values[dataRows.first()];
+    value.max = value.min;
+    for (int dataRow : dataRows)
+    {
+        value.min = qMin(value.min, values[dataRow]);
+        value.max = qMax(value.max, values[dataRow]);
+    }
+}
+
+void RowsGrouping::relayout()
+{
+    // expanded groups stay expanded
+    m_tree.reset();
+    emit groupsChanged(this);
+}
+
+int RowsGrouping::childrenCount(int node) const
+{
+    if (node == InvalidIndex)
+        return m_order.size();
+
+    if (isGroupNode(node))
+        return m_groups[groupNode(node)].dataRows.size();
+
+    return 0;
+}
+
+int RowsGrouping::child(int node, int index) const
+{
+    if (node == InvalidIndex)
+        return groupNode(m_order[index]);
+
+    Q_ASSERT(isGroupNode(node));
+    return m_groups[groupNode(node)].dataRows[index];
+}
+
+} // end namespace Qi
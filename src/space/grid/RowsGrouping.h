@@ -0,0 +1,165 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_ROWS_GROUPING_H
+#define QI_ROWS_GROUPING_H
+
+#include "LinesTree.h"
+#include "GridID.h"
+#include "core/ext/ModelTyped.h"
+
+namespace Qi
+{
+
+// groups data rows by values of key model and lays out groups as tree
+// each group has header row, rows of expanded groups follow their header
+// groups are ordered by key, rows of a group keep data order
+// count, sum, min and max of groups are updated for changed items
+class QI_EXPORT RowsGrouping: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(RowsGrouping)
+
+public:
+    enum AggregateType
+    {
+        AggregateSum,
+        AggregateMin,
+        AggregateMax
+    };
+
+    // rows are lines of grouped grid, data rows are rows of key model
+    RowsGrouping(SharedPtr<Lines> rows, SharedPtr<ModelComparable> keyModel, int keyColumn, int dataRowsCount = 0);
+    ~RowsGrouping();
+
+    const SharedPtr<Lines>& rows() const { return m_tree.rows(); }
+    const SharedPtr<ModelComparable>& keyModel() const { return m_keyModel; }
+    int keyColumn() const { return m_keyColumn; }
+
+    int dataRowsCount() const { return m_dataRowsCount; }
+    void setDataRowsCount(int dataRowsCount);
+
+    // expands and collapses groups
+    LinesTree& tree() { return m_tree; }
+    const LinesTree& tree() const { return m_tree; }
+
+    // aggregates values of the model column, returns index of aggregate
+    template <typename T>
+    int addAggregate(const SharedPtr<ModelTyped<T>>& model, int column)
+    {
+        Q_ASSERT(model);
+        return addAggregateImpl(model, column, [model, column](int dataRow) {
+            return double(model->value(ID(GridID(dataRow, column))));
+        });
+    }
+    int aggregatesCount() const { return m_sources.size(); }
+
+    // group ids ordered by key
+    const QVector<int>& groups() const { return m_order; }
+    // sorted data rows of the group
+    const QVector<int>& groupDataRows(int group) const { return m_groups[group].dataRows; }
+    int groupDataRowsCount(int group) const { return m_groups[group].dataRows.size(); }
+    double aggregate(int group, int aggregateIndex, AggregateType type) const;
+
+    // maps rows of grouped grid
+    bool isGroupRow(int row) const { return isGroupNode(m_tree.node(row)); }
+    // returns data row or InvalidIndex for group header
+    int dataRow(int row) const;
+    // returns group of header or data row
+    int groupOfRow(int row) const;
+    // returns header row of the group
+    int groupRow(int group) const { return m_tree.findRow(groupNode(group)); }
+
+    // regroups all data rows
+    void regroup();
+
+signals:
+    // groups or their rows have changed
+    void groupsChanged(const RowsGrouping* grouping);
+    void aggregatesChanged(const RowsGrouping* grouping, int group);
+
+private:
+    struct AggregateValue
+    {
+        double sum;
+        double min;
+        double max;
+    };
+
+    struct Group
+    {
+        QVector<int> dataRows;
+        QVector<AggregateValue> aggregates;
+    };
+
+    struct Source
+    {
+        SharedPtr<Model> model;
+        std::function<double(int)> value;
+        int column;
+        // values of data rows included in aggregates
+        QVector<double> values;
+        // items were reported before modelChanged
+        bool itemsUpdated;
+    };
+
+    // data rows are nodes of the tree, groups are negative nodes
+    // groupNode converts group to node and node back to group
+    static int groupNode(int group) { return -2 - group; }
+    static bool isGroupNode(int node) { return node <= -2; }
+
+    int addAggregateImpl(SharedPtr<Model> model, int column, std::function<double(int)> value);
+
+    void onKeyModelChanged(const Model*);
+    void onKeyModelItemChanged(const Model*, ID id);
+    void onKeyModelItemsChanged(const Model*, const QVector<ID>& ids);
+    void updateKeys(const QVector<ID>& ids);
+    // moves data row to the group of its new key
+    bool updateKey(int dataRow);
+    void updateValues(int sourceIndex, const QVector<ID>& ids);
+    void reloadValues(int sourceIndex);
+
+    int compareKeys(int dataRowLeft, int dataRowRight) const;
+    void addToAggregates(int group, int dataRow);
+    void removeFromAggregates(int group, int dataRow);
+    void recalculateMinMax(int group, int sourceIndex);
+    void relayout();
+
+    int childrenCount(int node) const;
+    int child(int node, int index) const;
+
+    SharedPtr<ModelComparable> m_keyModel;
+    int m_keyColumn;
+    int m_dataRowsCount;
+
+    // groups are never reused, so expanded state of removed group is not inherited
+    QVector<Group> m_groups;
+    QVector<int> m_order;
+    QVector<int> m_dataRowGroups;
+
+    QVector<Source> m_sources;
+    QVector<QMetaObject::Connection> m_connections;
+
+    // items were reported before modelChanged
+    bool m_keysUpdated;
+
+    LinesTree m_tree;
+};
+
+} // end namespace Qi
+
+#endif // QI_ROWS_GROUPING_H
@@ -18,6 +18,7 @@
 #include "RangeGrid.h"
 #include "core/Model.h"
 #include "cache/CacheItemFactory.h"
+#include "utils/Trace.h"
 
 namespace Qi
 {
@@ -48,6 +49,55 @@ SharedPtr<Range> makeRangeGridRect(const SpaceGrid& grid, GridID displayCorner1,
     return makeRangeGridRect(rows, columns);
 }
 
+int IdIteratorGrid::fetchIdsImpl(ID* ids, int count)
+{
+    GridID gridIds[BatchSize];
+
+    int fetched = 0;
+    while (fetched < count)
+    {
+        int n = fetchGridIdsImpl(gridIds, qMin<int>(BatchSize, count - fetched));
+        if (n == 0)
+            break;
+
+        for (int i = 0; i < n; ++i)
+            ids[fetched + i] = ID(gridIds[i]);
+        fetched += n;
+    }
+
+    return fetched;
+}
+
+int IdIteratorGrid::fetchGridIdsImpl(GridID* ids, int count)
+{
+    int fetched = 0;
+    for (; fetched < count && isValidImpl(); toNextImpl())
+        ids[fetched++] = gridIdImpl();
+    return fetched;
+}
+
+bool IdIteratorGrid::fetchColumnSpanImpl(GridColumnSpan& span)
+{
+    GridID id = gridIdImpl();
+    if (!id.isValid())
+        return false;
+
+    span.column = id.column;
+    span.firstRow = id.row;
+    span.rowsCount = 1;
+
+    while (toNextImpl())
+    {
+        id = gridIdImpl();
+        if (id.column != span.column || id.row != span.firstRow + span.rowsCount)
+            break;
+
+        ++span.rowsCount;
+    }
+
+    return true;
+}
+
 IdIteratorGridAll::IdIteratorGridAll(const SpaceGrid& spaceGrid)
     : m_spaceGrid(spaceGrid)
 {
@@ -83,6 +133,30 @@ bool IdIteratorGridAll::toNextImpl()
     return false;
 }
 
+int IdIteratorGridAll::fetchGridIdsImpl(GridID* ids, int count)
+{
+    if (!m_currentItem.isValid())
+        return 0;
+
+    int rowsCount = m_spaceGrid.rowsCount();
+    int columnsCount = m_spaceGrid.columnsCount();
+
+    int fetched = 0;
+    while (fetched < count && m_currentItem.row < rowsCount)
+    {
+        ids[fetched++] = m_currentItem;
+        if (++m_currentItem.column == columnsCount)
+        {
+            m_currentItem.column = 0;
+            ++m_currentItem.row;
+        }
+    }
+
+    if (m_currentItem.row >= rowsCount)
+        m_currentItem = GridID();
+
+    return fetched;
+}
 
 ItemsIteratorGridVisible::ItemsIteratorGridVisible(const SpaceGrid& spaceGrid)
     : m_spaceGrid(spaceGrid)
@@ -159,6 +233,36 @@ bool ItemsIteratorGridByColumn::toNextImpl()
     return false;
 }
 
+int ItemsIteratorGridByColumn::fetchGridIdsImpl(GridID* ids, int count)
+{
+    if (!m_currentItem.isValid())
+        return 0;
+
+    int fetched = qMin(count, m_rows.count() - m_currentItem.row);
+    for (int i = 0; i < fetched; ++i)
+        ids[i] = GridID(m_currentItem.row + i, m_currentItem.column);
+
+    m_currentItem.row += fetched;
+    if (m_currentItem.row >= m_rows.count())
+        m_currentItem.row = InvalidIndex;
+
+    return fetched;
+}
+
+bool ItemsIteratorGridByColumn::fetchColumnSpanImpl(GridColumnSpan& span)
+{
+    if (!m_currentItem.isValid())
+        return false;
+
+    // all rest rows of the column
+    span.column = m_currentItem.column;
+    span.firstRow = m_currentItem.row;
+    span.rowsCount = m_rows.count() - m_currentItem.row;
+
+    m_currentItem.row = InvalidIndex;
+    return true;
+}
+
 class AscendingColumnComparatorByModel
 {
 public:
@@ -250,7 +354,9 @@ private:
 SpaceGrid::SpaceGrid(SpaceGridHint hint)
     : m_rows(new Lines()),
       m_columns(new Lines()),
-      m_hint(hint)
+      m_hint(hint),
+      m_isLinesShifted(false),
+      m_isLineResized(false)
 {
     connectLines(m_rows);
     connectLines(m_columns);
@@ -259,7 +365,9 @@ SpaceGrid::SpaceGrid(SpaceGridHint hint)
 SpaceGrid::SpaceGrid(SharedPtr<Lines> rows, SharedPtr<Lines> columns, SpaceGridHint hint)
     : m_rows(rows),
       m_columns(columns),
-      m_hint(hint)
+      m_hint(hint),
+      m_isLinesShifted(false),
+      m_isLineResized(false)
 {
     connectLines(m_rows);
     connectLines(m_columns);
@@ -321,6 +429,60 @@ QRect SpaceGrid::itemRect(ID visibleItem) const
     return rect;
 }
 
+// start positions of visible lines [first, last + 1]
+static QVector<int> linesStarts(const Lines& lines, int first, int last)
+{
+    QVector<int> starts(last - first + 2);
+    for (int i = 0; i < starts.size(); ++i)
+        starts[i] = lines.startPos(first + i);
+    return starts;
+}
+
+QVector<QRect> SpaceGrid::itemRects(const QVector<ID>& visibleItems) const
+{
+    if (visibleItems.isEmpty())
+        return QVector<QRect>();
+
+    GridID idStart = visibleItems.front().as<GridID>();
+    GridID idEnd = idStart;
+    for (ID visibleItem : visibleItems)
+    {
+        const auto& id = visibleItem.as<GridID>();
+        Q_ASSERT(id.isValid());
+        Q_ASSERT(checkVisibleItem(id));
+
+        idStart.row = qMin(idStart.row, id.row);
+        idStart.column = qMin(idStart.column, id.column);
+        idEnd.row = qMax(idEnd.row, id.row);
+        idEnd.column = qMax(idEnd.column, id.column);
+    }
+
+    // sparse items are cheaper to look up one by one
+    qint64 blockLookups = qint64(idEnd.row - idStart.row) + (idEnd.column - idStart.column) + 4;
+    if (blockLookups > qint64(visibleItems.size()) * 4)
+        return Space::itemRects(visibleItems);
+
+    // endPos(line) == startPos(line + 1)
+    QVector<int> rowStarts = linesStarts(*m_rows, idStart.row, idEnd.row);
+    QVector<int> columnStarts = linesStarts(*m_columns, idStart.column, idEnd.column);
+
+    QVector<QRect> rects;
+    rects.reserve(visibleItems.size());
+    for (ID visibleItem : visibleItems)
+    {
+        GridID id = visibleItem.as<GridID>() - idStart;
+
+        QRect rect(0, 0, 0, 0);
+        rect.setTop(rowStarts[id.row]);
+        rect.setLeft(columnStarts[id.column]);
+        rect.setBottom(rowStarts[id.row + 1]);
+        rect.setRight(columnStarts[id.column + 1]);
+        rects.append(rect);
+    }
+
+    return rects;
+}
+
 SharedPtr<CacheItemFactory> SpaceGrid::createCacheItemFactory() const
 {
     switch (m_hint) {
@@ -328,8 +490,11 @@ SharedPtr<CacheItemFactory> SpaceGrid::createCacheItemFactory() const
         return createCacheItemFactorySameSchemaByColumn(*this);
     case SpaceGridHintSameSchemasByRow:
         return createCacheItemFactorySameSchemaByRow(*this);
+    case SpaceGridHintSameSchemasByColumnRanges:
+        return createCacheItemFactorySameSchemaByColumnRanges(*this);
     default:
-        return createCacheItemFactoryDefault(*this);
+        // uniformity is found from schemas ranges
+        return createCacheItemFactoryUniform(*this);
     }
 }
 
@@ -341,11 +506,17 @@ QSize SpaceGrid::itemSize(GridID item) const
 void SpaceGrid::connectLines(const SharedPtr<Lines> &lines)
 {
     connect(lines.data(), &Lines::linesChanged, this, &SpaceGrid::onLinesChanged);
+    connect(lines.data(), &Lines::linesInserted, this, &SpaceGrid::onLinesInserted);
+    connect(lines.data(), &Lines::linesRemoved, this, &SpaceGrid::onLinesRemoved);
+    connect(lines.data(), &Lines::lineResized, this, &SpaceGrid::onLineResized);
 }
 
 void SpaceGrid::disconnectLines(const SharedPtr<Lines> &lines)
 {
     disconnect(lines.data(), &Lines::linesChanged, this, &SpaceGrid::onLinesChanged);
+    disconnect(lines.data(), &Lines::linesInserted, this, &SpaceGrid::onLinesInserted);
+    disconnect(lines.data(), &Lines::linesRemoved, this, &SpaceGrid::onLinesRemoved);
+    disconnect(lines.data(), &Lines::lineResized, this, &SpaceGrid::onLineResized);
 }
 
 GridID SpaceGrid::trimItem(GridID item) const
@@ -414,36 +585,127 @@ bool SpaceGrid::isItemVisible(GridID item) const
     return m_rows->isLineVisible(item.row) && m_columns->isLineVisible(item.column);
 }
 
-void SpaceGrid::sortColumnByModel(int column, const ModelComparable& model, bool ascending, bool stable)
+void SpaceGrid::sortColumnByModel(int column, const ModelComparable& model, bool ascending, bool stable, bool parallel, bool visibleOnly)
 {
+    QI_TRACE_SCOPE(TraceCategorySort, "SpaceGrid::sortColumnByModel");
+
     // avoid invalid column
     if (column >= m_columns->count())
         return;
 
-    if (ascending)
-        m_rows->sort(stable, AscendingColumnComparatorByModel(column, model));
+    // all rows are visible
+    if (visibleOnly && m_rows->visibleCount() == m_rows->count())
+        visibleOnly = false;
+
+    // call compare concurrently for thread safe models only
+    parallel = parallel && model.isThreadSafe();
+
+    // try to sort by extracted keys first, ordinal keys are counting sorted
+    // keys are sorted stable, so either stable flag is satisfied,
+    // but in one thread, so parallel sorting compares by model instead
+    if (!parallel)
+    {
+        QVector<int> positions;
+        QVector<int> permutation;
+        if (visibleOnly)
+        {
+            positions = m_rows->visibleRelativePositions();
+            permutation = m_rows->permutationAt(positions);
+        }
+        else
+            permutation = m_rows->permutation();
+
+        if (model.sortLines(permutation, [column](int row) { return ID(GridID(row, column)); }, ascending))
+        {
+            if (visibleOnly)
+                m_rows->setPermutationAt(positions, permutation);
+            else
+                m_rows->setPermutation(permutation);
+            return;
+        }
+    }
+
+    if (visibleOnly)
+    {
+        if (ascending)
+            m_rows->sortVisible(stable, AscendingColumnComparatorByModel(column, model), parallel);
+        else
+            m_rows->sortVisible(stable, DescendingColumnComparatorByModel(column, model), parallel);
+    }
+    else if (ascending)
+        m_rows->sort(stable, AscendingColumnComparatorByModel(column, model), parallel);
     else
-        m_rows->sort(stable, DescendingColumnComparatorByModel(column, model));
+        m_rows->sort(stable, DescendingColumnComparatorByModel(column, model), parallel);
 }
 
-void SpaceGrid::sortRowByModel(int row, const ModelComparable &model, bool ascending, bool stable)
+void SpaceGrid::sortRowByModel(int row, const ModelComparable &model, bool ascending, bool stable, bool parallel)
 {
+    QI_TRACE_SCOPE(TraceCategorySort, "SpaceGrid::sortRowByModel");
+
     // avoid invalid row
     if (row >= m_rows->count())
         return;
 
+    // call compare concurrently for thread safe models only
+    parallel = parallel && model.isThreadSafe();
+
+    // try to sort by extracted keys first, see sortColumnByModel
+    if (!parallel)
+    {
+        QVector<int> permutation = m_columns->permutation();
+        if (model.sortLines(permutation, [row](int column) { return ID(GridID(row, column)); }, ascending))
+        {
+            m_columns->setPermutation(permutation);
+            return;
+        }
+    }
+
     if (ascending)
-        m_columns->sort(stable, AscendingRowComparatorByModel(row, model));
+        m_columns->sort(stable, AscendingRowComparatorByModel(row, model), parallel);
     else
-        m_columns->sort(stable, DescendingRowComparatorByModel(row, model));
+        m_columns->sort(stable, DescendingRowComparatorByModel(row, model), parallel);
 }
 
 void SpaceGrid::onLinesChanged(const Lines* /*lines*/, ChangeReason reason)
 {
-    if (reason & (ChangeReasonLinesCount|ChangeReasonLinesVisibility|ChangeReasonLinesSize|ChangeReasonLinesOrder))
+    if (m_isLinesShifted)
+    {
+        // items kept their absolute ids shifted by listeners of linesInserted/linesRemoved
+        m_isLinesShifted = false;
+        emit spaceChanged(this, ChangeReasonSpaceStructure|ChangeReasonSpaceItemsOrder);
+    }
+    else if (m_isLineResized)
+    {
+        // cache items of resized line were dropped by listeners of lineResized
+        m_isLineResized = false;
+        emit spaceChanged(this, ChangeReasonSpaceStructure|ChangeReasonSpaceItemsOrder);
+    }
+    else if (reason & (ChangeReasonLinesCount|ChangeReasonLinesVisibility|ChangeReasonLinesSize))
     {
         emit spaceChanged(this, ChangeReasonSpaceStructure);
     }
+    else if (reason & ChangeReasonLinesOrder)
+    {
+        emit spaceChanged(this, ChangeReasonSpaceStructure|ChangeReasonSpaceItemsOrder);
+    }
+}
+
+void SpaceGrid::onLinesInserted(const Lines* lines, int absoluteLine, int linesCount)
+{
+    m_isLinesShifted = true;
+    emit linesInserted(this, lines, absoluteLine, linesCount);
+}
+
+void SpaceGrid::onLinesRemoved(const Lines* lines, int absoluteLine, int linesCount)
+{
+    m_isLinesShifted = true;
+    emit linesRemoved(this, lines, absoluteLine, linesCount);
+}
+
+void SpaceGrid::onLineResized(const Lines* lines, int absoluteLine)
+{
+    m_isLineResized = true;
+    emit lineResized(this, lines, absoluteLine);
 }
 
 } // end namespace Qi
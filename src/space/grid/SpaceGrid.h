@@ -30,9 +30,13 @@ class ModelComparable;
 
 enum SpaceGridHint
 {
+    // schemas are memoized by column or row if their ranges allow it
     SpaceGridHintNone = 0x0000,
+    // hints below are trusted and override detection
     SpaceGridHintSameSchemasByColumn = 0x0001,
     SpaceGridHintSameSchemasByRow = 0x0002,
+    // same schemas by column, usually for wide grids with ranges of alike columns
+    SpaceGridHintSameSchemasByColumnRanges = 0x0004,
 };
 
 class QI_EXPORT SpaceGrid: public Space
@@ -52,6 +56,8 @@ public:
     ID toAbsolute(ID visibleItem) const override { return ID(toGridAbsolute(visibleItem.as<GridID>())); }
     ID toVisible(ID absoluteItem) const override { return ID(toGridVisible(absoluteItem.as<GridID>())); }
     QRect itemRect(ID visibleItem) const override;
+    // positions of rows and columns of the items block are looked up once
+    QVector<QRect> itemRects(const QVector<ID>& visibleItems) const override;
     SharedPtr<CacheItemFactory> createCacheItemFactory() const override;
 
     bool isEmpty() const { return m_rows->isEmpty() || m_columns->isEmpty(); }
@@ -86,11 +92,23 @@ public:
     bool checkVisibleItem(GridID id) const;
     bool isItemVisible(GridID id) const;
 
-    void sortColumnByModel(int column, const ModelComparable &model, bool ascending, bool stable);
-    void sortRowByModel(int row, const ModelComparable& model, bool ascending, bool stable);
+    // parallel sorting is used only if model is thread safe, it compares items instead of sorting extracted keys
+    // visibleOnly sorts visible rows only, hidden rows keep their relative positions
+    void sortColumnByModel(int column, const ModelComparable &model, bool ascending, bool stable, bool parallel = false, bool visibleOnly = false);
+    void sortRowByModel(int row, const ModelComparable& model, bool ascending, bool stable, bool parallel = false);
+
+signals:
+    // rows or columns were inserted or removed, emitted before spaceChanged
+    void linesInserted(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount);
+    void linesRemoved(const SpaceGrid* grid, const Lines* lines, int absoluteLine, int linesCount);
+    // size of one row or column was changed, emitted before spaceChanged
+    void lineResized(const SpaceGrid* grid, const Lines* lines, int absoluteLine);
 
 private slots:
     void onLinesChanged(const Lines* lines, ChangeReason reason);
+    void onLinesInserted(const Lines* lines, int absoluteLine, int linesCount);
+    void onLinesRemoved(const Lines* lines, int absoluteLine, int linesCount);
+    void onLineResized(const Lines* lines, int absoluteLine);
 
 private:
     void connectLines(const SharedPtr<Lines>& lines);
@@ -103,22 +121,44 @@ private:
     SharedPtr<Lines> m_columns;
 
     SpaceGridHint m_hint;
+    // lines were inserted or removed and cache items can be reused by absolute ids
+    bool m_isLinesShifted;
+    // one line was resized and cache items of other lines can be reused by absolute ids
+    bool m_isLineResized;
 };
 
 QI_EXPORT SharedPtr<Range> makeRangeGridRect(const SpaceGrid& grid, GridID displayCorner1, GridID displayCorner2);
 
+// run of items in absolute rows [firstRow, firstRow + rowsCount) of column
+struct QI_EXPORT GridColumnSpan
+{
+    int column = InvalidIndex;
+    int firstRow = InvalidIndex;
+    int rowsCount = 0;
+};
+
 class QI_EXPORT IdIteratorGrid: public IdIterator
 {
 public:
     GridID gridId() const { return gridIdImpl(); }
 
+    // batch version of fetchIds for grid ids
+    int fetchGridIds(GridID* ids, int count) { return fetchGridIdsImpl(ids, count); }
+    // fetches the longest run of items from the current one which are consecutive rows of one column
+    // and moves past it, returns false if iterator is not valid
+    bool fetchColumnSpan(GridColumnSpan& span) { return fetchColumnSpanImpl(span); }
+
 protected:
     IdIteratorGrid() = default;
 
     ID idImpl() const final { return ID(gridId()); }
     bool isValidImpl() const final { return gridId().isValid(); }
+    int fetchIdsImpl(ID* ids, int count) override;
 
     virtual GridID gridIdImpl() const = 0;
+    // call gridIdImpl and toNextImpl for each item by default
+    virtual int fetchGridIdsImpl(GridID* ids, int count);
+    virtual bool fetchColumnSpanImpl(GridColumnSpan& span);
 };
 
 class QI_EXPORT IdIteratorGridAll: public IdIteratorGrid
@@ -130,6 +170,7 @@ protected:
     GridID gridIdImpl() const override { return m_currentItem; }
     bool atFirstImpl() override;
     bool toNextImpl() override;
+    int fetchGridIdsImpl(GridID* ids, int count) override;
 
 private:
     const SpaceGrid& m_spaceGrid;
@@ -163,6 +204,8 @@ protected:
     GridID gridIdImpl() const override { return m_currentItem; }
     bool atFirstImpl() override;
     bool toNextImpl() override;
+    int fetchGridIdsImpl(GridID* ids, int count) override;
+    bool fetchColumnSpanImpl(GridColumnSpan& span) override;
 
 private:
     const Lines& m_rows;
@@ -25,7 +25,9 @@ namespace Qi
 
 CacheSpaceItem::CacheSpaceItem(const SharedPtr<SpaceItem> &spaceItem, bool syncSpaceSizeWithWindow)
     : CacheSpace(spaceItem),
-      m_spaceItem(spaceItem)
+      m_spaceItem(spaceItem),
+      m_isItemResized(false),
+      m_isCacheItemReused(false)
 {
     if (syncSpaceSizeWithWindow)
         connect(this, &CacheSpace::cacheChanged, this, &CacheSpaceItem::onCacheChanged);
@@ -43,10 +45,35 @@ void CacheSpaceItem::onCacheChanged(const CacheSpace* cache, ChangeReason reason
         m_spaceItem->setSize(window().size());
 }
 
+void CacheSpaceItem::setCacheItemReused(bool isCacheItemReused)
+{
+    if (m_isCacheItemReused == isCacheItemReused)
+        return;
+
+    m_isCacheItemReused = isCacheItemReused;
+    if (!m_isCacheItemReused && m_isItemResized)
+        clearItemsCacheImpl();
+}
+
 void CacheSpaceItem::clearItemsCacheImpl() const
 {
     Q_ASSERT(!m_cacheIsInUse);
     m_item.reset();
+    m_isItemResized = false;
+}
+
+void CacheSpaceItem::resizeItemsCacheImpl() const
+{
+    Q_ASSERT(!m_cacheIsInUse);
+
+    if (!m_isCacheItemReused || !m_item)
+    {
+        clearItemsCacheImpl();
+        return;
+    }
+
+    // item will be adjusted to new size in validateItemsCacheImpl
+    m_isItemResized = true;
 }
 
 void CacheSpaceItem::validateItemsCacheImpl() const
@@ -56,8 +83,29 @@ void CacheSpaceItem::validateItemsCacheImpl() const
 
     auto_value<bool> inUse(m_cacheIsInUse, true);
 
-    m_item = createCacheItem(m_spaceItem->id());
-    m_item->rect.translate(originPos());
+    if (m_isItemResized)
+    {
+        m_isItemResized = false;
+        Q_ASSERT(m_item);
+        Q_ASSERT(m_item->id == m_spaceItem->id());
+
+        QRect rect = m_spaceItem->itemRect(m_item->id).translated(originPos());
+        // views are laid out for item size only, offset is applied to rects
+        if (rect.size() != m_item->rect.size())
+        {
+            m_item->rect = rect;
+            m_item->invalidateCacheView();
+        }
+        else
+        {
+            m_item->correctRectangles(rect.topLeft() - m_item->rect.topLeft());
+        }
+    }
+    else
+    {
+        m_item = createCacheItem(m_spaceItem->id());
+        m_item->rect.translate(originPos());
+    }
 
     // mark item as valid
     m_itemsCacheInvalid = false;
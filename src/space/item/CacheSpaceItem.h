@@ -34,8 +34,14 @@ public:
 
     const SharedPtr<SpaceItem>& spaceItem() const { return m_spaceItem; }
 
+    // keeps single cache item across resizes of the space item,
+    // item's views are laid out again only if item size was changed
+    bool isCacheItemReused() const { return m_isCacheItemReused; }
+    void setCacheItemReused(bool isCacheItemReused);
+
 private:
     void clearItemsCacheImpl() const override;
+    void resizeItemsCacheImpl() const override;
     void validateItemsCacheImpl() const override;
     bool forEachCacheItemImpl(const std::function<bool(const SharedPtr<CacheItem>&)>& visitor) const override;
     const CacheItem* cacheItemImpl(ID visibleId) const override;
@@ -45,6 +51,9 @@ private:
 
     SharedPtr<SpaceItem> m_spaceItem;
     mutable SharedPtr<CacheItem> m_item;
+    // resized item waiting for validation
+    mutable bool m_isItemResized;
+    bool m_isCacheItemReused;
 };
 
 } // end namespace Qi
@@ -48,7 +48,7 @@ void SpaceItem::setSize(const QSize& size)
 
     m_size = size;
 
-    emit spaceChanged(this, ChangeReasonSpaceStructure);
+    emit spaceChanged(this, ChangeReasonSpaceStructure|ChangeReasonSpaceItemsSize);
 }
 
 void SpaceItem::setId(ID id)
@@ -17,6 +17,7 @@
 #include "CacheSpaceScene.h"
 #include "cache/CacheItem.h"
 #include "utils/auto_value.h"
+#include <algorithm>
 
 namespace Qi
 {
@@ -25,10 +26,12 @@ CacheSpaceScene::CacheSpaceScene(SharedPtr<SpaceScene> scene)
     : CacheSpace(scene),
       m_scene(std::move(scene))
 {
+    connect(m_scene.data(), &SpaceScene::elementsMoved, this, &CacheSpaceScene::onElementsMoved);
 }
 
 CacheSpaceScene::~CacheSpaceScene()
 {
+    disconnect(m_scene.data(), &SpaceScene::elementsMoved, this, &CacheSpaceScene::onElementsMoved);
 }
 
 void CacheSpaceScene::clearItemsCacheImpl() const
@@ -40,6 +43,13 @@ void CacheSpaceScene::clearItemsCacheImpl() const
     m_sizeDelta = QSize(0, 0);
 }
 
+void CacheSpaceScene::invalidateItemsImpl(const QVector<ID>& visibleIds) const
+{
+    // other items are kept by validateItemsCacheImpl
+    for (const auto& visibleId : visibleIds)
+        removeCacheItem(index(visibleId));
+}
+
 void CacheSpaceScene::validateItemsCacheImpl() const
 {
     Q_ASSERT(m_itemsCacheInvalid);
@@ -56,16 +66,13 @@ void CacheSpaceScene::validateItemsCacheImpl() const
     QRect cacheRect(scrollOffset(), window().size());
     QPoint origin = originPos();
 
-    int count = m_scene->count();
     auto it = m_items.begin();
 
     QVector<SharedPtr<CacheItem>> newItems;
 
-    for (int id(0); id < count; ++id)
+    // only elements found by scene index
+    for (int id : m_scene->elementsInRect(cacheRect))
     {
-        if (!cacheRect.intersects(m_scene->itemRect(ID(id))))
-            continue;
-
         SharedPtr<CacheItem> newItem;
         while ((it != m_items.end()) && (index((*it)->id) <= id))
         {
@@ -90,6 +97,9 @@ void CacheSpaceScene::validateItemsCacheImpl() const
     }
 
     m_items.swap(newItems);
+    Q_ASSERT(std::is_sorted(m_items.begin(), m_items.end(), [](const SharedPtr<CacheItem>& left, const SharedPtr<CacheItem>& right) {
+        return index(left->id) < index(right->id);
+    }));
 
     // clear offset
     m_scrollDelta = QPoint(0, 0);
@@ -108,15 +118,84 @@ bool CacheSpaceScene::forEachCacheItemImpl(const std::function<bool(const Shared
     return true;
 }
 
+static bool cacheItemIdLess(const SharedPtr<CacheItem>& cacheItem, int id)
+{
+    return index(cacheItem->id) < id;
+}
+
 const CacheItem* CacheSpaceScene::cacheItemImpl(ID visibleId) const
 {
-    for (const auto& cacheItem : m_items)
+    // items are ordered by id
+    auto it = std::lower_bound(m_items.begin(), m_items.end(), index(visibleId), cacheItemIdLess);
+    if (it != m_items.end() && (*it)->id == visibleId)
+        return it->data();
+
+    return nullptr;
+}
+
+void CacheSpaceScene::onElementsMoved(const SpaceScene* scene, const QVector<int>& ids, const QRect& oldBounds)
+{
+    Q_UNUSED(scene);
+    Q_ASSERT(scene == m_scene.data());
+
+    // animated items are recreated all together
+    if (m_animation)
+    {
+        clear();
+        return;
+    }
+
+    // items are not known until validation, moved ones are created by it
+    if (m_itemsCacheInvalid)
     {
-        if (cacheItem->id == visibleId)
-            return cacheItem.data();
+        QVector<ID> visibleIds;
+        visibleIds.reserve(ids.size());
+        for (int id : ids)
+            visibleIds.append(ID(id));
+        invalidateItems(visibleIds);
+        return;
     }
 
-    return nullptr;
+    applyItemsOffset();
+
+    QRect cacheRect(scrollOffset(), window().size());
+    QPoint origin = originPos();
+
+    QRect newBounds;
+    {
+        auto_value<bool> inUse(m_cacheIsInUse, true);
+
+        for (int id : ids)
+        {
+            int position = removeCacheItem(id);
+
+            // elements are indexed by normalized rects
+            QRect rect = m_scene->itemRect(ID(id)).normalized();
+            newBounds |= rect;
+            if (!rect.intersects(cacheRect))
+                continue;
+
+            SharedPtr<CacheItem> newItem = createCacheItem(ID(id));
+            newItem->rect.translate(origin);
+            m_items.insert(position, newItem);
+        }
+    }
+
+    QRegion windowRegion = QRegion(toView(oldBounds.translated(origin) & m_window)) | toView(newBounds.translated(origin) & m_window);
+    if (!windowRegion.isEmpty())
+        emit cacheItemsChanged(this, windowRegion);
+}
+
+int CacheSpaceScene::removeCacheItem(int id) const
+{
+    auto it = std::lower_bound(m_items.begin(), m_items.end(), id, cacheItemIdLess);
+    int position = int(it - m_items.begin());
+    if (it != m_items.end() && index((*it)->id) == id)
+    {
+        recycleCacheItem(*it);
+        m_items.erase(it);
+    }
+    return position;
 }
 
 const CacheItem* CacheSpaceScene::cacheItemByPositionImpl(QPoint point) const
@@ -126,10 +205,13 @@ const CacheItem* CacheSpaceScene::cacheItemByPositionImpl(QPoint point) const
     if (isEmpty())
         return nullptr;
 
-    for (const auto& cacheItem : m_items)
+    // ask scene index for elements under the point
+    QPoint scenePoint = point - originPos();
+    for (int id : m_scene->elementsInRect(QRect(scenePoint, QSize(1, 1))))
     {
-        if (cacheItem->rect.contains(point))
-            return cacheItem.data();
+        auto cacheItem = cacheItemImpl(ID(id));
+        if (cacheItem && cacheItem->rect.contains(point))
+            return cacheItem;
     }
 
     return nullptr;
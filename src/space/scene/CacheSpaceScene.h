@@ -37,15 +37,23 @@ public:
 
 private:
     void clearItemsCacheImpl() const override;
+    void invalidateItemsImpl(const QVector<ID>& visibleIds) const override;
     void validateItemsCacheImpl() const override;
     bool forEachCacheItemImpl(const std::function<bool(const SharedPtr<CacheItem>&)>& visitor) const override;
     const CacheItem* cacheItemImpl(ID visibleId) const override;
     const CacheItem* cacheItemByPositionImpl(QPoint point) const override;
+    bool isItemsOverlappedImpl() const override { return true; }
+
+    // replaces cache items of moved elements and repaints their old and new rects
+    void onElementsMoved(const SpaceScene* scene, const QVector<int>& ids, const QRect& oldBounds);
+    // removes cache item of element, returns position of the item by id order
+    int removeCacheItem(int id) const;
 
     // source scene space
     SharedPtr<SpaceScene> m_scene;
 
-    // cache items
+    // cache items ordered by id
+    // cacheItemImpl finds items by binary search
     mutable QVector<SharedPtr<CacheItem>> m_items;
 };
 
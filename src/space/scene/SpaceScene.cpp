@@ -16,6 +16,8 @@
 
 #include "SpaceScene.h"
 #include "cache/CacheItemFactory.h"
+#include <QSet>
+#include <algorithm>
 
 namespace Qi
 {
@@ -45,18 +47,32 @@ SharedPtr<Range> makeRangeByType(const SpaceScene* scene, int type)
     return makeShared<RangeByType>(scene, type);
 }
 
-class CacheItemFactorySameSchemaByType: public CacheItemFactory
+class CacheItemFactoryScene: public CacheItemFactory
 {
 public:
-    CacheItemFactorySameSchemaByType(const SpaceScene& space)
+    CacheItemFactoryScene(const SpaceScene& space, bool sameSchemasByType)
         : CacheItemFactory(space),
-          m_spaceScene(space)
+          m_spaceScene(space),
+          m_sameSchemasByType(sameSchemasByType)
     {}
 
 protected:
-    void initSchemaImpl(CacheItemInfo& info) const
+    void initSchemaImpl(CacheItemInfo& info) const override
     {
-        auto type = m_spaceScene.itemType(index(info.id));
+        int id = index(info.id);
+
+        // small elements are drawn by cheap schema
+        info.schema = m_spaceScene.lodSchema(id);
+        if (info.schema.isValid())
+            return;
+
+        if (!m_sameSchemasByType)
+        {
+            info.schema = createViewSchema(info.id);
+            return;
+        }
+
+        auto type = m_spaceScene.itemType(id);
         auto it = m_schemaByType.find(type);
         if (it != m_schemaByType.end())
         {
@@ -72,12 +88,29 @@ protected:
 
 private:
     const SpaceScene& m_spaceScene;
+    bool m_sameSchemasByType;
     mutable QMap<int, ViewSchema> m_schemaByType;
 };
 
+// default size of index cell
+static const int DefaultIndexCellSize = 256;
+// elements covering more cells are checked on each query
+static const int MaxElementCells = 64;
+
+static quint64 cellKey(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint32(y);
+}
+
+static int cellFloor(int value, int cellSize)
+{
+    return (value >= 0) ? value / cellSize : -((-value - 1) / cellSize) - 1;
+}
+
 SpaceScene::SpaceScene(SpaceSceneHint hint)
     : m_hint(hint),
-      m_sizeIsValid(false)
+      m_sizeIsValid(false),
+      m_indexCellSize(DefaultIndexCellSize)
 {
 }
 
@@ -100,10 +133,10 @@ QSize SpaceScene::size() const
         return m_size;
 
     m_size = QSize(0, 0);
-    int count = countImpl();
-    for (int id(0); id < count; ++id)
+    // indexed rects are up to date
+    QVector<QRect> rects = (m_indexRects.size() == countImpl()) ? m_indexRects : elementRectsImpl();
+    for (const QRect& rect : rects)
     {
-        QRect rect = itemRect(ID(id));
         m_size.rwidth() = qMax(m_size.width(), rect.right());
         m_size.rheight() = qMax(m_size.height(), rect.bottom());
     }
@@ -114,20 +147,248 @@ QSize SpaceScene::size() const
 
 SharedPtr<CacheItemFactory> SpaceScene::createCacheItemFactory() const
 {
-    switch (m_hint) {
-    case SpaceSceneHintSameSchemasByType:
-        return makeShared<CacheItemFactorySameSchemaByType>(*this);
-    default:
-        return createCacheItemFactoryDefault(*this);
+    return makeShared<CacheItemFactoryScene>(*this, m_hint == SpaceSceneHintSameSchemasByType);
+}
+
+QVector<int> SpaceScene::elementsInRect(const QRect& rect) const
+{
+    QVector<int> ids;
+    if (rect.isEmpty())
+        return ids;
+
+    validateIndex();
+
+    for (int id : m_indexLarge)
+    {
+        if (m_indexRects[id].intersects(rect))
+            ids.append(id);
+    }
+
+    QRect cells = indexCells(rect);
+    for (int y = cells.top(); y <= cells.bottom(); ++y)
+    {
+        for (int x = cells.left(); x <= cells.right(); ++x)
+        {
+            auto it = m_indexCells.find(cellKey(x, y));
+            if (it == m_indexCells.end())
+                continue;
+
+            for (int id : it.value())
+            {
+                if (m_indexRects[id].intersects(rect))
+                    ids.append(id);
+            }
+        }
     }
+
+    // elements are listed in each cell they cover
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+void SpaceScene::setIndexCellSize(int cellSize)
+{
+    Q_ASSERT(cellSize > 0);
+    if (m_indexCellSize == cellSize)
+        return;
+
+    m_indexCellSize = cellSize;
+    invalidateIndex();
+}
+
+void SpaceScene::setLodSize(const QSize& lodSize)
+{
+    if (m_lodSize == lodSize)
+        return;
+
+    m_lodSize = lodSize;
+    // rebuild cache items with new schemas
+    emit spaceChanged(this, ChangeReasonSpaceStructure);
+}
+
+void SpaceScene::setLodSchema(int elementType, const ViewSchema& schema)
+{
+    if (schema.isValid())
+        m_lodSchemas[elementType] = schema;
+    else
+        m_lodSchemas.remove(elementType);
+
+    if (!m_lodSize.isEmpty())
+        emit spaceChanged(this, ChangeReasonSpaceStructure);
+}
+
+ViewSchema SpaceScene::lodSchema(int id) const
+{
+    if (m_lodSize.isEmpty() || m_lodSchemas.isEmpty())
+        return ViewSchema();
+
+    QSize size = elementRectImpl(id).normalized().size();
+    if (size.width() >= m_lodSize.width() || size.height() >= m_lodSize.height())
+        return ViewSchema();
+
+    return m_lodSchemas.value(elementTypeImpl(id));
+}
+
+QVector<QRect> SpaceScene::elementRectsImpl() const
+{
+    int count = countImpl();
+    QVector<QRect> rects;
+    rects.reserve(count);
+    for (int id = 0; id < count; ++id)
+        rects.append(elementRectImpl(id));
+    return rects;
 }
 
 void SpaceScene::notifyCountChanged()
 {
     m_sizeIsValid = false;
+    invalidateIndex();
+    emit spaceChanged(this, ChangeReasonSpaceHint);
+}
+
+void SpaceScene::notifyElementAdded(int id)
+{
+    QRect rect = elementRectImpl(id).normalized();
+    growSize(rect);
+
+    // index stays valid if it contains all previous elements
+    if (m_indexRects.size() == id)
+    {
+        m_indexRects.append(rect);
+        indexInsert(id, rect);
+    }
+
     emit spaceChanged(this, ChangeReasonSpaceHint);
 }
 
+void SpaceScene::notifyElementsMoved(const QVector<int>& ids)
+{
+    if (ids.isEmpty())
+        return;
+
+    if (m_indexRects.isEmpty())
+    {
+        // old rects are unknown
+        m_sizeIsValid = false;
+        emit spaceChanged(this, ChangeReasonSpaceStructure);
+        return;
+    }
+
+    QSize oldSize = m_sizeIsValid ? m_size : QSize(-1, -1);
+
+    QVector<int> movedIds;
+    QRect oldBounds;
+    for (int id : ids)
+    {
+        QRect rect = elementRectImpl(id).normalized();
+        QRect oldRect = m_indexRects[id];
+        if (rect == oldRect)
+            continue;
+
+        // element on the boundary may shrink scene
+        if (m_sizeIsValid && (oldRect.right() == m_size.width() || oldRect.bottom() == m_size.height()))
+            m_sizeIsValid = false;
+        growSize(rect);
+
+        indexRemove(id, oldRect);
+        indexInsert(id, rect);
+        m_indexRects[id] = rect;
+
+        movedIds.append(id);
+        oldBounds |= oldRect;
+    }
+
+    if (movedIds.isEmpty())
+        return;
+
+    // scrollbars and layout depend on scene size
+    if (size() != oldSize)
+        emit spaceChanged(this, ChangeReasonSpaceStructure);
+    else
+        emit elementsMoved(this, movedIds, oldBounds);
+}
+
+void SpaceScene::growSize(const QRect& rect)
+{
+    if (!m_sizeIsValid)
+        return;
+
+    m_size.rwidth() = qMax(m_size.width(), rect.right());
+    m_size.rheight() = qMax(m_size.height(), rect.bottom());
+}
+
+void SpaceScene::validateIndex() const
+{
+    int count = countImpl();
+    if (m_indexRects.size() == count)
+        return;
+
+    m_indexCells.clear();
+    m_indexLarge.clear();
+    m_indexRects = elementRectsImpl();
+    Q_ASSERT(m_indexRects.size() == count);
+
+    for (int id = 0; id < count; ++id)
+    {
+        QRect& rect = m_indexRects[id];
+        rect = rect.normalized();
+        indexInsert(id, rect);
+    }
+}
+
+void SpaceScene::indexInsert(int id, const QRect& rect) const
+{
+    if (rect.isEmpty())
+        return;
+
+    QRect cells = indexCells(rect);
+    if (qint64(cells.width()) * cells.height() > MaxElementCells)
+    {
+        m_indexLarge.append(id);
+        return;
+    }
+
+    for (int y = cells.top(); y <= cells.bottom(); ++y)
+    {
+        for (int x = cells.left(); x <= cells.right(); ++x)
+            m_indexCells[cellKey(x, y)].append(id);
+    }
+}
+
+void SpaceScene::indexRemove(int id, const QRect& rect) const
+{
+    if (rect.isEmpty())
+        return;
+
+    QRect cells = indexCells(rect);
+    if (qint64(cells.width()) * cells.height() > MaxElementCells)
+    {
+        m_indexLarge.removeOne(id);
+        return;
+    }
+
+    for (int y = cells.top(); y <= cells.bottom(); ++y)
+    {
+        for (int x = cells.left(); x <= cells.right(); ++x)
+        {
+            auto it = m_indexCells.find(cellKey(x, y));
+            if (it == m_indexCells.end())
+                continue;
+
+            it.value().removeOne(id);
+            if (it.value().isEmpty())
+                m_indexCells.erase(it);
+        }
+    }
+}
+
+QRect SpaceScene::indexCells(const QRect& rect) const
+{
+    return QRect(QPoint(cellFloor(rect.left(), m_indexCellSize), cellFloor(rect.top(), m_indexCellSize)),
+                 QPoint(cellFloor(rect.right(), m_indexCellSize), cellFloor(rect.bottom(), m_indexCellSize)));
+}
+
 SpaceSceneElements::SpaceSceneElements(SpaceSceneHint hint)
     : SpaceScene(hint)
 {
@@ -139,30 +400,179 @@ SpaceSceneElements::~SpaceSceneElements()
 
 void SpaceSceneElements::addElement(SharedPtr<SceneElement> element)
 {
+    Q_ASSERT(element);
+    m_dependents.reset();
+
+    QRect rect = element->rect();
+    int type = element->type();
     m_elements.append(std::move(element));
-    notifyCountChanged();
+    m_rects.append(rect);
+    m_types.append(type);
+    notifyElementAdded(m_rects.size() - 1);
+}
+
+int SpaceSceneElements::addElement(const QRect& rect, int type)
+{
+    m_elements.append(SharedPtr<SceneElement>());
+    m_rects.append(rect);
+    m_types.append(type);
+    notifyElementAdded(m_rects.size() - 1);
+    return m_rects.size() - 1;
 }
 
 void SpaceSceneElements::clearElements()
 {
+    m_dependents.reset();
     m_elements.clear();
+    m_rects.clear();
+    m_types.clear();
     notifyCountChanged();
 }
 
 void SpaceSceneElements::setElements(QVector<SharedPtr<SceneElement>> elements)
 {
+    m_dependents.reset();
     m_elements = std::move(elements);
+    m_rects.resize(m_elements.size());
+    m_types.resize(m_elements.size());
+    for (int id = 0; id < m_elements.size(); ++id)
+        storeElement(id);
+    notifyCountChanged();
+}
+
+void SpaceSceneElements::setElements(QVector<QRect> rects, QVector<int> types)
+{
+    Q_ASSERT(rects.size() == types.size());
+
+    m_dependents.reset();
+    m_rects = std::move(rects);
+    m_types = std::move(types);
+    m_elements.fill(SharedPtr<SceneElement>(), m_rects.size());
     notifyCountChanged();
 }
 
-QRect SpaceSceneElements::elementRectImpl(int id) const
+void SpaceSceneElements::updateElements(const QVector<int>& ids)
+{
+    QVector<int> changedIds = withDependents(ids);
+    for (int id : changedIds)
+        storeElement(id);
+    notifyElementsMoved(changedIds);
+}
+
+void SpaceSceneElements::setElementsRect(const QVector<int>& ids, const QVector<QRect>& rects)
+{
+    Q_ASSERT(ids.size() == rects.size());
+
+    for (int i = 0; i < ids.size(); ++i)
+        m_rects[ids[i]] = rects[i];
+    notifyElementsMoved(ids);
+}
+
+QVector<int> SpaceSceneElements::withDependents(const QVector<int>& ids) const
+{
+    validateDependents();
+    if (m_dependents->isEmpty())
+        return ids;
+
+    // anchors depend on elements and connections depend on anchors
+    QVector<int> result;
+    QSet<int> visited;
+    QVector<int> pending = ids;
+    while (!pending.isEmpty())
+    {
+        int id = pending.takeLast();
+        if (visited.contains(id))
+            continue;
+
+        visited.insert(id);
+        result.append(id);
+        for (auto it = m_dependents->find(id); it != m_dependents->end() && it.key() == id; ++it)
+            pending.append(it.value());
+    }
+
+    return result;
+}
+
+void SpaceSceneElements::validateDependents() const
+{
+    if (m_dependents)
+        return;
+
+    m_dependents.reset(new QMultiHash<int, int>());
+
+    QHash<const SceneElement*, int> elementIds;
+    for (int id = 0; id < m_elements.size(); ++id)
+    {
+        if (m_elements[id])
+            elementIds.insert(m_elements[id].data(), id);
+    }
+
+    auto addDependent = [this, &elementIds](const SceneElement* element, int dependentId) {
+        // anchors missing in scene are followed to their source elements
+        while (element)
+        {
+            auto it = elementIds.find(element);
+            if (it != elementIds.end())
+            {
+                m_dependents->insert(it.value(), dependentId);
+                return;
+            }
+
+            auto anchor = dynamic_cast<const SceneElementAnchor*>(element);
+            element = anchor ? anchor->sourceElement().data() : nullptr;
+        }
+    };
+
+    for (int id = 0; id < m_elements.size(); ++id)
+    {
+        const SceneElement* element = m_elements[id].data();
+        if (auto anchor = dynamic_cast<const SceneElementAnchor*>(element))
+        {
+            addDependent(anchor->sourceElement().data(), id);
+        }
+        else if (auto connection = dynamic_cast<const SceneElementConnection*>(element))
+        {
+            addDependent(connection->elementFrom().data(), id);
+            addDependent(connection->elementTo().data(), id);
+        }
+    }
+}
+
+void SpaceSceneElements::storeElement(int id)
 {
-    return m_elements[id]->rect();
+    const auto& element = m_elements[id];
+    if (!element)
+        return;
+
+    m_rects[id] = element->rect();
+    m_types[id] = element->type();
 }
 
-int SpaceSceneElements::elementTypeImpl(int id) const
+int SpaceSceneElements::connectionAt(const QPoint& scenePoint, int tolerance) const
 {
-    return m_elements[id]->type();
+    QRect pointRect(scenePoint - QPoint(tolerance, tolerance), QSize(2 * tolerance + 1, 2 * tolerance + 1));
+
+    // topmost connection first
+    QVector<int> ids = elementsInRect(pointRect);
+    for (auto it = ids.rbegin(); it != ids.rend(); ++it)
+    {
+        auto connection = dynamic_cast<const SceneElementConnection*>(m_elements[*it].data());
+        if (!connection)
+            continue;
+
+        // distance from point to segment
+        QPointF from = connection->elementFrom()->point();
+        QPointF to = connection->elementTo()->point();
+        QPointF segment = to - from;
+        qreal length2 = QPointF::dotProduct(segment, segment);
+        qreal t = (length2 > 0.) ? qBound(0., QPointF::dotProduct(scenePoint - from, segment) / length2, 1.) : 0.;
+        QPointF delta = scenePoint - (from + t * segment);
+
+        if (QPointF::dotProduct(delta, delta) <= qreal(tolerance * tolerance))
+            return *it;
+    }
+
+    return InvalidIndex;
 }
 
 SceneElementAnchor::SceneElementAnchor(SharedPtr<SceneElement> sourceElement, Anchor anchor, int type)
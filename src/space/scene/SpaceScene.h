@@ -18,6 +18,9 @@
 #define QI_SPACE_SCENE_H
 
 #include "space/Space.h"
+#include <QHash>
+#include <QMap>
+#include <QScopedPointer>
 
 namespace Qi
 {
@@ -50,17 +53,68 @@ public:
 
     int itemType(int id) const { return elementTypeImpl(id); }
 
+    // ids of elements intersecting rect in ascending order
+    // elements are found through uniform grid index of cellSize cells
+    QVector<int> elementsInRect(const QRect& rect) const;
+
+    int indexCellSize() const { return m_indexCellSize; }
+    void setIndexCellSize(int cellSize);
+
+    // elements smaller than lodSize in both dimensions are drawn by lod schema of their type
+    // empty lodSize disables level of detail
+    QSize lodSize() const { return m_lodSize; }
+    void setLodSize(const QSize& lodSize);
+    void setLodSchema(int elementType, const ViewSchema& schema);
+    // returns invalid schema if element should be drawn in full detail
+    ViewSchema lodSchema(int id) const;
+
+signals:
+    // rects of elements were changed without changing scene size,
+    // oldBounds is bounding rect of their previous rects
+    // emitted instead of spaceChanged with ChangeReasonSpaceStructure
+    void elementsMoved(const SpaceScene* scene, const QVector<int>& ids, const QRect& oldBounds);
+
 protected:
     virtual int countImpl() const = 0;
     virtual QRect elementRectImpl(int id) const = 0;
     virtual int elementTypeImpl(int id) const = 0;
+    // rects of all elements by id, scanned by size and index building
+    // default calls elementRectImpl for each element
+    virtual QVector<QRect> elementRectsImpl() const;
 
     void notifyCountChanged();
+    // updates size and index for element appended with id
+    void notifyElementAdded(int id);
+    // updates size and index for elements which rects were changed
+    // emits elementsMoved if old rects are indexed and scene size is kept
+    void notifyElementsMoved(const QVector<int>& ids);
 
 private:
+    void invalidateIndex() { m_indexRects.clear(); m_indexCells.clear(); m_indexLarge.clear(); }
+    void validateIndex() const;
+    void indexInsert(int id, const QRect& rect) const;
+    void indexRemove(int id, const QRect& rect) const;
+    // cells range covered by rect
+    QRect indexCells(const QRect& rect) const;
+    // extends valid size to contain rect
+    void growSize(const QRect& rect);
+
     SpaceSceneHint m_hint;
     mutable bool m_sizeIsValid;
     mutable QSize m_size;
+
+    // uniform grid index
+    int m_indexCellSize;
+    // normalized element rects at the moment of indexing, empty if index is invalid
+    mutable QVector<QRect> m_indexRects;
+    // elements by cell key
+    mutable QHash<quint64, QVector<int>> m_indexCells;
+    // elements covering too many cells
+    mutable QVector<int> m_indexLarge;
+
+    // level of detail
+    QSize m_lodSize;
+    QMap<int, ViewSchema> m_lodSchemas;
 };
 
 QI_EXPORT SharedPtr<Range> makeRangeByType(const SpaceScene* scene, int type);
@@ -78,16 +132,49 @@ public:
     ~SpaceSceneElements();
 
     void addElement(SharedPtr<SceneElement> element);
+    // adds element without object, returns its id
+    int addElement(const QRect& rect, int type = SceneElementTypeNode);
     void clearElements();
     void setElements(QVector<SharedPtr<SceneElement> > elements);
+    // sets elements without objects, rects and types should have the same size
+    void setElements(QVector<QRect> rects, QVector<int> types);
+    // call after rects of element objects have been changed
+    // anchors and connections attached to the elements are updated too
+    void updateElements(const QVector<int>& ids);
+    // moves elements, element objects are not changed
+    void setElementsRect(const QVector<int>& ids, const QVector<QRect>& rects);
+
+    // returns null for element added without object
+    const SharedPtr<SceneElement>& element(int id) const { return m_elements[id]; }
+    // rects and types of elements by id
+    const QVector<QRect>& elementRects() const { return m_rects; }
+    const QVector<int>& elementTypes() const { return m_types; }
+
+    // returns connection passing within tolerance from scenePoint or InvalidIndex
+    // candidates are found by spatial index
+    int connectionAt(const QPoint& scenePoint, int tolerance = 2) const;
 
 protected:
-    int countImpl() const override { return m_elements.size(); }
-    QRect elementRectImpl(int id) const override;
-    int elementTypeImpl(int id) const override;
+    int countImpl() const override { return m_rects.size(); }
+    QRect elementRectImpl(int id) const override { return m_rects[id]; }
+    int elementTypeImpl(int id) const override { return m_types[id]; }
+    QVector<QRect> elementRectsImpl() const override { return m_rects; }
 
 private:
+    // copies rect and type of element object
+    void storeElement(int id);
+    // ids with anchors and connections attached to them
+    QVector<int> withDependents(const QVector<int>& ids) const;
+    void validateDependents() const;
+
+    // rects and types are stored contiguously,
+    // so culling and indexing don't call element objects
+    QVector<QRect> m_rects;
+    QVector<int> m_types;
+    // optional objects, null for elements without objects
     QVector<SharedPtr<SceneElement>> m_elements;
+    // ids of anchors and connections attached to element id, null if invalid
+    mutable QScopedPointer<QMultiHash<int, int>> m_dependents;
 };
 
 enum SceneElementType
@@ -126,6 +213,9 @@ public:
     {
     }
 
+    // call SpaceSceneElements::updateElements after moving
+    void setRect(const QRect& rect) { m_rect = rect; }
+
 protected:
     QRect rectImpl() const override { return m_rect; }
     int typeImpl() const override { return m_type; }
@@ -167,6 +257,8 @@ class QI_EXPORT SceneElementAnchor: public SceneElementPoint
 public:
     SceneElementAnchor(SharedPtr<SceneElement> sourceElement, Anchor anchor, int type = SceneElementTypeAnchor);
 
+    const SharedPtr<SceneElement>& sourceElement() const { return m_sourceElement; }
+
 protected:
     QRect rectImpl() const override;
     int typeImpl() const override { return m_type; }
@@ -185,6 +277,9 @@ class QI_EXPORT SceneElementConnection: public SceneElement
 public:
     SceneElementConnection(SharedPtr<SceneElementPoint> elementFrom, SharedPtr<SceneElementPoint> elementTo, int type = SceneElementTypeConnection);
 
+    const SharedPtr<SceneElementPoint>& elementFrom() const { return m_elementFrom; }
+    const SharedPtr<SceneElementPoint>& elementTo() const { return m_elementTo; }
+
 protected:
     QRect rectImpl() const override;
     int typeImpl() const override { return m_type; }
@@ -0,0 +1,85 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "ViewSceneConnection.h"
+#include "SpaceScene.h"
+#include "cache/CacheView.h"
+#include <QPainter>
+
+namespace Qi
+{
+
+ViewSceneConnection::ViewSceneConnection(const SpaceSceneElements* scene, const QPen& pen)
+    : m_scene(scene),
+      m_pen(pen)
+{
+}
+
+void ViewSceneConnection::setPen(const QPen& pen)
+{
+    if (m_pen == pen)
+        return;
+
+    m_pen = pen;
+    emitViewChanged(ChangeReasonViewContent);
+}
+
+void ViewSceneConnection::drawImpl(QPainter* painter, const GuiContext& /*ctx*/, const CacheContext& cache, bool* /*showTooltip*/) const
+{
+    QLine line;
+    if (!connectionLine(cache.id, cache.cacheView.rect(), line))
+        return;
+
+    QPen oldPen = painter->pen();
+    painter->setPen(m_pen);
+    painter->drawLine(line);
+    painter->setPen(oldPen);
+}
+
+void ViewSceneConnection::drawBatchImpl(QPainter* painter, const GuiContext& /*ctx*/, const QVector<CacheViewBatchItem>& items, const QRect* /*visibleRect*/) const
+{
+    QVector<QLine> lines;
+    lines.reserve(items.size());
+    for (const auto& item : items)
+    {
+        QLine line;
+        if (connectionLine(item.id, item.cacheView->rect(), line))
+            lines.append(line);
+    }
+
+    QPen oldPen = painter->pen();
+    painter->setPen(m_pen);
+    painter->drawLines(lines);
+    painter->setPen(oldPen);
+}
+
+bool ViewSceneConnection::connectionLine(ID id, const QRect& itemRect, QLine& line) const
+{
+    int elementId = index(id);
+    if (!m_scene || elementId >= m_scene->count())
+        return false;
+
+    auto connection = dynamic_cast<const SceneElementConnection*>(m_scene->element(elementId).data());
+    if (!connection)
+        return false;
+
+    // map scene points to item rect
+    QPoint offset = itemRect.topLeft() - connection->rect().topLeft();
+    line = QLine(connection->elementFrom()->point() + offset, connection->elementTo()->point() + offset);
+    return true;
+}
+
+} // end namespace Qi
@@ -0,0 +1,58 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_VIEW_SCENE_CONNECTION_H
+#define QI_VIEW_SCENE_CONNECTION_H
+
+#include "core/View.h"
+#include <QPen>
+#include <QPointer>
+
+namespace Qi
+{
+
+class SpaceSceneElements;
+class SceneElementConnection;
+
+// draws SceneElementConnection elements as lines
+// batch drawing paints all visible connections of the view by one drawLines call
+class QI_EXPORT ViewSceneConnection: public View
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ViewSceneConnection)
+
+public:
+    ViewSceneConnection(const SpaceSceneElements* scene, const QPen& pen = QPen());
+
+    const QPen& pen() const { return m_pen; }
+    void setPen(const QPen& pen);
+
+protected:
+    void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawBatchableImpl() const override { return true; }
+    void drawBatchImpl(QPainter* painter, const GuiContext& ctx, const QVector<CacheViewBatchItem>& items, const QRect* visibleRect) const override;
+
+private:
+    // connection line in item rect coordinates
+    bool connectionLine(ID id, const QRect& itemRect, QLine& line) const;
+
+    QPointer<const SpaceSceneElements> m_scene;
+    QPen m_pen;
+};
+
+} // end namespace Qi
+
+#endif // QI_VIEW_SCENE_CONNECTION_H
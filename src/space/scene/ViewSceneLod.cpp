@@ -0,0 +1,64 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "ViewSceneLod.h"
+#include "SpaceScene.h"
+#include "cache/CacheView.h"
+#include <QPainter>
+
+namespace Qi
+{
+
+ViewSceneLod::ViewSceneLod(const SpaceSceneElements* scene, const QColor& color)
+    : m_scene(scene),
+      m_color(color)
+{
+}
+
+void ViewSceneLod::setColor(const QColor& color)
+{
+    if (m_color == color)
+        return;
+
+    m_color = color;
+    emitViewChanged(ChangeReasonViewContent);
+}
+
+void ViewSceneLod::drawImpl(QPainter* painter, const GuiContext& /*ctx*/, const CacheContext& cache, bool* /*showTooltip*/) const
+{
+    QRect rect = cache.cacheView.rect();
+    int id = index(cache.id);
+
+    if (m_scene && id < m_scene->count())
+    {
+        auto connection = dynamic_cast<const SceneElementConnection*>(m_scene->element(id).data());
+        if (connection)
+        {
+            // map scene points to view rect
+            QPoint offset = rect.topLeft() - connection->rect().topLeft();
+
+            painter->save();
+            painter->setPen(m_color);
+            painter->drawLine(connection->elementFrom()->point() + offset, connection->elementTo()->point() + offset);
+            painter->restore();
+            return;
+        }
+    }
+
+    painter->fillRect(rect, m_color);
+}
+
+} // end namespace Qi
@@ -0,0 +1,53 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_VIEW_SCENE_LOD_H
+#define QI_VIEW_SCENE_LOD_H
+
+#include "core/View.h"
+#include <QColor>
+#include <QPointer>
+
+namespace Qi
+{
+
+class SpaceSceneElements;
+
+// cheap view for elements drawn with low level of detail
+// nodes are filled with color, connections are drawn as lines between their points
+class QI_EXPORT ViewSceneLod: public View
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(ViewSceneLod)
+
+public:
+    ViewSceneLod(const SpaceSceneElements* scene, const QColor& color);
+
+    const QColor& color() const { return m_color; }
+    void setColor(const QColor& color);
+
+protected:
+    void drawImpl(QPainter* painter, const GuiContext& ctx, const CacheContext& cache, bool* showTooltip) const override;
+    bool isDrawBatchableImpl() const override { return true; }
+
+private:
+    QPointer<const SpaceSceneElements> m_scene;
+    QColor m_color;
+};
+
+} // end namespace Qi
+
+#endif // QI_VIEW_SCENE_LOD_H
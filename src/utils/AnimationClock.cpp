@@ -0,0 +1,97 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "AnimationClock.h"
+#include "core/View.h"
+
+namespace Qi
+{
+
+AnimationClock::AnimationClock()
+    : m_maxFps(30)
+{
+    m_clock.start();
+
+    m_frameTimer.setInterval(1000 / m_maxFps);
+    connect(&m_frameTimer, &QTimer::timeout, this, &AnimationClock::onFrame);
+}
+
+AnimationClock& AnimationClock::instance()
+{
+    static AnimationClock clock;
+    return clock;
+}
+
+void AnimationClock::setMaxFps(int maxFps)
+{
+    Q_ASSERT(maxFps > 0);
+    if (m_maxFps == maxFps)
+        return;
+
+    m_maxFps = maxFps;
+    m_frameTimer.setInterval(qMax(1, 1000 / m_maxFps));
+}
+
+void AnimationClock::addFrameItem(const View* view, ID id)
+{
+    Q_ASSERT(view);
+
+    // views are notified from the frame, drawing keeps them const
+    View* frameView = const_cast<View*>(view);
+    if (!m_views.contains(frameView))
+    {
+        m_views.insert(frameView);
+        connect(frameView, &QObject::destroyed, this, &AnimationClock::onViewDestroyed);
+    }
+
+    m_frameItems[frameView].insert(id);
+
+    if (!m_frameTimer.isActive())
+        m_frameTimer.start();
+}
+
+void AnimationClock::onFrame()
+{
+    // items drawn during repaint are added for the next frame
+    QHash<View*, QSet<ID>> frameItems;
+    frameItems.swap(m_frameItems);
+
+    if (frameItems.isEmpty())
+    {
+        m_frameTimer.stop();
+        return;
+    }
+
+    for (auto it = frameItems.constBegin(); it != frameItems.constEnd(); ++it)
+    {
+        QVector<ID> ids;
+        ids.reserve(it.value().size());
+        for (ID id : it.value())
+            ids.append(id);
+
+        // only visible cache items of the view are repainted
+        it.key()->emitViewItemsChanged(ids);
+    }
+}
+
+void AnimationClock::onViewDestroyed(QObject* view)
+{
+    m_views.remove(view);
+    m_frameItems.remove(static_cast<View*>(view));
+}
+
+} // end namespace Qi
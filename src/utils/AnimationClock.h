@@ -0,0 +1,74 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_ANIMATION_CLOCK_H
+#define QI_ANIMATION_CLOCK_H
+
+#include "core/ID.h"
+#include <QElapsedTimer>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+
+namespace Qi
+{
+
+class View;
+
+// shared frame clock of animated views
+// views add items they have drawn, each frame repaints these items only
+// items not drawn again are not visible any more and are dropped,
+// so the clock stops when no animated items are visible
+class QI_EXPORT AnimationClock: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(AnimationClock)
+
+public:
+    static AnimationClock& instance();
+
+    // milliseconds since the clock was created, common for all views
+    qint64 time() const { return m_clock.elapsed(); }
+
+    // frames per second limit
+    int maxFps() const { return m_maxFps; }
+    void setMaxFps(int maxFps);
+
+    // repaints item of the view on the next frame, usually called from View::drawImpl
+    void addFrameItem(const View* view, ID id);
+
+    bool isRunning() const { return m_frameTimer.isActive(); }
+
+private:
+    AnimationClock();
+
+    void onFrame();
+    void onViewDestroyed(QObject* view);
+
+    int m_maxFps;
+    // items drawn since the previous frame
+    QHash<View*, QSet<ID>> m_frameItems;
+    // views which destruction is tracked
+    QSet<QObject*> m_views;
+
+    QElapsedTimer m_clock;
+    QTimer m_frameTimer;
+};
+
+} // end namespace Qi
+
+#endif // QI_ANIMATION_CLOCK_H
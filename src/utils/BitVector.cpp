@@ -0,0 +1,221 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "BitVector.h"
+#include <QtAlgorithms>
+
+namespace Qi
+{
+
+static const quint64 AllBits = ~quint64(0);
+
+static int wordsCount(int size)
+{
+    return (size + 63) >> 6;
+}
+
+void BitVector::clear()
+{
+    m_words.clear();
+    m_size = 0;
+    invalidateRanks();
+}
+
+void BitVector::resize(int size, bool value)
+{
+    Q_ASSERT(size >= 0);
+
+    int oldSize = m_size;
+    m_words.resize(wordsCount(size));
+    m_size = size;
+
+    if (value)
+    {
+        for (int i = oldSize; i < size && (i & 63); ++i)
+            m_words[i >> 6] |= quint64(1) << (i & 63);
+        for (int i = wordsCount(oldSize); i < m_words.size(); ++i)
+            m_words[i] = AllBits;
+    }
+    else
+    {
+        for (int i = wordsCount(oldSize); i < m_words.size(); ++i)
+            m_words[i] = 0;
+    }
+
+    clearTail();
+    invalidateRanks();
+}
+
+void BitVector::fill(bool value, int size)
+{
+    Q_ASSERT(size >= 0);
+
+    m_words.fill(value ? AllBits : 0, wordsCount(size));
+    m_size = size;
+
+    clearTail();
+    invalidateRanks();
+}
+
+void BitVector::assign(const QVector<quint64>& words, int size)
+{
+    Q_ASSERT(size >= 0);
+    Q_ASSERT(words.size() == wordsCount(size));
+
+    m_words = words;
+    m_size = size;
+
+    clearTail();
+    invalidateRanks();
+}
+
+void BitVector::insert(int index, int count, bool value)
+{
+    Q_ASSERT(index >= 0 && index <= m_size);
+    Q_ASSERT(count >= 0);
+
+    int oldSize = m_size;
+    resize(m_size + count);
+
+    // shift tail bits
+    for (int i = oldSize - 1; i >= index; --i)
+        setValue(i + count, this->value(i));
+
+    for (int i = index; i < index + count; ++i)
+        setValue(i, value);
+}
+
+void BitVector::remove(int index, int count)
+{
+    Q_ASSERT(index >= 0 && count >= 0 && index + count <= m_size);
+
+    int newSize = m_size - count;
+    int i = index;
+
+    // shift bits up to word boundary, then by whole words
+    for (; i < newSize && (i & 63); ++i)
+        setValue(i, value(i + count));
+    for (; i + 64 <= newSize; i += 64)
+        m_words[i >> 6] = wordAt(i + count);
+    for (; i < newSize; ++i)
+        setValue(i, value(i + count));
+
+    resize(newSize);
+}
+
+quint64 BitVector::wordAt(int index) const
+{
+    Q_ASSERT(index >= 0 && index + 64 <= m_size);
+
+    const int word = index >> 6;
+    const int shift = index & 63;
+    if (!shift)
+        return m_words.at(word);
+
+    return (m_words.at(word) >> shift) | (m_words.at(word + 1) << (64 - shift));
+}
+
+void BitVector::setValue(int index, bool value)
+{
+    Q_ASSERT(index >= 0 && index < m_size);
+
+    quint64 mask = quint64(1) << (index & 63);
+    if (value)
+        m_words[index >> 6] |= mask;
+    else
+        m_words[index >> 6] &= ~mask;
+
+    invalidateRanks();
+}
+
+bool BitVector::isAll(bool value) const
+{
+    if (m_words.empty())
+        return true;
+
+    const quint64 pattern = value ? AllBits : 0;
+    for (int i = 0, n = m_words.size() - 1; i < n; ++i)
+    {
+        if (m_words[i] != pattern)
+            return false;
+    }
+
+    const int tailBits = m_size & 63;
+    const quint64 tailMask = tailBits ? (quint64(1) << tailBits) - 1 : AllBits;
+    return m_words.back() == (pattern & tailMask);
+}
+
+int BitVector::rank(int index) const
+{
+    Q_ASSERT(index >= 0 && index <= m_size);
+
+    validateRanks();
+
+    const int word = index >> 6;
+    const int bits = index & 63;
+
+    // const access keeps ranks shared between copies
+    int result = m_ranks.at(word);
+    if (bits)
+        result += qPopulationCount(m_words[word] & ((quint64(1) << bits) - 1));
+
+    return result;
+}
+
+int BitVector::select(int n) const
+{
+    Q_ASSERT(n >= 0 && n < count());
+
+    validateRanks();
+
+    // find last word which starts with not greater than n set bits
+    int word = int(std::upper_bound(m_ranks.constBegin(), m_ranks.constEnd() - 1, n) - m_ranks.constBegin()) - 1;
+    Q_ASSERT(word >= 0 && word < m_words.size());
+
+    quint64 bits = m_words[word];
+    for (int i = n - m_ranks.at(word); i > 0; --i)
+        bits &= bits - 1;
+
+    Q_ASSERT(bits);
+    return (word << 6) + qCountTrailingZeroBits(bits);
+}
+
+void BitVector::validateRanks() const
+{
+    if (!m_ranks.empty())
+        return;
+
+    m_ranks.resize(m_words.size() + 1);
+
+    int sum = 0;
+    for (int i = 0, n = m_words.size(); i < n; ++i)
+    {
+        m_ranks[i] = sum;
+        sum += qPopulationCount(m_words[i]);
+    }
+    m_ranks.back() = sum;
+}
+
+void BitVector::clearTail()
+{
+    // keep bits after m_size zero
+    const int tailBits = m_size & 63;
+    if (tailBits)
+        m_words.back() &= (quint64(1) << tailBits) - 1;
+}
+
+} // end namespace Qi
@@ -0,0 +1,82 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_BIT_VECTOR_H
+#define QI_BIT_VECTOR_H
+
+#include "QiAPI.h"
+#include <QVector>
+
+namespace Qi
+{
+
+// packed bits storage with rank/select queries
+class QI_EXPORT BitVector
+{
+public:
+    BitVector() : m_size(0) {}
+
+    int size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    void clear();
+    void resize(int size, bool value = false);
+    void fill(bool value, int size);
+    // inserts count bits with value before index
+    void insert(int index, int count, bool value);
+    // removes count bits starting from index
+    void remove(int index, int count);
+
+    bool value(int index) const { Q_ASSERT(index >= 0 && index < m_size); return (m_words[index >> 6] >> (index & 63)) & 1; }
+    bool front() const { return value(0); }
+    void setValue(int index, bool value);
+
+    // returns true if all bits equal value
+    bool isAll(bool value) const;
+
+    // number of set bits
+    int count() const { return rank(m_size); }
+    // number of set bits in [0, index)
+    int rank(int index) const;
+    // position of the set bit number n (starting from 0)
+    int select(int n) const;
+
+    // packed bits, 64 per word, bits after size are zero
+    const QVector<quint64>& words() const { return m_words; }
+    // sets packed bits, words should have (size + 63) / 64 items
+    void assign(const QVector<quint64>& words, int size);
+
+    // heap memory in bytes
+    qint64 memoryBytes() const { return qint64(m_words.capacity() + m_ranks.capacity() / 2) * sizeof(quint64); }
+
+private:
+    void invalidateRanks() { m_ranks.clear(); }
+    void validateRanks() const;
+    // 64 bits starting from index, index + 64 should not exceed size
+    quint64 wordAt(int index) const;
+    void clearTail();
+
+    QVector<quint64> m_words;
+    int m_size;
+
+    // m_ranks[word] - number of set bits before word
+    mutable QVector<int> m_ranks;
+};
+
+} // end namespace Qi
+
+#endif // QI_BIT_VECTOR_H
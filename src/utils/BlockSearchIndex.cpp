@@ -0,0 +1,112 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "BlockSearchIndex.h"
+#include <algorithm>
+#include <limits>
+
+namespace Qi
+{
+
+static const int PaddingKey = std::numeric_limits<int>::max();
+static const int CacheLineSize = 64;
+
+// number of keys in block not greater than value
+static inline int blockUpperBound(const int* block, int value)
+{
+    // compilers vectorize the fixed size loop
+    int count = 0;
+    for (int i = 0; i < BlockSearchIndex::BlockSize; ++i)
+        count += (block[i] <= value);
+    return count;
+}
+
+static int blocksCount(int count)
+{
+    return qMax(1, (count + BlockSearchIndex::BlockSize - 1) / BlockSearchIndex::BlockSize);
+}
+
+// allocates padded blocks starting at cache line boundary
+static void allocateLevel(QVector<int>& level, int& offset, int blocks)
+{
+    const int lineKeys = CacheLineSize / int(sizeof(int));
+    level.fill(PaddingKey, blocks * BlockSearchIndex::BlockSize + lineKeys - 1);
+    quintptr address = quintptr(level.constData());
+    offset = int((CacheLineSize - address % CacheLineSize) % CacheLineSize / sizeof(int));
+}
+
+void BlockSearchIndex::build(const QVector<int>& keys)
+{
+    clear();
+    m_count = keys.size();
+
+    int blocks = blocksCount(m_count);
+    m_levels.resize(1);
+    m_offsets.resize(1);
+    allocateLevel(m_levels[0], m_offsets[0], blocks);
+    std::copy(keys.begin(), keys.end(), m_levels[0].begin() + m_offsets[0]);
+
+    while (blocks > 1)
+    {
+        const int* lower = m_levels.back().constData() + m_offsets.back();
+        int upperBlocks = blocksCount(blocks);
+
+        QVector<int> upper;
+        int upperOffset = 0;
+        allocateLevel(upper, upperOffset, upperBlocks);
+        for (int block = 0; block < blocks; ++block)
+            upper[upperOffset + block] = lower[block * BlockSize + BlockSize - 1];
+
+        m_levels.append(upper);
+        m_offsets.append(upperOffset);
+        blocks = upperBlocks;
+    }
+}
+
+void BlockSearchIndex::clear()
+{
+    m_levels.clear();
+    m_offsets.clear();
+    m_count = 0;
+}
+
+int BlockSearchIndex::upperBound(int value) const
+{
+    if (m_count == 0)
+        return 0;
+
+    // top block may have no greater keys, other blocks always have
+    if (value >= key(m_count - 1))
+        return m_count;
+
+    // first block of lower level which max key is greater than value
+    int block = 0;
+    for (int level = m_levels.size() - 1; level > 0; --level)
+        block = block * BlockSize + blockUpperBound(levelBlock(level, block), value);
+
+    return qMin(block * BlockSize + blockUpperBound(levelBlock(0, block), value), m_count);
+}
+
+qint64 BlockSearchIndex::memoryBytes() const
+{
+    qint64 bytes = qint64(m_levels.capacity()) * sizeof(QVector<int>) + qint64(m_offsets.capacity()) * sizeof(int);
+    for (const auto& level : m_levels)
+        bytes += qint64(level.capacity()) * sizeof(int);
+    return bytes;
+}
+
+} // end namespace Qi
@@ -0,0 +1,67 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_BLOCK_SEARCH_INDEX_H
+#define QI_BLOCK_SEARCH_INDEX_H
+
+#include "QiAPI.h"
+#include <QVector>
+
+namespace Qi
+{
+
+// static B-tree over sorted keys for cache friendly searches
+// each level is split to blocks of BlockSize keys aligned to cache lines,
+// key of upper level is the max key of the block,
+// so a search reads one cache line per level and counts keys without branches
+// the lowest level is the keys themselves, so key(index) is a plain array access
+class QI_EXPORT BlockSearchIndex
+{
+public:
+    enum { BlockSize = 16 };
+
+    BlockSearchIndex() : m_count(0) {}
+
+    int count() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+
+    // keys should be non decreasing
+    void build(const QVector<int>& keys);
+    void clear();
+
+    int key(int index) const { Q_ASSERT(index >= 0 && index < m_count); return m_levels.front().at(m_offsets.front() + index); }
+
+    // number of keys not greater than value
+    int upperBound(int value) const;
+
+    // heap memory in bytes
+    qint64 memoryBytes() const;
+
+private:
+    const int* levelBlock(int level, int block) const { return m_levels[level].constData() + m_offsets[level] + block * BlockSize; }
+
+    // m_levels[0] - padded keys, m_levels.back() - single block
+    // containers are implicitly shared, so copies keep alignment
+    QVector<QVector<int>> m_levels;
+    // index of the first key of the level
+    QVector<int> m_offsets;
+    int m_count;
+};
+
+} // end namespace Qi
+
+#endif // QI_BLOCK_SEARCH_INDEX_H
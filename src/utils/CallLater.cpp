@@ -17,12 +17,16 @@
 #include "CallLater.h"
 #include <QEvent>
 #include <QCoreApplication>
+#include <QThreadStorage>
+#include <QPointer>
 #include <QDebug>
+#include <vector>
 
 namespace Qi
 {
 
 const QEvent::Type QCallEventType = QEvent::Type(QEvent::User+1);
+const QEvent::Type QCallOnceEventType = QEvent::Type(QEvent::User+2);
 
 class QCallEvent: public QEvent
 {
@@ -77,4 +81,93 @@ void callLater(QObject* owner, const std::function<void()>& callback)
     QCoreApplication::instance()->postEvent(&callManager, new QCallEvent(owner, callback));
 }
 
+// per thread queue of keyed calls, storage is reused between event loop turns
+class CallOnceQueue: public QObject
+{
+    Q_DISABLE_COPY(CallOnceQueue)
+
+public:
+    CallOnceQueue()
+        : m_isPosted(false),
+          m_isProcessing(false)
+    {
+    }
+
+    void add(QObject* owner, const char* key, const std::function<void()>& callback)
+    {
+        for (const auto& call : m_calls)
+        {
+            if (call.owner.data() == owner && qstrcmp(call.key, key) == 0)
+                return;
+        }
+
+        m_calls.push_back(Call{owner, key, callback});
+        post();
+    }
+
+    bool event(QEvent* event) override
+    {
+        if (event->type() != QCallOnceEventType)
+            return QObject::event(event);
+
+        m_isPosted = false;
+
+        // nested event loop from callback - process the rest on next turn
+        if (m_isProcessing)
+        {
+            post();
+            return true;
+        }
+
+        m_isProcessing = true;
+        // calls requested from callbacks go to the next turn
+        m_processing.swap(m_calls);
+        for (const auto& call : m_processing)
+        {
+            if (!call.owner.isNull())
+                call.callback();
+        }
+        m_processing.clear();
+        m_isProcessing = false;
+
+        return true;
+    }
+
+private:
+    void post()
+    {
+        if (m_isPosted)
+            return;
+
+        m_isPosted = true;
+        QCoreApplication::postEvent(this, new QEvent(QCallOnceEventType));
+    }
+
+    struct Call
+    {
+        QPointer<QObject> owner;
+        const char* key;
+        std::function<void()> callback;
+    };
+
+    std::vector<Call> m_calls;
+    std::vector<Call> m_processing;
+    bool m_isPosted;
+    bool m_isProcessing;
+};
+
+void callLaterOnce(QObject* owner, const char* key, const std::function<void()>& callback)
+{
+    Q_ASSERT(owner);
+    Q_ASSERT(key);
+    Q_ASSERT(callback);
+
+    static QThreadStorage<CallOnceQueue*> queues;
+
+    if (!queues.hasLocalData())
+        queues.setLocalData(new CallOnceQueue());
+
+    queues.localData()->add(owner, key, callback);
+}
+
 } // end namespace Qi
@@ -25,6 +25,10 @@ namespace Qi
 
 QI_EXPORT void callLater(QObject* owner, const std::function<void()>& callback);
 
+// calls callback once per event loop turn for each owner and key pair,
+// repeated requests before the call are ignored
+QI_EXPORT void callLaterOnce(QObject* owner, const char* key, const std::function<void()>& callback);
+
 } // end namespace Qi
 
 #endif // QI_CALL_LATER_H
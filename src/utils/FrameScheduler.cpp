@@ -0,0 +1,114 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "FrameScheduler.h"
+#include <QWidget>
+#include <QEvent>
+#include <QCoreApplication>
+
+namespace Qi
+{
+
+const QEvent::Type QFrameEventType = QEvent::Type(QEvent::User+3);
+
+FrameScheduler::FrameScheduler(QWidget* window)
+    : QObject(window),
+      m_currentPhase(FramePhasesCount),
+      m_isFramePosted(false),
+      m_framesCount(0)
+{
+}
+
+FrameScheduler* FrameScheduler::of(QWidget* widget)
+{
+    Q_ASSERT(widget);
+
+    QWidget* window = widget->window();
+    auto scheduler = window->findChild<FrameScheduler*>(QString(), Qt::FindDirectChildrenOnly);
+    if (!scheduler)
+        scheduler = new FrameScheduler(window);
+
+    return scheduler;
+}
+
+void FrameScheduler::schedule(FramePhase phase, QObject* owner, const char* key, const std::function<void()>& task)
+{
+    Q_ASSERT(phase >= 0 && phase < FramePhasesCount);
+    Q_ASSERT(owner);
+    Q_ASSERT(key);
+    Q_ASSERT(task);
+
+    auto& tasks = m_tasks[phase];
+    for (const auto& pending : tasks)
+    {
+        if (pending.owner.data() == owner && qstrcmp(pending.key, key) == 0)
+            return;
+    }
+
+    tasks.push_back(Task{owner, key, task});
+
+    // current and passed phases run in the next frame
+    if (!isFrameRunning() || phase <= m_currentPhase)
+        postFrame();
+}
+
+void FrameScheduler::runFrame()
+{
+    // nested event loop from task
+    if (isFrameRunning())
+    {
+        postFrame();
+        return;
+    }
+
+    for (int phase = 0; phase < FramePhasesCount; ++phase)
+    {
+        m_currentPhase = FramePhase(phase);
+
+        m_running.swap(m_tasks[phase]);
+        for (const auto& task : m_running)
+        {
+            if (!task.owner.isNull())
+                task.task();
+        }
+        m_running.clear();
+    }
+
+    m_currentPhase = FramePhasesCount;
+    ++m_framesCount;
+}
+
+bool FrameScheduler::event(QEvent* event)
+{
+    if (event->type() != QFrameEventType)
+        return QObject::event(event);
+
+    m_isFramePosted = false;
+    runFrame();
+    return true;
+}
+
+void FrameScheduler::postFrame()
+{
+    if (m_isFramePosted)
+        return;
+
+    m_isFramePosted = true;
+    QCoreApplication::postEvent(this, new QEvent(QFrameEventType));
+}
+
+} // end namespace Qi
@@ -0,0 +1,98 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_FRAME_SCHEDULER_H
+#define QI_FRAME_SCHEDULER_H
+
+#include "QiAPI.h"
+#include <QPointer>
+#include <functional>
+#include <vector>
+
+class QWidget;
+
+namespace Qi
+{
+
+// phases of a frame in execution order
+enum FramePhase
+{
+    // deferred model notifications
+    FramePhaseModel = 0,
+    // lines sizes, visibility and permutations
+    FramePhaseLines,
+    // cache items invalidation and validation
+    FramePhaseCache,
+    // cache items layout and scrollbars
+    FramePhaseLayout,
+    // repaint requests
+    FramePhasePaint,
+    FramePhasesCount
+};
+
+// runs deferred tasks of one window in phases, each phase at most once per frame
+class QI_EXPORT FrameScheduler: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(FrameScheduler)
+
+public:
+    // returns scheduler of the widget's window, creates it on demand
+    static FrameScheduler* of(QWidget* widget);
+
+    // schedules task in the phase of the next frame,
+    // repeated requests with the same owner and key are ignored until the task runs
+    // tasks of later phases scheduled while frame is running run in the same frame
+    void schedule(FramePhase phase, QObject* owner, const char* key, const std::function<void()>& task);
+
+    bool isFrameScheduled() const { return m_isFramePosted; }
+    bool isFrameRunning() const { return m_currentPhase != FramePhasesCount; }
+    // phase being executed or FramePhasesCount
+    FramePhase currentPhase() const { return m_currentPhase; }
+    // number of finished frames
+    quint64 framesCount() const { return m_framesCount; }
+
+    // runs pending tasks now
+    void runFrame();
+
+protected:
+    bool event(QEvent* event) override;
+
+private:
+    explicit FrameScheduler(QWidget* window);
+
+    void postFrame();
+
+    struct Task
+    {
+        QPointer<QObject> owner;
+        const char* key;
+        std::function<void()> task;
+    };
+
+    // pending tasks and tasks being executed for each phase
+    std::vector<Task> m_tasks[FramePhasesCount];
+    std::vector<Task> m_running;
+
+    FramePhase m_currentPhase;
+    bool m_isFramePosted;
+    quint64 m_framesCount;
+};
+
+} // end namespace Qi
+
+#endif // QI_FRAME_SCHEDULER_H
@@ -83,15 +83,69 @@ bool InplaceEdit::stop()
     onEditorDestroyed(m_inplaceEditor);
     Q_ASSERT(!m_inplaceEditor);
 
+    inplaceEditor->hide();
+    emit stopped(inplaceEditor);
+
+    if (m_pooledEditors.contains(inplaceEditor))
+    {
+        // keep editor for the next inplace edit
+        m_idleEditors.insert(inplaceEditor->metaObject(), inplaceEditor);
+        return true;
+    }
+
     // delete widget later
     // because stop() can be called from widget's signal
     // so we cannot delete widget right here
-    inplaceEditor->hide();
     inplaceEditor->deleteLater();
 
     return true;
 }
 
+void InplaceEdit::clearPool()
+{
+    for (QWidget* editor : m_idleEditors)
+    {
+        m_pooledEditors.remove(editor);
+        disconnect(editor, &QObject::destroyed, this, &InplaceEdit::onPooledEditorDestroyed);
+        editor->deleteLater();
+    }
+    m_idleEditors.clear();
+}
+
+QWidget* InplaceEdit::takePooledEditor(const QMetaObject& type, QWidget* parent)
+{
+    for (auto it = m_idleEditors.find(&type); it != m_idleEditors.end() && it.key() == &type; ++it)
+    {
+        QWidget* editor = it.value();
+        if (editor->parentWidget() == parent)
+        {
+            m_idleEditors.erase(it);
+            return editor;
+        }
+    }
+
+    return nullptr;
+}
+
+void InplaceEdit::addPooledEditor(QWidget* editor)
+{
+    m_pooledEditors.insert(editor);
+    connect(editor, &QObject::destroyed, this, &InplaceEdit::onPooledEditorDestroyed);
+}
+
+void InplaceEdit::onPooledEditorDestroyed(QObject* object)
+{
+    // editor is destroyed with its parent
+    m_pooledEditors.remove(object);
+    for (auto it = m_idleEditors.begin(); it != m_idleEditors.end(); )
+    {
+        if (it.value() == object)
+            it = m_idleEditors.erase(it);
+        else
+            ++it;
+    }
+}
+
 static bool hasParent(QObject* child, QObject* parent)
 {
     if (!child)
@@ -19,6 +19,8 @@
 
 #include "QiAPI.h"
 #include <QWidget>
+#include <QSet>
+#include <QMultiHash>
 
 namespace Qi
 {
@@ -33,14 +35,43 @@ public:
     QWidget *current() { return m_inplaceEditor; }
     bool stop();
 
+    // returns hidden editor of type T with parent from the pool or creates new one
+    // pooled editors are hidden instead of deleting on stop
+    template <typename T>
+    T* pooledEditor(QWidget* parent)
+    {
+        if (QWidget* editor = takePooledEditor(T::staticMetaObject, parent))
+            return static_cast<T*>(editor);
+
+        T* editor = new T(parent);
+        addPooledEditor(editor);
+        return editor;
+    }
+
+    // deletes not used pooled editors
+    void clearPool();
+
+signals:
+    // editor is stopped and hidden, receivers should disconnect from editor
+    void stopped(QWidget* editor);
+
 private:
     InplaceEdit();
 
     void onEditorDestroyed(QObject* object);
     bool eventFilter(QObject* watched, QEvent* event) override;
 
+    QWidget* takePooledEditor(const QMetaObject& type, QWidget* parent);
+    void addPooledEditor(QWidget* editor);
+    void onPooledEditorDestroyed(QObject* object);
+
     QWidget* m_inplaceEditor;
 
+    // all editors created by pooledEditor
+    QSet<QObject*> m_pooledEditors;
+    // stopped pooled editors by type
+    QMultiHash<const QMetaObject*, QWidget*> m_idleEditors;
+
     friend QI_EXPORT InplaceEdit& inplaceEdit();
 };
 
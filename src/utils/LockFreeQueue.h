@@ -0,0 +1,129 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_LOCK_FREE_QUEUE_H
+#define QI_LOCK_FREE_QUEUE_H
+
+#include "QiAPI.h"
+#include <atomic>
+#include <memory>
+
+namespace Qi
+{
+
+// bounded lock-free queue for many producers and many consumers
+// each cell has sequence number telling whether it is free or filled
+// for the current lap (see Dmitry Vyukov's bounded MPMC queue)
+template <typename T>
+class LockFreeQueue
+{
+    Q_DISABLE_COPY(LockFreeQueue)
+
+public:
+    // capacity is rounded up to power of two
+    explicit LockFreeQueue(int capacity)
+        : m_capacity(roundCapacity(capacity)),
+          m_mask(m_capacity - 1),
+          m_cells(new Cell[m_capacity]),
+          m_pushPos(0),
+          m_popPos(0)
+    {
+        for (size_t i = 0; i < m_capacity; ++i)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    int capacity() const { return int(m_capacity); }
+
+    // returns false if queue is full
+    bool push(T value)
+    {
+        Cell* cell = nullptr;
+        size_t pos = m_pushPos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &m_cells[pos & m_mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = qint64(sequence) - qint64(pos);
+            if (diff == 0)
+            {
+                if (m_pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_pushPos.load(std::memory_order_relaxed);
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // returns false if queue is empty
+    bool pop(T& value)
+    {
+        Cell* cell = nullptr;
+        size_t pos = m_popPos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &m_cells[pos & m_mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto diff = qint64(sequence) - qint64(pos + 1);
+            if (diff == 0)
+            {
+                if (m_popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_popPos.load(std::memory_order_relaxed);
+        }
+
+        value = std::move(cell->value);
+        // cell is free for the next lap
+        cell->sequence.store(pos + m_capacity, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static size_t roundCapacity(int capacity)
+    {
+        size_t result = 2;
+        while (result < size_t(capacity))
+            result <<= 1;
+        return result;
+    }
+
+    const size_t m_capacity;
+    const size_t m_mask;
+    std::unique_ptr<Cell[]> m_cells;
+
+    // producers and consumers work with different cache lines
+    alignas(64) std::atomic<size_t> m_pushPos;
+    alignas(64) std::atomic<size_t> m_popPos;
+};
+
+} // end namespace Qi
+
+#endif // QI_LOCK_FREE_QUEUE_H
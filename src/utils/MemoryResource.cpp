@@ -0,0 +1,106 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "MemoryResource.h"
+#include <cstdlib>
+
+namespace Qi
+{
+
+namespace
+{
+
+class MemoryResourceHeap: public MemoryResource
+{
+protected:
+    void* allocateImpl(size_t bytes, size_t alignment) override
+    {
+        // operator new aligns to max_align_t
+        Q_ASSERT(alignment <= alignof(std::max_align_t));
+        Q_UNUSED(alignment);
+        return ::operator new(bytes);
+    }
+
+    void deallocateImpl(void* p, size_t /*bytes*/, size_t /*alignment*/) override
+    {
+        ::operator delete(p);
+    }
+};
+
+} // end anonymous namespace
+
+MemoryResource::~MemoryResource()
+{
+}
+
+MemoryResource* MemoryResource::heap()
+{
+    static MemoryResourceHeap resource;
+    return &resource;
+}
+
+MemoryArena::MemoryArena(size_t blockSize, MemoryResource* upstream)
+    : m_blockSize(blockSize),
+      m_upstream(upstream),
+      m_current(nullptr),
+      m_available(0),
+      m_reservedBytes(0)
+{
+    Q_ASSERT(m_blockSize > 0);
+    Q_ASSERT(m_upstream);
+}
+
+MemoryArena::~MemoryArena()
+{
+    release();
+}
+
+void MemoryArena::release()
+{
+    for (const auto& block : m_blocks)
+        m_upstream->deallocate(block.memory, block.size, alignof(std::max_align_t));
+
+    m_blocks.clear();
+    m_current = nullptr;
+    m_available = 0;
+    m_reservedBytes = 0;
+}
+
+void* MemoryArena::allocateImpl(size_t bytes, size_t alignment)
+{
+    size_t padding = m_current ? (alignment - reinterpret_cast<quintptr>(m_current) % alignment) % alignment : 0;
+    if (!m_current || padding + bytes > m_available)
+    {
+        // large allocations take their own block
+        Block block;
+        block.size = qMax(m_blockSize, bytes + alignment);
+        block.memory = m_upstream->allocate(block.size, alignof(std::max_align_t));
+        m_blocks.append(block);
+        m_reservedBytes += qint64(block.size);
+
+        m_current = static_cast<char*>(block.memory);
+        m_available = block.size;
+        padding = (alignment - reinterpret_cast<quintptr>(m_current) % alignment) % alignment;
+    }
+
+    void* result = m_current + padding;
+    m_current += padding + bytes;
+    m_available -= padding + bytes;
+    return result;
+}
+
+} // end namespace Qi
@@ -0,0 +1,117 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_MEMORY_RESOURCE_H
+#define QI_MEMORY_RESOURCE_H
+
+#include "QiAPI.h"
+#include <QVector>
+#include <cstddef>
+#include <new>
+
+namespace Qi
+{
+
+// source of memory for storage models like std::pmr::memory_resource,
+// subclasses may take it from arenas or huge pages
+class QI_EXPORT MemoryResource
+{
+    Q_DISABLE_COPY(MemoryResource)
+
+public:
+    MemoryResource() {}
+    virtual ~MemoryResource();
+
+    void* allocate(size_t bytes, size_t alignment) { return allocateImpl(bytes, alignment); }
+    void deallocate(void* p, size_t bytes, size_t alignment) { deallocateImpl(p, bytes, alignment); }
+
+    // global heap resource
+    static MemoryResource* heap();
+
+protected:
+    virtual void* allocateImpl(size_t bytes, size_t alignment) = 0;
+    virtual void deallocateImpl(void* p, size_t bytes, size_t alignment) = 0;
+};
+
+// takes memory from large blocks of the upstream resource
+// and releases it at once on destruction or release,
+// for storages which are filled once and dropped together
+class QI_EXPORT MemoryArena: public MemoryResource
+{
+    Q_DISABLE_COPY(MemoryArena)
+
+public:
+    explicit MemoryArena(size_t blockSize = 1 << 20, MemoryResource* upstream = MemoryResource::heap());
+    ~MemoryArena();
+
+    // releases all allocated memory, allocations should not be used anymore
+    void release();
+    // bytes taken from upstream
+    qint64 reservedBytes() const { return m_reservedBytes; }
+
+protected:
+    void* allocateImpl(size_t bytes, size_t alignment) override;
+    // memory is reused after release only
+    void deallocateImpl(void* /*p*/, size_t /*bytes*/, size_t /*alignment*/) override {}
+
+private:
+    struct Block
+    {
+        void* memory;
+        size_t size;
+    };
+
+    size_t m_blockSize;
+    MemoryResource* m_upstream;
+    QVector<Block> m_blocks;
+    char* m_current;
+    size_t m_available;
+    qint64 m_reservedBytes;
+};
+
+// standard allocator over MemoryResource for containers of storage models
+template <typename T>
+class ResourceAllocator
+{
+public:
+    typedef T value_type;
+
+    ResourceAllocator() noexcept : m_resource(MemoryResource::heap()) {}
+    ResourceAllocator(MemoryResource* resource) noexcept : m_resource(resource) { Q_ASSERT(m_resource); }
+    template <typename U>
+    ResourceAllocator(const ResourceAllocator<U>& other) noexcept : m_resource(other.resource()) {}
+
+    MemoryResource* resource() const { return m_resource; }
+
+    T* allocate(size_t n) { return static_cast<T*>(m_resource->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T* p, size_t n) { m_resource->deallocate(p, n * sizeof(T), alignof(T)); }
+
+    // copied containers keep resource of their source
+    ResourceAllocator select_on_container_copy_construction() const { return *this; }
+
+    template <typename U>
+    bool operator==(const ResourceAllocator<U>& other) const { return m_resource == other.resource(); }
+    template <typename U>
+    bool operator!=(const ResourceAllocator<U>& other) const { return m_resource != other.resource(); }
+
+private:
+    MemoryResource* m_resource;
+};
+
+} // end namespace Qi
+
+#endif // QI_MEMORY_RESOURCE_H
@@ -0,0 +1,187 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "MemoryUsage.h"
+#include "CallLater.h"
+#include "TextWidthCache.h"
+#include <algorithm>
+
+namespace Qi
+{
+
+qint64 MemoryUsage::total() const
+{
+    qint64 result = 0;
+    for (const auto& part : m_parts)
+        result += part.bytes;
+    return result;
+}
+
+void MemoryUsage::add(const QString& name, qint64 bytes)
+{
+    for (auto& part : m_parts)
+    {
+        if (part.name == name)
+        {
+            part.bytes += bytes;
+            return;
+        }
+    }
+
+    Part part;
+    part.name = name;
+    part.bytes = bytes;
+    m_parts.append(part);
+}
+
+void MemoryUsage::add(const QString& prefix, const MemoryUsage& usage)
+{
+    for (const auto& part : usage.parts())
+        add(prefix + QLatin1Char('.') + part.name, part.bytes);
+}
+
+QString MemoryUsage::toString() const
+{
+    QString result;
+    for (const auto& part : m_parts)
+        result += QString("%1: %2\n").arg(part.name).arg(part.bytes);
+    return result;
+}
+
+MemoryBudget::MemoryBudget()
+    : m_budget(0)
+{
+    // text widths of this thread
+    addCache(this, "TextWidthCache", []() {
+        return TextWidthCache::instance().memoryUsage().total();
+    }, [](qint64 /*bytes*/) {
+        TextWidthCache::instance().clear();
+    });
+}
+
+MemoryBudget::~MemoryBudget()
+{
+    for (const auto& cache : m_caches)
+    {
+        if (cache.owner != this)
+            disconnect(cache.owner, &QObject::destroyed, this, nullptr);
+    }
+}
+
+MemoryBudget& MemoryBudget::instance()
+{
+    static MemoryBudget budget;
+    return budget;
+}
+
+void MemoryBudget::setBudget(qint64 budget)
+{
+    Q_ASSERT(budget >= 0);
+    if (m_budget == budget)
+        return;
+
+    m_budget = budget;
+    trimLater();
+}
+
+void MemoryBudget::addCache(QObject* owner, const QString& name, std::function<qint64()> usage, std::function<void(qint64)> trim)
+{
+    Q_ASSERT(owner);
+    Q_ASSERT(usage);
+    Q_ASSERT(trim);
+
+    bool isConnected = std::any_of(m_caches.begin(), m_caches.end(), [owner](const Cache& cache) {
+        return cache.owner == owner;
+    });
+    if (!isConnected && owner != this)
+        connect(owner, &QObject::destroyed, this, [this, owner]() { removeCaches(owner); });
+
+    Cache cache;
+    cache.owner = owner;
+    cache.name = name;
+    cache.usage = std::move(usage);
+    cache.trim = std::move(trim);
+    m_caches.append(cache);
+}
+
+void MemoryBudget::removeCaches(QObject* owner)
+{
+    auto it = std::remove_if(m_caches.begin(), m_caches.end(), [owner](const Cache& cache) {
+        return cache.owner == owner;
+    });
+    if (it == m_caches.end())
+        return;
+
+    m_caches.erase(it, m_caches.end());
+    if (owner != this)
+        disconnect(owner, &QObject::destroyed, this, nullptr);
+}
+
+MemoryUsage MemoryBudget::usage() const
+{
+    MemoryUsage result;
+    for (const auto& cache : m_caches)
+        result.add(cache.name, cache.usage());
+    return result;
+}
+
+qint64 MemoryBudget::trim()
+{
+    if (m_budget <= 0)
+        return 0;
+
+    QVector<QPair<qint64, int>> usages;
+    qint64 total = 0;
+    for (int i = 0; i < m_caches.size(); ++i)
+    {
+        qint64 bytes = m_caches[i].usage();
+        usages.append(qMakePair(bytes, i));
+        total += bytes;
+    }
+
+    if (total <= m_budget)
+        return 0;
+
+    std::sort(usages.begin(), usages.end(), [](const QPair<qint64, int>& left, const QPair<qint64, int>& right) {
+        return left.first > right.first;
+    });
+
+    qint64 freed = 0;
+    for (const auto& usage : usages)
+    {
+        if (total - freed <= m_budget)
+            break;
+
+        // callbacks may remove caches, so caches are copied
+        if (usage.second >= m_caches.size())
+            break;
+        Cache cache = m_caches[usage.second];
+        cache.trim(total - freed - m_budget);
+        freed += usage.first - cache.usage();
+    }
+
+    emit trimmed(this, freed);
+    return freed;
+}
+
+void MemoryBudget::trimLater()
+{
+    if (m_budget > 0)
+        callLaterOnce(this, "trim", [this]() { trim(); });
+}
+
+} // end namespace Qi
@@ -0,0 +1,118 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_MEMORY_USAGE_H
+#define QI_MEMORY_USAGE_H
+
+#include "QiAPI.h"
+#include <QObject>
+#include <QVector>
+#include <QString>
+#include <QHash>
+#include <QMap>
+#include <functional>
+#include <vector>
+
+namespace Qi
+{
+
+// approximate heap memory in bytes by named parts
+// containers are counted by capacity and size of elements without their own heap data
+// models report memory of their values, heap data of values is not counted
+class QI_EXPORT MemoryUsage
+{
+public:
+    struct Part
+    {
+        QString name;
+        qint64 bytes;
+    };
+
+    const QVector<Part>& parts() const { return m_parts; }
+    qint64 total() const;
+
+    // bytes of parts with the same name are summed
+    void add(const QString& name, qint64 bytes);
+    // adds parts of usage with "prefix." names
+    void add(const QString& prefix, const MemoryUsage& usage);
+
+    // one "name: bytes" line per part
+    QString toString() const;
+
+    template <typename T>
+    static qint64 bytes(const QVector<T>& vector) { return qint64(vector.capacity()) * sizeof(T); }
+    template <typename T, typename A>
+    static qint64 bytes(const std::vector<T, A>& vector) { return qint64(vector.capacity()) * sizeof(T); }
+    template <typename K, typename V>
+    static qint64 bytes(const QHash<K, V>& hash) { return qint64(hash.capacity()) * sizeof(void*) + qint64(hash.size()) * (sizeof(K) + sizeof(V) + 2 * sizeof(void*)); }
+    template <typename K, typename V>
+    static qint64 bytes(const QMap<K, V>& map) { return qint64(map.size()) * (sizeof(K) + sizeof(V) + 3 * sizeof(void*)); }
+    static qint64 bytes(const QString& text) { return qint64(text.capacity()) * sizeof(QChar); }
+
+private:
+    QVector<Part> m_parts;
+};
+
+// trims registered caches when their total memory usage exceeds the budget
+// caches with the largest usage are trimmed first, only GUI thread caches should be registered
+class QI_EXPORT MemoryBudget: public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(MemoryBudget)
+
+public:
+    MemoryBudget();
+    ~MemoryBudget();
+
+    // budget of caches in GUI thread, it trims text widths cache of its thread too
+    static MemoryBudget& instance();
+
+    // budget in bytes, 0 means unlimited
+    qint64 budget() const { return m_budget; }
+    void setBudget(qint64 budget);
+
+    // usage returns bytes of cache, trim should free about given bytes if it can
+    // caches are removed when owner is destroyed
+    void addCache(QObject* owner, const QString& name, std::function<qint64()> usage, std::function<void(qint64 bytes)> trim);
+    void removeCaches(QObject* owner);
+
+    MemoryUsage usage() const;
+
+    // trims caches down to the budget, returns freed bytes
+    qint64 trim();
+    // trims on the next event loop turn, caches call it when they grow
+    void trimLater();
+
+signals:
+    void trimmed(const MemoryBudget*, qint64 freedBytes);
+
+private:
+    struct Cache
+    {
+        QObject* owner;
+        QString name;
+        std::function<qint64()> usage;
+        std::function<void(qint64)> trim;
+    };
+
+    qint64 m_budget;
+    QVector<Cache> m_caches;
+};
+
+} // end namespace Qi
+
+#endif // QI_MEMORY_USAGE_H
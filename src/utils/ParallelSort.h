@@ -0,0 +1,138 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_PARALLEL_SORT_H
+#define QI_PARALLEL_SORT_H
+
+#include "QiAPI.h"
+#include "TaskPool.h"
+#include <QVector>
+#include <algorithm>
+#include <functional>
+
+namespace Qi
+{
+
+// minimal chunk size which is worth sorting in a separate thread
+static const int ParallelSortMinChunkSize = 16384;
+
+// stable parallel merge sort
+// chunks are sorted in TaskPool workers and then merged pairwise
+// pred is copied for each chunk so it may have internal state
+template <typename Iterator, typename Pred>
+void parallelStableSort(Iterator begin, Iterator end, const Pred& pred)
+{
+    const int size = int(end - begin);
+    const int chunks = qMin(TaskPool::instance().threadsCount(), size / ParallelSortMinChunkSize);
+
+    if (chunks < 2)
+    {
+        Pred chunkPred(pred);
+        std::stable_sort(begin, end, chunkPred);
+        return;
+    }
+
+    QVector<Iterator> bounds(chunks + 1);
+    for (int i = 0; i < chunks; ++i)
+        bounds[i] = begin + (qint64(size) * i) / chunks;
+    bounds[chunks] = end;
+
+    {
+        TaskGroup group;
+        for (int i = 0; i < chunks; ++i)
+        {
+            Iterator chunkBegin = bounds[i];
+            Iterator chunkEnd = bounds[i + 1];
+            group.run([chunkBegin, chunkEnd, &pred]() {
+                Pred chunkPred(pred);
+                std::stable_sort(chunkBegin, chunkEnd, chunkPred);
+            });
+        }
+        group.wait();
+    }
+
+    // merge sorted chunks level by level
+    for (int step = 1; step < chunks; step *= 2)
+    {
+        TaskGroup group;
+        for (int i = 0; i + step < chunks; i += 2 * step)
+        {
+            Iterator first = bounds[i];
+            Iterator middle = bounds[i + step];
+            Iterator last = bounds[qMin(i + 2 * step, chunks)];
+            group.run([first, middle, last, &pred]() {
+                Pred chunkPred(pred);
+                std::inplace_merge(first, middle, last, chunkPred);
+            });
+        }
+        group.wait();
+    }
+}
+
+// chunks count for progressive sort
+static const int ProgressiveSortChunks = 16;
+
+// stable merge sort which reports progress between steps
+// progress receives percents done and returns false to cancel sorting
+// returns false if sorting was cancelled, range is left unsorted then
+template <typename Iterator, typename Pred>
+bool stableSortProgressive(Iterator begin, Iterator end, const Pred& pred, const std::function<bool(int)>& progress)
+{
+    if (!progress)
+    {
+        std::stable_sort(begin, end, pred);
+        return true;
+    }
+
+    const int size = int(end - begin);
+    const int chunks = qBound(1, size / ParallelSortMinChunkSize, ProgressiveSortChunks);
+
+    QVector<Iterator> bounds(chunks + 1);
+    for (int i = 0; i < chunks; ++i)
+        bounds[i] = begin + (qint64(size) * i) / chunks;
+    bounds[chunks] = end;
+
+    // each chunk sort and each merge is a step
+    const int steps = 2 * chunks - 1;
+    int step = 0;
+
+    if (!progress(0))
+        return false;
+
+    for (int i = 0; i < chunks; ++i)
+    {
+        std::stable_sort(bounds[i], bounds[i + 1], pred);
+        if (!progress((++step * 100) / steps))
+            return false;
+    }
+
+    for (int width = 1; width < chunks; width *= 2)
+    {
+        for (int i = 0; i + width < chunks; i += 2 * width)
+        {
+            std::inplace_merge(bounds[i], bounds[i + width], bounds[qMin(i + 2 * width, chunks)], pred);
+            if (!progress((++step * 100) / steps))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+} // end namespace Qi
+
+#endif // QI_PARALLEL_SORT_H
@@ -0,0 +1,122 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_RADIX_SORT_H
+#define QI_RADIX_SORT_H
+
+#include "QiAPI.h"
+#include <vector>
+#include <cstring>
+#include <type_traits>
+#include <functional>
+
+namespace Qi
+{
+
+namespace Private
+{
+    // maps numeric value to unsigned code with the same order
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, quint64>::type radixCode(T value)
+    {
+        return quint64(qint64(value)) ^ (quint64(1) << 63);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, quint64>::type radixCode(T value)
+    {
+        return quint64(value);
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_floating_point<T>::value, quint64>::type radixCode(T value)
+    {
+        // -0.0 and 0.0 are equal
+        double d = (value == 0) ? 0.0 : double(value);
+        quint64 bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        // negative values - flip all bits, positive values - flip sign bit
+        return (bits & (quint64(1) << 63)) ? ~bits : (bits ^ (quint64(1) << 63));
+    }
+}
+
+// minimal keys count to prefer radix sort over comparison sort
+static const int RadixSortMinSize = 256;
+
+// stable LSD radix sort of (numeric key, line) pairs by keys
+// progress receives percents done and returns false to cancel sorting
+// returns false if sorting was cancelled, keys are left unchanged then
+template <typename T>
+bool radixSortKeys(std::vector<std::pair<T, int>>& keys, bool ascending, const std::function<bool(int)>& progress = nullptr)
+{
+    static_assert(std::is_arithmetic<T>::value, "T should be numeric.");
+
+    typedef std::pair<quint64, int> Code;
+    const int size = int(keys.size());
+
+    std::vector<Code> codes(size);
+    for (int i = 0; i < size; ++i)
+    {
+        quint64 code = Private::radixCode(keys[i].first);
+        // descending order is ascending order of inverted codes, stability is kept
+        codes[i] = Code(ascending ? code : ~code, i);
+    }
+
+    std::vector<Code> buffer(size);
+    for (int shift = 0; shift < 64; shift += 8)
+    {
+        if (progress && !progress((shift * 100) / 64))
+            return false;
+
+        int counts[256] = {0};
+        for (const auto& code: codes)
+            ++counts[(code.first >> shift) & 0xFF];
+
+        // all codes have the same byte
+        if (counts[(codes.front().first >> shift) & 0xFF] == size)
+            continue;
+
+        int offset = 0;
+        for (auto& count: counts)
+        {
+            int c = count;
+            count = offset;
+            offset += c;
+        }
+
+        for (const auto& code: codes)
+            buffer[counts[(code.first >> shift) & 0xFF]++] = code;
+
+        codes.swap(buffer);
+    }
+
+    std::vector<std::pair<T, int>> sortedKeys;
+    sortedKeys.reserve(size);
+    for (const auto& code: codes)
+        sortedKeys.push_back(keys[code.second]);
+
+    keys.swap(sortedKeys);
+
+    if (progress)
+        progress(100);
+
+    return true;
+}
+
+} // end namespace Qi
+
+#endif // QI_RADIX_SORT_H
@@ -0,0 +1,134 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "SparseBitVector.h"
+#include <algorithm>
+
+namespace Qi
+{
+
+static const quint64 AllBits = ~quint64(0);
+
+SparseBitVector::SparseBitVector()
+    : m_default(false),
+      m_inverted(false)
+{
+}
+
+bool SparseBitVector::value(int index) const
+{
+    Q_ASSERT(index >= 0);
+
+    bool raw = m_default;
+    auto it = m_chunks.find(index >> ChunkShift);
+    if (it != m_chunks.end())
+    {
+        const auto& words = it.value();
+        if (words.isEmpty())
+            raw = !m_default;
+        else
+        {
+            int bit = index & (ChunkSize - 1);
+            raw = (words[bit >> 6] >> (bit & 63)) & 1;
+        }
+    }
+
+    return raw != m_inverted;
+}
+
+void SparseBitVector::setValues(int begin, int end, bool value)
+{
+    Q_ASSERT(begin >= 0 && begin <= end);
+    if (begin == end)
+        return;
+
+    bool raw = (value != m_inverted);
+
+    for (int chunk = begin >> ChunkShift; chunk <= ((end - 1) >> ChunkShift); ++chunk)
+    {
+        qint64 chunkBegin = qint64(chunk) << ChunkShift;
+        int first = int(qMax<qint64>(begin, chunkBegin) - chunkBegin);
+        int last = int(qMin<qint64>(end, chunkBegin + ChunkSize) - chunkBegin);
+
+        auto it = m_chunks.find(chunk);
+
+        if (first == 0 && last == ChunkSize)
+        {
+            // whole chunk
+            if (raw == m_default)
+            {
+                if (it != m_chunks.end())
+                    m_chunks.erase(it);
+            }
+            else
+            {
+                m_chunks[chunk] = QVector<quint64>();
+            }
+            continue;
+        }
+
+        if (it == m_chunks.end())
+        {
+            if (raw == m_default)
+                continue;
+            it = m_chunks.insert(chunk, QVector<quint64>(ChunkWords, m_default ? AllBits : 0));
+        }
+        else if (it.value().isEmpty())
+        {
+            if (raw != m_default)
+                continue;
+            it.value() = QVector<quint64>(ChunkWords, m_default ? 0 : AllBits);
+        }
+
+        auto& words = it.value();
+        for (int bit = first; bit < last;)
+        {
+            int count = qMin(64 - (bit & 63), last - bit);
+            quint64 mask = (count == 64) ? AllBits : (((quint64(1) << count) - 1) << (bit & 63));
+            if (raw)
+                words[bit >> 6] |= mask;
+            else
+                words[bit >> 6] &= ~mask;
+            bit += count;
+        }
+
+        // drop chunk if all bits are equal
+        quint64 word = words.front();
+        if (word != 0 && word != AllBits)
+            continue;
+        if (std::any_of(words.begin(), words.end(), [word](quint64 w) { return w != word; }))
+            continue;
+
+        if ((word == AllBits) == m_default)
+            m_chunks.erase(it);
+        else
+            words.clear();
+    }
+}
+
+void SparseBitVector::fill(bool value)
+{
+    m_chunks.clear();
+    m_default = value;
+    m_inverted = false;
+}
+
+void SparseBitVector::invert()
+{
+    m_inverted = !m_inverted;
+}
+
+} // end namespace Qi
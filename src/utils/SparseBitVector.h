@@ -0,0 +1,64 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_SPARSE_BIT_VECTOR_H
+#define QI_SPARSE_BIT_VECTOR_H
+
+#include "QiAPI.h"
+#include <QMap>
+#include <QVector>
+
+namespace Qi
+{
+
+// unbounded bits storage split into chunks of 64K bits,
+// chunks with all bits equal are not allocated,
+// fill and invert are O(1)
+class QI_EXPORT SparseBitVector
+{
+public:
+    SparseBitVector();
+
+    bool value(int index) const;
+    void setValue(int index, bool value) { setValues(index, index + 1, value); }
+    // sets bits in [begin, end)
+    void setValues(int begin, int end, bool value);
+
+    void fill(bool value);
+    void invert();
+
+    // returns true if all bits equal value
+    bool isAll(bool value) const { return m_chunks.isEmpty() && (m_default != m_inverted) == value; }
+
+private:
+    enum
+    {
+        ChunkShift = 16,
+        ChunkSize = 1 << ChunkShift,
+        ChunkWords = ChunkSize / 64
+    };
+
+    // absent chunk has all raw bits equal m_default,
+    // chunk without words has all raw bits equal !m_default
+    QMap<int, QVector<quint64>> m_chunks;
+    bool m_default;
+    // stored raw bits are inverted
+    bool m_inverted;
+};
+
+} // end namespace Qi
+
+#endif // QI_SPARSE_BIT_VECTOR_H
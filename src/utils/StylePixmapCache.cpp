@@ -0,0 +1,60 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "StylePixmapCache.h"
+#include <QPainter>
+#include <QPixmap>
+#include <QPixmapCache>
+
+namespace Qi
+{
+
+void drawStyleCached(const QStyle* style, QPainter* painter, const QStyleOption& option, const QString& elementKey,
+                     const std::function<void(QPainter* painter, const QRect& rect)>& render)
+{
+    if (option.rect.isEmpty())
+        return;
+
+    qreal pixelRatio = painter->device() ? painter->device()->devicePixelRatioF() : 1.;
+    const QSize& size = option.rect.size();
+
+    QString key = QString("qi_style_%1_%2_%3_%4x%5_%6_%7_%8")
+            .arg(quintptr(style))
+            .arg(elementKey)
+            .arg(uint(option.state))
+            .arg(size.width()).arg(size.height())
+            .arg(pixelRatio)
+            .arg(option.palette.cacheKey())
+            .arg(int(option.direction));
+
+    QPixmap pixmap;
+    if (!QPixmapCache::find(key, &pixmap))
+    {
+        pixmap = QPixmap(size * pixelRatio);
+        pixmap.setDevicePixelRatio(pixelRatio);
+        pixmap.fill(Qt::transparent);
+
+        QPainter pixmapPainter(&pixmap);
+        render(&pixmapPainter, QRect(QPoint(0, 0), size));
+        pixmapPainter.end();
+
+        QPixmapCache::insert(key, pixmap);
+    }
+
+    painter->drawPixmap(option.rect.topLeft(), pixmap);
+}
+
+} // end namespace Qi
@@ -0,0 +1,67 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_STYLE_PIXMAP_CACHE_H
+#define QI_STYLE_PIXMAP_CACHE_H
+
+#include "QiAPI.h"
+#include <QStyle>
+#include <QStyleOption>
+#include <functional>
+
+class QPainter;
+
+namespace Qi
+{
+
+// draws style element through pixmap kept in QPixmapCache
+// pixmap is keyed by style, element, state, size, palette, direction and device pixel ratio
+// elementKey should identify the element and option fields affecting drawing besides these
+// render should draw the element into painter within rect
+QI_EXPORT void drawStyleCached(const QStyle* style, QPainter* painter, const QStyleOption& option, const QString& elementKey,
+                               const std::function<void(QPainter* painter, const QRect& rect)>& render);
+
+// cached versions of QStyle::drawPrimitive and QStyle::drawControl
+// style animations are not applied to cached pixmaps
+template <typename Option>
+void drawStylePrimitiveCached(const QStyle* style, QStyle::PrimitiveElement element, const Option& option,
+                              QPainter* painter, const QWidget* widget, const QString& elementKey = QString())
+{
+    drawStyleCached(style, painter, option, QString("p%1_%2").arg(int(element)).arg(elementKey),
+                    [style, element, &option, widget](QPainter* pixmapPainter, const QRect& rect) {
+        Option pixmapOption(option);
+        pixmapOption.rect = rect;
+        pixmapOption.styleObject = nullptr;
+        style->drawPrimitive(element, &pixmapOption, pixmapPainter, widget);
+    });
+}
+
+template <typename Option>
+void drawStyleControlCached(const QStyle* style, QStyle::ControlElement element, const Option& option,
+                            QPainter* painter, const QWidget* widget, const QString& elementKey = QString())
+{
+    drawStyleCached(style, painter, option, QString("c%1_%2").arg(int(element)).arg(elementKey),
+                    [style, element, &option, widget](QPainter* pixmapPainter, const QRect& rect) {
+        Option pixmapOption(option);
+        pixmapOption.rect = rect;
+        pixmapOption.styleObject = nullptr;
+        style->drawControl(element, &pixmapOption, pixmapPainter, widget);
+    });
+}
+
+} // end namespace Qi
+
+#endif // QI_STYLE_PIXMAP_CACHE_H
@@ -0,0 +1,396 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "TaskPool.h"
+#include <QCoreApplication>
+#include <QEvent>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <deque>
+
+namespace Qi
+{
+
+TaskToken::TaskToken()
+    : m_cancelled(makeShared<std::atomic<bool>>(false))
+{
+}
+
+struct TaskPool::Task
+{
+    std::function<void()> function;
+    TaskToken token;
+};
+
+struct TaskPool::Queue
+{
+    QMutex mutex;
+    std::deque<Task> tasks[TaskPrioritiesCount];
+};
+
+struct TaskPool::Sleep
+{
+    QMutex mutex;
+    QWaitCondition wakeup;
+};
+
+class TaskPool::Worker: public QThread
+{
+public:
+    Worker(TaskPool* pool, int index)
+        : m_pool(pool),
+          m_index(index)
+    {
+    }
+
+    TaskPool* pool() const { return m_pool; }
+    int index() const { return m_index; }
+
+protected:
+    void run() override { m_pool->workerLoop(m_index); }
+
+private:
+    TaskPool* m_pool;
+    int m_index;
+};
+
+// receives continuation in owner's thread, dies with owner
+class TaskContinuation: public QObject
+{
+public:
+    static const QEvent::Type EventType = QEvent::Type(QEvent::User + 3);
+
+    // worker posts to receiver while it's alive
+    struct Link
+    {
+        QMutex mutex;
+        TaskContinuation* receiver;
+    };
+
+    TaskContinuation(QObject* owner, const TaskToken& token, std::function<void()> continuation)
+        : QObject(owner),
+          m_token(token),
+          m_continuation(std::move(continuation)),
+          m_link(makeShared<Link>())
+    {
+        m_link->receiver = this;
+    }
+
+    ~TaskContinuation()
+    {
+        // owner is destroyed or continuation is done
+        m_token.cancel();
+
+        QMutexLocker locker(&m_link->mutex);
+        m_link->receiver = nullptr;
+    }
+
+    const SharedPtr<Link>& link() const { return m_link; }
+
+    static void post(const SharedPtr<Link>& link)
+    {
+        QMutexLocker locker(&link->mutex);
+        if (link->receiver)
+            QCoreApplication::postEvent(link->receiver, new QEvent(EventType));
+    }
+
+    bool event(QEvent* event) override
+    {
+        if (event->type() != EventType)
+            return QObject::event(event);
+
+        if (!m_token.isCancelled() && m_continuation)
+            m_continuation();
+
+        deleteLater();
+        return true;
+    }
+
+private:
+    TaskToken m_token;
+    std::function<void()> m_continuation;
+    SharedPtr<Link> m_link;
+};
+
+TaskPool::TaskPool(int threadsCount)
+    : m_pendingCount(0),
+      m_nextQueue(0),
+      m_isStopping(false),
+      m_sleep(new Sleep())
+{
+    if (threadsCount <= 0)
+        threadsCount = qMax(1, QThread::idealThreadCount());
+
+    for (int i = 0; i < threadsCount; ++i)
+        m_queues.append(new Queue());
+
+    for (int i = 0; i < threadsCount; ++i)
+    {
+        auto worker = new Worker(this, i);
+        m_workers.append(worker);
+        worker->start();
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        QMutexLocker locker(&m_sleep->mutex);
+        m_isStopping = true;
+        m_sleep->wakeup.wakeAll();
+    }
+
+    for (auto worker : m_workers)
+    {
+        worker->wait();
+        delete worker;
+    }
+
+    qDeleteAll(m_queues);
+}
+
+TaskPool& TaskPool::instance()
+{
+    static TaskPool pool;
+    return pool;
+}
+
+void TaskPool::run(std::function<void()> task, TaskPriority priority, TaskToken token)
+{
+    Q_ASSERT(task);
+    Q_ASSERT(priority >= 0 && priority < TaskPrioritiesCount);
+
+    Task poolTask;
+    poolTask.function = std::move(task);
+    poolTask.token = std::move(token);
+    push(std::move(poolTask), priority);
+}
+
+void TaskPool::run(QObject* owner, std::function<void()> task, std::function<void()> continuation, TaskPriority priority, TaskToken token)
+{
+    Q_ASSERT(owner);
+    Q_ASSERT(task);
+    Q_ASSERT(owner->thread() == QThread::currentThread());
+
+    auto receiver = new TaskContinuation(owner, token, std::move(continuation));
+
+    // receiver is destroyed with owner, so posted event is dropped
+    auto link = receiver->link();
+    run([task, token, link]() {
+        if (!token.isCancelled())
+            task();
+        // receiver of cancelled task is deleted too
+        TaskContinuation::post(link);
+    }, priority);
+}
+
+void TaskPool::parallelFor(int begin, int end, int chunkSize, const std::function<void(int, int)>& task, TaskPriority priority)
+{
+    Q_ASSERT(task);
+    Q_ASSERT(chunkSize > 0);
+
+    if (begin >= end)
+        return;
+
+    if (end - begin <= chunkSize)
+    {
+        task(begin, end);
+        return;
+    }
+
+    TaskGroup group(priority, *this);
+    for (int chunkBegin = begin + chunkSize; chunkBegin < end; chunkBegin += chunkSize)
+    {
+        int chunkEnd = qMin(end, chunkBegin + chunkSize);
+        group.run([&task, chunkBegin, chunkEnd]() { task(chunkBegin, chunkEnd); });
+    }
+
+    // first chunk in calling thread
+    task(begin, qMin(end, begin + chunkSize));
+    group.wait();
+}
+
+void TaskPool::push(Task task, TaskPriority priority)
+{
+    int workerIndex = currentWorkerIndex();
+    if (workerIndex >= 0)
+    {
+        // own queue keeps cache of worker warm
+        QMutexLocker locker(&m_queues[workerIndex]->mutex);
+        m_queues[workerIndex]->tasks[priority].push_front(std::move(task));
+    }
+    else
+    {
+        Queue* queue = m_queues[m_nextQueue++ % unsigned(m_queues.size())];
+        QMutexLocker locker(&queue->mutex);
+        queue->tasks[priority].push_back(std::move(task));
+    }
+
+    ++m_pendingCount;
+
+    QMutexLocker locker(&m_sleep->mutex);
+    m_sleep->wakeup.wakeOne();
+}
+
+bool TaskPool::take(int workerIndex, Task& task)
+{
+    if (m_pendingCount.load() == 0)
+        return false;
+
+    const int queuesCount = m_queues.size();
+    for (int priority = 0; priority < TaskPrioritiesCount; ++priority)
+    {
+        // own tasks first
+        if (workerIndex >= 0)
+        {
+            Queue* queue = m_queues[workerIndex];
+            QMutexLocker locker(&queue->mutex);
+            auto& tasks = queue->tasks[priority];
+            if (!tasks.empty())
+            {
+                task = std::move(tasks.front());
+                tasks.pop_front();
+                --m_pendingCount;
+                return true;
+            }
+        }
+
+        // steal the oldest task of other queues
+        for (int i = 1; i <= queuesCount; ++i)
+        {
+            int index = (qMax(workerIndex, 0) + i) % queuesCount;
+            if (index == workerIndex)
+                continue;
+
+            Queue* queue = m_queues[index];
+            QMutexLocker locker(&queue->mutex);
+            auto& tasks = queue->tasks[priority];
+            if (!tasks.empty())
+            {
+                task = std::move(tasks.back());
+                tasks.pop_back();
+                --m_pendingCount;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void TaskPool::workerLoop(int workerIndex)
+{
+    while (!m_isStopping)
+    {
+        Task task;
+        if (take(workerIndex, task))
+        {
+            if (!task.token.isCancelled())
+                task.function();
+            continue;
+        }
+
+        QMutexLocker locker(&m_sleep->mutex);
+        if (m_pendingCount.load() == 0 && !m_isStopping)
+            m_sleep->wakeup.wait(&m_sleep->mutex);
+    }
+}
+
+int TaskPool::currentWorkerIndex() const
+{
+    auto worker = dynamic_cast<Worker*>(QThread::currentThread());
+    return (worker && worker->pool() == this) ? worker->index() : -1;
+}
+
+struct TaskGroup::State
+{
+    QMutex mutex;
+    QWaitCondition finished;
+    // not started tasks
+    std::deque<std::function<void()>> tasks;
+    int pendingCount = 0;
+
+    // runs the oldest not started task, returns false if there are none
+    bool runTask()
+    {
+        std::function<void()> task;
+        {
+            QMutexLocker locker(&mutex);
+            if (tasks.empty())
+                return false;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+
+        QMutexLocker locker(&mutex);
+        if (--pendingCount == 0)
+            finished.wakeAll();
+        return true;
+    }
+};
+
+TaskGroup::TaskGroup(TaskPriority priority, TaskPool& pool)
+    : m_pool(pool),
+      m_priority(priority),
+      m_state(makeShared<State>())
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    cancel();
+}
+
+void TaskGroup::run(std::function<void()> task)
+{
+    Q_ASSERT(task);
+
+    {
+        QMutexLocker locker(&m_state->mutex);
+        m_state->tasks.push_back(std::move(task));
+        ++m_state->pendingCount;
+    }
+
+    // worker takes any not started task of the group, it may be done by waiting thread already
+    auto state = m_state;
+    m_pool.run([state]() { state->runTask(); }, m_priority);
+}
+
+void TaskGroup::wait()
+{
+    while (m_state->runTask())
+        ;
+
+    // rest tasks are running in workers
+    QMutexLocker locker(&m_state->mutex);
+    while (m_state->pendingCount > 0)
+        m_state->finished.wait(&m_state->mutex);
+}
+
+void TaskGroup::cancel()
+{
+    QMutexLocker locker(&m_state->mutex);
+    m_state->pendingCount -= int(m_state->tasks.size());
+    m_state->tasks.clear();
+    if (m_state->pendingCount == 0)
+        m_state->finished.wakeAll();
+}
+
+} // end namespace Qi
@@ -0,0 +1,131 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_TASK_POOL_H
+#define QI_TASK_POOL_H
+
+#include "QiAPI.h"
+#include <QVector>
+#include <QScopedPointer>
+#include <functional>
+#include <atomic>
+
+class QObject;
+
+namespace Qi
+{
+
+// tasks of higher priority are taken first by all workers
+enum TaskPriority
+{
+    // work for items visible on screen
+    TaskPriorityVisible = 0,
+    TaskPriorityNormal,
+    // prefetching, indexing and other work nobody waits for
+    TaskPriorityBackground,
+    TaskPrioritiesCount
+};
+
+// cooperative cancellation flag, copies share the flag
+class QI_EXPORT TaskToken
+{
+public:
+    TaskToken();
+
+    bool isCancelled() const { return m_cancelled->load(std::memory_order_relaxed); }
+    void cancel() { m_cancelled->store(true, std::memory_order_relaxed); }
+
+private:
+    SharedPtr<std::atomic<bool>> m_cancelled;
+};
+
+// worker threads with work-stealing queues shared by background features of the library
+// tasks submitted by a worker go to its own queue and are taken in LIFO order,
+// idle workers steal the oldest tasks of other queues
+class QI_EXPORT TaskPool
+{
+    Q_DISABLE_COPY(TaskPool)
+
+public:
+    explicit TaskPool(int threadsCount = 0);
+    // cancels pending tasks and waits for running ones
+    ~TaskPool();
+
+    // pool of ideal threads count shared by the library
+    static TaskPool& instance();
+
+    int threadsCount() const { return m_workers.size(); }
+
+    // task is skipped if token is cancelled before it starts
+    void run(std::function<void()> task, TaskPriority priority = TaskPriorityNormal, TaskToken token = TaskToken());
+
+    // runs task in worker and then continuation in owner's thread, should be called in owner's thread
+    // owner's destruction cancels token, task should check it to stop early
+    // continuation is not called if owner is destroyed or token is cancelled
+    void run(QObject* owner, std::function<void()> task, std::function<void()> continuation, TaskPriority priority = TaskPriorityNormal, TaskToken token = TaskToken());
+
+    // calls task(chunkBegin, chunkEnd) for chunks of [begin, end) and waits for all of them,
+    // calling thread executes chunks too, so it can be called from tasks
+    void parallelFor(int begin, int end, int chunkSize, const std::function<void(int chunkBegin, int chunkEnd)>& task, TaskPriority priority = TaskPriorityVisible);
+
+private:
+    struct Task;
+    struct Queue;
+    class Worker;
+
+    void push(Task task, TaskPriority priority);
+    bool take(int workerIndex, Task& task);
+    void workerLoop(int workerIndex);
+    int currentWorkerIndex() const;
+
+    QVector<Worker*> m_workers;
+    QVector<Queue*> m_queues;
+    std::atomic<int> m_pendingCount;
+    std::atomic<unsigned> m_nextQueue;
+    std::atomic<bool> m_isStopping;
+
+    struct Sleep;
+    QScopedPointer<Sleep> m_sleep;
+};
+
+// tasks waited together, waiting thread executes not started tasks of the group meanwhile,
+// so waiting never deadlocks and never runs unrelated tasks
+class QI_EXPORT TaskGroup
+{
+    Q_DISABLE_COPY(TaskGroup)
+
+public:
+    explicit TaskGroup(TaskPriority priority = TaskPriorityVisible, TaskPool& pool = TaskPool::instance());
+    // drops not started tasks, running ones are not waited
+    ~TaskGroup();
+
+    void run(std::function<void()> task);
+    void wait();
+    // drops not started tasks
+    void cancel();
+
+private:
+    struct State;
+
+    TaskPool& m_pool;
+    TaskPriority m_priority;
+    SharedPtr<State> m_state;
+};
+
+} // end namespace Qi
+
+#endif // QI_TASK_POOL_H
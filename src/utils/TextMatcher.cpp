@@ -0,0 +1,165 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "TextMatcher.h"
+#include <QtAlgorithms>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define QI_TEXT_MATCHER_SSE2
+    #include <emmintrin.h>
+#endif
+
+namespace Qi
+{
+
+TextMatcher::TextMatcher()
+    : m_cs(Qt::CaseSensitive),
+      m_firstCount(0)
+{
+    m_first[0] = m_first[1] = m_first[2] = 0;
+}
+
+TextMatcher::TextMatcher(const QString& pattern, Qt::CaseSensitivity cs)
+    : m_pattern(pattern),
+      m_cs(cs),
+      m_firstCount(0)
+{
+    m_first[0] = m_first[1] = m_first[2] = 0;
+
+    m_units.resize(m_pattern.size());
+    for (int i = 0; i < m_pattern.size(); ++i)
+    {
+        ushort unit = m_pattern.at(i).unicode();
+        m_units[i] = (m_cs == Qt::CaseSensitive) ? unit : foldCase(unit);
+    }
+
+    if (m_units.isEmpty())
+        return;
+
+    ushort first = m_units.first();
+    if (m_cs == Qt::CaseSensitive)
+    {
+        m_first[0] = m_first[1] = m_first[2] = first;
+        m_firstCount = 1;
+    }
+    else if (first < 128)
+    {
+        // ascii unit folds from its upper case and a few non ascii units
+        m_first[0] = m_first[1] = m_first[2] = first;
+        m_firstCount = 1;
+        if (first >= 'a' && first <= 'z')
+        {
+            m_first[1] = m_first[2] = ushort(first - ('a' - 'A'));
+            m_firstCount = 2;
+
+            const ushort special = (first == 'k') ? 0x212A   // kelvin sign
+                                 : (first == 's') ? 0x017F  // long s
+                                 : (first == 'i') ? 0x0130  // dotted capital i
+                                 : 0;
+            if (special)
+            {
+                m_first[2] = special;
+                m_firstCount = 3;
+            }
+        }
+    }
+}
+
+bool TextMatcher::isMatchedAt(const ushort* text) const
+{
+    const int size = m_units.size();
+    const ushort* units = m_units.constData();
+
+    if (m_cs == Qt::CaseSensitive)
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            if (text[i] != units[i])
+                return false;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            if (text[i] != units[i] && foldCase(text[i]) != units[i])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+int TextMatcher::indexIn(const QChar* text, int length) const
+{
+    const int size = m_units.size();
+    if (size == 0)
+        return 0;
+
+    // last position where occurrence may start
+    const int end = length - size + 1;
+    if (end <= 0)
+        return -1;
+
+    const ushort* units = reinterpret_cast<const ushort*>(text);
+    int pos = 0;
+
+    if (m_firstCount == 0)
+    {
+        for (; pos < end; ++pos)
+        {
+            if (isMatchedAt(units + pos))
+                return pos;
+        }
+        return -1;
+    }
+
+#if defined(QI_TEXT_MATCHER_SSE2)
+    // check 8 units at once for the first pattern unit
+    const __m128i first0 = _mm_set1_epi16(short(m_first[0]));
+    const __m128i first1 = _mm_set1_epi16(short(m_first[1]));
+    const __m128i first2 = _mm_set1_epi16(short(m_first[2]));
+    for (; pos + 8 <= length && pos < end; pos += 8)
+    {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(units + pos));
+        __m128i equal = _mm_or_si128(_mm_cmpeq_epi16(block, first0),
+                                     _mm_or_si128(_mm_cmpeq_epi16(block, first1), _mm_cmpeq_epi16(block, first2)));
+        uint mask = uint(_mm_movemask_epi8(equal));
+        while (mask)
+        {
+            // two mask bits per unit
+            int bit = int(qCountTrailingZeroBits(mask));
+            int candidate = pos + bit / 2;
+            if (candidate >= end)
+                return -1;
+            if (isMatchedAt(units + candidate))
+                return candidate;
+            mask &= ~(3u << bit);
+        }
+    }
+#endif
+
+    for (; pos < end; ++pos)
+    {
+        const ushort unit = units[pos];
+        if ((unit == m_first[0] || unit == m_first[1] || unit == m_first[2]) && isMatchedAt(units + pos))
+            return pos;
+    }
+
+    return -1;
+}
+
+} // end namespace Qi
@@ -0,0 +1,68 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_TEXT_MATCHER_H
+#define QI_TEXT_MATCHER_H
+
+#include "QiAPI.h"
+#include <QString>
+#include <QVector>
+
+namespace Qi
+{
+
+// substring search prepared once for a pattern and reused for many texts
+// case insensitive search folds UTF-16 code units (QChar::toCaseFolded)
+// candidates of the first pattern unit are found by SSE2 if available
+class QI_EXPORT TextMatcher
+{
+public:
+    TextMatcher();
+    explicit TextMatcher(const QString& pattern, Qt::CaseSensitivity cs = Qt::CaseSensitive);
+
+    const QString& pattern() const { return m_pattern; }
+    Qt::CaseSensitivity caseSensitivity() const { return m_cs; }
+    bool isEmpty() const { return m_pattern.isEmpty(); }
+
+    // returns position of the first occurrence of pattern or -1
+    int indexIn(const QChar* text, int length) const;
+    int indexIn(const QString& text) const { return indexIn(text.constData(), text.size()); }
+    // returns true if text contains pattern, empty pattern is contained in any text
+    bool isMatched(const QString& text) const { return indexIn(text) >= 0; }
+
+    static ushort foldCase(ushort unit)
+    {
+        if (unit < 128)
+            return (unit >= 'A' && unit <= 'Z') ? ushort(unit + ('a' - 'A')) : unit;
+        return QChar(unit).toCaseFolded().unicode();
+    }
+
+private:
+    bool isMatchedAt(const ushort* text) const;
+
+    QString m_pattern;
+    Qt::CaseSensitivity m_cs;
+    // pattern units to compare with, folded if search is case insensitive
+    QVector<ushort> m_units;
+    // units which may start an occurrence, repeated to fill all slots
+    // m_firstCount == 0 - first unit folds from unknown units and is checked by foldCase
+    ushort m_first[3];
+    int m_firstCount;
+};
+
+} // end namespace Qi
+
+#endif // QI_TEXT_MATCHER_H
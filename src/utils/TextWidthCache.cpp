@@ -0,0 +1,197 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#include "TextWidthCache.h"
+#include <QFontInfo>
+#include <QtMath>
+#include <QThreadStorage>
+
+namespace Qi
+{
+
+static const int MaxFonts = 64;
+static const int AsciiSize = 128;
+// bounds of wrapped texts layout
+static const int MaxWrappedHeight = 1 << 24;
+
+struct TextWidthCache::FontData
+{
+    explicit FontData(const QFont& font)
+        : metrics(font),
+          metricsF(font),
+          fontHash(qHash(font.key())),
+          hasAsciiAdvances(false)
+    {
+        // sum of glyph advances equals text width only if there is no kerning and spacing
+        // ligatures are not used for ASCII texts of fixed pitch fonts
+        bool isSimple = font.letterSpacing() == 0. && font.wordSpacing() == 0.
+                && (!font.kerning() || QFontInfo(font).fixedPitch());
+        if (isSimple)
+        {
+            for (int i = 0; i < AsciiSize; ++i)
+                asciiAdvances[i] = metricsF.width(QChar(i));
+            hasAsciiAdvances = true;
+        }
+    }
+
+    QFontMetrics metrics;
+    QFontMetricsF metricsF;
+    uint fontHash;
+    bool hasAsciiAdvances;
+    qreal asciiAdvances[AsciiSize];
+};
+
+TextWidthCache::TextWidthCache(int maxTexts)
+    : m_lastFontData(nullptr),
+      m_widths(maxTexts),
+      m_wrappedHeights(qMax(1, maxTexts / 4))
+{
+}
+
+TextWidthCache::~TextWidthCache()
+{
+    qDeleteAll(m_fonts);
+}
+
+TextWidthCache& TextWidthCache::instance()
+{
+    // each thread measures with its own cache
+    static QThreadStorage<TextWidthCache*> caches;
+
+    if (!caches.hasLocalData())
+        caches.setLocalData(new TextWidthCache());
+
+    return *caches.localData();
+}
+
+int TextWidthCache::width(const QFont& font, const QString& text)
+{
+    if (text.isEmpty())
+        return 0;
+
+    FontData* data = fontData(font);
+
+    int width = 0;
+    if (asciiWidth(*data, text, width))
+        return width;
+
+    TextKey key = { data->fontHash, qHash(text) };
+    if (TextWidth* cached = m_widths.object(key))
+    {
+        // hashes may collide
+        if (cached->text == text)
+            return cached->width;
+    }
+
+    width = data->metrics.width(text);
+    m_widths.insert(key, new TextWidth { text, width });
+    return width;
+}
+
+int TextWidthCache::height(const QFont& font)
+{
+    return fontData(font)->metrics.height();
+}
+
+int TextWidthCache::wrappedHeight(const QFont& font, const QString& text, int width)
+{
+    FontData* data = fontData(font);
+    bool isMultiline = text.contains(QLatin1Char('\n'));
+    if (!isMultiline && this->width(font, text) <= width)
+        return data->metrics.height();
+
+    TextKey key = { data->fontHash, qHash(text) ^ (uint(width) * 0x45d9f3bu) };
+    if (TextHeight* cached = m_wrappedHeights.object(key))
+    {
+        // hashes may collide
+        if (cached->width == width && cached->text == text)
+            return cached->height;
+    }
+
+    int height = data->metrics.boundingRect(QRect(0, 0, qMax(width, 1), MaxWrappedHeight), Qt::TextWordWrap, text).height();
+    m_wrappedHeights.insert(key, new TextHeight { text, width, height });
+    return height;
+}
+
+// estimated length of cached texts
+static const int AverageTextLength = 16;
+
+MemoryUsage TextWidthCache::memoryUsage() const
+{
+    MemoryUsage usage;
+    usage.add("fonts", MemoryUsage::bytes(m_fonts) + qint64(m_fonts.size()) * sizeof(FontData));
+    usage.add("texts", qint64(m_widths.size()) * (sizeof(TextKey) + sizeof(TextWidth) + 4 * sizeof(void*) + AverageTextLength * sizeof(QChar)));
+    usage.add("wrappedTexts", qint64(m_wrappedHeights.size()) * (sizeof(TextKey) + sizeof(TextHeight) + 4 * sizeof(void*) + AverageTextLength * sizeof(QChar)));
+    return usage;
+}
+
+void TextWidthCache::clear()
+{
+    m_widths.clear();
+    m_wrappedHeights.clear();
+    m_lastFont = QFont();
+    m_lastFontData = nullptr;
+    qDeleteAll(m_fonts);
+    m_fonts.clear();
+}
+
+TextWidthCache::FontData* TextWidthCache::fontData(const QFont& font)
+{
+    if (m_lastFontData && m_lastFont == font)
+        return m_lastFontData;
+
+    QString key = font.key();
+    FontData*& data = m_fonts[key];
+    if (!data)
+    {
+        if (m_fonts.size() > MaxFonts)
+        {
+            // fonts are rarely changed, just start over
+            m_fonts.remove(key);
+            clear();
+            return fontData(font);
+        }
+
+        data = new FontData(font);
+    }
+
+    m_lastFont = font;
+    m_lastFontData = data;
+    return data;
+}
+
+bool TextWidthCache::asciiWidth(const FontData& data, const QString& text, int& width) const
+{
+    if (!data.hasAsciiAdvances)
+        return false;
+
+    qreal advance = 0.;
+    const ushort* units = text.utf16();
+    for (int i = 0, size = text.size(); i < size; ++i)
+    {
+        ushort unit = units[i];
+        // control characters are not simple glyphs
+        if (unit >= AsciiSize || unit < 0x20)
+            return false;
+
+        advance += data.asciiAdvances[unit];
+    }
+
+    width = qRound(advance);
+    return true;
+}
+
+} // end namespace Qi
@@ -0,0 +1,95 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+#ifndef QI_TEXT_WIDTH_CACHE_H
+#define QI_TEXT_WIDTH_CACHE_H
+
+#include "QiAPI.h"
+#include "MemoryUsage.h"
+#include <QFont>
+#include <QFontMetricsF>
+#include <QCache>
+#include <QHash>
+
+namespace Qi
+{
+
+// caches advance widths of texts per font
+// texts are kept in LRU cache keyed by (font key, text hash)
+// ASCII texts of fonts without kerning are summed from glyph advances table
+// is not thread safe, each instance should be used from one thread
+class QI_EXPORT TextWidthCache
+{
+    Q_DISABLE_COPY(TextWidthCache)
+
+public:
+    explicit TextWidthCache(int maxTexts = 65536);
+    ~TextWidthCache();
+
+    // instance of the calling thread
+    static TextWidthCache& instance();
+
+    // same as QFontMetrics(font).width(text)
+    int width(const QFont& font, const QString& text);
+    // same as QFontMetrics(font).height()
+    int height(const QFont& font);
+    // height of text word wrapped to width, single line texts are not laid out
+    int wrappedHeight(const QFont& font, const QString& text, int width);
+
+    void clear();
+    // texts are estimated by average length
+    MemoryUsage memoryUsage() const;
+
+private:
+    struct FontData;
+    FontData* fontData(const QFont& font);
+    bool asciiWidth(const FontData& data, const QString& text, int& width) const;
+
+    struct TextKey
+    {
+        uint fontHash;
+        uint textHash;
+
+        bool operator==(const TextKey& other) const { return fontHash == other.fontHash && textHash == other.textHash; }
+    };
+    friend uint qHash(const TextKey& key) { return key.fontHash ^ (key.textHash * 0x9E3779B1u); }
+
+    struct TextWidth
+    {
+        QString text;
+        int width;
+    };
+
+    QHash<QString, FontData*> m_fonts;
+    // last used font to skip QFont::key calculations
+    QFont m_lastFont;
+    FontData* m_lastFontData;
+
+    struct TextHeight
+    {
+        QString text;
+        int width;
+        int height;
+    };
+
+    QCache<TextKey, TextWidth> m_widths;
+    // keyed by text hash mixed with wrap width
+    QCache<TextKey, TextHeight> m_wrappedHeights;
+};
+
+} // end namespace Qi
+
+#endif // QI_TEXT_WIDTH_CACHE_H
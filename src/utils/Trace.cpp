@@ -0,0 +1,256 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "Trace.h"
+#include <QIODevice>
+#include <QThread>
+#include <QMutex>
+#include <QHash>
+#include <QElapsedTimer>
+#include <atomic>
+#include <algorithm>
+
+namespace Qi
+{
+
+static const char* const TraceCategoryNames[TraceCategoriesCount] = {
+    "controller",
+    "cache",
+    "lines",
+    "sort",
+    "paint",
+    "view"
+};
+
+struct TraceData
+{
+    std::atomic<bool> isActive { false };
+    QElapsedTimer timer;
+
+    QMutex mutex;
+    QVector<Tracer::Event> events;
+    int eventsLimit = 0;
+    QHash<const char*, Tracer::DrawStatistics> drawStatistics;
+    QVector<CallbackProfile*> profiles;
+};
+
+static TraceData& traceData()
+{
+    static TraceData data;
+    return data;
+}
+
+void Tracer::start(int eventsLimit)
+{
+    TraceData& data = traceData();
+    QMutexLocker locker(&data.mutex);
+    if (!data.timer.isValid())
+        data.timer.start();
+    data.eventsLimit = eventsLimit;
+    data.isActive = true;
+}
+
+void Tracer::stop()
+{
+    traceData().isActive = false;
+}
+
+bool Tracer::isActive()
+{
+    return traceData().isActive.load(std::memory_order_relaxed);
+}
+
+void Tracer::clear()
+{
+    TraceData& data = traceData();
+    QMutexLocker locker(&data.mutex);
+    data.events.clear();
+    data.drawStatistics.clear();
+    for (auto profile : data.profiles)
+        profile->reset();
+}
+
+QVector<Tracer::Event> Tracer::events()
+{
+    TraceData& data = traceData();
+    QMutexLocker locker(&data.mutex);
+    return data.events;
+}
+
+QVector<Tracer::DrawStatistics> Tracer::drawStatistics()
+{
+    TraceData& data = traceData();
+    QVector<DrawStatistics> result;
+    {
+        QMutexLocker locker(&data.mutex);
+        result.reserve(data.drawStatistics.size());
+        for (const auto& statistics : data.drawStatistics)
+            result.append(statistics);
+    }
+
+    std::sort(result.begin(), result.end(), [](const DrawStatistics& left, const DrawStatistics& right) {
+        return left.totalTime > right.totalTime;
+    });
+    return result;
+}
+
+QVector<Tracer::CallbackStatistics> Tracer::callbackStatistics()
+{
+    TraceData& data = traceData();
+    QVector<CallbackStatistics> result;
+    {
+        QMutexLocker locker(&data.mutex);
+        result.reserve(data.profiles.size());
+        for (auto profile : data.profiles)
+        {
+            CallbackStatistics statistics;
+            statistics.name = profile->name();
+            statistics.calls = profile->calls();
+            statistics.totalTime = profile->totalTime();
+            result.append(statistics);
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const CallbackStatistics& left, const CallbackStatistics& right) {
+        return left.totalTime > right.totalTime;
+    });
+    return result;
+}
+
+static void appendJsonString(QByteArray& json, const char* text)
+{
+    json.append('"');
+    for (; *text; ++text)
+    {
+        if (*text == '"' || *text == '\\')
+            json.append('\\');
+        json.append(*text);
+    }
+    json.append('"');
+}
+
+bool Tracer::writeChromeTrace(QIODevice* device)
+{
+    Q_ASSERT(device);
+    if (!device->isWritable())
+        return false;
+
+    QVector<Event> events = Tracer::events();
+
+    // complete events with timestamps in microseconds
+    QByteArray json("{\"traceEvents\":[\n");
+    for (int i = 0; i < events.size(); ++i)
+    {
+        const Event& event = events[i];
+        if (i > 0)
+            json.append(",\n");
+
+        json.append("{\"name\":");
+        appendJsonString(json, event.name);
+        json.append(",\"cat\":");
+        appendJsonString(json, TraceCategoryNames[event.category]);
+        json.append(",\"ph\":\"X\",\"pid\":1,\"tid\":");
+        json.append(QByteArray::number(event.threadId));
+        json.append(",\"ts\":");
+        json.append(QByteArray::number(double(event.start) / 1000., 'f', 3));
+        json.append(",\"dur\":");
+        json.append(QByteArray::number(double(event.duration) / 1000., 'f', 3));
+        json.append('}');
+
+        if (json.size() >= 64 * 1024)
+        {
+            if (device->write(json) != json.size())
+                return false;
+            json.resize(0);
+        }
+    }
+    json.append("\n],\"displayTimeUnit\":\"ns\"}\n");
+
+    return device->write(json) == json.size();
+}
+
+qint64 Tracer::now()
+{
+    return traceData().timer.nsecsElapsed();
+}
+
+void Tracer::addEvent(TraceCategory category, const char* name, qint64 start, qint64 duration)
+{
+    TraceData& data = traceData();
+    QMutexLocker locker(&data.mutex);
+
+    if (category == TraceCategoryView)
+    {
+        auto& statistics = data.drawStatistics[name];
+        if (statistics.draws == 0)
+        {
+            statistics.viewType = name;
+            statistics.totalTime = 0;
+            statistics.maxTime = 0;
+        }
+        ++statistics.draws;
+        statistics.totalTime += duration;
+        statistics.maxTime = qMax(statistics.maxTime, duration);
+    }
+
+    if (data.events.size() >= data.eventsLimit)
+        return;
+
+    Event event;
+    event.category = category;
+    event.name = name;
+    event.threadId = quint64(quintptr(QThread::currentThreadId()));
+    event.start = start;
+    event.duration = duration;
+    data.events.append(event);
+}
+
+void Tracer::addProfile(CallbackProfile* profile)
+{
+    TraceData& data = traceData();
+    QMutexLocker locker(&data.mutex);
+    data.profiles.append(profile);
+}
+
+void Tracer::removeProfile(CallbackProfile* profile)
+{
+    TraceData& data = traceData();
+    QMutexLocker locker(&data.mutex);
+    data.profiles.removeOne(profile);
+}
+
+CallbackProfile::CallbackProfile(const char* name)
+    : m_name(name),
+      m_calls(0),
+      m_totalTime(0)
+{
+    Q_ASSERT(m_name);
+    Tracer::addProfile(this);
+}
+
+CallbackProfile::~CallbackProfile()
+{
+    Tracer::removeProfile(this);
+}
+
+void CallbackProfile::reset()
+{
+    m_calls.store(0, std::memory_order_relaxed);
+    m_totalTime.store(0, std::memory_order_relaxed);
+}
+
+} // end namespace Qi
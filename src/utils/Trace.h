@@ -0,0 +1,188 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_TRACE_H
+#define QI_TRACE_H
+
+#include "QiAPI.h"
+#include <QVector>
+#include <atomic>
+
+class QIODevice;
+
+namespace Qi
+{
+
+class CallbackProfile;
+
+enum TraceCategory
+{
+    TraceCategoryController = 0,
+    TraceCategoryCache,
+    TraceCategoryLines,
+    TraceCategorySort,
+    TraceCategoryPaint,
+    // View::draw, aggregated by view class in Tracer::drawStatistics
+    TraceCategoryView,
+    TraceCategoriesCount
+};
+
+// collects events of trace markers
+// markers are compiled only if library is built with QI_TRACE (CONFIG += qi_trace)
+// and record events only between Tracer::start and Tracer::stop
+class QI_EXPORT Tracer
+{
+public:
+    struct Event
+    {
+        TraceCategory category;
+        // static string
+        const char* name;
+        quint64 threadId;
+        // nanoseconds since the first start
+        qint64 start;
+        qint64 duration;
+    };
+
+    struct DrawStatistics
+    {
+        // class name of the view
+        const char* viewType;
+        quint64 draws;
+        // nanoseconds
+        qint64 totalTime;
+        qint64 maxTime;
+    };
+
+    struct CallbackStatistics
+    {
+        // name of the profiled callback
+        const char* name;
+        quint64 calls;
+        // nanoseconds
+        qint64 totalTime;
+    };
+
+    // events over eventsLimit are aggregated to draw statistics only
+    static void start(int eventsLimit = 1024 * 1024);
+    static void stop();
+    static bool isActive();
+    static void clear();
+
+    static QVector<Event> events();
+    // sorted by total time descending
+    static QVector<DrawStatistics> drawStatistics();
+    // counters of alive callback profiles, sorted by total time descending
+    static QVector<CallbackStatistics> callbackStatistics();
+    // writes events in Chrome trace event format (chrome://tracing, ui.perfetto.dev)
+    static bool writeChromeTrace(QIODevice* device);
+
+    static qint64 now();
+    static void addEvent(TraceCategory category, const char* name, qint64 start, qint64 duration);
+
+private:
+    friend class CallbackProfile;
+    static void addProfile(CallbackProfile* profile);
+    static void removeProfile(CallbackProfile* profile);
+};
+
+// counts calls and time of user callbacks (see core/ext/CallbackProfiling.h)
+// counters are updated without locks from any thread between Tracer::start and Tracer::stop,
+// Tracer::clear resets them
+class QI_EXPORT CallbackProfile
+{
+    Q_DISABLE_COPY(CallbackProfile)
+
+public:
+    // name should be static string
+    explicit CallbackProfile(const char* name);
+    ~CallbackProfile();
+
+    const char* name() const { return m_name; }
+    quint64 calls() const { return m_calls.load(std::memory_order_relaxed); }
+    qint64 totalTime() const { return m_totalTime.load(std::memory_order_relaxed); }
+
+    void add(qint64 duration)
+    {
+        m_calls.fetch_add(1, std::memory_order_relaxed);
+        m_totalTime.fetch_add(duration, std::memory_order_relaxed);
+    }
+    void reset();
+
+private:
+    const char* m_name;
+    std::atomic<quint64> m_calls;
+    std::atomic<qint64> m_totalTime;
+};
+
+// adds its scope to the profile
+class CallbackProfileScope
+{
+    Q_DISABLE_COPY(CallbackProfileScope)
+
+public:
+    explicit CallbackProfileScope(CallbackProfile& profile)
+        : m_profile(profile),
+          m_start(Tracer::isActive() ? Tracer::now() : -1)
+    {}
+
+    ~CallbackProfileScope()
+    {
+        if (m_start >= 0)
+            m_profile.add(Tracer::now() - m_start);
+    }
+
+private:
+    CallbackProfile& m_profile;
+    qint64 m_start;
+};
+
+// records event of its scope
+class TraceScope
+{
+    Q_DISABLE_COPY(TraceScope)
+
+public:
+    TraceScope(TraceCategory category, const char* name)
+        : m_category(category),
+          m_name(name),
+          m_start(Tracer::isActive() ? Tracer::now() : -1)
+    {}
+
+    ~TraceScope()
+    {
+        if (m_start >= 0)
+            Tracer::addEvent(m_category, m_name, m_start, Tracer::now() - m_start);
+    }
+
+private:
+    TraceCategory m_category;
+    const char* m_name;
+    qint64 m_start;
+};
+
+} // end namespace Qi
+
+#ifdef QI_TRACE
+#define QI_TRACE_CONCAT_IMPL(a, b) a##b
+#define QI_TRACE_CONCAT(a, b) QI_TRACE_CONCAT_IMPL(a, b)
+#define QI_TRACE_SCOPE(category, name) ::Qi::TraceScope QI_TRACE_CONCAT(qiTraceScope, __LINE__)(::Qi::category, name)
+#else
+#define QI_TRACE_SCOPE(category, name) (void)0
+#endif
+
+#endif // QI_TRACE_H
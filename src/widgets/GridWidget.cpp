@@ -20,13 +20,15 @@
 #include "items/cache/ViewCacheSpace.h"
 #include "core/ext/Ranges.h"
 #include "core/ext/Layouts.h"
+#include "utils/FrameScheduler.h"
 #include <QScrollBar>
 
 namespace Qi
 {
 
 GridWidget::GridWidget(QWidget* parent)
-    : SpaceWidgetScrollAbstract(parent)
+    : SpaceWidgetScrollAbstract(parent),
+      m_isSubGridsStructureChanged(false)
 {
     // initialize main grid
     m_mainGrid = makeShared<SpaceGrid>();
@@ -41,20 +43,24 @@ GridWidget::GridWidget(QWidget* parent)
     }
 
     //initialize sub grids and caches
+    // sub-grids retire and recreate items while scrolling, so they share one pool
+    auto itemsPool = makeShared<CacheItemsPool>();
     auto modelCache = makeShared<ModelStorageGrid<SharedPtr<CacheSpace>>>(m_mainGrid);
     for (GridID subID = GridID(0, 0); subID.row < 3; ++subID.row)
     {
         for (subID.column = 0; subID.column < 3; ++subID.column)
         {
-            SpaceGridHint hint = (subID.row == 1) ? SpaceGridHintSameSchemasByColumn : SpaceGridHintNone;
-            auto subGrid = makeShared<SpaceGrid>(m_rows[subID.row], m_columns[subID.column], hint);
+            // schemas uniformity is detected by sub-grids
+            auto subGrid = makeShared<SpaceGrid>(m_rows[subID.row], m_columns[subID.column]);
             auto cacheSpace = makeShared<CacheSpaceGrid>(subGrid);
+            cacheSpace->setItemsPool(itemsPool);
 
             m_cacheSubGrids[subID.row][subID.column] = cacheSpace;
             modelCache->setValueId(subID, cacheSpace);
 
             connect(subGrid.data(), &Space::spaceChanged, this, &GridWidget::onSubGridChanged);
             connect(cacheSpace.data(), &CacheSpace::cacheChanged, this, &GridWidget::onCacheSpaceChanged);
+            connect(cacheSpace.data(), &CacheSpace::cacheItemsChanged, this, &GridWidget::onCacheSpaceItemsChanged);
         }
     }
 
@@ -141,19 +147,39 @@ QSize GridWidget::viewportSizeHint() const
 
 void GridWidget::onSubGridChanged(const Space* /*space*/, ChangeReason reason)
 {
-    if (reason & ChangeReasonSpaceStructure)
-    {
-        invalidateCacheItemsLayout();
-        updateScrollbars();
-        // request to recalculate layout
-        updateGeometry();
-    }
+    if (!(reason & ChangeReasonSpaceStructure) || m_isSubGridsStructureChanged)
+        return;
+
+    m_isSubGridsStructureChanged = true;
+    invalidateCacheItemsLayout();
+    FrameScheduler::of(this)->schedule(FramePhaseCache, this, "validateSubGridsStructure", [this]() { validateSubGridsStructure(); });
+}
+
+void GridWidget::validateSubGridsStructure()
+{
+    if (!m_isSubGridsStructureChanged)
+        return;
+
+    m_isSubGridsStructureChanged = false;
+    updateScrollbars();
+    // request to recalculate layout
+    updateGeometry();
+}
+
+void GridWidget::onCacheSpaceChanged(const CacheSpace* /*cache*/, ChangeReason reason)
+{
+    // content is moved by scrollViewportImpl
+    if (isBlitScrollChange(reason))
+        return;
+
+    // caches of sub-grids sharing lines repaint widget once
+    FrameScheduler::of(this)->schedule(FramePhasePaint, this, "updateViewport", [this]() { viewport()->update(); });
 }
 
-void GridWidget::onCacheSpaceChanged(const CacheSpace* /*cache*/, ChangeReason /*reason*/)
+void GridWidget::onCacheSpaceItemsChanged(const CacheSpace* /*cache*/, const QRegion& windowRegion)
 {
-    // repaint widget
-    viewport()->update();
+    // repaint changed items only
+    viewport()->update(windowRegion);
 }
 
 QSize GridWidget::calculateVirtualSizeImpl() const
@@ -192,8 +218,29 @@ void GridWidget::updateCacheScrollOffsetImpl()
     cacheSubGrid(clientID)->setScrollOffset(scrollPos);
 }
 
+void GridWidget::scrollViewportImpl(int dx, int dy)
+{
+    // corner sub-grids are not scrolled
+    viewport()->scroll(dx, dy, cacheSubGrid(clientID)->window());
+
+    if (dx != 0)
+    {
+        viewport()->scroll(dx, 0, cacheSubGrid(topID)->window());
+        viewport()->scroll(dx, 0, cacheSubGrid(bottomID)->window());
+    }
+
+    if (dy != 0)
+    {
+        viewport()->scroll(0, dy, cacheSubGrid(leftID)->window());
+        viewport()->scroll(0, dy, cacheSubGrid(rightID)->window());
+    }
+}
+
 void GridWidget::validateCacheItemsLayoutImpl()
 {
+    // layout may be validated before scheduled frame
+    validateSubGridsStructure();
+
     QSize visibleSize = viewport()->size();
 
     QSize topLeftSubGridSize = subGrid(topLeftID)->size();
@@ -72,16 +72,23 @@ protected:
     QSize calculateVirtualSizeImpl() const override;
     QSize calculateScrollableSizeImpl() const override;
     void updateCacheScrollOffsetImpl() override;
+    void scrollViewportImpl(int dx, int dy) override;
 
 private:
+    // sub-grids sharing changed lines report it together,
+    // so scrollbars and geometry are updated once per frame
     void onSubGridChanged(const Space* space, ChangeReason reason);
+    void validateSubGridsStructure();
     void onCacheSpaceChanged(const CacheSpace* cache, ChangeReason reason);
+    void onCacheSpaceItemsChanged(const CacheSpace* cache, const QRegion& windowRegion);
 
     SharedPtr<SpaceGrid> m_mainGrid;
 
     SharedPtr<Lines> m_rows[3];
     SharedPtr<Lines> m_columns[3];
     SharedPtr<CacheSpaceGrid> m_cacheSubGrids[3][3];
+
+    bool m_isSubGridsStructureChanged;
 };
 
 } // end namespace Qi
@@ -27,7 +27,10 @@ ItemWidget::ItemWidget(QWidget* parent, ID id)
       m_syncSpaceSizeWithContent(true)
 {
     m_space = makeShared<SpaceItem>(id);
-    initSpaceWidgetCore(makeShared<CacheSpaceItem>(m_space));
+    auto cacheSpace = makeShared<CacheSpaceItem>(m_space);
+    // resizes of the widget don't recreate item
+    cacheSpace->setCacheItemReused(true);
+    initSpaceWidgetCore(cacheSpace);
 
     connect(m_space.data(), &Space::spaceChanged, this, &ItemWidget::onSpaceChanged);
 }
@@ -23,18 +23,23 @@
 #include "core/ext/Ranges.h"
 #include "core/ext/Layouts.h"
 #include "utils/PainterState.h"
+#include "utils/FrameScheduler.h"
+#include <QScrollBar>
 
 namespace Qi
 {
 
 ListWidget::ListWidget(QWidget* parent)
-    : SpaceWidgetScrollAbstract(parent)
+    : SpaceWidgetScrollAbstract(parent),
+      m_pendingRowsCount(0),
+      m_isFollowTail(false)
 {
     // initialize main grid
     m_grid = makeShared<SpaceGrid>();
     m_cacheGrid = makeShared<CacheSpaceGrid>(m_grid);
 
     connect(m_cacheGrid.data(), &CacheSpace::cacheChanged, this, &ListWidget::onCacheSpaceGridChanged);
+    connect(m_cacheGrid.data(), &CacheSpace::cacheItemsChanged, this, &ListWidget::onCacheSpaceGridItemsChanged);
 
     // initialize main item space
     m_mainSpace = makeShared<SpaceItem>(ID(GridID(0, 0)));
@@ -51,11 +56,23 @@ ListWidget::~ListWidget()
 {
 }
 
-void ListWidget::onCacheSpaceGridChanged(const CacheSpace* cache, ChangeReason /*reason*/)
+void ListWidget::onCacheSpaceGridChanged(const CacheSpace* cache, ChangeReason reason)
 {
     Q_UNUSED(cache);
     Q_ASSERT(cache == m_cacheGrid.data());
-    viewport()->update();;
+
+    // content is moved by scrollViewportImpl
+    if (isBlitScrollChange(reason))
+        return;
+
+    viewport()->update();
+}
+
+void ListWidget::onCacheSpaceGridItemsChanged(const CacheSpace* cache, const QRegion& windowRegion)
+{
+    Q_UNUSED(cache);
+    Q_ASSERT(cache == m_cacheGrid.data());
+    viewport()->update(windowRegion);
 }
 
 void ListWidget::onSpaceGridChanged(const Space* space, ChangeReason reason)
@@ -86,6 +103,51 @@ bool ListWidget::installEmptyView(SharedPtr<View> view, SharedPtr<Layout> layout
     return true;
 }
 
+void ListWidget::appendRowsLater(int rowsCount)
+{
+    Q_ASSERT(rowsCount >= 0);
+    if (rowsCount == 0)
+        return;
+
+    m_pendingRowsCount += rowsCount;
+    FrameScheduler::of(this)->schedule(FramePhaseLines, this, "appendRows", [this]() {
+        int rowsCount = m_pendingRowsCount;
+        m_pendingRowsCount = 0;
+        rows()->appendLines(rowsCount);
+    });
+}
+
+void ListWidget::setFollowTail(bool isFollowTail)
+{
+    if (m_isFollowTail == isFollowTail)
+        return;
+
+    m_isFollowTail = isFollowTail;
+
+    if (m_isFollowTail)
+        connect(rows().data(), &Lines::linesInserted, this, &ListWidget::onRowsInserted);
+    else
+        disconnect(rows().data(), &Lines::linesInserted, this, &ListWidget::onRowsInserted);
+}
+
+void ListWidget::onRowsInserted(const Lines* rows, int row, int rowsCount)
+{
+    // scrollbars are not updated yet and show position before appending
+    if (row + rowsCount != rows->count() || !isScrolledToTail())
+        return;
+
+    // scroll after scrollbars are updated, cache items of rows
+    // which remain in frame are reused and only exposed rows are created
+    FrameScheduler::of(this)->schedule(FramePhaseLayout, this, "followTail", [this]() {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    });
+}
+
+bool ListWidget::isScrolledToTail() const
+{
+    return verticalScrollBar()->value() >= verticalScrollBar()->maximum();
+}
+
 QPixmap ListWidget::createPixmapImpl() const
 {
     if (m_grid->isEmptyVisible())
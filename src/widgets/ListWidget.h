@@ -47,12 +47,25 @@ public:
 
     bool installEmptyView(SharedPtr<View> view, SharedPtr<Layout> layout);
 
+    // appends rows in the lines phase of the next frame,
+    // rows requested during one frame are appended by single change
+    void appendRowsLater(int rowsCount);
+    int pendingRowsCount() const { return m_pendingRowsCount; }
+
+    // keeps list scrolled to the last row when rows are appended
+    // while it is scrolled to the end, scrolling up stops following
+    bool isFollowTail() const { return m_isFollowTail; }
+    void setFollowTail(bool isFollowTail);
+
 protected:
     QPixmap createPixmapImpl() const;
 
 private:
     void onCacheSpaceGridChanged(const CacheSpace* cache, ChangeReason reason);
+    void onCacheSpaceGridItemsChanged(const CacheSpace* cache, const QRegion& windowRegion);
     void onSpaceGridChanged(const Space* space, ChangeReason reason);
+    void onRowsInserted(const Lines* rows, int row, int rowsCount);
+    bool isScrolledToTail() const;
 
     SharedPtr<SpaceGrid> m_grid;
     SharedPtr<CacheSpaceGrid> m_cacheGrid;
@@ -61,6 +74,9 @@ private:
     SharedPtr<CacheSpaceItem> m_mainCache;
 
     SharedPtr<ViewVisible> m_emptyView;
+
+    int m_pendingRowsCount;
+    bool m_isFollowTail;
 };
 
 } // end namespace Qi
@@ -17,13 +17,28 @@
 #include "SceneWidget.h"
 #include "space/scene/CacheSpaceScene.h"
 #include "cache/CacheItem.h"
+#include <QPainter>
+#include <QScrollBar>
+#include <QTimer>
+#include <QWheelEvent>
+#include <QtMath>
 
 namespace Qi
 {
 
+static const int DefaultZoomPreviewDelay = 150;
+
 SceneWidget::SceneWidget(QWidget* parent)
-    : SpaceWidgetScrollAbstract(parent)
+    : SpaceWidgetScrollAbstract(parent),
+      m_minZoom(0.05),
+      m_maxZoom(20.),
+      m_zoomPreviewDelay(DefaultZoomPreviewDelay),
+      m_zoomPreviewTimer(new QTimer(this)),
+      m_zoomPreviewScale(1.)
 {
+    m_zoomPreviewTimer->setSingleShot(true);
+    m_zoomPreviewTimer->setInterval(m_zoomPreviewDelay);
+    connect(m_zoomPreviewTimer, &QTimer::timeout, this, &SceneWidget::stopZoomPreview);
 }
 
 SceneWidget::~SceneWidget()
@@ -41,5 +56,119 @@ void SceneWidget::initScene(SharedPtr<SpaceScene> scene)
     initSpaceWidgetScrollable(m_cacheScene, m_cacheScene);
 }
 
+qreal SceneWidget::zoom() const
+{
+    return m_cacheScene ? m_cacheScene->scale() : 1.;
+}
+
+void SceneWidget::setZoom(qreal zoom)
+{
+    setZoom(zoom, viewport()->rect().center());
+}
+
+void SceneWidget::setZoom(qreal zoom, const QPoint& anchor)
+{
+    Q_ASSERT(m_cacheScene);
+
+    zoom = qBound(m_minZoom, zoom, m_maxZoom);
+    qreal scale = m_cacheScene->scale();
+    if (qFuzzyCompare(scale, zoom))
+        return;
+
+    if (m_zoomPreviewDelay > 0 && !isAcceleratedViewport())
+        startZoomPreview();
+
+    QPointF scenePoint = QPointF(m_cacheScene->scrollOffset()) + QPointF(anchor) / scale;
+
+    m_cacheScene->setScale(zoom);
+    updateScrollbars();
+
+    QPointF scrollOffset = scenePoint - QPointF(anchor) / zoom;
+    horizontalScrollBar()->setValue(qRound(scrollOffset.x()));
+    verticalScrollBar()->setValue(qRound(scrollOffset.y()));
+
+    viewport()->update();
+}
+
+void SceneWidget::setZoomRange(qreal minZoom, qreal maxZoom)
+{
+    Q_ASSERT(minZoom > 0. && minZoom <= maxZoom);
+
+    m_minZoom = minZoom;
+    m_maxZoom = maxZoom;
+    if (m_cacheScene)
+        setZoom(zoom());
+}
+
+void SceneWidget::setZoomPreviewDelay(int delay)
+{
+    Q_ASSERT(delay >= 0);
+
+    m_zoomPreviewDelay = delay;
+    if (m_zoomPreviewDelay > 0)
+        m_zoomPreviewTimer->setInterval(m_zoomPreviewDelay);
+    else
+        stopZoomPreview();
+}
+
+bool SceneWidget::viewportEvent(QEvent* event)
+{
+    if (event->type() != QEvent::Paint || m_zoomPreview.isNull())
+        return SpaceWidgetScrollAbstract::viewportEvent(event);
+
+    QPainter painter(viewport());
+    painter.fillRect(viewport()->rect(), viewport()->palette().color(viewport()->backgroundRole()));
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    // preview point p shows scene point p / previewScale + previewOffset
+    qreal scale = m_cacheScene->scale();
+    painter.translate(QPointF(m_zoomPreviewOffset - m_cacheScene->scrollOffset()) * scale);
+    painter.scale(scale / m_zoomPreviewScale, scale / m_zoomPreviewScale);
+    painter.drawPixmap(0, 0, m_zoomPreview);
+
+    return true;
+}
+
+void SceneWidget::wheelEvent(QWheelEvent* event)
+{
+    if (!m_cacheScene || !(event->modifiers() & Qt::ControlModifier))
+    {
+        SpaceWidgetScrollAbstract::wheelEvent(event);
+        return;
+    }
+
+    // one wheel notch (120) zooms by 20%
+    setZoom(zoom() * qPow(1.2, event->angleDelta().y() / 120.), event->pos());
+    event->accept();
+}
+
+QSize SceneWidget::calculateScrollableSizeImpl() const
+{
+    // scroll offsets are in scene units
+    return m_cacheScene ? m_cacheScene->window().size() : viewport()->size();
+}
+
+void SceneWidget::startZoomPreview()
+{
+    if (m_zoomPreview.isNull())
+    {
+        // grab paints the frame at current zoom
+        m_zoomPreview = viewport()->grab();
+        m_zoomPreviewScale = m_cacheScene->scale();
+        m_zoomPreviewOffset = m_cacheScene->scrollOffset();
+    }
+
+    m_zoomPreviewTimer->start();
+}
+
+void SceneWidget::stopZoomPreview()
+{
+    m_zoomPreviewTimer->stop();
+    if (m_zoomPreview.isNull())
+        return;
+
+    m_zoomPreview = QPixmap();
+    viewport()->update();
+}
 
 } // end namespace Qi
@@ -20,6 +20,7 @@
 #include "QiAPI.h"
 #include "space/scene/SpaceScene.h"
 #include "core/SpaceWidgetScrollAbstract.h"
+#include <QPixmap>
 
 namespace Qi
 {
@@ -40,9 +41,41 @@ public:
 
     const SharedPtr<CacheSpaceScene>& cacheScene() const { return m_cacheScene;}
 
+    // scale of the scene (see CacheSpace::scale), control + wheel zooms at mouse position
+    qreal zoom() const;
+    void setZoom(qreal zoom);
+    // scene point under viewport point anchor is kept
+    void setZoom(qreal zoom, const QPoint& anchor);
+    qreal minZoom() const { return m_minZoom; }
+    qreal maxZoom() const { return m_maxZoom; }
+    void setZoomRange(qreal minZoom, qreal maxZoom);
+
+    // while zoom is changing the frame drawn before zooming is shown scaled,
+    // scene is drawn at new zoom once zoom is kept for the delay (in milliseconds)
+    // 0 draws scene on each zoom change
+    int zoomPreviewDelay() const { return m_zoomPreviewDelay; }
+    void setZoomPreviewDelay(int delay);
+
+protected:
+    bool viewportEvent(QEvent* event) override;
+    void wheelEvent(QWheelEvent* event) override;
+    QSize calculateScrollableSizeImpl() const override;
+
 private:
+    void startZoomPreview();
+    void stopZoomPreview();
+
     SharedPtr<SpaceScene> m_scene;
     SharedPtr<CacheSpaceScene> m_cacheScene;
+
+    qreal m_minZoom;
+    qreal m_maxZoom;
+    int m_zoomPreviewDelay;
+    QTimer* m_zoomPreviewTimer;
+    // viewport frame drawn at m_zoomPreviewScale and m_zoomPreviewOffset
+    QPixmap m_zoomPreview;
+    qreal m_zoomPreviewScale;
+    QPoint m_zoomPreviewOffset;
 };
 
 } // end namespace Qi
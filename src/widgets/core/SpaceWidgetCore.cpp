@@ -19,19 +19,40 @@
 #include "cache/CacheControllerMouse.h"
 #include "core/ControllerKeyboard.h"
 #include "utils/PainterState.h"
+#include "SpaceWidgetDebugOverlay.h"
 
 #include <QWidget>
 #include <QToolTip>
+#include <QTimer>
+#include <QMouseEvent>
 
 namespace Qi
 {
 
 SpaceWidgetCore::SpaceWidgetCore(QWidget* owner)
     : m_owner(owner),
-      m_guiContext(owner)
+      m_guiContext(owner),
+      m_idleValidationTimer(new QTimer(owner)),
+      m_idleValidationBudget(0),
+      m_isEventCompression(false),
+      m_compressionTimer(new QTimer(owner))
 {
     Q_ASSERT(m_owner);
 
+    // zero interval timer fires when event queue is processed
+    m_idleValidationTimer->setSingleShot(true);
+    m_idleValidationTimer->setInterval(0);
+    QObject::connect(m_idleValidationTimer, &QTimer::timeout, [this]() {
+        onIdleValidation();
+    });
+
+    // compressed events are flushed once queued events of this event loop turn are processed
+    m_compressionTimer->setSingleShot(true);
+    m_compressionTimer->setInterval(0);
+    QObject::connect(m_compressionTimer, &QTimer::timeout, [this]() {
+        flushCompressedEventsImpl();
+    });
+
 #if !defined(QT_NO_DEBUG)
     m_trackOwner = m_owner;
 #endif
@@ -45,6 +66,7 @@ SpaceWidgetCore::~SpaceWidgetCore()
 #endif
 
     QObject::disconnect(m_connection);
+    QObject::disconnect(m_itemsConnection);
 }
 
 const Space& SpaceWidgetCore::mainSpace() const
@@ -73,10 +95,16 @@ bool SpaceWidgetCore::initSpaceWidgetCore(SharedPtr<CacheSpace> mainCacheSpace)
     m_connection = QObject::connect(m_mainCacheSpace.data(), &CacheSpace::cacheChanged, [this](const CacheSpace* cache, ChangeReason reason) {
         onCacheSpaceChanged(cache, reason);
     });
+    m_itemsConnection = QObject::connect(m_mainCacheSpace.data(), &CacheSpace::cacheItemsChanged, [this](const CacheSpace* cache, const QRegion& windowRegion) {
+        onCacheSpaceItemsChanged(cache, windowRegion);
+    });
 
     // enable tracking mouse moves
     m_owner->setMouseTracking(true);
 
+    if (qgetenv("QI_DEBUG_OVERLAY") == "1")
+        setDebugOverlay(true);
+
     return true;
 }
 
@@ -98,6 +126,68 @@ void SpaceWidgetCore::addControllerKeyboard(SharedPtr<ControllerKeyboard> contro
     }
 }
 
+void SpaceWidgetCore::setStatistics(SharedPtr<CacheSpaceStatistics> statistics)
+{
+    Q_ASSERT(m_mainCacheSpace);
+    m_mainCacheSpace->setStatistics(std::move(statistics));
+}
+
+void SpaceWidgetCore::setDebugOverlay(bool isDebugOverlay)
+{
+    Q_ASSERT(m_mainCacheSpace);
+    if (this->isDebugOverlay() == isDebugOverlay)
+        return;
+
+    if (isDebugOverlay)
+        m_debugOverlay.reset(new SpaceWidgetDebugOverlay(m_owner, m_mainCacheSpace));
+    else
+        m_debugOverlay.reset();
+
+    m_owner->update();
+}
+
+void SpaceWidgetCore::setIdleValidationBudget(int budget)
+{
+    Q_ASSERT(budget >= 0);
+    m_idleValidationBudget = budget;
+
+    if (m_idleValidationBudget > 0)
+        scheduleIdleValidation();
+    else
+        m_idleValidationTimer->stop();
+}
+
+void SpaceWidgetCore::setEventCompression(bool isEventCompression)
+{
+    if (m_isEventCompression == isEventCompression)
+        return;
+
+    m_isEventCompression = isEventCompression;
+    if (!m_isEventCompression)
+        flushCompressedEventsImpl();
+}
+
+void SpaceWidgetCore::flushCompressedEventsImpl()
+{
+    m_compressionTimer->stop();
+    flushPendingMouseMove();
+}
+
+void SpaceWidgetCore::scheduleCompressedEvents()
+{
+    if (!m_compressionTimer->isActive())
+        m_compressionTimer->start();
+}
+
+void SpaceWidgetCore::flushPendingMouseMove()
+{
+    if (!m_pendingMouseMove)
+        return;
+
+    QScopedPointer<QMouseEvent> mouseMove(m_pendingMouseMove.take());
+    m_cacheControllers->processEvent(mouseMove.data());
+}
+
 void SpaceWidgetCore::ensureVisible(ID visibleItem, const CacheSpace* cacheSpace, bool validateItem)
 {
     ensureVisibleImpl(visibleItem, cacheSpace, validateItem);
@@ -109,6 +199,54 @@ bool SpaceWidgetCore::processOwnerEvent(QEvent* event)
     if (!m_mainCacheSpace)
         return false;
 
+    switch (event->type())
+    {
+    case QEvent::MouseMove:
+    {
+        if (!m_isEventCompression)
+            break;
+
+        // keep the latest move only
+        QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+        m_pendingMouseMove.reset(new QMouseEvent(mouseEvent->type(), mouseEvent->localPos(), mouseEvent->windowPos(), mouseEvent->screenPos(),
+                                                 mouseEvent->button(), mouseEvent->buttons(), mouseEvent->modifiers()));
+        scheduleCompressedEvents();
+        return false;
+    }
+
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::ContextMenu:
+    case QEvent::Leave:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+        // keep events order
+        if (m_isEventCompression)
+            flushCompressedEventsImpl();
+        break;
+
+    default:
+        break;
+    }
+
+    switch (event->type())
+    {
+    case QEvent::PaletteChange:
+    case QEvent::FontChange:
+    case QEvent::StyleChange:
+    case QEvent::EnabledChange:
+    case QEvent::FocusIn:
+    case QEvent::FocusOut:
+    case QEvent::ScreenChangeInternal:
+        // prepared style state follows the owner
+        m_guiContext.invalidate();
+        break;
+
+    default:
+        break;
+    }
+
     bool processed = true;
 
     switch (event->type())
@@ -125,8 +263,17 @@ bool SpaceWidgetCore::processOwnerEvent(QEvent* event)
         QPainter painter(m_owner);
         painter.setRenderHints(QPainter::Antialiasing | QPainter::TextAntialiasing | QPainter::HighQualityAntialiasing);
         painter.setBackgroundMode(Qt::TransparentMode);
-        // draw cache
-        m_mainCacheSpace->draw(&painter, GuiContext(m_owner));
+        // draw cache items exposed by the event only
+        QRect exposedRect = static_cast<QPaintEvent*>(event)->rect();
+        // style state is prepared once per frame
+        m_guiContext.invalidate();
+        if (m_debugOverlay)
+            m_debugOverlay->beginPaint(static_cast<QPaintEvent*>(event)->region());
+        m_mainCacheSpace->draw(&painter, m_guiContext, &exposedRect);
+        if (m_debugOverlay)
+            m_debugOverlay->endPaint(&painter);
+        // prepare items around window
+        scheduleIdleValidation();
     } break;
 
     case QEvent::ToolTip:
@@ -135,8 +282,8 @@ bool SpaceWidgetCore::processOwnerEvent(QEvent* event)
 
         // show tooltip from the cache
         TooltipInfo tooltipInfo;
-        if (m_mainCacheSpace->tooltipByPoint(helpEvent->pos(), tooltipInfo))
-            QToolTip::showText(helpEvent->globalPos(), tooltipInfo.text, m_owner, tooltipInfo.rect);
+        if (m_mainCacheSpace->tooltipByPoint(m_mainCacheSpace->fromView(helpEvent->pos()), tooltipInfo))
+            QToolTip::showText(helpEvent->globalPos(), tooltipInfo.text, m_owner, m_mainCacheSpace->toView(tooltipInfo.rect));
         else
             QToolTip::hideText();
     } break;
@@ -201,23 +348,95 @@ void SpaceWidgetCore::resumeControllers()
         m_cacheControllers->resume();
 }
 
-void SpaceWidgetCore::onCacheSpaceChanged(const CacheSpace* cache, ChangeReason /*reason*/)
+void SpaceWidgetCore::setDraft(bool isDraft)
+{
+    if (m_guiContext.isDraft() == isDraft)
+        return;
+
+    m_guiContext.setDraft(isDraft);
+    if (!isDraft)
+        m_owner->update();
+}
+
+void SpaceWidgetCore::setOwner(QWidget* owner)
+{
+    Q_ASSERT(owner);
+    if (m_owner == owner)
+        return;
+
+    // release captures and cursors of old owner
+    if (m_cacheControllers)
+        m_cacheControllers->stop();
+
+    m_owner = owner;
+    bool isDraft = m_guiContext.isDraft();
+    m_guiContext = GuiContext(m_owner);
+    m_guiContext.setDraft(isDraft);
+    m_idleValidationTimer->setParent(m_owner);
+    m_compressionTimer->setParent(m_owner);
+    m_pendingMouseMove.reset();
+    if (m_debugOverlay)
+        m_debugOverlay->setOwner(m_owner);
+
+#if !defined(QT_NO_DEBUG)
+    m_trackOwner = m_owner;
+#endif
+
+    if (m_cacheControllers)
+    {
+        m_cacheControllers->widget = m_owner;
+        m_cacheControllers->resume();
+        m_owner->setMouseTracking(true);
+    }
+
+    m_owner->update();
+}
+
+void SpaceWidgetCore::onCacheSpaceChanged(const CacheSpace* cache, ChangeReason reason)
 {
     Q_UNUSED(cache);
     Q_ASSERT(m_mainCacheSpace.data() == cache);
+
+    if (!isRepaintRequiredImpl(reason))
+        return;
+
     // repaint owner widget
     m_owner->update();
 }
 
+void SpaceWidgetCore::onCacheSpaceItemsChanged(const CacheSpace* cache, const QRegion& windowRegion)
+{
+    Q_UNUSED(cache);
+    Q_ASSERT(m_mainCacheSpace.data() == cache);
+    // repaint changed items only
+    m_owner->update(windowRegion);
+}
+
+void SpaceWidgetCore::scheduleIdleValidation()
+{
+    if (m_idleValidationBudget > 0 && !m_idleValidationTimer->isActive())
+        m_idleValidationTimer->start();
+}
+
+void SpaceWidgetCore::onIdleValidation()
+{
+    if (!m_mainCacheSpace)
+        return;
+
+    // continue in the next event loop turn
+    if (!m_mainCacheSpace->validateAhead(m_guiContext, m_idleValidationBudget))
+        scheduleIdleValidation();
+}
+
 QPixmap SpaceWidgetCore::createPixmapImpl() const
 {
-    QPixmap image(m_mainCacheSpace->window().size());
+    QPixmap image(m_mainCacheSpace->viewWindow().size());
     image.fill(m_owner->palette().color(m_owner->backgroundRole()));
 
     {
         QPainter painter(&image);
         copyPainterState(m_owner, &painter);
-        painter.setWindow(m_mainCacheSpace->window());
+        painter.setWindow(m_mainCacheSpace->viewWindow());
 
         m_mainCacheSpace->drawRaw(&painter, guiContext());
     }
@@ -20,18 +20,23 @@
 #include "core/misc/ViewAuxiliary.h"
 
 #include <QMetaObject>
+#include <QScopedPointer>
 
 class QWidget;
 class QKeyEvent;
+class QMouseEvent;
+class QTimer;
 
 namespace Qi
 {
 
 class ID;
 class CacheSpace;
+class CacheSpaceStatistics;
 class Space;
 class CacheControllerMouse;
 class ControllerKeyboard;
+class SpaceWidgetDebugOverlay;
 
 class QI_EXPORT SpaceWidgetCore
 {
@@ -58,6 +63,24 @@ public:
 
     QPixmap createPixmap() const { return createPixmapImpl(); }
 
+    // attaches statistics to the main cache space
+    void setStatistics(SharedPtr<CacheSpaceStatistics> statistics);
+
+    // validates cache views ahead of drawing in idle time
+    // budget is in microseconds per event loop turn, 0 disables validation
+    int idleValidationBudget() const { return m_idleValidationBudget; }
+    void setIdleValidationBudget(int budget);
+
+    // coalesces mouse moves and wheel events arrived within one event loop turn
+    // and processes only the latest position with accumulated wheel delta
+    bool isEventCompression() const { return m_isEventCompression; }
+    void setEventCompression(bool isEventCompression);
+
+    // draws repainted regions, draw cost of cache views and frame counters over the widget
+    // it's enabled on initialization if QI_DEBUG_OVERLAY environment variable is set to 1
+    bool isDebugOverlay() const { return !m_debugOverlay.isNull(); }
+    void setDebugOverlay(bool isDebugOverlay);
+
 protected:
     explicit SpaceWidgetCore(QWidget* owner);
     ~SpaceWidgetCore();
@@ -69,13 +92,31 @@ protected:
     void stopControllers();
     void resumeControllers();
 
+    // rebinds drawing and controllers to another owner widget
+    // old owner should be alive during the call
+    void setOwner(QWidget* owner);
+
+    // switches drawing to draft (see GuiContext::isDraft), owner is repainted
+    // once draft is off to lay out draft items fully
+    void setDraft(bool isDraft);
+
     // scrolls widget to make visibleItem fully visible
     virtual void ensureVisibleImpl(const ID& visibleItem, const CacheSpace *cacheSpace, bool validateItem) = 0;
     // creates image of the widget
     virtual QPixmap createPixmapImpl() const;
+    // returns false if owner content is already updated for the main cache change
+    virtual bool isRepaintRequiredImpl(ChangeReason /*reason*/) const { return true; }
+    // processes compressed events before the next not compressed event
+    virtual void flushCompressedEventsImpl();
+    // requests flushCompressedEventsImpl call after queued events are processed
+    void scheduleCompressedEvents();
 
 private:
     void onCacheSpaceChanged(const CacheSpace* cache, ChangeReason reason);
+    void onCacheSpaceItemsChanged(const CacheSpace* cache, const QRegion& windowRegion);
+    void scheduleIdleValidation();
+    void onIdleValidation();
+    void flushPendingMouseMove();
 
     QWidget* m_owner;
 
@@ -86,6 +127,17 @@ private:
     GuiContext m_guiContext;
 
     QMetaObject::Connection m_connection;
+    QMetaObject::Connection m_itemsConnection;
+
+    QTimer* m_idleValidationTimer;
+    int m_idleValidationBudget;
+
+    bool m_isEventCompression;
+    QTimer* m_compressionTimer;
+    // latest mouse move waiting for m_compressionTimer
+    QScopedPointer<QMouseEvent> m_pendingMouseMove;
+
+    QScopedPointer<SpaceWidgetDebugOverlay> m_debugOverlay;
 
 #if !defined(QT_NO_DEBUG)
     QPointer<QWidget> m_trackOwner;
@@ -0,0 +1,193 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#include "SpaceWidgetDebugOverlay.h"
+#include "space/CacheSpace.h"
+#include <QWidget>
+#include <QPainter>
+#include <QTimer>
+
+namespace Qi
+{
+
+// repainted regions fade out during this time (in milliseconds)
+static const int FlashDuration = 400;
+static const int FadeInterval = 40;
+// cache views drawn faster are not tinted (in nanoseconds)
+static const qint64 CheapViewDrawTime = 20 * 1000;
+// cache views drawn slower are tinted red
+static const qint64 CostlyViewDrawTime = 1000 * 1000;
+
+static QString toMilliseconds(qint64 nanoseconds)
+{
+    return QString::number(double(nanoseconds) / 1000000., 'f', 2);
+}
+
+SpaceWidgetDebugOverlay::SpaceWidgetDebugOverlay(QWidget* owner, SharedPtr<CacheSpace> cacheSpace)
+    : m_owner(owner),
+      m_cacheSpace(std::move(cacheSpace)),
+      m_frameStart(0),
+      m_frameTime(0),
+      m_viewsTime(0),
+      m_fadeTimer(new QTimer())
+{
+    Q_ASSERT(m_owner);
+    Q_ASSERT(m_cacheSpace);
+
+    // keep statistics of the application if they are set
+    m_statistics = m_cacheSpace->statistics();
+    if (!m_statistics)
+    {
+        m_statistics = makeShared<CacheSpaceStatistics>();
+        m_cacheSpace->setStatistics(m_statistics);
+    }
+    m_lastCounters = m_statistics->counters();
+
+    m_recorder = [this](const QRect& deviceRect, qint64 duration) {
+        m_viewsTime += duration;
+        if (duration < CheapViewDrawTime)
+            return;
+
+        ViewCost cost;
+        cost.rect = deviceRect;
+        cost.duration = duration;
+        m_viewCosts.append(cost);
+    };
+
+    m_clock.start();
+    m_fadeTimer->setInterval(FadeInterval);
+    QObject::connect(m_fadeTimer.data(), &QTimer::timeout, [this]() { onFadeTimeout(); });
+}
+
+SpaceWidgetDebugOverlay::~SpaceWidgetDebugOverlay()
+{
+    setCacheViewDrawRecorder(nullptr);
+}
+
+void SpaceWidgetDebugOverlay::setOwner(QWidget* owner)
+{
+    Q_ASSERT(owner);
+    m_owner = owner;
+    m_flashes.clear();
+    m_selfUpdates = QRegion();
+}
+
+void SpaceWidgetDebugOverlay::beginPaint(const QRegion& exposedRegion)
+{
+    // repaint of fading flashes is not a new flash,
+    // bounds are compared as update regions may be merged
+    QRect exposedRect = exposedRegion.boundingRect();
+    if (!m_selfUpdates.boundingRect().contains(exposedRect))
+    {
+        Flash flash;
+        flash.rect = exposedRect;
+        flash.time = m_clock.elapsed();
+        m_flashes.append(flash);
+        m_fadeTimer->start();
+    }
+    m_selfUpdates = QRegion();
+
+    m_viewCosts.clear();
+    m_viewsTime = 0;
+    setCacheViewDrawRecorder(&m_recorder);
+    m_frameStart = m_clock.nsecsElapsed();
+}
+
+void SpaceWidgetDebugOverlay::endPaint(QPainter* painter)
+{
+    m_frameTime = m_clock.nsecsElapsed() - m_frameStart;
+    setCacheViewDrawRecorder(nullptr);
+
+    const auto& counters = m_statistics->counters();
+    m_frameCounters.itemsCreated = counters.itemsCreated - m_lastCounters.itemsCreated;
+    m_frameCounters.itemsRecycled = counters.itemsRecycled - m_lastCounters.itemsRecycled;
+    m_frameCounters.itemsReused = counters.itemsReused - m_lastCounters.itemsReused;
+    m_frameCounters.viewsLaidOut = counters.viewsLaidOut - m_lastCounters.viewsLaidOut;
+    m_frameCounters.validationsRebuilt = counters.validationsRebuilt - m_lastCounters.validationsRebuilt;
+    m_frameCounters.validationsOffset = counters.validationsOffset - m_lastCounters.validationsOffset;
+    m_lastCounters = counters;
+
+    painter->save();
+    painter->resetTransform();
+    painter->setPen(Qt::NoPen);
+
+    // green for cheap views, red for costly ones
+    for (const auto& cost : m_viewCosts)
+    {
+        double ratio = qBound(0., double(cost.duration - CheapViewDrawTime) / (CostlyViewDrawTime - CheapViewDrawTime), 1.);
+        painter->setBrush(QColor::fromHsvF((1. - ratio) / 3., 1., 1., 0.35));
+        painter->drawRect(cost.rect);
+    }
+
+    qint64 now = m_clock.elapsed();
+    for (const auto& flash : m_flashes)
+    {
+        double alpha = 0.4 * (1. - double(now - flash.time) / FlashDuration);
+        if (alpha <= 0.)
+            continue;
+        painter->setBrush(QColor::fromRgbF(1., 0., 1., alpha));
+        painter->drawRect(flash.rect);
+    }
+
+    drawHud(painter);
+    painter->restore();
+}
+
+QRect SpaceWidgetDebugOverlay::hudRect() const
+{
+    QFontMetrics metrics(m_owner->font());
+    return QRect(4, 4, metrics.averageCharWidth() * 36, metrics.height() * 4 + 8);
+}
+
+void SpaceWidgetDebugOverlay::drawHud(QPainter* painter) const
+{
+    QRect rect = hudRect();
+    painter->setBrush(QColor(0, 0, 0, 160));
+    painter->drawRect(rect);
+
+    QStringList lines;
+    lines << QString("frame %1 ms, views %2 ms").arg(toMilliseconds(m_frameTime), toMilliseconds(m_viewsTime));
+    lines << QString("items created %1 recycled %2").arg(m_frameCounters.itemsCreated).arg(m_frameCounters.itemsRecycled);
+    lines << QString("items reused %1 laid out %2").arg(m_frameCounters.itemsReused).arg(m_frameCounters.viewsLaidOut);
+    lines << QString("validations %1 rebuilt %2").arg(m_frameCounters.validationsOffset + m_frameCounters.validationsRebuilt).arg(m_frameCounters.validationsRebuilt);
+
+    painter->setPen(Qt::white);
+    painter->setFont(m_owner->font());
+    painter->drawText(rect.adjusted(4, 4, -4, -4), Qt::AlignLeft | Qt::AlignTop, lines.join(QLatin1Char('\n')));
+}
+
+void SpaceWidgetDebugOverlay::onFadeTimeout()
+{
+    qint64 now = m_clock.elapsed();
+
+    // expired flashes are repainted once more to clear them
+    QRegion region = hudRect();
+    for (int i = m_flashes.size() - 1; i >= 0; --i)
+    {
+        region |= m_flashes[i].rect;
+        if (now - m_flashes[i].time > FlashDuration)
+            m_flashes.remove(i);
+    }
+
+    if (m_flashes.isEmpty())
+        m_fadeTimer->stop();
+
+    m_selfUpdates |= region;
+    m_owner->update(region);
+}
+
+} // end namespace Qi
@@ -0,0 +1,93 @@
+/*
+   Copyright (c) 2008-1015 Alex Zhondin <qtinuum.team@gmail.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+       http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+*/
+
+
+#ifndef QI_SPACE_WIDGET_DEBUG_OVERLAY_H
+#define QI_SPACE_WIDGET_DEBUG_OVERLAY_H
+
+#include "space/CacheSpaceStatistics.h"
+#include "cache/CacheView.h"
+#include <QElapsedTimer>
+#include <QRegion>
+#include <QScopedPointer>
+
+class QWidget;
+class QPainter;
+class QTimer;
+
+namespace Qi
+{
+
+class CacheSpace;
+
+// paint profiler drawn over space widget (see SpaceWidgetCore::setDebugOverlay)
+// flashes repainted regions, tints cache views by draw cost and shows
+// frame time with cache counters of the main cache space
+class QI_EXPORT SpaceWidgetDebugOverlay
+{
+    Q_DISABLE_COPY(SpaceWidgetDebugOverlay)
+
+public:
+    SpaceWidgetDebugOverlay(QWidget* owner, SharedPtr<CacheSpace> cacheSpace);
+    ~SpaceWidgetDebugOverlay();
+
+    void setOwner(QWidget* owner);
+
+    // wrap drawing of owner content in paint event
+    void beginPaint(const QRegion& exposedRegion);
+    void endPaint(QPainter* painter);
+
+private:
+    struct Flash
+    {
+        QRect rect;
+        qint64 time;
+    };
+
+    struct ViewCost
+    {
+        QRect rect;
+        qint64 duration;
+    };
+
+    QRect hudRect() const;
+    void drawHud(QPainter* painter) const;
+    void onFadeTimeout();
+
+    QWidget* m_owner;
+    SharedPtr<CacheSpace> m_cacheSpace;
+    SharedPtr<CacheSpaceStatistics> m_statistics;
+
+    QElapsedTimer m_clock;
+    QVector<Flash> m_flashes;
+    // repaints requested by overlay itself are not flashed
+    QRegion m_selfUpdates;
+
+    CacheViewDrawRecorder m_recorder;
+    QVector<ViewCost> m_viewCosts;
+
+    qint64 m_frameStart;
+    qint64 m_frameTime;
+    qint64 m_viewsTime;
+    CacheSpaceStatistics::Counters m_lastCounters;
+    CacheSpaceStatistics::Counters m_frameCounters;
+
+    QScopedPointer<QTimer> m_fadeTimer;
+};
+
+} // end namespace Qi
+
+#endif // QI_SPACE_WIDGET_DEBUG_OVERLAY_H
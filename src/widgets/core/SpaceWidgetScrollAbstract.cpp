@@ -17,22 +17,58 @@
 #include "SpaceWidgetScrollAbstract.h"
 #include "space/CacheSpace.h"
 #include "cache/CacheItem.h"
+#include "utils/auto_value.h"
+#include "utils/FrameScheduler.h"
 
 #include <QScrollBar>
 #include <QKeyEvent>
+#include <QWheelEvent>
+#include <QVariantAnimation>
+#include <QTimer>
+#include <QApplication>
+#ifndef QT_NO_OPENGL
+#include <QOpenGLWidget>
+#endif
 
 namespace Qi
 {
 
+// scrolls separated by longer pause start velocity estimation again
+static const qint64 ScrollVelocityResetInterval = 200;
+// fast scrolling ends if widget isn't scrolled within the interval
+static const int FastScrollStopInterval = 100;
+
 SpaceWidgetScrollAbstract::SpaceWidgetScrollAbstract(QWidget* parent)
     : QAbstractScrollArea(parent),
       SpaceWidgetCore(viewport()),
-      m_isCacheItemsLayoutValid(false)
+      m_isCacheItemsLayoutValid(false),
+      m_scrollByBlit(true),
+      m_isScrollingByBlit(false),
+      m_isAcceleratedViewport(false),
+      m_isSmoothScrolling(false),
+      m_smoothScrollValidationBudget(0),
+      m_smoothScrollAnimation(new QVariantAnimation(this)),
+      m_draftScrollVelocity(0),
+      m_scrollVelocity(0.0),
+      m_isFastScrolling(false),
+      m_fastScrollTimer(new QTimer(this))
 {
     // enable tracking mouse moves
     //viewport()->setMouseTracking(true);
     // enable focus
     setFocusPolicy(Qt::StrongFocus);
+
+    // decelerating scroll like flick gesture
+    m_smoothScrollAnimation->setDuration(160);
+    m_smoothScrollAnimation->setEasingCurve(QEasingCurve::OutCubic);
+    connect(m_smoothScrollAnimation, &QVariantAnimation::valueChanged, this, &SpaceWidgetScrollAbstract::onSmoothScrollFrame);
+
+    m_fastScrollTimer->setSingleShot(true);
+    m_fastScrollTimer->setInterval(FastScrollStopInterval);
+    connect(m_fastScrollTimer, &QTimer::timeout, this, [this]() {
+        m_scrollVelocity = 0.0;
+        setFastScrolling(false);
+    });
 }
 
 SpaceWidgetScrollAbstract::~SpaceWidgetScrollAbstract()
@@ -56,6 +92,110 @@ bool SpaceWidgetScrollAbstract::initSpaceWidgetScrollable(SharedPtr<CacheSpace>
     return initSpaceWidgetCore(std::move(mainCacheSpace));
 }
 
+void SpaceWidgetScrollAbstract::setScrollByBlit(bool scrollByBlit)
+{
+    m_scrollByBlit = scrollByBlit;
+}
+
+void SpaceWidgetScrollAbstract::setAcceleratedViewport(bool isAccelerated)
+{
+#if defined(QT_NO_OPENGL)
+    // only raster viewport is available
+    Q_UNUSED(isAccelerated);
+#else
+    if (m_isAcceleratedViewport == isAccelerated)
+        return;
+
+    QWidget* newViewport = isAccelerated ? new QOpenGLWidget() : new QWidget();
+    // move core to new viewport before old one is deleted
+    setOwner(newViewport);
+    setViewport(newViewport);
+    m_isAcceleratedViewport = isAccelerated;
+
+    invalidateCacheItemsLayout();
+#endif
+}
+
+void SpaceWidgetScrollAbstract::setSmoothScrolling(bool isSmoothScrolling)
+{
+    m_isSmoothScrolling = isSmoothScrolling;
+    if (!m_isSmoothScrolling)
+        m_smoothScrollAnimation->stop();
+}
+
+int SpaceWidgetScrollAbstract::smoothScrollDuration() const
+{
+    return m_smoothScrollAnimation->duration();
+}
+
+void SpaceWidgetScrollAbstract::setSmoothScrollDuration(int duration)
+{
+    Q_ASSERT(duration >= 0);
+    m_smoothScrollAnimation->setDuration(duration);
+}
+
+void SpaceWidgetScrollAbstract::setSmoothScrollValidationBudget(int budget)
+{
+    Q_ASSERT(budget >= 0);
+    m_smoothScrollValidationBudget = budget;
+}
+
+void SpaceWidgetScrollAbstract::setDraftScrollVelocity(int velocity)
+{
+    Q_ASSERT(velocity >= 0);
+    m_draftScrollVelocity = velocity;
+    if (m_draftScrollVelocity == 0)
+        setFastScrolling(false);
+}
+
+void SpaceWidgetScrollAbstract::updateScrollVelocity(int dx, int dy)
+{
+    qint64 elapsed = m_scrollVelocityTimer.isValid() ? m_scrollVelocityTimer.restart() : ScrollVelocityResetInterval;
+    if (!m_scrollVelocityTimer.isValid())
+        m_scrollVelocityTimer.start();
+
+    if (elapsed >= ScrollVelocityResetInterval)
+    {
+        // single scroll after a pause isn't fast
+        m_scrollVelocity = 0.0;
+    }
+    else
+    {
+        // smoothed over several frames, scrolls within one millisecond are summed
+        qreal distance = qMax(qAbs(dx), qAbs(dy));
+        qreal velocity = distance * 1000.0 / qMax(elapsed, qint64(1));
+        m_scrollVelocity = (m_scrollVelocity + velocity) / 2.0;
+    }
+
+    if (m_draftScrollVelocity == 0)
+        return;
+
+    // slower scrolling ends fast one with hysteresis
+    if (m_scrollVelocity > m_draftScrollVelocity)
+        setFastScrolling(true, QPoint(dx, dy));
+    else if (m_scrollVelocity < m_draftScrollVelocity / 2)
+        setFastScrolling(false);
+
+    if (m_isFastScrolling)
+        m_fastScrollTimer->start();
+}
+
+void SpaceWidgetScrollAbstract::setFastScrolling(bool isFastScrolling, QPoint direction)
+{
+    // direction may be changed while fast scrolling
+    if (m_scrollableCacheSpace)
+        m_scrollableCacheSpace->setPrefetchDirection(isFastScrolling ? direction : QPoint());
+
+    if (m_isFastScrolling == isFastScrolling)
+        return;
+
+    m_isFastScrolling = isFastScrolling;
+    if (!m_isFastScrolling)
+        m_fastScrollTimer->stop();
+
+    setDraft(m_isFastScrolling);
+}
+
 void SpaceWidgetScrollAbstract::onScrollCacheSpaceChanged(const CacheSpace* cache, ChangeReason reason)
 {
     Q_UNUSED(cache);
@@ -116,6 +256,101 @@ void SpaceWidgetScrollAbstract::ensureVisibleImpl(const ID& visibleItem, const C
     }
 }
 
+void SpaceWidgetScrollAbstract::wheelEvent(QWheelEvent* event)
+{
+    if (!isEventCompression())
+    {
+        processWheel(event);
+        return;
+    }
+
+    // don't mix deltas with different modifiers
+    if (m_pendingWheel && (m_pendingWheel->modifiers() != event->modifiers()))
+        flushCompressedEventsImpl();
+
+    QPoint pixelDelta = event->pixelDelta();
+    QPoint angleDelta = event->angleDelta();
+    if (m_pendingWheel)
+    {
+        pixelDelta += m_pendingWheel->pixelDelta();
+        angleDelta += m_pendingWheel->angleDelta();
+    }
+
+    Qt::Orientation orientation = (qAbs(angleDelta.x()) > qAbs(angleDelta.y())) ? Qt::Horizontal : Qt::Vertical;
+    int delta = (orientation == Qt::Horizontal) ? angleDelta.x() : angleDelta.y();
+    m_pendingWheel.reset(new QWheelEvent(event->posF(), event->globalPosF(), pixelDelta, angleDelta,
+                                         delta, orientation, event->buttons(), event->modifiers()));
+
+    event->accept();
+    scheduleCompressedEvents();
+}
+
+void SpaceWidgetScrollAbstract::flushCompressedEventsImpl()
+{
+    SpaceWidgetCore::flushCompressedEventsImpl();
+
+    if (!m_pendingWheel)
+        return;
+
+    QScopedPointer<QWheelEvent> wheel(m_pendingWheel.take());
+    processWheel(wheel.data());
+}
+
+void SpaceWidgetScrollAbstract::processWheel(QWheelEvent* event)
+{
+    // zoom and page scrolling are left to scrollbars
+    if (!m_isSmoothScrolling || (event->modifiers() & (Qt::ControlModifier | Qt::ShiftModifier)))
+    {
+        QAbstractScrollArea::wheelEvent(event);
+        return;
+    }
+
+    QPoint delta = event->pixelDelta();
+    if (delta.isNull())
+    {
+        // one wheel notch (120) is wheelScrollLines single steps
+        QPoint angleDelta = event->angleDelta();
+        int lines = QApplication::wheelScrollLines();
+        delta.rx() = angleDelta.x() * lines * horizontalScrollBar()->singleStep() / 120;
+        delta.ry() = angleDelta.y() * lines * verticalScrollBar()->singleStep() / 120;
+    }
+
+    event->accept();
+    smoothScrollBy(-delta);
+}
+
+void SpaceWidgetScrollAbstract::smoothScrollBy(QPoint delta)
+{
+    QPoint current(horizontalScrollBar()->value(), verticalScrollBar()->value());
+
+    // continue from the previous target to accumulate fast wheel rotations
+    if (m_smoothScrollAnimation->state() != QAbstractAnimation::Running)
+        m_smoothScrollTarget = current;
+
+    m_smoothScrollTarget += delta;
+    m_smoothScrollTarget.rx() = qBound(horizontalScrollBar()->minimum(), m_smoothScrollTarget.x(), horizontalScrollBar()->maximum());
+    m_smoothScrollTarget.ry() = qBound(verticalScrollBar()->minimum(), m_smoothScrollTarget.y(), verticalScrollBar()->maximum());
+
+    m_smoothScrollAnimation->stop();
+    if (m_smoothScrollTarget == current)
+        return;
+
+    m_smoothScrollAnimation->setStartValue(current);
+    m_smoothScrollAnimation->setEndValue(m_smoothScrollTarget);
+    m_smoothScrollAnimation->start();
+}
+
+void SpaceWidgetScrollAbstract::onSmoothScrollFrame(const QVariant& value)
+{
+    QPoint position = value.toPoint();
+    horizontalScrollBar()->setValue(position.x());
+    verticalScrollBar()->setValue(position.y());
+
+    // prepare items which will appear in the next frames
+    if (m_smoothScrollValidationBudget > 0)
+        mainCacheSpace().validateAhead(guiContext(), m_smoothScrollValidationBudget);
+}
+
 bool SpaceWidgetScrollAbstract::viewportEvent(QEvent* event)
 {
     bool result = QAbstractScrollArea::viewportEvent(event);
@@ -165,8 +400,24 @@ void SpaceWidgetScrollAbstract::focusOutEvent(QFocusEvent * event)
 
 void SpaceWidgetScrollAbstract::scrollContentsBy(int dx, int dy)
 {
-    QAbstractScrollArea::scrollContentsBy(dx, dy);
-    updateCacheScrollOffsetImpl();
+    // content moves opposite to scroll offset
+    updateScrollVelocity(-dx, -dy);
+
+    // blit is possible if painted content is laid out
+    // OpenGL viewport content cannot be moved
+    if (!m_scrollByBlit || m_isAcceleratedViewport || !m_isCacheItemsLayoutValid)
+    {
+        QAbstractScrollArea::scrollContentsBy(dx, dy);
+        updateCacheScrollOffsetImpl();
+        return;
+    }
+
+    {
+        auto_value<bool> scrolling(m_isScrollingByBlit, true);
+        updateCacheScrollOffsetImpl();
+    }
+
+    scrollViewportImpl(dx, dy);
 }
 
 QSize SpaceWidgetScrollAbstract::viewportSizeHint() const
@@ -231,6 +482,25 @@ void SpaceWidgetScrollAbstract::updateCacheScrollOffsetImpl()
     m_scrollableCacheSpace->setScrollOffset(scrollPos);
 }
 
+void SpaceWidgetScrollAbstract::scrollViewportImpl(int dx, int dy)
+{
+    Q_ASSERT(!m_scrollableCacheSpace.isNull());
+    if (m_scrollableCacheSpace.isNull())
+        return;
+
+    // offsets of scaled cache space are not whole pixels
+    if (m_scrollableCacheSpace->scale() != 1.)
+        viewport()->update(m_scrollableCacheSpace->viewWindow());
+    else
+        viewport()->scroll(dx, dy, m_scrollableCacheSpace->viewWindow());
+}
+
+bool SpaceWidgetScrollAbstract::isBlitScrollChange(ChangeReason reason) const
+{
+    // scroll offset changes come as frame changes
+    return m_isScrollingByBlit && (reason == (ChangeReasonCacheItems|ChangeReasonCacheFrame));
+}
+
 void SpaceWidgetScrollAbstract::validateCacheItemsLayoutImpl()
 {
     rMainCacheSpace().setWindow(viewport()->rect());
@@ -242,8 +512,11 @@ void SpaceWidgetScrollAbstract::invalidateCacheItemsLayout()
     //stopControllers();
 
     m_isCacheItemsLayoutValid = false;
-    // request to repaint
-    update();
+
+    // lay out once per frame after lines changes and repaint after layout
+    auto scheduler = FrameScheduler::of(this);
+    scheduler->schedule(FramePhaseLayout, this, "validateCacheItemsLayout", [this]() { validateCacheItemsLayout(); });
+    scheduler->schedule(FramePhasePaint, this, "update", [this]() { update(); });
 }
 
 void SpaceWidgetScrollAbstract::validateCacheItemsLayout()
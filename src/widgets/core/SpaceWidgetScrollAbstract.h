@@ -19,6 +19,11 @@
 
 #include "SpaceWidgetCore.h"
 #include <QAbstractScrollArea>
+#include <QElapsedTimer>
+
+class QWheelEvent;
+class QVariantAnimation;
+class QTimer;
 
 namespace Qi
 {
@@ -31,6 +36,36 @@ class QI_EXPORT SpaceWidgetScrollAbstract: public QAbstractScrollArea, public Sp
 public:
     virtual ~SpaceWidgetScrollAbstract();
 
+    // scroll by moving painted viewport content, only exposed parts are repainted
+    bool isScrollByBlit() const { return m_scrollByBlit; }
+    void setScrollByBlit(bool scrollByBlit);
+
+    // paints viewport through OpenGL paint engine instead of raster one
+    // blit scrolling is not used while viewport is accelerated
+    // viewport widget is replaced, so set it before installing viewport event filters
+    bool isAcceleratedViewport() const { return m_isAcceleratedViewport; }
+    void setAcceleratedViewport(bool isAccelerated);
+
+    // animates wheel scrolling to the target position frame by frame
+    bool isSmoothScrolling() const { return m_isSmoothScrolling; }
+    void setSmoothScrolling(bool isSmoothScrolling);
+    // duration of one wheel scroll animation in milliseconds
+    int smoothScrollDuration() const;
+    void setSmoothScrollDuration(int duration);
+    // validates cache views ahead of drawing on each animation frame
+    // budget is in microseconds per frame, 0 disables validation
+    int smoothScrollValidationBudget() const { return m_smoothScrollValidationBudget; }
+    void setSmoothScrollValidationBudget(int budget);
+
+    // scrolling faster than the velocity (in pixels per second) draws items in draft
+    // (see GuiContext::isDraft) and prefetches them ahead of scrolling only,
+    // full drawing is restored once scrolling slows down, 0 disables it
+    int draftScrollVelocity() const { return m_draftScrollVelocity; }
+    void setDraftScrollVelocity(int velocity);
+    // estimated scrolling speed in pixels per second
+    qreal scrollVelocity() const { return m_scrollVelocity; }
+    bool isFastScrolling() const { return m_isFastScrolling; }
+
 protected:
     explicit SpaceWidgetScrollAbstract(QWidget *parent = nullptr);
 
@@ -42,28 +77,61 @@ protected:
     void focusInEvent(QFocusEvent * event) override;
     void focusOutEvent(QFocusEvent * event) override;
     void scrollContentsBy(int dx, int dy) override;
+    void wheelEvent(QWheelEvent* event) override;
     QSize viewportSizeHint() const override;
 
     // SpaceWidgetCore implementation
     void ensureVisibleImpl(const ID& visibleItem, const CacheSpace *cacheSpace, bool validateItem) override;
+    bool isRepaintRequiredImpl(ChangeReason reason) const override { return !isBlitScrollChange(reason); }
+    void flushCompressedEventsImpl() override;
 
     void updateScrollbars();
     void invalidateCacheItemsLayout();
     void validateCacheItemsLayout();
 
+    // true if cache change is caused by blit scrolling and needs no repaint
+    bool isBlitScrollChange(ChangeReason reason) const;
+
     virtual void validateCacheItemsLayoutImpl();
     virtual QSize calculateVirtualSizeImpl() const;
     virtual QSize calculateScrollableSizeImpl() const;
     virtual void updateCacheScrollOffsetImpl();
+    // moves painted content of scrollable parts of viewport
+    virtual void scrollViewportImpl(int dx, int dy);
 
 private:
     // hide method
     using SpaceWidgetCore::initSpaceWidgetCore;
     void onScrollCacheSpaceChanged(const CacheSpace* cache, ChangeReason reason);
+    void processWheel(QWheelEvent* event);
+    void smoothScrollBy(QPoint delta);
+    void onSmoothScrollFrame(const QVariant& value);
+    // dx, dy are scroll offset changes
+    void updateScrollVelocity(int dx, int dy);
+    void setFastScrolling(bool isFastScrolling, QPoint direction = QPoint());
 
     SharedPtr<CacheSpace> m_scrollableCacheSpace;
 
     bool m_isCacheItemsLayoutValid;
+    bool m_scrollByBlit;
+    bool m_isScrollingByBlit;
+    bool m_isAcceleratedViewport;
+    // wheel event with accumulated deltas waiting for compressed events flush
+    QScopedPointer<QWheelEvent> m_pendingWheel;
+
+    bool m_isSmoothScrolling;
+    int m_smoothScrollValidationBudget;
+    QVariantAnimation* m_smoothScrollAnimation;
+    // final scroll position of smooth scrolling
+    QPoint m_smoothScrollTarget;
+
+    int m_draftScrollVelocity;
+    qreal m_scrollVelocity;
+    bool m_isFastScrolling;
+    // time since the previous scroll
+    QElapsedTimer m_scrollVelocityTimer;
+    // ends fast scrolling once scroll stops
+    QTimer* m_fastScrollTimer;
 };
 
 } // end namespace Qi
@@ -2,6 +2,7 @@
 #include "test_ranges.h"
 #include "test_lines.h"
 #include "test_grid.h"
+#include "test_scale.h"
 
 #include <QtTest/QtTest>
 
@@ -18,6 +19,7 @@ int main(int argc, char* argv[])
     tests.append(&TestRanges::staticMetaObject);
     tests.append(&TestLines::staticMetaObject);
     tests.append(&TestGrid::staticMetaObject);
+    tests.append(&TestScale::staticMetaObject);
 
     // run tests
     foreach (const QMetaObject* testMetaObject, tests)
@@ -1,6 +1,17 @@
 #include "test_grid.h"
 #include "test_item_id.h"
 #include "space/grid/SpaceGrid.h"
+#include "space/grid/RowsGrouping.h"
+#include "core/ext/ModelStore.h"
+#include "core/ext/ModelStoreSnapshot.h"
+#include "core/ext/ModelAggregate.h"
+#include "utils/MemoryResource.h"
+#include "core/ext/Views.h"
+#include "items/sorting/Sorting.h"
+#include "items/selection/Selection.h"
+#include "items/selection/SelectionPaste.h"
+#include "misc/GridOverview.h"
+#include "cache/CacheItemFactory.h"
 #include "SignalSpy.h"
 #include <QtTest/QtTest>
 
@@ -142,3 +153,747 @@ void TestGrid::test()
     QCOMPARE(signalSpy.size(), 26);
     */
 }
+
+void TestGrid::testModelUpdate()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(10);
+    grid->columns()->setCount(2);
+
+    ModelStorageGrid<int> model(grid);
+
+    auto changedSpy = createSignalSpy(&model, &Model::modelChanged);
+    QVector<int> itemsSizes;
+    QObject::connect(&model, &Model::modelItemsChanged, [&itemsSizes](const Model*, const QVector<ID>& ids) {
+        itemsSizes.append(ids.size());
+    });
+
+    {
+        ModelUpdateGuard guard(model);
+        model.setValue(GridID(1, 0), 1);
+        model.setValue(GridID(2, 1), 2);
+        model.setValue(GridID(2, 1), 3);
+        QVERIFY(changedSpy.empty());
+    }
+    QCOMPARE(changedSpy.size(), 1);
+    QCOMPARE(itemsSizes, QVector<int>() << 2);
+    QCOMPARE(model.valueAt(GridID(2, 1)), 3);
+
+    model.beginUpdate();
+    model.beginUpdate();
+    model.setValue(GridID(3, 0), 1);
+    int values[] = { 1, 2, 3 };
+    model.setColumnValues(1, values, 3);
+    model.endUpdate();
+    QCOMPARE(changedSpy.size(), 1);
+    model.endUpdate();
+    // whole model change has no items
+    QCOMPARE(changedSpy.size(), 2);
+    QCOMPARE(itemsSizes.size(), 1);
+
+    model.setValue(GridID(4, 0), 1);
+    QCOMPARE(changedSpy.size(), 3);
+}
+
+void TestGrid::testSortOrdinal()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(6);
+    grid->columns()->setCount(1);
+
+    ModelStorageGrid<Qt::CheckState> model(grid);
+    Qt::CheckState states[] = { Qt::Checked, Qt::Unchecked, Qt::PartiallyChecked, Qt::Checked, Qt::Unchecked, Qt::Checked };
+    model.setColumnValues(0, states, 6);
+    QCOMPARE(model.ordinalKeysCount(), 3);
+
+    // equal keys keep their order
+    grid->sortColumnByModel(0, model, true, true);
+    QCOMPARE(grid->rows()->permutation(), QVector<int>() << 1 << 4 << 2 << 0 << 3 << 5);
+
+    grid->rows()->setPermutation(QVector<int>() << 0 << 1 << 2 << 3 << 4 << 5);
+    grid->sortColumnByModel(0, model, false, true);
+    QCOMPARE(grid->rows()->permutation(), QVector<int>() << 0 << 3 << 5 << 2 << 1 << 4);
+}
+
+void TestGrid::testModelRing()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->columns()->setCount(2);
+
+    ModelStorageGridRing<int> model(grid, 4);
+    for (int i = 0; i < 6; ++i)
+    {
+        int row = model.appendRows(1);
+        model.setValue(GridID(row, 0), i);
+        model.setValue(GridID(row, 1), i * 10);
+    }
+
+    // first rows are dropped
+    QCOMPARE(grid->rowsCount(), 4);
+    QCOMPARE(model.rowsCount(), 4);
+    QCOMPARE(model.valueAt(GridID(0, 0)), 2);
+    QCOMPARE(model.valueAt(GridID(3, 0)), 5);
+    QCOMPARE(model.valueAt(GridID(3, 1)), 50);
+
+    // values stay attached to their rows
+    grid->rows()->removeLines(1);
+    QCOMPARE(model.valueAt(GridID(0, 0)), 2);
+    QCOMPARE(model.valueAt(GridID(1, 0)), 4);
+    QCOMPARE(model.valueAt(GridID(2, 1)), 50);
+
+    grid->rows()->insertLines(0);
+    QCOMPARE(model.valueAt(GridID(0, 0)), 0);
+    QCOMPARE(model.valueAt(GridID(1, 0)), 2);
+    QCOMPARE(model.valueAt(GridID(3, 0)), 5);
+}
+
+void TestGrid::testRowsGrouping()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(4);
+    grid->columns()->setCount(2);
+
+    auto model = makeShared<ModelStorageGrid<int>>(grid);
+    int keys[] = { 2, 1, 2, 3 };
+    for (int row = 0; row < 4; ++row)
+    {
+        model->setValue(GridID(row, 0), keys[row]);
+        model->setValue(GridID(row, 1), (row + 1) * 10);
+    }
+
+    auto rows = makeShared<Lines>();
+    RowsGrouping grouping(rows, model, 0, 4);
+    int sum = grouping.addAggregate<int>(model, 1);
+
+    // collapsed groups have header rows only
+    QCOMPARE(rows->count(), 3);
+    QCOMPARE(grouping.groups().size(), 3);
+    int group = grouping.groupOfRow(1);
+    QCOMPARE(grouping.groupDataRows(group), QVector<int>() << 0 << 2);
+    QCOMPARE(grouping.aggregate(group, sum, RowsGrouping::AggregateSum), 40.);
+
+    QVERIFY(grouping.tree().expand(1));
+    QCOMPARE(rows->count(), 5);
+    QVERIFY(grouping.isGroupRow(1));
+    QCOMPARE(grouping.dataRow(2), 0);
+    QCOMPARE(grouping.dataRow(3), 2);
+    QCOMPARE(grouping.groupOfRow(3), group);
+
+    // aggregates follow changed values
+    auto spy = createSignalSpy(&grouping, &RowsGrouping::aggregatesChanged);
+    model->setValue(GridID(2, 1), 5);
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(grouping.aggregate(group, sum, RowsGrouping::AggregateSum), 15.);
+    QCOMPARE(grouping.aggregate(group, sum, RowsGrouping::AggregateMin), 5.);
+    QCOMPARE(grouping.aggregate(group, sum, RowsGrouping::AggregateMax), 10.);
+
+    // row moves to the group of its new key
+    model->setValue(GridID(0, 0), 3);
+    QCOMPARE(rows->count(), 4);
+    QCOMPARE(grouping.dataRow(2), 2);
+    int lastGroup = grouping.groupOfRow(3);
+    QCOMPARE(grouping.groupDataRows(lastGroup), QVector<int>() << 0 << 3);
+    QCOMPARE(grouping.aggregate(lastGroup, sum, RowsGrouping::AggregateSum), 50.);
+    QCOMPARE(grouping.aggregate(group, sum, RowsGrouping::AggregateMax), 5.);
+
+    // single row group is moved to its new place
+    model->setValue(GridID(1, 0), 5);
+    QCOMPARE(grouping.groups().size(), 3);
+    QCOMPARE(grouping.groupDataRows(grouping.groups().last()), QVector<int>() << 1);
+    QCOMPARE(grouping.groupRow(group), 0);
+}
+
+void TestGrid::testColumnAggregates()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->setDimensions(4, 2);
+
+    auto model = makeShared<ModelStorageGrid<int>>(grid);
+    for (int row = 0; row < 4; ++row)
+        model->setValue(GridID(row, 1), (row + 1) * 10);
+
+    auto aggregates = makeColumnAggregates<int>(model, 1, grid->rows());
+    ModelAggregate modelSum(aggregates, AggregateSum);
+    QCOMPARE(aggregates->sum(), 100.);
+    QCOMPARE(aggregates->count(), 4);
+    QCOMPARE(aggregates->mean(), 25.);
+    QCOMPARE(modelSum.value(ID(GridID(0, 7))), 100.);
+
+    // changed items update aggregates by difference
+    auto spy = createSignalSpy(aggregates.data(), &ColumnAggregates::aggregatesChanged);
+    model->setValue(GridID(3, 1), 5);
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(aggregates->sum(), 65.);
+    QCOMPARE(aggregates->min(), 5.);
+    QCOMPARE(aggregates->max(), 30.);
+
+    // other columns are ignored
+    model->setValue(GridID(0, 0), 1000);
+    QCOMPARE(spy.size(), 1);
+
+    // hidden rows are excluded
+    grid->rows()->setLineVisible(2, false);
+    QCOMPARE(aggregates->sum(), 35.);
+    QCOMPARE(aggregates->count(), 3);
+    QCOMPARE(aggregates->max(), 20.);
+    model->setValue(GridID(2, 1), 1);
+    QCOMPARE(aggregates->min(), 5.);
+
+    grid->rows()->setLineVisible(2, true);
+    QCOMPARE(aggregates->sum(), 36.);
+    QCOMPARE(aggregates->min(), 1.);
+
+    // removed rows are excluded, inserted rows are read from model
+    grid->rows()->removeLines(0);
+    QCOMPARE(aggregates->sum(), 26.);
+    QCOMPARE(aggregates->count(), 3);
+    grid->rows()->insertLines(0);
+    QCOMPARE(aggregates->count(), 4);
+    QCOMPARE(aggregates->sum(), 26. + model->value(GridID(0, 1)));
+}
+
+void TestGrid::testSchemasByColumnRanges()
+{
+    auto grid = makeShared<SpaceGrid>(SpaceGridHintSameSchemasByColumnRanges);
+    grid->rows()->setCount(2);
+    grid->columns()->setCount(6);
+
+    auto viewLeft = makeShared<ViewCallback>();
+    auto viewRight = makeShared<ViewCallback>();
+    grid->addSchema(makeRangeGridColumns(0, 3), viewLeft);
+    grid->addSchema(makeRangeGridColumns(3, 6), viewRight);
+
+    auto factory = grid->createCacheItemFactory();
+    for (int row = 0; row < 2; ++row)
+    {
+        for (int column = 5; column >= 0; --column)
+        {
+            auto info = factory->create(ID(GridID(row, column)));
+            QVERIFY(info.schema.view == (column < 3 ? viewLeft : viewRight));
+        }
+    }
+
+    // memoized schemas follow schemas of the space
+    grid->removeSchema(viewRight);
+    QVERIFY(!factory->create(ID(GridID(0, 4))).schema.isValid());
+    QVERIFY(factory->create(ID(GridID(1, 1))).schema.view == viewLeft);
+}
+
+void TestGrid::testSchemasUniformity()
+{
+    QCOMPARE(makeRangeGridColumn(1)->uniformity(), int(RangeUniformByColumn));
+    QCOMPARE(makeRangeGridRows(0, 2)->uniformity(), int(RangeUniformByRow));
+    QCOMPARE(makeRangeGridRect(0, 2, 0, 2)->uniformity(), int(RangeUniformNone));
+
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(4);
+    grid->columns()->setCount(4);
+
+    auto viewColumn = makeShared<ViewCallback>();
+    auto viewRect = makeShared<ViewCallback>();
+    grid->addSchema(makeRangeGridColumn(1), viewColumn);
+
+    // column uniform schemas only
+    auto factory = grid->createCacheItemFactory();
+    QVERIFY(factory->create(ID(GridID(0, 1))).schema.view == viewColumn);
+    QVERIFY(factory->create(ID(GridID(3, 1))).schema.view == viewColumn);
+    QVERIFY(!factory->create(ID(GridID(3, 2))).schema.isValid());
+
+    // non uniform range is tested per item
+    grid->addSchema(makeRangeGridRect(2, 4, 2, 4), viewRect);
+    QVERIFY(factory->create(ID(GridID(0, 1))).schema.view == viewColumn);
+    QVERIFY(!factory->create(ID(GridID(0, 2))).schema.isValid());
+    QVERIFY(factory->create(ID(GridID(3, 2))).schema.view == viewRect);
+    QVERIFY(factory->create(ID(GridID(2, 3))).schema.view == viewRect);
+}
+
+void TestGrid::testIteratorsBatch()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(300);
+    grid->columns()->setCount(3);
+
+    {
+        ItemsIteratorGridByColumn it(*grid, 1);
+        GridID ids[IdIterator::BatchSize];
+        QCOMPARE(it.fetchGridIds(ids, IdIterator::BatchSize), int(IdIterator::BatchSize));
+        QCOMPARE(ids[0].row, 0);
+        QCOMPARE(ids[0].column, 1);
+        QCOMPARE(ids[255].row, 255);
+        QCOMPARE(it.gridId().row, 256);
+
+        QCOMPARE(it.fetchGridIds(ids, IdIterator::BatchSize), 44);
+        QCOMPARE(ids[43].row, 299);
+        QVERIFY(!it.isValid());
+        QCOMPARE(it.fetchGridIds(ids, IdIterator::BatchSize), 0);
+    }
+
+    {
+        ItemsIteratorGridByColumn it(*grid, 2);
+        it.toNext();
+        GridColumnSpan span;
+        QVERIFY(it.fetchColumnSpan(span));
+        QCOMPARE(span.column, 2);
+        QCOMPARE(span.firstRow, 1);
+        QCOMPARE(span.rowsCount, 299);
+        QVERIFY(!it.isValid());
+        QVERIFY(!it.fetchColumnSpan(span));
+    }
+
+    {
+        // row by row iteration gives spans of one item
+        IdIteratorGridAll it(*grid);
+        GridColumnSpan span;
+        QVERIFY(it.fetchColumnSpan(span));
+        QCOMPARE(span.column, 0);
+        QCOMPARE(span.rowsCount, 1);
+        QCOMPARE(it.gridId().column, 1);
+
+        ID ids[10];
+        QCOMPARE(it.fetchIds(ids, 10), 10);
+        QCOMPARE(ids[0].as<GridID>().column, 1);
+        QCOMPARE(ids[2].as<GridID>().row, 1);
+        QCOMPARE(ids[2].as<GridID>().column, 0);
+    }
+}
+
+void TestGrid::testSetValueMultiple()
+{
+    auto grid = makeShared<SpaceGrid>();
+    // more rows than one storage chunk
+    grid->rows()->setCount(5000);
+    grid->columns()->setCount(2);
+
+    ModelStorageGrid<Qt::CheckState> model(grid);
+    auto changedSpy = createSignalSpy(&model, &Model::modelChanged);
+
+    ItemsIteratorGridByColumn it(*grid, 1);
+    QVERIFY(model.setValueMultiple(it, Qt::Checked));
+    QCOMPARE(changedSpy.size(), 1);
+    QCOMPARE(model.valueAt(GridID(0, 1)), Qt::Checked);
+    QCOMPARE(model.valueAt(GridID(4095, 1)), Qt::Checked);
+    QCOMPARE(model.valueAt(GridID(4096, 1)), Qt::Checked);
+    QCOMPARE(model.valueAt(GridID(4999, 1)), Qt::Checked);
+    QCOMPARE(model.valueAt(GridID(10, 0)), Qt::Unchecked);
+
+    ModelStorageColumns<int> columns(grid, 0, 1);
+    auto columnsSpy = createSignalSpy(&columns, &Model::modelChanged);
+    IdIteratorGridAll all(*grid);
+    QVERIFY(columns.setValueMultiple(all, 7));
+    QCOMPARE(columnsSpy.size(), 1);
+    QCOMPARE(columns.value(GridID(0, 0)), 7);
+    QCOMPARE(columns.value(GridID(4999, 1)), 7);
+}
+
+void TestGrid::testStorageColumns()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(4);
+    grid->columns()->setCount(5);
+
+    ModelStorageColumns<int> model(grid, QSet<int>() << 1 << 3);
+    QVERIFY(model.hasColumn(1));
+    QVERIFY(!model.hasColumn(2));
+    QVERIFY(model.hasColumn(3));
+    QVERIFY(!model.hasColumn(0));
+    QVERIFY(!model.columnData(2));
+
+    QVERIFY(model.setValue(GridID(2, 3), 5));
+    QVERIFY(!model.setValue(GridID(2, 2), 5));
+    QVERIFY(!model.setValue(GridID(4, 3), 5));
+    QCOMPARE(model.value(GridID(2, 3)), 5);
+
+    const int* data = model.columnData(3);
+    QVERIFY(data);
+    QCOMPARE(data[2], 5);
+
+    grid->rows()->insertLines(1, 2);
+    QCOMPARE(model.rowsCount(), 6);
+    QCOMPARE(model.value(GridID(4, 3)), 5);
+    QCOMPARE(model.value(GridID(1, 3)), 0);
+}
+
+void TestGrid::testStorageGridSparse()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(50000);
+    grid->columns()->setCount(2000);
+
+    ModelStorageGridSparse<int> model(grid, -1);
+    QCOMPARE(model.populatedCount(), 0);
+    QCOMPARE(model.value(GridID(49999, 1999)), -1);
+
+    QVERIFY(model.setValue(GridID(10, 5), 1));
+    QVERIFY(model.setValue(GridID(3, 5), 2));
+    QVERIFY(model.setValue(GridID(7, 0), 3));
+    QVERIFY(!model.setValue(GridID(50000, 0), 3));
+    QCOMPARE(model.populatedCount(), 3);
+    QCOMPARE(model.valueAt(GridID(10, 5)), 1);
+
+    // default value removes the cell
+    QVERIFY(model.setValue(GridID(7, 0), -1));
+    QCOMPARE(model.populatedCount(), 2);
+
+    QVector<int> rows;
+    for (ModelStorageGridSparse<int>::PopulatedIterator it(model); it.isValid(); it.toNext())
+        rows.append(it.gridId().row);
+    QCOMPARE(rows, QVector<int>() << 3 << 10);
+
+    grid->rows()->insertLines(5, 2);
+    QCOMPARE(model.valueAt(GridID(3, 5)), 2);
+    QCOMPARE(model.valueAt(GridID(12, 5)), 1);
+    QCOMPARE(model.valueAt(GridID(10, 5)), -1);
+
+    grid->rows()->removeLines(0, 4);
+    QCOMPARE(model.populatedCount(), 1);
+    QCOMPARE(model.valueAt(GridID(8, 5)), 1);
+}
+
+template <typename Layout>
+static void checkStorageGridLayout()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->setDimensions(40, 70);
+
+    ModelStorageGrid<int, int, Layout> model(grid);
+    for (int row = 0; row < 40; ++row)
+    {
+        for (int column = 0; column < 70; ++column)
+            model.setValue(GridID(row, column), row * 100 + column);
+    }
+    QCOMPARE(model.valueAt(GridID(39, 69)), 3969);
+
+    int values[] = { -1, -2 };
+    QVERIFY(model.setRowValues(17, values, 2, 64));
+    QCOMPARE(model.valueAt(GridID(17, 65)), -2);
+    QCOMPARE(model.valueAt(GridID(17, 66)), 1766);
+
+    // values stay attached to their lines
+    grid->rows()->insertLines(10, 2);
+    QCOMPARE(model.valueAt(GridID(9, 69)), 969);
+    QCOMPARE(model.valueAt(GridID(10, 5)), 0);
+    QCOMPARE(model.valueAt(GridID(12, 5)), 1005);
+    QCOMPARE(model.valueAt(GridID(41, 69)), 3969);
+
+    grid->columns()->insertLines(63, 3);
+    QCOMPARE(model.columnsCount(), 73);
+    QCOMPARE(model.valueAt(GridID(12, 62)), 1062);
+    QCOMPARE(model.valueAt(GridID(12, 64)), 0);
+    QCOMPARE(model.valueAt(GridID(12, 66)), 1063);
+    QCOMPARE(model.valueAt(GridID(41, 72)), 3969);
+
+    grid->columns()->removeLines(0, 10);
+    QCOMPARE(model.valueAt(GridID(41, 62)), 3969);
+    QCOMPARE(model.valueAt(GridID(0, 0)), 10);
+
+    grid->rows()->removeLines(0, 12);
+    QCOMPARE(model.valueAt(GridID(29, 62)), 3969);
+    QCOMPARE(model.valueAt(GridID(0, 0)), 1010);
+
+    // fills of column runs
+    ItemsIteratorGridByColumn it(*grid, 1);
+    QVERIFY(model.setValueMultiple(it, 7));
+    QCOMPARE(model.valueAt(GridID(0, 1)), 7);
+    QCOMPARE(model.valueAt(GridID(29, 1)), 7);
+    QCOMPARE(model.valueAt(GridID(29, 2)), 3912);
+
+    grid->setDimensions(30, 5);
+    QCOMPARE(model.valueAt(GridID(29, 4)), 3914);
+}
+
+void TestGrid::testStorageGridLayouts()
+{
+    checkStorageGridLayout<StorageGridColumns>();
+    checkStorageGridLayout<StorageGridRows>();
+    checkStorageGridLayout<StorageGridTiles>();
+}
+
+void TestGrid::testStorageAllocator()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->setDimensions(100, 3);
+
+    MemoryArena arena(4096);
+    {
+        ModelStorageGrid<int, int, StorageGridTiles, ResourceAllocator<int>> model(grid, &arena);
+        ModelStorageColumns<double, double, ResourceAllocator<double>> columns(grid, 0, 1, &arena);
+        QVERIFY(arena.reservedBytes() >= qint64(100 * 3 * sizeof(int) + 100 * 2 * sizeof(double)));
+
+        model.setValue(GridID(99, 2), 5);
+        columns.setValue(GridID(99, 1), 0.5);
+        grid->rows()->insertLines(0, 10);
+        QCOMPARE(model.valueAt(GridID(109, 2)), 5);
+        QCOMPARE(columns.columnData(1)[109], 0.5);
+        QCOMPARE(model.allocator().resource(), static_cast<MemoryResource*>(&arena));
+    }
+    arena.release();
+    QCOMPARE(arena.reservedBytes(), qint64(0));
+}
+
+void TestGrid::testStorageSnapshot()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->columns()->setCount(2);
+    auto model = makeShared<ModelStorageGrid<int>>(grid);
+    ModelStorageSnapshot<QString, int> snapshot(grid, model);
+
+    auto stats = snapshot.apply(QVector<QString>() << "a" << "b" << "c",
+                                QVector<QVector<int>>() << (QVector<int>() << 1 << 1) << (QVector<int>() << 2 << 2) << (QVector<int>() << 3 << 3));
+    QCOMPARE(grid->rowsCount(), 3);
+    QCOMPARE(stats.insertedRows, 3);
+    QCOMPARE(stats.removedRows, 0);
+    QCOMPARE(stats.changedCells, 6);
+
+    QVector<int> itemsSizes;
+    QObject::connect(model.data(), &Model::modelItemsChanged, [&itemsSizes](const Model*, const QVector<ID>& ids) {
+        itemsSizes.append(ids.size());
+    });
+
+    // "b" is removed, "d" is inserted, "c" is changed
+    stats = snapshot.apply(QVector<QString>() << "a" << "d" << "c",
+                           QVector<QVector<int>>() << (QVector<int>() << 1 << 1) << (QVector<int>() << 4 << 4) << (QVector<int>() << 3 << 5));
+    QCOMPARE(stats.removedRows, 1);
+    QCOMPARE(stats.insertedRows, 1);
+    QCOMPARE(stats.changedCells, 3);
+    QCOMPARE(itemsSizes, QVector<int>() << 3);
+    QCOMPARE(snapshot.keys(), QVector<QString>() << "a" << "d" << "c");
+    QCOMPARE(model->valueAt(GridID(1, 0)), 4);
+    QCOMPARE(model->valueAt(GridID(2, 1)), 5);
+
+    // moved row is removed and inserted back
+    stats = snapshot.apply(QVector<QString>() << "c" << "a" << "d",
+                           QVector<QVector<int>>() << (QVector<int>() << 3 << 5) << (QVector<int>() << 1 << 1) << (QVector<int>() << 4 << 4));
+    QCOMPARE(stats.removedRows, 1);
+    QCOMPARE(stats.insertedRows, 1);
+    QCOMPARE(stats.changedCells, 2);
+    QCOMPARE(model->valueAt(GridID(0, 1)), 5);
+    QCOMPARE(model->valueAt(GridID(2, 0)), 4);
+}
+
+void TestGrid::testSortingCache()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(5);
+    grid->columns()->setCount(2);
+
+    auto model = makeShared<ModelStorageGrid<int>>(grid);
+    int values0[] = { 2, 1, 2, 3, 1 };
+    int values1[] = { 0, 1, 0, 1, 0 };
+    model->setColumnValues(0, values0, 5);
+    model->setColumnValues(1, values1, 5);
+
+    ModelGridSorting sorting(grid);
+    sorting.addSortingModel(0, model);
+    sorting.addSortingModel(1, model);
+    sorting.setSortingCacheSize(2);
+
+    QVERIFY(sorting.sortByItem(GridID(0, 0), true));
+    QCOMPARE(grid->rows()->permutation(), QVector<int>() << 1 << 4 << 0 << 2 << 3);
+
+    // reversed order keeps equal rows in place as stable sorting does
+    QVERIFY(sorting.sortByItem(GridID(0, 0), false));
+    QCOMPARE(grid->rows()->permutation(), QVector<int>() << 3 << 0 << 2 << 1 << 4);
+
+    QVERIFY(sorting.sortByItem(GridID(0, 1), true));
+    QCOMPARE(grid->rows()->permutation(), QVector<int>() << 0 << 2 << 4 << 3 << 1);
+
+    // cached order is restored
+    QVERIFY(sorting.sortByItem(GridID(0, 0), false));
+    QCOMPARE(grid->rows()->permutation(), QVector<int>() << 3 << 0 << 2 << 1 << 4);
+
+    // changed model invalidates cached orders
+    model->setValue(GridID(3, 0), 0);
+    QVERIFY(sorting.sortByItem(GridID(0, 0), true));
+    QCOMPARE(grid->rows()->permutation(), QVector<int>() << 3 << 1 << 4 << 0 << 2);
+}
+
+void TestGrid::testSetSchemas()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(4);
+    grid->columns()->setCount(4);
+
+    auto view = makeShared<ViewCallback>();
+    QVector<ItemSchema> schemas;
+    for (int column = 0; column < 4; ++column)
+        schemas.append(ItemSchema(makeRangeGridColumn(column), makeLayoutClient(), view));
+
+    auto spy = createSignalSpy(grid.data(), &Space::spaceChanged);
+    grid->setSchemas(schemas);
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(grid->schemas().size(), 4);
+    QCOMPARE(grid->schemasOrdered().size(), 4);
+
+    // shared view stays connected after replacing schemas
+    grid->setSchemas(schemas.mid(0, 2));
+    QCOMPARE(spy.size(), 2);
+    view->emitViewChanged(ChangeReasonViewContent);
+    QCOMPARE(spy.size(), 3);
+
+    grid->addSchemas(schemas.mid(2));
+    QCOMPARE(spy.size(), 4);
+    QCOMPARE(grid->schemas().size(), 4);
+}
+
+void TestGrid::testSelectionPaste()
+{
+    auto table = SelectionPaste::parse("1\t2\r\n3\n\t4\t5\n");
+    QCOMPARE(table.rows.size(), 3);
+    QCOMPARE(table.columnsCount, 3);
+    QCOMPARE(table.rows[0], QVector<QString>() << "1" << "2");
+    QCOMPARE(table.rows[2], QVector<QString>() << "" << "4" << "5");
+
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(4);
+    grid->columns()->setCount(3);
+
+    auto numbers = makeShared<ModelStorageGrid<int>>(grid);
+    auto texts = makeShared<ModelStorageGrid<QString>>(grid);
+    auto selection = makeShared<ModelSelection>(grid);
+
+    SelectionPaste paste(selection);
+    paste.setColumnNumericModel<int>(0, numbers);
+    paste.setColumnModel(1, texts);
+
+    // one item selected, table is pasted from it and clipped by grid
+    selection->setSelection(makeRangeGridRect(2, 3, 0, 1));
+    auto spy = createSignalSpy(numbers.data(), &Model::modelChanged);
+    QCOMPARE(paste.paste("7\ta\n8\tb\n9\tc"), 4);
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(numbers->value(GridID(2, 0)), 7);
+    QCOMPARE(numbers->value(GridID(3, 0)), 8);
+    QCOMPARE(texts->value(GridID(3, 1)), QString("b"));
+
+    // single cell is repeated over selected items
+    selection->setSelection(makeRangeGridRect(0, 2, 0, 2));
+    QCOMPARE(paste.paste("5"), 4);
+    QCOMPARE(spy.size(), 2);
+    QCOMPARE(numbers->value(GridID(1, 0)), 5);
+    QCOMPARE(texts->value(GridID(0, 1)), QString("5"));
+    QCOMPARE(numbers->value(GridID(2, 0)), 7);
+}
+
+void TestGrid::testSelectionCounts()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->setDimensions(10, 5);
+
+    ModelSelection selection(grid);
+    QCOMPARE(selection.rowSelectedCount(0), 0);
+    QVERIFY(!selection.isRowSelectedAll(0));
+
+    selection.setSelection(makeRangeGridRows(2, 4));
+    QCOMPARE(selection.rowSelectedCount(2), 5);
+    QCOMPARE(selection.rowSelectedCount(4), 0);
+    QCOMPARE(selection.columnSelectedCount(0), 2);
+    QVERIFY(selection.isRowSelectedAll(3));
+
+    // counts of changed lines are updated
+    selection.addSelection(makeRangeGridColumn(1), false);
+    QCOMPARE(selection.columnSelectedCount(1), 10);
+    QVERIFY(selection.isColumnSelectedAll(1));
+    QCOMPARE(selection.rowSelectedCount(0), 1);
+    QCOMPARE(selection.rowSelectedCount(2), 5);
+
+    selection.addSelection(makeRangeGridRect(3, 4, 0, 2), true);
+    QCOMPARE(selection.rowSelectedCount(3), 3);
+    QVERIFY(!selection.isRowSelectedAll(3));
+    QCOMPARE(selection.columnSelectedCount(0), 1);
+    QCOMPARE(selection.columnSelectedCount(1), 9);
+
+    // new lines are counted
+    grid->rows()->setCount(12);
+    QCOMPARE(selection.columnSelectedCount(1), 11);
+    QCOMPARE(selection.rowSelectedCount(11), 1);
+
+    // selection without spans is probed
+    ModelSelectionRows rowsSelection(grid);
+    rowsSelection.selectRows(QSet<int>() << 1 << 3);
+    QCOMPARE(rowsSelection.rowSelectedCount(1), 5);
+    QVERIFY(rowsSelection.isRowSelectedAll(3));
+    QCOMPARE(rowsSelection.columnSelectedCount(0), 2);
+}
+
+void TestGrid::testSelectionChangedItems()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->setDimensions(1000, 100);
+
+    ModelSelection selection(grid);
+    auto itemsSpy = createSignalSpy(&selection, &Model::modelItemsChanged);
+    auto changedSpy = createSignalSpy(&selection, &Model::modelChanged);
+
+    // items of small changed region are reported
+    selection.setSelection(makeRangeGridRect(2, 4, 1, 3));
+    QCOMPARE(changedSpy.size(), 1);
+    QCOMPARE(itemsSpy.size(), 1);
+    QCOMPARE(itemsSpy.getLast<1>().size(), 4);
+
+    selection.addSelection(makeRangeGridRect(3, 5, 1, 3), false);
+    QCOMPARE(itemsSpy.size(), 2);
+    QCOMPARE(itemsSpy.getLast<1>().size(), 2);
+
+    // large region changes whole model
+    selection.setSelection(makeRangeAll());
+    QCOMPARE(changedSpy.size(), 3);
+    QCOMPARE(itemsSpy.size(), 2);
+}
+
+void TestGrid::testGridOverview()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->rows()->setCount(100);
+    grid->columns()->setCount(1);
+
+    auto model = makeShared<ModelStorageGrid<int>>(grid);
+    for (int row = 0; row < 100; ++row)
+        model->setValue(GridID(row, 0), row < 50 ? 0 : 100);
+
+    GridOverview overview(grid);
+    overview.addColumnValues<int>(0, model, 0, 100, QColor(Qt::black), QColor(Qt::white));
+    overview.setSize(QSize(2, 10));
+
+    auto finishedSpy = createSignalSpy(&overview, &GridOverview::buildFinished);
+    QTRY_COMPARE(finishedSpy.size(), 1);
+    QCOMPARE(overview.image().size(), QSize(2, 10));
+    QCOMPARE(overview.image().pixel(0, 0), QColor(Qt::black).rgba());
+    QCOMPARE(overview.image().pixel(1, 9), QColor(Qt::white).rgba());
+
+    // changed item updates its bucket only
+    auto changedSpy = createSignalSpy(&overview, &GridOverview::imageChanged);
+    for (int row = 0; row < 10; ++row)
+        model->setValue(GridID(row, 0), 100);
+    QTRY_COMPARE(changedSpy.size(), 1);
+    QCOMPARE(changedSpy.getLast<1>(), QRect(0, 0, 2, 1));
+    QCOMPARE(overview.image().pixel(0, 0), QColor(Qt::white).rgba());
+    QCOMPARE(finishedSpy.size(), 1);
+}
+
+void TestGrid::testItemRects()
+{
+    auto grid = makeShared<SpaceGrid>();
+    grid->setDimensions(100, 20);
+    grid->rows()->setLineSizeAll(20);
+    grid->columns()->setLineSizeAll(50);
+    grid->rows()->setLineSize(3, 35);
+    grid->columns()->setLineSize(5, 0);
+    grid->rows()->setLineVisible(7, false);
+
+    // block of items
+    QVector<ID> block;
+    for (int row = 2; row < 12; ++row)
+        for (int column = 3; column < 9; ++column)
+            block.append(ID(GridID(row, column)));
+
+    // sparse items
+    QVector<ID> sparse;
+    sparse << ID(GridID(0, 0)) << ID(GridID(98, 19)) << ID(GridID(50, 2));
+
+    for (const auto& ids : { block, sparse })
+    {
+        auto rects = grid->itemRects(ids);
+        QCOMPARE(rects.size(), ids.size());
+        for (int i = 0; i < ids.size(); ++i)
+            QCOMPARE(rects[i], grid->itemRect(ids[i]));
+    }
+}
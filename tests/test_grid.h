@@ -13,6 +13,27 @@ public:
 private slots:
 
     void test();
+    void testModelUpdate();
+    void testSortOrdinal();
+    void testModelRing();
+    void testRowsGrouping();
+    void testColumnAggregates();
+    void testSchemasByColumnRanges();
+    void testSchemasUniformity();
+    void testIteratorsBatch();
+    void testSetValueMultiple();
+    void testStorageColumns();
+    void testStorageGridSparse();
+    void testStorageGridLayouts();
+    void testStorageAllocator();
+    void testStorageSnapshot();
+    void testSortingCache();
+    void testSetSchemas();
+    void testSelectionPaste();
+    void testSelectionCounts();
+    void testSelectionChangedItems();
+    void testGridOverview();
+    void testItemRects();
 };
 
 #endif // TEST_GRID_H
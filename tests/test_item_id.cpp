@@ -1,4 +1,5 @@
 #include "test_item_id.h"
+#include "core/ID.h"
 
 #include <set>
 #include <type_traits>
@@ -141,3 +142,38 @@ void TestItemID::testMap()
         QVERIFY(m.empty());
     }
 }
+
+void TestItemID::testID()
+{
+    ID id;
+    ID idGrid(GridID(3, 5));
+    QCOMPARE(idGrid.as<GridID>(), GridID(3, 5));
+    QVERIFY(idGrid == ID(GridID(3, 5)));
+    QVERIFY(idGrid != ID(GridID(3, 6)));
+
+    id = idGrid;
+    QVERIFY(id == idGrid);
+
+    ID idIndex(7);
+    QCOMPARE(index(idIndex), 7);
+    QVERIFY(idIndex == ID(7));
+}
+
+void TestItemID::benchmarkID()
+{
+    QVector<ID> ids;
+    ids.reserve(10000);
+
+    int equals = 0;
+    QBENCHMARK
+    {
+        ids.clear();
+        for (int i = 0; i < 10000; ++i)
+            ids.append(ID(GridID(i / 100, i % 100)));
+
+        for (int i = 1; i < ids.size(); ++i)
+            equals += (ids[i] == ids[i - 1]) ? 1 : 0;
+    }
+
+    QCOMPARE(equals, 0);
+}
@@ -17,6 +17,8 @@ private slots:
     void testClass();
     void testSet();
     void testMap();
+    void testID();
+    void benchmarkID();
 };
 
 namespace QTest {
@@ -1,5 +1,7 @@
 #include "test_lines.h"
 #include "space/grid/Lines.h"
+#include "space/grid/LinesTree.h"
+#include "utils/MemoryUsage.h"
 #include "SignalSpy.h"
 #include <QtTest/QtTest>
 
@@ -342,3 +344,644 @@ void TestLines::testSizeAtLine()
     QCOMPARE(lines.visibleSize(), 62);
 }
 
+void TestLines::testSizeIncremental()
+{
+    Lines lines;
+    lines.setCount(8);
+    lines.setLineSizeAll(10);
+    lines.setLineVisible(3, false);
+
+    QCOMPARE(lines.visibleSize(), 70);
+    QCOMPARE(lines.findVisibleIDByPos(35), 3);
+
+    // sizes cache is valid here and should be updated in place
+    lines.setLineSize(0, 25);
+    QCOMPARE(lines.startPos(1), 25);
+    QCOMPARE(lines.startPos(3), 45);
+    QCOMPARE(lines.endPos(6), 85);
+    QCOMPARE(lines.visibleSize(), 85);
+
+    // invisible line doesn't affect positions
+    lines.setLineSize(3, 100);
+    QCOMPARE(lines.startPos(3), 45);
+    QCOMPARE(lines.visibleSize(), 85);
+
+    lines.setLineSize(5, 0);
+    QCOMPARE(lines.startPos(4), 55);
+    QCOMPARE(lines.startPos(5), 55);
+    QCOMPARE(lines.visibleSize(), 75);
+
+    QCOMPARE(lines.findVisibleIDByPos(24), 0);
+    QCOMPARE(lines.findVisibleIDByPos(25), 1);
+    QCOMPARE(lines.findVisibleIDByPos(55), 5);
+    QCOMPARE(lines.findVisibleIDByPos(74), 6);
+    QCOMPARE(lines.findVisibleIDByPos(55, 2, 3), 3);
+    QCOMPARE(lines.findVisibleIDByPos(10, 2, 3), InvalidIndex);
+
+    lines.setLineVisible(3, true);
+    QCOMPARE(lines.startPos(4), 145);
+    QCOMPARE(lines.visibleSize(), 175);
+}
+
+void TestLines::testSizeRuns()
+{
+    Lines lines;
+    lines.setCount(1000000);
+    lines.setLineSizeAll(20);
+
+    lines.setLineSize(10, 50);
+    lines.setLineSize(11, 50);
+    lines.setLineSize(500000, 0);
+
+    QCOMPARE(lines.lineSize(9), 20);
+    QCOMPARE(lines.lineSize(11), 50);
+    QCOMPARE(lines.lineSize(12), 20);
+    QCOMPARE(lines.lineSize(500000), 0);
+
+    QCOMPARE(lines.startPos(10), 200);
+    QCOMPARE(lines.startPos(12), 300);
+    QCOMPARE(lines.startPos(500001), 500000 * 20 + 60);
+    QCOMPARE(lines.visibleSize(), 1000000 * 20 + 60 - 20);
+
+    QCOMPARE(lines.findVisibleIDByPos(199), 9);
+    QCOMPARE(lines.findVisibleIDByPos(249), 10);
+    QCOMPARE(lines.findVisibleIDByPos(300), 12);
+    QCOMPARE(lines.findVisibleIDByPos(500000 * 20 + 60), 500001);
+
+    // restore size merges runs back
+    lines.setLineSize(10, 20);
+    lines.setLineSize(11, 20);
+    lines.setLineSize(500000, 20);
+    QCOMPARE(lines.visibleSize(), 1000000 * 20);
+    QCOMPARE(lines.findVisibleIDByPos(12345), 617);
+}
+
+void TestLines::testSizeUniform()
+{
+    Lines lines;
+    lines.setCount(100);
+    lines.setLineSizeAll(10);
+
+    // reversed order with hidden lines keeps positions arithmetic
+    lines.sort(true, [](int left, int right) { return left > right; });
+    lines.setLineVisible(99, false);
+    lines.setLineVisible(50, false);
+
+    QCOMPARE(lines.visibleCount(), 98);
+    QCOMPARE(lines.toAbsolute(0), 98);
+    QCOMPARE(lines.startPos(5), 50);
+    QCOMPARE(lines.endPos(5), 60);
+    QCOMPARE(lines.visibleSize(), 980);
+    QCOMPARE(lines.findVisibleIDByPos(55), 5);
+    QCOMPARE(lines.findVisibleIDByPos(979), 97);
+
+    // non uniform sizes switch to the tree
+    lines.setLineSize(98, 20);
+    QCOMPARE(lines.startPos(5), 60);
+    QCOMPARE(lines.findVisibleIDByPos(15), 0);
+    QCOMPARE(lines.findVisibleIDByPos(25), 1);
+}
+
+void TestLines::testLazyPermutation()
+{
+    // huge count costs nothing while order is natural
+    Lines hugeLines;
+    hugeLines.setCount(100000000);
+    hugeLines.setLineSizeAll(2);
+    QCOMPARE(hugeLines.toAbsolute(12345678), 12345678);
+    QCOMPARE(hugeLines.findVisibleIDByPos(24691357), 12345678);
+    QCOMPARE(hugeLines.visibleSize(), 200000000);
+
+    Lines lines;
+    lines.setCount(10);
+    lines.setLineVisible(3, false);
+    QCOMPARE(lines.toAbsolute(3), 4);
+    QCOMPARE(lines.permutation().size(), 10);
+    QCOMPARE(lines.permutation()[9], 9);
+
+    QCOMPARE(lines.moveLines(9, 0), 0);
+    QCOMPARE(lines.toAbsolute(0), 9);
+    QCOMPARE(lines.toAbsolute(4), 4);
+
+    // new count restores natural order
+    lines.setCount(20);
+    QCOMPARE(lines.toAbsolute(0), 0);
+    QCOMPARE(lines.permutation().size(), 20);
+}
+
+void TestLines::testVisibleRange()
+{
+    Lines lines;
+    lines.setCount(10);
+    lines.setLineSizeAll(10);
+
+    int start = InvalidIndex, end = InvalidIndex;
+    lines.visibleRangeByPos(15, 20, start, end);
+    QCOMPARE(start, 1);
+    QCOMPARE(end, 3);
+
+    // cached range is dropped on change
+    lines.setLineSize(0, 20);
+    lines.visibleRangeByPos(15, 20, start, end);
+    QCOMPARE(start, 0);
+    QCOMPARE(end, 2);
+
+    lines.setLineVisible(0, false);
+    lines.visibleRangeByPos(15, 20, start, end);
+    QCOMPARE(start, 1);
+    QCOMPARE(end, 3);
+}
+
+void TestLines::testSortTop()
+{
+    QVector<int> values = QVector<int>() << 5 << 1 << 3 << 1 << 4 << 2 << 1;
+    auto less = [&values](int left, int right) { return values[left] < values[right]; };
+
+    Lines sorted(values.size());
+    sorted.sort(true, less);
+
+    // first lines match stable sorting including equal values
+    Lines lines(values.size());
+    lines.sortTop(4, less);
+    QCOMPARE(lines.permutation().mid(0, 4), sorted.permutation().mid(0, 4));
+}
+
+void TestLines::testSnapshot()
+{
+    Lines lines(100);
+    lines.setLineSizeAll(10);
+    lines.setLineSize(5, 30);
+    lines.setLineVisible(7, false);
+    lines.moveLines(20, 0);
+
+    auto snapshot = lines.snapshot();
+    QCOMPARE(snapshot.count(), lines.count());
+    QCOMPARE(snapshot.visibleCount(), lines.visibleCount());
+    QCOMPARE(snapshot.visibleSize(), lines.visibleSize());
+    QCOMPARE(snapshot.permutation(), lines.permutation());
+    for (int i = 0; i < lines.count(); ++i)
+    {
+        QCOMPARE(snapshot.lineSize(i), lines.lineSize(i));
+        QCOMPARE(snapshot.toVisible(i), lines.toVisible(i));
+    }
+    for (int i = 0; i < lines.visibleCount(); ++i)
+    {
+        QCOMPARE(snapshot.toAbsolute(i), lines.toAbsolute(i));
+        QCOMPARE(snapshot.startPos(i), lines.startPos(i));
+        QCOMPARE(snapshot.findVisibleIDByPos(lines.startPos(i) + 1), lines.findVisibleIDByPos(lines.startPos(i) + 1));
+    }
+
+    // snapshot keeps state after lines are changed
+    int visibleLine = lines.toVisible(30);
+    lines.setLineVisible(30, false);
+    lines.setLineSize(40, 50);
+    QCOMPARE(snapshot.visibleCount(), 99);
+    QCOMPARE(snapshot.lineSize(40), 10);
+    QCOMPARE(snapshot.toVisible(30), visibleLine);
+
+    // bitwise visibility and uniform sizes
+    Lines bitwise(64 * 3);
+    bitwise.setLineSizeAll(5);
+    bitwise.setLineVisible(70, false);
+    auto bitwiseSnapshot = bitwise.snapshot();
+    QCOMPARE(bitwiseSnapshot.visibleCount(), bitwise.visibleCount());
+    QCOMPARE(bitwiseSnapshot.toVisible(70), InvalidIndex);
+    QCOMPARE(bitwiseSnapshot.toVisible(100), bitwise.toVisible(100));
+    QCOMPARE(bitwiseSnapshot.toAbsolute(100), bitwise.toAbsolute(100));
+    QCOMPARE(bitwiseSnapshot.endPos(10), bitwise.endPos(10));
+}
+
+void TestLines::testCloneSharing()
+{
+    Lines lines(1000);
+    lines.setLineSizeAll(10);
+    lines.setLineVisible(3, false);
+    lines.moveLines(500, 0);
+    QCOMPARE(lines.toAbsolute(0), 500);
+
+    // reading clone keeps storage shared
+    auto clone = lines.clone();
+    QCOMPARE(clone->toAbsolute(10), lines.toAbsolute(10));
+    QCOMPARE(clone->toVisible(10), lines.toVisible(10));
+    QCOMPARE(clone->findVisibleIDByPos(55), lines.findVisibleIDByPos(55));
+    QCOMPARE(clone->permutation().constData(), lines.permutation().constData());
+
+    // changed clone diverges from source
+    clone->moveLines(10, 0);
+    QCOMPARE(clone->toAbsolute(0), 10);
+    QCOMPARE(lines.toAbsolute(0), 500);
+    QVERIFY(clone->permutation().constData() != lines.permutation().constData());
+}
+
+void TestLines::testInsertRemoveLines()
+{
+    Lines lines(6);
+    lines.setLineSizeAll(10);
+    lines.setLineSize(2, 20);
+    lines.setLineSize(4, 40);
+    lines.setLineVisible(5, false);
+    lines.moveLines(3, 0);
+    QCOMPARE(lines.permutation(), QVector<int>() << 3 << 0 << 1 << 2 << 4 << 5);
+
+    SignalSpy inserted(&lines, &Lines::linesInserted);
+    QVERIFY(lines.insertLines(2, 2));
+    QCOMPARE(inserted.size(), 1);
+    QCOMPARE(lines.count(), 8);
+
+    // order is kept and new lines go before shifted line
+    QCOMPARE(lines.permutation(), QVector<int>() << 5 << 0 << 1 << 2 << 3 << 4 << 6 << 7);
+    QCOMPARE(lines.lineSize(4), 20);
+    QCOMPARE(lines.lineSize(6), 40);
+    QCOMPARE(lines.lineSize(5), 10);
+    QVERIFY(lines.isLineVisible(2));
+    QVERIFY(!lines.isLineVisible(7));
+    QCOMPARE(lines.visibleCount(), 7);
+
+    SignalSpy removed(&lines, &Lines::linesRemoved);
+    QVERIFY(lines.removeLines(2, 2));
+    QCOMPARE(removed.size(), 1);
+    QCOMPARE(lines.count(), 6);
+    QCOMPARE(lines.permutation(), QVector<int>() << 3 << 0 << 1 << 2 << 4 << 5);
+    QCOMPARE(lines.lineSize(2), 20);
+    QCOMPARE(lines.lineSize(3), 10);
+    QCOMPARE(lines.lineSize(4), 40);
+    QVERIFY(!lines.isLineVisible(5));
+
+    QVERIFY(!lines.removeLines(5, 2));
+    QVERIFY(!lines.insertLines(7));
+}
+
+void TestLines::testAppendLines()
+{
+    // many size runs use Fenwick tree
+    Lines lines(200);
+    for (int i = 0; i < lines.count(); ++i)
+        lines.setLineSize(i, 10 + i % 7);
+    lines.setLineVisible(3, false);
+    lines.moveLines(10, 0);
+
+    // validate caches which are patched by appending
+    QCOMPARE(lines.toAbsolute(0), 10);
+    QVERIFY(lines.visibleSize() > 0);
+
+    QVERIFY(lines.appendLines(5));
+    lines.setLineSize(203, 25);
+    QCOMPARE(lines.count(), 205);
+    QCOMPARE(lines.visibleCount(), 204);
+    QCOMPARE(lines.toAbsolute(0), 10);
+    QCOMPARE(lines.toAbsolute(203), 204);
+    QCOMPARE(lines.toVisible(200), 199);
+
+    int position = 0;
+    for (int i = 0; i < lines.visibleCount(); ++i)
+    {
+        QCOMPARE(lines.startPos(i), position);
+        position += lines.lineSize(lines.toAbsolute(i));
+    }
+    QCOMPARE(lines.visibleSize(), position);
+}
+
+void TestLines::testLinesTree()
+{
+    QMap<int, QVector<int>> children;
+    children[InvalidIndex] = QVector<int>() << 0 << 1;
+    children[0] = QVector<int>() << 10 << 11;
+    children[10] = QVector<int>() << 100;
+
+    int childrenQueries = 0;
+    auto rows = makeShared<Lines>();
+    LinesTree tree(rows, [&children, &childrenQueries](int node) {
+        ++childrenQueries;
+        return children.value(node).size();
+    }, [&children](int node, int index) {
+        return children.value(node)[index];
+    });
+
+    // children of collapsed nodes are not queried
+    QCOMPARE(rows->count(), 2);
+    QCOMPARE(childrenQueries, 1);
+
+    QVERIFY(tree.expand(0));
+    QCOMPARE(rows->count(), 4);
+    QCOMPARE(tree.node(1), 10);
+    QCOMPARE(tree.node(3), 1);
+    QCOMPARE(tree.depth(2), 1);
+
+    QVERIFY(tree.expand(1));
+    QCOMPARE(rows->count(), 5);
+    QCOMPARE(tree.node(2), 100);
+    QCOMPARE(tree.parentRow(2), 1);
+
+    // collapsed subtree takes one line and restores expanded children
+    QVERIFY(tree.collapse(0));
+    QCOMPARE(rows->count(), 2);
+    QCOMPARE(tree.node(1), 1);
+    QVERIFY(tree.expand(0));
+    QCOMPARE(rows->count(), 5);
+    QCOMPARE(tree.node(2), 100);
+
+    QVERIFY(!tree.expand(4));
+    tree.collapseAll();
+    QCOMPARE(rows->count(), 2);
+}
+
+void TestLines::testLinesSizeRange()
+{
+    Lines lines(20000);
+    lines.setLineSizeAll(10);
+
+    int changes = 0;
+    QObject::connect(&lines, &Lines::linesChanged, [&changes](const Lines*, ChangeReason) { ++changes; });
+
+    // one run and one notification for many lines
+    lines.setLinesSize(100, 10000, 20);
+    QCOMPARE(changes, 1);
+    QCOMPARE(lines.lineSize(99), 10);
+    QCOMPARE(lines.lineSize(100), 20);
+    QCOMPARE(lines.lineSize(10099), 20);
+    QCOMPARE(lines.lineSize(10100), 10);
+    QCOMPARE(lines.visibleSize(), 20000 * 10 + 10000 * 10);
+
+    // the same size is not applied again
+    lines.setLinesSize(200, 100, 20);
+    QCOMPARE(changes, 1);
+
+    lines.setLineVisible(150, false);
+    lines.setLineVisible(50, false);
+    QCOMPARE(lines.visibleLinesCount(0, 200), 198);
+    QCOMPARE(lines.visibleLinesSize(0, 200), 99 * 10 + 99 * 20);
+    QCOMPARE(lines.visibleLinesSize(0, lines.count()), lines.visibleSize());
+    QCOMPARE(lines.endPos(lines.visibleCount() - 1), lines.visibleSize());
+
+    // sizes are merged back to one run
+    lines.setLinesSize(100, 10000, 10);
+    QCOMPARE(lines.visibleLinesSize(0, lines.count()), 19998 * 10);
+
+    // scattered sizes are set by one notification
+    changes = 0;
+    int resized = 0;
+    QObject::connect(&lines, &Lines::lineResized, [&resized](const Lines*, int) { ++resized; });
+    lines.visibleSize();
+    lines.setLinesSizes(QVector<int>() << 10 << 11 << 150 << 5000, QVector<int>() << 30 << 10 << 40 << 25);
+    QCOMPARE(changes, 1);
+    QCOMPARE(resized, 0);
+    QCOMPARE(lines.lineSize(10), 30);
+    QCOMPARE(lines.lineSize(11), 10);
+    QCOMPARE(lines.lineSize(150), 40);
+    QCOMPARE(lines.lineSize(5000), 25);
+    QCOMPARE(lines.visibleSize(), 19998 * 10 + 20 + 15);
+    QCOMPARE(lines.endPos(lines.visibleCount() - 1), lines.visibleSize());
+
+    // the same sizes are not notified
+    lines.setLinesSizes(QVector<int>() << 10 << 11, QVector<int>() << 30 << 10);
+    QCOMPARE(changes, 1);
+}
+
+void TestLines::testLinesVersion()
+{
+    Lines lines(10);
+    lines.setLineSizeAll(10);
+    auto spy = createSignalSpy(&lines, &Lines::linesChanged);
+
+    quint64 version = lines.version();
+    lines.setLineSize(2, 40);
+    QCOMPARE(spy.size(), 1);
+    QVERIFY(lines.version() != version);
+
+    // cached visible range follows the version
+    int visibleStart = InvalidIndex, visibleEnd = InvalidIndex;
+    lines.visibleRangeByPos(0, 45, visibleStart, visibleEnd);
+    QCOMPARE(visibleStart, 0);
+    QCOMPARE(visibleEnd, 2);
+
+    version = lines.version();
+    lines.setLineVisible(1, false);
+    QVERIFY(lines.version() != version);
+    lines.visibleRangeByPos(0, 45, visibleStart, visibleEnd);
+    QCOMPARE(visibleStart, 0);
+    QCOMPARE(visibleEnd, 1);
+
+    // reading doesn't change the version
+    version = lines.version();
+    lines.visibleRangeByPos(0, 45, visibleStart, visibleEnd);
+    QCOMPARE(lines.lineSize(2), 40);
+    QCOMPARE(lines.version(), version);
+
+    // count change drops cached visible range too
+    lines.setCount(2);
+    QVERIFY(lines.version() != version);
+    lines.visibleRangeByPos(0, 45, visibleStart, visibleEnd);
+    QCOMPARE(visibleStart, 0);
+    QCOMPARE(visibleEnd, 0);
+}
+
+void TestLines::testLineResized()
+{
+    Lines lines(10);
+    lines.setLineSizeAll(10);
+    auto spy = createSignalSpy(&lines, &Lines::lineResized);
+
+    lines.setLineSize(3, 25);
+    QCOMPARE(spy.size(), 1);
+    QCOMPARE(spy.getLast<1>(), 3);
+    QCOMPARE(lines.startPos(4), 55);
+
+    // same size is ignored
+    lines.setLineSize(3, 25);
+    QCOMPARE(spy.size(), 1);
+
+    // bulk resize notifies by linesChanged only
+    lines.setLineSizeAll(5);
+    QCOMPARE(spy.size(), 1);
+}
+
+void TestLines::testSortVisible()
+{
+    Lines lines(6);
+    lines.setLineVisible(1, false);
+    lines.setLineVisible(4, false);
+    QCOMPARE(lines.visibleRelativePositions(), QVector<int>() << 0 << 2 << 3 << 5);
+
+    // hidden lines keep their relative positions
+    lines.sortVisible(true, [](int left, int right) { return left > right; });
+    QCOMPARE(lines.permutation(), QVector<int>() << 5 << 1 << 3 << 2 << 4 << 0);
+    QCOMPARE(lines.visibleCount(), 4);
+    QCOMPARE(lines.toAbsolute(0), 5);
+    QCOMPARE(lines.toAbsolute(3), 0);
+    QCOMPARE(lines.toVisible(1), InvalidIndex);
+}
+
+void TestLines::testMemoryUsage()
+{
+    Lines lines(100);
+    qint64 sizesBytes = lines.memoryUsage().total();
+
+    lines.setLineSize(10, 40);
+    QVERIFY(lines.memoryUsage().total() >= sizesBytes);
+
+    MemoryUsage usage;
+    usage.add("a", 10);
+    usage.add("b", 5);
+    usage.add("a", 1);
+    QCOMPARE(usage.parts().size(), 2);
+    QCOMPARE(usage.total(), qint64(16));
+
+    MemoryBudget budget;
+    QObject owner;
+    qint64 cacheBytes = 1000;
+    budget.addCache(&owner, "cache", [&cacheBytes]() { return cacheBytes; }, [&cacheBytes](qint64) { cacheBytes = 0; });
+
+    // unlimited budget doesn't trim
+    QCOMPARE(budget.trim(), qint64(0));
+    QCOMPARE(cacheBytes, qint64(1000));
+
+    // caches are trimmed until usage fits the budget
+    budget.setBudget(1);
+    QVERIFY(budget.trim() >= 1000);
+    QCOMPARE(cacheBytes, qint64(0));
+
+    // text widths cache remains
+    budget.removeCaches(&owner);
+    QCOMPARE(budget.usage().parts().size(), 1);
+}
+
+void TestLines::testSizesIndex()
+{
+    const int count = 100000;
+
+    // every 3rd line is bigger, every 5th line is hidden
+    Lines lines(count);
+    lines.setLineSizeAll(20);
+    for (int line = 0; line < count; line += 3)
+        lines.setLineSize(line, 35);
+    for (int line = 0; line < count; line += 5)
+        lines.setLineVisible(line, false);
+
+    auto reference = lines.clone();
+    reference->setSizesIndexEnabled(false);
+
+    // enough lookups to build index
+    const int size = lines.visibleSize();
+    for (int pos = 0; pos < size; pos += 97)
+        QCOMPARE(lines.findVisibleIDByPos(pos), reference->findVisibleIDByPos(pos));
+    QVERIFY(lines.memoryUsage().total() > reference->memoryUsage().total());
+
+    for (int line = 0; line < lines.visibleCount(); line += 13)
+    {
+        QCOMPARE(lines.startPos(line), reference->startPos(line));
+        QCOMPARE(lines.findVisibleIDByPos(lines.startPos(line)), line);
+        QCOMPARE(lines.findVisibleIDByPos(lines.endPos(line) - 1), line);
+    }
+
+    // snapshot reads the same index
+    LinesSnapshot snapshot = lines.snapshot();
+    for (int pos = 0; pos < size; pos += 1009)
+        QCOMPARE(snapshot.findVisibleIDByPos(pos), reference->findVisibleIDByPos(pos));
+
+    // index is dropped by resize and rebuilt later
+    lines.setLineSize(1, 100);
+    reference->setLineSize(1, 100);
+    for (int pos = 0; pos < size; pos += 97)
+        QCOMPARE(lines.findVisibleIDByPos(pos), reference->findVisibleIDByPos(pos));
+    QCOMPARE(lines.visibleSize(), reference->visibleSize());
+}
+
+void TestLines::testSaveRestoreState()
+{
+    Lines lines(1000);
+    lines.setLineSizeAll(20);
+    lines.setLinesSize(100, 50, 30);
+    for (int line = 0; line < 1000; line += 7)
+        lines.setLineVisible(line, false);
+    lines.sort(true, [](int left, int right) { return left % 10 < right % 10; });
+
+    QByteArray state = lines.saveState();
+
+    Lines restored(5);
+    auto spy = createSignalSpy(&restored, &Lines::linesChanged);
+    QVERIFY(restored.restoreState(state));
+
+    // all data is restored by one notification
+    QCOMPARE(spy.size(), 1);
+    QVERIFY(spy.getLast<1>() & ChangeReasonLinesCount);
+    QVERIFY(spy.getLast<1>() & ChangeReasonLinesOrder);
+    QCOMPARE(restored.count(), lines.count());
+    QCOMPARE(restored.visibleCount(), lines.visibleCount());
+    QCOMPARE(restored.visibleSize(), lines.visibleSize());
+    QCOMPARE(restored.permutation(), lines.permutation());
+    for (int line = 0; line < lines.count(); ++line)
+    {
+        QCOMPARE(restored.lineSize(line), lines.lineSize(line));
+        QCOMPARE(restored.toVisible(line), lines.toVisible(line));
+    }
+
+    // identity permutation and uniform sizes
+    Lines simple(10);
+    QVERIFY(restored.restoreState(simple.saveState()));
+    QCOMPARE(restored.count(), 10);
+    QCOMPARE(restored.visibleSize(), simple.visibleSize());
+
+    // invalid state is rejected without changes
+    int notifications = spy.size();
+    QVERIFY(!restored.restoreState(QByteArray()));
+    QVERIFY(!restored.restoreState(state.left(state.size() - 4)));
+    QByteArray corrupted = state;
+    corrupted[0] = char(corrupted[0] ^ 0xff);
+    QVERIFY(!restored.restoreState(corrupted));
+    QCOMPARE(spy.size(), notifications);
+    QCOMPARE(restored.count(), 10);
+}
+
+void TestLines::testVisibilityFilters()
+{
+    Lines lines(200);
+
+    int evenCalls = 0;
+    auto even = makeShared<LinesVisibilityCallback>([&evenCalls](int line) { ++evenCalls; return line % 2 == 0; });
+    int lowCalls = 0;
+    int lowLimit = 100;
+    auto low = makeShared<LinesVisibilityCallback>([&lowCalls, &lowLimit](int line) { ++lowCalls; return line < lowLimit; });
+
+    lines.addLinesVisibility(even);
+    lines.addLinesVisibility(low);
+    QCOMPARE(lines.visibleCount(), 50);
+    QCOMPARE(lines.toAbsolute(1), 2);
+    QCOMPARE(lines.visibleLinesCount(0, 10), 5);
+    QCOMPARE(evenCalls, 200);
+    QCOMPARE(lowCalls, 200);
+
+    // only changed filter is evaluated again
+    lowLimit = 150;
+    emit low->visibilityChanged(low.data());
+    QCOMPARE(lines.visibleCount(), 75);
+    QCOMPARE(evenCalls, 200);
+    QCOMPARE(lowCalls, 400);
+
+    // own visibility is combined with cached filters
+    lines.setLineVisible(2, false);
+    QCOMPARE(lines.visibleCount(), 74);
+    QVERIFY(!lines.isLineVisible(2));
+    lines.setLineVisibleAll(true);
+    QCOMPARE(lines.visibleCount(), 75);
+    QCOMPARE(evenCalls, 200);
+    QCOMPARE(lowCalls, 400);
+
+    // partial change evaluates given lines only
+    lowLimit = 152;
+    emit low->visibilityChangedPartial(low.data(), QVector<int>() << 150 << 151);
+    QCOMPARE(lines.visibleCount(), 76);
+    QCOMPARE(lines.toVisible(150), 75);
+    QCOMPARE(lowCalls, 402);
+
+    // appended lines are evaluated by all filters
+    lowLimit = 1000;
+    emit low->visibilityChanged(low.data());
+    lines.visibleCount();
+    lines.insertLines(200, 10);
+    QCOMPARE(lines.visibleCount(), 105);
+    QCOMPARE(lines.isLinesVisibleAll(), -1);
+
+    lines.removeLinesVisibility(even);
+    QCOMPARE(lines.visibleCount(), 210);
+    QCOMPARE(lines.isLinesVisibleAll(), 1);
+}
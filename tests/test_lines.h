@@ -17,6 +17,25 @@ private slots:
     void testSizes();
     void testAbsVsVis();
     void testSizeAtLine();
+    void testSizeIncremental();
+    void testSizeRuns();
+    void testSizeUniform();
+    void testLazyPermutation();
+    void testVisibleRange();
+    void testSortTop();
+    void testSnapshot();
+    void testCloneSharing();
+    void testInsertRemoveLines();
+    void testAppendLines();
+    void testLinesTree();
+    void testLinesSizeRange();
+    void testLinesVersion();
+    void testLineResized();
+    void testSortVisible();
+    void testMemoryUsage();
+    void testSizesIndex();
+    void testSaveRestoreState();
+    void testVisibilityFilters();
 };
 
 #endif // TEST_LINES_H
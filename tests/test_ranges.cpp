@@ -1,8 +1,10 @@
 #include "test_ranges.h"
 #include "core/ext/Ranges.h"
+#include "core/ext/CallbackProfiling.h"
 #include "SignalSpy.h"
 #include <QtTest/QtTest>
 #include "space/grid/RangeGrid.h"
+#include "items/selection/SelectionSpans.h"
 
 using namespace Qi;
 
@@ -229,3 +231,169 @@ void TestRanges::testRangeRows()
         QVERIFY(!r->hasItem(8, 8));
     }
 }
+
+void TestRanges::testSelectionSpans()
+{
+    RangeSelection selection;
+    SelectionSpans spans;
+
+    auto addRange = [&selection, &spans](SharedPtr<Range> range, bool exclude) {
+        QVERIFY(spans.addRange(*range, exclude));
+        selection.addRange(range, exclude);
+    };
+
+    addRange(makeRangeGridRect(2, 8, 1, 5), false);
+    addRange(makeRangeGridRows(10, 12), false);
+    addRange(makeRangeGridRect(3, 5, 2, 4), true);
+    addRange(makeRangeGridColumn(7), false);
+    addRange(makeRangeID(ID(GridID(7, 7))), true);
+    addRange(makeRangeGridRow(4), false);
+    addRange(makeRangeGridColumns(3, 4), true);
+
+    for (int row = -1; row < 15; ++row)
+    {
+        for (int column = -1; column < 10; ++column)
+        {
+            GridID id(row, column);
+            QCOMPARE(spans.hasItem(id), selection.hasItem(ID(id)));
+        }
+    }
+
+    addRange(makeRangeAll(), true);
+    QCOMPARE(spans.bands().size(), 1);
+    QVERIFY(!spans.hasItem(GridID(4, 4)));
+
+    auto rangeCallback = makeShared<RangeGridCallback>();
+    QVERIFY(!spans.addRange(*rangeCallback, false));
+}
+
+void TestRanges::testRangeRowsBitmap()
+{
+    SparseBitVector rows;
+    QVERIFY(rows.isAll(false));
+
+    rows.setValues(10, 200000, true);
+    rows.setValue(70000, false);
+    QVERIFY(!rows.value(9));
+    QVERIFY(rows.value(10));
+    QVERIFY(rows.value(199999));
+    QVERIFY(!rows.value(200000));
+    QVERIFY(!rows.value(70000));
+
+    rows.invert();
+    QVERIFY(rows.value(9));
+    QVERIFY(!rows.value(10));
+    QVERIFY(rows.value(70000));
+
+    auto r = makeRangeGridRowsBitmap(rows);
+    QVERIFY(r->hasItem(70000, 3));
+    QVERIFY(!r->hasItem(100, 3));
+    QVERIFY(!r->hasItem(InvalidIndex, 3));
+
+    rows.fill(true);
+    QVERIFY(rows.isAll(true));
+    QVERIFY(!r->hasItem(100, 3));
+}
+
+void TestRanges::testRangeLinesCallback()
+{
+    int calls = 0;
+    int divider = 2;
+    auto r = makeRangeGridRowsCallback([&calls, &divider](int row) {
+        ++calls;
+        return row % divider == 0;
+    });
+
+    QVERIFY(r->hasItem(4, 0));
+    QVERIFY(!r->hasItem(5, 0));
+    QCOMPARE(calls, 2);
+
+    // rows are evaluated once for all columns
+    QVERIFY(r->hasItem(4, 7));
+    GridID ids[] = { GridID(5, 1), GridID(4, 2), GridID(6, 3) };
+    bool results[3];
+    r->hasItems(ids, results, 3);
+    QVERIFY(!results[0] && results[1] && results[2]);
+    QCOMPARE(calls, 3);
+    QVERIFY(!r->hasItem(InvalidIndex, 0));
+
+    auto spy = createSignalSpy(r.data(), &Range::rangeChanged);
+    divider = 5;
+    r->invalidateLine(5);
+    QCOMPARE(spy.size(), 1);
+    QVERIFY(r->hasItem(5, 0));
+    QVERIFY(r->hasItem(4, 0));
+
+    r->invalidate();
+    QCOMPARE(spy.size(), 2);
+    QVERIFY(!r->hasItem(4, 0));
+
+    auto c = makeRangeGridColumnsCallback([](int column) { return column == 1; });
+    QVERIFY(c->hasItem(10, 1));
+    QVERIFY(!c->hasItem(1, 10));
+}
+
+void TestRanges::testRangeListener()
+{
+    struct Listener: public RangeListener
+    {
+        void onRangeChanged(const Range* range, ChangeReason reason) override
+        {
+            lastRange = range;
+            lastReason = reason;
+            ++calls;
+        }
+
+        const Range* lastRange = nullptr;
+        ChangeReason lastReason;
+        int calls = 0;
+    };
+
+    auto r = makeRangeGridColumn(1);
+    auto spy = createSignalSpy(r.data(), &Range::rangeChanged);
+
+    Listener listener;
+    r->addListener(&listener);
+    r->setColumn(2);
+    QCOMPARE(listener.calls, 1);
+    QCOMPARE(listener.lastRange, r.data());
+    QCOMPARE(listener.lastReason, ChangeReason(ChangeReasonRange));
+    // signal is emitted as well
+    QCOMPARE(spy.size(), 1);
+
+    // unchanged range doesn't notify
+    r->setColumn(2);
+    QCOMPARE(listener.calls, 1);
+
+    r->removeListener(&listener);
+    r->setColumn(3);
+    QCOMPARE(listener.calls, 1);
+    QCOMPARE(spy.size(), 2);
+}
+
+void TestRanges::testRangeCallbackProfiling()
+{
+    RangeCallback range([](ID id) { return id.as<GridID>().row % 2 == 0; });
+    auto profile = profileCallbacks(range, "evenRows");
+
+    // calls are not counted until tracer starts
+    QVERIFY(range.hasItem(makeID<GridID>(0, 0)));
+    QCOMPARE(profile->calls(), quint64(0));
+
+    Tracer::clear();
+    Tracer::start();
+    QVERIFY(range.hasItem(makeID<GridID>(2, 0)));
+    QVERIFY(!range.hasItem(makeID<GridID>(3, 0)));
+    Tracer::stop();
+
+    QCOMPARE(profile->calls(), quint64(2));
+    QVERIFY(profile->totalTime() >= 0);
+
+    bool isListed = false;
+    for (const auto& statistics : Tracer::callbackStatistics())
+        isListed |= qstrcmp(statistics.name, "evenRows") == 0 && statistics.calls == 2;
+    QVERIFY(isListed);
+
+    Tracer::clear();
+    QCOMPARE(profile->calls(), quint64(0));
+}
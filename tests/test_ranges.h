@@ -18,6 +18,11 @@ private slots:
     void testRangeColumns();
     void testRangeRow();
     void testRangeRows();
+    void testSelectionSpans();
+    void testRangeRowsBitmap();
+    void testRangeLinesCallback();
+    void testRangeListener();
+    void testRangeCallbackProfiling();
 };
 
 #endif // TEST_RANGES_H
@@ -0,0 +1,285 @@
+#include "test_scale.h"
+#include "space/grid/Lines.h"
+#include "space/grid/SpaceGrid.h"
+#include "space/grid/CacheSpaceGrid.h"
+#include "core/ext/Ranges.h"
+#include "items/selection/Selection.h"
+#include <QtTest/QtTest>
+#include <QElapsedTimer>
+#include <cmath>
+#include <limits>
+
+using namespace Qi;
+
+static const int smallLinesCount = 10000;
+
+static int largeLinesCount()
+{
+    int count = qEnvironmentVariableIntValue("QI_SCALE_LINES");
+    return count > smallLinesCount ? qMin(count, 100000000) : 1000000;
+}
+
+static double tolerance()
+{
+    bool ok = false;
+    double value = qgetenv("QI_SCALE_TOLERANCE").toDouble(&ok);
+    return ok && value > 1.0 ? value : 10.0;
+}
+
+enum Complexity
+{
+    ComplexityConstant,
+    ComplexityLog
+};
+
+// fails if cost per operation grows faster than complexity allows
+static bool isScaled(const char* name, double smallCost, double largeCost, int smallCount, int largeCount, Complexity complexity, QByteArray& message)
+{
+    // faster operations are timer noise
+    const double minCost = 20.0;
+
+    double growth = complexity == ComplexityLog ? std::log2(double(largeCount)) / std::log2(double(smallCount)) : 1.0;
+    double allowed = growth * tolerance();
+    double actual = qMax(largeCost, minCost) / qMax(smallCost, minCost);
+
+    message = QString("%1: %2 ns at %3, %4 ns at %5, growth %6 exceeds %7")
+            .arg(name).arg(smallCost, 0, 'f', 1).arg(smallCount)
+            .arg(largeCost, 0, 'f', 1).arg(largeCount)
+            .arg(actual, 0, 'f', 1).arg(allowed, 0, 'f', 1).toLatin1();
+    return actual <= allowed;
+}
+
+#define QI_VERIFY_SCALED(name, smallCost, largeCost, smallCount, largeCount, complexity) \
+    do { \
+        QByteArray message; \
+        QVERIFY2(isScaled(name, smallCost, largeCost, smallCount, largeCount, complexity, message), message.constData()); \
+    } while (false)
+
+// nanoseconds per operation, best of several runs
+template <typename Op>
+static double nsecsPerOp(int opsCount, const Op& op)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < 3; ++run)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < opsCount; ++i)
+            op(i);
+        best = qMin(best, double(timer.nsecsElapsed()) / opsCount);
+    }
+    return best;
+}
+
+// deterministic spread of indexes in [0, count)
+static QVector<int> randomIndexes(int size, int count, quint32 seed = 1)
+{
+    QVector<int> indexes(size);
+    for (auto& index : indexes)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        index = int(seed % quint32(count));
+    }
+    return indexes;
+}
+
+static quint32 lineKey(int line, quint32 seed)
+{
+    quint32 key = quint32(line) ^ seed;
+    key = (key ^ (key >> 16)) * 0x45d9f3bu;
+    return key ^ (key >> 16);
+}
+
+// lines with runs of different sizes and every 10th line hidden
+static SharedPtr<Lines> makeLines(int count)
+{
+    auto lines = makeShared<Lines>(count);
+    lines->setLineSizeAll(20);
+    for (int line = 0; line < count; line += 100)
+        lines->setLinesSize(line, qMin(10, count - line), 35);
+
+    QVector<int> hidden;
+    hidden.reserve(count / 10);
+    for (int line = 5; line < count; line += 10)
+        hidden.append(line);
+    lines->setLinesVisible(hidden, false);
+
+    // validates visibles and sizes
+    lines->visibleSize();
+    return lines;
+}
+
+void TestScale::testScaleLinesIndex()
+{
+    const int opsCount = 100000;
+    const int counts[] = { smallLinesCount, largeLinesCount() };
+
+    double toVisibleCost[2], toAbsoluteCost[2], startPosCost[2], findByPosCost[2], resizeCost[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        auto lines = makeLines(counts[i]);
+        auto absolutes = randomIndexes(opsCount, lines->count());
+        auto visibles = randomIndexes(opsCount, lines->visibleCount());
+        auto positions = randomIndexes(opsCount, lines->visibleSize());
+
+        int sum = 0;
+        toVisibleCost[i] = nsecsPerOp(opsCount, [&](int op) { sum += lines->toVisible(absolutes[op]); });
+        toAbsoluteCost[i] = nsecsPerOp(opsCount, [&](int op) { sum += lines->toAbsolute(visibles[op]); });
+        startPosCost[i] = nsecsPerOp(opsCount, [&](int op) { sum += lines->startPos(visibles[op]); });
+        findByPosCost[i] = nsecsPerOp(opsCount, [&](int op) { sum += lines->findVisibleIDByPos(positions[op]); });
+        // resize has to be followed by positions update
+        resizeCost[i] = nsecsPerOp(opsCount / 10, [&](int op) {
+            lines->setLineSize(absolutes[op], 20 + op % 7);
+            sum += lines->startPos(visibles[op]);
+        });
+        QVERIFY(sum != 0);
+    }
+
+    QI_VERIFY_SCALED("toVisible", toVisibleCost[0], toVisibleCost[1], counts[0], counts[1], ComplexityConstant);
+    QI_VERIFY_SCALED("toAbsolute", toAbsoluteCost[0], toAbsoluteCost[1], counts[0], counts[1], ComplexityConstant);
+    QI_VERIFY_SCALED("startPos", startPosCost[0], startPosCost[1], counts[0], counts[1], ComplexityLog);
+    QI_VERIFY_SCALED("findVisibleIDByPos", findByPosCost[0], findByPosCost[1], counts[0], counts[1], ComplexityLog);
+    QI_VERIFY_SCALED("setLineSize", resizeCost[0], resizeCost[1], counts[0], counts[1], ComplexityLog);
+}
+
+void TestScale::testScaleLinesSort()
+{
+    const int counts[] = { smallLinesCount, qMin(largeLinesCount(), 10000000) };
+
+    // cost per line of N log N sorting
+    double sortCost[2], sortVisibleCost[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        auto lines = makeLines(counts[i]);
+
+        quint32 seed = 0;
+        sortCost[i] = nsecsPerOp(1, [&](int) {
+            ++seed;
+            lines->sort(false, [seed](int left, int right) { return lineKey(left, seed) < lineKey(right, seed); });
+            lines->visibleCount();
+        }) / counts[i];
+
+        sortVisibleCost[i] = nsecsPerOp(1, [&](int) {
+            ++seed;
+            lines->sortVisible(false, [seed](int left, int right) { return lineKey(left, seed) < lineKey(right, seed); });
+            lines->visibleCount();
+        }) / counts[i];
+
+        QCOMPARE(lines->count(), counts[i]);
+    }
+
+    QI_VERIFY_SCALED("sort", sortCost[0], sortCost[1], counts[0], counts[1], ComplexityLog);
+    QI_VERIFY_SCALED("sortVisible", sortVisibleCost[0], sortVisibleCost[1], counts[0], counts[1], ComplexityLog);
+}
+
+void TestScale::testScaleLinesFilter()
+{
+    const int counts[] = { smallLinesCount, largeLinesCount() };
+
+    // cost per line to apply filter and update visibles
+    double filterCost[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        auto lines = makeLines(counts[i]);
+
+        QVector<int> filtered;
+        filtered.reserve(counts[i] / 3 + 1);
+        for (int line = 0; line < counts[i]; line += 3)
+            filtered.append(line);
+
+        bool visible = false;
+        filterCost[i] = nsecsPerOp(1, [&](int) {
+            lines->setLinesVisible(filtered, visible);
+            visible = !visible;
+            lines->visibleSize();
+        }) / counts[i];
+
+        QVERIFY(lines->visibleCount() < counts[i]);
+    }
+
+    QI_VERIFY_SCALED("setLinesVisible", filterCost[0], filterCost[1], counts[0], counts[1], ComplexityLog);
+}
+
+void TestScale::testScaleCacheScroll()
+{
+    const int opsCount = 200;
+    const int counts[] = { smallLinesCount, largeLinesCount() };
+
+    // wide grid with many schemas
+    const int columnsCount = 500;
+    const int schemasCount = 50;
+
+    double scrollCost[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        auto grid = makeShared<SpaceGrid>();
+        grid->setDimensions(counts[i], columnsCount);
+        grid->rows()->setLineSizeAll(20);
+        grid->columns()->setLineSizeAll(80);
+        for (int schema = 0; schema < schemasCount; ++schema)
+        {
+            if (schema % 2)
+                grid->addSchema(makeRangeGridColumns(schema, columnsCount), makeShared<View>());
+            else
+                grid->addSchema(makeRangeAll(), makeShared<View>());
+        }
+
+        CacheSpaceGrid cache(grid);
+        cache.setWindow(QRect(0, 0, 1600, 1000));
+
+        const QSize maxOffset(grid->columns()->visibleSize() - 1600, grid->rows()->visibleSize() - 1000);
+        auto rowOffsets = randomIndexes(opsCount, maxOffset.height(), 7);
+        auto columnOffsets = randomIndexes(opsCount, maxOffset.width(), 11);
+
+        GridID idStart, idEnd;
+        scrollCost[i] = nsecsPerOp(opsCount, [&](int op) {
+            cache.setScrollOffset(QPoint(columnOffsets[op], rowOffsets[op]));
+            // validates items cache
+            cache.visibleItemsRange(idStart, idEnd);
+        });
+
+        QVERIFY(idStart.isValid());
+    }
+
+    QI_VERIFY_SCALED("cache scroll", scrollCost[0], scrollCost[1], counts[0], counts[1], ComplexityLog);
+}
+
+void TestScale::testScaleSelection()
+{
+    const int opsCount = 100000;
+    const int counts[] = { smallLinesCount, largeLinesCount() };
+
+    double querySpansCost[2], queryCost[2];
+    for (int i = 0; i < 2; ++i)
+    {
+        auto grid = makeShared<SpaceGrid>();
+        grid->setDimensions(counts[i], 100);
+
+        // many selection ranges: every 4th row and band of columns
+        QSet<int> rows;
+        int rangesCount = qMin(counts[i] / 4, 250000);
+        rows.reserve(rangesCount);
+        for (int range = 0; range < rangesCount; ++range)
+            rows.insert(range * 4);
+
+        ModelSelection selection(grid);
+        selection.setSelection(makeRangeGridRows(rows));
+        selection.addSelection(makeRangeGridColumns(10, 20), false);
+        QVERIFY(selection.selectionSpans());
+
+        auto queryRows = randomIndexes(opsCount, counts[i], 3);
+        auto queryColumns = randomIndexes(opsCount, 100, 5);
+
+        int selected = 0;
+        querySpansCost[i] = nsecsPerOp(opsCount, [&](int op) {
+            selected += selection.selectionSpans()->hasItem(GridID(queryRows[op], queryColumns[op]));
+        });
+        queryCost[i] = nsecsPerOp(opsCount, [&](int op) {
+            selected += selection.isItemSelected(GridID(queryRows[op], queryColumns[op]));
+        });
+        QVERIFY(selected > 0);
+    }
+
+    QI_VERIFY_SCALED("selection spans", querySpansCost[0], querySpansCost[1], counts[0], counts[1], ComplexityLog);
+    QI_VERIFY_SCALED("isItemSelected", queryCost[0], queryCost[1], counts[0], counts[1], ComplexityLog);
+}
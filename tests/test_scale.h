@@ -0,0 +1,27 @@
+#ifndef TEST_SCALE_H
+#define TEST_SCALE_H
+
+#include <QObject>
+
+// complexity checks on generated large datasets
+// cost per operation is measured on small and large data and should grow
+// no faster than expected complexity times tolerance band
+// QI_SCALE_LINES sets lines count of large data (up to 100M, 1M by default)
+// QI_SCALE_TOLERANCE sets tolerance band (10 by default)
+class TestScale: public QObject
+{
+    Q_OBJECT
+
+public:
+    Q_INVOKABLE TestScale() {}
+
+private slots:
+
+    void testScaleLinesIndex();
+    void testScaleLinesSort();
+    void testScaleLinesFilter();
+    void testScaleCacheScroll();
+    void testScaleSelection();
+};
+
+#endif // TEST_SCALE_H
@@ -18,10 +18,12 @@ HEADERS +=  SignalSpy.h\
     test_item_id.h \
     test_ranges.h \
     test_lines.h \
-    test_grid.h
+    test_grid.h \
+    test_scale.h
 
 SOURCES +=  main.cpp \
     test_item_id.cpp \
     test_ranges.cpp \
     test_lines.cpp \
-    test_grid.cpp
+    test_grid.cpp \
+    test_scale.cpp